@@ -0,0 +1,462 @@
+//
+//  ActiveSpeakerMeter.c
+//  quickstart
+//
+
+#include "ActiveSpeakerMeter.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ACTIVE_SPEAKER_NEON 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define ACTIVE_SPEAKER_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ACTIVE_SPEAKER_SSE2 1
+#endif
+
+/// 三缓冲中的中间缓冲有新数据
+#define ACTIVE_SPEAKER_DIRTY 4u
+
+typedef struct {
+    char roomId[ACTIVE_SPEAKER_MAX_ID_LENGTH + 1];
+    char userId[ACTIVE_SPEAKER_MAX_ID_LENGTH + 1];
+    int streamIndex;
+    uint64_t hash;
+    bool occupied;
+    /// 平滑后的均方值（线性）
+    float energy;
+    float peak;
+    uint64_t lastUpdateMs;
+} ActiveSpeakerState;
+
+struct ActiveSpeakerMeter {
+    ActiveSpeakerMeterConfig config;
+    size_t mask;
+    size_t trackedCount;
+    ActiveSpeakerState *states;
+    uint64_t lastRankMs;
+    bool ranked;
+
+    /// 最近一次发布的排序结果，只在音频线程访问，用于判断是否需要重新发布
+    ActiveSpeakerRanking published;
+    /// 排序结果三缓冲：音频线程写 back，读线程读 front，通过 middle 原子交换
+    ActiveSpeakerRanking buffers[3];
+    unsigned backIndex;
+    unsigned frontIndex;
+    _Atomic unsigned middleIndex;
+};
+
+ActiveSpeakerMeterConfig ActiveSpeakerMeterDefaultConfig(void) {
+    ActiveSpeakerMeterConfig config = {
+        .capacity = 256,
+        .attackMs = 20.0f,
+        .releaseMs = 400.0f,
+        .activeThresholdDb = -50.0f,
+        .staleMs = 1000,
+        .rankIntervalMs = 10,
+        .publishDeltaDb = 1.0f,
+    };
+    return config;
+}
+
+ActiveSpeakerMeter *ActiveSpeakerMeterCreate(const ActiveSpeakerMeterConfig *config) {
+    if (!config || config->capacity == 0 || config->attackMs <= 0 || config->releaseMs <= 0) {
+        return NULL;
+    }
+    size_t capacity = 1;
+    while (capacity < config->capacity) {
+        capacity <<= 1;
+    }
+    ActiveSpeakerMeter *meter = calloc(1, sizeof(ActiveSpeakerMeter));
+    if (!meter) {
+        return NULL;
+    }
+    meter->states = calloc(capacity, sizeof(ActiveSpeakerState));
+    if (!meter->states) {
+        free(meter);
+        return NULL;
+    }
+    meter->config = *config;
+    meter->config.capacity = capacity;
+    meter->mask = capacity - 1;
+    meter->backIndex = 0;
+    atomic_init(&meter->middleIndex, 1);
+    meter->frontIndex = 2;
+    return meter;
+}
+
+void ActiveSpeakerMeterDestroy(ActiveSpeakerMeter *meter) {
+    if (!meter) {
+        return;
+    }
+    free(meter->states);
+    free(meter);
+}
+
+// 电平统计
+
+static void ActiveSpeakerAccumulate_C(const int16_t *samples, size_t count, float *sumSquares, int *maxAbs) {
+    float sum = 0;
+    int peak = 0;
+    for (size_t i = 0; i < count; i++) {
+        float value = samples[i];
+        sum += value * value;
+        int magnitude = abs(samples[i]);
+        if (magnitude > peak) {
+            peak = magnitude;
+        }
+    }
+    *sumSquares += sum;
+    if (peak > *maxAbs) {
+        *maxAbs = peak;
+    }
+}
+
+static void ActiveSpeakerFinishMeasure(float sumSquares, int maxAbs, size_t count, float *rms, float *peak) {
+    *rms = count > 0 ? sqrtf(sumSquares / (float)count) / 32768.0f : 0;
+    *peak = (float)maxAbs / 32768.0f;
+}
+
+void ActiveSpeakerMeasureS16_C(const int16_t *samples, size_t count, float *rms, float *peak) {
+    float sumSquares = 0;
+    int maxAbs = 0;
+    ActiveSpeakerAccumulate_C(samples, count, &sumSquares, &maxAbs);
+    ActiveSpeakerFinishMeasure(sumSquares, maxAbs, count, rms, peak);
+}
+
+void ActiveSpeakerMeasureS16(const int16_t *samples, size_t count, float *rms, float *peak) {
+    float sumSquares = 0;
+    int maxAbs = 0;
+    size_t i = 0;
+    // 平方和用 float 累加：16 位整数平方累加数百次会溢出 int32
+#if ACTIVE_SPEAKER_NEON
+    float32x4_t sum0 = vdupq_n_f32(0), sum1 = vdupq_n_f32(0);
+    int16x8_t maxValue = vdupq_n_s16(0), minValue = vdupq_n_s16(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(samples + i);
+        maxValue = vmaxq_s16(maxValue, v);
+        minValue = vminq_s16(minValue, v);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+        sum0 = vmlaq_f32(sum0, lo, lo);
+        sum1 = vmlaq_f32(sum1, hi, hi);
+    }
+    float32x4_t sum = vaddq_f32(sum0, sum1);
+    sumSquares = vgetq_lane_f32(sum, 0) + vgetq_lane_f32(sum, 1) + vgetq_lane_f32(sum, 2) + vgetq_lane_f32(sum, 3);
+    int16_t lanes[8];
+    vst1q_s16(lanes, maxValue);
+    for (int k = 0; k < 8; k++) {
+        if (lanes[k] > maxAbs) {
+            maxAbs = lanes[k];
+        }
+    }
+    vst1q_s16(lanes, minValue);
+    for (int k = 0; k < 8; k++) {
+        if (-lanes[k] > maxAbs) {
+            maxAbs = -lanes[k];
+        }
+    }
+#elif ACTIVE_SPEAKER_AVX2
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    __m256i maxValue = _mm256_setzero_si256(), minValue = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(samples + i));
+        maxValue = _mm256_max_epi16(maxValue, v);
+        minValue = _mm256_min_epi16(minValue, v);
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(lo, lo));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(hi, hi));
+    }
+    float sums[8];
+    _mm256_storeu_ps(sums, _mm256_add_ps(sum0, sum1));
+    for (int k = 0; k < 8; k++) {
+        sumSquares += sums[k];
+    }
+    int16_t lanes[16];
+    _mm256_storeu_si256((__m256i *)lanes, maxValue);
+    for (int k = 0; k < 16; k++) {
+        if (lanes[k] > maxAbs) {
+            maxAbs = lanes[k];
+        }
+    }
+    _mm256_storeu_si256((__m256i *)lanes, minValue);
+    for (int k = 0; k < 16; k++) {
+        if (-lanes[k] > maxAbs) {
+            maxAbs = -lanes[k];
+        }
+    }
+#elif ACTIVE_SPEAKER_SSE2
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    __m128i maxValue = _mm_setzero_si128(), minValue = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(samples + i));
+        maxValue = _mm_max_epi16(maxValue, v);
+        minValue = _mm_min_epi16(minValue, v);
+        // 放到 32 位高半部分再算术右移，完成符号扩展
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(lo, lo));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(hi, hi));
+    }
+    float sums[4];
+    _mm_storeu_ps(sums, _mm_add_ps(sum0, sum1));
+    sumSquares = sums[0] + sums[1] + sums[2] + sums[3];
+    int16_t lanes[8];
+    _mm_storeu_si128((__m128i *)lanes, maxValue);
+    for (int k = 0; k < 8; k++) {
+        if (lanes[k] > maxAbs) {
+            maxAbs = lanes[k];
+        }
+    }
+    _mm_storeu_si128((__m128i *)lanes, minValue);
+    for (int k = 0; k < 8; k++) {
+        if (-lanes[k] > maxAbs) {
+            maxAbs = -lanes[k];
+        }
+    }
+#endif
+    ActiveSpeakerAccumulate_C(samples + i, count - i, &sumSquares, &maxAbs);
+    ActiveSpeakerFinishMeasure(sumSquares, maxAbs, count, rms, peak);
+}
+
+// 开放寻址表
+
+static uint64_t ActiveSpeakerHash(const char *roomId, const char *userId, int streamIndex) {
+    // FNV-1a
+    uint64_t hash = 1469598103934665603ULL;
+    for (const char *p = roomId; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 1099511628211ULL;
+    }
+    hash = (hash ^ 0xFF) * 1099511628211ULL;
+    for (const char *p = userId; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 1099511628211ULL;
+    }
+    hash = (hash ^ (uint8_t)streamIndex) * 1099511628211ULL;
+    return hash;
+}
+
+static inline bool ActiveSpeakerIsStale(const ActiveSpeakerMeter *meter, const ActiveSpeakerState *state,
+                                        uint64_t nowMs) {
+    return nowMs - state->lastUpdateMs > meter->config.staleMs;
+}
+
+/// 查找流对应的表项，不存在时占用探测路径上第一个失效或空的表项
+/// @note 失效表项不清空而是直接复用，探测链不会断开，因此不需要墓碑
+static ActiveSpeakerState *ActiveSpeakerFindOrInsert(ActiveSpeakerMeter *meter, const char *roomId,
+                                                     const char *userId, int streamIndex, uint64_t nowMs) {
+    if (strlen(roomId) > ACTIVE_SPEAKER_MAX_ID_LENGTH || strlen(userId) > ACTIVE_SPEAKER_MAX_ID_LENGTH) {
+        return NULL;
+    }
+    uint64_t hash = ActiveSpeakerHash(roomId, userId, streamIndex);
+    ActiveSpeakerState *reusable = NULL;
+    size_t index = (size_t)hash & meter->mask;
+    for (size_t probe = 0; probe <= meter->mask; probe++, index = (index + 1) & meter->mask) {
+        ActiveSpeakerState *state = &meter->states[index];
+        if (!state->occupied) {
+            if (!reusable) {
+                reusable = state;
+                meter->trackedCount++;
+            }
+            break;
+        }
+        if (state->hash == hash && state->streamIndex == streamIndex && strcmp(state->userId, userId) == 0 &&
+            strcmp(state->roomId, roomId) == 0) {
+            return state;
+        }
+        if (!reusable && ActiveSpeakerIsStale(meter, state, nowMs)) {
+            reusable = state;
+        }
+    }
+    if (!reusable) {
+        return NULL;
+    }
+    strcpy(reusable->roomId, roomId);
+    strcpy(reusable->userId, userId);
+    reusable->streamIndex = streamIndex;
+    reusable->hash = hash;
+    reusable->occupied = true;
+    reusable->energy = 0;
+    reusable->peak = 0;
+    return reusable;
+}
+
+static inline float ActiveSpeakerToDb(float linear, float scale) {
+    if (linear <= 0) {
+        return ACTIVE_SPEAKER_FLOOR_DB;
+    }
+    return fmaxf(scale * log10f(linear), ACTIVE_SPEAKER_FLOOR_DB);
+}
+
+// 排序与发布
+
+/// 说话人与顺序相同，且电平变化都不超过 publishDeltaDb 时视为未变化
+static bool ActiveSpeakerRankingChanged(const ActiveSpeakerMeter *meter, const ActiveSpeakerRanking *ranking) {
+    const ActiveSpeakerRanking *published = &meter->published;
+    if (ranking->count != published->count) {
+        return true;
+    }
+    for (size_t i = 0; i < ranking->count; i++) {
+        const ActiveSpeakerEntry *entry = &ranking->entries[i];
+        const ActiveSpeakerEntry *previous = &published->entries[i];
+        if (entry->streamIndex != previous->streamIndex || strcmp(entry->userId, previous->userId) != 0 ||
+            strcmp(entry->roomId, previous->roomId) != 0 ||
+            fabsf(entry->levelDb - previous->levelDb) > meter->config.publishDeltaDb) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ActiveSpeakerPublishRanking(ActiveSpeakerMeter *meter, uint64_t nowMs) {
+    ActiveSpeakerRanking *ranking = &meter->buffers[meter->backIndex];
+    ranking->count = 0;
+    float threshold = powf(10.0f, meter->config.activeThresholdDb / 10.0f);
+    // 插入排序维护前 ACTIVE_SPEAKER_MAX_RANKED 名，比较均方值即可
+    float energies[ACTIVE_SPEAKER_MAX_RANKED];
+    const ActiveSpeakerState *top[ACTIVE_SPEAKER_MAX_RANKED];
+    size_t count = 0;
+    for (size_t i = 0; i <= meter->mask; i++) {
+        const ActiveSpeakerState *state = &meter->states[i];
+        if (!state->occupied || state->energy < threshold || ActiveSpeakerIsStale(meter, state, nowMs)) {
+            continue;
+        }
+        if (count == ACTIVE_SPEAKER_MAX_RANKED && state->energy <= energies[count - 1]) {
+            continue;
+        }
+        size_t position = count < ACTIVE_SPEAKER_MAX_RANKED ? count++ : count - 1;
+        while (position > 0 && energies[position - 1] < state->energy) {
+            energies[position] = energies[position - 1];
+            top[position] = top[position - 1];
+            position--;
+        }
+        energies[position] = state->energy;
+        top[position] = state;
+    }
+    for (size_t i = 0; i < count; i++) {
+        ActiveSpeakerEntry *entry = &ranking->entries[i];
+        strcpy(entry->roomId, top[i]->roomId);
+        strcpy(entry->userId, top[i]->userId);
+        entry->streamIndex = top[i]->streamIndex;
+        entry->levelDb = ActiveSpeakerToDb(top[i]->energy, 10.0f);
+        entry->peakDb = ActiveSpeakerToDb(top[i]->peak, 20.0f);
+    }
+    ranking->count = count;
+    // 结果没有变化时不发布，读线程的 ActiveSpeakerMeterCopyRanking 返回 false，界面可以跳过刷新
+    if (!ActiveSpeakerRankingChanged(meter, ranking)) {
+        return;
+    }
+    meter->published.count = count;
+    memcpy(meter->published.entries, ranking->entries, count * sizeof(ActiveSpeakerEntry));
+    meter->backIndex = atomic_exchange_explicit(&meter->middleIndex, meter->backIndex | ACTIVE_SPEAKER_DIRTY,
+                                                memory_order_acq_rel) & ~ACTIVE_SPEAKER_DIRTY;
+}
+
+bool ActiveSpeakerMeterUpdate(ActiveSpeakerMeter *meter, const char *roomId, const char *userId, int streamIndex,
+                              const int16_t *samples, size_t count, float durationMs, uint64_t nowMs) {
+    if (!meter || !roomId || !userId || !samples) {
+        return false;
+    }
+    ActiveSpeakerState *state = ActiveSpeakerFindOrInsert(meter, roomId, userId, streamIndex, nowMs);
+    if (!state) {
+        return false;
+    }
+    float rms, peak;
+    ActiveSpeakerMeasureS16(samples, count, &rms, &peak);
+    float energy = rms * rms;
+    // 失效后复用的表项从当前帧开始，不沿用旧电平
+    if (state->lastUpdateMs == 0 || ActiveSpeakerIsStale(meter, state, nowMs)) {
+        state->energy = energy;
+    } else {
+        float timeConstant = energy > state->energy ? meter->config.attackMs : meter->config.releaseMs;
+        float alpha = 1.0f - expf(-fmaxf(durationMs, 0.0f) / timeConstant);
+        state->energy += alpha * (energy - state->energy);
+    }
+    state->peak = peak;
+    state->lastUpdateMs = nowMs;
+
+    if (!meter->ranked || nowMs - meter->lastRankMs >= meter->config.rankIntervalMs) {
+        meter->ranked = true;
+        meter->lastRankMs = nowMs;
+        ActiveSpeakerPublishRanking(meter, nowMs);
+    }
+    return true;
+}
+
+size_t ActiveSpeakerMeterTrackedCount(const ActiveSpeakerMeter *meter) {
+    return meter->trackedCount;
+}
+
+bool ActiveSpeakerMeterCopyRanking(ActiveSpeakerMeter *meter, ActiveSpeakerRanking *ranking) {
+    bool updated = false;
+    if (atomic_load_explicit(&meter->middleIndex, memory_order_relaxed) & ACTIVE_SPEAKER_DIRTY) {
+        meter->frontIndex = atomic_exchange_explicit(&meter->middleIndex, meter->frontIndex, memory_order_acq_rel) &
+                            ~ACTIVE_SPEAKER_DIRTY;
+        updated = true;
+    }
+    const ActiveSpeakerRanking *front = &meter->buffers[meter->frontIndex];
+    ranking->count = front->count;
+    memcpy(ranking->entries, front->entries, front->count * sizeof(ActiveSpeakerEntry));
+    return updated;
+}
+
+// 槽位分配
+
+static float ActiveSpeakerLevelOf(const ActiveSpeakerEntry *ranked, size_t rankedCount, const char *userId) {
+    for (size_t i = 0; i < rankedCount; i++) {
+        if (strcmp(ranked[i].userId, userId) == 0) {
+            return ranked[i].levelDb;
+        }
+    }
+    return ACTIVE_SPEAKER_FLOOR_DB;
+}
+
+size_t ActiveSpeakerAssignSlots(const ActiveSpeakerEntry *ranked, size_t rankedCount, ActiveSpeakerSlot *slots,
+                                size_t slotCount, float switchMarginDb) {
+    size_t changed = 0;
+    for (size_t r = 0; r < rankedCount; r++) {
+        const ActiveSpeakerEntry *candidate = &ranked[r];
+        bool visible = false;
+        size_t emptySlot = slotCount;
+        size_t quietestSlot = slotCount;
+        float quietestLevel = 0;
+        for (size_t s = 0; s < slotCount; s++) {
+            if (slots[s].userId[0] == '\0') {
+                if (emptySlot == slotCount) {
+                    emptySlot = s;
+                }
+                continue;
+            }
+            if (strcmp(slots[s].userId, candidate->userId) == 0) {
+                visible = true;
+                break;
+            }
+            float level = ActiveSpeakerLevelOf(ranked, rankedCount, slots[s].userId);
+            if (quietestSlot == slotCount || level < quietestLevel) {
+                quietestSlot = s;
+                quietestLevel = level;
+            }
+        }
+        if (visible) {
+            continue;
+        }
+        size_t target = emptySlot;
+        if (target == slotCount) {
+            // 按排名从高到低处理，当前候选替换不了，后面的也替换不了
+            if (quietestSlot == slotCount || candidate->levelDb < quietestLevel + switchMarginDb) {
+                break;
+            }
+            target = quietestSlot;
+        }
+        strcpy(slots[target].userId, candidate->userId);
+        changed++;
+    }
+    return changed;
+}
@@ -0,0 +1,109 @@
+//
+//  ActiveSpeakerMeter.h
+//  quickstart
+//
+//  远端用户音量计与活跃说话人排序
+//
+
+#ifndef ActiveSpeakerMeter_h
+#define ActiveSpeakerMeter_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 房间 ID、用户 ID 的最大长度（与 SDK 限制一致）
+#define ACTIVE_SPEAKER_MAX_ID_LENGTH 128
+/// 排序结果最多保留的说话人数
+#define ACTIVE_SPEAKER_MAX_RANKED 8
+/// 电平下限（dBFS），静音帧按此值计
+#define ACTIVE_SPEAKER_FLOOR_DB (-96.0f)
+
+typedef struct {
+    char roomId[ACTIVE_SPEAKER_MAX_ID_LENGTH + 1];
+    char userId[ACTIVE_SPEAKER_MAX_ID_LENGTH + 1];
+    int streamIndex;
+    /// 平滑后的 RMS 电平（dBFS）
+    float levelDb;
+    /// 最近一帧的峰值（dBFS）
+    float peakDb;
+} ActiveSpeakerEntry;
+
+/// 按 levelDb 从大到小排列的活跃说话人
+typedef struct {
+    size_t count;
+    ActiveSpeakerEntry entries[ACTIVE_SPEAKER_MAX_RANKED];
+} ActiveSpeakerRanking;
+
+typedef struct {
+    /// 最多同时跟踪的音频流数，取整到 2 的幂
+    size_t capacity;
+    /// 电平上升/下降的时间常数（毫秒），上升快、下降慢，避免说话间隙导致排名跳动
+    float attackMs;
+    float releaseMs;
+    /// 平滑电平低于该值（dBFS）时不参与排序
+    float activeThresholdDb;
+    /// 超过该时长（毫秒）没有收到音频帧的流不参与排序，其表项可被复用
+    uint64_t staleMs;
+    /// 两次排序之间的最小间隔（毫秒）
+    uint64_t rankIntervalMs;
+    /// 排序结果中的说话人与顺序不变时，电平变化超过该值（dB）才发布新结果；峰值不参与比较
+    float publishDeltaDb;
+} ActiveSpeakerMeterConfig;
+
+/// 默认配置：256 路流，上升 20ms，下降 400ms，阈值 -50dBFS，1 秒无数据视为失效，
+/// 每 10ms 排序一次，说话人或顺序变化、或电平变化超过 1dB 时才发布
+ActiveSpeakerMeterConfig ActiveSpeakerMeterDefaultConfig(void);
+
+typedef struct ActiveSpeakerMeter ActiveSpeakerMeter;
+
+/// 所有内存在此分配，之后更新与读取都不再分配内存
+ActiveSpeakerMeter *ActiveSpeakerMeterCreate(const ActiveSpeakerMeterConfig *config);
+
+void ActiveSpeakerMeterDestroy(ActiveSpeakerMeter *meter);
+
+/// 计算 S16 PCM 的 RMS 与峰值（均为满幅归一化的线性值），根据编译目标选择 NEON / AVX2 / SSE2 实现
+void ActiveSpeakerMeasureS16(const int16_t *samples, size_t count, float *rms, float *peak);
+
+/// 标量参考实现
+void ActiveSpeakerMeasureS16_C(const int16_t *samples, size_t count, float *rms, float *peak);
+
+/// 用一帧音频更新对应流的电平，并按 rankIntervalMs 排序，结果有变化时发布
+/// @note 只在音频线程调用（所有流的回调需在同一线程，或由调用方串行化）
+/// @param samples 交错 PCM，各声道一起统计
+/// @param count int16_t 个数
+/// @param durationMs 该帧时长，用于按时间常数平滑
+/// @param nowMs 单调时钟（毫秒）
+/// @return 表已满、无法跟踪新的流时返回 false
+bool ActiveSpeakerMeterUpdate(ActiveSpeakerMeter *meter, const char *roomId, const char *userId, int streamIndex,
+                              const int16_t *samples, size_t count, float durationMs, uint64_t nowMs);
+
+/// 当前跟踪的流数（含失效但尚未复用的表项）
+size_t ActiveSpeakerMeterTrackedCount(const ActiveSpeakerMeter *meter);
+
+/// 读取最近一次发布的排序结果，无锁、无等待
+/// @note 只能在一个线程中调用（通常是主线程），与 ActiveSpeakerMeterUpdate 可以并发
+/// @return 与上次调用相比是否有新的结果
+bool ActiveSpeakerMeterCopyRanking(ActiveSpeakerMeter *meter, ActiveSpeakerRanking *ranking);
+
+/// 可见窗口槽位，userId 为空串表示空槽
+typedef struct {
+    char userId[ACTIVE_SPEAKER_MAX_ID_LENGTH + 1];
+} ActiveSpeakerSlot;
+
+/// 根据排序结果分配可见槽位：已在槽位上的用户保持原位；空槽按排名填充；
+/// 槽位已满时，未显示的说话人需要比最安静的已显示用户高出 switchMarginDb 才替换它
+/// @param ranked 排序结果，可以只包含可显示的用户
+/// @return 发生变化的槽位数
+size_t ActiveSpeakerAssignSlots(const ActiveSpeakerEntry *ranked, size_t rankedCount, ActiveSpeakerSlot *slots,
+                                size_t slotCount, float switchMarginDb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ActiveSpeakerMeter_h */
@@ -0,0 +1,42 @@
+//
+//  ActiveSpeakerMonitor.h
+//  quickstart
+//
+//  按远端用户实时音量排序，分配可见窗口
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "ActiveSpeakerMeter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 在 onProcessRemoteUserAudioFrame: 中统计每路远端音频的 RMS/峰值，不需要等待 onRemoteAudioPropertiesReport 的上报间隔
+/// @note processRemoteAudioFrame:streamKey: 只在音频线程调用，不分配内存；其余方法只在主线程调用。
+@interface ActiveSpeakerMonitor : NSObject
+
+- (instancetype)initWithConfig:(ActiveSpeakerMeterConfig)config NS_DESIGNATED_INITIALIZER;
+
+/// 使用 ActiveSpeakerMeterDefaultConfig
+- (instancetype)init;
+
+/// 更换可见说话人需要高出的电平（dB），默认 6
+@property (nonatomic, assign) float switchMarginDb;
+
+/// 音频线程：统计一帧远端音频
+- (void)processRemoteAudioFrame:(ByteRTCAudioFrame *)audioFrame streamKey:(ByteRTCRemoteStreamKey *)streamKey;
+
+/// 主线程：读取最近一次发布的排序结果，按电平从大到小
+/// @return 与上次调用相比是否有新的结果；没有时 ranking 仍为当前结果
+- (BOOL)copyRanking:(ActiveSpeakerRanking *)ranking;
+
+/// 主线程：按排序结果更新可见槽位
+/// @param slotUserIds 各槽位当前的用户 ID，空串表示空槽，原地更新
+/// @param ranking copyRanking: 取得的排序结果
+/// @param eligibleUserIds 可以显示的用户（如已解码首帧视频的用户），nil 表示不限制
+/// @return 是否有槽位变化
+- (BOOL)assignSlots:(NSMutableArray<NSString *> *)slotUserIds ranking:(const ActiveSpeakerRanking *)ranking eligibleUserIds:(nullable NSSet<NSString *> *)eligibleUserIds;
+
+@end
+
+NS_ASSUME_NONNULL_END
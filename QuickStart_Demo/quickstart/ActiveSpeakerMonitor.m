@@ -0,0 +1,89 @@
+//
+//  ActiveSpeakerMonitor.m
+//  quickstart
+//
+
+#import "ActiveSpeakerMonitor.h"
+#import <time.h>
+
+@interface ActiveSpeakerMonitor () {
+    ActiveSpeakerMeter *_meter;
+}
+
+@end
+
+@implementation ActiveSpeakerMonitor
+
+- (instancetype)init {
+    return [self initWithConfig:ActiveSpeakerMeterDefaultConfig()];
+}
+
+- (instancetype)initWithConfig:(ActiveSpeakerMeterConfig)config {
+    self = [super init];
+    if (self) {
+        _meter = ActiveSpeakerMeterCreate(&config);
+        _switchMarginDb = 6.0f;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    ActiveSpeakerMeterDestroy(_meter);
+}
+
+- (void)processRemoteAudioFrame:(ByteRTCAudioFrame *)audioFrame streamKey:(ByteRTCRemoteStreamKey *)streamKey {
+    int channels = audioFrame.channel == ByteRTCAudioChannelStereo ? 2 : 1;
+    size_t count = (size_t)audioFrame.samples * channels;
+    if (count == 0 || audioFrame.sampleRate <= 0 || audioFrame.buffer.length < count * sizeof(int16_t)) {
+        return;
+    }
+    // streamKey 的 roomId、userId 声明为 nullable，CFStringGetCString 不接受 NULL
+    NSString *roomIdString = streamKey.roomId;
+    NSString *userIdString = streamKey.userId;
+    if (!roomIdString || !userIdString) {
+        return;
+    }
+    // 转成栈上的 C 字符串，避免在音频线程分配内存
+    char roomId[ACTIVE_SPEAKER_MAX_ID_LENGTH + 1];
+    char userId[ACTIVE_SPEAKER_MAX_ID_LENGTH + 1];
+    if (!CFStringGetCString((__bridge CFStringRef)roomIdString, roomId, sizeof(roomId), kCFStringEncodingUTF8) ||
+        !CFStringGetCString((__bridge CFStringRef)userIdString, userId, sizeof(userId), kCFStringEncodingUTF8)) {
+        return;
+    }
+    float durationMs = audioFrame.samples * 1000.0f / (float)audioFrame.sampleRate;
+    uint64_t nowMs = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) / NSEC_PER_MSEC;
+    ActiveSpeakerMeterUpdate(_meter, roomId, userId, (int)streamKey.streamIndex, audioFrame.buffer.bytes, count,
+                             durationMs, nowMs);
+}
+
+- (BOOL)copyRanking:(ActiveSpeakerRanking *)ranking {
+    return ActiveSpeakerMeterCopyRanking(_meter, ranking);
+}
+
+- (BOOL)assignSlots:(NSMutableArray<NSString *> *)slotUserIds ranking:(const ActiveSpeakerRanking *)ranking eligibleUserIds:(NSSet<NSString *> *)eligibleUserIds {
+    ActiveSpeakerEntry candidates[ACTIVE_SPEAKER_MAX_RANKED];
+    size_t candidateCount = 0;
+    for (size_t i = 0; i < ranking->count; i++) {
+        if (eligibleUserIds && ![eligibleUserIds containsObject:@(ranking->entries[i].userId)]) {
+            continue;
+        }
+        candidates[candidateCount++] = ranking->entries[i];
+    }
+    if (candidateCount == 0 || slotUserIds.count == 0) {
+        return NO;
+    }
+    NSUInteger slotCount = slotUserIds.count;
+    ActiveSpeakerSlot slots[slotCount];
+    for (NSUInteger i = 0; i < slotCount; i++) {
+        strlcpy(slots[i].userId, slotUserIds[i].UTF8String ?: "", sizeof(slots[i].userId));
+    }
+    if (ActiveSpeakerAssignSlots(candidates, candidateCount, slots, slotCount, self.switchMarginDb) == 0) {
+        return NO;
+    }
+    for (NSUInteger i = 0; i < slotCount; i++) {
+        slotUserIds[i] = @(slots[i].userId);
+    }
+    return YES;
+}
+
+@end
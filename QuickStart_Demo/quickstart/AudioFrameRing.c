@@ -0,0 +1,254 @@
+//
+//  AudioFrameRing.c
+//  quickstart
+//
+
+#include "AudioFrameRing.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AUDIO_FRAME_RING_CACHE_LINE 64
+
+/// 深度超过 目标 + 该值 时每次读取额外丢弃一帧
+#define AUDIO_FRAME_RING_LATENCY_SLACK 2
+/// 连续这么多次读取缓冲都有富余时目标深度减一（10ms 帧约 2 秒）
+#define AUDIO_FRAME_RING_SHRINK_WINDOW 200
+/// 重复隐藏的最大帧数，之后输出静音
+#define AUDIO_FRAME_RING_MAX_REPEATS 4
+
+struct AudioFrameRing {
+    /// 生产者与消费者各自写的字段分开放在不同缓存行，避免伪共享
+    _Alignas(AUDIO_FRAME_RING_CACHE_LINE) _Atomic uint64_t writeIndex;
+    _Atomic uint64_t writtenFrames;
+    _Atomic uint64_t overrunDrops;
+
+    _Alignas(AUDIO_FRAME_RING_CACHE_LINE) _Atomic uint64_t readIndex;
+    _Atomic uint64_t readFrames;
+    _Atomic uint64_t latencyDrops;
+    _Atomic uint64_t underruns;
+    _Atomic uint64_t concealedFrames;
+    _Atomic size_t targetDepth;
+
+    /// 以下只由消费者访问
+    bool prebuffering;
+    bool underrunning;
+    bool fadeIn;
+    unsigned concealedRun;
+    size_t windowReads;
+    size_t windowMinSpare;
+    int16_t *lastFrame;
+    bool hasLastFrame;
+
+    /// 创建后只读
+    _Alignas(AUDIO_FRAME_RING_CACHE_LINE) AudioFrameRingConfig config;
+    size_t frameLength;
+    int16_t *slots;
+};
+
+AudioFrameRingConfig AudioFrameRingDefaultConfig(size_t samplesPerFrame, unsigned channels) {
+    AudioFrameRingConfig config = {
+        .capacity = 32,
+        .samplesPerFrame = samplesPerFrame,
+        .channels = channels,
+        .minTargetDepth = 2,
+        .maxTargetDepth = 16,
+        .concealment = AudioFrameRingConcealRepeat,
+    };
+    return config;
+}
+
+AudioFrameRing *AudioFrameRingCreate(const AudioFrameRingConfig *config) {
+    if (!config || config->capacity < 2 || config->samplesPerFrame == 0 || config->channels == 0 ||
+        config->minTargetDepth == 0 || config->minTargetDepth > config->maxTargetDepth ||
+        config->maxTargetDepth >= config->capacity) {
+        return NULL;
+    }
+    void *memory = NULL;
+    if (posix_memalign(&memory, AUDIO_FRAME_RING_CACHE_LINE, sizeof(AudioFrameRing)) != 0) {
+        return NULL;
+    }
+    AudioFrameRing *ring = memory;
+    memset(ring, 0, sizeof(AudioFrameRing));
+    ring->config = *config;
+    ring->frameLength = config->samplesPerFrame * config->channels;
+    ring->slots = calloc(config->capacity * ring->frameLength, sizeof(int16_t));
+    ring->lastFrame = calloc(ring->frameLength, sizeof(int16_t));
+    if (!ring->slots || !ring->lastFrame) {
+        AudioFrameRingDestroy(ring);
+        return NULL;
+    }
+    atomic_init(&ring->writeIndex, 0);
+    atomic_init(&ring->readIndex, 0);
+    atomic_init(&ring->targetDepth, config->minTargetDepth);
+    ring->prebuffering = true;
+    ring->windowMinSpare = SIZE_MAX;
+    return ring;
+}
+
+void AudioFrameRingDestroy(AudioFrameRing *ring) {
+    if (!ring) {
+        return;
+    }
+    free(ring->slots);
+    free(ring->lastFrame);
+    free(ring);
+}
+
+size_t AudioFrameRingFrameLength(const AudioFrameRing *ring) {
+    return ring->frameLength;
+}
+
+static inline void AudioFrameRingCounterAdd(_Atomic uint64_t *counter) {
+    // 每个计数器只有一个写线程，无需 RMW
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+bool AudioFrameRingWrite(AudioFrameRing *ring, const int16_t *frame) {
+    uint64_t write = atomic_load_explicit(&ring->writeIndex, memory_order_relaxed);
+    uint64_t read = atomic_load_explicit(&ring->readIndex, memory_order_acquire);
+    if (write - read >= ring->config.capacity) {
+        AudioFrameRingCounterAdd(&ring->overrunDrops);
+        return false;
+    }
+    int16_t *slot = ring->slots + (size_t)(write % ring->config.capacity) * ring->frameLength;
+    memcpy(slot, frame, ring->frameLength * sizeof(int16_t));
+    atomic_store_explicit(&ring->writeIndex, write + 1, memory_order_release);
+    AudioFrameRingCounterAdd(&ring->writtenFrames);
+    return true;
+}
+
+/// 根据已连续隐藏的帧数，用上一帧生成隐藏帧
+static void AudioFrameRingConceal(AudioFrameRing *ring, int16_t *frame) {
+    size_t length = ring->frameLength;
+    unsigned run = ring->concealedRun++;
+    if (!ring->hasLastFrame) {
+        memset(frame, 0, length * sizeof(int16_t));
+        return;
+    }
+    if (ring->config.concealment == AudioFrameRingConcealRepeat) {
+        if (run >= AUDIO_FRAME_RING_MAX_REPEATS) {
+            memset(frame, 0, length * sizeof(int16_t));
+            return;
+        }
+        // 第 n 次重复衰减 6n dB
+        int shift = (int)run + 1;
+        for (size_t i = 0; i < length; i++) {
+            frame[i] = (int16_t)(ring->lastFrame[i] >> shift);
+        }
+        return;
+    }
+    if (run > 0) {
+        memset(frame, 0, length * sizeof(int16_t));
+        return;
+    }
+    unsigned channels = ring->config.channels;
+    size_t samples = ring->config.samplesPerFrame;
+    for (size_t i = 0; i < samples; i++) {
+        int32_t gain = (int32_t)(((samples - i) << 15) / samples);
+        for (unsigned c = 0; c < channels; c++) {
+            frame[i * channels + c] = (int16_t)((ring->lastFrame[i * channels + c] * gain) >> 15);
+        }
+    }
+}
+
+/// 隐藏后恢复的第一帧线性淡入，避免跳变
+static void AudioFrameRingFadeIn(AudioFrameRing *ring, int16_t *frame) {
+    unsigned channels = ring->config.channels;
+    size_t samples = ring->config.samplesPerFrame;
+    for (size_t i = 0; i < samples; i++) {
+        int32_t gain = (int32_t)(((i + 1) << 15) / samples);
+        for (unsigned c = 0; c < channels; c++) {
+            frame[i * channels + c] = (int16_t)((frame[i * channels + c] * gain) >> 15);
+        }
+    }
+}
+
+/// 统计窗口内的最小富余深度，持续富余时缩小目标深度以降低延迟
+static void AudioFrameRingTrackSpare(AudioFrameRing *ring, size_t depth, size_t target) {
+    size_t spare = depth > target ? depth - target : 0;
+    if (spare < ring->windowMinSpare) {
+        ring->windowMinSpare = spare;
+    }
+    if (++ring->windowReads < AUDIO_FRAME_RING_SHRINK_WINDOW) {
+        return;
+    }
+    if (ring->windowMinSpare > 0 && target > ring->config.minTargetDepth) {
+        atomic_store_explicit(&ring->targetDepth, target - 1, memory_order_relaxed);
+    }
+    ring->windowReads = 0;
+    ring->windowMinSpare = SIZE_MAX;
+}
+
+AudioFrameRingReadResult AudioFrameRingRead(AudioFrameRing *ring, int16_t *frame) {
+    uint64_t read = atomic_load_explicit(&ring->readIndex, memory_order_relaxed);
+    uint64_t write = atomic_load_explicit(&ring->writeIndex, memory_order_acquire);
+    size_t depth = (size_t)(write - read);
+    size_t target = atomic_load_explicit(&ring->targetDepth, memory_order_relaxed);
+
+    if (ring->prebuffering) {
+        if (depth < target) {
+            if (ring->underrunning) {
+                AudioFrameRingCounterAdd(&ring->concealedFrames);
+                AudioFrameRingConceal(ring, frame);
+                return AudioFrameRingReadConcealed;
+            }
+            memset(frame, 0, ring->frameLength * sizeof(int16_t));
+            return AudioFrameRingReadPrebuffering;
+        }
+        ring->prebuffering = false;
+    }
+
+    if (depth == 0) {
+        // 读空：上调目标深度并重新预缓冲，期间输出隐藏帧
+        if (!ring->underrunning) {
+            ring->underrunning = true;
+            AudioFrameRingCounterAdd(&ring->underruns);
+            if (target < ring->config.maxTargetDepth) {
+                atomic_store_explicit(&ring->targetDepth, target + 1, memory_order_relaxed);
+            }
+        }
+        ring->prebuffering = true;
+        ring->windowReads = 0;
+        ring->windowMinSpare = SIZE_MAX;
+        AudioFrameRingCounterAdd(&ring->concealedFrames);
+        AudioFrameRingConceal(ring, frame);
+        return AudioFrameRingReadConcealed;
+    }
+
+    if (depth > target + AUDIO_FRAME_RING_LATENCY_SLACK) {
+        read++;
+        depth--;
+        AudioFrameRingCounterAdd(&ring->latencyDrops);
+    }
+    AudioFrameRingTrackSpare(ring, depth, target);
+
+    const int16_t *slot = ring->slots + (size_t)(read % ring->config.capacity) * ring->frameLength;
+    memcpy(frame, slot, ring->frameLength * sizeof(int16_t));
+    atomic_store_explicit(&ring->readIndex, read + 1, memory_order_release);
+    AudioFrameRingCounterAdd(&ring->readFrames);
+
+    memcpy(ring->lastFrame, frame, ring->frameLength * sizeof(int16_t));
+    ring->hasLastFrame = true;
+    if (ring->underrunning) {
+        ring->underrunning = false;
+        ring->concealedRun = 0;
+        AudioFrameRingFadeIn(ring, frame);
+    }
+    return AudioFrameRingReadData;
+}
+
+void AudioFrameRingGetStats(const AudioFrameRing *ring, AudioFrameRingStats *stats) {
+    AudioFrameRing *mutableRing = (AudioFrameRing *)ring;
+    uint64_t read = atomic_load_explicit(&mutableRing->readIndex, memory_order_acquire);
+    uint64_t write = atomic_load_explicit(&mutableRing->writeIndex, memory_order_acquire);
+    stats->writtenFrames = atomic_load_explicit(&mutableRing->writtenFrames, memory_order_relaxed);
+    stats->overrunDrops = atomic_load_explicit(&mutableRing->overrunDrops, memory_order_relaxed);
+    stats->readFrames = atomic_load_explicit(&mutableRing->readFrames, memory_order_relaxed);
+    stats->latencyDrops = atomic_load_explicit(&mutableRing->latencyDrops, memory_order_relaxed);
+    stats->underruns = atomic_load_explicit(&mutableRing->underruns, memory_order_relaxed);
+    stats->concealedFrames = atomic_load_explicit(&mutableRing->concealedFrames, memory_order_relaxed);
+    stats->depth = write > read ? (size_t)(write - read) : 0;
+    stats->targetDepth = atomic_load_explicit(&mutableRing->targetDepth, memory_order_relaxed);
+}
@@ -0,0 +1,84 @@
+//
+//  AudioFrameRing.h
+//  quickstart
+//
+//  单生产者/单消费者无锁 PCM 帧环形缓冲，带自适应抖动缓冲与丢包隐藏
+//
+
+#ifndef AudioFrameRing_h
+#define AudioFrameRing_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 读空时的隐藏方式
+typedef enum {
+    AudioFrameRingConcealRepeat = 0,    // 重复上一帧，每帧衰减 6dB，4 帧后静音
+    AudioFrameRingConcealFade,          // 上一帧在一帧内线性淡出，之后静音
+} AudioFrameRingConcealment;
+
+typedef struct {
+    /// 可缓存的帧数，至少为 2
+    size_t capacity;
+    /// 每帧每声道采样点数，10ms 帧为 sampleRate / 100
+    size_t samplesPerFrame;
+    /// 声道数，多声道按 LRLR 交错
+    unsigned channels;
+    /// 抖动缓冲目标深度（帧）的下限与上限，读空后上调、持续富余时下调
+    size_t minTargetDepth;
+    size_t maxTargetDepth;
+    AudioFrameRingConcealment concealment;
+} AudioFrameRingConfig;
+
+/// 默认配置：容量 32 帧，目标深度 2~16 帧，重复隐藏
+AudioFrameRingConfig AudioFrameRingDefaultConfig(size_t samplesPerFrame, unsigned channels);
+
+/// 计数器，可在任意线程读取
+typedef struct {
+    uint64_t writtenFrames;         // 写入成功的帧数
+    uint64_t overrunDrops;          // 写满时丢弃的帧数
+    uint64_t readFrames;            // 读出的真实帧数
+    uint64_t latencyDrops;          // 缓冲深度超出目标过多时，为降低延迟丢弃的帧数
+    uint64_t underruns;             // 读空次数（连续读空只计一次）
+    uint64_t concealedFrames;       // 读空时输出的隐藏帧数
+    size_t depth;                   // 当前缓存帧数
+    size_t targetDepth;             // 当前目标深度
+} AudioFrameRingStats;
+
+typedef enum {
+    AudioFrameRingReadData = 0,     // 输出真实数据
+    AudioFrameRingReadPrebuffering, // 缓冲深度未达到目标，输出静音
+    AudioFrameRingReadConcealed,    // 读空，输出隐藏帧
+} AudioFrameRingReadResult;
+
+typedef struct AudioFrameRing AudioFrameRing;
+
+/// 创建环形缓冲，所有内存在此分配
+/// @return 配置非法时返回 NULL
+AudioFrameRing *AudioFrameRingCreate(const AudioFrameRingConfig *config);
+
+void AudioFrameRingDestroy(AudioFrameRing *ring);
+
+/// 每帧 int16_t 个数（samplesPerFrame * channels）
+size_t AudioFrameRingFrameLength(const AudioFrameRing *ring);
+
+/// 写入一帧，只在生产者线程调用，无等待
+/// @return 缓冲已满时丢弃该帧并返回 false
+bool AudioFrameRingWrite(AudioFrameRing *ring, const int16_t *frame);
+
+/// 读出一帧，只在消费者线程调用，无等待；总会写满 frame
+AudioFrameRingReadResult AudioFrameRingRead(AudioFrameRing *ring, int16_t *frame);
+
+/// 读取计数器，各项分别原子读取，彼此之间不保证是同一时刻的值
+void AudioFrameRingGetStats(const AudioFrameRing *ring, AudioFrameRingStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AudioFrameRing_h */
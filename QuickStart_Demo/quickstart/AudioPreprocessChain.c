@@ -0,0 +1,666 @@
+//
+//  AudioPreprocessChain.c
+//  quickstart
+//
+
+#include "AudioPreprocessChain.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// NEON 只在 arm64 上启用（需要 vfmaq_f32 / vdivq_f32），x86 上 AVX2 优先于 SSE2
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_PREPROCESS_NEON 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define AUDIO_PREPROCESS_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_PREPROCESS_SSE2 1
+#endif
+
+// S16 与 float 的转换在 AVX2 下也使用 SSE2 指令
+#if AUDIO_PREPROCESS_AVX2 || AUDIO_PREPROCESS_SSE2
+#define AUDIO_PREPROCESS_X86 1
+#endif
+
+/// 每次处理的最大帧数，更长的输入分块处理（10ms@48kHz 为 480 帧，一块即可）
+#define AUDIO_PREPROCESS_BLOCK_FRAMES 512
+
+#if AUDIO_PREPROCESS_NEON
+typedef float32x4_t AudioVec;
+#define AUDIO_VEC_WIDTH 4
+#define AudioVecLoad(p) vld1q_f32(p)
+#define AudioVecStore(p, v) vst1q_f32(p, v)
+#define AudioVecSet1(x) vdupq_n_f32(x)
+#define AudioVecAdd(a, b) vaddq_f32(a, b)
+#define AudioVecSub(a, b) vsubq_f32(a, b)
+#define AudioVecMul(a, b) vmulq_f32(a, b)
+#define AudioVecMulAdd(acc, a, b) vfmaq_f32(acc, a, b)
+#define AudioVecDiv(a, b) vdivq_f32(a, b)
+#define AudioVecMin(a, b) vminq_f32(a, b)
+#define AudioVecMax(a, b) vmaxq_f32(a, b)
+#define AudioVecAbs(a) vabsq_f32(a)
+/// 幅度 mag（非负）取 x 的符号
+#define AudioVecCopySign(mag, x) vbslq_f32(vdupq_n_u32(0x80000000u), x, mag)
+#elif AUDIO_PREPROCESS_AVX2
+typedef __m256 AudioVec;
+#define AUDIO_VEC_WIDTH 8
+#define AudioVecLoad(p) _mm256_loadu_ps(p)
+#define AudioVecStore(p, v) _mm256_storeu_ps(p, v)
+#define AudioVecSet1(x) _mm256_set1_ps(x)
+#define AudioVecAdd(a, b) _mm256_add_ps(a, b)
+#define AudioVecSub(a, b) _mm256_sub_ps(a, b)
+#define AudioVecMul(a, b) _mm256_mul_ps(a, b)
+#if defined(__FMA__)
+#define AudioVecMulAdd(acc, a, b) _mm256_fmadd_ps(a, b, acc)
+#else
+#define AudioVecMulAdd(acc, a, b) _mm256_add_ps(acc, _mm256_mul_ps(a, b))
+#endif
+#define AudioVecDiv(a, b) _mm256_div_ps(a, b)
+#define AudioVecMin(a, b) _mm256_min_ps(a, b)
+#define AudioVecMax(a, b) _mm256_max_ps(a, b)
+#define AudioVecAbs(a) _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a)
+#define AudioVecCopySign(mag, x) _mm256_or_ps(mag, _mm256_and_ps(_mm256_set1_ps(-0.0f), x))
+#elif AUDIO_PREPROCESS_SSE2
+typedef __m128 AudioVec;
+#define AUDIO_VEC_WIDTH 4
+#define AudioVecLoad(p) _mm_loadu_ps(p)
+#define AudioVecStore(p, v) _mm_storeu_ps(p, v)
+#define AudioVecSet1(x) _mm_set1_ps(x)
+#define AudioVecAdd(a, b) _mm_add_ps(a, b)
+#define AudioVecSub(a, b) _mm_sub_ps(a, b)
+#define AudioVecMul(a, b) _mm_mul_ps(a, b)
+#define AudioVecMulAdd(acc, a, b) _mm_add_ps(acc, _mm_mul_ps(a, b))
+#define AudioVecDiv(a, b) _mm_div_ps(a, b)
+#define AudioVecMin(a, b) _mm_min_ps(a, b)
+#define AudioVecMax(a, b) _mm_max_ps(a, b)
+#define AudioVecAbs(a) _mm_andnot_ps(_mm_set1_ps(-0.0f), a)
+#define AudioVecCopySign(mag, x) _mm_or_ps(mag, _mm_and_ps(_mm_set1_ps(-0.0f), x))
+#else
+#define AUDIO_VEC_WIDTH 1
+#endif
+
+#define AUDIO_PREPROCESS_SIMD (AUDIO_VEC_WIDTH > 1)
+
+/// 分块 IIR 的输入个数：x[n-2], x[n-1], x[n..n+W-1], y[n-2], y[n-1]
+#define AUDIO_BIQUAD_BLOCK_INPUTS (AUDIO_VEC_WIDTH + 4)
+
+typedef struct AudioStage AudioStage;
+
+/// 每种处理级的默认参数与处理函数
+typedef struct {
+    float defaultParam;
+    /// 参数或采样率变化时在音频线程调用，不能分配内存
+    void (*configure)(AudioStage *stage, float param, unsigned sampleRate);
+    /// 处理平面格式的 float 数据，planes[c] 为第 c 声道
+    void (*process)(AudioStage *stage, float *const *planes, unsigned channels, size_t frames, bool simd);
+} AudioStageOps;
+
+struct AudioStage {
+    AudioStageType type;
+    const AudioStageOps *ops;
+    _Atomic bool enabled;
+    _Atomic float param;
+
+    /// 以下只在音频线程访问
+    float appliedParam;
+    bool configured;
+
+    /// 二阶 IIR：y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+    float b0, b1, b2, a1, a2;
+    /// 分块形式：y[n+k] = Σ blockCoeffs[i][k] * input[i]，一次算出一个向量宽度的输出
+    float blockCoeffs[AUDIO_BIQUAD_BLOCK_INPUTS][AUDIO_VEC_WIDTH];
+    float x1[AUDIO_PREPROCESS_MAX_CHANNELS], x2[AUDIO_PREPROCESS_MAX_CHANNELS];
+    float y1[AUDIO_PREPROCESS_MAX_CHANNELS], y2[AUDIO_PREPROCESS_MAX_CHANNELS];
+
+    /// 增益：当前与目标线性增益
+    float gain, targetGain;
+
+    /// 软限幅：拐点（线性幅度）
+    float knee;
+};
+
+struct AudioPreprocessChain {
+    AudioStage stages[AUDIO_PREPROCESS_MAX_STAGES];
+    size_t count;
+    _Atomic bool scalarOnly;
+    unsigned sampleRate;
+    unsigned channels;
+    float scratch[AUDIO_PREPROCESS_MAX_CHANNELS][AUDIO_PREPROCESS_BLOCK_FRAMES];
+};
+
+// 二阶 IIR（高通、去直流共用）
+
+static inline float AudioFlushDenormal(float value) {
+    return fabsf(value) < 1e-15f ? 0.0f : value;
+}
+
+static void AudioBiquadReset(AudioStage *stage) {
+    memset(stage->x1, 0, sizeof(stage->x1));
+    memset(stage->x2, 0, sizeof(stage->x2));
+    memset(stage->y1, 0, sizeof(stage->y1));
+    memset(stage->y2, 0, sizeof(stage->y2));
+}
+
+/// 对每个输入单独求冲激响应，得到分块形式的系数
+static void AudioBiquadComputeBlockCoeffs(AudioStage *stage) {
+    for (int input = 0; input < AUDIO_BIQUAD_BLOCK_INPUTS; input++) {
+        // x[-2], x[-1], x[0..W-1]
+        double x[AUDIO_VEC_WIDTH + 2] = {0};
+        double yPrev2 = 0, yPrev1 = 0;
+        if (input < AUDIO_VEC_WIDTH + 2) {
+            x[input] = 1;
+        } else if (input == AUDIO_VEC_WIDTH + 2) {
+            yPrev2 = 1;
+        } else {
+            yPrev1 = 1;
+        }
+        for (int k = 0; k < AUDIO_VEC_WIDTH; k++) {
+            double y = stage->b0 * x[k + 2] + stage->b1 * x[k + 1] + stage->b2 * x[k] - stage->a1 * yPrev1 - stage->a2 * yPrev2;
+            stage->blockCoeffs[input][k] = (float)y;
+            yPrev2 = yPrev1;
+            yPrev1 = y;
+        }
+    }
+}
+
+static void AudioBiquadSetCoeffs(AudioStage *stage, double b0, double b1, double b2, double a1, double a2) {
+    stage->b0 = (float)b0;
+    stage->b1 = (float)b1;
+    stage->b2 = (float)b2;
+    stage->a1 = (float)a1;
+    stage->a2 = (float)a2;
+    AudioBiquadComputeBlockCoeffs(stage);
+}
+
+static void AudioBiquadProcessChannel_C(AudioStage *stage, float *samples, size_t frames, unsigned channel,
+                                        size_t start) {
+    float b0 = stage->b0, b1 = stage->b1, b2 = stage->b2, a1 = stage->a1, a2 = stage->a2;
+    float x1 = stage->x1[channel], x2 = stage->x2[channel];
+    float y1 = stage->y1[channel], y2 = stage->y2[channel];
+    for (size_t i = start; i < frames; i++) {
+        float x = samples[i];
+        float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        samples[i] = y;
+    }
+    stage->x1[channel] = x1;
+    stage->x2[channel] = x2;
+    stage->y1[channel] = y1;
+    stage->y2[channel] = y2;
+}
+
+#if AUDIO_PREPROCESS_SIMD
+/// 递推无法按样本并行，改为每次用 W + 4 次广播乘加算出 W 个输出（标量形式每个输出 5 次乘加）
+static size_t AudioBiquadProcessChannel_SIMD(AudioStage *stage, float *samples, size_t frames, unsigned channel) {
+    AudioVec coeffs[AUDIO_BIQUAD_BLOCK_INPUTS];
+    for (int i = 0; i < AUDIO_BIQUAD_BLOCK_INPUTS; i++) {
+        coeffs[i] = AudioVecLoad(stage->blockCoeffs[i]);
+    }
+    float x1 = stage->x1[channel], x2 = stage->x2[channel];
+    float y1 = stage->y1[channel], y2 = stage->y2[channel];
+    size_t i = 0;
+    for (; i + AUDIO_VEC_WIDTH <= frames; i += AUDIO_VEC_WIDTH) {
+        float *block = samples + i;
+        AudioVec acc = AudioVecMul(coeffs[0], AudioVecSet1(x2));
+        acc = AudioVecMulAdd(acc, coeffs[1], AudioVecSet1(x1));
+        for (int k = 0; k < AUDIO_VEC_WIDTH; k++) {
+            acc = AudioVecMulAdd(acc, coeffs[k + 2], AudioVecSet1(block[k]));
+        }
+        acc = AudioVecMulAdd(acc, coeffs[AUDIO_VEC_WIDTH + 2], AudioVecSet1(y2));
+        acc = AudioVecMulAdd(acc, coeffs[AUDIO_VEC_WIDTH + 3], AudioVecSet1(y1));
+        x2 = block[AUDIO_VEC_WIDTH - 2];
+        x1 = block[AUDIO_VEC_WIDTH - 1];
+        AudioVecStore(block, acc);
+        y2 = block[AUDIO_VEC_WIDTH - 2];
+        y1 = block[AUDIO_VEC_WIDTH - 1];
+    }
+    stage->x1[channel] = x1;
+    stage->x2[channel] = x2;
+    stage->y1[channel] = y1;
+    stage->y2[channel] = y2;
+    return i;
+}
+#endif
+
+static void AudioBiquadProcess(AudioStage *stage, float *const *planes, unsigned channels, size_t frames, bool simd) {
+    for (unsigned c = 0; c < channels; c++) {
+        size_t start = 0;
+#if AUDIO_PREPROCESS_SIMD
+        if (simd) {
+            start = AudioBiquadProcessChannel_SIMD(stage, planes[c], frames, c);
+        }
+#endif
+        AudioBiquadProcessChannel_C(stage, planes[c], frames, c, start);
+        // 静音输入时反馈会衰减到非规格化数，x86 上处理非常慢
+        stage->y1[c] = AudioFlushDenormal(stage->y1[c]);
+        stage->y2[c] = AudioFlushDenormal(stage->y2[c]);
+    }
+}
+
+static void AudioHighPassConfigure(AudioStage *stage, float param, unsigned sampleRate) {
+    // RBJ 二阶巴特沃斯高通，Q = 1/√2
+    double cutoff = fmin(fmax(param, 10.0), 0.45 * sampleRate);
+    double w0 = 2.0 * M_PI * cutoff / sampleRate;
+    double cosW0 = cos(w0);
+    double alpha = sin(w0) / (2.0 * M_SQRT1_2);
+    double a0 = 1.0 + alpha;
+    AudioBiquadSetCoeffs(stage, (1.0 + cosW0) / 2.0 / a0, -(1.0 + cosW0) / a0, (1.0 + cosW0) / 2.0 / a0,
+                         -2.0 * cosW0 / a0, (1.0 - alpha) / a0);
+}
+
+static void AudioDCRemovalConfigure(AudioStage *stage, float param, unsigned sampleRate) {
+    // y[n] = g (x[n] - x[n-1]) + R y[n-1]，g 使奈奎斯特频率处增益为 1
+    double timeConstant = fmax(param, 1.0) / 1000.0;
+    double pole = exp(-1.0 / (timeConstant * sampleRate));
+    double gain = (1.0 + pole) / 2.0;
+    AudioBiquadSetCoeffs(stage, gain, -gain, 0.0, -pole, 0.0);
+}
+
+// 增益
+
+static void AudioGainConfigure(AudioStage *stage, float param, unsigned sampleRate) {
+    (void)sampleRate;
+    float db = fminf(fmaxf(param, -40.0f), 40.0f);
+    stage->targetGain = powf(10.0f, db / 20.0f);
+    if (!stage->configured) {
+        stage->gain = stage->targetGain;
+    }
+}
+
+static void AudioGainProcess(AudioStage *stage, float *const *planes, unsigned channels, size_t frames, bool simd) {
+    float from = stage->gain;
+    float step = (stage->targetGain - from) / (float)frames;
+    for (unsigned c = 0; c < channels; c++) {
+        float *samples = planes[c];
+        size_t i = 0;
+#if AUDIO_PREPROCESS_SIMD
+        if (simd) {
+            float lanes[AUDIO_VEC_WIDTH];
+            for (int k = 0; k < AUDIO_VEC_WIDTH; k++) {
+                lanes[k] = from + step * (float)(k + 1);
+            }
+            AudioVec gain = AudioVecLoad(lanes);
+            AudioVec advance = AudioVecSet1(step * AUDIO_VEC_WIDTH);
+            for (; i + AUDIO_VEC_WIDTH <= frames; i += AUDIO_VEC_WIDTH) {
+                AudioVecStore(samples + i, AudioVecMul(AudioVecLoad(samples + i), gain));
+                gain = AudioVecAdd(gain, advance);
+            }
+        }
+#endif
+        for (; i < frames; i++) {
+            samples[i] *= from + step * (float)(i + 1);
+        }
+    }
+    stage->gain = stage->targetGain;
+}
+
+// 软限幅
+
+static void AudioSoftLimiterConfigure(AudioStage *stage, float param, unsigned sampleRate) {
+    (void)sampleRate;
+    float db = fminf(fmaxf(param, -24.0f), 0.0f);
+    stage->knee = powf(10.0f, db / 20.0f);
+}
+
+/// 拐点以上的部分 e 压缩为 e / (1 + e / (1 - knee))：斜率从 1 平滑下降，输出渐近满幅
+static inline float AudioSoftLimit(float x, float knee, float inverseHeadroom) {
+    float magnitude = fabsf(x);
+    float excess = fmaxf(magnitude - knee, 0.0f);
+    float limited = fminf(magnitude, knee) + excess / (1.0f + excess * inverseHeadroom);
+    return copysignf(limited, x);
+}
+
+static void AudioSoftLimiterProcess(AudioStage *stage, float *const *planes, unsigned channels, size_t frames,
+                                    bool simd) {
+    float knee = stage->knee;
+    if (knee >= 1.0f) {
+        // 拐点为 0 dBFS 时退化为转换回 S16 时的硬削波
+        return;
+    }
+    float inverseHeadroom = 1.0f / (1.0f - knee);
+    for (unsigned c = 0; c < channels; c++) {
+        float *samples = planes[c];
+        size_t i = 0;
+#if AUDIO_PREPROCESS_SIMD
+        if (simd) {
+            AudioVec kneeVec = AudioVecSet1(knee);
+            AudioVec inverseVec = AudioVecSet1(inverseHeadroom);
+            AudioVec one = AudioVecSet1(1.0f);
+            AudioVec zero = AudioVecSet1(0.0f);
+            for (; i + AUDIO_VEC_WIDTH <= frames; i += AUDIO_VEC_WIDTH) {
+                AudioVec x = AudioVecLoad(samples + i);
+                AudioVec magnitude = AudioVecAbs(x);
+                AudioVec excess = AudioVecMax(AudioVecSub(magnitude, kneeVec), zero);
+                AudioVec limited = AudioVecAdd(AudioVecMin(magnitude, kneeVec),
+                                               AudioVecDiv(excess, AudioVecMulAdd(one, excess, inverseVec)));
+                AudioVecStore(samples + i, AudioVecCopySign(limited, x));
+            }
+        }
+#endif
+        for (; i < frames; i++) {
+            samples[i] = AudioSoftLimit(samples[i], knee, inverseHeadroom);
+        }
+    }
+}
+
+// 处理级表
+
+static const AudioStageOps AudioStageOpsTable[AudioStageTypeCount] = {
+    [AudioStageHighPass] = {80.0f, AudioHighPassConfigure, AudioBiquadProcess},
+    [AudioStageGain] = {0.0f, AudioGainConfigure, AudioGainProcess},
+    [AudioStageSoftLimiter] = {-1.0f, AudioSoftLimiterConfigure, AudioSoftLimiterProcess},
+    [AudioStageDCRemoval] = {200.0f, AudioDCRemovalConfigure, AudioBiquadProcess},
+};
+
+// S16 与 float 转换
+
+static const float AudioS16Scale = 1.0f / 32768.0f;
+
+static inline int16_t AudioFloatToS16(float value) {
+    float scaled = value * 32768.0f;
+    if (scaled >= 32767.0f) {
+        return INT16_MAX;
+    }
+    if (scaled <= -32768.0f) {
+        return INT16_MIN;
+    }
+    return (int16_t)lrintf(scaled);
+}
+
+/// 交错 S16 拆分为各声道 float
+static void AudioDeinterleaveS16(const int16_t *src, size_t frames, unsigned channels, float *const *planes,
+                                 bool simd) {
+    size_t i = 0;
+    if (channels == 1) {
+        float *mono = planes[0];
+#if AUDIO_PREPROCESS_NEON
+        if (simd) {
+            float32x4_t scale = vdupq_n_f32(AudioS16Scale);
+            for (; i + 8 <= frames; i += 8) {
+                int16x8_t v = vld1q_s16(src + i);
+                vst1q_f32(mono + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+                vst1q_f32(mono + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+            }
+        }
+#elif AUDIO_PREPROCESS_X86
+        if (simd) {
+            __m128 scale = _mm_set1_ps(AudioS16Scale);
+            for (; i + 8 <= frames; i += 8) {
+                __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+                // 放到 32 位高半部分再算术右移，完成符号扩展
+                __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+                __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+                _mm_storeu_ps(mono + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+                _mm_storeu_ps(mono + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+            }
+        }
+#endif
+        for (; i < frames; i++) {
+            mono[i] = src[i] * AudioS16Scale;
+        }
+        return;
+    }
+    float *left = planes[0];
+    float *right = planes[1];
+#if AUDIO_PREPROCESS_NEON
+    if (simd) {
+        float32x4_t scale = vdupq_n_f32(AudioS16Scale);
+        for (; i + 8 <= frames; i += 8) {
+            int16x8x2_t v = vld2q_s16(src + 2 * i);
+            vst1q_f32(left + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[0]))), scale));
+            vst1q_f32(left + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[0]))), scale));
+            vst1q_f32(right + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[1]))), scale));
+            vst1q_f32(right + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[1]))), scale));
+        }
+    }
+#elif AUDIO_PREPROCESS_X86
+    if (simd) {
+        __m128 scale = _mm_set1_ps(AudioS16Scale);
+        for (; i + 4 <= frames; i += 4) {
+            // 每个 32 位元素为一帧：低 16 位 L，高 16 位 R
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+            __m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+            __m128i r = _mm_srai_epi32(v, 16);
+            _mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(l), scale));
+            _mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), scale));
+        }
+    }
+#endif
+    for (; i < frames; i++) {
+        left[i] = src[2 * i] * AudioS16Scale;
+        right[i] = src[2 * i + 1] * AudioS16Scale;
+    }
+}
+
+/// 各声道 float 合并为交错 S16，饱和到 [-32768, 32767]
+static void AudioInterleaveS16(float *const *planes, size_t frames, unsigned channels, int16_t *dst, bool simd) {
+    size_t i = 0;
+    if (channels == 1) {
+        const float *mono = planes[0];
+#if AUDIO_PREPROCESS_NEON
+        if (simd) {
+            float32x4_t scale = vdupq_n_f32(32768.0f);
+            for (; i + 8 <= frames; i += 8) {
+                int32x4_t lo = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(mono + i), scale));
+                int32x4_t hi = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(mono + i + 4), scale));
+                vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+            }
+        }
+#elif AUDIO_PREPROCESS_X86
+        if (simd) {
+            __m128 scale = _mm_set1_ps(32768.0f);
+            for (; i + 8 <= frames; i += 8) {
+                __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(mono + i), scale));
+                __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(mono + i + 4), scale));
+                _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+            }
+        }
+#endif
+        for (; i < frames; i++) {
+            dst[i] = AudioFloatToS16(mono[i]);
+        }
+        return;
+    }
+    const float *left = planes[0];
+    const float *right = planes[1];
+#if AUDIO_PREPROCESS_NEON
+    if (simd) {
+        float32x4_t scale = vdupq_n_f32(32768.0f);
+        for (; i + 8 <= frames; i += 8) {
+            int16x8x2_t v;
+            v.val[0] = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(left + i), scale))),
+                                    vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(left + i + 4), scale))));
+            v.val[1] = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(right + i), scale))),
+                                    vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(right + i + 4), scale))));
+            vst2q_s16(dst + 2 * i, v);
+        }
+    }
+#elif AUDIO_PREPROCESS_X86
+    if (simd) {
+        __m128 scale = _mm_set1_ps(32768.0f);
+        for (; i + 8 <= frames; i += 8) {
+            __m128i l = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(left + i), scale)),
+                                        _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(left + i + 4), scale)));
+            __m128i r = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(right + i), scale)),
+                                        _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(right + i + 4), scale)));
+            _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi16(l, r));
+            _mm_storeu_si128((__m128i *)(dst + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+        }
+    }
+#endif
+    for (; i < frames; i++) {
+        dst[2 * i] = AudioFloatToS16(left[i]);
+        dst[2 * i + 1] = AudioFloatToS16(right[i]);
+    }
+}
+
+// 处理链
+
+AudioPreprocessChain *AudioPreprocessChainCreate(const AudioStageType *stages, size_t count) {
+    if (!stages || count == 0 || count > AUDIO_PREPROCESS_MAX_STAGES) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if ((unsigned)stages[i] >= AudioStageTypeCount) {
+            return NULL;
+        }
+    }
+    AudioPreprocessChain *chain = calloc(1, sizeof(AudioPreprocessChain));
+    if (!chain) {
+        return NULL;
+    }
+    chain->count = count;
+    for (size_t i = 0; i < count; i++) {
+        AudioStage *stage = &chain->stages[i];
+        stage->type = stages[i];
+        stage->ops = &AudioStageOpsTable[stages[i]];
+        atomic_init(&stage->enabled, true);
+        atomic_init(&stage->param, stage->ops->defaultParam);
+    }
+    atomic_init(&chain->scalarOnly, false);
+    return chain;
+}
+
+void AudioPreprocessChainDestroy(AudioPreprocessChain *chain) {
+    free(chain);
+}
+
+size_t AudioPreprocessChainStageCount(const AudioPreprocessChain *chain) {
+    return chain->count;
+}
+
+AudioStageType AudioPreprocessChainStageType(const AudioPreprocessChain *chain, size_t index) {
+    return chain->stages[index].type;
+}
+
+bool AudioPreprocessChainSetStageEnabled(AudioPreprocessChain *chain, size_t index, bool enabled) {
+    if (index >= chain->count) {
+        return false;
+    }
+    atomic_store_explicit(&chain->stages[index].enabled, enabled, memory_order_relaxed);
+    return true;
+}
+
+bool AudioPreprocessChainSetStageParam(AudioPreprocessChain *chain, size_t index, float value) {
+    if (index >= chain->count || !isfinite(value)) {
+        return false;
+    }
+    atomic_store_explicit(&chain->stages[index].param, value, memory_order_relaxed);
+    return true;
+}
+
+void AudioPreprocessChainSetScalarOnly(AudioPreprocessChain *chain, bool scalarOnly) {
+    atomic_store_explicit(&chain->scalarOnly, scalarOnly, memory_order_relaxed);
+}
+
+/// 采样率或声道数变化后所有级重新配置并清空状态
+static void AudioPreprocessChainReset(AudioPreprocessChain *chain, unsigned sampleRate, unsigned channels) {
+    chain->sampleRate = sampleRate;
+    chain->channels = channels;
+    for (size_t i = 0; i < chain->count; i++) {
+        AudioStage *stage = &chain->stages[i];
+        AudioBiquadReset(stage);
+        stage->configured = false;
+    }
+}
+
+void AudioPreprocessChainProcessS16(AudioPreprocessChain *chain, int16_t *samples, size_t frames,
+                                    unsigned channels, unsigned sampleRate) {
+    if (!chain || !samples || frames == 0 || channels == 0 || channels > AUDIO_PREPROCESS_MAX_CHANNELS ||
+        sampleRate == 0) {
+        return;
+    }
+    if (sampleRate != chain->sampleRate || channels != chain->channels) {
+        AudioPreprocessChainReset(chain, sampleRate, channels);
+    }
+    bool simd = AUDIO_PREPROCESS_SIMD && !atomic_load_explicit(&chain->scalarOnly, memory_order_relaxed);
+
+    AudioStage *active[AUDIO_PREPROCESS_MAX_STAGES];
+    size_t activeCount = 0;
+    for (size_t i = 0; i < chain->count; i++) {
+        AudioStage *stage = &chain->stages[i];
+        if (!atomic_load_explicit(&stage->enabled, memory_order_relaxed)) {
+            continue;
+        }
+        float param = atomic_load_explicit(&stage->param, memory_order_relaxed);
+        if (!stage->configured || param != stage->appliedParam) {
+            stage->ops->configure(stage, param, sampleRate);
+            stage->appliedParam = param;
+            stage->configured = true;
+        }
+        active[activeCount++] = stage;
+    }
+    if (activeCount == 0) {
+        return;
+    }
+
+    float *planes[AUDIO_PREPROCESS_MAX_CHANNELS] = {chain->scratch[0], chain->scratch[1]};
+    for (size_t offset = 0; offset < frames; offset += AUDIO_PREPROCESS_BLOCK_FRAMES) {
+        size_t blockFrames = frames - offset;
+        if (blockFrames > AUDIO_PREPROCESS_BLOCK_FRAMES) {
+            blockFrames = AUDIO_PREPROCESS_BLOCK_FRAMES;
+        }
+        int16_t *block = samples + offset * channels;
+        AudioDeinterleaveS16(block, blockFrames, channels, planes, simd);
+        for (size_t i = 0; i < activeCount; i++) {
+            active[i]->ops->process(active[i], planes, channels, blockFrames, simd);
+        }
+        AudioInterleaveS16(planes, blockFrames, channels, block, simd);
+    }
+}
+
+// 基准测试
+
+static uint64_t AudioPreprocessNowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+double AudioPreprocessChainBenchmark(AudioPreprocessChain *chain, unsigned sampleRate, unsigned channels,
+                                     size_t iterations) {
+    if (!chain || sampleRate == 0 || channels == 0 || channels > AUDIO_PREPROCESS_MAX_CHANNELS || iterations == 0) {
+        return 0;
+    }
+    size_t frames = sampleRate / 100;
+    size_t count = frames * channels;
+    int16_t *source = malloc(count * sizeof(int16_t));
+    int16_t *work = malloc(count * sizeof(int16_t));
+    if (!source || !work) {
+        free(source);
+        free(work);
+        return 0;
+    }
+    // 1 kHz 正弦 + 50 Hz 工频 + 直流偏移，峰值接近满幅以触发限幅
+    for (size_t i = 0; i < frames; i++) {
+        double t = (double)i / sampleRate;
+        double value = 0.6 * sin(2.0 * M_PI * 1000.0 * t) + 0.3 * sin(2.0 * M_PI * 50.0 * t) + 0.05;
+        for (unsigned c = 0; c < channels; c++) {
+            source[i * channels + c] = (int16_t)lrint(value * 32767.0);
+        }
+    }
+    size_t warmup = iterations < 100 ? iterations : 100;
+    for (size_t i = 0; i < warmup; i++) {
+        memcpy(work, source, count * sizeof(int16_t));
+        AudioPreprocessChainProcessS16(chain, work, frames, channels, sampleRate);
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        memcpy(work, source, count * sizeof(int16_t));
+        uint64_t start = AudioPreprocessNowNs();
+        AudioPreprocessChainProcessS16(chain, work, frames, channels, sampleRate);
+        total += AudioPreprocessNowNs() - start;
+    }
+    free(source);
+    free(work);
+    return (double)total / (double)iterations;
+}
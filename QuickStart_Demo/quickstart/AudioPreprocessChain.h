@@ -0,0 +1,77 @@
+//
+//  AudioPreprocessChain.h
+//  quickstart
+//
+//  本地采集音频前处理链：高通、增益、软限幅、去直流
+//
+
+#ifndef AudioPreprocessChain_h
+#define AudioPreprocessChain_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 最多级数
+#define AUDIO_PREPROCESS_MAX_STAGES 8
+/// 最多声道数
+#define AUDIO_PREPROCESS_MAX_CHANNELS 2
+
+/// 处理级类型，新增类型时在 AudioPreprocessChain.c 中补充默认参数与处理函数
+typedef enum {
+    AudioStageHighPass = 0,     // 二阶巴特沃斯高通，参数为截止频率（Hz），默认 80
+    AudioStageGain,             // 增益，参数为 dB，默认 0，变化时在一个块内线性过渡
+    AudioStageSoftLimiter,      // 软限幅，参数为拐点（dBFS），默认 -1，超过拐点的部分被渐进压缩到满幅以内
+    AudioStageDCRemoval,        // 去直流，参数为直流估计的时间常数（ms），默认 200
+    AudioStageTypeCount
+} AudioStageType;
+
+typedef struct AudioPreprocessChain AudioPreprocessChain;
+
+/// 创建处理链，各级按数组顺序执行
+/// @note 所有内存在此分配，处理时不再分配内存
+/// @return count 为 0、超过 AUDIO_PREPROCESS_MAX_STAGES 或类型非法时返回 NULL
+AudioPreprocessChain *AudioPreprocessChainCreate(const AudioStageType *stages, size_t count);
+
+void AudioPreprocessChainDestroy(AudioPreprocessChain *chain);
+
+/// 级数
+size_t AudioPreprocessChainStageCount(const AudioPreprocessChain *chain);
+
+/// 第 index 级的类型
+AudioStageType AudioPreprocessChainStageType(const AudioPreprocessChain *chain, size_t index);
+
+/// 开关第 index 级（默认开启），可在任意线程调用，下一块生效
+/// @return index 越界时返回 false
+bool AudioPreprocessChainSetStageEnabled(AudioPreprocessChain *chain, size_t index, bool enabled);
+
+/// 设置第 index 级的参数，含义见 AudioStageType，可在任意线程调用，下一块生效
+/// @return index 越界时返回 false
+bool AudioPreprocessChainSetStageParam(AudioPreprocessChain *chain, size_t index, float value);
+
+/// 只使用标量实现，用于校验与对比 SIMD 实现，默认 false
+void AudioPreprocessChainSetScalarOnly(AudioPreprocessChain *chain, bool scalarOnly);
+
+/// 原地处理 S16 交错 PCM，只在音频线程调用
+/// @param samples PCM 数据，多声道按 LRLR 交错
+/// @param frames 每声道采样点数
+/// @param channels 声道数，超过 AUDIO_PREPROCESS_MAX_CHANNELS 时不处理
+/// @param sampleRate 采样率，与上次不同时重置各级状态
+void AudioPreprocessChainProcessS16(AudioPreprocessChain *chain, int16_t *samples, size_t frames,
+                                    unsigned channels, unsigned sampleRate);
+
+/// 用合成信号测量处理一个 10ms 音频帧的平均耗时
+/// @note 会改变各级内部状态，不要对正在使用的处理链调用
+/// @return 每帧纳秒数
+double AudioPreprocessChainBenchmark(AudioPreprocessChain *chain, unsigned sampleRate, unsigned channels,
+                                     size_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AudioPreprocessChain_h */
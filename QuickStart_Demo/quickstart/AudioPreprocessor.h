@@ -0,0 +1,52 @@
+//
+//  AudioPreprocessor.h
+//  quickstart
+//
+//  本地采集音频前处理
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "AudioPreprocessChain.h"
+#import "ActiveSpeakerMonitor.h"
+#import "LocalStreamRecorder.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 在 onProcessRecordAudioFrame: 中对采集音频执行 AudioPreprocessChain，结果写入自有缓冲后替换音频帧的 buffer
+/// @note 注册后需调用 enableAudioProcessor:audioFormat: 选择 ByteRTCAudioFrameProcessorRecord。
+///       音频帧不超过 100ms 时音频线程中不分配内存，参数可在任意线程修改，下一帧生效。
+@interface AudioPreprocessor : NSObject <ByteRTCAudioFrameProcessor>
+
+/// 各级按数组顺序执行
+/// @param stages AudioStageType 数组，元素为 NSNumber
+/// @return 级数为 0、超过 AUDIO_PREPROCESS_MAX_STAGES 或类型非法时返回 nil
+- (nullable instancetype)initWithStages:(NSArray<NSNumber *> *)stages NS_DESIGNATED_INITIALIZER;
+
+/// 默认处理链：高通 80Hz → 增益 0dB → 软限幅 -1dBFS → 去直流 200ms
+- (instancetype)init;
+
+/// 级数
+@property (nonatomic, assign, readonly) NSUInteger stageCount;
+
+/// 开关整个处理链，默认 YES；关闭时不修改音频
+@property (atomic, assign) BOOL enabled;
+
+/// 开关第 index 级
+- (BOOL)setStageAtIndex:(NSUInteger)index enabled:(BOOL)enabled;
+
+/// 设置第 index 级的参数，含义见 AudioStageType
+- (BOOL)setStageAtIndex:(NSUInteger)index param:(float)param;
+
+/// 第一个指定类型的级的下标，不存在时返回 NSNotFound
+- (NSUInteger)indexOfStageType:(AudioStageType)type;
+
+/// 远端用户音量统计，需同时选择 ByteRTCAudioFrameProcessorRemoteUser；远端音频不做前处理
+@property (nonatomic, strong, nullable) ActiveSpeakerMonitor *speakerMonitor;
+
+/// 本地录制，接收前处理后的采集音频（处理链关闭时为原始采集音频）；可在录制开始、结束时修改
+@property (atomic, strong, nullable) LocalStreamRecorder *recorder;
+
+@end
+
+NS_ASSUME_NONNULL_END
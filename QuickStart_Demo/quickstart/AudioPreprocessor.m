@@ -0,0 +1,115 @@
+//
+//  AudioPreprocessor.m
+//  quickstart
+//
+
+#import "AudioPreprocessor.h"
+
+/// 预分配的处理缓冲可容纳的音频时长（毫秒），更长的帧到来时才扩容
+static const NSUInteger kAudioBufferPreallocatedMs = 100;
+
+@interface AudioPreprocessor () {
+    AudioPreprocessChain *_chain;
+    /// 处理后的采集音频，只在音频线程访问
+    NSMutableData *_processedBuffer;
+}
+
+@end
+
+@implementation AudioPreprocessor
+
+- (instancetype)init {
+    return [self initWithStages:@[@(AudioStageHighPass), @(AudioStageGain), @(AudioStageSoftLimiter), @(AudioStageDCRemoval)]];
+}
+
+- (nullable instancetype)initWithStages:(NSArray<NSNumber *> *)stages {
+    self = [super init];
+    if (self) {
+        AudioStageType types[AUDIO_PREPROCESS_MAX_STAGES];
+        if (stages.count == 0 || stages.count > AUDIO_PREPROCESS_MAX_STAGES) {
+            return nil;
+        }
+        for (NSUInteger i = 0; i < stages.count; i++) {
+            types[i] = (AudioStageType)stages[i].integerValue;
+        }
+        _chain = AudioPreprocessChainCreate(types, stages.count);
+        if (!_chain) {
+            return nil;
+        }
+        // 48kHz 双声道
+        _processedBuffer = [NSMutableData dataWithCapacity:48 * kAudioBufferPreallocatedMs * 2 * sizeof(int16_t)];
+        _enabled = YES;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    AudioPreprocessChainDestroy(_chain);
+}
+
+- (NSUInteger)stageCount {
+    return AudioPreprocessChainStageCount(_chain);
+}
+
+- (BOOL)setStageAtIndex:(NSUInteger)index enabled:(BOOL)enabled {
+    return AudioPreprocessChainSetStageEnabled(_chain, index, enabled);
+}
+
+- (BOOL)setStageAtIndex:(NSUInteger)index param:(float)param {
+    return AudioPreprocessChainSetStageParam(_chain, index, param);
+}
+
+- (NSUInteger)indexOfStageType:(AudioStageType)type {
+    size_t count = AudioPreprocessChainStageCount(_chain);
+    for (size_t i = 0; i < count; i++) {
+        if (AudioPreprocessChainStageType(_chain, i) == type) {
+            return i;
+        }
+    }
+    return NSNotFound;
+}
+
+#pragma mark - ByteRTCAudioFrameProcessor
+
+- (int)onProcessRecordAudioFrame:(ByteRTCAudioFrame *)audioFrame {
+    if (self.enabled) {
+        [self processRecordAudioFrame:audioFrame];
+    }
+    // 录制的音频与发布出去的一致
+    [self.recorder appendRecordAudioFrame:audioFrame];
+    return 0;
+}
+
+- (void)processRecordAudioFrame:(ByteRTCAudioFrame *)audioFrame {
+    int channels = audioFrame.channel == ByteRTCAudioChannelStereo ? 2 : 1;
+    size_t frames = (size_t)audioFrame.samples;
+    size_t length = frames * channels * sizeof(int16_t);
+    if (frames == 0 || audioFrame.buffer.length < length || audioFrame.sampleRate <= 0) {
+        return;
+    }
+    // buffer 是不可变的 NSData，不能写入其 bytes；拷贝到自有缓冲处理后替换 buffer，SDK 在回调返回后读取
+    // 缓冲容量足够时 setLength 不重新分配
+    _processedBuffer.length = length;
+    memcpy(_processedBuffer.mutableBytes, audioFrame.buffer.bytes, length);
+    AudioPreprocessChainProcessS16(_chain, (int16_t *)_processedBuffer.mutableBytes, frames, channels, (unsigned)audioFrame.sampleRate);
+    audioFrame.buffer = _processedBuffer;
+}
+
+- (int)onProcessPlayBackAudioFrame:(ByteRTCAudioFrame *)audioFrame {
+    return 0;
+}
+
+- (int)onProcessRemoteUserAudioFrame:(ByteRTCRemoteStreamKey *)streamKey audioFrame:(ByteRTCAudioFrame *)audioFrame {
+    [self.speakerMonitor processRemoteAudioFrame:audioFrame streamKey:streamKey];
+    return 0;
+}
+
+- (int)onProcessEarMonitorAudioFrame:(ByteRTCAudioFrame *)audioFrame {
+    return 0;
+}
+
+- (int)onProcessScreenAudioFrame:(ByteRTCAudioFrame *)audioFrame {
+    return 0;
+}
+
+@end
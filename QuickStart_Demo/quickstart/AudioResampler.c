@@ -0,0 +1,408 @@
+//
+//  AudioResampler.c
+//  quickstart
+//
+
+#include "AudioResampler.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_RESAMPLER_NEON 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define AUDIO_RESAMPLER_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_RESAMPLER_SSE2 1
+#endif
+
+/// 滤波器组最大系数个数
+#define AUDIO_RESAMPLER_MAX_BANK_SIZE (1u << 20)
+/// Kaiser 窗 β，约 80dB 旁瓣衰减
+#define AUDIO_RESAMPLER_KAISER_BETA 7.857
+/// 截止频率相对于较低奈奎斯特频率的比例，通带约到 0.85，过渡带落在奈奎斯特频率附近
+#define AUDIO_RESAMPLER_CUTOFF 0.925
+
+struct AudioResampler {
+    unsigned inputRate;
+    unsigned outputRate;
+    unsigned channels;
+    /// 输出/输入 = L / M
+    unsigned upFactor;
+    unsigned downFactor;
+    size_t taps;
+    size_t maxInputFrames;
+    bool bypass;
+    _Atomic bool scalarOnly;
+
+    /// L 相，每相 taps 个系数，按输入时间正序存放，与输入窗口直接做点积
+    float *bank;
+    /// 各声道的历史 + 当前块，容量 taps - 1 + maxInputFrames
+    float *buffers[AUDIO_RESAMPLER_MAX_CHANNELS];
+    /// 缓冲区中的有效帧数
+    size_t buffered;
+    /// 下一个输出的输入窗口起点与相位
+    size_t windowStart;
+    unsigned phase;
+};
+
+static unsigned AudioResamplerGCD(unsigned a, unsigned b) {
+    while (b) {
+        unsigned t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/// 第一类零阶修正贝塞尔函数
+static double AudioResamplerBesselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    double half = x / 2.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/// 原型低通长度 N = L × taps，工作在 L × inputRate 上；第 p 相为 h[p + jL]（j = 0..taps-1）
+/// 按 y = Σ h[p + jL] x[i - j] 的顺序倒序存放，使点积的输入窗口为正序
+static void AudioResamplerDesignBank(AudioResampler *resampler) {
+    size_t up = resampler->upFactor;
+    size_t taps = resampler->taps;
+    size_t length = up * taps;
+    double nyquist = 0.5 * (resampler->inputRate < resampler->outputRate ? resampler->inputRate : resampler->outputRate);
+    // 归一化到上采样后的采样率
+    double cutoff = AUDIO_RESAMPLER_CUTOFF * nyquist / ((double)up * resampler->inputRate);
+    double center = (length - 1) / 2.0;
+    double besselBeta = AudioResamplerBesselI0(AUDIO_RESAMPLER_KAISER_BETA);
+    for (size_t p = 0; p < up; p++) {
+        float *phase = resampler->bank + p * taps;
+        double sum = 0;
+        for (size_t j = 0; j < taps; j++) {
+            size_t k = p + j * up;
+            double t = k - center;
+            double sinc = t == 0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+            double ratio = t / (center + 0.5);
+            double window = AudioResamplerBesselI0(AUDIO_RESAMPLER_KAISER_BETA * sqrt(fmax(0.0, 1.0 - ratio * ratio))) / besselBeta;
+            double value = sinc * window;
+            phase[taps - 1 - j] = (float)value;
+            sum += value;
+        }
+        // 每相单独归一化，直流增益精确为 1
+        for (size_t j = 0; j < taps; j++) {
+            phase[j] = (float)(phase[j] / sum);
+        }
+    }
+}
+
+AudioResampler *AudioResamplerCreate(unsigned inputRate, unsigned outputRate, unsigned channels,
+                                     size_t maxInputFrames, size_t tapsPerPhase) {
+    if (inputRate == 0 || outputRate == 0 || channels == 0 || channels > AUDIO_RESAMPLER_MAX_CHANNELS ||
+        maxInputFrames == 0) {
+        return NULL;
+    }
+    size_t taps = tapsPerPhase ? tapsPerPhase : AUDIO_RESAMPLER_DEFAULT_TAPS;
+    // 降采样时截止频率按输入采样率变低，保持同样的过渡带宽需要按比例加长滤波器
+    if (inputRate > outputRate) {
+        taps = (taps * inputRate + outputRate - 1) / outputRate;
+    }
+    taps = (taps + 7) & ~(size_t)7;
+    unsigned gcd = AudioResamplerGCD(inputRate, outputRate);
+    unsigned up = outputRate / gcd;
+    unsigned down = inputRate / gcd;
+    if ((size_t)up * taps > AUDIO_RESAMPLER_MAX_BANK_SIZE) {
+        return NULL;
+    }
+    AudioResampler *resampler = calloc(1, sizeof(AudioResampler));
+    if (!resampler) {
+        return NULL;
+    }
+    resampler->inputRate = inputRate;
+    resampler->outputRate = outputRate;
+    resampler->channels = channels;
+    resampler->upFactor = up;
+    resampler->downFactor = down;
+    resampler->taps = taps;
+    resampler->maxInputFrames = maxInputFrames;
+    resampler->bypass = inputRate == outputRate;
+    atomic_init(&resampler->scalarOnly, false);
+    if (!resampler->bypass) {
+        resampler->bank = malloc((size_t)up * taps * sizeof(float));
+        bool allocated = resampler->bank != NULL;
+        for (unsigned c = 0; c < channels; c++) {
+            resampler->buffers[c] = malloc((taps - 1 + maxInputFrames) * sizeof(float));
+            allocated = allocated && resampler->buffers[c];
+        }
+        if (!allocated) {
+            AudioResamplerDestroy(resampler);
+            return NULL;
+        }
+        AudioResamplerDesignBank(resampler);
+    }
+    AudioResamplerReset(resampler);
+    return resampler;
+}
+
+void AudioResamplerDestroy(AudioResampler *resampler) {
+    if (!resampler) {
+        return;
+    }
+    free(resampler->bank);
+    for (unsigned c = 0; c < AUDIO_RESAMPLER_MAX_CHANNELS; c++) {
+        free(resampler->buffers[c]);
+    }
+    free(resampler);
+}
+
+void AudioResamplerReset(AudioResampler *resampler) {
+    if (resampler->bypass) {
+        return;
+    }
+    // 以 taps - 1 帧静音作为初始历史
+    for (unsigned c = 0; c < resampler->channels; c++) {
+        memset(resampler->buffers[c], 0, (resampler->taps - 1) * sizeof(float));
+    }
+    resampler->buffered = resampler->taps - 1;
+    resampler->windowStart = 0;
+    resampler->phase = 0;
+}
+
+void AudioResamplerSetScalarOnly(AudioResampler *resampler, bool scalarOnly) {
+    atomic_store_explicit(&resampler->scalarOnly, scalarOnly, memory_order_relaxed);
+}
+
+size_t AudioResamplerMaxOutputFrames(const AudioResampler *resampler, size_t inputFrames) {
+    if (resampler->bypass) {
+        return inputFrames;
+    }
+    // 历史中最多还有 taps - 1 帧未消费的输入
+    size_t available = inputFrames + resampler->taps;
+    return available * resampler->upFactor / resampler->downFactor + 1;
+}
+
+double AudioResamplerDelayInputFrames(const AudioResampler *resampler) {
+    if (resampler->bypass) {
+        return 0;
+    }
+    return ((double)resampler->upFactor * resampler->taps - 1) / 2.0 / resampler->upFactor;
+}
+
+// 点积
+
+static inline float AudioResamplerDot_C(const float *coeffs, const float *samples, size_t taps) {
+    float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    for (size_t i = 0; i < taps; i += 4) {
+        sum0 += coeffs[i] * samples[i];
+        sum1 += coeffs[i + 1] * samples[i + 1];
+        sum2 += coeffs[i + 2] * samples[i + 2];
+        sum3 += coeffs[i + 3] * samples[i + 3];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/// taps 为 8 的倍数，无需处理尾部
+static inline float AudioResamplerDot(const float *coeffs, const float *samples, size_t taps) {
+#if AUDIO_RESAMPLER_NEON
+    float32x4_t sum0 = vdupq_n_f32(0), sum1 = vdupq_n_f32(0);
+    for (size_t i = 0; i < taps; i += 8) {
+        sum0 = vfmaq_f32(sum0, vld1q_f32(coeffs + i), vld1q_f32(samples + i));
+        sum1 = vfmaq_f32(sum1, vld1q_f32(coeffs + i + 4), vld1q_f32(samples + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(sum0, sum1));
+#elif AUDIO_RESAMPLER_AVX2
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= taps; i += 16) {
+#if defined(__FMA__)
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(coeffs + i), _mm256_loadu_ps(samples + i), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(coeffs + i + 8), _mm256_loadu_ps(samples + i + 8), sum1);
+#else
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(coeffs + i), _mm256_loadu_ps(samples + i)));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(coeffs + i + 8), _mm256_loadu_ps(samples + i + 8)));
+#endif
+    }
+    if (i < taps) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(coeffs + i), _mm256_loadu_ps(samples + i)));
+    }
+    __m256 sum = _mm256_add_ps(sum0, sum1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    return _mm_cvtss_f32(half);
+#elif AUDIO_RESAMPLER_SSE2
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    for (size_t i = 0; i < taps; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coeffs + i), _mm_loadu_ps(samples + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(coeffs + i + 4), _mm_loadu_ps(samples + i + 4)));
+    }
+    __m128 sum = _mm_add_ps(sum0, sum1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#else
+    return AudioResamplerDot_C(coeffs, samples, taps);
+#endif
+}
+
+// 处理
+
+typedef enum {
+    AudioResamplerFormatS16,
+    AudioResamplerFormatFloat,
+} AudioResamplerFormat;
+
+static inline int16_t AudioResamplerFloatToS16(float value) {
+    float scaled = value * 32768.0f;
+    if (scaled >= 32767.0f) {
+        return INT16_MAX;
+    }
+    if (scaled <= -32768.0f) {
+        return INT16_MIN;
+    }
+    return (int16_t)lrintf(scaled);
+}
+
+/// 把一块交错输入追加到各声道缓冲区
+static void AudioResamplerAppend(AudioResampler *resampler, const void *input, size_t offset, size_t frames,
+                                 AudioResamplerFormat format) {
+    unsigned channels = resampler->channels;
+    for (unsigned c = 0; c < channels; c++) {
+        float *dst = resampler->buffers[c] + resampler->buffered;
+        if (format == AudioResamplerFormatS16) {
+            const int16_t *src = (const int16_t *)input + offset * channels + c;
+            for (size_t i = 0; i < frames; i++) {
+                dst[i] = src[i * channels] * (1.0f / 32768.0f);
+            }
+        } else {
+            const float *src = (const float *)input + offset * channels + c;
+            for (size_t i = 0; i < frames; i++) {
+                dst[i] = src[i * channels];
+            }
+        }
+    }
+    resampler->buffered += frames;
+}
+
+/// 用缓冲区中的数据尽可能多地输出，然后把未消费的尾部移到缓冲区开头
+static size_t AudioResamplerFilter(AudioResampler *resampler, void *output, size_t outputOffset,
+                                   AudioResamplerFormat format, bool simd) {
+    unsigned channels = resampler->channels;
+    size_t taps = resampler->taps;
+    unsigned up = resampler->upFactor;
+    unsigned down = resampler->downFactor;
+    size_t start = resampler->windowStart;
+    unsigned phase = resampler->phase;
+    size_t produced = 0;
+    while (start + taps <= resampler->buffered) {
+        const float *coeffs = resampler->bank + (size_t)phase * taps;
+        size_t index = (outputOffset + produced) * channels;
+        for (unsigned c = 0; c < channels; c++) {
+            const float *window = resampler->buffers[c] + start;
+            float value = simd ? AudioResamplerDot(coeffs, window, taps) : AudioResamplerDot_C(coeffs, window, taps);
+            if (format == AudioResamplerFormatS16) {
+                ((int16_t *)output)[index + c] = AudioResamplerFloatToS16(value);
+            } else {
+                ((float *)output)[index + c] = value;
+            }
+        }
+        produced++;
+        phase += down;
+        start += phase / up;
+        phase %= up;
+    }
+    size_t remaining = resampler->buffered > start ? resampler->buffered - start : 0;
+    size_t consumed = resampler->buffered - remaining;
+    for (unsigned c = 0; c < channels; c++) {
+        memmove(resampler->buffers[c], resampler->buffers[c] + consumed, remaining * sizeof(float));
+    }
+    resampler->buffered = remaining;
+    resampler->windowStart = start - consumed;
+    resampler->phase = phase;
+    return produced;
+}
+
+static size_t AudioResamplerProcess(AudioResampler *resampler, const void *input, size_t inputFrames,
+                                    void *output, size_t outputCapacity, AudioResamplerFormat format) {
+    if (!resampler || (!input && inputFrames > 0) || !output ||
+        outputCapacity < AudioResamplerMaxOutputFrames(resampler, inputFrames)) {
+        return 0;
+    }
+    if (resampler->bypass) {
+        size_t sampleSize = format == AudioResamplerFormatS16 ? sizeof(int16_t) : sizeof(float);
+        memcpy(output, input, inputFrames * resampler->channels * sampleSize);
+        return inputFrames;
+    }
+    bool simd = !atomic_load_explicit(&resampler->scalarOnly, memory_order_relaxed);
+    size_t produced = 0;
+    for (size_t offset = 0; offset < inputFrames; offset += resampler->maxInputFrames) {
+        size_t frames = inputFrames - offset;
+        if (frames > resampler->maxInputFrames) {
+            frames = resampler->maxInputFrames;
+        }
+        AudioResamplerAppend(resampler, input, offset, frames, format);
+        produced += AudioResamplerFilter(resampler, output, produced, format, simd);
+    }
+    return produced;
+}
+
+size_t AudioResamplerProcessS16(AudioResampler *resampler, const int16_t *input, size_t inputFrames,
+                                int16_t *output, size_t outputCapacity) {
+    return AudioResamplerProcess(resampler, input, inputFrames, output, outputCapacity, AudioResamplerFormatS16);
+}
+
+size_t AudioResamplerProcessFloat(AudioResampler *resampler, const float *input, size_t inputFrames,
+                                  float *output, size_t outputCapacity) {
+    return AudioResamplerProcess(resampler, input, inputFrames, output, outputCapacity, AudioResamplerFormatFloat);
+}
+
+// 基准测试
+
+static uint64_t AudioResamplerNowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+double AudioResamplerBenchmark(AudioResampler *resampler, size_t iterations) {
+    if (!resampler || iterations == 0) {
+        return 0;
+    }
+    size_t frames = resampler->inputRate / 100;
+    size_t outputFrames = AudioResamplerMaxOutputFrames(resampler, frames);
+    int16_t *input = malloc(frames * resampler->channels * sizeof(int16_t));
+    int16_t *output = malloc(outputFrames * resampler->channels * sizeof(int16_t));
+    if (!input || !output) {
+        free(input);
+        free(output);
+        return 0;
+    }
+    for (size_t i = 0; i < frames; i++) {
+        double value = 0.5 * sin(2.0 * M_PI * 997.0 * i / resampler->inputRate);
+        for (unsigned c = 0; c < resampler->channels; c++) {
+            input[i * resampler->channels + c] = (int16_t)lrint(value * 32767.0);
+        }
+    }
+    size_t warmup = iterations < 100 ? iterations : 100;
+    for (size_t i = 0; i < warmup; i++) {
+        AudioResamplerProcessS16(resampler, input, frames, output, outputFrames);
+    }
+    uint64_t start = AudioResamplerNowNs();
+    for (size_t i = 0; i < iterations; i++) {
+        AudioResamplerProcessS16(resampler, input, frames, output, outputFrames);
+    }
+    uint64_t elapsed = AudioResamplerNowNs() - start;
+    free(input);
+    free(output);
+    return (double)elapsed / (double)iterations;
+}
@@ -0,0 +1,67 @@
+//
+//  AudioResampler.h
+//  quickstart
+//
+//  多相 FIR 采样率转换（16k / 44.1k / 48k 等 AudioSampleRate 之间）
+//
+
+#ifndef AudioResampler_h
+#define AudioResampler_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 最多声道数
+#define AUDIO_RESAMPLER_MAX_CHANNELS 2
+/// 每相默认抽头数，约 70dB 阻带衰减
+#define AUDIO_RESAMPLER_DEFAULT_TAPS 64
+
+typedef struct AudioResampler AudioResampler;
+
+/// 创建采样率转换器，按 inputRate / outputRate 的最简比 M / L 预先计算 L 相滤波器组
+/// @note 所有内存在此分配，处理时不再分配内存
+/// @param maxInputFrames 单次 Process 的最大输入帧数，更长的输入在内部分块处理
+/// @param tapsPerPhase 每相抽头数，传 0 使用 AUDIO_RESAMPLER_DEFAULT_TAPS；降采样时按 inputRate / outputRate 加长，并向上取整到 8 的倍数
+/// @return 参数非法或滤波器组过大（L × 抽头数超过 2^20）时返回 NULL
+AudioResampler *AudioResamplerCreate(unsigned inputRate, unsigned outputRate, unsigned channels,
+                                     size_t maxInputFrames, size_t tapsPerPhase);
+
+void AudioResamplerDestroy(AudioResampler *resampler);
+
+/// 清空历史数据，下一次处理从静音开始
+void AudioResamplerReset(AudioResampler *resampler);
+
+/// 只使用标量实现，用于校验与对比 SIMD 实现，默认 false
+void AudioResamplerSetScalarOnly(AudioResampler *resampler, bool scalarOnly);
+
+/// 输入 inputFrames 帧时最多输出的帧数，Process 的输出缓冲区不能小于此值
+size_t AudioResamplerMaxOutputFrames(const AudioResampler *resampler, size_t inputFrames);
+
+/// 滤波器群延迟（输入帧）
+double AudioResamplerDelayInputFrames(const AudioResampler *resampler);
+
+/// 转换 S16 交错 PCM，状态在多次调用之间保留，可按任意帧长流式输入
+/// @param outputCapacity 输出缓冲区帧数，小于 AudioResamplerMaxOutputFrames 时不处理并返回 0
+/// @return 输出帧数
+size_t AudioResamplerProcessS16(AudioResampler *resampler, const int16_t *input, size_t inputFrames,
+                                int16_t *output, size_t outputCapacity);
+
+/// 同 AudioResamplerProcessS16，输入输出为 [-1, 1] 的 float 交错 PCM，输出不做饱和
+size_t AudioResamplerProcessFloat(AudioResampler *resampler, const float *input, size_t inputFrames,
+                                  float *output, size_t outputCapacity);
+
+/// 用合成信号测量转换一个 10ms 输入帧的平均耗时
+/// @note 会改变内部状态，不要对正在使用的转换器调用
+/// @return 每帧纳秒数
+double AudioResamplerBenchmark(AudioResampler *resampler, size_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AudioResampler_h */
@@ -7,11 +7,61 @@
 
 #import <Foundation/Foundation.h>
 #import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "FaceDetectionStage.h"
+#import "FrameBudgetGovernor.h"
+#import "FaceLandmarkSender.h"
+#import "LocalSnapshotter.h"
+#import "RoomStatsCollector.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// 人脸跟踪与渲染的执行方式
+/// @note FURenderKit 的跟踪与渲染共用同一个上下文，不能在两个线程上并发调用，
+///       因此异步模式只能使用 FURenderKit 内部的异步跟踪（asyncTrackFace），由 SDK 决定跟踪线程与结果的新旧
+typedef NS_ENUM(NSInteger, CustomProcessorPipelineMode) {
+    CustomProcessorPipelineModeSerial = 0,      // 跟踪与渲染在采集线程串行执行
+    CustomProcessorPipelineModeAsyncTrack,      // 开启 FURenderKit 内部异步人脸跟踪，渲染使用最近一次完成的跟踪结果
+};
+
 @interface CustomProcessor : NSObject <ByteRTCVideoProcessorDelegate>
 
+/// 是否零拷贝输出 FURenderKit 渲染结果的 buffer（默认 YES），关闭时在采集帧上原地渲染
+/// @note 可在任意线程设置，缓存池在下一帧处理时于处理线程释放
+@property (atomic, assign) BOOL usePooledOutput;
+
+/// 跟踪模式，默认串行；异步跟踪对帧率与点位延迟的影响随机型与效果不同，需用 FUTestRecorder 实测后再按机型开启
+@property (nonatomic, assign) CustomProcessorPipelineMode pipelineMode;
+
+/// 关闭效果时人脸检测使用的分辨率，默认 FaceDetectionScaleFull（不检测）
+/// @note 开启渲染时检测由 FURenderKit 在原图上完成
+@property (nonatomic, assign) FaceDetectionScale detectionScale;
+
+/// 低分辨率检测阶段，detectionScale 为 FaceDetectionScaleFull 时为 nil；点位已映射回原图坐标
+@property (nonatomic, strong, readonly, nullable) FaceDetectionStage *detectionStage;
+
+/// 人脸点位 SEI 发送，为 nil 时不发送；每帧在检测或渲染之后读取跟踪结果
+@property (atomic, strong, nullable) FaceLandmarkSender *landmarkSender;
+
+/// 处理后画面截图，为 nil 时不截图；用 captureNextFrames:scale: 请求截取接下来的若干帧
+@property (atomic, strong, nullable) LocalSnapshotter *snapshotter;
+
+/// 房间统计，为 nil 时不记录；每帧记录处理、渲染与跟踪耗时
+@property (atomic, strong, nullable) RoomStatsCollector *statsCollector;
+
+/// 第一帧处理完成后在后台队列调用一次，可为 nil；启动追踪以第一帧处理完成为终点
+@property (atomic, copy, nullable) dispatch_block_t firstFrameHandler;
+
+/// 帧耗时预算控制，未开启时为 nil；开启或关闭后在下一帧处理结束时生效
+@property (atomic, strong, readonly, nullable) FrameBudgetGovernor *budgetGovernor;
+
+/// 完整效果下的人脸检测间隔（帧），默认 7
+/// @note FURenderKit 只提供设置接口、无法读取当前值，开启帧耗时预算时以此值显式设置，最低档时加倍
+@property (nonatomic, assign) int baseDetectInterval;
+
+/// 开启帧耗时预算控制，处理耗时超出编码帧率对应的预算时逐档降低效果质量
+/// @note 收到 FUDemoEffectDidChangeNotification 后在下一帧回到完整效果重新评估
+/// @param frameRate 编码帧率，传 0 关闭
+- (void)enableFrameBudgetWithFrameRate:(NSInteger)frameRate;
 
 @end
 
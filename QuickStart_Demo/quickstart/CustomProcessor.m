@@ -8,19 +8,193 @@
 #import "CustomProcessor.h"
 #import "FUDemoManager.h"
 #import "FUTestRecorder.h"
+#import "VideoFramePool.h"
+#import "FaceDetectionStage.h"
+#import "FUAIModelLoader.h"
+#import "SpanTracer.h"
 
-@implementation CustomProcessor
+#include <stdatomic.h>
+
+/// RTC 视频帧旋转角度对应的 FU 图像朝向
+static inline FUImageOrientation FUImageOrientationFromRotation(ByteRTCVideoRotation rotation) {
+    switch (rotation) {
+        case ByteRTCVideoRotation0:
+            return FUImageOrientationDown;
+        case ByteRTCVideoRotation90:
+            return FUImageOrientationLeft;
+        case ByteRTCVideoRotation180:
+            return FUImageOrientationUP;
+        case ByteRTCVideoRotation270:
+            return FUImageOrientationRight;
+    }
+    return FUImageOrientationDown;
+}
+
+@interface CustomProcessor ()
+
+/// 输出帧缓存池
+@property (nonatomic, strong) VideoFramePool *framePool;
+
+/// 关闭零拷贝输出后由处理线程释放缓存池
+@property (atomic, assign) BOOL framePoolNeedsFlush;
+
+/// 切换效果后由处理线程重置帧耗时预算
+@property (atomic, assign) BOOL budgetNeedsReset;
+
+@property (nonatomic, strong, nullable) FaceDetectionStage *detectionStage;
+
+/// 只在处理线程替换，主线程读取档位
+@property (atomic, strong, nullable) FrameBudgetGovernor *budgetGovernor;
+
+/// enableFrameBudgetWithFrameRate: 设置的预算控制，由处理线程在下一帧结束时接管；nil 表示关闭
+@property (atomic, strong, nullable) FrameBudgetGovernor *pendingBudgetGovernor;
+
+/// pendingBudgetGovernor 待接管
+@property (atomic, assign) BOOL budgetGovernorChanged;
+
+/// 上一帧是否由低分辨率检测更新了跟踪结果
+@property (nonatomic, assign) BOOL detectedAtLowResolution;
+
+@end
+
+@implementation CustomProcessor {
+    /// 第一帧是否已开始处理，只在第一帧记录启动追踪区间
+    atomic_bool _firstFrameStarted;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _usePooledOutput = YES;
+        _baseDetectInterval = 7;
+        _detectionScale = FaceDetectionScaleFull;
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(effectDidChange:) name:FUDemoEffectDidChangeNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
 
 - (ByteRTCVideoFrame* _Nullable)processVideoFrame:(ByteRTCVideoFrame* _Nonnull)src_frame{
-    
+    if (atomic_exchange_explicit(&_firstFrameStarted, true, memory_order_relaxed)) {
+        return [self processFrame:src_frame];
+    }
+    ByteRTCVideoFrame *dst_frame = [self processFirstFrame:src_frame];
+    dispatch_block_t handler = self.firstFrameHandler;
+    if (handler) {
+        // 导出追踪等工作不占用视频处理线程
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), handler);
+    }
+    return dst_frame;
+}
+
+/// 第一帧单独记录为一个追踪区间
+- (ByteRTCVideoFrame *)processFirstFrame:(ByteRTCVideoFrame *)src_frame {
+    SPAN_TRACE_SCOPE("firstProcessVideoFrame");
+    return [self processFrame:src_frame];
+}
+
+- (ByteRTCVideoFrame *)processFrame:(ByteRTCVideoFrame *)src_frame {
     NSLog(@"----%d",src_frame.rotation);
-    [[FUDemoManager shared] checkAITrackedResult];
+    // 注册加载队列上已读取完成的 AI 模型，注册、回调与渲染在同一线程
+    [[FUAIModelLoader shareLoader] finishLoadedModels];
     if (![FUDemoManager shared].shouldRender) {
+        // 关闭效果时不渲染，仅在低分辨率图像上检测以保持检测结果可用
+        [self detectFacesAtLowResolutionInFrame:src_frame];
+        [[FUDemoManager shared] checkAITrackedResult];
+        if (self.detectionStage) {
+            [self.landmarkSender sendFacesForFrame:src_frame detectionStage:self.detectionStage];
+        }
+        [self.snapshotter appendFrame:src_frame];
         return src_frame;
     }
+    if (self.detectedAtLowResolution) {
+        // 渲染在原图上检测，丢弃低分辨率坐标系下的跟踪结果
+        [FUDemoManager resetTrackedResult];
+        self.detectedAtLowResolution = NO;
+    }
+    FUTestRecorder *recorder = [FUTestRecorder shareRecorder];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [[FUDemoManager shared] checkAITrackedResult];
+    CFAbsoluteTime trackedTime = CFAbsoluteTimeGetCurrent();
+    [recorder recordDuration:trackedTime - startTime forStage:FUTestRecorderStageTracking];
     [FUDemoManager updateBeautyBlurEffect];
-    [[FUTestRecorder shareRecorder] processFrameWithLog];
-    CVPixelBufferRef srcPixelBuffer = src_frame.textureBuf;
+    // 界面与磨皮策略暂存的美颜参数每帧只写入一次
+    [FUDemoManager flushBeautyParams];
+    CFAbsoluteTime paramTime = CFAbsoluteTimeGetCurrent();
+    [recorder recordDuration:paramTime - trackedTime forStage:FUTestRecorderStageParamUpdate];
+    [recorder processFrameWithLog];
+    if (self.framePoolNeedsFlush) {
+        self.framePoolNeedsFlush = NO;
+        [_framePool flush];
+    }
+    CFAbsoluteTime renderStartTime = CFAbsoluteTimeGetCurrent();
+    // 渲染前决定输出方式，每帧只渲染一次：
+    // 零拷贝时以 pixelBuffer 输入且不回写，渲染结果留在 FURenderKit 的输出 buffer 中直接交给 SDK；
+    // 校验渲染器期间回写到采集帧，输出 buffer 只交给缓存池检查是否按引用轮换；
+    // SDK 持有的输出帧已达上限或渲染器会复用 buffer 时在采集帧上原地渲染
+    ByteRTCVideoFrame *dst_frame = src_frame;
+    FrameLeaseTarget target = self.usePooledOutput ? [self.framePool beginOutputFrame] : FrameLeaseTargetInPlace;
+    if (target == FrameLeaseTargetInPlace) {
+        [self renderInPlace:src_frame];
+    } else {
+        FURenderInput *input = [self renderInputForFrame:src_frame];
+        input.pixelBuffer = src_frame.textureBuf;
+        input.renderConfig.readBackToPixelBuffer = target == FrameLeaseTargetProbe;
+        FURenderOutput *output = [[FURenderKit shareRenderKit] renderWithInput:input];
+        CVPixelBufferRef outputPixelBuffer = output.pixelBuffer != src_frame.textureBuf ? output.pixelBuffer : NULL;
+        if (target == FrameLeaseTargetProbe) {
+            [self.framePool probeRendererPixelBuffer:outputPixelBuffer];
+        } else if (outputPixelBuffer) {
+            dst_frame = [self.framePool outputFrameWithPixelBuffer:outputPixelBuffer sourceFrame:src_frame];
+        }
+        // 没有输出（如在后台）时渲染器未处理本帧，原样返回采集帧
+    }
+    CFAbsoluteTime endTime = CFAbsoluteTimeGetCurrent();
+    [recorder recordDuration:endTime - renderStartTime forStage:FUTestRecorderStageRender];
+    [recorder recordDuration:endTime - startTime forStage:FUTestRecorderStageTotal];
+    [recorder recordEffectRenderedIfNeeded];
+    FrameBudgetGovernor *budgetGovernor = self.budgetGovernor;
+    if (self.budgetGovernorChanged) {
+        // 预算控制非线程安全，旧的在这里回到完整效果后再换成新的
+        self.budgetGovernorChanged = NO;
+        [budgetGovernor reset];
+        // 先清标记再读取，接管期间主线程再次设置时下一帧会重新接管
+        budgetGovernor = self.pendingBudgetGovernor;
+        self.budgetGovernor = budgetGovernor;
+    } else if (self.budgetNeedsReset) {
+        // 旧效果的平滑耗时与档位不适用于新效果
+        self.budgetNeedsReset = NO;
+        [budgetGovernor reset];
+    }
+    [budgetGovernor recordFrameCost:(endTime - startTime) * 1000.0];
+    [self.statsCollector recordProcessorTotal:endTime - startTime render:endTime - renderStartTime tracking:trackedTime - startTime];
+    // 渲染时 FURenderKit 已在原图上完成跟踪
+    [self.landmarkSender sendFacesForFrame:src_frame detectionStage:nil];
+    [self.snapshotter appendFrame:dst_frame];
+    return dst_frame;
+}
+
+/// 渲染配置，输入 buffer 由调用方设置
+- (FURenderInput *)renderInputForFrame:(ByteRTCVideoFrame *)frame {
+    FURenderInput *input = [[FURenderInput alloc] init];
+    input.renderConfig.imageOrientation = FUImageOrientationFromRotation(frame.rotation);
+    //开启重力感应，内部会自动计算正确方向，设置fuSetDefaultRotationMode，无须外面设置
+    input.renderConfig.gravityEnable = YES;
+
+    //如果来源相机捕获的图片一定要设置，否则将会导致内部检测异常
+    input.renderConfig.isFromFrontCamera = [FUDemoManager shared].stickerH;
+    //该属性是指系统相机是否做了镜像: 一般情况前置摄像头出来的帧都是设置过镜像，所以默认需要设置下。如果相机属性未设置镜像，改属性不用设置。
+//    input.renderConfig.isFromMirroredCamera = YES;
+    input.renderConfig.stickerFlipH = [FUDemoManager shared].stickerH;
+    return input;
+}
+
+/// 以 imageBuffer 输入，渲染结果直接写回采集帧
+- (void)renderInPlace:(ByteRTCVideoFrame *)frame {
+    CVPixelBufferRef srcPixelBuffer = frame.textureBuf;
     CVPixelBufferLockBaseAddress(srcPixelBuffer, 0);
     size_t width = (size_t)CVPixelBufferGetWidth(srcPixelBuffer);
     size_t height = (size_t)CVPixelBufferGetHeight(srcPixelBuffer);
@@ -32,34 +206,113 @@
     size_t stride1 = CVPixelBufferGetBytesPerRowOfPlane(srcPixelBuffer, 1);
     size_t stride2 = CVPixelBufferGetBytesPerRowOfPlane(srcPixelBuffer, 2);;
     FUImageBuffer imageBuffer = FUImageBufferMakeI420(buffer0, buffer1, buffer2, width, height, stride0,stride1, stride2);
-    FURenderInput *input = [[FURenderInput alloc] init];
+    FURenderInput *input = [self renderInputForFrame:frame];
     input.imageBuffer = imageBuffer;
-    switch (src_frame.rotation) {
-        case ByteRTCVideoRotation0:
-            input.renderConfig.imageOrientation = FUImageOrientationDown;
-            break;
-        case ByteRTCVideoRotation90:
-            input.renderConfig.imageOrientation = FUImageOrientationLeft;
+    [[FURenderKit shareRenderKit] renderWithInput:input];
+    CVPixelBufferUnlockBaseAddress(srcPixelBuffer, 0);
+}
+
+- (void)enableFrameBudgetWithFrameRate:(NSInteger)frameRate {
+    FrameBudgetGovernor *governor = nil;
+    if (frameRate > 0) {
+        governor = [[FrameBudgetGovernor alloc] initWithFrameRate:frameRate];
+        __weak typeof(self) weakSelf = self;
+        governor.levelChangedHandler = ^(FrameBudgetLevel level) {
+            [weakSelf applyFrameBudgetLevel:level];
+        };
+    }
+    // 预算控制在处理线程使用，由处理线程接管，不在这里替换或重置
+    self.pendingBudgetGovernor = governor;
+    self.budgetGovernorChanged = YES;
+    if (governor && !self.budgetGovernor) {
+        // 首次开启时显式设置完整效果的参数；替换时由旧预算控制 reset 回到完整效果
+        [self applyFrameBudgetLevel:FrameBudgetLevelFull];
+    }
+}
+
+/// 按档位设置渲染质量、人脸点位质量、检测间隔与跟踪方式
+- (void)applyFrameBudgetLevel:(FrameBudgetLevel)level {
+    FUFaceProcessorFaceLandmarkQuality defaultLandmarkQuality = [FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh ? FUFaceProcessorFaceLandmarkQualityHigh : FUFaceProcessorFaceLandmarkQualityMedium;
+    switch (level) {
+        case FrameBudgetLevelFull:
+            fuSetDynamicQuality(1.0);
+            [FUAIKit shareKit].faceProcessorFaceLandmarkQuality = defaultLandmarkQuality;
             break;
-        case ByteRTCVideoRotation180:
-            input.renderConfig.imageOrientation = FUImageOrientationUP;
+        case FrameBudgetLevelReducedQuality:
+            fuSetDynamicQuality(0.6);
+            [FUAIKit shareKit].faceProcessorFaceLandmarkQuality = defaultLandmarkQuality;
             break;
-        case ByteRTCVideoRotation270:
-            input.renderConfig.imageOrientation = FUImageOrientationRight;
+        case FrameBudgetLevelLowQuality:
+        case FrameBudgetLevelSparseTracking:
+            fuSetDynamicQuality(0.3);
+            [FUAIKit shareKit].faceProcessorFaceLandmarkQuality = FUFaceProcessorFaceLandmarkQualityLow;
             break;
     }
-    //开启重力感应，内部会自动计算正确方向，设置fuSetDefaultRotationMode，无须外面设置
-    input.renderConfig.gravityEnable = YES;
+    int detectEveryFrames = FrameBudgetDetectInterval(level, self.baseDetectInterval);
+    [FUAIKit setFaceProcessorDetectEveryFramesWhenFace:detectEveryFrames];
+    [FUAIKit setFaceProcessorDetectEveryFramesWhenNoFace:detectEveryFrames];
+    // 最低档改为异步跟踪：渲染不再等待本帧跟踪，复用上一次完成的跟踪结果；恢复时回到 pipelineMode 的设置
+    [FUAIKit shareKit].asyncTrackFace = FrameBudgetUsesAsyncTracking(level) || self.pipelineMode == CustomProcessorPipelineModeAsyncTrack;
+    NSLog(@"frame budget level: %ld", (long)level);
+}
 
-    //如果来源相机捕获的图片一定要设置，否则将会导致内部检测异常
-    input.renderConfig.isFromFrontCamera = [FUDemoManager shared].stickerH;
-    //该属性是指系统相机是否做了镜像: 一般情况前置摄像头出来的帧都是设置过镜像，所以默认需要设置下。如果相机属性未设置镜像，改属性不用设置。
-//    input.renderConfig.isFromMirroredCamera = YES;
-//    input.renderConfig.readBackToPixelBuffer = YES;
-    input.renderConfig.stickerFlipH = [FUDemoManager shared].stickerH;
-    FURenderOutput *output = [[FURenderKit shareRenderKit] renderWithInput:input];
-    CVPixelBufferUnlockBaseAddress(srcPixelBuffer, 0);
-    return src_frame;
+- (void)setDetectionScale:(FaceDetectionScale)detectionScale {
+    _detectionScale = detectionScale;
+    if (detectionScale == FaceDetectionScaleFull) {
+        self.detectionStage = nil;
+        return;
+    }
+    if (!self.detectionStage) {
+        self.detectionStage = [[FaceDetectionStage alloc] init];
+    }
+    self.detectionStage.scale = detectionScale;
+}
+
+- (void)detectFacesAtLowResolutionInFrame:(ByteRTCVideoFrame *)frame {
+    CVPixelBufferRef pixelBuffer = frame.textureBuf;
+    if (!self.detectionStage || !pixelBuffer || ![[FUAIModelLoader shareLoader] isModelReady:FUAITYPE_FACEPROCESSOR]) {
+        return;
+    }
+    CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    [self.detectionStage detectFacesWithLumaPlane:CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0)
+                                           stride:CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0)
+                                            width:CVPixelBufferGetWidth(pixelBuffer)
+                                           height:CVPixelBufferGetHeight(pixelBuffer)
+                                      orientation:FUImageOrientationFromRotation(frame.rotation)
+                                      frontCamera:[FUDemoManager shared].stickerH];
+    CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    self.detectedAtLowResolution = YES;
+}
+
+- (void)setPipelineMode:(CustomProcessorPipelineMode)pipelineMode {
+    if (_pipelineMode == pipelineMode) {
+        return;
+    }
+    _pipelineMode = pipelineMode;
+    // 帧耗时预算处于最低档时保持异步跟踪
+    BOOL budgetAsyncTracking = self.budgetGovernor && FrameBudgetUsesAsyncTracking(self.budgetGovernor.level);
+    [FUAIKit shareKit].asyncTrackFace = pipelineMode == CustomProcessorPipelineModeAsyncTrack || budgetAsyncTracking;
+    // 切换模式后旧的跟踪结果不再对应当前帧
+    [FUDemoManager resetTrackedResult];
+}
+
+- (void)setUsePooledOutput:(BOOL)usePooledOutput {
+    _usePooledOutput = usePooledOutput;
+    if (!usePooledOutput) {
+        // 缓存池只在处理线程访问，下一帧处理时再释放
+        self.framePoolNeedsFlush = YES;
+    }
+}
+
+- (void)effectDidChange:(NSNotification *)notification {
+    self.budgetNeedsReset = YES;
+}
+
+- (VideoFramePool *)framePool {
+    if (!_framePool) {
+        _framePool = [[VideoFramePool alloc] initWithCapacity:4];
+    }
+    return _framePool;
 }
 
 
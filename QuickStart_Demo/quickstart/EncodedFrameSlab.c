@@ -0,0 +1,146 @@
+//
+//  EncodedFrameSlab.c
+//  quickstart
+//
+
+#include "EncodedFrameSlab.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ENCODED_FRAME_SLAB_CACHE_LINE 64
+#define ENCODED_FRAME_SLAB_MIN_CAPACITY 4096
+/// 记录按 8 字节对齐，保证记录头可以直接按结构体访问
+#define ENCODED_FRAME_SLAB_ALIGN 8
+
+/// 缓冲中的一条记录：记录头 + 数据 + 对齐填充
+typedef struct {
+    /// 整条记录的字节数；0 表示回绕标记，读者跳到缓冲起点
+    uint32_t total;
+    uint32_t reserved;
+    EncodedFrameHeader header;
+} EncodedFrameSlabEntry;
+
+struct EncodedFrameSlab {
+    /// 生产者与消费者各自写的字段分开放在不同缓存行，避免伪共享
+    _Alignas(ENCODED_FRAME_SLAB_CACHE_LINE) _Atomic uint64_t head;
+    _Atomic uint64_t writtenFrames;
+    _Atomic uint64_t droppedFrames;
+
+    _Alignas(ENCODED_FRAME_SLAB_CACHE_LINE) _Atomic uint64_t tail;
+    /// 只由消费者访问
+    uint64_t readPosition;
+
+    /// 创建后只读
+    _Alignas(ENCODED_FRAME_SLAB_CACHE_LINE) size_t capacity;
+    uint8_t *bytes;
+};
+
+static inline size_t EncodedFrameSlabAlign(size_t size) {
+    return (size + ENCODED_FRAME_SLAB_ALIGN - 1) & ~(size_t)(ENCODED_FRAME_SLAB_ALIGN - 1);
+}
+
+EncodedFrameSlab *EncodedFrameSlabCreate(size_t capacityBytes) {
+    size_t capacity = ENCODED_FRAME_SLAB_MIN_CAPACITY;
+    while (capacity < capacityBytes && capacity <= SIZE_MAX / 2) {
+        capacity <<= 1;
+    }
+    void *memory = NULL;
+    if (posix_memalign(&memory, ENCODED_FRAME_SLAB_CACHE_LINE, sizeof(EncodedFrameSlab)) != 0) {
+        return NULL;
+    }
+    EncodedFrameSlab *slab = memory;
+    memset(slab, 0, sizeof(EncodedFrameSlab));
+    slab->capacity = capacity;
+    if (posix_memalign((void **)&slab->bytes, ENCODED_FRAME_SLAB_CACHE_LINE, capacity) != 0) {
+        free(slab);
+        return NULL;
+    }
+    atomic_init(&slab->head, 0);
+    atomic_init(&slab->tail, 0);
+    return slab;
+}
+
+void EncodedFrameSlabDestroy(EncodedFrameSlab *slab) {
+    if (!slab) {
+        return;
+    }
+    free(slab->bytes);
+    free(slab);
+}
+
+size_t EncodedFrameSlabCapacity(const EncodedFrameSlab *slab) {
+    return slab->capacity;
+}
+
+static inline void EncodedFrameSlabCounterAdd(_Atomic uint64_t *counter) {
+    // 每个计数器只有一个写线程，无需 RMW
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+bool EncodedFrameSlabWrite(EncodedFrameSlab *slab, const EncodedFrameHeader *header, const void *data) {
+    size_t need = EncodedFrameSlabAlign(sizeof(EncodedFrameSlabEntry) + header->size);
+    uint64_t head = atomic_load_explicit(&slab->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&slab->tail, memory_order_acquire);
+    size_t offset = (size_t)(head & (slab->capacity - 1));
+    size_t contiguous = slab->capacity - offset;
+    // 放不下时在末尾写回绕标记，记录整体从起点开始，数据始终连续
+    size_t required = need <= contiguous ? need : contiguous + need;
+    if (need > slab->capacity || need > UINT32_MAX || required > slab->capacity - (size_t)(head - tail)) {
+        EncodedFrameSlabCounterAdd(&slab->droppedFrames);
+        return false;
+    }
+    if (need > contiguous) {
+        ((EncodedFrameSlabEntry *)(slab->bytes + offset))->total = 0;
+        head += contiguous;
+        offset = 0;
+    }
+    EncodedFrameSlabEntry *entry = (EncodedFrameSlabEntry *)(slab->bytes + offset);
+    entry->total = (uint32_t)need;
+    entry->header = *header;
+    if (header->size > 0) {
+        memcpy(entry + 1, data, header->size);
+    }
+    atomic_store_explicit(&slab->head, head + need, memory_order_release);
+    EncodedFrameSlabCounterAdd(&slab->writtenFrames);
+    return true;
+}
+
+bool EncodedFrameSlabRead(EncodedFrameSlab *slab, EncodedFrameRecord *record) {
+    uint64_t head = atomic_load_explicit(&slab->head, memory_order_acquire);
+    uint64_t position = slab->readPosition;
+    if (position == head) {
+        return false;
+    }
+    size_t offset = (size_t)(position & (slab->capacity - 1));
+    const EncodedFrameSlabEntry *entry = (const EncodedFrameSlabEntry *)(slab->bytes + offset);
+    if (entry->total == 0) {
+        // 回绕标记与其后的记录是一起发布的，跳过后一定还有记录
+        position += slab->capacity - offset;
+        entry = (const EncodedFrameSlabEntry *)slab->bytes;
+    }
+    record->header = entry->header;
+    record->data = (const uint8_t *)(entry + 1);
+    record->end = position + entry->total;
+    slab->readPosition = record->end;
+    return true;
+}
+
+void EncodedFrameSlabRelease(EncodedFrameSlab *slab, const EncodedFrameRecord *record) {
+    atomic_store_explicit(&slab->tail, record->end, memory_order_release);
+}
+
+size_t EncodedFrameSlabUsedBytes(const EncodedFrameSlab *slab) {
+    uint64_t tail = atomic_load_explicit(&slab->tail, memory_order_acquire);
+    uint64_t head = atomic_load_explicit(&slab->head, memory_order_acquire);
+    return (size_t)(head - tail);
+}
+
+uint64_t EncodedFrameSlabWrittenFrames(const EncodedFrameSlab *slab) {
+    return atomic_load_explicit(&slab->writtenFrames, memory_order_relaxed);
+}
+
+uint64_t EncodedFrameSlabDroppedFrames(const EncodedFrameSlab *slab) {
+    return atomic_load_explicit(&slab->droppedFrames, memory_order_relaxed);
+}
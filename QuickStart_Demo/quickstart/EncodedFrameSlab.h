@@ -0,0 +1,90 @@
+//
+//  EncodedFrameSlab.h
+//  quickstart
+//
+//  单生产者/单消费者无锁编码帧缓冲：变长记录顺序写入预分配的连续内存
+//
+
+#ifndef EncodedFrameSlab_h
+#define EncodedFrameSlab_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    EncodedFrameCodecH264 = 0,
+    EncodedFrameCodecH265,
+    /// 交错排列的 int16 PCM
+    EncodedFrameCodecPCM16,
+} EncodedFrameCodec;
+
+/// 关键帧（IDR），视频有效
+#define ENCODED_FRAME_FLAG_KEYFRAME 1u
+
+typedef struct {
+    /// 显示时间戳与解码时间戳（微秒）
+    int64_t ptsUs;
+    int64_t dtsUs;
+    /// 到达时的单调时钟（微秒），用于音视频对齐
+    int64_t arrivalUs;
+    /// 数据字节数
+    uint32_t size;
+    uint32_t flags;
+    uint16_t width;
+    uint16_t height;
+    /// 顺时针旋转角度：0、90、180、270
+    uint16_t rotation;
+    /// EncodedFrameCodec
+    uint8_t codec;
+    /// 音频声道数
+    uint8_t channels;
+    /// 音频采样率
+    uint32_t sampleRate;
+} EncodedFrameHeader;
+
+/// 消费者读出的一条记录，data 指向缓冲内部，Release 之前有效
+typedef struct {
+    EncodedFrameHeader header;
+    const uint8_t *data;
+    /// 内部使用：该记录之后的读位置
+    uint64_t end;
+} EncodedFrameRecord;
+
+typedef struct EncodedFrameSlab EncodedFrameSlab;
+
+/// 所有内存在此分配
+/// @param capacityBytes 缓冲字节数，取整到 2 的幂，至少 4KB
+EncodedFrameSlab *EncodedFrameSlabCreate(size_t capacityBytes);
+
+void EncodedFrameSlabDestroy(EncodedFrameSlab *slab);
+
+size_t EncodedFrameSlabCapacity(const EncodedFrameSlab *slab);
+
+/// 拷贝一帧（header->size 字节），只在生产者线程调用，无等待
+/// @return 空间不足时丢弃该帧并返回 false
+bool EncodedFrameSlabWrite(EncodedFrameSlab *slab, const EncodedFrameHeader *header, const void *data);
+
+/// 按写入顺序读出下一条记录但不释放，只在消费者线程调用
+/// @return 没有未读记录时返回 false
+bool EncodedFrameSlabRead(EncodedFrameSlab *slab, EncodedFrameRecord *record);
+
+/// 释放 record 及其之前读出的所有记录，只在消费者线程调用
+void EncodedFrameSlabRelease(EncodedFrameSlab *slab, const EncodedFrameRecord *record);
+
+/// 已占用（含已读未释放）的字节数，可在任意线程调用
+size_t EncodedFrameSlabUsedBytes(const EncodedFrameSlab *slab);
+
+/// 写入成功与因空间不足丢弃的帧数，可在任意线程调用
+uint64_t EncodedFrameSlabWrittenFrames(const EncodedFrameSlab *slab);
+uint64_t EncodedFrameSlabDroppedFrames(const EncodedFrameSlab *slab);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EncodedFrameSlab_h */
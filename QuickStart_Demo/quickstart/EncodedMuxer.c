@@ -0,0 +1,1011 @@
+//
+//  EncodedMuxer.c
+//  quickstart
+//
+
+#include "EncodedMuxer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define ENCODED_MUXER_VIDEO_TIMESCALE 90000
+#define ENCODED_MUXER_VIDEO_TRACK_ID 1
+#define ENCODED_MUXER_AUDIO_TRACK_ID 2
+/// 没有下一帧时最后一帧的默认时长（30fps）
+#define ENCODED_MUXER_DEFAULT_FRAME_TICKS (ENCODED_MUXER_VIDEO_TIMESCALE / 30)
+/// SPS/PPS 最大字节数
+#define ENCODED_MUXER_MAX_PARAMETER_SET 256
+/// 为每帧视频预留的平均 NAL 数，单帧超出时占用后续帧的份额
+#define ENCODED_MUXER_NALS_PER_FRAME 8
+/// 单次 writev 的 iovec 数，不超过 IOV_MAX
+#define ENCODED_MUXER_WRITEV_BATCH 1024
+#define ENCODED_MUXER_WAV_HEADER_SIZE 44
+/// moof 中每帧视频的 trun 条目：时长、大小、标志、显示时间偏移
+#define ENCODED_MUXER_TRUN_ENTRY_SIZE 16
+
+/// sample_depends_on = 2：不依赖其他帧
+#define ENCODED_MUXER_SAMPLE_FLAGS_SYNC 0x02000000u
+/// sample_depends_on = 1，sample_is_non_sync_sample = 1
+#define ENCODED_MUXER_SAMPLE_FLAGS_NON_SYNC 0x01010000u
+
+#define H264_NAL_SPS 7
+#define H264_NAL_PPS 8
+#define H264_NAL_AUD 9
+
+typedef struct {
+    uint64_t decodeTicks;
+    int32_t compositionOffset;
+    uint32_t size;
+    uint32_t flags;
+} EncodedMuxerVideoSample;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    bool overflow;
+} EncodedMuxerBuffer;
+
+struct EncodedMuxer {
+    EncodedMuxerConfig config;
+
+    // 当前文件
+    EncodedMuxerFormat format;
+    EncodedFrameCodec codec;
+    int videoFd;
+    int audioFd;
+    bool failed;
+    /// 已收到文件的第一帧关键帧
+    bool started;
+    bool initWritten;
+    uint32_t sequenceNumber;
+    uint16_t width;
+    uint16_t height;
+    uint16_t rotation;
+    uint8_t sps[ENCODED_MUXER_MAX_PARAMETER_SET];
+    size_t spsSize;
+    uint8_t pps[ENCODED_MUXER_MAX_PARAMETER_SET];
+    size_t ppsSize;
+
+    // 时间轴：视频以文件第一帧关键帧为零点，音频按到达时钟对齐后连续计数
+    int64_t baseDtsUs;
+    int64_t baseArrivalUs;
+    /// 上一个分片最后一帧的解码时间与时长
+    bool hasLastDecodeTicks;
+    uint64_t lastDecodeTicks;
+    uint64_t lastDurationTicks;
+    bool audioStarted;
+    uint64_t audioDecodeTicks;
+    /// WAV 开头需要补的静音帧数
+    uint64_t audioSilenceFrames;
+    uint64_t audioDataBytes;
+
+    // 待写出的分片
+    EncodedMuxerVideoSample *videoSamples;
+    size_t videoCount;
+    size_t videoBytes;
+    size_t audioRecordCount;
+    size_t audioFrames;
+    size_t audioBytes;
+
+    /// iov[0] 是 moof + mdat 头，之后是视频数据，Flush 时追加音频
+    struct iovec *iov;
+    size_t videoIovCount;
+    size_t videoIovCapacity;
+    struct iovec *audioIov;
+    /// 每个 NAL 的 4 字节长度前缀
+    uint8_t (*lengthPrefixes)[4];
+    size_t lengthPrefixCount;
+
+    EncodedMuxerBuffer boxes;
+    uint64_t bytesWritten;
+};
+
+EncodedMuxerConfig EncodedMuxerDefaultConfig(void) {
+    EncodedMuxerConfig config = {
+        .audioSampleRate = 0,
+        .audioChannels = 0,
+        .maxFragmentVideoFrames = 256,
+        .maxFragmentAudioFrames = 512,
+    };
+    return config;
+}
+
+EncodedMuxer *EncodedMuxerCreate(const EncodedMuxerConfig *config) {
+    if (!config || config->maxFragmentVideoFrames == 0 || config->maxFragmentAudioFrames == 0 ||
+        (config->audioSampleRate > 0 && (config->audioChannels == 0 || config->audioSampleRate > UINT16_MAX))) {
+        return NULL;
+    }
+    EncodedMuxer *muxer = calloc(1, sizeof(EncodedMuxer));
+    if (!muxer) {
+        return NULL;
+    }
+    muxer->config = *config;
+    muxer->videoFd = -1;
+    muxer->audioFd = -1;
+    muxer->videoIovCapacity = config->maxFragmentVideoFrames * ENCODED_MUXER_NALS_PER_FRAME * 2;
+    muxer->videoSamples = calloc(config->maxFragmentVideoFrames, sizeof(EncodedMuxerVideoSample));
+    muxer->iov = calloc(1 + muxer->videoIovCapacity + config->maxFragmentAudioFrames, sizeof(struct iovec));
+    muxer->audioIov = calloc(config->maxFragmentAudioFrames, sizeof(struct iovec));
+    muxer->lengthPrefixes = calloc(muxer->videoIovCapacity / 2, sizeof(muxer->lengthPrefixes[0]));
+    // 初始化段约 1.2KB 加参数集，moof 每帧视频一个 trun 条目
+    muxer->boxes.capacity = 2048 + 2 * ENCODED_MUXER_MAX_PARAMETER_SET +
+                            config->maxFragmentVideoFrames * ENCODED_MUXER_TRUN_ENTRY_SIZE;
+    muxer->boxes.data = malloc(muxer->boxes.capacity);
+    if (!muxer->videoSamples || !muxer->iov || !muxer->audioIov || !muxer->lengthPrefixes || !muxer->boxes.data) {
+        EncodedMuxerDestroy(muxer);
+        return NULL;
+    }
+    return muxer;
+}
+
+void EncodedMuxerDestroy(EncodedMuxer *muxer) {
+    if (!muxer) {
+        return;
+    }
+    EncodedMuxerClose(muxer);
+    free(muxer->videoSamples);
+    free(muxer->iov);
+    free(muxer->audioIov);
+    free(muxer->lengthPrefixes);
+    free(muxer->boxes.data);
+    free(muxer);
+}
+
+const char *EncodedMuxerFileExtension(EncodedMuxerFormat format, EncodedFrameCodec codec) {
+    if (format == EncodedMuxerFormatFmp4) {
+        return "mp4";
+    }
+    return codec == EncodedFrameCodecH265 ? "h265" : "h264";
+}
+
+// Big-endian box writing
+
+static void EncodedMuxerPut(EncodedMuxerBuffer *buffer, const void *bytes, size_t size) {
+    if (buffer->overflow || size > buffer->capacity - buffer->size) {
+        buffer->overflow = true;
+        return;
+    }
+    memcpy(buffer->data + buffer->size, bytes, size);
+    buffer->size += size;
+}
+
+static void EncodedMuxerPut8(EncodedMuxerBuffer *buffer, uint8_t value) {
+    EncodedMuxerPut(buffer, &value, 1);
+}
+
+static void EncodedMuxerPut16(EncodedMuxerBuffer *buffer, uint16_t value) {
+    uint8_t bytes[2] = {(uint8_t)(value >> 8), (uint8_t)value};
+    EncodedMuxerPut(buffer, bytes, sizeof(bytes));
+}
+
+static void EncodedMuxerPut32(EncodedMuxerBuffer *buffer, uint32_t value) {
+    uint8_t bytes[4] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+    EncodedMuxerPut(buffer, bytes, sizeof(bytes));
+}
+
+static void EncodedMuxerPut64(EncodedMuxerBuffer *buffer, uint64_t value) {
+    EncodedMuxerPut32(buffer, (uint32_t)(value >> 32));
+    EncodedMuxerPut32(buffer, (uint32_t)value);
+}
+
+static void EncodedMuxerPutZeros(EncodedMuxerBuffer *buffer, size_t count) {
+    static const uint8_t zeros[32] = {0};
+    while (count > 0) {
+        size_t chunk = count < sizeof(zeros) ? count : sizeof(zeros);
+        EncodedMuxerPut(buffer, zeros, chunk);
+        count -= chunk;
+    }
+}
+
+static size_t EncodedMuxerBeginBox(EncodedMuxerBuffer *buffer, const char type[4]) {
+    size_t start = buffer->size;
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut(buffer, type, 4);
+    return start;
+}
+
+static size_t EncodedMuxerBeginFullBox(EncodedMuxerBuffer *buffer, const char type[4], uint8_t version,
+                                       uint32_t flags) {
+    size_t start = EncodedMuxerBeginBox(buffer, type);
+    EncodedMuxerPut32(buffer, ((uint32_t)version << 24) | (flags & 0xFFFFFF));
+    return start;
+}
+
+static void EncodedMuxerEndBox(EncodedMuxerBuffer *buffer, size_t start) {
+    if (buffer->overflow) {
+        return;
+    }
+    uint32_t size = (uint32_t)(buffer->size - start);
+    uint8_t *at = buffer->data + start;
+    at[0] = (uint8_t)(size >> 24);
+    at[1] = (uint8_t)(size >> 16);
+    at[2] = (uint8_t)(size >> 8);
+    at[3] = (uint8_t)size;
+}
+
+/// 变换矩阵，a/b/c/d/tx/ty 为整数，与 ffmpeg 写 rotate 的方式一致
+static void EncodedMuxerPutMatrix(EncodedMuxerBuffer *buffer, int32_t a, int32_t b, int32_t c, int32_t d,
+                                  int32_t tx, int32_t ty) {
+    EncodedMuxerPut32(buffer, (uint32_t)(a * 0x10000));
+    EncodedMuxerPut32(buffer, (uint32_t)(b * 0x10000));
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, (uint32_t)(c * 0x10000));
+    EncodedMuxerPut32(buffer, (uint32_t)(d * 0x10000));
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, (uint32_t)(tx * 0x10000));
+    EncodedMuxerPut32(buffer, (uint32_t)(ty * 0x10000));
+    EncodedMuxerPut32(buffer, 0x40000000);
+}
+
+// Annex-B parsing
+
+/// 从 from 开始查找 00 00 01，返回 00 00 01 的位置，找不到返回 size
+static size_t EncodedMuxerFindStartCode(const uint8_t *data, size_t size, size_t from) {
+    size_t i = from + 2;
+    while (i < size) {
+        const uint8_t *one = memchr(data + i, 1, size - i);
+        if (!one) {
+            return size;
+        }
+        i = (size_t)(one - data);
+        if (data[i - 1] == 0 && data[i - 2] == 0) {
+            return i - 2;
+        }
+        i++;
+    }
+    return size;
+}
+
+/// 依次取出 NAL（不含起始码与末尾的填充 0）；数据不以起始码开头时整段视为一个 NAL
+static bool EncodedMuxerNextNal(const uint8_t *data, size_t size, size_t *position, const uint8_t **nal,
+                                size_t *nalSize) {
+    size_t start;
+    if (*position == 0) {
+        size_t code = EncodedMuxerFindStartCode(data, size, 0);
+        if (code == size) {
+            *position = size;
+            *nal = data;
+            *nalSize = size;
+            return size > 0;
+        }
+        start = code + 3;
+    } else if (*position >= size) {
+        return false;
+    } else {
+        start = *position + 3;
+    }
+    size_t next = EncodedMuxerFindStartCode(data, size, start);
+    size_t end = next;
+    while (end > start && data[end - 1] == 0) {
+        end--;
+    }
+    *position = next;
+    *nal = data + start;
+    *nalSize = end - start;
+    return true;
+}
+
+/// 取出关键帧中的第一个 SPS 与 PPS
+static bool EncodedMuxerFindParameterSets(const uint8_t *data, size_t size, const uint8_t **sps, size_t *spsSize,
+                                          const uint8_t **pps, size_t *ppsSize) {
+    *sps = NULL;
+    *pps = NULL;
+    size_t position = 0;
+    const uint8_t *nal;
+    size_t nalSize;
+    while ((!*sps || !*pps) && EncodedMuxerNextNal(data, size, &position, &nal, &nalSize)) {
+        if (nalSize == 0 || nalSize > ENCODED_MUXER_MAX_PARAMETER_SET) {
+            continue;
+        }
+        uint8_t type = nal[0] & 0x1F;
+        if (type == H264_NAL_SPS && !*sps && nalSize >= 4) {
+            *sps = nal;
+            *spsSize = nalSize;
+        } else if (type == H264_NAL_PPS && !*pps) {
+            *pps = nal;
+            *ppsSize = nalSize;
+        }
+    }
+    return *sps && *pps;
+}
+
+// Output
+
+/// writev 全部写完，处理部分写入与 EINTR；会修改 iov
+static bool EncodedMuxerWritev(EncodedMuxer *muxer, int fd, struct iovec *iov, size_t count) {
+    while (count > 0) {
+        int batch = count < ENCODED_MUXER_WRITEV_BATCH ? (int)count : ENCODED_MUXER_WRITEV_BATCH;
+        ssize_t written = writev(fd, iov, batch);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            muxer->failed = true;
+            return false;
+        }
+        muxer->bytesWritten += (uint64_t)written;
+        size_t remaining = (size_t)written;
+        while (count > 0 && remaining >= iov->iov_len) {
+            remaining -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (remaining > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+static void EncodedMuxerPutWavHeader(EncodedMuxerBuffer *buffer, uint32_t sampleRate, uint32_t channels,
+                                     uint32_t dataBytes) {
+    uint32_t blockAlign = channels * sizeof(int16_t);
+    uint8_t header[ENCODED_MUXER_WAV_HEADER_SIZE] = {
+        'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, (uint8_t)channels, 0,
+        (uint8_t)sampleRate, (uint8_t)(sampleRate >> 8), (uint8_t)(sampleRate >> 16), (uint8_t)(sampleRate >> 24),
+        0, 0, 0, 0, (uint8_t)blockAlign, 0, 16, 0,
+        'd', 'a', 't', 'a', 0, 0, 0, 0,
+    };
+    uint32_t byteRate = sampleRate * blockAlign;
+    uint32_t riffSize = 36 + dataBytes;
+    for (int i = 0; i < 4; i++) {
+        header[4 + i] = (uint8_t)(riffSize >> (8 * i));
+        header[28 + i] = (uint8_t)(byteRate >> (8 * i));
+        header[40 + i] = (uint8_t)(dataBytes >> (8 * i));
+    }
+    EncodedMuxerPut(buffer, header, sizeof(header));
+}
+
+bool EncodedMuxerOpen(EncodedMuxer *muxer, EncodedMuxerFormat format, EncodedFrameCodec codec,
+                      const char *videoPath, const char *audioPath) {
+    if (muxer->videoFd >= 0 || codec == EncodedFrameCodecPCM16 ||
+        (format == EncodedMuxerFormatFmp4 && codec != EncodedFrameCodecH264)) {
+        return false;
+    }
+    bool sidecarAudio = format == EncodedMuxerFormatAnnexB && muxer->config.audioSampleRate > 0 && audioPath;
+    int videoFd = open(videoPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (videoFd < 0) {
+        return false;
+    }
+    int audioFd = -1;
+    if (sidecarAudio) {
+        audioFd = open(audioPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (audioFd < 0) {
+            close(videoFd);
+            return false;
+        }
+    }
+    muxer->format = format;
+    muxer->codec = codec;
+    muxer->videoFd = videoFd;
+    muxer->audioFd = audioFd;
+    muxer->failed = false;
+    muxer->started = false;
+    muxer->initWritten = false;
+    muxer->sequenceNumber = 1;
+    muxer->spsSize = 0;
+    muxer->ppsSize = 0;
+    muxer->audioStarted = false;
+    muxer->audioDecodeTicks = 0;
+    muxer->audioSilenceFrames = 0;
+    muxer->audioDataBytes = 0;
+    muxer->lastDurationTicks = ENCODED_MUXER_DEFAULT_FRAME_TICKS;
+    if (audioFd >= 0) {
+        // 数据长度在 Close 时补写
+        muxer->boxes.size = 0;
+        muxer->boxes.overflow = false;
+        EncodedMuxerPutWavHeader(&muxer->boxes, muxer->config.audioSampleRate, muxer->config.audioChannels, 0);
+        struct iovec iov = {muxer->boxes.data, muxer->boxes.size};
+        EncodedMuxerWritev(muxer, audioFd, &iov, 1);
+    }
+    return !muxer->failed;
+}
+
+bool EncodedMuxerIsOpen(const EncodedMuxer *muxer) {
+    return muxer->videoFd >= 0;
+}
+
+// Pending samples
+
+static uint64_t EncodedMuxerVideoTicks(const EncodedMuxer *muxer, int64_t timestampUs) {
+    int64_t delta = timestampUs - muxer->baseDtsUs;
+    if (delta <= 0) {
+        return 0;
+    }
+    return (uint64_t)((delta * (ENCODED_MUXER_VIDEO_TIMESCALE / 1000) + 500) / 1000);
+}
+
+bool EncodedMuxerParameterSetsChanged(const EncodedMuxer *muxer, const EncodedFrameHeader *header,
+                                      const uint8_t *data) {
+    if (muxer->format != EncodedMuxerFormatFmp4 || !muxer->started ||
+        !(header->flags & ENCODED_FRAME_FLAG_KEYFRAME)) {
+        return false;
+    }
+    const uint8_t *sps, *pps;
+    size_t spsSize, ppsSize;
+    if (!EncodedMuxerFindParameterSets(data, header->size, &sps, &spsSize, &pps, &ppsSize)) {
+        return false;
+    }
+    return spsSize != muxer->spsSize || memcmp(sps, muxer->sps, spsSize) != 0 ||
+           ppsSize != muxer->ppsSize || memcmp(pps, muxer->pps, ppsSize) != 0;
+}
+
+/// 文件第一帧关键帧：确定时间零点与初始化段参数
+static bool EncodedMuxerStart(EncodedMuxer *muxer, const EncodedFrameHeader *header, const uint8_t *data) {
+    if (!(header->flags & ENCODED_FRAME_FLAG_KEYFRAME)) {
+        return false;
+    }
+    if (muxer->format == EncodedMuxerFormatFmp4) {
+        const uint8_t *sps, *pps;
+        size_t spsSize, ppsSize;
+        if (!EncodedMuxerFindParameterSets(data, header->size, &sps, &spsSize, &pps, &ppsSize)) {
+            return false;
+        }
+        memcpy(muxer->sps, sps, spsSize);
+        muxer->spsSize = spsSize;
+        memcpy(muxer->pps, pps, ppsSize);
+        muxer->ppsSize = ppsSize;
+    }
+    muxer->width = header->width;
+    muxer->height = header->height;
+    muxer->rotation = header->rotation;
+    muxer->baseDtsUs = header->dtsUs;
+    muxer->baseArrivalUs = header->arrivalUs;
+    muxer->hasLastDecodeTicks = false;
+    muxer->started = true;
+    return true;
+}
+
+bool EncodedMuxerAddVideo(EncodedMuxer *muxer, const EncodedFrameHeader *header, const uint8_t *data) {
+    if (muxer->videoFd < 0 || muxer->failed) {
+        return true;
+    }
+    if (!muxer->started && !EncodedMuxerStart(muxer, header, data)) {
+        return true;
+    }
+    if (muxer->videoCount == muxer->config.maxFragmentVideoFrames) {
+        return false;
+    }
+    size_t iovStart = 1 + muxer->videoIovCount;
+    size_t prefixStart = muxer->lengthPrefixCount;
+    uint32_t sampleSize = 0;
+    if (muxer->format == EncodedMuxerFormatAnnexB) {
+        if (muxer->videoIovCount == muxer->videoIovCapacity) {
+            return false;
+        }
+        muxer->iov[iovStart] = (struct iovec){(void *)data, header->size};
+        muxer->videoIovCount++;
+        sampleSize = header->size;
+    } else {
+        // Annex-B 转为 4 字节长度前缀，参数集放在 avcC 中，长度前缀与 NAL 分别作为 iovec，不拷贝数据
+        size_t position = 0;
+        const uint8_t *nal;
+        size_t nalSize;
+        while (EncodedMuxerNextNal(data, header->size, &position, &nal, &nalSize)) {
+            uint8_t type = nalSize > 0 ? nal[0] & 0x1F : H264_NAL_AUD;
+            if (type == H264_NAL_SPS || type == H264_NAL_PPS || type == H264_NAL_AUD) {
+                continue;
+            }
+            if (muxer->videoIovCount + 2 > muxer->videoIovCapacity) {
+                // 回滚这一帧；分片中没有其他帧时只能丢弃
+                muxer->videoIovCount = iovStart - 1;
+                muxer->lengthPrefixCount = prefixStart;
+                return muxer->videoCount == 0;
+            }
+            uint8_t *prefix = muxer->lengthPrefixes[muxer->lengthPrefixCount++];
+            prefix[0] = (uint8_t)(nalSize >> 24);
+            prefix[1] = (uint8_t)(nalSize >> 16);
+            prefix[2] = (uint8_t)(nalSize >> 8);
+            prefix[3] = (uint8_t)nalSize;
+            muxer->iov[1 + muxer->videoIovCount++] = (struct iovec){prefix, 4};
+            muxer->iov[1 + muxer->videoIovCount++] = (struct iovec){(void *)nal, nalSize};
+            sampleSize += 4 + (uint32_t)nalSize;
+        }
+        if (sampleSize == 0) {
+            return true;
+        }
+    }
+    uint64_t decodeTicks = EncodedMuxerVideoTicks(muxer, header->dtsUs);
+    if (muxer->videoCount > 0) {
+        // 解码时间必须严格递增
+        uint64_t previous = muxer->videoSamples[muxer->videoCount - 1].decodeTicks;
+        if (decodeTicks <= previous) {
+            decodeTicks = previous + 1;
+        }
+    } else if (muxer->hasLastDecodeTicks) {
+        // 上一分片最后一帧的时长是估计值时，不能与之重叠
+        uint64_t previousEnd = muxer->lastDecodeTicks + muxer->lastDurationTicks;
+        if (decodeTicks < previousEnd) {
+            decodeTicks = previousEnd;
+        }
+    }
+    int64_t compositionOffset = (int64_t)EncodedMuxerVideoTicks(muxer, header->ptsUs) - (int64_t)decodeTicks;
+    EncodedMuxerVideoSample *sample = &muxer->videoSamples[muxer->videoCount++];
+    sample->decodeTicks = decodeTicks;
+    sample->compositionOffset = compositionOffset > INT32_MAX ? INT32_MAX
+                                : compositionOffset < INT32_MIN ? INT32_MIN : (int32_t)compositionOffset;
+    sample->size = sampleSize;
+    sample->flags = (header->flags & ENCODED_FRAME_FLAG_KEYFRAME) ? ENCODED_MUXER_SAMPLE_FLAGS_SYNC
+                                                                  : ENCODED_MUXER_SAMPLE_FLAGS_NON_SYNC;
+    muxer->videoBytes += sampleSize;
+    return true;
+}
+
+bool EncodedMuxerAddAudio(EncodedMuxer *muxer, const EncodedFrameHeader *header, const uint8_t *data) {
+    uint32_t sampleRate = muxer->config.audioSampleRate;
+    uint32_t channels = muxer->config.audioChannels;
+    if (muxer->videoFd < 0 || muxer->failed || !muxer->started || sampleRate == 0 ||
+        header->codec != EncodedFrameCodecPCM16 || header->sampleRate != sampleRate || header->channels != channels) {
+        return true;
+    }
+    size_t frameBytes = channels * sizeof(int16_t);
+    size_t frames = header->size / frameBytes;
+    if (!muxer->audioStarted) {
+        // 第一帧音频的采集时刻相对视频零点的偏移，之前的部分丢弃
+        int64_t startUs = header->arrivalUs - (int64_t)(frames * 1000000 / sampleRate) - muxer->baseArrivalUs;
+        if (startUs < 0) {
+            size_t skip = (size_t)((-startUs * sampleRate + 999999) / 1000000);
+            if (skip >= frames) {
+                return true;
+            }
+            data += skip * frameBytes;
+            frames -= skip;
+            startUs = 0;
+        }
+        muxer->audioDecodeTicks = (uint64_t)startUs * sampleRate / 1000000;
+        muxer->audioSilenceFrames = muxer->audioDecodeTicks;
+        muxer->audioStarted = true;
+    }
+    if (frames == 0) {
+        return true;
+    }
+    if (muxer->audioRecordCount == muxer->config.maxFragmentAudioFrames) {
+        return false;
+    }
+    muxer->audioIov[muxer->audioRecordCount++] = (struct iovec){(void *)data, frames * frameBytes};
+    muxer->audioFrames += frames;
+    muxer->audioBytes += frames * frameBytes;
+    return true;
+}
+
+size_t EncodedMuxerPendingVideoFrames(const EncodedMuxer *muxer) {
+    return muxer->videoCount;
+}
+
+size_t EncodedMuxerPendingAudioFrames(const EncodedMuxer *muxer) {
+    return muxer->audioRecordCount;
+}
+
+size_t EncodedMuxerPendingBytes(const EncodedMuxer *muxer) {
+    return muxer->videoBytes + muxer->audioBytes;
+}
+
+int64_t EncodedMuxerPendingVideoDurationUs(const EncodedMuxer *muxer) {
+    if (muxer->videoCount == 0) {
+        return 0;
+    }
+    uint64_t ticks = muxer->videoSamples[muxer->videoCount - 1].decodeTicks - muxer->videoSamples[0].decodeTicks +
+                     muxer->lastDurationTicks;
+    return (int64_t)(ticks * 1000000 / ENCODED_MUXER_VIDEO_TIMESCALE);
+}
+
+int64_t EncodedMuxerPendingAudioDurationUs(const EncodedMuxer *muxer) {
+    if (muxer->config.audioSampleRate == 0) {
+        return 0;
+    }
+    return (int64_t)((uint64_t)muxer->audioFrames * 1000000 / muxer->config.audioSampleRate);
+}
+
+// Fragmented MP4
+
+static void EncodedMuxerPutTrackHeader(EncodedMuxerBuffer *buffer, uint32_t trackId, bool audio, uint16_t width,
+                                       uint16_t height, uint16_t rotation) {
+    size_t tkhd = EncodedMuxerBeginFullBox(buffer, "tkhd", 0, 0x000003);
+    EncodedMuxerPut32(buffer, 0);                   // creation_time
+    EncodedMuxerPut32(buffer, 0);                   // modification_time
+    EncodedMuxerPut32(buffer, trackId);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, 0);                   // duration，分片文件由 moof 决定
+    EncodedMuxerPutZeros(buffer, 8);
+    EncodedMuxerPut16(buffer, 0);                   // layer
+    EncodedMuxerPut16(buffer, audio ? 1 : 0);       // alternate_group
+    EncodedMuxerPut16(buffer, audio ? 0x0100 : 0);  // volume
+    EncodedMuxerPut16(buffer, 0);
+    switch (rotation) {
+        case 90:
+            EncodedMuxerPutMatrix(buffer, 0, 1, -1, 0, height, 0);
+            break;
+        case 180:
+            EncodedMuxerPutMatrix(buffer, -1, 0, 0, -1, width, height);
+            break;
+        case 270:
+            EncodedMuxerPutMatrix(buffer, 0, -1, 1, 0, 0, width);
+            break;
+        default:
+            EncodedMuxerPutMatrix(buffer, 1, 0, 0, 1, 0, 0);
+            break;
+    }
+    EncodedMuxerPut32(buffer, (uint32_t)width << 16);
+    EncodedMuxerPut32(buffer, (uint32_t)height << 16);
+    EncodedMuxerEndBox(buffer, tkhd);
+}
+
+static void EncodedMuxerPutMediaHeader(EncodedMuxerBuffer *buffer, uint32_t timescale, const char handler[4],
+                                       const char *name) {
+    size_t mdhd = EncodedMuxerBeginFullBox(buffer, "mdhd", 0, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, timescale);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut16(buffer, 0x55C4);              // language = und
+    EncodedMuxerPut16(buffer, 0);
+    EncodedMuxerEndBox(buffer, mdhd);
+
+    size_t hdlr = EncodedMuxerBeginFullBox(buffer, "hdlr", 0, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut(buffer, handler, 4);
+    EncodedMuxerPutZeros(buffer, 12);
+    EncodedMuxerPut(buffer, name, strlen(name) + 1);
+    EncodedMuxerEndBox(buffer, hdlr);
+}
+
+/// dinf 与空的采样表，分片文件的采样都在 moof 中
+static void EncodedMuxerPutDataInformation(EncodedMuxerBuffer *buffer) {
+    size_t dinf = EncodedMuxerBeginBox(buffer, "dinf");
+    size_t dref = EncodedMuxerBeginFullBox(buffer, "dref", 0, 0);
+    EncodedMuxerPut32(buffer, 1);
+    size_t url = EncodedMuxerBeginFullBox(buffer, "url ", 0, 0x000001);
+    EncodedMuxerEndBox(buffer, url);
+    EncodedMuxerEndBox(buffer, dref);
+    EncodedMuxerEndBox(buffer, dinf);
+}
+
+static void EncodedMuxerPutEmptySampleTables(EncodedMuxerBuffer *buffer) {
+    static const char *const tables[] = {"stts", "stsc", "stco"};
+    for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++) {
+        size_t box = EncodedMuxerBeginFullBox(buffer, tables[i], 0, 0);
+        EncodedMuxerPut32(buffer, 0);
+        EncodedMuxerEndBox(buffer, box);
+    }
+    size_t stsz = EncodedMuxerBeginFullBox(buffer, "stsz", 0, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerEndBox(buffer, stsz);
+}
+
+static void EncodedMuxerPutVideoTrack(EncodedMuxer *muxer, EncodedMuxerBuffer *buffer) {
+    size_t trak = EncodedMuxerBeginBox(buffer, "trak");
+    EncodedMuxerPutTrackHeader(buffer, ENCODED_MUXER_VIDEO_TRACK_ID, false, muxer->width, muxer->height,
+                               muxer->rotation);
+    size_t mdia = EncodedMuxerBeginBox(buffer, "mdia");
+    EncodedMuxerPutMediaHeader(buffer, ENCODED_MUXER_VIDEO_TIMESCALE, "vide", "VideoHandler");
+    size_t minf = EncodedMuxerBeginBox(buffer, "minf");
+    size_t vmhd = EncodedMuxerBeginFullBox(buffer, "vmhd", 0, 0x000001);
+    EncodedMuxerPutZeros(buffer, 8);
+    EncodedMuxerEndBox(buffer, vmhd);
+    EncodedMuxerPutDataInformation(buffer);
+
+    size_t stbl = EncodedMuxerBeginBox(buffer, "stbl");
+    size_t stsd = EncodedMuxerBeginFullBox(buffer, "stsd", 0, 0);
+    EncodedMuxerPut32(buffer, 1);
+    size_t avc1 = EncodedMuxerBeginBox(buffer, "avc1");
+    EncodedMuxerPutZeros(buffer, 6);
+    EncodedMuxerPut16(buffer, 1);                   // data_reference_index
+    EncodedMuxerPutZeros(buffer, 16);
+    EncodedMuxerPut16(buffer, muxer->width);
+    EncodedMuxerPut16(buffer, muxer->height);
+    EncodedMuxerPut32(buffer, 0x00480000);          // 72 dpi
+    EncodedMuxerPut32(buffer, 0x00480000);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut16(buffer, 1);                   // frame_count
+    EncodedMuxerPutZeros(buffer, 32);               // compressorname
+    EncodedMuxerPut16(buffer, 0x0018);              // depth
+    EncodedMuxerPut16(buffer, 0xFFFF);
+
+    size_t avcC = EncodedMuxerBeginBox(buffer, "avcC");
+    EncodedMuxerPut8(buffer, 1);
+    EncodedMuxerPut8(buffer, muxer->sps[1]);        // profile_idc
+    EncodedMuxerPut8(buffer, muxer->sps[2]);        // constraint flags
+    EncodedMuxerPut8(buffer, muxer->sps[3]);        // level_idc
+    EncodedMuxerPut8(buffer, 0xFF);                 // lengthSizeMinusOne = 3
+    EncodedMuxerPut8(buffer, 0xE1);                 // 1 个 SPS
+    EncodedMuxerPut16(buffer, (uint16_t)muxer->spsSize);
+    EncodedMuxerPut(buffer, muxer->sps, muxer->spsSize);
+    EncodedMuxerPut8(buffer, 1);                    // 1 个 PPS
+    EncodedMuxerPut16(buffer, (uint16_t)muxer->ppsSize);
+    EncodedMuxerPut(buffer, muxer->pps, muxer->ppsSize);
+    EncodedMuxerEndBox(buffer, avcC);
+    EncodedMuxerEndBox(buffer, avc1);
+    EncodedMuxerEndBox(buffer, stsd);
+    EncodedMuxerPutEmptySampleTables(buffer);
+    EncodedMuxerEndBox(buffer, stbl);
+
+    EncodedMuxerEndBox(buffer, minf);
+    EncodedMuxerEndBox(buffer, mdia);
+    EncodedMuxerEndBox(buffer, trak);
+}
+
+static void EncodedMuxerPutAudioTrack(EncodedMuxer *muxer, EncodedMuxerBuffer *buffer) {
+    size_t trak = EncodedMuxerBeginBox(buffer, "trak");
+    EncodedMuxerPutTrackHeader(buffer, ENCODED_MUXER_AUDIO_TRACK_ID, true, 0, 0, 0);
+    size_t mdia = EncodedMuxerBeginBox(buffer, "mdia");
+    EncodedMuxerPutMediaHeader(buffer, muxer->config.audioSampleRate, "soun", "SoundHandler");
+    size_t minf = EncodedMuxerBeginBox(buffer, "minf");
+    size_t smhd = EncodedMuxerBeginFullBox(buffer, "smhd", 0, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerEndBox(buffer, smhd);
+    EncodedMuxerPutDataInformation(buffer);
+
+    size_t stbl = EncodedMuxerBeginBox(buffer, "stbl");
+    size_t stsd = EncodedMuxerBeginFullBox(buffer, "stsd", 0, 0);
+    EncodedMuxerPut32(buffer, 1);
+    // 小端 16 位 PCM，每个采样为一帧（所有声道）
+    size_t sowt = EncodedMuxerBeginBox(buffer, "sowt");
+    EncodedMuxerPutZeros(buffer, 6);
+    EncodedMuxerPut16(buffer, 1);
+    EncodedMuxerPutZeros(buffer, 8);
+    EncodedMuxerPut16(buffer, (uint16_t)muxer->config.audioChannels);
+    EncodedMuxerPut16(buffer, 16);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, muxer->config.audioSampleRate << 16);
+    EncodedMuxerEndBox(buffer, sowt);
+    EncodedMuxerEndBox(buffer, stsd);
+    EncodedMuxerPutEmptySampleTables(buffer);
+    EncodedMuxerEndBox(buffer, stbl);
+
+    EncodedMuxerEndBox(buffer, minf);
+    EncodedMuxerEndBox(buffer, mdia);
+    EncodedMuxerEndBox(buffer, trak);
+}
+
+static void EncodedMuxerPutInitSegment(EncodedMuxer *muxer, EncodedMuxerBuffer *buffer) {
+    bool hasAudio = muxer->config.audioSampleRate > 0;
+    size_t ftyp = EncodedMuxerBeginBox(buffer, "ftyp");
+    EncodedMuxerPut(buffer, "isom", 4);
+    EncodedMuxerPut32(buffer, 0x200);
+    EncodedMuxerPut(buffer, "isomiso5iso6avc1mp41", 20);
+    EncodedMuxerEndBox(buffer, ftyp);
+
+    size_t moov = EncodedMuxerBeginBox(buffer, "moov");
+    size_t mvhd = EncodedMuxerBeginFullBox(buffer, "mvhd", 0, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, 1000);
+    EncodedMuxerPut32(buffer, 0);
+    EncodedMuxerPut32(buffer, 0x00010000);          // rate 1.0
+    EncodedMuxerPut16(buffer, 0x0100);              // volume 1.0
+    EncodedMuxerPutZeros(buffer, 10);
+    EncodedMuxerPutMatrix(buffer, 1, 0, 0, 1, 0, 0);
+    EncodedMuxerPutZeros(buffer, 24);
+    EncodedMuxerPut32(buffer, hasAudio ? ENCODED_MUXER_AUDIO_TRACK_ID + 1 : ENCODED_MUXER_VIDEO_TRACK_ID + 1);
+    EncodedMuxerEndBox(buffer, mvhd);
+
+    EncodedMuxerPutVideoTrack(muxer, buffer);
+    if (hasAudio) {
+        EncodedMuxerPutAudioTrack(muxer, buffer);
+    }
+
+    size_t mvex = EncodedMuxerBeginBox(buffer, "mvex");
+    for (uint32_t trackId = ENCODED_MUXER_VIDEO_TRACK_ID; trackId <= (hasAudio ? ENCODED_MUXER_AUDIO_TRACK_ID
+                                                                               : ENCODED_MUXER_VIDEO_TRACK_ID);
+         trackId++) {
+        size_t trex = EncodedMuxerBeginFullBox(buffer, "trex", 0, 0);
+        EncodedMuxerPut32(buffer, trackId);
+        EncodedMuxerPut32(buffer, 1);               // default_sample_description_index
+        EncodedMuxerPut32(buffer, 0);
+        EncodedMuxerPut32(buffer, 0);
+        EncodedMuxerPut32(buffer, 0);
+        EncodedMuxerEndBox(buffer, trex);
+    }
+    EncodedMuxerEndBox(buffer, mvex);
+    EncodedMuxerEndBox(buffer, moov);
+}
+
+/// moof + mdat 头；trun 的 data_offset 相对 moof 起点（default-base-is-moof）
+static void EncodedMuxerPutFragmentHeader(EncodedMuxer *muxer, EncodedMuxerBuffer *buffer, uint64_t lastDurationTicks) {
+    size_t moof = EncodedMuxerBeginBox(buffer, "moof");
+    size_t mfhd = EncodedMuxerBeginFullBox(buffer, "mfhd", 0, 0);
+    EncodedMuxerPut32(buffer, muxer->sequenceNumber);
+    EncodedMuxerEndBox(buffer, mfhd);
+
+    size_t videoDataOffsetAt = 0;
+    size_t audioDataOffsetAt = 0;
+    if (muxer->videoCount > 0) {
+        size_t traf = EncodedMuxerBeginBox(buffer, "traf");
+        size_t tfhd = EncodedMuxerBeginFullBox(buffer, "tfhd", 0, 0x020000);
+        EncodedMuxerPut32(buffer, ENCODED_MUXER_VIDEO_TRACK_ID);
+        EncodedMuxerEndBox(buffer, tfhd);
+        size_t tfdt = EncodedMuxerBeginFullBox(buffer, "tfdt", 1, 0);
+        EncodedMuxerPut64(buffer, muxer->videoSamples[0].decodeTicks);
+        EncodedMuxerEndBox(buffer, tfdt);
+        // data_offset、时长、大小、标志、有符号显示时间偏移
+        size_t trun = EncodedMuxerBeginFullBox(buffer, "trun", 1, 0x000F01);
+        EncodedMuxerPut32(buffer, (uint32_t)muxer->videoCount);
+        videoDataOffsetAt = buffer->size;
+        EncodedMuxerPut32(buffer, 0);
+        for (size_t i = 0; i < muxer->videoCount; i++) {
+            const EncodedMuxerVideoSample *sample = &muxer->videoSamples[i];
+            uint64_t duration = i + 1 < muxer->videoCount ? muxer->videoSamples[i + 1].decodeTicks - sample->decodeTicks
+                                                          : lastDurationTicks;
+            EncodedMuxerPut32(buffer, (uint32_t)duration);
+            EncodedMuxerPut32(buffer, sample->size);
+            EncodedMuxerPut32(buffer, sample->flags);
+            EncodedMuxerPut32(buffer, (uint32_t)sample->compositionOffset);
+        }
+        EncodedMuxerEndBox(buffer, trun);
+        EncodedMuxerEndBox(buffer, traf);
+    }
+    if (muxer->audioFrames > 0) {
+        size_t traf = EncodedMuxerBeginBox(buffer, "traf");
+        // 默认时长、大小、标志：PCM 每个采样时长为 1，大小为一帧
+        size_t tfhd = EncodedMuxerBeginFullBox(buffer, "tfhd", 0, 0x020038);
+        EncodedMuxerPut32(buffer, ENCODED_MUXER_AUDIO_TRACK_ID);
+        EncodedMuxerPut32(buffer, 1);
+        EncodedMuxerPut32(buffer, muxer->config.audioChannels * (uint32_t)sizeof(int16_t));
+        EncodedMuxerPut32(buffer, ENCODED_MUXER_SAMPLE_FLAGS_SYNC);
+        EncodedMuxerEndBox(buffer, tfhd);
+        size_t tfdt = EncodedMuxerBeginFullBox(buffer, "tfdt", 1, 0);
+        EncodedMuxerPut64(buffer, muxer->audioDecodeTicks);
+        EncodedMuxerEndBox(buffer, tfdt);
+        size_t trun = EncodedMuxerBeginFullBox(buffer, "trun", 0, 0x000001);
+        EncodedMuxerPut32(buffer, (uint32_t)muxer->audioFrames);
+        audioDataOffsetAt = buffer->size;
+        EncodedMuxerPut32(buffer, 0);
+        EncodedMuxerEndBox(buffer, trun);
+        EncodedMuxerEndBox(buffer, traf);
+    }
+    EncodedMuxerEndBox(buffer, moof);
+
+    size_t moofSize = buffer->size - moof;
+    EncodedMuxerPut32(buffer, (uint32_t)(8 + muxer->videoBytes + muxer->audioBytes));
+    EncodedMuxerPut(buffer, "mdat", 4);
+    if (buffer->overflow) {
+        return;
+    }
+    uint32_t videoOffset = (uint32_t)(moofSize + 8);
+    uint32_t audioOffset = (uint32_t)(moofSize + 8 + muxer->videoBytes);
+    if (videoDataOffsetAt) {
+        uint8_t *at = buffer->data + videoDataOffsetAt;
+        at[0] = (uint8_t)(videoOffset >> 24);
+        at[1] = (uint8_t)(videoOffset >> 16);
+        at[2] = (uint8_t)(videoOffset >> 8);
+        at[3] = (uint8_t)videoOffset;
+    }
+    if (audioDataOffsetAt) {
+        uint8_t *at = buffer->data + audioDataOffsetAt;
+        at[0] = (uint8_t)(audioOffset >> 24);
+        at[1] = (uint8_t)(audioOffset >> 16);
+        at[2] = (uint8_t)(audioOffset >> 8);
+        at[3] = (uint8_t)audioOffset;
+    }
+}
+
+static void EncodedMuxerResetPending(EncodedMuxer *muxer) {
+    muxer->videoCount = 0;
+    muxer->videoBytes = 0;
+    muxer->videoIovCount = 0;
+    muxer->lengthPrefixCount = 0;
+    muxer->audioRecordCount = 0;
+    muxer->audioFrames = 0;
+    muxer->audioBytes = 0;
+}
+
+static bool EncodedMuxerFlushFmp4(EncodedMuxer *muxer, uint64_t lastDurationTicks) {
+    EncodedMuxerBuffer *boxes = &muxer->boxes;
+    if (!muxer->initWritten) {
+        boxes->size = 0;
+        boxes->overflow = false;
+        EncodedMuxerPutInitSegment(muxer, boxes);
+        struct iovec iov = {boxes->data, boxes->size};
+        if (boxes->overflow || !EncodedMuxerWritev(muxer, muxer->videoFd, &iov, 1)) {
+            muxer->failed = true;
+            return false;
+        }
+        muxer->initWritten = true;
+    }
+    if (muxer->videoCount == 0 && muxer->audioFrames == 0) {
+        return true;
+    }
+    boxes->size = 0;
+    boxes->overflow = false;
+    EncodedMuxerPutFragmentHeader(muxer, boxes, lastDurationTicks);
+    if (boxes->overflow) {
+        muxer->failed = true;
+        return false;
+    }
+    muxer->iov[0] = (struct iovec){boxes->data, boxes->size};
+    size_t count = 1 + muxer->videoIovCount;
+    memcpy(muxer->iov + count, muxer->audioIov, muxer->audioRecordCount * sizeof(struct iovec));
+    count += muxer->audioRecordCount;
+    if (!EncodedMuxerWritev(muxer, muxer->videoFd, muxer->iov, count)) {
+        return false;
+    }
+    muxer->audioDecodeTicks += muxer->audioFrames;
+    muxer->sequenceNumber++;
+    return true;
+}
+
+static bool EncodedMuxerFlushAnnexB(EncodedMuxer *muxer) {
+    if (muxer->videoIovCount > 0 && !EncodedMuxerWritev(muxer, muxer->videoFd, muxer->iov + 1, muxer->videoIovCount)) {
+        return false;
+    }
+    if (muxer->audioFd < 0 || muxer->audioRecordCount == 0) {
+        return true;
+    }
+    // WAV 没有时间戳，开头补静音对齐视频
+    static const uint8_t silence[4096] = {0};
+    size_t frameBytes = muxer->config.audioChannels * sizeof(int16_t);
+    while (muxer->audioSilenceFrames > 0) {
+        size_t frames = sizeof(silence) / frameBytes;
+        if (frames > muxer->audioSilenceFrames) {
+            frames = (size_t)muxer->audioSilenceFrames;
+        }
+        struct iovec iov = {(void *)silence, frames * frameBytes};
+        if (!EncodedMuxerWritev(muxer, muxer->audioFd, &iov, 1)) {
+            return false;
+        }
+        muxer->audioSilenceFrames -= frames;
+        muxer->audioDataBytes += frames * frameBytes;
+    }
+    if (!EncodedMuxerWritev(muxer, muxer->audioFd, muxer->audioIov, muxer->audioRecordCount)) {
+        return false;
+    }
+    muxer->audioDataBytes += muxer->audioBytes;
+    return true;
+}
+
+bool EncodedMuxerFlush(EncodedMuxer *muxer, int64_t nextVideoDtsUs) {
+    if (muxer->videoFd < 0 || muxer->failed) {
+        EncodedMuxerResetPending(muxer);
+        return muxer->videoFd < 0;
+    }
+    if (!muxer->started) {
+        return true;
+    }
+    if (muxer->videoCount > 0) {
+        uint64_t lastTicks = muxer->videoSamples[muxer->videoCount - 1].decodeTicks;
+        if (nextVideoDtsUs != INT64_MIN) {
+            uint64_t nextTicks = EncodedMuxerVideoTicks(muxer, nextVideoDtsUs);
+            muxer->lastDurationTicks = nextTicks > lastTicks ? nextTicks - lastTicks : 1;
+        } else if (muxer->videoCount > 1) {
+            muxer->lastDurationTicks = lastTicks - muxer->videoSamples[muxer->videoCount - 2].decodeTicks;
+        }
+        muxer->lastDecodeTicks = lastTicks;
+        muxer->hasLastDecodeTicks = true;
+    }
+    bool ok = muxer->format == EncodedMuxerFormatFmp4 ? EncodedMuxerFlushFmp4(muxer, muxer->lastDurationTicks)
+                                                      : EncodedMuxerFlushAnnexB(muxer);
+    EncodedMuxerResetPending(muxer);
+    return ok;
+}
+
+bool EncodedMuxerClose(EncodedMuxer *muxer) {
+    if (muxer->videoFd < 0) {
+        return true;
+    }
+    bool ok = EncodedMuxerFlush(muxer, INT64_MIN);
+    if (muxer->audioFd >= 0) {
+        EncodedMuxerBuffer *boxes = &muxer->boxes;
+        boxes->size = 0;
+        boxes->overflow = false;
+        uint32_t dataBytes = muxer->audioDataBytes > UINT32_MAX - 36 ? UINT32_MAX - 36 : (uint32_t)muxer->audioDataBytes;
+        EncodedMuxerPutWavHeader(boxes, muxer->config.audioSampleRate, muxer->config.audioChannels, dataBytes);
+        ok = pwrite(muxer->audioFd, boxes->data, boxes->size, 0) == (ssize_t)boxes->size && ok;
+        ok = close(muxer->audioFd) == 0 && ok;
+        muxer->audioFd = -1;
+    }
+    ok = close(muxer->videoFd) == 0 && ok;
+    muxer->videoFd = -1;
+    return ok;
+}
+
+uint64_t EncodedMuxerBytesWritten(const EncodedMuxer *muxer) {
+    return muxer->bytesWritten;
+}
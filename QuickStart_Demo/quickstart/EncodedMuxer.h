@@ -0,0 +1,95 @@
+//
+//  EncodedMuxer.h
+//  quickstart
+//
+//  编码帧封装：H.264 分片 MP4（音频为 PCM 轨）或 Annex-B 裸流（音频另存 WAV），writev 批量落盘
+//
+
+#ifndef EncodedMuxer_h
+#define EncodedMuxer_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "EncodedFrameSlab.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    /// ftyp + moov 之后逐个写 moof + mdat，中途中断也能播放已写入的分片；仅支持 H.264
+    EncodedMuxerFormatFmp4 = 0,
+    /// 原样写出 Annex-B 码流
+    EncodedMuxerFormatAnnexB,
+} EncodedMuxerFormat;
+
+typedef struct {
+    /// 音频采样率与声道数，采样率为 0 表示没有音频
+    uint32_t audioSampleRate;
+    uint32_t audioChannels;
+    /// 一个分片最多的视频帧数与音频帧数
+    size_t maxFragmentVideoFrames;
+    size_t maxFragmentAudioFrames;
+} EncodedMuxerConfig;
+
+/// 默认配置：无音频，一个分片最多 256 帧视频、512 帧音频
+EncodedMuxerConfig EncodedMuxerDefaultConfig(void);
+
+typedef struct EncodedMuxer EncodedMuxer;
+
+/// 所有内存在此分配，之后打开文件、写分片都不再分配内存
+EncodedMuxer *EncodedMuxerCreate(const EncodedMuxerConfig *config);
+
+/// 关闭未关闭的文件后释放
+void EncodedMuxerDestroy(EncodedMuxer *muxer);
+
+/// 格式与编码对应的视频文件扩展名（不含点）
+const char *EncodedMuxerFileExtension(EncodedMuxerFormat format, EncodedFrameCodec codec);
+
+/// 打开新文件，之前的文件需先 Close
+/// @param audioPath Annex-B 格式下音频 WAV 的路径，没有音频或 MP4 格式时可传 NULL
+/// @return 格式不支持该编码或打开失败时返回 false
+bool EncodedMuxerOpen(EncodedMuxer *muxer, EncodedMuxerFormat format, EncodedFrameCodec codec,
+                      const char *videoPath, const char *audioPath);
+
+bool EncodedMuxerIsOpen(const EncodedMuxer *muxer);
+
+/// 加入一帧视频。文件的第一帧必须是关键帧，否则被丢弃。
+/// 数据不拷贝，直接被 writev 引用，Flush 之前必须保持有效
+/// @return 分片已满时返回 false，需要先 Flush 再重新加入
+bool EncodedMuxerAddVideo(EncodedMuxer *muxer, const EncodedFrameHeader *header, const uint8_t *data);
+
+/// 加入一帧 PCM16 音频，时间按到达时钟对齐到文件的第一帧视频，之前到达的音频被丢弃
+/// 数据不拷贝，Flush 之前必须保持有效
+/// @return 分片已满时返回 false
+bool EncodedMuxerAddAudio(EncodedMuxer *muxer, const EncodedFrameHeader *header, const uint8_t *data);
+
+/// 关键帧的 SPS/PPS 与当前文件不同（如分辨率变化）时返回 true，需要换新文件
+bool EncodedMuxerParameterSetsChanged(const EncodedMuxer *muxer, const EncodedFrameHeader *header,
+                                      const uint8_t *data);
+
+/// 待写出的帧数、字节数与视频时长（微秒）
+size_t EncodedMuxerPendingVideoFrames(const EncodedMuxer *muxer);
+size_t EncodedMuxerPendingAudioFrames(const EncodedMuxer *muxer);
+size_t EncodedMuxerPendingBytes(const EncodedMuxer *muxer);
+int64_t EncodedMuxerPendingVideoDurationUs(const EncodedMuxer *muxer);
+int64_t EncodedMuxerPendingAudioDurationUs(const EncodedMuxer *muxer);
+
+/// 把已加入的帧写成一个分片，返回后之前加入的数据不再被引用
+/// @param nextVideoDtsUs 下一帧视频的解码时间戳，用于确定最后一帧的时长；未知时传 INT64_MIN，沿用上一帧时长
+/// @return 写入失败时返回 false，之后的写入都会失败
+bool EncodedMuxerFlush(EncodedMuxer *muxer, int64_t nextVideoDtsUs);
+
+/// 写出剩余的帧、补全 WAV 头并关闭文件
+bool EncodedMuxerClose(EncodedMuxer *muxer);
+
+/// 累计写出的字节数
+uint64_t EncodedMuxerBytesWritten(const EncodedMuxer *muxer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EncodedMuxer_h */
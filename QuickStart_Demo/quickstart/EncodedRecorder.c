@@ -0,0 +1,300 @@
+//
+//  EncodedRecorder.c
+//  quickstart
+//
+
+#include "EncodedRecorder.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// 没有关键帧或只有音频时，积压超过分片时长的这么多倍也要落盘
+#define ENCODED_RECORDER_FORCE_FLUSH_FACTOR 2
+
+struct EncodedRecorder {
+    EncodedRecorderConfig config;
+    char pathPrefix[PATH_MAX];
+    EncodedFrameSlab *videoSlab;
+    EncodedFrameSlab *audioSlab;
+    EncodedMuxer *muxer;
+    pthread_t thread;
+    bool threadStarted;
+    _Atomic bool accepting;
+    _Atomic bool running;
+
+    // 以下只由 I/O 线程访问：已读出、尚未释放的最后一条记录
+    EncodedFrameRecord lastVideo;
+    bool hasLastVideo;
+    EncodedFrameRecord lastAudio;
+    bool hasLastAudio;
+    uint32_t fileIndex;
+
+    _Atomic uint64_t videoFrames;
+    _Atomic uint64_t audioFrames;
+    _Atomic uint64_t skippedFrames;
+    _Atomic uint64_t bytesWritten;
+    _Atomic uint32_t files;
+    _Atomic uint32_t writeErrors;
+};
+
+EncodedRecorderConfig EncodedRecorderDefaultConfig(const char *pathPrefix) {
+    EncodedRecorderConfig config = {
+        .format = EncodedMuxerFormatFmp4,
+        .pathPrefix = pathPrefix,
+        .videoSlabBytes = 8 << 20,
+        .audioSlabBytes = 1 << 20,
+        .audioSampleRate = 0,
+        .audioChannels = 0,
+        .fragmentDurationMs = 1000,
+        .pollIntervalMs = 10,
+    };
+    return config;
+}
+
+int64_t EncodedRecorderNowUs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static inline void EncodedRecorderCounterAdd(_Atomic uint64_t *counter, uint64_t value) {
+    // 计数器只由 I/O 线程写
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static inline void EncodedRecorderCounterAdd32(_Atomic uint32_t *counter) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+// I/O thread
+
+/// 释放已写出的记录
+static void EncodedRecorderReleaseWritten(EncodedRecorder *recorder) {
+    if (recorder->hasLastVideo) {
+        EncodedFrameSlabRelease(recorder->videoSlab, &recorder->lastVideo);
+        recorder->hasLastVideo = false;
+    }
+    if (recorder->hasLastAudio) {
+        EncodedFrameSlabRelease(recorder->audioSlab, &recorder->lastAudio);
+        recorder->hasLastAudio = false;
+    }
+}
+
+static void EncodedRecorderCloseFile(EncodedRecorder *recorder) {
+    size_t videoFrames = EncodedMuxerPendingVideoFrames(recorder->muxer);
+    size_t audioFrames = EncodedMuxerPendingAudioFrames(recorder->muxer);
+    if (!EncodedMuxerClose(recorder->muxer)) {
+        EncodedRecorderCounterAdd32(&recorder->writeErrors);
+    } else {
+        EncodedRecorderCounterAdd(&recorder->videoFrames, videoFrames);
+        EncodedRecorderCounterAdd(&recorder->audioFrames, audioFrames);
+    }
+    atomic_store_explicit(&recorder->bytesWritten, EncodedMuxerBytesWritten(recorder->muxer), memory_order_relaxed);
+    EncodedRecorderReleaseWritten(recorder);
+}
+
+static void EncodedRecorderFlush(EncodedRecorder *recorder, int64_t nextVideoDtsUs) {
+    size_t videoFrames = EncodedMuxerPendingVideoFrames(recorder->muxer);
+    size_t audioFrames = EncodedMuxerPendingAudioFrames(recorder->muxer);
+    if (EncodedMuxerFlush(recorder->muxer, nextVideoDtsUs)) {
+        EncodedRecorderCounterAdd(&recorder->videoFrames, videoFrames);
+        EncodedRecorderCounterAdd(&recorder->audioFrames, audioFrames);
+    } else {
+        // 写失败（如磁盘已满）后关闭文件，下一帧关键帧时重新尝试
+        EncodedRecorderCounterAdd32(&recorder->writeErrors);
+        EncodedMuxerClose(recorder->muxer);
+    }
+    atomic_store_explicit(&recorder->bytesWritten, EncodedMuxerBytesWritten(recorder->muxer), memory_order_relaxed);
+    EncodedRecorderReleaseWritten(recorder);
+}
+
+static bool EncodedRecorderOpenFile(EncodedRecorder *recorder, EncodedFrameCodec codec) {
+    EncodedMuxerFormat format = recorder->config.format;
+    if (format == EncodedMuxerFormatFmp4 && codec != EncodedFrameCodecH264) {
+        format = EncodedMuxerFormatAnnexB;
+    }
+    char videoPath[PATH_MAX];
+    char audioPath[PATH_MAX];
+    int videoLength = snprintf(videoPath, sizeof(videoPath), "%s_%03u.%s", recorder->pathPrefix, recorder->fileIndex,
+                               EncodedMuxerFileExtension(format, codec));
+    int audioLength = snprintf(audioPath, sizeof(audioPath), "%s_%03u.wav", recorder->pathPrefix, recorder->fileIndex);
+    recorder->fileIndex++;
+    if (videoLength < 0 || (size_t)videoLength >= sizeof(videoPath) || audioLength < 0 ||
+        (size_t)audioLength >= sizeof(audioPath)) {
+        // 截断的路径可能指向其他文件，不打开
+        EncodedRecorderCounterAdd32(&recorder->writeErrors);
+        return false;
+    }
+    if (!EncodedMuxerOpen(recorder->muxer, format, codec, videoPath, audioPath)) {
+        EncodedMuxerClose(recorder->muxer);
+        EncodedRecorderCounterAdd32(&recorder->writeErrors);
+        return false;
+    }
+    EncodedRecorderCounterAdd32(&recorder->files);
+    return true;
+}
+
+static void EncodedRecorderHandleVideo(EncodedRecorder *recorder, const EncodedFrameRecord *record) {
+    const EncodedFrameHeader *header = &record->header;
+    bool keyframe = header->flags & ENCODED_FRAME_FLAG_KEYFRAME;
+    EncodedMuxer *muxer = recorder->muxer;
+    if (EncodedMuxerIsOpen(muxer)) {
+        int64_t fragmentUs = (int64_t)recorder->config.fragmentDurationMs * 1000;
+        int64_t pendingUs = EncodedMuxerPendingVideoDurationUs(muxer);
+        if (keyframe && EncodedMuxerParameterSetsChanged(muxer, header, record->data)) {
+            // 分辨率等参数变化，新参数写进新文件的初始化段
+            EncodedRecorderFlush(recorder, header->dtsUs);
+            EncodedRecorderCloseFile(recorder);
+        } else if ((keyframe && pendingUs >= fragmentUs) ||
+                   pendingUs >= ENCODED_RECORDER_FORCE_FLUSH_FACTOR * fragmentUs) {
+            EncodedRecorderFlush(recorder, header->dtsUs);
+        }
+    }
+    if (!EncodedMuxerIsOpen(muxer) && (!keyframe || !EncodedRecorderOpenFile(recorder, header->codec))) {
+        EncodedRecorderCounterAdd(&recorder->skippedFrames, 1);
+        EncodedFrameSlabRelease(recorder->videoSlab, record);
+        return;
+    }
+    if (!EncodedMuxerAddVideo(muxer, header, record->data)) {
+        EncodedRecorderFlush(recorder, header->dtsUs);
+        EncodedMuxerAddVideo(muxer, header, record->data);
+    }
+    if (EncodedMuxerPendingVideoFrames(muxer) == 0) {
+        // 没有被封装（如文件第一帧不含参数集），也没有在等待写出的帧
+        EncodedRecorderCounterAdd(&recorder->skippedFrames, 1);
+        EncodedFrameSlabRelease(recorder->videoSlab, record);
+        return;
+    }
+    recorder->lastVideo = *record;
+    recorder->hasLastVideo = true;
+}
+
+static void EncodedRecorderHandleAudio(EncodedRecorder *recorder, const EncodedFrameRecord *record) {
+    EncodedMuxer *muxer = recorder->muxer;
+    if (!EncodedMuxerAddAudio(muxer, &record->header, record->data)) {
+        EncodedRecorderFlush(recorder, INT64_MIN);
+        EncodedMuxerAddAudio(muxer, &record->header, record->data);
+    }
+    if (EncodedMuxerPendingAudioFrames(muxer) == 0) {
+        // 第一帧视频之前的音频直接丢弃
+        EncodedFrameSlabRelease(recorder->audioSlab, record);
+        return;
+    }
+    recorder->lastAudio = *record;
+    recorder->hasLastAudio = true;
+}
+
+static void EncodedRecorderDrain(EncodedRecorder *recorder) {
+    EncodedFrameRecord record;
+    while (EncodedFrameSlabRead(recorder->videoSlab, &record)) {
+        EncodedRecorderHandleVideo(recorder, &record);
+    }
+    while (EncodedFrameSlabRead(recorder->audioSlab, &record)) {
+        EncodedRecorderHandleAudio(recorder, &record);
+    }
+    // 摄像头关闭时只有音频在积压；缓冲占用过半时也提前落盘，保证回调线程总有空间
+    int64_t fragmentUs = (int64_t)recorder->config.fragmentDurationMs * 1000;
+    if (EncodedMuxerPendingAudioDurationUs(recorder->muxer) >= ENCODED_RECORDER_FORCE_FLUSH_FACTOR * fragmentUs ||
+        EncodedFrameSlabUsedBytes(recorder->videoSlab) > EncodedFrameSlabCapacity(recorder->videoSlab) / 2 ||
+        EncodedFrameSlabUsedBytes(recorder->audioSlab) > EncodedFrameSlabCapacity(recorder->audioSlab) / 2) {
+        EncodedRecorderFlush(recorder, INT64_MIN);
+    }
+}
+
+static void *EncodedRecorderThread(void *context) {
+    EncodedRecorder *recorder = context;
+    struct timespec interval = {
+        .tv_sec = recorder->config.pollIntervalMs / 1000,
+        .tv_nsec = (long)(recorder->config.pollIntervalMs % 1000) * 1000000,
+    };
+    while (atomic_load_explicit(&recorder->running, memory_order_acquire)) {
+        EncodedRecorderDrain(recorder);
+        nanosleep(&interval, NULL);
+    }
+    EncodedRecorderDrain(recorder);
+    EncodedRecorderCloseFile(recorder);
+    return NULL;
+}
+
+// Public
+
+EncodedRecorder *EncodedRecorderCreate(const EncodedRecorderConfig *config) {
+    if (!config || !config->pathPrefix || strlen(config->pathPrefix) + 16 > PATH_MAX ||
+        config->fragmentDurationMs == 0 || config->pollIntervalMs == 0) {
+        return NULL;
+    }
+    EncodedRecorder *recorder = calloc(1, sizeof(EncodedRecorder));
+    if (!recorder) {
+        return NULL;
+    }
+    recorder->config = *config;
+    strcpy(recorder->pathPrefix, config->pathPrefix);
+    recorder->config.pathPrefix = recorder->pathPrefix;
+
+    EncodedMuxerConfig muxerConfig = EncodedMuxerDefaultConfig();
+    muxerConfig.audioSampleRate = config->audioSampleRate;
+    muxerConfig.audioChannels = config->audioChannels;
+    recorder->muxer = EncodedMuxerCreate(&muxerConfig);
+    recorder->videoSlab = EncodedFrameSlabCreate(config->videoSlabBytes);
+    recorder->audioSlab = EncodedFrameSlabCreate(config->audioSlabBytes);
+    if (!recorder->muxer || !recorder->videoSlab || !recorder->audioSlab) {
+        EncodedRecorderDestroy(recorder);
+        return NULL;
+    }
+    atomic_init(&recorder->accepting, true);
+    atomic_init(&recorder->running, true);
+    if (pthread_create(&recorder->thread, NULL, EncodedRecorderThread, recorder) != 0) {
+        EncodedRecorderDestroy(recorder);
+        return NULL;
+    }
+    recorder->threadStarted = true;
+    return recorder;
+}
+
+void EncodedRecorderStop(EncodedRecorder *recorder) {
+    atomic_store_explicit(&recorder->accepting, false, memory_order_release);
+    if (atomic_exchange_explicit(&recorder->running, false, memory_order_acq_rel) && recorder->threadStarted) {
+        pthread_join(recorder->thread, NULL);
+    }
+}
+
+void EncodedRecorderDestroy(EncodedRecorder *recorder) {
+    if (!recorder) {
+        return;
+    }
+    EncodedRecorderStop(recorder);
+    EncodedMuxerDestroy(recorder->muxer);
+    EncodedFrameSlabDestroy(recorder->videoSlab);
+    EncodedFrameSlabDestroy(recorder->audioSlab);
+    free(recorder);
+}
+
+bool EncodedRecorderPushVideo(EncodedRecorder *recorder, const EncodedFrameHeader *header, const void *data) {
+    if (!atomic_load_explicit(&recorder->accepting, memory_order_acquire)) {
+        return false;
+    }
+    return EncodedFrameSlabWrite(recorder->videoSlab, header, data);
+}
+
+bool EncodedRecorderPushAudio(EncodedRecorder *recorder, const EncodedFrameHeader *header, const void *data) {
+    if (!atomic_load_explicit(&recorder->accepting, memory_order_acquire) || recorder->config.audioSampleRate == 0) {
+        return false;
+    }
+    return EncodedFrameSlabWrite(recorder->audioSlab, header, data);
+}
+
+void EncodedRecorderGetStats(const EncodedRecorder *recorder, EncodedRecorderStats *stats) {
+    stats->videoFrames = atomic_load_explicit(&recorder->videoFrames, memory_order_relaxed);
+    stats->audioFrames = atomic_load_explicit(&recorder->audioFrames, memory_order_relaxed);
+    stats->videoDrops = EncodedFrameSlabDroppedFrames(recorder->videoSlab);
+    stats->audioDrops = EncodedFrameSlabDroppedFrames(recorder->audioSlab);
+    stats->skippedFrames = atomic_load_explicit(&recorder->skippedFrames, memory_order_relaxed);
+    stats->bytesWritten = atomic_load_explicit(&recorder->bytesWritten, memory_order_relaxed);
+    stats->files = atomic_load_explicit(&recorder->files, memory_order_relaxed);
+    stats->writeErrors = atomic_load_explicit(&recorder->writeErrors, memory_order_relaxed);
+}
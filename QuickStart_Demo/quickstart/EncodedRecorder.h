@@ -0,0 +1,81 @@
+//
+//  EncodedRecorder.h
+//  quickstart
+//
+//  免重编码录制：回调线程把编码帧拷入预分配缓冲，独立 I/O 线程封装落盘
+//
+
+#ifndef EncodedRecorder_h
+#define EncodedRecorder_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "EncodedFrameSlab.h"
+#include "EncodedMuxer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    /// 期望的格式；H.265 等 MP4 不支持的编码自动改用 Annex-B
+    EncodedMuxerFormat format;
+    /// 输出路径前缀，文件名为 <pathPrefix>_<序号>.<扩展名>，Annex-B 的音频为 <pathPrefix>_<序号>.wav
+    const char *pathPrefix;
+    /// 视频、音频缓冲字节数，写盘慢于产生时新帧被丢弃
+    size_t videoSlabBytes;
+    size_t audioSlabBytes;
+    /// PCM 音频采样率与声道数，采样率为 0 表示只录视频
+    uint32_t audioSampleRate;
+    uint32_t audioChannels;
+    /// 分片时长（毫秒），在此之后的第一帧关键帧处切分片
+    uint32_t fragmentDurationMs;
+    /// I/O 线程检查缓冲的间隔（毫秒）
+    uint32_t pollIntervalMs;
+} EncodedRecorderConfig;
+
+/// 默认配置：MP4，视频缓冲 8MB，音频缓冲 1MB，无音频，分片 1 秒，每 10ms 检查一次
+EncodedRecorderConfig EncodedRecorderDefaultConfig(const char *pathPrefix);
+
+/// 计数器，可在任意线程读取
+typedef struct {
+    uint64_t videoFrames;           // 写入文件的视频帧数
+    uint64_t audioFrames;           // 写入文件的音频帧数
+    uint64_t videoDrops;            // 缓冲已满丢弃的视频帧数
+    uint64_t audioDrops;            // 缓冲已满丢弃的音频帧数
+    uint64_t skippedFrames;         // 等待关键帧或无法封装而跳过的视频帧数
+    uint64_t bytesWritten;
+    uint32_t files;                 // 打开过的视频文件数
+    uint32_t writeErrors;
+} EncodedRecorderStats;
+
+typedef struct EncodedRecorder EncodedRecorder;
+
+/// 分配缓冲并启动 I/O 线程，第一个文件在收到第一帧关键帧时创建
+EncodedRecorder *EncodedRecorderCreate(const EncodedRecorderConfig *config);
+
+/// 停止并释放
+void EncodedRecorderDestroy(EncodedRecorder *recorder);
+
+/// 单调时钟（微秒），用于填写 EncodedFrameHeader.arrivalUs
+int64_t EncodedRecorderNowUs(void);
+
+/// 投递一帧视频，只在同一个线程调用；只拷贝数据，不等待磁盘
+/// @return 缓冲已满或已停止时丢弃该帧并返回 false
+bool EncodedRecorderPushVideo(EncodedRecorder *recorder, const EncodedFrameHeader *header, const void *data);
+
+/// 投递一帧 PCM16 音频，只在同一个线程调用；只拷贝数据，不等待磁盘
+bool EncodedRecorderPushAudio(EncodedRecorder *recorder, const EncodedFrameHeader *header, const void *data);
+
+/// 写完缓冲中剩余的帧、关闭文件并结束 I/O 线程；之后投递的帧被丢弃
+void EncodedRecorderStop(EncodedRecorder *recorder);
+
+void EncodedRecorderGetStats(const EncodedRecorder *recorder, EncodedRecorderStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EncodedRecorder_h */
@@ -0,0 +1,54 @@
+//
+//  ExternalAudioBridge.h
+//  quickstart
+//
+//  自定义音频采集/渲染与 SDK 之间的无锁缓冲
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "AudioFrameRing.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 采集线程 → 采集环 → 10ms 定时线程 → pushExternalAudioFrame:
+/// pullExternalAudioFrame: → 10ms 定时线程 → 渲染环 → 渲染线程
+/// @note 采集/渲染线程只访问各自的环，不加锁、不分配内存，不会因为 SDK 调用被阻塞。
+///       两个环各自做自适应抖动缓冲，吸收采集/渲染时钟与 10ms 定时器之间的抖动与漂移。
+@interface ExternalAudioBridge : NSObject
+
+/// @param sampleRate 采样率，每帧 sampleRate / 100 个采样点
+- (instancetype)initWithRTCVideo:(ByteRTCVideo *)rtcVideo
+                      sampleRate:(ByteRTCAudioSampleRate)sampleRate
+                         channel:(ByteRTCAudioChannel)channel
+                     concealment:(AudioFrameRingConcealment)concealment NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 每帧 int16_t 个数（采样点数 × 声道数）
+@property (nonatomic, assign, readonly) NSUInteger frameLength;
+
+/// 是否开启自定义采集，需在 start 前设置，默认 YES
+@property (nonatomic, assign) BOOL captureEnabled;
+/// 是否开启自定义渲染，需在 start 前设置，默认 YES
+@property (nonatomic, assign) BOOL renderEnabled;
+
+/// 切换为自定义采集/渲染并启动 10ms 定时线程
+- (void)start;
+/// 停止定时线程并恢复 SDK 内部采集/渲染
+- (void)stop;
+
+/// 写入一帧采集数据（frameLength 个 S16），只在采集线程调用
+/// @return 采集环已满、该帧被丢弃时返回 NO
+- (BOOL)writeCaptureFrame:(const int16_t *)frame;
+
+/// 读出一帧待播放数据（frameLength 个 S16），只在渲染线程调用；读空时输出隐藏帧或静音
+- (AudioFrameRingReadResult)readRenderFrame:(int16_t *)frame;
+
+/// 采集环计数器
+- (AudioFrameRingStats)captureStats;
+/// 渲染环计数器
+- (AudioFrameRingStats)renderStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
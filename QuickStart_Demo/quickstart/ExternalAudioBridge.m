@@ -0,0 +1,146 @@
+//
+//  ExternalAudioBridge.m
+//  quickstart
+//
+
+#import "ExternalAudioBridge.h"
+
+@interface ExternalAudioBridge () {
+    AudioFrameRing *_captureRing;
+    AudioFrameRing *_renderRing;
+}
+
+@property (nonatomic, weak) ByteRTCVideo *rtcVideo;
+
+/// 10ms 定时线程，push 与 pull 都在这里调用
+@property (nonatomic, strong) dispatch_queue_t pumpQueue;
+@property (nonatomic, strong, nullable) dispatch_source_t pumpTimer;
+
+/// 预分配的帧对象，只在 pumpQueue 中使用
+@property (nonatomic, strong) ByteRTCAudioFrame *pushFrame;
+@property (nonatomic, strong) ByteRTCAudioFrame *pullFrame;
+
+@end
+
+@implementation ExternalAudioBridge
+
+- (instancetype)initWithRTCVideo:(ByteRTCVideo *)rtcVideo
+                      sampleRate:(ByteRTCAudioSampleRate)sampleRate
+                         channel:(ByteRTCAudioChannel)channel
+                     concealment:(AudioFrameRingConcealment)concealment {
+    self = [super init];
+    if (self) {
+        NSParameterAssert(sampleRate > 0 && channel > 0);
+        _rtcVideo = rtcVideo;
+        _captureEnabled = YES;
+        _renderEnabled = YES;
+        size_t samplesPerFrame = (size_t)sampleRate / 100;
+        AudioFrameRingConfig config = AudioFrameRingDefaultConfig(samplesPerFrame, (unsigned)channel);
+        config.concealment = concealment;
+        _captureRing = AudioFrameRingCreate(&config);
+        _renderRing = AudioFrameRingCreate(&config);
+        _frameLength = AudioFrameRingFrameLength(_captureRing);
+
+        _pushFrame = [self audioFrameWithSampleRate:sampleRate channel:channel];
+        _pullFrame = [self audioFrameWithSampleRate:sampleRate channel:channel];
+
+        dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0);
+        _pumpQueue = dispatch_queue_create("com.faceunity.external-audio", attr);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_pumpTimer) {
+        dispatch_source_cancel(_pumpTimer);
+    }
+    AudioFrameRingDestroy(_captureRing);
+    AudioFrameRingDestroy(_renderRing);
+}
+
+- (ByteRTCAudioFrame *)audioFrameWithSampleRate:(ByteRTCAudioSampleRate)sampleRate channel:(ByteRTCAudioChannel)channel {
+    ByteRTCAudioFrame *frame = [[ByteRTCAudioFrame alloc] init];
+    frame.sampleRate = sampleRate;
+    frame.channel = channel;
+    frame.samples = (int)sampleRate / 100;
+    frame.buffer = [NSMutableData dataWithLength:self.frameLength * sizeof(int16_t)];
+    return frame;
+}
+
+- (void)start {
+    if (self.pumpTimer) {
+        return;
+    }
+    if (self.captureEnabled) {
+        [self.rtcVideo setAudioSourceType:ByteRTCAudioSourceTypeExternal];
+    }
+    if (self.renderEnabled) {
+        [self.rtcVideo setAudioRenderType:ByteRTCAudioRenderTypeExternal];
+    }
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, DISPATCH_TIMER_STRICT, self.pumpQueue);
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_MSEC), 10 * NSEC_PER_MSEC, 0);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(timer, ^{
+        [weakSelf pump];
+    });
+    self.pumpTimer = timer;
+    dispatch_resume(timer);
+}
+
+- (void)stop {
+    if (!self.pumpTimer) {
+        return;
+    }
+    dispatch_source_cancel(self.pumpTimer);
+    self.pumpTimer = nil;
+    // 等待正在执行的一次 pump 结束，之后不再调用 SDK
+    dispatch_sync(self.pumpQueue, ^{});
+    if (self.captureEnabled) {
+        [self.rtcVideo setAudioSourceType:ByteRTCAudioSourceTypeInternal];
+    }
+    if (self.renderEnabled) {
+        [self.rtcVideo setAudioRenderType:ByteRTCAudioRenderTypeInternal];
+    }
+}
+
+/// 每 10ms 推送一帧采集数据、拉取一帧播放数据
+- (void)pump {
+    ByteRTCVideo *rtcVideo = self.rtcVideo;
+    if (!rtcVideo) {
+        return;
+    }
+    if (self.captureEnabled) {
+        NSMutableData *buffer = (NSMutableData *)self.pushFrame.buffer;
+        // 预缓冲期间与读空时也推送静音/隐藏帧，保持 SDK 要求的 10ms 节奏
+        AudioFrameRingRead(_captureRing, buffer.mutableBytes);
+        [rtcVideo pushExternalAudioFrame:self.pushFrame];
+    }
+    if (self.renderEnabled) {
+        if ([rtcVideo pullExternalAudioFrame:self.pullFrame] == 0 &&
+            self.pullFrame.buffer.length >= self.frameLength * sizeof(int16_t)) {
+            AudioFrameRingWrite(_renderRing, self.pullFrame.buffer.bytes);
+        }
+    }
+}
+
+- (BOOL)writeCaptureFrame:(const int16_t *)frame {
+    return AudioFrameRingWrite(_captureRing, frame);
+}
+
+- (AudioFrameRingReadResult)readRenderFrame:(int16_t *)frame {
+    return AudioFrameRingRead(_renderRing, frame);
+}
+
+- (AudioFrameRingStats)captureStats {
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(_captureRing, &stats);
+    return stats;
+}
+
+- (AudioFrameRingStats)renderStats {
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(_renderRing, &stats);
+    return stats;
+}
+
+@end
@@ -0,0 +1,59 @@
+//
+//  FaceDetectionStage.h
+//  quickstart
+//
+//  低分辨率人脸检测
+//
+
+#import <Foundation/Foundation.h>
+#import <FURenderKit/FURenderKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 检测图像相对原图的缩放倍数
+typedef NS_ENUM(NSUInteger, FaceDetectionScale) {
+    FaceDetectionScaleFull = 1,         // 原图检测
+    FaceDetectionScaleHalf = 2,         // 1/2 分辨率
+    FaceDetectionScaleQuarter = 4       // 1/4 分辨率
+};
+
+/// 在降采样后的亮度平面上进行人脸检测，并将点位映射回原图坐标
+/// @note 检测耗时与像素数成正比，1/2 分辨率约为原图的 1/4。
+///       开启小脸检测（faceProcessorDetectSmallFace）时远处人脸很小，最低只降到 1/2 分辨率。
+///       非线程安全，只在视频前处理线程中使用。
+@interface FaceDetectionStage : NSObject
+
+/// 期望的缩放倍数，默认 FaceDetectionScaleHalf
+@property (nonatomic, assign) FaceDetectionScale scale;
+
+/// 实际使用的缩放倍数（受小脸检测开关限制）
+@property (nonatomic, assign, readonly) FaceDetectionScale effectiveScale;
+
+/// 对 I420 图像进行人脸检测
+/// @param yPlane 亮度平面
+/// @param stride 亮度平面行字节数
+/// @param width 图像宽
+/// @param height 图像高
+/// @param orientation 图像朝向
+/// @param frontCamera 是否来源于前置摄像头
+/// @return 检测到的人脸数
+- (int)detectFacesWithLumaPlane:(const uint8_t *)yPlane
+                         stride:(size_t)stride
+                          width:(size_t)width
+                         height:(size_t)height
+                    orientation:(FUImageOrientation)orientation
+                    frontCamera:(BOOL)frontCamera;
+
+/// 获取人脸 2D 点位（已映射回原图坐标）
+/// @param faceId 人脸索引
+/// @param points 点位数组，x/y 交替存放
+/// @param count 数组长度（75 个点为 150）
+/// @return 1 成功，0 失败
+- (int)getLandmarks:(float *)points count:(int)count forFace:(int)faceId;
+
+/// 获取人脸矩形框 (xmin, ymin, xmax, ymax)（已映射回原图坐标）
+- (int)getFaceRect:(float *)rect forFace:(int)faceId;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,131 @@
+//
+//  FaceDetectionStage.m
+//  quickstart
+//
+
+#import "FaceDetectionStage.h"
+#import "LumaDownscaler.h"
+
+@interface FaceDetectionStage ()
+
+/// 降采样后的 I420 图像，色度平面固定为 128
+@property (nonatomic, strong) NSMutableData *detectData;
+/// 1/4 降采样的中间结果
+@property (nonatomic, strong) NSMutableData *scratchData;
+
+@property (nonatomic, assign) size_t detectWidth;
+@property (nonatomic, assign) size_t detectHeight;
+/// 最近一次检测所用的缩放倍数
+@property (nonatomic, assign) FaceDetectionScale lastScale;
+
+@property (nonatomic, strong) FUTrackFaceInput *trackInput;
+
+@end
+
+@implementation FaceDetectionStage
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _scale = FaceDetectionScaleHalf;
+        _lastScale = FaceDetectionScaleFull;
+        _trackInput = [[FUTrackFaceInput alloc] init];
+        _trackInput.trackFaceConfig = [[FUTrackFaceConfig alloc] init];
+        _trackInput.trackFaceConfig.gravityEnable = YES;
+    }
+    return self;
+}
+
+- (FaceDetectionScale)effectiveScale {
+    if ([FUAIKit shareKit].faceProcessorDetectSmallFace && self.scale > FaceDetectionScaleHalf) {
+        return FaceDetectionScaleHalf;
+    }
+    return self.scale;
+}
+
+- (int)detectFacesWithLumaPlane:(const uint8_t *)yPlane
+                         stride:(size_t)stride
+                          width:(size_t)width
+                         height:(size_t)height
+                    orientation:(FUImageOrientation)orientation
+                    frontCamera:(BOOL)frontCamera {
+    FaceDetectionScale scale = self.effectiveScale;
+    // 保证降采样后宽高为偶数，色度平面可以整除
+    size_t detectWidth = (width / scale) & ~(size_t)1;
+    size_t detectHeight = (height / scale) & ~(size_t)1;
+    if (detectWidth == 0 || detectHeight == 0) {
+        return 0;
+    }
+    if (scale != self.lastScale) {
+        // 检测尺寸变化，旧的跟踪结果坐标系不一致
+        [FUAIKit resetTrackedResult];
+        self.lastScale = scale;
+    }
+    uint8_t *y = [self prepareBuffersWithWidth:detectWidth height:detectHeight];
+    uint8_t *u = y + detectWidth * detectHeight;
+    uint8_t *v = u + (detectWidth / 2) * (detectHeight / 2);
+    switch (scale) {
+        case FaceDetectionScaleFull:
+            for (size_t row = 0; row < detectHeight; row++) {
+                memcpy(y + row * detectWidth, yPlane + row * stride, detectWidth);
+            }
+            break;
+        case FaceDetectionScaleHalf:
+            LumaDownscaleHalf(yPlane, stride, detectWidth * 2, detectHeight * 2, y, detectWidth);
+            break;
+        case FaceDetectionScaleQuarter:
+            if (self.scratchData.length < detectWidth * detectHeight * 4) {
+                self.scratchData = [NSMutableData dataWithLength:detectWidth * detectHeight * 4];
+            }
+            LumaDownscaleQuarter(yPlane, stride, detectWidth * 4, detectHeight * 4, y, detectWidth, self.scratchData.mutableBytes);
+            break;
+    }
+    self.trackInput.imageBuffer = FUImageBufferMakeI420(y, u, v, detectWidth, detectHeight, detectWidth, detectWidth / 2, detectWidth / 2);
+    self.trackInput.trackFaceConfig.imageOrientation = orientation;
+    self.trackInput.trackFaceConfig.isFromFrontCamera = frontCamera;
+    return [FUAIKit trackFaceWithInput:self.trackInput];
+}
+
+- (int)getLandmarks:(float *)points count:(int)count forFace:(int)faceId {
+    int result = [FUAIKit getFaceInfo:faceId name:@"landmarks" pret:points number:count];
+    if (result) {
+        [self backProjectPoints:points count:count];
+    }
+    return result;
+}
+
+- (int)getFaceRect:(float *)rect forFace:(int)faceId {
+    int result = [FUAIKit getFaceInfo:faceId name:@"face_rect" pret:rect number:4];
+    if (result) {
+        [self backProjectPoints:rect count:4];
+    }
+    return result;
+}
+
+#pragma mark - Private methods
+
+/// 检测坐标映射回原图坐标
+- (void)backProjectPoints:(float *)points count:(int)count {
+    if (self.lastScale == FaceDetectionScaleFull) {
+        return;
+    }
+    float factor = (float)self.lastScale;
+    for (int i = 0; i < count; i++) {
+        points[i] *= factor;
+    }
+}
+
+- (uint8_t *)prepareBuffersWithWidth:(size_t)width height:(size_t)height {
+    if (width != self.detectWidth || height != self.detectHeight) {
+        size_t lumaSize = width * height;
+        size_t chromaSize = (width / 2) * (height / 2);
+        self.detectData = [NSMutableData dataWithLength:lumaSize + chromaSize * 2];
+        // 只检测亮度，色度固定为中性灰
+        memset((uint8_t *)self.detectData.mutableBytes + lumaSize, 128, chromaSize * 2);
+        self.detectWidth = width;
+        self.detectHeight = height;
+    }
+    return self.detectData.mutableBytes;
+}
+
+@end
@@ -0,0 +1,561 @@
+//
+//  FaceLandmarkCodec.c
+//  quickstart
+//
+
+#include "FaceLandmarkCodec.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 记录格式（多字节整数为小端序）：
+//   magic(1) version<<4|flags(1) sequence(1) faceCount(1)
+//   关键帧：timestampUs(8) width(2) height(2) quantBits(1)
+//           每张脸 pointCount(1)，随后 4 + 2 * pointCount 个 quantBits 位的量化坐标，按字节对齐
+//   差分：  zigzag varint 的时间戳差
+//           每张脸 bitWidth(1)，随后同样个数的 bitWidth 位 zigzag 差值，按字节对齐
+#define FACE_LANDMARK_MAGIC 0xFA
+#define FACE_LANDMARK_VERSION 1
+#define FACE_LANDMARK_FLAG_KEYFRAME 0x01
+/// 每张脸的量化值个数：人脸框 4 个 + 点位
+#define FACE_LANDMARK_MAX_VALUES (4 + 2 * FACE_LANDMARK_MAX_POINTS)
+
+/// 量化后的一帧，编码端与解码端各保存一份作为差分的参考
+typedef struct {
+    int64_t timestampUs;
+    uint32_t width;
+    uint32_t height;
+    uint32_t faceCount;
+    uint32_t pointCounts[FACE_LANDMARK_MAX_FACES];
+    uint16_t values[FACE_LANDMARK_MAX_FACES][FACE_LANDMARK_MAX_VALUES];
+} FaceLandmarkQuantized;
+
+static inline uint32_t FaceLandmarkValueCount(uint32_t pointCount) {
+    return 4 + 2 * pointCount;
+}
+
+static inline uint32_t FaceLandmarkZigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t FaceLandmarkUnzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Bit stream
+
+typedef struct {
+    uint8_t *data;
+    size_t capacity;
+    size_t size;
+    uint64_t accumulator;
+    unsigned bits;
+    bool overflow;
+} FaceLandmarkWriter;
+
+static void FaceLandmarkPutByte(FaceLandmarkWriter *writer, uint8_t byte) {
+    if (writer->size == writer->capacity) {
+        writer->overflow = true;
+        return;
+    }
+    writer->data[writer->size++] = byte;
+}
+
+static void FaceLandmarkPutLE(FaceLandmarkWriter *writer, uint64_t value, unsigned bytes) {
+    for (unsigned i = 0; i < bytes; i++) {
+        FaceLandmarkPutByte(writer, (uint8_t)(value >> (8 * i)));
+    }
+}
+
+static void FaceLandmarkPutVarint(FaceLandmarkWriter *writer, uint64_t value) {
+    while (value >= 0x80) {
+        FaceLandmarkPutByte(writer, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    FaceLandmarkPutByte(writer, (uint8_t)value);
+}
+
+static void FaceLandmarkPutBits(FaceLandmarkWriter *writer, uint32_t value, unsigned count) {
+    writer->accumulator |= (uint64_t)value << writer->bits;
+    writer->bits += count;
+    while (writer->bits >= 8) {
+        FaceLandmarkPutByte(writer, (uint8_t)writer->accumulator);
+        writer->accumulator >>= 8;
+        writer->bits -= 8;
+    }
+}
+
+static void FaceLandmarkAlignBits(FaceLandmarkWriter *writer) {
+    if (writer->bits > 0) {
+        FaceLandmarkPutByte(writer, (uint8_t)writer->accumulator);
+    }
+    writer->accumulator = 0;
+    writer->bits = 0;
+}
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t position;
+    uint64_t accumulator;
+    unsigned bits;
+    bool overflow;
+} FaceLandmarkReader;
+
+static uint8_t FaceLandmarkGetByte(FaceLandmarkReader *reader) {
+    if (reader->position == reader->size) {
+        reader->overflow = true;
+        return 0;
+    }
+    return reader->data[reader->position++];
+}
+
+static uint64_t FaceLandmarkGetLE(FaceLandmarkReader *reader, unsigned bytes) {
+    uint64_t value = 0;
+    for (unsigned i = 0; i < bytes; i++) {
+        value |= (uint64_t)FaceLandmarkGetByte(reader) << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t FaceLandmarkGetVarint(FaceLandmarkReader *reader) {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = FaceLandmarkGetByte(reader);
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    reader->overflow = true;
+    return 0;
+}
+
+static uint32_t FaceLandmarkGetBits(FaceLandmarkReader *reader, unsigned count) {
+    while (reader->bits < count) {
+        reader->accumulator |= (uint64_t)FaceLandmarkGetByte(reader) << reader->bits;
+        reader->bits += 8;
+    }
+    uint32_t value = (uint32_t)(reader->accumulator & ((1ULL << count) - 1));
+    reader->accumulator >>= count;
+    reader->bits -= count;
+    return value;
+}
+
+static void FaceLandmarkAlignRead(FaceLandmarkReader *reader) {
+    reader->accumulator = 0;
+    reader->bits = 0;
+}
+
+// Quantization
+
+static uint16_t FaceLandmarkQuantize(float value, uint32_t dimension, uint32_t maxValue) {
+    float normalized = value / (float)dimension;
+    if (!(normalized > 0.0f)) {
+        return 0;
+    }
+    if (normalized >= 1.0f) {
+        return (uint16_t)maxValue;
+    }
+    return (uint16_t)lrintf(normalized * (float)maxValue);
+}
+
+static float FaceLandmarkDequantize(uint16_t value, uint32_t dimension, uint32_t maxValue) {
+    return (float)value * (float)dimension / (float)maxValue;
+}
+
+static void FaceLandmarkQuantizeFrame(const FaceLandmarkFrame *frame, uint32_t quantBits, FaceLandmarkQuantized *out) {
+    uint32_t maxValue = (1u << quantBits) - 1;
+    out->timestampUs = frame->timestampUs;
+    out->width = frame->width;
+    out->height = frame->height;
+    out->faceCount = frame->faceCount;
+    for (uint32_t f = 0; f < frame->faceCount; f++) {
+        const FaceLandmarkFace *face = &frame->faces[f];
+        uint16_t *values = out->values[f];
+        out->pointCounts[f] = face->pointCount;
+        // 偶数下标为 x，奇数为 y，人脸框与点位相同
+        for (int i = 0; i < 4; i++) {
+            values[i] = FaceLandmarkQuantize(face->rect[i], i % 2 ? frame->height : frame->width, maxValue);
+        }
+        for (uint32_t i = 0; i < 2 * face->pointCount; i++) {
+            values[4 + i] = FaceLandmarkQuantize(face->points[i], i % 2 ? frame->height : frame->width, maxValue);
+        }
+    }
+}
+
+static void FaceLandmarkDequantizeFrame(const FaceLandmarkQuantized *quantized, uint32_t quantBits,
+                                        FaceLandmarkFrame *frame) {
+    uint32_t maxValue = (1u << quantBits) - 1;
+    frame->timestampUs = quantized->timestampUs;
+    frame->width = quantized->width;
+    frame->height = quantized->height;
+    frame->faceCount = quantized->faceCount;
+    for (uint32_t f = 0; f < quantized->faceCount; f++) {
+        FaceLandmarkFace *face = &frame->faces[f];
+        const uint16_t *values = quantized->values[f];
+        face->pointCount = quantized->pointCounts[f];
+        for (int i = 0; i < 4; i++) {
+            face->rect[i] = FaceLandmarkDequantize(values[i], i % 2 ? quantized->height : quantized->width, maxValue);
+        }
+        for (uint32_t i = 0; i < 2 * face->pointCount; i++) {
+            face->points[i] =
+                FaceLandmarkDequantize(values[4 + i], i % 2 ? quantized->height : quantized->width, maxValue);
+        }
+    }
+}
+
+/// 人脸数、点数与尺寸一致时才能差分
+static bool FaceLandmarkSameLayout(const FaceLandmarkQuantized *a, const FaceLandmarkQuantized *b) {
+    if (a->faceCount != b->faceCount || a->width != b->width || a->height != b->height) {
+        return false;
+    }
+    for (uint32_t f = 0; f < a->faceCount; f++) {
+        if (a->pointCounts[f] != b->pointCounts[f]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Encoder
+
+struct FaceLandmarkEncoder {
+    FaceLandmarkEncoderConfig config;
+    FaceLandmarkQuantized previous;
+    FaceLandmarkQuantized current;
+    bool hasPrevious;
+    bool forceKeyframe;
+    uint32_t sinceKeyframe;
+    uint8_t sequence;
+};
+
+FaceLandmarkEncoderConfig FaceLandmarkEncoderDefaultConfig(void) {
+    FaceLandmarkEncoderConfig config = {
+        .quantBits = 12,
+        .keyframeInterval = 30,
+    };
+    return config;
+}
+
+FaceLandmarkEncoder *FaceLandmarkEncoderCreate(const FaceLandmarkEncoderConfig *config) {
+    if (!config || config->quantBits < 8 || config->quantBits > 16 || config->keyframeInterval == 0) {
+        return NULL;
+    }
+    FaceLandmarkEncoder *encoder = calloc(1, sizeof(FaceLandmarkEncoder));
+    if (!encoder) {
+        return NULL;
+    }
+    encoder->config = *config;
+    return encoder;
+}
+
+void FaceLandmarkEncoderDestroy(FaceLandmarkEncoder *encoder) {
+    free(encoder);
+}
+
+void FaceLandmarkEncoderForceKeyframe(FaceLandmarkEncoder *encoder) {
+    encoder->forceKeyframe = true;
+}
+
+size_t FaceLandmarkEncoderEncode(FaceLandmarkEncoder *encoder, const FaceLandmarkFrame *frame, uint8_t *out,
+                                 size_t capacity) {
+    if (!frame || frame->faceCount > FACE_LANDMARK_MAX_FACES || frame->width == 0 || frame->height == 0 ||
+        frame->width > UINT16_MAX || frame->height > UINT16_MAX) {
+        return 0;
+    }
+    for (uint32_t f = 0; f < frame->faceCount; f++) {
+        if (frame->faces[f].pointCount > FACE_LANDMARK_MAX_POINTS) {
+            return 0;
+        }
+    }
+    FaceLandmarkQuantized *current = &encoder->current;
+    FaceLandmarkQuantized *previous = &encoder->previous;
+    FaceLandmarkQuantizeFrame(frame, encoder->config.quantBits, current);
+    bool keyframe = !encoder->hasPrevious || encoder->forceKeyframe ||
+                    encoder->sinceKeyframe + 1 >= encoder->config.keyframeInterval ||
+                    !FaceLandmarkSameLayout(current, previous) || current->timestampUs < previous->timestampUs;
+
+    FaceLandmarkWriter writer = {.data = out, .capacity = capacity};
+    FaceLandmarkPutByte(&writer, FACE_LANDMARK_MAGIC);
+    FaceLandmarkPutByte(&writer, (FACE_LANDMARK_VERSION << 4) | (keyframe ? FACE_LANDMARK_FLAG_KEYFRAME : 0));
+    FaceLandmarkPutByte(&writer, encoder->sequence);
+    FaceLandmarkPutByte(&writer, (uint8_t)current->faceCount);
+    if (keyframe) {
+        FaceLandmarkPutLE(&writer, (uint64_t)current->timestampUs, 8);
+        FaceLandmarkPutLE(&writer, current->width, 2);
+        FaceLandmarkPutLE(&writer, current->height, 2);
+        FaceLandmarkPutByte(&writer, (uint8_t)encoder->config.quantBits);
+    } else {
+        int64_t delta = current->timestampUs - previous->timestampUs;
+        FaceLandmarkPutVarint(&writer, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    }
+    for (uint32_t f = 0; f < current->faceCount; f++) {
+        uint32_t count = FaceLandmarkValueCount(current->pointCounts[f]);
+        const uint16_t *values = current->values[f];
+        if (keyframe) {
+            FaceLandmarkPutByte(&writer, (uint8_t)current->pointCounts[f]);
+            for (uint32_t i = 0; i < count; i++) {
+                FaceLandmarkPutBits(&writer, values[i], encoder->config.quantBits);
+            }
+        } else {
+            // 整张脸用同一位宽，静止时为 0 位，只占 1 字节
+            const uint16_t *reference = previous->values[f];
+            uint32_t maxZigzag = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t zigzag = FaceLandmarkZigzag((int32_t)values[i] - (int32_t)reference[i]);
+                maxZigzag = zigzag > maxZigzag ? zigzag : maxZigzag;
+            }
+            unsigned bitWidth = 0;
+            while (bitWidth < 32 && (maxZigzag >> bitWidth) != 0) {
+                bitWidth++;
+            }
+            FaceLandmarkPutByte(&writer, (uint8_t)bitWidth);
+            if (bitWidth > 0) {
+                for (uint32_t i = 0; i < count; i++) {
+                    FaceLandmarkPutBits(&writer, FaceLandmarkZigzag((int32_t)values[i] - (int32_t)reference[i]),
+                                        bitWidth);
+                }
+            }
+        }
+        FaceLandmarkAlignBits(&writer);
+    }
+    if (writer.overflow) {
+        return 0;
+    }
+    FaceLandmarkQuantized swap = *previous;
+    *previous = *current;
+    *current = swap;
+    encoder->hasPrevious = true;
+    encoder->forceKeyframe = false;
+    encoder->sinceKeyframe = keyframe ? 0 : encoder->sinceKeyframe + 1;
+    encoder->sequence++;
+    return writer.size;
+}
+
+// Decoder
+
+typedef struct {
+    FaceLandmarkFrame frame;
+    int64_t arrivalUs;
+} FaceLandmarkHistoryEntry;
+
+struct FaceLandmarkDecoder {
+    FaceLandmarkQuantized reference;
+    FaceLandmarkQuantized scratch;
+    uint32_t quantBits;
+    bool hasReference;
+    uint8_t sequence;
+    /// 按时间戳递增的环形历史
+    FaceLandmarkHistoryEntry *history;
+    size_t historyCapacity;
+    size_t historyStart;
+    size_t historyCount;
+};
+
+FaceLandmarkDecoder *FaceLandmarkDecoderCreate(size_t historyCount) {
+    if (historyCount < 2) {
+        return NULL;
+    }
+    FaceLandmarkDecoder *decoder = calloc(1, sizeof(FaceLandmarkDecoder));
+    if (!decoder) {
+        return NULL;
+    }
+    decoder->history = calloc(historyCount, sizeof(FaceLandmarkHistoryEntry));
+    if (!decoder->history) {
+        free(decoder);
+        return NULL;
+    }
+    decoder->historyCapacity = historyCount;
+    return decoder;
+}
+
+void FaceLandmarkDecoderDestroy(FaceLandmarkDecoder *decoder) {
+    if (!decoder) {
+        return;
+    }
+    free(decoder->history);
+    free(decoder);
+}
+
+void FaceLandmarkDecoderReset(FaceLandmarkDecoder *decoder) {
+    decoder->hasReference = false;
+    decoder->historyStart = 0;
+    decoder->historyCount = 0;
+}
+
+static const FaceLandmarkHistoryEntry *FaceLandmarkHistoryAt(const FaceLandmarkDecoder *decoder, size_t index) {
+    return &decoder->history[(decoder->historyStart + index) % decoder->historyCapacity];
+}
+
+static void FaceLandmarkHistoryAppend(FaceLandmarkDecoder *decoder, int64_t arrivalUs) {
+    if (decoder->historyCount > 0 &&
+        FaceLandmarkHistoryAt(decoder, decoder->historyCount - 1)->frame.timestampUs >= decoder->scratch.timestampUs) {
+        // 发送端时间戳回退（如重新开始采集），旧历史不再可比
+        decoder->historyCount = 0;
+    }
+    size_t slot;
+    if (decoder->historyCount == decoder->historyCapacity) {
+        slot = decoder->historyStart;
+        decoder->historyStart = (decoder->historyStart + 1) % decoder->historyCapacity;
+    } else {
+        slot = (decoder->historyStart + decoder->historyCount) % decoder->historyCapacity;
+        decoder->historyCount++;
+    }
+    FaceLandmarkDequantizeFrame(&decoder->scratch, decoder->quantBits, &decoder->history[slot].frame);
+    decoder->history[slot].arrivalUs = arrivalUs;
+}
+
+FaceLandmarkDecodeResult FaceLandmarkDecoderDecode(FaceLandmarkDecoder *decoder, const uint8_t *data, size_t size,
+                                                   int64_t arrivalUs, FaceLandmarkFrame *frame) {
+    FaceLandmarkReader reader = {.data = data, .size = size};
+    uint8_t magic = FaceLandmarkGetByte(&reader);
+    uint8_t versionFlags = FaceLandmarkGetByte(&reader);
+    uint8_t sequence = FaceLandmarkGetByte(&reader);
+    uint32_t faceCount = FaceLandmarkGetByte(&reader);
+    if (reader.overflow || magic != FACE_LANDMARK_MAGIC || (versionFlags >> 4) != FACE_LANDMARK_VERSION ||
+        faceCount > FACE_LANDMARK_MAX_FACES) {
+        return FaceLandmarkDecodeInvalid;
+    }
+    bool keyframe = versionFlags & FACE_LANDMARK_FLAG_KEYFRAME;
+    if (decoder->hasReference && sequence == decoder->sequence) {
+        // 序号相同的关键帧也可能来自重新开始的发送端，再比较时间戳
+        FaceLandmarkReader peek = reader;
+        if (!keyframe || (int64_t)FaceLandmarkGetLE(&peek, 8) == decoder->reference.timestampUs) {
+            return FaceLandmarkDecodeDuplicate;
+        }
+    }
+    if (!keyframe && (!decoder->hasReference || sequence != (uint8_t)(decoder->sequence + 1))) {
+        decoder->hasReference = false;
+        return FaceLandmarkDecodeWaitingKeyframe;
+    }
+
+    // 先解到 scratch，完整校验后再替换参考帧
+    FaceLandmarkQuantized *out = &decoder->scratch;
+    const FaceLandmarkQuantized *reference = &decoder->reference;
+    uint32_t quantBits = decoder->quantBits;
+    out->faceCount = faceCount;
+    if (keyframe) {
+        out->timestampUs = (int64_t)FaceLandmarkGetLE(&reader, 8);
+        out->width = (uint32_t)FaceLandmarkGetLE(&reader, 2);
+        out->height = (uint32_t)FaceLandmarkGetLE(&reader, 2);
+        quantBits = FaceLandmarkGetByte(&reader);
+        if (quantBits < 8 || quantBits > 16 || out->width == 0 || out->height == 0) {
+            return FaceLandmarkDecodeInvalid;
+        }
+    } else {
+        if (faceCount != reference->faceCount) {
+            return FaceLandmarkDecodeInvalid;
+        }
+        uint64_t zigzag = FaceLandmarkGetVarint(&reader);
+        out->timestampUs = reference->timestampUs + (int64_t)((zigzag >> 1) ^ -(zigzag & 1));
+        out->width = reference->width;
+        out->height = reference->height;
+    }
+    uint32_t maxValue = (1u << quantBits) - 1;
+    for (uint32_t f = 0; f < faceCount && !reader.overflow; f++) {
+        uint16_t *values = out->values[f];
+        if (keyframe) {
+            uint32_t pointCount = FaceLandmarkGetByte(&reader);
+            if (pointCount > FACE_LANDMARK_MAX_POINTS) {
+                return FaceLandmarkDecodeInvalid;
+            }
+            out->pointCounts[f] = pointCount;
+            uint32_t count = FaceLandmarkValueCount(pointCount);
+            for (uint32_t i = 0; i < count; i++) {
+                values[i] = (uint16_t)FaceLandmarkGetBits(&reader, quantBits);
+            }
+        } else {
+            out->pointCounts[f] = reference->pointCounts[f];
+            uint32_t count = FaceLandmarkValueCount(out->pointCounts[f]);
+            unsigned bitWidth = FaceLandmarkGetByte(&reader);
+            if (bitWidth > quantBits + 1) {
+                return FaceLandmarkDecodeInvalid;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                int32_t value = (int32_t)reference->values[f][i];
+                if (bitWidth > 0) {
+                    value += FaceLandmarkUnzigzag(FaceLandmarkGetBits(&reader, bitWidth));
+                }
+                if (value < 0 || value > (int32_t)maxValue) {
+                    return FaceLandmarkDecodeInvalid;
+                }
+                values[i] = (uint16_t)value;
+            }
+        }
+        FaceLandmarkAlignRead(&reader);
+    }
+    if (reader.overflow) {
+        return FaceLandmarkDecodeInvalid;
+    }
+    decoder->quantBits = quantBits;
+    decoder->sequence = sequence;
+    decoder->hasReference = true;
+    FaceLandmarkHistoryAppend(decoder, arrivalUs);
+    if (frame) {
+        FaceLandmarkDequantizeFrame(out, quantBits, frame);
+    }
+    FaceLandmarkQuantized swap = decoder->reference;
+    decoder->reference = *out;
+    decoder->scratch = swap;
+    return FaceLandmarkDecodeOk;
+}
+
+static bool FaceLandmarkFramesInterpolatable(const FaceLandmarkFrame *a, const FaceLandmarkFrame *b) {
+    if (a->faceCount != b->faceCount || a->width != b->width || a->height != b->height) {
+        return false;
+    }
+    for (uint32_t f = 0; f < a->faceCount; f++) {
+        if (a->faces[f].pointCount != b->faces[f].pointCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FaceLandmarkDecoderSample(const FaceLandmarkDecoder *decoder, int64_t timestampUs, FaceLandmarkFrame *frame) {
+    if (decoder->historyCount == 0) {
+        return false;
+    }
+    // 最后一条时间戳不大于目标的记录；目标早于所有记录时取最早一条
+    size_t before = 0;
+    while (before + 1 < decoder->historyCount &&
+           FaceLandmarkHistoryAt(decoder, before + 1)->frame.timestampUs <= timestampUs) {
+        before++;
+    }
+    const FaceLandmarkFrame *a = &FaceLandmarkHistoryAt(decoder, before)->frame;
+    *frame = *a;
+    if (before + 1 == decoder->historyCount || a->timestampUs >= timestampUs) {
+        return true;
+    }
+    const FaceLandmarkFrame *b = &FaceLandmarkHistoryAt(decoder, before + 1)->frame;
+    if (!FaceLandmarkFramesInterpolatable(a, b)) {
+        return true;
+    }
+    float t = (float)(timestampUs - a->timestampUs) / (float)(b->timestampUs - a->timestampUs);
+    frame->timestampUs = timestampUs;
+    for (uint32_t f = 0; f < a->faceCount; f++) {
+        FaceLandmarkFace *face = &frame->faces[f];
+        for (int i = 0; i < 4; i++) {
+            face->rect[i] = a->faces[f].rect[i] + (b->faces[f].rect[i] - a->faces[f].rect[i]) * t;
+        }
+        for (uint32_t i = 0; i < 2 * face->pointCount; i++) {
+            face->points[i] = a->faces[f].points[i] + (b->faces[f].points[i] - a->faces[f].points[i]) * t;
+        }
+    }
+    return true;
+}
+
+int64_t FaceLandmarkDecoderSenderTimeUs(const FaceLandmarkDecoder *decoder, int64_t localUs) {
+    if (decoder->historyCount == 0) {
+        return INT64_MIN;
+    }
+    int64_t offset = INT64_MAX;
+    for (size_t i = 0; i < decoder->historyCount; i++) {
+        const FaceLandmarkHistoryEntry *entry = FaceLandmarkHistoryAt(decoder, i);
+        int64_t candidate = entry->arrivalUs - entry->frame.timestampUs;
+        offset = candidate < offset ? candidate : offset;
+    }
+    return localUs - offset;
+}
@@ -0,0 +1,111 @@
+//
+//  FaceLandmarkCodec.h
+//  quickstart
+//
+//  人脸点位编解码：量化后以关键帧 + 差分的紧凑二进制记录随 SEI 发送
+//
+
+#ifndef FaceLandmarkCodec_h
+#define FaceLandmarkCodec_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 一条记录最多的人脸数与每张脸的点数（FaceUnity 2D 点位为 75 个）
+#define FACE_LANDMARK_MAX_FACES 4
+#define FACE_LANDMARK_MAX_POINTS 75
+/// 一条记录的最大字节数，远小于 SEI 建议的 4KB
+#define FACE_LANDMARK_MAX_RECORD_BYTES (24 + FACE_LANDMARK_MAX_FACES * (2 + (4 + 2 * FACE_LANDMARK_MAX_POINTS) * 17 / 8 + 1))
+
+typedef struct {
+    /// 人脸框 (xmin, ymin, xmax, ymax)，像素坐标
+    float rect[4];
+    /// 点数，0 表示只有人脸框（如证书不支持点位）
+    uint32_t pointCount;
+    /// 点位，x/y 交替存放，像素坐标
+    float points[2 * FACE_LANDMARK_MAX_POINTS];
+} FaceLandmarkFace;
+
+typedef struct {
+    /// 发送端视频帧的时间戳（微秒）
+    int64_t timestampUs;
+    /// 坐标所在图像的宽高，量化时按此归一化
+    uint32_t width;
+    uint32_t height;
+    uint32_t faceCount;
+    FaceLandmarkFace faces[FACE_LANDMARK_MAX_FACES];
+} FaceLandmarkFrame;
+
+// Encoder
+
+typedef struct {
+    /// 每个坐标的量化位数，8～16；12 位在 1280 宽时误差不超过 0.16 像素
+    uint32_t quantBits;
+    /// 每隔多少条记录发一次关键帧，中途加入或丢失 SEI 的接收端最多等这么多帧
+    uint32_t keyframeInterval;
+} FaceLandmarkEncoderConfig;
+
+/// 默认配置：12 位量化，每 30 条记录一个关键帧
+FaceLandmarkEncoderConfig FaceLandmarkEncoderDefaultConfig(void);
+
+typedef struct FaceLandmarkEncoder FaceLandmarkEncoder;
+
+FaceLandmarkEncoder *FaceLandmarkEncoderCreate(const FaceLandmarkEncoderConfig *config);
+
+void FaceLandmarkEncoderDestroy(FaceLandmarkEncoder *encoder);
+
+/// 编码一帧。人脸数、点数或图像尺寸变化时自动发关键帧，否则发相对上一条记录的差分
+/// @param capacity out 的字节数，FACE_LANDMARK_MAX_RECORD_BYTES 总是足够
+/// @return 写入的字节数，参数非法或空间不足时返回 0
+size_t FaceLandmarkEncoderEncode(FaceLandmarkEncoder *encoder, const FaceLandmarkFrame *frame, uint8_t *out,
+                                 size_t capacity);
+
+/// 下一条记录强制为关键帧，如有新用户加入时
+void FaceLandmarkEncoderForceKeyframe(FaceLandmarkEncoder *encoder);
+
+// Decoder
+
+typedef enum {
+    FaceLandmarkDecodeOk = 0,
+    /// 重复收到的记录（SEI 重发），已忽略
+    FaceLandmarkDecodeDuplicate,
+    /// 差分记录之前有丢失，等待下一个关键帧
+    FaceLandmarkDecodeWaitingKeyframe,
+    /// 不是人脸点位记录或数据损坏
+    FaceLandmarkDecodeInvalid,
+} FaceLandmarkDecodeResult;
+
+typedef struct FaceLandmarkDecoder FaceLandmarkDecoder;
+
+/// @param historyCount 保留最近多少帧用于按时间戳插值，至少 2
+FaceLandmarkDecoder *FaceLandmarkDecoderCreate(size_t historyCount);
+
+void FaceLandmarkDecoderDestroy(FaceLandmarkDecoder *decoder);
+
+/// 清空状态，如发送端重新进房时
+void FaceLandmarkDecoderReset(FaceLandmarkDecoder *decoder);
+
+/// 解码一条记录并加入历史
+/// @param arrivalUs 接收端单调时钟（微秒），用于估计发送端时间轴
+/// @param frame 解码结果，可为 NULL
+FaceLandmarkDecodeResult FaceLandmarkDecoderDecode(FaceLandmarkDecoder *decoder, const uint8_t *data, size_t size,
+                                                   int64_t arrivalUs, FaceLandmarkFrame *frame);
+
+/// 发送端时间轴上 timestampUs 时刻的人脸：落在两条记录之间且人脸数、点数一致时线性插值，否则取之前最近的一条
+/// @return 还没有解码出任何记录时返回 false
+bool FaceLandmarkDecoderSample(const FaceLandmarkDecoder *decoder, int64_t timestampUs, FaceLandmarkFrame *frame);
+
+/// 把接收端单调时钟换算到发送端时间轴：取最近记录中到达时间与时间戳之差的最小值，即传输最快的一条
+/// @return 还没有解码出任何记录时返回 INT64_MIN
+int64_t FaceLandmarkDecoderSenderTimeUs(const FaceLandmarkDecoder *decoder, int64_t localUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FaceLandmarkCodec_h */
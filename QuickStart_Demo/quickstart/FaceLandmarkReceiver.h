@@ -0,0 +1,32 @@
+//
+//  FaceLandmarkReceiver.h
+//  quickstart
+//
+//  人脸点位接收：从远端 SEI 还原发送端的跟踪结果，按时间戳对齐
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "FaceLandmarkCodec.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 每个远端用户一个 FaceLandmarkDecoder，保留最近 8 帧用于插值。
+/// @note receiveSEIMessage:fromStream: 在 SDK 回调线程调用，其余方法可在任意线程调用。
+@interface FaceLandmarkReceiver : NSObject
+
+/// 解码 rtcEngine:onSEIMessageReceived:andMessage: 收到的消息
+/// @return 不是人脸点位记录时返回 NO，可交给其他 SEI 处理逻辑
+- (BOOL)receiveSEIMessage:(NSData *)message fromStream:(ByteRTCRemoteStreamKey *)streamKey;
+
+/// 远端用户此刻的人脸，坐标为发送端图像的像素坐标（frame.width × frame.height）
+/// @param delayUs 在发送端时间轴上往回退的时长，用于匹配渲染延迟；0 表示最新
+/// @return 还没有收到该用户的记录时返回 NO
+- (BOOL)facesOfUserId:(NSString *)userId delayUs:(int64_t)delayUs frame:(FaceLandmarkFrame *)frame;
+
+/// 用户离开房间时释放其解码状态
+- (void)removeUserId:(NSString *)userId;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,92 @@
+//
+//  FaceLandmarkReceiver.m
+//  quickstart
+//
+
+#import "FaceLandmarkReceiver.h"
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+
+#define FACE_LANDMARK_RECEIVER_HISTORY 8
+
+@interface FaceLandmarkUserState : NSObject {
+@public
+    FaceLandmarkDecoder *_decoder;
+}
+@end
+
+@implementation FaceLandmarkUserState
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _decoder = FaceLandmarkDecoderCreate(FACE_LANDMARK_RECEIVER_HISTORY);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    FaceLandmarkDecoderDestroy(_decoder);
+}
+
+@end
+
+@interface FaceLandmarkReceiver () {
+    os_unfair_lock _lock;
+}
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, FaceLandmarkUserState *> *users;
+
+@end
+
+@implementation FaceLandmarkReceiver
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _users = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+static inline int64_t FaceLandmarkReceiverNowUs(void) {
+    return (int64_t)(CACurrentMediaTime() * 1000000.0);
+}
+
+- (BOOL)receiveSEIMessage:(NSData *)message fromStream:(ByteRTCRemoteStreamKey *)streamKey {
+    if (streamKey.streamIndex != ByteRTCStreamIndexMain || !streamKey.userId) {
+        return NO;
+    }
+    int64_t arrivalUs = FaceLandmarkReceiverNowUs();
+    os_unfair_lock_lock(&_lock);
+    FaceLandmarkUserState *state = self.users[streamKey.userId];
+    if (!state) {
+        state = [[FaceLandmarkUserState alloc] init];
+        self.users[streamKey.userId] = state;
+    }
+    FaceLandmarkDecodeResult result = FaceLandmarkDecoderDecode(state->_decoder, message.bytes, message.length, arrivalUs, NULL);
+    os_unfair_lock_unlock(&_lock);
+    return result != FaceLandmarkDecodeInvalid;
+}
+
+- (BOOL)facesOfUserId:(NSString *)userId delayUs:(int64_t)delayUs frame:(FaceLandmarkFrame *)frame {
+    int64_t nowUs = FaceLandmarkReceiverNowUs();
+    BOOL found = NO;
+    os_unfair_lock_lock(&_lock);
+    FaceLandmarkUserState *state = self.users[userId];
+    if (state) {
+        int64_t senderUs = FaceLandmarkDecoderSenderTimeUs(state->_decoder, nowUs);
+        found = senderUs != INT64_MIN && FaceLandmarkDecoderSample(state->_decoder, senderUs - delayUs, frame);
+    }
+    os_unfair_lock_unlock(&_lock);
+    return found;
+}
+
+- (void)removeUserId:(NSString *)userId {
+    os_unfair_lock_lock(&_lock);
+    [self.users removeObjectForKey:userId];
+    os_unfair_lock_unlock(&_lock);
+}
+
+@end
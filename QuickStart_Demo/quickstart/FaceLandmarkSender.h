@@ -0,0 +1,36 @@
+//
+//  FaceLandmarkSender.h
+//  quickstart
+//
+//  人脸点位发送：把本地跟踪结果随视频帧通过 SEI 发给房间内其他用户
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "FaceDetectionStage.h"
+#import "FaceLandmarkCodec.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 房间内只有发送端做一次检测，接收端用 FaceLandmarkReceiver 还原，不必各自再检测。
+/// @note 每帧一条记录（单张脸约 100 字节），有人脸时逐帧发送，人脸消失后只发一条空记录。
+///       sendFacesForFrame:detectionStage: 只在视频前处理线程调用。
+@interface FaceLandmarkSender : NSObject
+
+- (instancetype)initWithRTCVideo:(ByteRTCVideo *)rtcVideo NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 读取当前帧的跟踪结果，编码后通过主流的 SEI 发送
+/// @param detectionStage 低分辨率检测阶段，点位已映射回原图；为 nil 时读取 FURenderKit 渲染时的跟踪结果
+- (void)sendFacesForFrame:(ByteRTCVideoFrame *)frame detectionStage:(nullable FaceDetectionStage *)detectionStage;
+
+/// 下一条记录发关键帧，有新用户加入时调用，可在任意线程调用
+- (void)requestKeyframe;
+
+/// 已发送的记录数与字节数
+@property (nonatomic, assign, readonly) uint64_t sentRecords;
+@property (nonatomic, assign, readonly) uint64_t sentBytes;
+
+@end
+
+NS_ASSUME_NONNULL_END
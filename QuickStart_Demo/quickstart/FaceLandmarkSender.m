@@ -0,0 +1,86 @@
+//
+//  FaceLandmarkSender.m
+//  quickstart
+//
+
+#import "FaceLandmarkSender.h"
+#import <QuartzCore/QuartzCore.h>
+#import <FURenderKit/FURenderKit.h>
+#import <stdatomic.h>
+
+@interface FaceLandmarkSender () {
+    FaceLandmarkEncoder *_encoder;
+    FaceLandmarkFrame _frame;
+    uint8_t _record[FACE_LANDMARK_MAX_RECORD_BYTES];
+    uint32_t _lastFaceCount;
+    atomic_bool _keyframeRequested;
+}
+
+@property (nonatomic, weak) ByteRTCVideo *rtcVideo;
+@property (nonatomic, assign, readwrite) uint64_t sentRecords;
+@property (nonatomic, assign, readwrite) uint64_t sentBytes;
+
+@end
+
+@implementation FaceLandmarkSender
+
+- (instancetype)initWithRTCVideo:(ByteRTCVideo *)rtcVideo {
+    self = [super init];
+    if (self) {
+        _rtcVideo = rtcVideo;
+        FaceLandmarkEncoderConfig config = FaceLandmarkEncoderDefaultConfig();
+        _encoder = FaceLandmarkEncoderCreate(&config);
+        atomic_init(&_keyframeRequested, false);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    FaceLandmarkEncoderDestroy(_encoder);
+}
+
+- (void)requestKeyframe {
+    atomic_store(&_keyframeRequested, true);
+}
+
+- (void)sendFacesForFrame:(ByteRTCVideoFrame *)frame detectionStage:(nullable FaceDetectionStage *)detectionStage {
+    int faceCount = MIN([FUAIKit aiFaceProcessorNums], FACE_LANDMARK_MAX_FACES);
+    if (faceCount <= 0 && _lastFaceCount == 0) {
+        return;
+    }
+    // 接收端按时间戳插值，发送端只需保证时间戳单调
+    _frame.timestampUs = CMTIME_IS_VALID(frame.time) ? (int64_t)(CMTimeGetSeconds(frame.time) * 1000000.0)
+                                                     : (int64_t)(CACurrentMediaTime() * 1000000.0);
+    _frame.width = (uint32_t)frame.width;
+    _frame.height = (uint32_t)frame.height;
+    uint32_t count = 0;
+    for (int i = 0; i < faceCount; i++) {
+        FaceLandmarkFace *face = &_frame.faces[count];
+        int rectFound = detectionStage ? [detectionStage getFaceRect:face->rect forFace:i]
+                                       : [FUAIKit getFaceInfo:i name:@"face_rect" pret:face->rect number:4];
+        if (!rectFound) {
+            continue;
+        }
+        // 证书不支持点位时只发人脸框
+        int pointsFound = detectionStage ? [detectionStage getLandmarks:face->points count:2 * FACE_LANDMARK_MAX_POINTS forFace:i]
+                                         : [FUAIKit getFaceInfo:i name:@"landmarks" pret:face->points number:2 * FACE_LANDMARK_MAX_POINTS];
+        face->pointCount = pointsFound ? FACE_LANDMARK_MAX_POINTS : 0;
+        count++;
+    }
+    _frame.faceCount = count;
+    if (atomic_exchange(&_keyframeRequested, false)) {
+        FaceLandmarkEncoderForceKeyframe(_encoder);
+    }
+    size_t size = FaceLandmarkEncoderEncode(_encoder, &_frame, _record, sizeof(_record));
+    if (size == 0) {
+        return;
+    }
+    _lastFaceCount = count;
+    NSData *message = [NSData dataWithBytes:_record length:size];
+    if ([self.rtcVideo sendSEIMessage:ByteRTCStreamIndexMain andMessage:message andRepeatCount:0 andCountPerFrame:ByteRTCSEICountPerFrameSingle] >= 0) {
+        self.sentRecords++;
+        self.sentBytes += size;
+    }
+}
+
+@end
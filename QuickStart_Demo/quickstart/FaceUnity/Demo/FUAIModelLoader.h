@@ -0,0 +1,78 @@
+//
+//  FUAIModelLoader.h
+//  FUDemo
+//
+//  AI 模型异步加载
+//
+
+#import <Foundation/Foundation.h>
+#import <FURenderKit/FURenderKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 模型加载状态
+typedef NS_ENUM(NSInteger, FUAIModelState) {
+    FUAIModelStateIdle = 0,     // 未加载
+    FUAIModelStateLoading,      // 正在加载队列上读取模型文件
+    FUAIModelStatePending,      // 文件已读取，等待渲染线程调用 finishLoadedModels 注册
+    FUAIModelStateReady,        // 已就绪，可以使用
+    FUAIModelStateFailed        // 加载失败
+};
+
+/// 单个模型各阶段耗时（毫秒）
+@interface FUAIModelLoadTiming : NSObject
+
+@property (nonatomic, assign) FUAITYPE type;
+/// 请求后在加载队列上等待的时间
+@property (nonatomic, assign) double queueMs;
+/// 读取模型文件
+@property (nonatomic, assign) double loadMs;
+/// 读取完成后等待渲染线程注册的时间
+@property (nonatomic, assign) double pendingMs;
+/// 渲染线程上 FUAIKit 注册模型
+@property (nonatomic, assign) double registerMs;
+/// 从请求到可用的总时间
+@property (nonatomic, assign) double totalMs;
+
+@end
+
+/// 在并发的加载队列上并行读取 AI 模型文件（读入页缓存），不阻塞调用线程与渲染线程；
+/// 读取完成后由渲染线程在 finishLoadedModels 中通过 FUAIKit 注册模型、标记就绪并执行回调。
+/// FUAIKit 的人脸算法接口不能在两个线程上并发调用，注册与渲染因此在同一线程，
+/// 回调中设置道具或算法参数也与渲染在同一线程。
+/// 渲染路径通过 isModelReady: 跳过模型尚未就绪的功能。
+@interface FUAIModelLoader : NSObject
+
++ (instancetype)shareLoader;
+
+/// 人体模型的分割模式，在加载人体模型前设置，默认 FUHumanSegmentationModeCPUCommon
+@property (atomic, assign) FUHumanSegmentationMode humanSegmentationMode;
+
+/// 请求加载模型，已在加载或已加载时忽略
+/// @param type 模型类型
+/// @param path 模型文件路径
+/// @param completion 完成回调，在调用 finishLoadedModels 的线程执行（失败时 ready 为 NO）
+- (void)loadModelWithType:(FUAITYPE)type path:(NSString *)path completion:(nullable void (^)(BOOL ready))completion;
+
+/// 模型是否已就绪，无锁，可在每帧调用
+- (BOOL)isModelReady:(FUAITYPE)type;
+
+- (FUAIModelState)stateForModel:(FUAITYPE)type;
+
+/// 注册一个已读取完成的模型、标记就绪并执行回调，在渲染线程每帧开始时调用
+/// @note 每次最多注册一个模型，多个模型分摊到相邻几帧，避免单帧卡顿叠加
+/// @return 本次完成的模型数量
+- (NSUInteger)finishLoadedModels;
+
+/// 已完成加载的模型耗时
+- (NSArray<FUAIModelLoadTiming *> *)timings;
+
+/// 耗时报告，每个模型一行
+- (NSString *)timingReport;
+
+/// 丢弃所有状态与未完成的加载（FURenderKit 销毁时调用）
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
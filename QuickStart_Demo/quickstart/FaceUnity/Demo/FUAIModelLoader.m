@@ -0,0 +1,212 @@
+//
+//  FUAIModelLoader.m
+//  FUDemo
+//
+
+#import "FUAIModelLoader.h"
+
+#include <stdatomic.h>
+
+@implementation FUAIModelLoadTiming
+
+@end
+
+/// 单个模型的加载任务
+@interface FUAIModelLoadTask : NSObject
+
+@property (nonatomic, assign) FUAITYPE type;
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy, nullable) void (^completion)(BOOL ready);
+@property (nonatomic, assign) FUAIModelState state;
+/// 人体模型的分割模式，请求时确定
+@property (nonatomic, assign) FUHumanSegmentationMode segmentationMode;
+/// 加载队列上是否读取到模型文件
+@property (nonatomic, assign) BOOL fileRead;
+/// 渲染线程上的注册结果
+@property (nonatomic, assign) BOOL loaded;
+@property (nonatomic, strong) FUAIModelLoadTiming *timing;
+@property (nonatomic, assign) CFAbsoluteTime requestTime;
+@property (nonatomic, assign) CFAbsoluteTime loadedTime;
+
+@end
+
+@implementation FUAIModelLoadTask
+
+@end
+
+@interface FUAIModelLoader ()
+
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, FUAIModelLoadTask *> *tasks;
+/// 并发读取模型文件，只做文件 IO，不调用 FUAIKit
+@property (nonatomic, strong) dispatch_queue_t loadQueue;
+/// reset 后递增，丢弃 reset 之前发起的加载
+@property (nonatomic, assign) NSUInteger generation;
+
+@end
+
+@implementation FUAIModelLoader {
+    /// 已就绪模型的 FUAITYPE 位掩码
+    atomic_ullong _readyMask;
+    /// 等待完成的模型数量，为 0 时 finishLoadedModels 不加锁直接返回
+    atomic_uint _pendingCount;
+}
+
++ (instancetype)shareLoader {
+    static FUAIModelLoader *loader = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        loader = [[FUAIModelLoader alloc] init];
+    });
+    return loader;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _tasks = [NSMutableDictionary dictionary];
+        _loadQueue = dispatch_queue_create("com.faceunity.aimodel.load", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_CONCURRENT, QOS_CLASS_USER_INITIATED, 0));
+        _humanSegmentationMode = FUHumanSegmentationModeCPUCommon;
+    }
+    return self;
+}
+
+- (void)loadModelWithType:(FUAITYPE)type path:(NSString *)path completion:(void (^)(BOOL))completion {
+    FUAIModelLoadTask *task = nil;
+    NSUInteger generation = 0;
+    @synchronized (self) {
+        FUAIModelLoadTask *existing = self.tasks[@(type)];
+        if (existing && existing.state != FUAIModelStateFailed) {
+            return;
+        }
+        task = [[FUAIModelLoadTask alloc] init];
+        task.type = type;
+        task.path = path;
+        task.completion = completion;
+        task.segmentationMode = self.humanSegmentationMode;
+        task.state = FUAIModelStateLoading;
+        task.timing = [[FUAIModelLoadTiming alloc] init];
+        task.timing.type = type;
+        task.requestTime = CFAbsoluteTimeGetCurrent();
+        self.tasks[@(type)] = task;
+        generation = self.generation;
+    }
+    dispatch_async(self.loadQueue, ^{
+        @synchronized (self) {
+            if (generation != self.generation) {
+                return;
+            }
+        }
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        // 完整读取一遍模型文件，之后渲染线程上 FUAIKit 按路径加载时只读页缓存，不等待磁盘
+        NSData *data = path ? [NSData dataWithContentsOfFile:path options:0 error:nil] : nil;
+        if (!data) {
+            // 路径无效也交给 finishLoadedModels 处理，保证回调总在渲染线程执行
+            NSLog(@"FUAIModelLoader: cannot find model %d at %@", type, path);
+        }
+        CFAbsoluteTime endTime = CFAbsoluteTimeGetCurrent();
+        task.timing.queueMs = (startTime - task.requestTime) * 1000.0;
+        task.timing.loadMs = (endTime - startTime) * 1000.0;
+        @synchronized (self) {
+            if (generation != self.generation) {
+                return;
+            }
+            task.fileRead = data != nil;
+            task.loadedTime = endTime;
+            task.state = FUAIModelStatePending;
+            atomic_fetch_add(&self->_pendingCount, 1);
+        }
+    });
+}
+
+- (BOOL)isModelReady:(FUAITYPE)type {
+    return (atomic_load_explicit(&_readyMask, memory_order_acquire) & (unsigned long long)type) != 0;
+}
+
+- (FUAIModelState)stateForModel:(FUAITYPE)type {
+    @synchronized (self) {
+        return self.tasks[@(type)].state;
+    }
+}
+
+- (NSUInteger)finishLoadedModels {
+    if (atomic_load_explicit(&_pendingCount, memory_order_relaxed) == 0) {
+        return 0;
+    }
+    // 按请求顺序取最早读取完成的一个模型
+    FUAIModelLoadTask *task = nil;
+    NSUInteger generation = 0;
+    @synchronized (self) {
+        for (FUAIModelLoadTask *candidate in self.tasks.allValues) {
+            if (candidate.state == FUAIModelStatePending && (!task || candidate.requestTime < task.requestTime)) {
+                task = candidate;
+            }
+        }
+        if (!task) {
+            return 0;
+        }
+        generation = self.generation;
+    }
+    CFAbsoluteTime registerTime = CFAbsoluteTimeGetCurrent();
+    BOOL loaded = NO;
+    if (task.fileRead) {
+        if (task.type == FUAITYPE_HUMAN_PROCESSOR) {
+            [FUAIKit loadAIHumanModelWithDataPath:task.path segmentationMode:task.segmentationMode];
+        } else {
+            [FUAIKit loadAIModeWithAIType:task.type dataPath:task.path];
+        }
+        loaded = [FUAIKit loadedAIType:task.type];
+    }
+    CFAbsoluteTime finishTime = CFAbsoluteTimeGetCurrent();
+    @synchronized (self) {
+        if (generation != self.generation) {
+            // 注册期间已 reset，丢弃结果
+            return 0;
+        }
+        task.loaded = loaded;
+        task.state = loaded ? FUAIModelStateReady : FUAIModelStateFailed;
+        atomic_fetch_sub(&_pendingCount, 1);
+    }
+    task.timing.pendingMs = (registerTime - task.loadedTime) * 1000.0;
+    task.timing.registerMs = (finishTime - registerTime) * 1000.0;
+    task.timing.totalMs = (finishTime - task.requestTime) * 1000.0;
+    if (loaded) {
+        atomic_fetch_or_explicit(&_readyMask, (unsigned long long)task.type, memory_order_release);
+    }
+    NSLog(@"FUAIModelLoader: model %d %@ queue=%.1fms load=%.1fms pending=%.1fms register=%.1fms total=%.1fms",
+          task.type, loaded ? @"ready" : @"failed", task.timing.queueMs, task.timing.loadMs,
+          task.timing.pendingMs, task.timing.registerMs, task.timing.totalMs);
+    !task.completion ?: task.completion(loaded);
+    return 1;
+}
+
+- (NSArray<FUAIModelLoadTiming *> *)timings {
+    NSMutableArray *timings = [NSMutableArray array];
+    @synchronized (self) {
+        for (FUAIModelLoadTask *task in self.tasks.allValues) {
+            if (task.state == FUAIModelStateReady) {
+                [timings addObject:task.timing];
+            }
+        }
+    }
+    return [timings copy];
+}
+
+- (NSString *)timingReport {
+    NSMutableString *report = [NSMutableString string];
+    for (FUAIModelLoadTiming *timing in [self timings]) {
+        [report appendFormat:@"model %d: queue=%.1fms load=%.1fms pending=%.1fms register=%.1fms total=%.1fms\n",
+         timing.type, timing.queueMs, timing.loadMs, timing.pendingMs, timing.registerMs, timing.totalMs];
+    }
+    return [report copy];
+}
+
+- (void)reset {
+    @synchronized (self) {
+        self.generation++;
+        [self.tasks removeAllObjects];
+        atomic_store(&_pendingCount, 0);
+        atomic_store(&_readyMask, 0);
+    }
+}
+
+@end
@@ -0,0 +1,44 @@
+//
+//  FUBeautyParamCache.h
+//  FUDemo
+//
+//  美颜道具参数缓存
+//
+
+#import <Foundation/Foundation.h>
+
+@class FUItem;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 道具参数写缓存：暂存要设置的参数，与上一次写入道具的值比较，只在 flush 时把变化的参数一次性写入
+/// @note 每个道具一个缓存（cacheForItem:），该道具的所有参数都应经由缓存设置，否则缓存记录的值与道具不一致。
+///       set 可在任意线程调用；flush 在视频前处理线程每帧调用一次。
+@interface FUBeautyParamCache : NSObject
+
+/// 道具对应的缓存，首次访问时创建，随道具释放
+/// @return item 为 nil 时返回 nil
++ (nullable instancetype)cacheForItem:(nullable FUItem *)item;
+
+- (instancetype)initWithItem:(FUItem *)item NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 目标道具
+@property (nonatomic, weak, readonly, nullable) FUItem *item;
+
+/// 暂存数值参数，值与最近一次设置的值相同时忽略
+/// @param value 参数值
+/// @param key 道具属性名（如 blurType、cheekThinning）
+- (void)setValue:(double)value forParamKey:(NSString *)key;
+
+/// 暂存字符串参数（如 filterName），规则同 setValue:forParamKey:
+- (void)setString:(NSString *)value forParamKey:(NSString *)key;
+
+/// 把暂存的参数写入道具
+/// @return 实际写入的参数个数
+- (NSUInteger)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
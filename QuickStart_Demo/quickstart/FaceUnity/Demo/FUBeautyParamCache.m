@@ -0,0 +1,97 @@
+//
+//  FUBeautyParamCache.m
+//  FUDemo
+//
+
+#import "FUBeautyParamCache.h"
+#import <FURenderKit/FUItem.h>
+#import <objc/runtime.h>
+#import <os/lock.h>
+
+static const void *FUBeautyParamCacheKey = &FUBeautyParamCacheKey;
+
+@interface FUBeautyParamCache ()
+
+@property (nonatomic, weak) FUItem *item;
+/// 已写入道具的参数值，只在 flush 中访问
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *writtenParams;
+/// 每个参数最近一次设置的值，由 _pendingLock 保护；每帧重复设置同一值时不产生待写入
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *latestParams;
+/// 待写入的参数值，由 _pendingLock 保护
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *pendingParams;
+
+@end
+
+@implementation FUBeautyParamCache {
+    os_unfair_lock _pendingLock;
+}
+
++ (instancetype)cacheForItem:(FUItem *)item {
+    if (!item) {
+        return nil;
+    }
+    @synchronized (item) {
+        FUBeautyParamCache *cache = objc_getAssociatedObject(item, FUBeautyParamCacheKey);
+        if (!cache) {
+            cache = [[FUBeautyParamCache alloc] initWithItem:item];
+            objc_setAssociatedObject(item, FUBeautyParamCacheKey, cache, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        }
+        return cache;
+    }
+}
+
+- (instancetype)initWithItem:(FUItem *)item {
+    self = [super init];
+    if (self) {
+        _item = item;
+        _writtenParams = [NSMutableDictionary dictionary];
+        _latestParams = [NSMutableDictionary dictionary];
+        _pendingParams = [NSMutableDictionary dictionary];
+        _pendingLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (void)setValue:(double)value forParamKey:(NSString *)key {
+    [self setParam:@(value) forKey:key];
+}
+
+- (void)setString:(NSString *)value forParamKey:(NSString *)key {
+    [self setParam:[value copy] forKey:key];
+}
+
+- (NSUInteger)flush {
+    FUItem *item = self.item;
+    os_unfair_lock_lock(&_pendingLock);
+    NSDictionary<NSString *, id> *params = self.pendingParams.count > 0 ? [self.pendingParams copy] : nil;
+    [self.pendingParams removeAllObjects];
+    os_unfair_lock_unlock(&_pendingLock);
+    if (!item || !params) {
+        return 0;
+    }
+    __block NSUInteger count = 0;
+    [params enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+        if ([self.writtenParams[key] isEqual:value]) {
+            // 同一帧内改回了道具当前值
+            return;
+        }
+        // 通过属性 setter 写入，保持道具缓存的属性值与实际参数一致
+        [item setValue:value forKey:key];
+        self.writtenParams[key] = value;
+        count++;
+    }];
+    return count;
+}
+
+#pragma mark - Private methods
+
+- (void)setParam:(id)value forKey:(NSString *)key {
+    os_unfair_lock_lock(&_pendingLock);
+    if (![self.latestParams[key] isEqual:value]) {
+        self.latestParams[key] = value;
+        self.pendingParams[key] = value;
+    }
+    os_unfair_lock_unlock(&_pendingLock);
+}
+
+@end
@@ -13,6 +13,9 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// 切换贴纸或组合妆后在主线程发送，新效果的渲染耗时与之前无关
+extern NSNotificationName const FUDemoEffectDidChangeNotification;
+
 @interface FUDemoManager : NSObject
 
 /// 开关状态
@@ -32,9 +35,12 @@ NS_ASSUME_NONNULL_BEGIN
 /// 重置检测结果
 + (void)resetTrackedResult;
 
-/// 更新美颜磨皮效果（根据人脸检测置信度设置不同磨皮效果）
+/// 更新美颜磨皮效果（根据人脸检测置信度设置不同磨皮效果），参数在 flushBeautyParams 时写入
 + (void)updateBeautyBlurEffect;
 
+/// 把本帧暂存的参数一次性写入美颜、美体道具（见 FUBeautyParamCache），在视频前处理线程每帧渲染前调用
++ (void)flushBeautyParams;
+
 /// 添加视图到指定父视图
 /// @param view 父视图
 /// @param originY 视图在父视图上的Y坐标（底部功能选择栏的Y坐标，X坐标默认为0）
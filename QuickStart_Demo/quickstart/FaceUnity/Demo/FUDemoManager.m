@@ -16,9 +16,17 @@
 
 #import "FUSegmentBar.h"
 #import "FUAlertManager.h"
+#import "FUTrackStateMonitor.h"
+#import "FUBeautyParamCache.h"
+#import "FUAIModelLoader.h"
+#import "SpanTracer.h"
+
+#include <stdatomic.h>
 
 #import "authpack.h"
 
+NSNotificationName const FUDemoEffectDidChangeNotification = @"FUDemoEffectDidChangeNotification";
+
 @interface FUDemoManager ()<FUSegmentBarDelegate>
 
 /// 底部功能选择栏
@@ -43,12 +51,20 @@
 /// 提示标签
 @property (nonatomic, strong) UILabel *trackTipLabel;
 
+/// 检测状态去抖，只在状态切换时刷新提示
+@property (nonatomic, strong) FUTrackStateMonitor *trackStateMonitor;
+/// 当前是否检测人体（美体功能），在采集线程读取
+@property (atomic, assign) BOOL tracksBody;
+
 @property (nonatomic, weak) UIView *targetView;
 @property (nonatomic, assign) CGFloat demoOriginY;
 
 @end
 
-@implementation FUDemoManager
+@implementation FUDemoManager {
+    /// 是否已有未执行的提示刷新，合并连续的状态切换
+    atomic_bool _trackTipUpdatePending;
+}
 
 static FUDemoManager *demoManager = nil;
 static dispatch_once_t onceToken;
@@ -64,35 +80,43 @@ static dispatch_once_t onceToken;
     self = [super init];
     if (self) {
         self.shouldRender = YES;
+        _trackStateMonitor = [[FUTrackStateMonitor alloc] init];
+        __weak typeof(self) weakSelf = self;
+        _trackStateMonitor.stateChangedHandler = ^(BOOL tracked) {
+            [weakSelf setNeedsUpdateTrackTip];
+        };
     }
     return self;
 }
 
 + (void)setupFUSDK {
+    SPAN_TRACE_SCOPE("setupFUSDK");
     [FURenderKit setLogLevel:FU_LOG_LEVEL_INFO];
     FUSetupConfig *setupConfig = [[FUSetupConfig alloc] init];
     setupConfig.authPack = FUAuthPackMake(g_auth_package, sizeof(g_auth_package));
     // 初始化 FURenderKit
     [FURenderKit setupWithSetupConfig:setupConfig];
     
-    // 加载人脸 AI 模型
+    // 加载人脸 AI 模型（加载队列上读取文件，渲染线程注册并执行回调，不阻塞调用线程）
+    // 身体 AI 模型在打开美体功能时再加载
     NSString *faceAIPath = [[NSBundle mainBundle] pathForResource:@"ai_face_processor" ofType:@"bundle"];
-    [FUAIKit loadAIModeWithAIType:FUAITYPE_FACEPROCESSOR dataPath:faceAIPath];
-    
-    // 加载身体 AI 模型
-    NSString *bodyAIPath = [[NSBundle mainBundle] pathForResource:@"ai_human_processor" ofType:@"bundle"];
-    [FUAIKit loadAIModeWithAIType:FUAITYPE_HUMAN_PROCESSOR dataPath:bodyAIPath];
+    [[FUAIModelLoader shareLoader] loadModelWithType:FUAITYPE_FACEPROCESSOR path:faceAIPath completion:^(BOOL ready) {
+        if (!ready) {
+            return;
+        }
+        // 设置人脸算法质量
+        [FUAIKit shareKit].faceProcessorFaceLandmarkQuality = [FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh ? FUFaceProcessorFaceLandmarkQualityHigh : FUFaceProcessorFaceLandmarkQualityMedium;
+        
+        // 设置小脸检测是否打开
+        [FUAIKit shareKit].faceProcessorDetectSmallFace = [FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh;
+    }];
     
     [FUAIKit shareKit].maxTrackFaces = 4;
     
-    // 设置人脸算法质量
-    [FUAIKit shareKit].faceProcessorFaceLandmarkQuality = [FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh ? FUFaceProcessorFaceLandmarkQualityHigh : FUFaceProcessorFaceLandmarkQualityMedium;
-    
-    // 设置小脸检测是否打开
-    [FUAIKit shareKit].faceProcessorDetectSmallFace = [FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh;
-    
     // 性能测试初始化
     [[FUTestRecorder shareRecorder] setupRecord];
+    // 每 5 秒输出一次各阶段耗时分布
+    [[FUTestRecorder shareRecorder] startLatencyReportWithInterval:5];
     
     // 美颜默认加载
     [self loadDefaultBeauty];
@@ -116,19 +140,29 @@ static dispatch_once_t onceToken;
 }
 
 - (void)checkAITrackedResult {
-    dispatch_async(dispatch_get_main_queue(), ^{
-        if (self.showingView == self.bodyView) {
-            self.trackTipLabel.hidden = [FUAIKit aiHumanProcessorNums] > 0;
-            self.trackTipLabel.text = FULocalizedString(@"未检测到人体");
-        } else {
-            self.trackTipLabel.hidden = [FUAIKit aiFaceProcessorNums] > 0;
-            self.trackTipLabel.text = FULocalizedString(@"未检测到人脸");
-        }
-    });
+    FUAITYPE type = self.tracksBody ? FUAITYPE_HUMAN_PROCESSOR : FUAITYPE_FACEPROCESSOR;
+    if (![[FUAIModelLoader shareLoader] isModelReady:type]) {
+        // 模型未就绪时不更新检测提示
+        return;
+    }
+    int count = self.tracksBody ? [FUAIKit aiHumanProcessorNums] : [FUAIKit aiFaceProcessorNums];
+    [self.trackStateMonitor updateWithDetectedCount:count];
 }
 
 #pragma mark - Private methods
 
+/// 在主线程刷新检测提示，未执行前的多次请求只刷新一次
+- (void)setNeedsUpdateTrackTip {
+    if (atomic_exchange(&_trackTipUpdatePending, true)) {
+        return;
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        atomic_store(&self->_trackTipUpdatePending, false);
+        self.trackTipLabel.hidden = self.trackStateMonitor.tracked;
+        self.trackTipLabel.text = self.tracksBody ? FULocalizedString(@"未检测到人体") : FULocalizedString(@"未检测到人脸");
+    });
+}
+
 /// 显示功能视图
 /// @param functionView 功能视图
 - (void)showFunctionView:(UIView *)functionView {
@@ -174,6 +208,12 @@ static dispatch_once_t onceToken;
 
 - (void)segmentBar:(FUSegmentBar *)segmentBar didSelectItemAtIndex:(NSUInteger)index {
     [FUAIKit shareKit].maxTrackFaces = index == FUModuleTypeBody ? 1 : 4;
+    BOOL tracksBody = index == FUModuleTypeBody;
+    if (tracksBody != self.tracksBody) {
+        // 切换检测目标，下一帧重新通知检测状态
+        self.tracksBody = tracksBody;
+        [self.trackStateMonitor reset];
+    }
     UIView *needShowView = nil;
     switch (index) {
         case FUModuleTypeBeautySkin:{
@@ -201,6 +241,8 @@ static dispatch_once_t onceToken;
                 // 加载默认美体
                 [FUDemoManager loadDefaultBody];
             }
+            // 首次打开美体时加载身体 AI 模型（在美体道具之后请求，回调时道具已存在）
+            [FUDemoManager loadBodyAIModel];
             needShowView = self.bodyView;
         }
             break;
@@ -317,6 +359,9 @@ static dispatch_once_t onceToken;
 #pragma mark - Class methods
 
 + (void)destory {
+    [[FUTestRecorder shareRecorder] stopLatencyReport];
+    [[FUTestRecorder shareRecorder] stopRecord];
+    [[FUAIModelLoader shareLoader] reset];
     [FURenderKit destroy];
     onceToken = 0;
     demoManager = nil;
@@ -326,36 +371,61 @@ static dispatch_once_t onceToken;
     [FUAIKit resetTrackedResult];
 }
 
+/// 人脸置信度平滑系数
+static const CGFloat kBlurConfidenceSmoothing = 0.1;
+/// 平滑后的置信度高于该值时切换到均匀磨皮
+static const CGFloat kBlurConfidenceEnterThreshold = 0.95;
+/// 平滑后的置信度低于该值时切回精细磨皮
+static const CGFloat kBlurConfidenceExitThreshold = 0.85;
+
 + (void)updateBeautyBlurEffect {
-    if (![FURenderKit shareRenderKit].beauty || ![FURenderKit shareRenderKit].beauty.enable) {
+    FUBeauty *beauty = [FURenderKit shareRenderKit].beauty;
+    if (!beauty || !beauty.enable) {
         return;
     }
-    if ([FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh) {
-        // 根据人脸置信度设置不同磨皮效果
+    // 只在视频前处理线程调用
+    static CGFloat smoothedScore = 0;
+    static BOOL useMaskBlur = NO;
+    FUBeautyParamCache *paramCache = [FUBeautyParamCache cacheForItem:beauty];
+    if ([FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh && [[FUAIModelLoader shareLoader] isModelReady:FUAITYPE_FACEPROCESSOR]) {
+        // 根据人脸置信度设置不同磨皮效果，置信度平滑并使用迟滞阈值，避免在阈值附近反复切换
         CGFloat score = [FUAIKit fuFaceProcessorGetConfidenceScore:0];
-        if (score > 0.95) {
-            [FURenderKit shareRenderKit].beauty.blurType = 3;
-            [FURenderKit shareRenderKit].beauty.blurUseMask = YES;
+        smoothedScore += kBlurConfidenceSmoothing * (score - smoothedScore);
+        if (useMaskBlur) {
+            useMaskBlur = smoothedScore >= kBlurConfidenceExitThreshold;
         } else {
-            [FURenderKit shareRenderKit].beauty.blurType = 2;
-            [FURenderKit shareRenderKit].beauty.blurUseMask = NO;
+            useMaskBlur = smoothedScore > kBlurConfidenceEnterThreshold;
         }
     } else {
-        // 设置精细磨皮效果
-        [FURenderKit shareRenderKit].beauty.blurType = 2;
-        [FURenderKit shareRenderKit].beauty.blurUseMask = NO;
+        useMaskBlur = NO;
     }
+    if (useMaskBlur) {
+        // 均匀磨皮
+        [paramCache setValue:3 forParamKey:@"blurType"];
+        [paramCache setValue:1 forParamKey:@"blurUseMask"];
+    } else {
+        // 精细磨皮
+        [paramCache setValue:2 forParamKey:@"blurType"];
+        [paramCache setValue:0 forParamKey:@"blurUseMask"];
+    }
+}
+
++ (void)flushBeautyParams {
+    [[FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].beauty] flush];
+    [[FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].bodyBeauty] flush];
 }
 
 /// 加载默认美颜
 + (void)loadDefaultBeauty {
     NSString *path = [[NSBundle mainBundle] pathForResource:@"face_beautification" ofType:@"bundle"];
     FUBeauty *beauty = [[FUBeauty alloc] initWithPath:path name:@"FUBeauty"];
-    beauty.heavyBlur = 0;
+    // 道具参数都经由参数缓存设置，视频前处理线程渲染前写入
+    FUBeautyParamCache *paramCache = [FUBeautyParamCache cacheForItem:beauty];
+    [paramCache setValue:0 forParamKey:@"heavyBlur"];
     // 默认均匀磨皮
-    beauty.blurType = 3;
+    [paramCache setValue:3 forParamKey:@"blurType"];
     // 默认精细变形
-    beauty.faceShape = 4;
+    [paramCache setValue:4 forParamKey:@"faceShape"];
     // 高性能设备设置去黑眼圈、去法令纹、大眼、嘴型最新效果
     if ([FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh) {
         [beauty addPropertyMode:FUBeautyPropertyMode2 forKey:FUModeKeyRemovePouchStrength];
@@ -370,7 +440,18 @@ static dispatch_once_t onceToken;
 + (void)loadDefaultBody {
     NSString *filePath = [[NSBundle mainBundle] pathForResource:@"body_slim" ofType:@"bundle"];
     FUBodyBeauty *bodyBeauty = [[FUBodyBeauty alloc] initWithPath:filePath name:@"body_slim"];
+    // 身体 AI 模型就绪前不渲染美体；与模型回调一样经由参数缓存写入
+    [[FUBeautyParamCache cacheForItem:bodyBeauty] setValue:[[FUAIModelLoader shareLoader] isModelReady:FUAITYPE_HUMAN_PROCESSOR] forParamKey:@"enable"];
     [FURenderKit shareRenderKit].bodyBeauty = bodyBeauty;
 }
 
+/// 加载身体 AI 模型
++ (void)loadBodyAIModel {
+    NSString *bodyAIPath = [[NSBundle mainBundle] pathForResource:@"ai_human_processor" ofType:@"bundle"];
+    [[FUAIModelLoader shareLoader] loadModelWithType:FUAITYPE_HUMAN_PROCESSOR path:bodyAIPath completion:^(BOOL ready) {
+        // 暂存后随美颜参数一起在 flushBeautyParams 中写入
+        [[FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].bodyBeauty] setValue:ready forParamKey:@"enable"];
+    }];
+}
+
 @end
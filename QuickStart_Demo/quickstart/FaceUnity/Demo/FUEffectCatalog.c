@@ -0,0 +1,167 @@
+//
+//  FUEffectCatalog.c
+//  FUDemo
+//
+
+#include "FUEffectCatalog.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// 文件头，所有整数为小端序
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tableCount;
+    uint32_t recordSize;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+    uint32_t reserved;
+    uint64_t sourceHash;
+} FUEffectCatalogHeader;
+
+/// 表目录项，紧跟在文件头之后
+typedef struct {
+    uint32_t offset;
+    uint32_t count;
+} FUEffectCatalogTableEntry;
+
+struct FUEffectCatalog {
+    const uint8_t *bytes;
+    size_t length;
+    /// 通过 FUEffectCatalogOpen 映射时需要 munmap
+    bool mapped;
+    const FUEffectCatalogHeader *header;
+    const FUEffectCatalogTableEntry *tables;
+    const char *strings;
+};
+
+_Static_assert(sizeof(FUEffectCatalogHeader) == 32, "catalog header layout");
+_Static_assert(sizeof(FUEffectCatalogRecord) == 40, "catalog record layout");
+
+static bool FUEffectCatalogValidate(FUEffectCatalog *catalog) {
+    if (catalog->length < sizeof(FUEffectCatalogHeader) || ((uintptr_t)catalog->bytes & 7) != 0) {
+        return false;
+    }
+    const FUEffectCatalogHeader *header = (const FUEffectCatalogHeader *)catalog->bytes;
+    if (header->magic != FU_EFFECT_CATALOG_MAGIC || header->version != FU_EFFECT_CATALOG_VERSION ||
+        header->recordSize != sizeof(FUEffectCatalogRecord) || header->tableCount < FUEffectCatalogTableCount) {
+        return false;
+    }
+    uint64_t directoryEnd = sizeof(FUEffectCatalogHeader) + (uint64_t)header->tableCount * sizeof(FUEffectCatalogTableEntry);
+    uint64_t stringEnd = (uint64_t)header->stringTableOffset + header->stringTableSize;
+    if (directoryEnd > catalog->length || header->stringTableSize == 0 || stringEnd > catalog->length) {
+        return false;
+    }
+    const char *strings = (const char *)catalog->bytes + header->stringTableOffset;
+    // 偏移 0 为空串，最后一个字符串必须以 '\0' 结尾，之后任何合法偏移都能安全读取
+    if (strings[0] != '\0' || strings[header->stringTableSize - 1] != '\0') {
+        return false;
+    }
+    const FUEffectCatalogTableEntry *tables = (const FUEffectCatalogTableEntry *)(catalog->bytes + sizeof(FUEffectCatalogHeader));
+    for (uint16_t i = 0; i < header->tableCount; i++) {
+        uint64_t end = (uint64_t)tables[i].offset + (uint64_t)tables[i].count * sizeof(FUEffectCatalogRecord);
+        if ((tables[i].offset & 7) != 0 || tables[i].offset < directoryEnd || end > catalog->length) {
+            return false;
+        }
+        const FUEffectCatalogRecord *records = (const FUEffectCatalogRecord *)(catalog->bytes + tables[i].offset);
+        for (uint32_t j = 0; j < tables[i].count; j++) {
+            if (records[j].name >= header->stringTableSize ||
+                records[j].icon >= header->stringTableSize ||
+                records[j].bundleName >= header->stringTableSize) {
+                return false;
+            }
+        }
+    }
+    catalog->header = header;
+    catalog->tables = tables;
+    catalog->strings = strings;
+    return true;
+}
+
+FUEffectCatalog *FUEffectCatalogOpenWithBytes(const void *data, size_t length) {
+    if (!data) {
+        return NULL;
+    }
+    FUEffectCatalog *catalog = calloc(1, sizeof(FUEffectCatalog));
+    if (!catalog) {
+        return NULL;
+    }
+    catalog->bytes = data;
+    catalog->length = length;
+    if (!FUEffectCatalogValidate(catalog)) {
+        free(catalog);
+        return NULL;
+    }
+    return catalog;
+}
+
+FUEffectCatalog *FUEffectCatalogOpen(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t length = (size_t)info.st_size;
+    void *bytes = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (bytes == MAP_FAILED) {
+        return NULL;
+    }
+    FUEffectCatalog *catalog = FUEffectCatalogOpenWithBytes(bytes, length);
+    if (!catalog) {
+        munmap(bytes, length);
+        return NULL;
+    }
+    catalog->mapped = true;
+    return catalog;
+}
+
+void FUEffectCatalogClose(FUEffectCatalog *catalog) {
+    if (!catalog) {
+        return;
+    }
+    if (catalog->mapped) {
+        munmap((void *)catalog->bytes, catalog->length);
+    }
+    free(catalog);
+}
+
+bool FUEffectCatalogGetTable(const FUEffectCatalog *catalog, FUEffectCatalogTable table, const FUEffectCatalogRecord **records, uint32_t *count) {
+    if (!catalog || table < 0 || table >= catalog->header->tableCount) {
+        return false;
+    }
+    const FUEffectCatalogTableEntry *entry = &catalog->tables[table];
+    *records = (const FUEffectCatalogRecord *)(catalog->bytes + entry->offset);
+    *count = entry->count;
+    return true;
+}
+
+const char *FUEffectCatalogString(const FUEffectCatalog *catalog, uint32_t offset) {
+    if (!catalog || offset >= catalog->header->stringTableSize) {
+        return "";
+    }
+    return catalog->strings + offset;
+}
+
+uint64_t FUEffectCatalogSourceHash(const FUEffectCatalog *catalog) {
+    return catalog ? catalog->header->sourceHash : 0;
+}
+
+uint64_t FUEffectCatalogHashBytes(const void *data, size_t length, uint64_t seed) {
+    uint64_t hash = seed ? seed : 0xcbf29ce484222325ULL;
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
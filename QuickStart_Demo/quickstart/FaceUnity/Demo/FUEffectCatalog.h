@@ -0,0 +1,88 @@
+//
+//  FUEffectCatalog.h
+//  FUDemo
+//
+//  预编译效果目录（二进制，内存映射只读访问）
+//
+
+#ifndef FUEffectCatalog_h
+#define FUEffectCatalog_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 文件魔数 "FUEC"
+#define FU_EFFECT_CATALOG_MAGIC 0x43455546u
+/// 格式版本，修改记录布局时递增（同时修改 Tools/compile_effect_catalog.py）
+#define FU_EFFECT_CATALOG_VERSION 1
+
+/// 目录中的表，顺序与源 JSON 文件一一对应
+typedef enum {
+    FUEffectCatalogTableBeautySkin = 0,     // beauty_skin.json
+    FUEffectCatalogTableBeautyShape,        // beauty_shape.json
+    FUEffectCatalogTableBeautyFilter,       // beauty_filter.json
+    FUEffectCatalogTableCombinationMakeup,  // combination_makeups.json
+    FUEffectCatalogTableSticker,            // stickers.json
+    FUEffectCatalogTableBody,               // body.json
+    FUEffectCatalogTableCount
+} FUEffectCatalogTable;
+
+/// 记录标记位
+typedef enum {
+    FUEffectCatalogFlagDefaultValueInMiddle = 1 << 0,
+    FUEffectCatalogFlagDifferentiateDevicePerformance = 1 << 1
+} FUEffectCatalogFlag;
+
+/// 定长记录，所有表共用，未使用的字段为 0（字符串为空串）
+/// 字段对应关系：
+///   美肤/美型/美体：name、type、currentValue、defaultValue、ratio（仅美肤）、flags
+///   滤镜：name = filterName，currentValue = defaultValue = filterLevel
+///   组合妆：name、icon、bundleName，currentValue = defaultValue = value
+///   贴纸：icon、bundleName
+typedef struct {
+    /// 字符串表偏移
+    uint32_t name;
+    uint32_t icon;
+    uint32_t bundleName;
+    int32_t type;
+    double currentValue;
+    double defaultValue;
+    int32_t ratio;
+    uint32_t flags;
+} FUEffectCatalogRecord;
+
+/// 已打开的目录
+typedef struct FUEffectCatalog FUEffectCatalog;
+
+/// 以只读方式映射并校验目录文件
+/// @return 文件不存在、版本不符或数据越界时返回 NULL
+FUEffectCatalog *FUEffectCatalogOpen(const char *path);
+
+/// 校验并包装一段内存中的目录数据（不拷贝，调用方保证 data 在目录关闭前有效）
+FUEffectCatalog *FUEffectCatalogOpenWithBytes(const void *data, size_t length);
+
+void FUEffectCatalogClose(FUEffectCatalog *catalog);
+
+/// 获取表中的记录，记录直接指向映射内存
+/// @return 表不存在时返回 false
+bool FUEffectCatalogGetTable(const FUEffectCatalog *catalog, FUEffectCatalogTable table, const FUEffectCatalogRecord **records, uint32_t *count);
+
+/// 字符串表中的字符串（UTF-8，以 '\0' 结尾），打开时已校验所有记录中的偏移
+const char *FUEffectCatalogString(const FUEffectCatalog *catalog, uint32_t offset);
+
+/// 编译时所有源 JSON 文件内容的哈希，用于检查目录是否过期
+uint64_t FUEffectCatalogSourceHash(const FUEffectCatalog *catalog);
+
+/// FNV-1a 64 位哈希，seed 传 0 表示从初始值开始，可链式计算多段数据
+uint64_t FUEffectCatalogHashBytes(const void *data, size_t length, uint64_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FUEffectCatalog_h */
@@ -0,0 +1,31 @@
+//
+//  FUEffectCatalogLoader.h
+//  FUDemo
+//
+//  效果目录加载
+//
+
+#import <Foundation/Foundation.h>
+#import "FUEffectCatalog.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 加载应用包内预编译的 effects.catalog（由 FaceUnity/Tools/compile_effect_catalog.py 生成），
+/// 各 ViewModel 直接从映射内存构建模型，无需解析 JSON。
+/// 目录缺失或校验失败时返回 NULL，调用方回退到解析 JSON。
+@interface FUEffectCatalogLoader : NSObject
+
+/// 应用包内的目录，首次调用时映射，之后常驻内存
+/// @note 会校验目录与包内 JSON 是否一致（构建时另有 Check Effect Catalog 脚本阶段检查），不一致时返回 NULL 并输出提示
++ (nullable const FUEffectCatalog *)defaultCatalog;
+
+/// 获取表中的记录
+/// @return 目录不可用时返回 NO
++ (BOOL)getRecords:(const FUEffectCatalogRecord * _Nullable * _Nonnull)records count:(uint32_t *)count forTable:(FUEffectCatalogTable)table;
+
+/// 字符串表中的字符串
++ (NSString *)stringAtOffset:(uint32_t)offset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,60 @@
+//
+//  FUEffectCatalogLoader.m
+//  FUDemo
+//
+
+#import "FUEffectCatalogLoader.h"
+
+@implementation FUEffectCatalogLoader
+
+static FUEffectCatalog *defaultCatalog = NULL;
+
++ (const FUEffectCatalog *)defaultCatalog {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+        NSString *path = [bundle pathForResource:@"effects" ofType:@"catalog"];
+        if (!path) {
+            return;
+        }
+        FUEffectCatalog *catalog = FUEffectCatalogOpen(path.fileSystemRepresentation);
+        if (!catalog) {
+            NSLog(@"FUEffectCatalog: invalid catalog %@", path);
+            return;
+        }
+        // 所有配置都校验：过期的目录会让界面与 JSON 配置不一致，此时回退到解析 JSON
+        if (![self isCatalogUpToDate:catalog inBundle:bundle]) {
+            NSLog(@"FUEffectCatalog: effects.catalog is out of date, falling back to JSON; run FaceUnity/Tools/compile_effect_catalog.py");
+            FUEffectCatalogClose(catalog);
+            return;
+        }
+        defaultCatalog = catalog;
+    });
+    return defaultCatalog;
+}
+
++ (BOOL)getRecords:(const FUEffectCatalogRecord **)records count:(uint32_t *)count forTable:(FUEffectCatalogTable)table {
+    return FUEffectCatalogGetTable([self defaultCatalog], table, records, count);
+}
+
++ (NSString *)stringAtOffset:(uint32_t)offset {
+    return [NSString stringWithUTF8String:FUEffectCatalogString([self defaultCatalog], offset)] ?: @"";
+}
+
+#pragma mark - Private methods
+
+/// 与编译脚本相同的顺序计算包内 JSON 的哈希
++ (BOOL)isCatalogUpToDate:(const FUEffectCatalog *)catalog inBundle:(NSBundle *)bundle {
+    NSArray<NSString *> *sources = @[@"beauty_skin", @"beauty_shape", @"beauty_filter", @"combination_makeups", @"stickers", @"body"];
+    uint64_t hash = 0;
+    for (NSString *source in sources) {
+        NSData *data = [NSData dataWithContentsOfFile:[bundle pathForResource:source ofType:@"json"]];
+        if (!data) {
+            return NO;
+        }
+        hash = FUEffectCatalogHashBytes(data.bytes, data.length, hash);
+    }
+    return hash == FUEffectCatalogSourceHash(catalog);
+}
+
+@end
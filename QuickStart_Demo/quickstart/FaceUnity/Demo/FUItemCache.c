@@ -0,0 +1,206 @@
+//
+//  FUItemCache.c
+//  FUDemo
+//
+
+#include "FUItemCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct FUItemCacheEntry {
+    struct FUItemCacheEntry *older;
+    struct FUItemCacheEntry *newer;
+    void *item;
+    size_t cost;
+    char path[];
+} FUItemCacheEntry;
+
+struct FUItemCache {
+    size_t byteBudget;
+    FUItemCacheBackend backend;
+    /// LRU 链表，oldest 最先淘汰
+    FUItemCacheEntry *oldest;
+    FUItemCacheEntry *newest;
+    FUItemCacheStats stats;
+};
+
+FUItemCache *FUItemCacheCreate(size_t byteBudget, const FUItemCacheBackend *backend) {
+    FUItemCache *cache = calloc(1, sizeof(FUItemCache));
+    if (!cache) {
+        return NULL;
+    }
+    cache->byteBudget = byteBudget;
+    if (backend) {
+        cache->backend = *backend;
+    }
+    return cache;
+}
+
+void FUItemCacheDestroy(FUItemCache *cache) {
+    if (!cache) {
+        return;
+    }
+    FUItemCacheEntry *entry = cache->oldest;
+    while (entry) {
+        FUItemCacheEntry *newer = entry->newer;
+        free(entry);
+        entry = newer;
+    }
+    free(cache);
+}
+
+// 链表
+
+static FUItemCacheEntry *FUItemCacheFind(const FUItemCache *cache, const char *path) {
+    // 道具列表只有几十项，由新到旧线性查找即可，最近用过的道具最先找到
+    for (FUItemCacheEntry *entry = cache->newest; entry; entry = entry->older) {
+        if (strcmp(entry->path, path) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void FUItemCacheUnlink(FUItemCache *cache, FUItemCacheEntry *entry) {
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+    if (entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+    entry->older = entry->newer = NULL;
+}
+
+static void FUItemCacheLinkNewest(FUItemCache *cache, FUItemCacheEntry *entry) {
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if (cache->newest) {
+        cache->newest->newer = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+static void FUItemCacheLinkOldest(FUItemCache *cache, FUItemCacheEntry *entry) {
+    entry->older = NULL;
+    entry->newer = cache->oldest;
+    if (cache->oldest) {
+        cache->oldest->older = entry;
+    } else {
+        cache->newest = entry;
+    }
+    cache->oldest = entry;
+}
+
+static FUItemCacheEntry *FUItemCacheNewEntry(const char *path, void *item, size_t cost) {
+    size_t length = strlen(path);
+    FUItemCacheEntry *entry = malloc(sizeof(FUItemCacheEntry) + length + 1);
+    if (!entry) {
+        return NULL;
+    }
+    entry->older = entry->newer = NULL;
+    entry->item = item;
+    entry->cost = cost;
+    memcpy(entry->path, path, length + 1);
+    return entry;
+}
+
+static void FUItemCacheRemoveEntry(FUItemCache *cache, FUItemCacheEntry *entry) {
+    FUItemCacheUnlink(cache, entry);
+    cache->stats.usedBytes -= entry->cost;
+    cache->stats.count--;
+}
+
+static void FUItemCacheEvictOldest(FUItemCache *cache) {
+    FUItemCacheEntry *entry = cache->oldest;
+    FUItemCacheRemoveEntry(cache, entry);
+    cache->stats.evictions++;
+    if (cache->backend.evict) {
+        cache->backend.evict(cache->backend.context, entry->item, entry->path);
+    }
+    free(entry);
+}
+
+// 查找与放入
+
+void *FUItemCacheLookup(FUItemCache *cache, const char *path) {
+    FUItemCacheEntry *entry = FUItemCacheFind(cache, path);
+    if (!entry) {
+        cache->stats.misses++;
+        return NULL;
+    }
+    cache->stats.hits++;
+    if (entry != cache->newest) {
+        FUItemCacheUnlink(cache, entry);
+        FUItemCacheLinkNewest(cache, entry);
+    }
+    return entry->item;
+}
+
+bool FUItemCacheContains(const FUItemCache *cache, const char *path) {
+    return FUItemCacheFind(cache, path) != NULL;
+}
+
+bool FUItemCacheInsert(FUItemCache *cache, const char *path, void *item, size_t cost) {
+    if (cost > cache->byteBudget || FUItemCacheFind(cache, path)) {
+        return false;
+    }
+    FUItemCacheEntry *entry = FUItemCacheNewEntry(path, item, cost);
+    if (!entry) {
+        return false;
+    }
+    while (cache->oldest && cache->stats.usedBytes + cost > cache->byteBudget) {
+        FUItemCacheEvictOldest(cache);
+    }
+    FUItemCacheLinkNewest(cache, entry);
+    cache->stats.usedBytes += cost;
+    cache->stats.count++;
+    return true;
+}
+
+bool FUItemCacheInsertPrefetched(FUItemCache *cache, const char *path, void *item, size_t cost) {
+    if (!FUItemCacheHasRoom(cache, cost) || FUItemCacheFind(cache, path)) {
+        return false;
+    }
+    FUItemCacheEntry *entry = FUItemCacheNewEntry(path, item, cost);
+    if (!entry) {
+        return false;
+    }
+    FUItemCacheLinkOldest(cache, entry);
+    cache->stats.usedBytes += cost;
+    cache->stats.count++;
+    return true;
+}
+
+bool FUItemCacheHasRoom(const FUItemCache *cache, size_t cost) {
+    return cost <= cache->byteBudget - cache->stats.usedBytes;
+}
+
+// 移除
+
+void *FUItemCacheRemove(FUItemCache *cache, const char *path) {
+    FUItemCacheEntry *entry = FUItemCacheFind(cache, path);
+    if (!entry) {
+        return NULL;
+    }
+    void *item = entry->item;
+    FUItemCacheRemoveEntry(cache, entry);
+    free(entry);
+    return item;
+}
+
+void FUItemCacheRemoveAll(FUItemCache *cache) {
+    while (cache->oldest) {
+        FUItemCacheEvictOldest(cache);
+    }
+}
+
+FUItemCacheStats FUItemCacheGetStats(const FUItemCache *cache) {
+    return cache->stats;
+}
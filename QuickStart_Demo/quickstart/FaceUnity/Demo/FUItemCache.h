@@ -0,0 +1,73 @@
+//
+//  FUItemCache.h
+//  FUDemo
+//
+//  道具缓存策略：按路径保存道具句柄，字节预算内常驻，超出预算时按 LRU 淘汰
+//
+
+#ifndef FUItemCache_h
+#define FUItemCache_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 道具后端：缓存只保存不透明的道具指针，淘汰时交回后端释放
+typedef struct {
+    /// 道具被淘汰（或清空）时调用，可为 NULL；调用时道具已从缓存移除
+    void (*evict)(void *context, void *item, const char *path);
+    void *context;
+} FUItemCacheBackend;
+
+/// 计数器
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t usedBytes;
+    uint32_t count;
+} FUItemCacheStats;
+
+typedef struct FUItemCache FUItemCache;
+
+/// @param byteBudget 字节预算，单个超出预算的道具不缓存
+/// @param backend 道具后端，可为 NULL
+FUItemCache *FUItemCacheCreate(size_t byteBudget, const FUItemCacheBackend *backend);
+
+/// 销毁缓存，不回调 evict；需要释放道具时先调用 FUItemCacheRemoveAll
+void FUItemCacheDestroy(FUItemCache *cache);
+
+/// 查找道具，命中时移到 LRU 最新位置并计为命中，否则计为未命中并返回 NULL
+void *FUItemCacheLookup(FUItemCache *cache, const char *path);
+
+/// 是否已缓存，不影响 LRU 顺序与计数
+bool FUItemCacheContains(const FUItemCache *cache, const char *path);
+
+/// 放入新创建的道具（放在 LRU 最新位置），先按 LRU 淘汰到放得下为止
+/// @return 缓存成功返回 true；道具超出预算、路径已缓存或内存不足时返回 false，调用方仍持有道具
+bool FUItemCacheInsert(FUItemCache *cache, const char *path, void *item, size_t cost);
+
+/// 放入预取的道具：只在剩余预算足够时放入，不淘汰已有道具；放在 LRU 最旧的位置，真正使用前优先被淘汰
+/// @return 缓存成功返回 true，否则调用方仍持有道具
+bool FUItemCacheInsertPrefetched(FUItemCache *cache, const char *path, void *item, size_t cost);
+
+/// 剩余预算是否放得下 cost 字节（不淘汰）
+bool FUItemCacheHasRoom(const FUItemCache *cache, size_t cost);
+
+/// 移除道具，不回调 evict，返回被移除的道具（未缓存时返回 NULL）
+void *FUItemCacheRemove(FUItemCache *cache, const char *path);
+
+/// 由旧到新淘汰所有道具，逐个回调 evict
+void FUItemCacheRemoveAll(FUItemCache *cache);
+
+FUItemCacheStats FUItemCacheGetStats(const FUItemCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FUItemCache_h */
@@ -0,0 +1,59 @@
+//
+//  FUItemPackageCache.h
+//  FUDemo
+//
+//  道具包缓存
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 按路径缓存已创建的道具对象（FUItem、FUSticker 等），在字节预算内常驻，超出预算时按 LRU 淘汰。
+/// 重新选择最近用过的道具时直接复用已创建的对象，不再读取、解析道具包。
+/// @note 淘汰策略与计数由 FUItemCache（C）实现，这里负责持有道具对象、创建道具与系统内存压力时清空。非线程安全，在主线程使用。
+@interface FUItemPackageCache<ObjectType> : NSObject
+
+/// 字节预算，按道具包文件大小计算
+@property (nonatomic, assign, readonly) NSUInteger byteBudget;
+/// 当前缓存的字节数
+@property (nonatomic, assign, readonly) NSUInteger usedBytes;
+/// 当前缓存的道具数
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/// 命中、未命中、淘汰次数
+@property (nonatomic, assign, readonly) NSUInteger hitCount;
+@property (nonatomic, assign, readonly) NSUInteger missCount;
+@property (nonatomic, assign, readonly) NSUInteger evictionCount;
+
+/// 道具被淘汰时回调，可在此释放道具占用的资源
+@property (nonatomic, copy, nullable) void (^evictionHandler)(ObjectType item, NSString *path);
+
+/// @param byteBudget 字节预算，单个超出预算的道具仍会创建但不缓存
+- (instancetype)initWithByteBudget:(NSUInteger)byteBudget NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 获取道具，未缓存时调用 creator 创建并缓存
+/// @param path 道具包路径
+/// @param cost 道具占用字节数，传 0 时取文件大小（只在未命中时读取文件属性）
+/// @param creator 创建道具，返回 nil 时不缓存
+- (nullable ObjectType)itemForPath:(NSString *)path cost:(NSUInteger)cost creator:(ObjectType _Nullable (^)(NSString *path))creator;
+
+/// 是否已缓存，不影响 LRU 顺序与计数
+- (BOOL)containsItemForPath:(NSString *)path;
+
+/// 放入预取的道具（由调用方在后台创建）：只在剩余预算足够时缓存，不淘汰已有道具，不影响命中计数
+/// 预取的道具放在 LRU 最旧的位置，真正使用前优先被淘汰
+/// @return 缓存成功返回 YES；路径已缓存或剩余预算不足时返回 NO，道具被丢弃
+- (BOOL)insertPrefetchedItem:(ObjectType)item forPath:(NSString *)path cost:(NSUInteger)cost;
+
+/// 移除指定道具（不回调 evictionHandler）
+- (void)removeItemForPath:(NSString *)path;
+
+/// 淘汰所有道具（会回调 evictionHandler）
+- (void)removeAllItems;
+
+@end
+
+NS_ASSUME_NONNULL_END
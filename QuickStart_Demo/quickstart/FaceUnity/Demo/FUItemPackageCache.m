@@ -0,0 +1,125 @@
+//
+//  FUItemPackageCache.m
+//  FUDemo
+//
+
+#import "FUItemPackageCache.h"
+#include "FUItemCache.h"
+
+@interface FUItemPackageCache ()
+
+/// 系统内存压力时清空缓存
+@property (nonatomic, strong) dispatch_source_t memoryPressureSource;
+
+@end
+
+@implementation FUItemPackageCache {
+    /// 道具以 CFBridgingRetain 的形式保存，移除或淘汰时交还 ARC
+    FUItemCache *_cache;
+}
+
+/// 淘汰回调：交还道具所有权并通知 evictionHandler
+static void FUItemPackageCacheEvict(void *context, void *item, const char *path) {
+    FUItemPackageCache *cache = (__bridge FUItemPackageCache *)context;
+    id object = CFBridgingRelease(item);
+    if (cache->_evictionHandler) {
+        cache->_evictionHandler(object, [NSString stringWithUTF8String:path]);
+    }
+}
+
+- (instancetype)initWithByteBudget:(NSUInteger)byteBudget {
+    self = [super init];
+    if (self) {
+        _byteBudget = byteBudget;
+        FUItemCacheBackend backend = {.evict = FUItemPackageCacheEvict, .context = (__bridge void *)self};
+        _cache = FUItemCacheCreate(byteBudget, &backend);
+        // 内存压力时清空缓存
+        __weak typeof(self) weakSelf = self;
+        _memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, dispatch_get_main_queue());
+        dispatch_source_set_event_handler(_memoryPressureSource, ^{
+            [weakSelf removeAllItems];
+        });
+        dispatch_resume(_memoryPressureSource);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_source_cancel(_memoryPressureSource);
+    // 只释放缓存持有的道具，不回调 evictionHandler
+    _evictionHandler = nil;
+    FUItemCacheRemoveAll(_cache);
+    FUItemCacheDestroy(_cache);
+}
+
+- (NSUInteger)usedBytes {
+    return FUItemCacheGetStats(_cache).usedBytes;
+}
+
+- (NSUInteger)count {
+    return FUItemCacheGetStats(_cache).count;
+}
+
+- (NSUInteger)hitCount {
+    return (NSUInteger)FUItemCacheGetStats(_cache).hits;
+}
+
+- (NSUInteger)missCount {
+    return (NSUInteger)FUItemCacheGetStats(_cache).misses;
+}
+
+- (NSUInteger)evictionCount {
+    return (NSUInteger)FUItemCacheGetStats(_cache).evictions;
+}
+
+- (id)itemForPath:(NSString *)path cost:(NSUInteger)cost creator:(id  _Nullable (^)(NSString * _Nonnull))creator {
+    void *cached = FUItemCacheLookup(_cache, path.fileSystemRepresentation);
+    if (cached) {
+        return (__bridge id)cached;
+    }
+    id item = creator(path);
+    if (!item) {
+        return nil;
+    }
+    if (cost == 0) {
+        cost = [self fileSizeAtPath:path];
+    }
+    void *retained = (void *)CFBridgingRetain(item);
+    if (!FUItemCacheInsert(_cache, path.fileSystemRepresentation, retained, cost)) {
+        // 超出预算，只创建不缓存
+        CFBridgingRelease(retained);
+    }
+    return item;
+}
+
+- (BOOL)containsItemForPath:(NSString *)path {
+    return FUItemCacheContains(_cache, path.fileSystemRepresentation);
+}
+
+- (BOOL)insertPrefetchedItem:(id)item forPath:(NSString *)path cost:(NSUInteger)cost {
+    void *retained = (void *)CFBridgingRetain(item);
+    if (!FUItemCacheInsertPrefetched(_cache, path.fileSystemRepresentation, retained, cost)) {
+        CFBridgingRelease(retained);
+        return NO;
+    }
+    return YES;
+}
+
+- (void)removeItemForPath:(NSString *)path {
+    void *item = FUItemCacheRemove(_cache, path.fileSystemRepresentation);
+    if (item) {
+        CFBridgingRelease(item);
+    }
+}
+
+- (void)removeAllItems {
+    FUItemCacheRemoveAll(_cache);
+}
+
+#pragma mark - Private methods
+
+- (NSUInteger)fileSizeAtPath:(NSString *)path {
+    return (NSUInteger)[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil].fileSize;
+}
+
+@end
@@ -0,0 +1,47 @@
+//
+//  FUItemPrefetcher.h
+//  FUDemo
+//
+//  相邻道具预取
+//
+
+#import <Foundation/Foundation.h>
+#import "FUItemPackageCache.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 根据选中位置与滑动方向预取相邻的道具：
+/// 1. 后台队列逐个创建道具（读取并解析道具包；道具句柄由 FURenderKit 在其渲染队列上创建），
+///    创建的字节数不超过 memoryCap 与道具缓存的剩余预算；
+/// 2. 每创建一个道具，回到主线程放入道具缓存，主线程只做发布。
+/// 选中位置变化后，旧的预取任务不再创建剩余的道具。
+/// @note 在主线程调用；creator 会在后台队列调用
+@interface FUItemPrefetcher<ObjectType> : NSObject
+
+/// 是否启用，默认 YES；启动参数 -FUItemPrefetchDisabled YES 可关闭，用于对比点击到生效的耗时
+@property (nonatomic, assign) BOOL enabled;
+
+/// 预取选中位置两侧各多少个道具，默认 2
+@property (nonatomic, assign) NSUInteger radius;
+
+/// 每次预取创建的道具包字节上限，默认 4MB
+@property (nonatomic, assign) NSUInteger memoryCap;
+
+/// @param cache 道具缓存，预取只使用其剩余预算，不会淘汰已有道具
+/// @param creator 创建道具，在后台队列调用
+- (instancetype)initWithCache:(FUItemPackageCache<ObjectType> *)cache creator:(ObjectType _Nullable (^)(NSString *path))creator NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 更新预取位置
+/// @param paths 所有道具包路径，按列表顺序（不存在的道具传空串）
+/// @param index 选中（或停留）位置
+/// @param direction 滑动方向，1 向后、-1 向前、0 未知；优先预取该方向上的道具
+- (void)prefetchAroundIndex:(NSInteger)index inPaths:(NSArray<NSString *> *)paths direction:(NSInteger)direction;
+
+/// 取消未完成的预取
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
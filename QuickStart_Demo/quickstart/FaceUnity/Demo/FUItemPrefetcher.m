@@ -0,0 +1,111 @@
+//
+//  FUItemPrefetcher.m
+//  FUDemo
+//
+
+#import "FUItemPrefetcher.h"
+
+#include <stdatomic.h>
+
+@interface FUItemPrefetcher ()
+
+@property (nonatomic, strong) FUItemPackageCache *cache;
+@property (nonatomic, copy) id _Nullable (^creator)(NSString *path);
+/// 创建道具的后台串行队列
+@property (nonatomic, strong) dispatch_queue_t warmQueue;
+
+@end
+
+@implementation FUItemPrefetcher {
+    /// 每次更新位置或取消时递增，旧任务发现不一致后退出
+    atomic_uint _generation;
+}
+
+- (instancetype)initWithCache:(FUItemPackageCache *)cache creator:(id  _Nullable (^)(NSString * _Nonnull))creator {
+    self = [super init];
+    if (self) {
+        _cache = cache;
+        _creator = [creator copy];
+        _enabled = ![[NSUserDefaults standardUserDefaults] boolForKey:@"FUItemPrefetchDisabled"];
+        _radius = 2;
+        _memoryCap = 4 * 1024 * 1024;
+        _warmQueue = dispatch_queue_create("com.faceunity.itemprefetcher", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+    }
+    return self;
+}
+
+- (void)prefetchAroundIndex:(NSInteger)index inPaths:(NSArray<NSString *> *)paths direction:(NSInteger)direction {
+    unsigned generation = atomic_fetch_add(&_generation, 1) + 1;
+    if (!self.enabled) {
+        return;
+    }
+    // 按距离由近到远（包括停留位置本身），同一距离先取滑动方向上的道具
+    NSInteger step = direction < 0 ? -1 : 1;
+    NSMutableArray<NSString *> *targets = [NSMutableArray array];
+    for (NSInteger distance = 0; distance <= (NSInteger)self.radius; distance++) {
+        for (NSNumber *neighbour in @[@(index + step * distance), @(index - step * distance)]) {
+            NSInteger neighbourIndex = neighbour.integerValue;
+            if (neighbourIndex < 0 || neighbourIndex >= (NSInteger)paths.count) {
+                continue;
+            }
+            NSString *path = paths[neighbourIndex];
+            if (path.length > 0 && ![self.cache containsItemForPath:path] && ![targets containsObject:path]) {
+                [targets addObject:path];
+            }
+        }
+    }
+    if (targets.count == 0) {
+        return;
+    }
+    // 预取只用缓存的剩余预算，提前截断，避免创建了放不进缓存的道具
+    NSUInteger spareBytes = self.cache.byteBudget - MIN(self.cache.usedBytes, self.cache.byteBudget);
+    NSUInteger byteLimit = MIN(self.memoryCap, spareBytes);
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.warmQueue, ^{
+        [weakSelf createItemsForPaths:targets byteLimit:byteLimit generation:generation];
+    });
+}
+
+- (void)cancel {
+    atomic_fetch_add(&_generation, 1);
+}
+
+#pragma mark - Private methods
+
+- (BOOL)isStale:(unsigned)generation {
+    return atomic_load(&_generation) != generation;
+}
+
+/// 后台逐个创建道具（读取并解析道具包），每创建一个就交给主线程发布
+- (void)createItemsForPaths:(NSArray<NSString *> *)paths byteLimit:(NSUInteger)byteLimit generation:(unsigned)generation {
+    NSUInteger createdBytes = 0;
+    for (NSString *path in paths) {
+        if ([self isStale:generation]) {
+            return;
+        }
+        NSUInteger cost = (NSUInteger)[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil].fileSize;
+        if (cost == 0 || createdBytes + cost > byteLimit) {
+            // 超出上限，之后更远的道具也不再预取
+            return;
+        }
+        id item = self.creator(path);
+        if (!item) {
+            continue;
+        }
+        createdBytes += cost;
+        __weak typeof(self) weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf publishItem:item forPath:path cost:cost];
+        });
+    }
+}
+
+/// 主线程放入道具缓存；位置变化后已创建的道具仍然放入（只占剩余预算），用户已点击创建了同一道具时丢弃
+- (void)publishItem:(id)item forPath:(NSString *)path cost:(NSUInteger)cost {
+    if ([self.cache containsItemForPath:path]) {
+        return;
+    }
+    [self.cache insertPrefetchedItem:item forPath:path cost:cost];
+}
+
+@end
@@ -0,0 +1,83 @@
+//
+//  FULatencyHistogram.c
+//  FUDemo
+//
+
+#include "FULatencyHistogram.h"
+
+/// log2(FU_LATENCY_HISTOGRAM_SUB_BUCKETS)
+#define FU_LATENCY_HISTOGRAM_SUB_BITS 4
+
+static inline unsigned FULatencyHistogramBucketIndex(uint64_t value) {
+    if (value < FU_LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return (unsigned)value;
+    }
+    unsigned exponent = 63 - (unsigned)__builtin_clzll(value);
+    unsigned shift = exponent - FU_LATENCY_HISTOGRAM_SUB_BITS;
+    unsigned sub = (unsigned)(value >> shift) & (FU_LATENCY_HISTOGRAM_SUB_BUCKETS - 1);
+    unsigned index = (shift + 1) * FU_LATENCY_HISTOGRAM_SUB_BUCKETS + sub;
+    return index < FU_LATENCY_HISTOGRAM_BUCKETS ? index : FU_LATENCY_HISTOGRAM_BUCKETS - 1;
+}
+
+/// 桶内可能的最大值
+static inline uint64_t FULatencyHistogramBucketUpperBound(unsigned index) {
+    if (index < FU_LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    unsigned shift = index / FU_LATENCY_HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t sub = index % FU_LATENCY_HISTOGRAM_SUB_BUCKETS;
+    return ((FU_LATENCY_HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void FULatencyHistogramRecord(FULatencyHistogram *histogram, uint64_t valueUs) {
+    atomic_fetch_add_explicit(&histogram->counts[FULatencyHistogramBucketIndex(valueUs)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->totalValue, valueUs, memory_order_relaxed);
+    uint64_t currentMax = atomic_load_explicit(&histogram->maxValue, memory_order_relaxed);
+    while (valueUs > currentMax &&
+           !atomic_compare_exchange_weak_explicit(&histogram->maxValue, &currentMax, valueUs, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void FULatencyHistogramTakeSnapshot(FULatencyHistogram *histogram, FULatencyHistogramSnapshot *snapshot, bool reset) {
+    snapshot->count = 0;
+    for (unsigned i = 0; i < FU_LATENCY_HISTOGRAM_BUCKETS; i++) {
+        uint64_t count = reset ? atomic_exchange_explicit(&histogram->counts[i], 0, memory_order_relaxed)
+                               : atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+        snapshot->counts[i] = count;
+        snapshot->count += count;
+    }
+    if (reset) {
+        snapshot->maxValue = atomic_exchange_explicit(&histogram->maxValue, 0, memory_order_relaxed);
+        snapshot->totalValue = atomic_exchange_explicit(&histogram->totalValue, 0, memory_order_relaxed);
+    } else {
+        snapshot->maxValue = atomic_load_explicit(&histogram->maxValue, memory_order_relaxed);
+        snapshot->totalValue = atomic_load_explicit(&histogram->totalValue, memory_order_relaxed);
+    }
+}
+
+uint64_t FULatencyHistogramSnapshotPercentile(const FULatencyHistogramSnapshot *snapshot, double percentile) {
+    if (snapshot->count == 0) {
+        return 0;
+    }
+    if (percentile >= 100.0) {
+        return snapshot->maxValue;
+    }
+    uint64_t target = (uint64_t)(percentile / 100.0 * (double)snapshot->count + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t accumulated = 0;
+    for (unsigned i = 0; i < FU_LATENCY_HISTOGRAM_BUCKETS; i++) {
+        accumulated += snapshot->counts[i];
+        if (accumulated >= target) {
+            uint64_t upper = FULatencyHistogramBucketUpperBound(i);
+            // 桶上界不超过实际最大值
+            return upper < snapshot->maxValue ? upper : snapshot->maxValue;
+        }
+    }
+    return snapshot->maxValue;
+}
+
+double FULatencyHistogramSnapshotMean(const FULatencyHistogramSnapshot *snapshot) {
+    return snapshot->count > 0 ? (double)snapshot->totalValue / (double)snapshot->count : 0;
+}
@@ -0,0 +1,60 @@
+//
+//  FULatencyHistogram.h
+//  FUDemo
+//
+//  无锁耗时直方图（HDR 风格对数-线性分桶）
+//
+
+#ifndef FULatencyHistogram_h
+#define FULatencyHistogram_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 每个 2 的幂区间细分的桶数，相对误差约 1/16
+#define FU_LATENCY_HISTOGRAM_SUB_BUCKETS 16
+/// 桶总数，可记录到 2^27 微秒（约 134 秒），超出部分计入最后一个桶
+#define FU_LATENCY_HISTOGRAM_BUCKETS 384
+
+/// 耗时直方图，单位微秒
+/// @note 记录只使用原子加法，不加锁、不申请内存，可在采集线程热路径上调用；
+///       快照可以在任意线程获取。需要零初始化（静态变量或 memset）。
+typedef struct {
+    _Atomic uint64_t counts[FU_LATENCY_HISTOGRAM_BUCKETS];
+    _Atomic uint64_t maxValue;
+    _Atomic uint64_t totalValue;
+} FULatencyHistogram;
+
+/// 直方图快照
+typedef struct {
+    uint64_t counts[FU_LATENCY_HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t maxValue;
+    uint64_t totalValue;
+} FULatencyHistogramSnapshot;
+
+/// 记录一次耗时
+void FULatencyHistogramRecord(FULatencyHistogram *histogram, uint64_t valueUs);
+
+/// 获取快照
+/// @param reset 是否在读取的同时清零（用于按时间窗口统计）
+void FULatencyHistogramTakeSnapshot(FULatencyHistogram *histogram, FULatencyHistogramSnapshot *snapshot, bool reset);
+
+/// 快照中的百分位数
+/// @param percentile 百分位 [0, 100]
+/// @return 对应桶内的最大值（微秒），快照为空时返回 0
+uint64_t FULatencyHistogramSnapshotPercentile(const FULatencyHistogramSnapshot *snapshot, double percentile);
+
+/// 快照平均值（微秒）
+double FULatencyHistogramSnapshotMean(const FULatencyHistogramSnapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FULatencyHistogram_h */
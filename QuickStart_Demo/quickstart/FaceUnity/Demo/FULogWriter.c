@@ -0,0 +1,401 @@
+//
+//  FULogWriter.c
+//  FUDemo
+//
+
+#include "FULogWriter.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// 队列中的一行；sequence 为 Vyukov 有界队列的序号，等于位置时可写，等于位置 + 1 时可读
+typedef struct {
+    _Atomic uint64_t sequence;
+    uint32_t length;
+    char text[FU_LOG_WRITER_LINE_MAX];
+} FULogLine;
+
+struct FULogWriter {
+    FULogWriterConfig config;
+    char *path;
+    char *header;
+    size_t headerLength;
+    long utcOffsetSeconds;
+    FULogLine *lines;
+    uint64_t mask;
+    pthread_t thread;
+    bool threadStarted;
+    _Atomic bool accepting;
+    _Atomic bool running;
+
+    /// 追加线程竞争的位置，单独占一个缓存行
+    _Alignas(64) _Atomic uint64_t tail;
+
+    // 以下只由写入线程访问
+    _Alignas(64) uint64_t head;
+    int fd;
+    char *buffer;
+    size_t bufferUsed;
+    uint64_t fileBytes;
+    bool dirty;
+    uint64_t lastFsyncNs;
+
+    // 追加线程写
+    _Atomic uint64_t appendedLines;
+    _Atomic uint64_t droppedLines;
+    _Atomic uint64_t truncatedLines;
+    // 写入线程写
+    _Atomic uint64_t writtenBytes;
+    _Atomic uint64_t writeCalls;
+    _Atomic uint64_t fsyncCalls;
+    _Atomic uint64_t rotations;
+    _Atomic uint64_t writeErrors;
+};
+
+/// 格式化用的线程局部缓冲，追加时不占用栈空间也不分配内存
+static _Thread_local char FULogWriterLineBuffer[FU_LOG_WRITER_LINE_MAX];
+
+FULogWriterConfig FULogWriterDefaultConfig(void) {
+    FULogWriterConfig config = {
+        .queueLines = 1024,
+        .flushBytes = 64 * 1024,
+        .fsyncIntervalMs = 1000,
+        .maxFileBytes = 8 * 1024 * 1024,
+        .maxRotatedFiles = 3,
+        .pollIntervalMs = 50,
+    };
+    return config;
+}
+
+static inline uint64_t FULogWriterNowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static inline void FULogWriterCounterAdd(_Atomic uint64_t *counter, uint64_t value) {
+    // 只有写入线程写
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+// Append
+
+bool FULogWriterAppendf(FULogWriter *writer, const char *format, ...) {
+    if (!atomic_load_explicit(&writer->accepting, memory_order_acquire)) {
+        return false;
+    }
+    char *text = FULogWriterLineBuffer;
+    va_list arguments;
+    va_start(arguments, format);
+    int formatted = vsnprintf(text, FU_LOG_WRITER_LINE_MAX, format, arguments);
+    va_end(arguments);
+    if (formatted < 0) {
+        atomic_fetch_add_explicit(&writer->droppedLines, 1, memory_order_relaxed);
+        return false;
+    }
+    uint32_t length = (uint32_t)formatted;
+    if (length > FU_LOG_WRITER_LINE_MAX - 1) {
+        length = FU_LOG_WRITER_LINE_MAX - 1;
+        atomic_fetch_add_explicit(&writer->truncatedLines, 1, memory_order_relaxed);
+    }
+    if (length == 0 || text[length - 1] != '\n') {
+        // 覆盖结尾 0，长度不超过 FU_LOG_WRITER_LINE_MAX
+        text[length++] = '\n';
+    }
+
+    uint64_t position = atomic_load_explicit(&writer->tail, memory_order_relaxed);
+    FULogLine *line;
+    for (;;) {
+        line = &writer->lines[position & writer->mask];
+        uint64_t sequence = atomic_load_explicit(&line->sequence, memory_order_acquire);
+        int64_t difference = (int64_t)(sequence - position);
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&writer->tail, &position, position + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // 写入线程还没取走上一圈的这一行
+            atomic_fetch_add_explicit(&writer->droppedLines, 1, memory_order_relaxed);
+            return false;
+        } else {
+            position = atomic_load_explicit(&writer->tail, memory_order_relaxed);
+        }
+    }
+    memcpy(line->text, text, length);
+    line->length = length;
+    atomic_store_explicit(&line->sequence, position + 1, memory_order_release);
+    atomic_fetch_add_explicit(&writer->appendedLines, 1, memory_order_relaxed);
+    return true;
+}
+
+static inline char *FULogWriterPutDigits(char *out, int value, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    return out + digits;
+}
+
+void FULogWriterFormatTimestamp(const FULogWriter *writer, double unixSeconds,
+                                char out[FU_LOG_WRITER_TIMESTAMP_LENGTH]) {
+    time_t seconds = (time_t)unixSeconds;
+    int milliseconds = (int)((unixSeconds - (double)seconds) * 1000.0);
+    if (milliseconds < 0) {
+        seconds -= 1;
+        milliseconds += 1000;
+    }
+    time_t local = seconds + writer->utcOffsetSeconds;
+    struct tm fields;
+    gmtime_r(&local, &fields);
+    char *cursor = FULogWriterPutDigits(out, fields.tm_year + 1900, 4);
+    *cursor++ = '-';
+    cursor = FULogWriterPutDigits(cursor, fields.tm_mon + 1, 2);
+    *cursor++ = '-';
+    cursor = FULogWriterPutDigits(cursor, fields.tm_mday, 2);
+    *cursor++ = ' ';
+    cursor = FULogWriterPutDigits(cursor, fields.tm_hour, 2);
+    *cursor++ = ':';
+    cursor = FULogWriterPutDigits(cursor, fields.tm_min, 2);
+    *cursor++ = ':';
+    cursor = FULogWriterPutDigits(cursor, fields.tm_sec, 2);
+    *cursor++ = ':';
+    cursor = FULogWriterPutDigits(cursor, milliseconds, 3);
+    *cursor = '\0';
+}
+
+// File
+
+static bool FULogWriterWriteAll(FULogWriter *writer, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(writer->fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            FULogWriterCounterAdd(&writer->writeErrors, 1);
+            return false;
+        }
+        FULogWriterCounterAdd(&writer->writeCalls, 1);
+        FULogWriterCounterAdd(&writer->writtenBytes, (uint64_t)written);
+        writer->fileBytes += (uint64_t)written;
+        data += written;
+        size -= (size_t)written;
+    }
+    writer->dirty = true;
+    return true;
+}
+
+static void FULogWriterFlush(FULogWriter *writer) {
+    if (writer->bufferUsed == 0) {
+        return;
+    }
+    if (writer->fd >= 0) {
+        FULogWriterWriteAll(writer, writer->buffer, writer->bufferUsed);
+    }
+    writer->bufferUsed = 0;
+}
+
+static void FULogWriterSync(FULogWriter *writer) {
+    if (writer->fd >= 0 && writer->dirty) {
+        fsync(writer->fd);
+        FULogWriterCounterAdd(&writer->fsyncCalls, 1);
+        writer->dirty = false;
+    }
+    writer->lastFsyncNs = FULogWriterNowNs();
+}
+
+/// 打开（覆盖）当前文件并写入表头
+static bool FULogWriterOpenFile(FULogWriter *writer) {
+    writer->fd = open(writer->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    writer->fileBytes = 0;
+    if (writer->fd < 0) {
+        FULogWriterCounterAdd(&writer->writeErrors, 1);
+        return false;
+    }
+    return writer->headerLength == 0 || FULogWriterWriteAll(writer, writer->header, writer->headerLength);
+}
+
+/// 当前文件改名为 <path>.1，已有的旧文件依次后移，超出 maxRotatedFiles 的被覆盖
+static void FULogWriterRotate(FULogWriter *writer) {
+    FULogWriterFlush(writer);
+    FULogWriterSync(writer);
+    if (writer->fd >= 0) {
+        close(writer->fd);
+        writer->fd = -1;
+    }
+    char from[PATH_MAX];
+    char to[PATH_MAX];
+    for (uint32_t index = writer->config.maxRotatedFiles; index > 1; index--) {
+        snprintf(from, sizeof(from), "%s.%u", writer->path, index - 1);
+        snprintf(to, sizeof(to), "%s.%u", writer->path, index);
+        rename(from, to);
+    }
+    if (writer->config.maxRotatedFiles > 0) {
+        snprintf(to, sizeof(to), "%s.1", writer->path);
+        rename(writer->path, to);
+    }
+    FULogWriterOpenFile(writer);
+    FULogWriterCounterAdd(&writer->rotations, 1);
+}
+
+// Writer thread
+
+static void FULogWriterDrain(FULogWriter *writer) {
+    for (;;) {
+        FULogLine *line = &writer->lines[writer->head & writer->mask];
+        if (atomic_load_explicit(&line->sequence, memory_order_acquire) != writer->head + 1) {
+            break;
+        }
+        uint32_t length = line->length;
+        uint64_t pending = writer->fileBytes + writer->bufferUsed;
+        if (writer->config.maxFileBytes > 0 && pending + length > writer->config.maxFileBytes &&
+            pending > writer->headerLength) {
+            FULogWriterRotate(writer);
+        }
+        if (writer->bufferUsed + length > writer->config.flushBytes) {
+            FULogWriterFlush(writer);
+        }
+        memcpy(writer->buffer + writer->bufferUsed, line->text, length);
+        writer->bufferUsed += length;
+        // 交还给追加线程，下一圈的位置为 head + mask + 1
+        atomic_store_explicit(&line->sequence, writer->head + writer->mask + 1, memory_order_release);
+        writer->head++;
+    }
+    FULogWriterFlush(writer);
+    if (writer->config.fsyncIntervalMs > 0 &&
+        FULogWriterNowNs() - writer->lastFsyncNs >= (uint64_t)writer->config.fsyncIntervalMs * 1000000ull) {
+        FULogWriterSync(writer);
+    }
+}
+
+static void *FULogWriterThread(void *context) {
+    FULogWriter *writer = context;
+    struct timespec interval = {
+        .tv_sec = writer->config.pollIntervalMs / 1000,
+        .tv_nsec = (long)(writer->config.pollIntervalMs % 1000) * 1000000,
+    };
+    while (atomic_load_explicit(&writer->running, memory_order_acquire)) {
+        FULogWriterDrain(writer);
+        nanosleep(&interval, NULL);
+    }
+    FULogWriterDrain(writer);
+    FULogWriterSync(writer);
+    return NULL;
+}
+
+// Public
+
+FULogWriter *FULogWriterCreate(const char *path, const char *header, const FULogWriterConfig *config) {
+    if (!path || !config || config->queueLines == 0 || config->queueLines > (1u << 20) ||
+        config->flushBytes < FU_LOG_WRITER_LINE_MAX || config->pollIntervalMs == 0 ||
+        strlen(path) + 12 >= PATH_MAX) {
+        return NULL;
+    }
+    FULogWriter *writer = NULL;
+    if (posix_memalign((void **)&writer, 64, sizeof(FULogWriter)) != 0) {
+        return NULL;
+    }
+    memset(writer, 0, sizeof(FULogWriter));
+    writer->fd = -1;
+    writer->config = *config;
+    uint32_t capacity = 1;
+    while (capacity < config->queueLines) {
+        capacity <<= 1;
+    }
+    writer->mask = capacity - 1;
+    writer->path = strdup(path);
+    writer->header = strdup(header ? header : "");
+    writer->lines = calloc(capacity, sizeof(FULogLine));
+    writer->buffer = malloc(config->flushBytes);
+    if (!writer->path || !writer->header || !writer->lines || !writer->buffer) {
+        FULogWriterDestroy(writer);
+        return NULL;
+    }
+    writer->headerLength = strlen(writer->header);
+    for (uint32_t i = 0; i < capacity; i++) {
+        atomic_init(&writer->lines[i].sequence, i);
+    }
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    writer->utcOffsetSeconds = local.tm_gmtoff;
+    if (!FULogWriterOpenFile(writer)) {
+        FULogWriterDestroy(writer);
+        return NULL;
+    }
+    writer->lastFsyncNs = FULogWriterNowNs();
+    atomic_init(&writer->tail, 0);
+    atomic_init(&writer->accepting, true);
+    atomic_init(&writer->running, true);
+    if (pthread_create(&writer->thread, NULL, FULogWriterThread, writer) != 0) {
+        FULogWriterDestroy(writer);
+        return NULL;
+    }
+    writer->threadStarted = true;
+    return writer;
+}
+
+void FULogWriterStop(FULogWriter *writer) {
+    atomic_store_explicit(&writer->accepting, false, memory_order_release);
+    if (atomic_exchange_explicit(&writer->running, false, memory_order_acq_rel) && writer->threadStarted) {
+        pthread_join(writer->thread, NULL);
+    }
+}
+
+void FULogWriterDestroy(FULogWriter *writer) {
+    if (!writer) {
+        return;
+    }
+    FULogWriterStop(writer);
+    if (writer->fd >= 0) {
+        close(writer->fd);
+    }
+    free(writer->path);
+    free(writer->header);
+    free(writer->lines);
+    free(writer->buffer);
+    free(writer);
+}
+
+void FULogWriterGetStats(const FULogWriter *writer, FULogWriterStats *stats) {
+    stats->appendedLines = atomic_load_explicit(&writer->appendedLines, memory_order_relaxed);
+    stats->droppedLines = atomic_load_explicit(&writer->droppedLines, memory_order_relaxed);
+    stats->truncatedLines = atomic_load_explicit(&writer->truncatedLines, memory_order_relaxed);
+    stats->writtenBytes = atomic_load_explicit(&writer->writtenBytes, memory_order_relaxed);
+    stats->writeCalls = atomic_load_explicit(&writer->writeCalls, memory_order_relaxed);
+    stats->fsyncCalls = atomic_load_explicit(&writer->fsyncCalls, memory_order_relaxed);
+    stats->rotations = atomic_load_explicit(&writer->rotations, memory_order_relaxed);
+    stats->writeErrors = atomic_load_explicit(&writer->writeErrors, memory_order_relaxed);
+}
+
+// Slot
+
+FULogWriter *FULogWriterSlotAcquire(FULogWriterSlot *slot) {
+    // 先登记再读取：替换方换下指针之后读到的计数一定包含读到旧指针的线程
+    atomic_fetch_add_explicit(&slot->users, 1, memory_order_seq_cst);
+    return atomic_load_explicit(&slot->writer, memory_order_seq_cst);
+}
+
+void FULogWriterSlotRelease(FULogWriterSlot *slot) {
+    atomic_fetch_sub_explicit(&slot->users, 1, memory_order_release);
+}
+
+FULogWriter *FULogWriterSlotExchange(FULogWriterSlot *slot, FULogWriter *writer) {
+    FULogWriter *previous = atomic_exchange_explicit(&slot->writer, writer, memory_order_seq_cst);
+    // 追加只做格式化与入队，等待很短；计数可能包含已取得新日志的线程，多等一次无妨
+    while (atomic_load_explicit(&slot->users, memory_order_seq_cst) != 0) {
+        sched_yield();
+    }
+    return previous;
+}
@@ -0,0 +1,98 @@
+//
+//  FULogWriter.h
+//  FUDemo
+//
+//  追加式日志文件：调用线程格式化到线程局部缓冲并入无锁队列，后台线程批量写入、定期 fsync、按大小轮转
+//
+
+#ifndef FULogWriter_h
+#define FULogWriter_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 单行最大字节数（含换行），超出部分截断
+#define FU_LOG_WRITER_LINE_MAX 256
+/// FULogWriterFormatTimestamp 输出的字节数（含结尾 0）："yyyy-MM-dd HH:mm:ss:SSS"
+#define FU_LOG_WRITER_TIMESTAMP_LENGTH 24
+
+typedef struct {
+    /// 队列行数，向上取整到 2 的幂；写入线程跟不上时新行丢弃并计数
+    uint32_t queueLines;
+    /// 写缓冲字节数，攒满或队列取空时调用一次 write
+    uint32_t flushBytes;
+    /// 两次 fsync 的最小间隔（毫秒），0 表示只在轮转与停止时 fsync
+    uint32_t fsyncIntervalMs;
+    /// 单个文件的最大字节数，超出时轮转；0 表示不轮转
+    uint64_t maxFileBytes;
+    /// 保留的旧文件数，旧文件为 <path>.1 ～ <path>.N，1 最新
+    uint32_t maxRotatedFiles;
+    /// 写入线程检查队列的间隔（毫秒）
+    uint32_t pollIntervalMs;
+} FULogWriterConfig;
+
+/// 默认配置：1024 行队列，64KB 写缓冲，每秒 fsync，单文件 8MB，保留 3 个旧文件，每 50ms 检查一次
+FULogWriterConfig FULogWriterDefaultConfig(void);
+
+/// 计数器，可在任意线程读取
+typedef struct {
+    uint64_t appendedLines;
+    uint64_t droppedLines;          // 队列已满而丢弃的行数
+    uint64_t truncatedLines;        // 超出 FU_LOG_WRITER_LINE_MAX 而截断的行数
+    uint64_t writtenBytes;
+    uint64_t writeCalls;
+    uint64_t fsyncCalls;
+    uint64_t rotations;
+    uint64_t writeErrors;
+} FULogWriterStats;
+
+typedef struct FULogWriter FULogWriter;
+
+/// 创建（覆盖）日志文件并写入表头，启动写入线程
+/// @param header 每个文件开头写入的内容（如 CSV 表头），可为 NULL
+FULogWriter *FULogWriterCreate(const char *path, const char *header, const FULogWriterConfig *config);
+
+/// 停止并释放
+void FULogWriterDestroy(FULogWriter *writer);
+
+/// 追加一行，可在任意线程并发调用：不分配内存、不加锁、不做文件 I/O
+/// @note 格式化在线程局部缓冲中完成；末尾没有换行时自动补上
+/// @return 队列已满或已停止时返回 false
+bool FULogWriterAppendf(FULogWriter *writer, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/// 本地时间 "yyyy-MM-dd HH:mm:ss:SSS"，时区偏移在创建时取得，不分配内存
+void FULogWriterFormatTimestamp(const FULogWriter *writer, double unixSeconds,
+                                char out[FU_LOG_WRITER_TIMESTAMP_LENGTH]);
+
+/// 写完队列中的行、fsync 并结束写入线程，之后的追加返回 false
+void FULogWriterStop(FULogWriter *writer);
+
+void FULogWriterGetStats(const FULogWriter *writer, FULogWriterStats *stats);
+
+/// 可替换的当前日志：追加线程取得后使用，替换方等取得旧日志的追加全部结束后再释放
+/// @note 需要零初始化（静态变量或 memset）
+typedef struct {
+    _Atomic(FULogWriter *) writer;
+    /// 正在使用 writer 的追加线程数
+    _Atomic uint32_t users;
+} FULogWriterSlot;
+
+/// 取得当前日志，无锁；无论是否返回 NULL 都要在用完后调用 FULogWriterSlotRelease
+FULogWriter *FULogWriterSlotAcquire(FULogWriterSlot *slot);
+
+void FULogWriterSlotRelease(FULogWriterSlot *slot);
+
+/// 换上新日志（可为 NULL），等待所有已取得日志的追加线程 Release 后返回旧日志，之后可以直接释放
+FULogWriter *FULogWriterSlotExchange(FULogWriterSlot *slot, FULogWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FULogWriter_h */
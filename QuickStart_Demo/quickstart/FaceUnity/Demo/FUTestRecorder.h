@@ -8,6 +8,19 @@
 
 #import <Foundation/Foundation.h>
 
+/// 视频前处理耗时统计阶段
+typedef NS_ENUM(NSUInteger, FUTestRecorderStage) {
+    FUTestRecorderStageTracking = 0,        // 检测结果处理
+    FUTestRecorderStageParamUpdate,         // 美颜参数更新
+    FUTestRecorderStageRender,              // 渲染
+    FUTestRecorderStageTotal,               // processVideoFrame: 总耗时
+    FUTestRecorderStageEffectSelect,        // 点击道具后主线程切换道具耗时
+    FUTestRecorderStageTapToEffect,         // 点击道具到第一帧带新效果的画面渲染完成
+    FUTestRecorderStageTapToEffectCached,   // 同上，道具已在缓存中（含预取命中）
+    FUTestRecorderStageTapToEffectUncached, // 同上，道具在点击时创建
+    FUTestRecorderStageCount
+};
+
 @interface FUTestRecorder : NSObject
 
 
@@ -15,6 +28,32 @@
 
 -(void)processFrameWithLog;
 
+/// 新建性能日志（Documents/<时间>.csv），每 100 帧追加一行 time,fps,cpu,memory；文件写入在后台线程批量进行
 - (void)setupRecord;
 
+/// 写完已追加的行并关闭性能日志
+- (void)stopRecord;
+
+/// 记录某阶段耗时，无锁且不申请内存，可在采集线程调用
+/// @param duration 耗时（秒）
+/// @param stage 阶段
+- (void)recordDuration:(CFTimeInterval)duration forStage:(FUTestRecorderStage)stage;
+
+/// 标记一次道具点击，之后第一帧渲染完成时记录点击到生效的耗时，可在任意线程调用
+- (void)markEffectSelection;
+
+/// 标记本次点击的道具是否命中缓存，在 markEffectSelection 之后调用；
+/// 点击到生效的耗时会同时记入 FUTestRecorderStageTapToEffectCached 或 FUTestRecorderStageTapToEffectUncached
+- (void)markEffectSelectionCached:(BOOL)cached;
+
+/// 渲染完成后调用，存在未完成的点击标记时记录 FUTestRecorderStageTapToEffect
+- (void)recordEffectRenderedIfNeeded;
+
+/// 开始定时输出各阶段 p50/p95/p99/max（后台线程统计，不影响采集线程）
+/// @param interval 统计窗口（秒）
+- (void)startLatencyReportWithInterval:(NSTimeInterval)interval;
+
+/// 停止定时输出
+- (void)stopLatencyReport;
+
 @end
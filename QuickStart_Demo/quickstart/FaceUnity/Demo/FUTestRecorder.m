@@ -7,14 +7,33 @@
 //
 
 #import "FUTestRecorder.h"
+#import "FULatencyHistogram.h"
+#import "FULogWriter.h"
 #include <sys/sysctl.h>
 #include <mach/mach.h>
 
+/// 各阶段耗时直方图，静态零初始化
+static FULatencyHistogram stageHistograms[FUTestRecorderStageCount];
+/// 帧间隔直方图
+static FULatencyHistogram frameIntervalHistogram;
+/// 最近一次道具点击时间（微秒），0 表示没有等待生效的点击
+static _Atomic uint64_t pendingSelectionTimeUs;
+/// 本次点击是否命中道具缓存：-1 未知，0 未命中，1 命中
+static _Atomic int pendingSelectionCached = -1;
+/// 性能日志，采集线程只格式化并入队，文件写入在后台线程
+static FULogWriterSlot logWriterSlot;
+
+static NSString * const FUTestRecorderStageNames[FUTestRecorderStageCount] = {
+    @"tracking", @"param", @"render", @"total", @"select", @"tap2effect", @"tap2effect.warm", @"tap2effect.cold"
+};
 
 @interface FUTestRecorder ()
 
 @property (nonatomic,strong) NSString *logPath;
 
+/// 耗时统计定时器
+@property (nonatomic, strong) dispatch_source_t reportTimer;
+
 @end
 
 @implementation FUTestRecorder
@@ -52,70 +71,125 @@
 
 
 - (void)setupRecord{
+    [self stopRecord];
     self.logPath = nil ;
-    [self createFile:self.logPath];
-    NSFileHandle* fileHandle = [NSFileHandle fileHandleForUpdatingAtPath:self.logPath];
-    [fileHandle seekToEndOfFile];
-    NSString * str = @"time,fps,cpu,memory\n";
-    NSData *stringData = [str dataUsingEncoding:NSUTF8StringEncoding];
-    [fileHandle writeData:stringData];
-    [fileHandle closeFile];
-}
-
-
-- (void)createFile:(NSString *)fileName {
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    [fileManager removeItemAtPath:fileName error:nil];
-    
-    if (![fileManager createFileAtPath:fileName contents:nil attributes:nil]) {
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    FULogWriter *logWriter = FULogWriterCreate(self.logPath.fileSystemRepresentation, "time,fps,cpu,memory\n", &config);
+    if (!logWriter) {
         NSLog(@"不能创建文件");
+        return;
     }
-    
+    // 并发的 setupRecord 换下的日志同样释放
+    FULogWriterDestroy(FULogWriterSlotExchange(&logWriterSlot, logWriter));
+}
+
+- (void)stopRecord{
+    // 返回时采集线程已不再持有旧日志，写完队列后直接释放
+    FULogWriterDestroy(FULogWriterSlotExchange(&logWriterSlot, NULL));
 }
 
 static CFAbsoluteTime oldTime = 0;
-static float totalTime = 0.0;
-static float totalCpu= 0.0;
 static int frame= 0;
 
 -(void)processFrameWithLog{
     CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
     CFAbsoluteTime currentFrameTime = startTime - oldTime;
     oldTime = startTime;
-    totalTime += currentFrameTime;
-    totalCpu += [self GetCpuUsage];
+    if (frame > 0) {
+        FULatencyHistogramRecord(&frameIntervalHistogram, (uint64_t)(currentFrameTime * 1000000.0));
+    }
     int count = 100;
     //
     frame++;
     if (frame % count == 0) {
-        float frameTime = totalTime ;
-        float cpu = totalCpu ;
-        totalTime = 0.0;
-        totalCpu = 0.0;
+        // 每 100 帧取一次帧间隔快照，CPU 只在输出时采样一次，避免逐帧调用 task_threads
+        FULatencyHistogramSnapshot snapshot;
+        FULatencyHistogramTakeSnapshot(&frameIntervalHistogram, &snapshot, true);
+        double frameTime = FULatencyHistogramSnapshotMean(&snapshot) / 1000000.0;
+        float fps = frameTime > 0 ? 1.0 / frameTime : 0;
+        float cpu = [self GetCpuUsage];
 
-        NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
-        formatter.dateFormat = @"yyyy-MM-dd HH:mm:ss:SSS";
-        NSDate *date = [NSDate date];
-        NSString *currnetDate = [formatter stringFromDate:date];
         double memory = [self usedMemory];
-        
-        frameTime = frameTime/count;
-        float fps = 1.0 / frameTime ;
-        if (fps > 30) {
-            fps = 30 ;
+
+        NSLog(@"⭐️%d,%.01f,%.02f", (int)fps, cpu, memory);
+
+        FULogWriter *logWriter = FULogWriterSlotAcquire(&logWriterSlot);
+        if (logWriter) {
+            // 时间在栈上格式化，整行进入写入队列，采集线程不做文件 I/O
+            char currnetDate[FU_LOG_WRITER_TIMESTAMP_LENGTH];
+            FULogWriterFormatTimestamp(logWriter, startTime + kCFAbsoluteTimeIntervalSince1970, currnetDate);
+            FULogWriterAppendf(logWriter, "%s,%d,%.01f,%.02f\n", currnetDate, (int)fps, cpu, memory);
         }
-//        NSLog(@"%@,%d,%.01f,%.02f\n",currnetDate,(int)fps,cpu/count,memory);
-        NSString *performance = [NSString stringWithFormat:@"%@,%d,%.01f,%.02f\n",currnetDate,(int)fps,cpu/count,memory];
-        
-        NSLog(@"⭐️%@", performance);
-
-       NSFileHandle* fileHandle = [NSFileHandle fileHandleForUpdatingAtPath:self.logPath];
-        NSData *stringData = [performance dataUsingEncoding:NSUTF8StringEncoding];
-       //将节点调到文件末尾
-       [fileHandle seekToEndOfFile];
-       //追加写入数据
-       [fileHandle writeData:stringData];
-       [fileHandle closeFile];
+        FULogWriterSlotRelease(&logWriterSlot);
+    }
+}
+
+- (void)recordDuration:(CFTimeInterval)duration forStage:(FUTestRecorderStage)stage {
+    if (stage >= FUTestRecorderStageCount || duration < 0) {
+        return;
+    }
+    FULatencyHistogramRecord(&stageHistograms[stage], (uint64_t)(duration * 1000000.0));
+}
+
+- (void)markEffectSelection {
+    atomic_store_explicit(&pendingSelectionCached, -1, memory_order_relaxed);
+    atomic_store_explicit(&pendingSelectionTimeUs, (uint64_t)(CFAbsoluteTimeGetCurrent() * 1000000.0), memory_order_relaxed);
+}
+
+- (void)markEffectSelectionCached:(BOOL)cached {
+    atomic_store_explicit(&pendingSelectionCached, cached ? 1 : 0, memory_order_relaxed);
+}
+
+- (void)recordEffectRenderedIfNeeded {
+    if (atomic_load_explicit(&pendingSelectionTimeUs, memory_order_relaxed) == 0) {
+        return;
+    }
+    uint64_t selectionTimeUs = atomic_exchange_explicit(&pendingSelectionTimeUs, 0, memory_order_relaxed);
+    uint64_t nowUs = (uint64_t)(CFAbsoluteTimeGetCurrent() * 1000000.0);
+    if (selectionTimeUs != 0 && nowUs > selectionTimeUs) {
+        FULatencyHistogramRecord(&stageHistograms[FUTestRecorderStageTapToEffect], nowUs - selectionTimeUs);
+        int cached = atomic_exchange_explicit(&pendingSelectionCached, -1, memory_order_relaxed);
+        if (cached >= 0) {
+            FUTestRecorderStage stage = cached ? FUTestRecorderStageTapToEffectCached : FUTestRecorderStageTapToEffectUncached;
+            FULatencyHistogramRecord(&stageHistograms[stage], nowUs - selectionTimeUs);
+        }
+    }
+}
+
+- (void)startLatencyReportWithInterval:(NSTimeInterval)interval {
+    [self stopLatencyReport];
+    dispatch_queue_t queue = dispatch_queue_create("com.faceunity.testrecorder.latency", DISPATCH_QUEUE_SERIAL);
+    self.reportTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+    uint64_t intervalNs = (uint64_t)(interval * NSEC_PER_SEC);
+    dispatch_source_set_timer(self.reportTimer, dispatch_time(DISPATCH_TIME_NOW, intervalNs), intervalNs, intervalNs / 10);
+    dispatch_source_set_event_handler(self.reportTimer, ^{
+        [FUTestRecorder reportLatency];
+    });
+    dispatch_resume(self.reportTimer);
+}
+
+- (void)stopLatencyReport {
+    if (self.reportTimer) {
+        dispatch_source_cancel(self.reportTimer);
+        self.reportTimer = nil;
+    }
+}
+
+/// 输出并清空各阶段统计窗口
++ (void)reportLatency {
+    FULatencyHistogramSnapshot snapshot;
+    for (NSUInteger stage = 0; stage < FUTestRecorderStageCount; stage++) {
+        FULatencyHistogramTakeSnapshot(&stageHistograms[stage], &snapshot, true);
+        if (snapshot.count == 0) {
+            continue;
+        }
+        NSLog(@"⏱%@ n=%llu p50=%.2fms p95=%.2fms p99=%.2fms max=%.2fms",
+              FUTestRecorderStageNames[stage],
+              snapshot.count,
+              FULatencyHistogramSnapshotPercentile(&snapshot, 50) / 1000.0,
+              FULatencyHistogramSnapshotPercentile(&snapshot, 95) / 1000.0,
+              FULatencyHistogramSnapshotPercentile(&snapshot, 99) / 1000.0,
+              snapshot.maxValue / 1000.0);
     }
 }
 
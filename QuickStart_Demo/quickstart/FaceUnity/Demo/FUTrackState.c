@@ -0,0 +1,45 @@
+//
+//  FUTrackState.c
+//  FUDemo
+//
+
+#include "FUTrackState.h"
+
+void FUTrackStateInit(FUTrackState *state, uint32_t debounceFrames) {
+    atomic_init(&state->tracked, false);
+    atomic_init(&state->needsNotify, true);
+    atomic_init(&state->debounceFrames, debounceFrames);
+    state->pendingFrames = 0;
+}
+
+bool FUTrackStateUpdate(FUTrackState *state, int detectedCount) {
+    bool detected = detectedCount > 0;
+    if (atomic_exchange_explicit(&state->needsNotify, false, memory_order_acquire)) {
+        state->pendingFrames = 0;
+        atomic_store_explicit(&state->tracked, detected, memory_order_release);
+        return true;
+    }
+    if (detected == atomic_load_explicit(&state->tracked, memory_order_relaxed)) {
+        state->pendingFrames = 0;
+        return false;
+    }
+    uint32_t debounceFrames = atomic_load_explicit(&state->debounceFrames, memory_order_relaxed);
+    if (++state->pendingFrames < (debounceFrames > 0 ? debounceFrames : 1)) {
+        return false;
+    }
+    state->pendingFrames = 0;
+    atomic_store_explicit(&state->tracked, detected, memory_order_release);
+    return true;
+}
+
+bool FUTrackStateIsTracked(const FUTrackState *state) {
+    return atomic_load_explicit(&state->tracked, memory_order_acquire);
+}
+
+void FUTrackStateReset(FUTrackState *state) {
+    atomic_store_explicit(&state->needsNotify, true, memory_order_release);
+}
+
+void FUTrackStateSetDebounceFrames(FUTrackState *state, uint32_t debounceFrames) {
+    atomic_store_explicit(&state->debounceFrames, debounceFrames, memory_order_relaxed);
+}
@@ -0,0 +1,52 @@
+//
+//  FUTrackState.h
+//  FUDemo
+//
+//  人脸/人体检测状态去抖
+//
+
+#ifndef FUTrackState_h
+#define FUTrackState_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 检测状态去抖，只在状态切换时报告
+/// @note update 只在视频前处理线程调用；tracked 可在任意线程读取，reset 与 debounceFrames 可在任意线程设置
+typedef struct {
+    /// 当前（去抖后的）状态：是否检测到目标
+    _Atomic bool tracked;
+    /// 下一次 update 无论结果如何都报告切换
+    _Atomic bool needsNotify;
+    /// 新状态连续保持多少帧才切换
+    _Atomic uint32_t debounceFrames;
+    /// 与当前状态不同的连续帧数，只由处理线程访问
+    uint32_t pendingFrames;
+} FUTrackState;
+
+/// @param debounceFrames 新状态连续保持多少帧才切换，0 按 1 处理
+void FUTrackStateInit(FUTrackState *state, uint32_t debounceFrames);
+
+/// 输入一帧的检测数量
+/// @return 本帧是否发生了状态切换（reset 后的第一帧总是返回 true）
+bool FUTrackStateUpdate(FUTrackState *state, int detectedCount);
+
+/// 当前状态，可在任意线程调用
+bool FUTrackStateIsTracked(const FUTrackState *state);
+
+/// 重置状态，可在任意线程调用
+void FUTrackStateReset(FUTrackState *state);
+
+/// 修改去抖帧数，可在任意线程调用，下一帧生效
+void FUTrackStateSetDebounceFrames(FUTrackState *state, uint32_t debounceFrames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FUTrackState_h */
@@ -0,0 +1,35 @@
+//
+//  FUTrackStateMonitor.h
+//  FUDemo
+//
+//  人脸/人体检测状态监听
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 检测状态去抖，只在状态切换时回调（状态机见 FUTrackState.h）
+/// @note 不依赖 UIKit 与 SDK，输入检测数量序列即可驱动。只在视频前处理线程中调用 update，其余属性与 reset 可在任意线程访问。
+@interface FUTrackStateMonitor : NSObject
+
+/// 新状态连续保持多少帧才切换，默认 5
+@property (atomic, assign) NSUInteger debounceFrames;
+
+/// 当前（去抖后的）状态：是否检测到目标
+@property (atomic, assign, readonly) BOOL tracked;
+
+/// 状态切换回调，在调用 updateWithDetectedCount: 的线程执行
+@property (atomic, copy, nullable) void (^stateChangedHandler)(BOOL tracked);
+
+/// 输入一帧的检测数量
+/// @param count 检测到的人脸/人体数量
+/// @return 本帧是否发生了状态切换
+- (BOOL)updateWithDetectedCount:(int)count;
+
+/// 重置状态，下一次 update 无论结果如何都会回调（切换检测目标时调用，可在任意线程调用）
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
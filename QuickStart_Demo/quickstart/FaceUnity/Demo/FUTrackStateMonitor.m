@@ -0,0 +1,48 @@
+//
+//  FUTrackStateMonitor.m
+//  FUDemo
+//
+
+#import "FUTrackStateMonitor.h"
+#include "FUTrackState.h"
+
+@implementation FUTrackStateMonitor {
+    FUTrackState _state;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        FUTrackStateInit(&_state, 5);
+    }
+    return self;
+}
+
+- (BOOL)updateWithDetectedCount:(int)count {
+    if (!FUTrackStateUpdate(&_state, count)) {
+        return NO;
+    }
+    void (^handler)(BOOL) = self.stateChangedHandler;
+    if (handler) {
+        handler(FUTrackStateIsTracked(&_state));
+    }
+    return YES;
+}
+
+- (void)reset {
+    FUTrackStateReset(&_state);
+}
+
+- (BOOL)tracked {
+    return FUTrackStateIsTracked(&_state);
+}
+
+- (NSUInteger)debounceFrames {
+    return atomic_load_explicit(&_state.debounceFrames, memory_order_relaxed);
+}
+
+- (void)setDebounceFrames:(NSUInteger)debounceFrames {
+    FUTrackStateSetDebounceFrames(&_state, (uint32_t)MIN(debounceFrames, UINT32_MAX));
+}
+
+@end
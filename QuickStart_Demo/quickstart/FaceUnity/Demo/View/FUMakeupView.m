@@ -19,6 +19,10 @@ static NSString * const kFUMakeupCellIdentifier = @"FUMakeupCell";
 
 @property (nonatomic, strong) FUMakeupViewModel *viewModel;
 
+/// 上次滑动位置与方向，用于预取
+@property (nonatomic, assign) CGFloat lastContentOffsetX;
+@property (nonatomic, assign) NSInteger scrollDirection;
+
 @end
 
 @implementation FUMakeupView
@@ -56,6 +60,8 @@ static NSString * const kFUMakeupCellIdentifier = @"FUMakeupCell";
     [self.collectionView addConstraint:height];
     // 默认选中
     [self.collectionView selectItemAtIndexPath:[NSIndexPath indexPathForItem:self.viewModel.selectedIndex inSection:0] animated:YES scrollPosition:UICollectionViewScrollPositionCenteredHorizontally];
+    // 预取默认选中位置附近的道具
+    [self.viewModel prefetchAroundIndex:self.viewModel.selectedIndex direction:1];
     self.slider.hidden = self.viewModel.selectedIndex < 1;
     if (!self.slider.hidden) {
         self.slider.value = self.viewModel.selectedMakeupValue;
@@ -94,6 +100,36 @@ static NSString * const kFUMakeupCellIdentifier = @"FUMakeupCell";
     }
 }
 
+#pragma mark - Scroll view delegate
+
+- (void)scrollViewDidScroll:(UIScrollView *)scrollView {
+    CGFloat offsetX = scrollView.contentOffset.x;
+    if (offsetX != self.lastContentOffsetX) {
+        self.scrollDirection = offsetX > self.lastContentOffsetX ? 1 : -1;
+        self.lastContentOffsetX = offsetX;
+    }
+}
+
+- (void)scrollViewDidEndDragging:(UIScrollView *)scrollView willDecelerate:(BOOL)decelerate {
+    if (!decelerate) {
+        [self prefetchAroundVisibleCenter];
+    }
+}
+
+- (void)scrollViewDidEndDecelerating:(UIScrollView *)scrollView {
+    [self prefetchAroundVisibleCenter];
+}
+
+/// 滑动停止后预取可见区域中间附近的道具
+- (void)prefetchAroundVisibleCenter {
+    NSArray<NSIndexPath *> *visibleIndexPaths = [self.collectionView.indexPathsForVisibleItems sortedArrayUsingSelector:@selector(compare:)];
+    if (visibleIndexPaths.count == 0) {
+        return;
+    }
+    NSInteger centerIndex = visibleIndexPaths[visibleIndexPaths.count / 2].item;
+    [self.viewModel prefetchAroundIndex:centerIndex direction:self.scrollDirection];
+}
+
 #pragma mark - Getters
 
 - (FUSlider *)slider {
@@ -6,7 +6,9 @@
 //
 
 #import "FUBeautyFilterViewModel.h"
+#import "FUBeautyParamCache.h"
 #import "FUBeautyFilterModel.h"
+#import "FUEffectCatalogLoader.h"
 #import "FUDefines.h"
 
 #import <FURenderKit/FURenderKit.h>
@@ -55,7 +57,7 @@
     }
     FUBeautyFilterModel *model = self.beautyFilters[self.selectedIndex];
     model.filterLevel = value;
-    [FURenderKit shareRenderKit].beauty.filterLevel = model.filterLevel;
+    [[FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].beauty] setValue:model.filterLevel forParamKey:@"filterLevel"];
 }
 
 - (NSString *)filterNameAtIndex:(NSUInteger)index {
@@ -76,13 +78,26 @@
 #pragma mark - Private methods
 
 - (void)setFilter:(NSString *)filterName level:(double)filterLevel {
-    [FURenderKit shareRenderKit].beauty.filterName = filterName;
-    [FURenderKit shareRenderKit].beauty.filterLevel = filterLevel;
+    FUBeautyParamCache *paramCache = [FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].beauty];
+    [paramCache setString:filterName forParamKey:@"filterName"];
+    [paramCache setValue:filterLevel forParamKey:@"filterLevel"];
 }
 
 #pragma mark - Getters
 
 - (NSArray<FUBeautyFilterModel *> *)defaultFilters {
+    const FUEffectCatalogRecord *records = NULL;
+    uint32_t count = 0;
+    if ([FUEffectCatalogLoader getRecords:&records count:&count forTable:FUEffectCatalogTableBeautyFilter]) {
+        NSMutableArray *filters = [[NSMutableArray alloc] initWithCapacity:count];
+        for (uint32_t i = 0; i < count; i++) {
+            FUBeautyFilterModel *model = [[FUBeautyFilterModel alloc] init];
+            model.filterName = [FUEffectCatalogLoader stringAtOffset:records[i].name];
+            model.filterLevel = records[i].currentValue;
+            [filters addObject:model];
+        }
+        return [filters copy];
+    }
     NSBundle *bundle = [NSBundle bundleForClass:[self class]];
     NSString *filterPath = [bundle pathForResource:@"beauty_filter" ofType:@"json"];
     NSArray<NSDictionary *> *filterData = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:filterPath] options:NSJSONReadingMutableContainers error:nil];
@@ -6,6 +6,8 @@
 //
 
 #import "FUBeautyShapeViewModel.h"
+#import "FUBeautyParamCache.h"
+#import "FUEffectCatalogLoader.h"
 
 @interface FUBeautyShapeViewModel ()
 
@@ -54,88 +56,109 @@
 #pragma mark - Private methods
 
 - (void)setValue:(double)value forType:(FUBeautyShape)type {
+    NSString *key = nil;
     switch (type) {
         case FUBeautyShapeCheekThinning:
-            [FURenderKit shareRenderKit].beauty.cheekThinning = value;
+            key = @"cheekThinning";
             break;
         case FUBeautyShapeCheekV:
-            [FURenderKit shareRenderKit].beauty.cheekV = value;
+            key = @"cheekV";
             break;
         case FUBeautyShapeCheekNarrow:
-            [FURenderKit shareRenderKit].beauty.cheekNarrow = value;
+            key = @"cheekNarrow";
             break;
         case FUBeautyShapeCheekShort:
-            [FURenderKit shareRenderKit].beauty.cheekShort = value;
+            key = @"cheekShort";
             break;
         case FUBeautyShapeCheekSmall:
-            [FURenderKit shareRenderKit].beauty.cheekSmall = value;
+            key = @"cheekSmall";
             break;
         case FUBeautyShapeCheekbones:
-            [FURenderKit shareRenderKit].beauty.intensityCheekbones = value;
+            key = @"intensityCheekbones";
             break;
         case FUBeautyShapeLowerJaw:
-            [FURenderKit shareRenderKit].beauty.intensityLowerJaw = value;
+            key = @"intensityLowerJaw";
             break;
         case FUBeautyShapeEyeEnlarging:
-            [FURenderKit shareRenderKit].beauty.eyeEnlarging = value;
+            key = @"eyeEnlarging";
             break;
         case FUBeautyShapeEyeCircle:
-            [FURenderKit shareRenderKit].beauty.intensityEyeCircle = value;
+            key = @"intensityEyeCircle";
             break;
         case FUBeautyShapeChin:
-            [FURenderKit shareRenderKit].beauty.intensityChin = value;
+            key = @"intensityChin";
             break;
         case FUBeautyShapeForehead:
-            [FURenderKit shareRenderKit].beauty.intensityForehead = value;
+            key = @"intensityForehead";
             break;
         case FUBeautyShapeNose:
-            [FURenderKit shareRenderKit].beauty.intensityNose = value;
+            key = @"intensityNose";
             break;
         case FUBeautyShapeMouth:
-            [FURenderKit shareRenderKit].beauty.intensityMouth = value;
+            key = @"intensityMouth";
             break;
         case FUBeautyShapeLipThick:
-            [FURenderKit shareRenderKit].beauty.intensityLipThick = value;
+            key = @"intensityLipThick";
             break;
         case FUBeautyShapeEyeHeight:
-            [FURenderKit shareRenderKit].beauty.intensityEyeHeight = value;
+            key = @"intensityEyeHeight";
             break;
         case FUBeautyShapeCanthus:
-            [FURenderKit shareRenderKit].beauty.intensityCanthus = value;
+            key = @"intensityCanthus";
             break;
         case FUBeautyShapeEyeLid:
-            [FURenderKit shareRenderKit].beauty.intensityEyeLid = value;
+            key = @"intensityEyeLid";
             break;
         case FUBeautyShapeEyeSpace:
-            [FURenderKit shareRenderKit].beauty.intensityEyeSpace = value;
+            key = @"intensityEyeSpace";
             break;
         case FUBeautyShapeEyeRotate:
-            [FURenderKit shareRenderKit].beauty.intensityEyeRotate = value;
+            key = @"intensityEyeRotate";
             break;
         case FUBeautyShapeLongNose:
-            [FURenderKit shareRenderKit].beauty.intensityLongNose = value;
+            key = @"intensityLongNose";
             break;
         case FUBeautyShapePhiltrum:
-            [FURenderKit shareRenderKit].beauty.intensityPhiltrum = value;
+            key = @"intensityPhiltrum";
             break;
         case FUBeautyShapeSmile:
-            [FURenderKit shareRenderKit].beauty.intensitySmile = value;
+            key = @"intensitySmile";
             break;
         case FUBeautyShapeBrowHeight:
-            [FURenderKit shareRenderKit].beauty.intensityBrowHeight = value;
+            key = @"intensityBrowHeight";
             break;
         case FUBeautyShapeBrowSpace:
-            [FURenderKit shareRenderKit].beauty.intensityBrowSpace = value;
+            key = @"intensityBrowSpace";
             break;
         case FUBeautyShapeBrowThick:
-            [FURenderKit shareRenderKit].beauty.intensityBrowThick = value;
+            key = @"intensityBrowThick";
             break;
     }
+    if (key) {
+        // 经由参数缓存暂存，视频前处理线程每帧渲染前统一写入道具
+        [[FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].beauty] setValue:value forParamKey:key];
+    }
 }
 
 #pragma mark - Getters
 
 - (NSArray<FUBeautyShapeModel *> *)defaultShapes {
+    const FUEffectCatalogRecord *records = NULL;
+    uint32_t count = 0;
+    if ([FUEffectCatalogLoader getRecords:&records count:&count forTable:FUEffectCatalogTableBeautyShape]) {
+        NSMutableArray *shapes = [[NSMutableArray alloc] initWithCapacity:count];
+        for (uint32_t i = 0; i < count; i++) {
+            FUBeautyShapeModel *model = [[FUBeautyShapeModel alloc] init];
+            model.name = [FUEffectCatalogLoader stringAtOffset:records[i].name];
+            model.type = records[i].type;
+            model.currentValue = records[i].currentValue;
+            model.defaultValue = records[i].defaultValue;
+            model.defaultValueInMiddle = (records[i].flags & FUEffectCatalogFlagDefaultValueInMiddle) != 0;
+            model.differentiateDevicePerformance = (records[i].flags & FUEffectCatalogFlagDifferentiateDevicePerformance) != 0;
+            [shapes addObject:model];
+        }
+        return [shapes copy];
+    }
     NSBundle *bundle = [NSBundle bundleForClass:[self class]];
     NSString *shapePath = [bundle pathForResource:@"beauty_shape" ofType:@"json"];
     NSArray<NSDictionary *> *shapeData = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:shapePath] options:NSJSONReadingMutableContainers error:nil];
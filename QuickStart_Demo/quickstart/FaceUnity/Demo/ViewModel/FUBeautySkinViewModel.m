@@ -6,7 +6,9 @@
 //
 
 #import "FUBeautySkinViewModel.h"
+#import "FUBeautyParamCache.h"
 #import "FUBeautySkinModel.h"
+#import "FUEffectCatalogLoader.h"
 
 @interface FUBeautySkinViewModel ()
 
@@ -54,35 +56,40 @@
 #pragma mark - Private methods
 
 - (void)setValue:(double)value forType:(FUBeautySkin)type {
+    NSString *key = nil;
     switch (type) {
         case FUBeautySkinBlurLevel:
-            [FURenderKit shareRenderKit].beauty.blurLevel = value;
+            key = @"blurLevel";
             break;
         case FUBeautySkinColorLevel:
-            [FURenderKit shareRenderKit].beauty.colorLevel = value;
+            key = @"colorLevel";
             break;
         case FUBeautySkinRedLevel:
-            [FURenderKit shareRenderKit].beauty.redLevel = value;
+            key = @"redLevel";
             break;
         case FUBeautySkinSharpen:
-            [FURenderKit shareRenderKit].beauty.sharpen = value;
+            key = @"sharpen";
             break;
         case FUBeautySkinFaceThreed:
-            [FURenderKit shareRenderKit].beauty.faceThreed = value;
+            key = @"faceThreed";
             break;
         case FUBeautySkinEyeBright:
-            [FURenderKit shareRenderKit].beauty.eyeBright = value;
+            key = @"eyeBright";
             break;
         case FUBeautySkinToothWhiten:
-            [FURenderKit shareRenderKit].beauty.toothWhiten = value;
+            key = @"toothWhiten";
             break;
         case FUBeautySkinRemovePouchStrength:
-            [FURenderKit shareRenderKit].beauty.removePouchStrength = value;
+            key = @"removePouchStrength";
             break;
         case FUBeautySkinRemoveNasolabialFoldsStrength:
-            [FURenderKit shareRenderKit].beauty.removeNasolabialFoldsStrength = value;
+            key = @"removeNasolabialFoldsStrength";
             break;
     }
+    if (key) {
+        // 经由参数缓存暂存，视频前处理线程每帧渲染前统一写入道具
+        [[FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].beauty] setValue:value forParamKey:key];
+    }
 }
 
 #pragma mark - Getters
@@ -99,6 +106,22 @@
 }
 
 - (NSArray<FUBeautySkinModel *> *)defaultSkins {
+    const FUEffectCatalogRecord *records = NULL;
+    uint32_t count = 0;
+    if ([FUEffectCatalogLoader getRecords:&records count:&count forTable:FUEffectCatalogTableBeautySkin]) {
+        NSMutableArray *skins = [[NSMutableArray alloc] initWithCapacity:count];
+        for (uint32_t i = 0; i < count; i++) {
+            FUBeautySkinModel *model = [[FUBeautySkinModel alloc] init];
+            model.name = [FUEffectCatalogLoader stringAtOffset:records[i].name];
+            model.type = records[i].type;
+            model.currentValue = records[i].currentValue;
+            model.defaultValue = records[i].defaultValue;
+            model.defaultValueInMiddle = (records[i].flags & FUEffectCatalogFlagDefaultValueInMiddle) != 0;
+            model.ratio = records[i].ratio;
+            [skins addObject:model];
+        }
+        return [skins copy];
+    }
     NSBundle *bundle = [NSBundle bundleForClass:[self class]];
     NSString *skinPath = [bundle pathForResource:@"beauty_skin" ofType:@"json"];
     NSArray<NSDictionary *> *skinData = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:skinPath] options:NSJSONReadingMutableContainers error:nil];
@@ -7,6 +7,8 @@
 
 #import "FUBodyViewModel.h"
 #import "FUBodyModel.h"
+#import "FUEffectCatalogLoader.h"
+#import "FUBeautyParamCache.h"
 
 @interface FUBodyViewModel ()
 
@@ -72,29 +74,34 @@
 #pragma mark - Private methods
 
 - (void)setValue:(double)value forType:(FUBeautyBodyItem)type {
+    NSString *key = nil;
     switch (type) {
         case FUBeautyBodyItemSlim:
-            [FURenderKit shareRenderKit].bodyBeauty.bodySlimStrength = value;
+            key = @"bodySlimStrength";
             break;
         case FUBeautyBodyItemLongLeg:
-            [FURenderKit shareRenderKit].bodyBeauty.legSlimStrength = value;
+            key = @"legSlimStrength";
             break;
         case FUBeautyBodyItemThinWaist:
-            [FURenderKit shareRenderKit].bodyBeauty.waistSlimStrength = value;
+            key = @"waistSlimStrength";
             break;
         case FUBeautyBodyItemBeautyShoulder:
-            [FURenderKit shareRenderKit].bodyBeauty.shoulderSlimStrength = value;
+            key = @"shoulderSlimStrength";
             break;
         case FUBeautyBodyItemBeautyButtock:
-            [FURenderKit shareRenderKit].bodyBeauty.hipSlimStrength = value;
+            key = @"hipSlimStrength";
             break;
         case FUBeautyBodyItemSmallHead:
-            [FURenderKit shareRenderKit].bodyBeauty.headSlim = value;
+            key = @"headSlim";
             break;
         case FUBeautyBodyItemThinLeg:
-            [FURenderKit shareRenderKit].bodyBeauty.legSlim = value;
+            key = @"legSlim";
             break;
     }
+    if (key) {
+        // 经由参数缓存暂存，视频前处理线程每帧渲染前统一写入道具
+        [[FUBeautyParamCache cacheForItem:[FURenderKit shareRenderKit].bodyBeauty] setValue:value forParamKey:key];
+    }
 }
 
 #pragma mark - Getters
@@ -111,6 +118,21 @@
 }
 
 - (NSArray<FUBodyModel *> *)defaultBodies {
+    const FUEffectCatalogRecord *records = NULL;
+    uint32_t count = 0;
+    if ([FUEffectCatalogLoader getRecords:&records count:&count forTable:FUEffectCatalogTableBody]) {
+        NSMutableArray *bodies = [[NSMutableArray alloc] initWithCapacity:count];
+        for (uint32_t i = 0; i < count; i++) {
+            FUBodyModel *model = [[FUBodyModel alloc] init];
+            model.name = [FUEffectCatalogLoader stringAtOffset:records[i].name];
+            model.type = records[i].type;
+            model.currentValue = records[i].currentValue;
+            model.defaultValue = records[i].defaultValue;
+            model.defaultValueInMiddle = (records[i].flags & FUEffectCatalogFlagDefaultValueInMiddle) != 0;
+            [bodies addObject:model];
+        }
+        return [bodies copy];
+    }
     NSBundle *bundle = [NSBundle bundleForClass:[self class]];
     NSString *path = [bundle pathForResource:@"body" ofType:@"json"];
     NSArray<NSDictionary *> *bodyData = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:path] options:NSJSONReadingMutableContainers error:nil];
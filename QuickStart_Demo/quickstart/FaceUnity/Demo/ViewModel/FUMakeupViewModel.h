@@ -28,6 +28,11 @@ NS_ASSUME_NONNULL_BEGIN
 /// @param index 组合妆索引，0为卸妆
 - (void)selectCombinationMakeupAtIndex:(NSInteger)index;
 
+/// 预取相邻的组合妆道具
+/// @param index 选中或滑动停留的位置
+/// @param direction 滑动方向，1 向后、-1 向前、0 未知
+- (void)prefetchAroundIndex:(NSInteger)index direction:(NSInteger)direction;
+
 /// 组合妆名称
 /// @param index 索引
 - (NSString *)combinationMakeupNameAtIndex:(NSUInteger)index;
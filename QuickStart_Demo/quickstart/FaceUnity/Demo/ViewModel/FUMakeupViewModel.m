@@ -7,6 +7,11 @@
 
 #import "FUMakeupViewModel.h"
 #import "FUMakeupModel.h"
+#import "FUEffectCatalogLoader.h"
+#import "FUItemPackageCache.h"
+#import "FUItemPrefetcher.h"
+#import "FUTestRecorder.h"
+#import "FUDemoManager.h"
 #import "FUDefines.h"
 
 #import <FURenderKit/FURenderKit.h>
@@ -17,8 +22,20 @@
 
 @property (nonatomic, assign) NSInteger selectedIndex;
 
+/// 组合妆道具缓存，切回最近用过的妆容时不再重新加载道具包
+@property (nonatomic, strong) FUItemPackageCache<FUItem *> *itemCache;
+/// 相邻组合妆预取
+@property (nonatomic, strong) FUItemPrefetcher<FUItem *> *prefetcher;
+/// 各组合妆道具包路径，卸妆为空串
+@property (nonatomic, copy) NSArray<NSString *> *bundlePaths;
+/// 当前组合妆道具
+@property (nonatomic, strong, nullable) FUItem *currentItem;
+
 @end
 
+/// 组合妆道具缓存预算
+static const NSUInteger kMakeupItemCacheBudget = 8 * 1024 * 1024;
+
 @implementation FUMakeupViewModel
 
 - (instancetype)init {
@@ -30,9 +47,35 @@
 }
 
 - (void)selectCombinationMakeupAtIndex:(NSInteger)index {
+    [[FUTestRecorder shareRecorder] markEffectSelection];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [self applyCombinationMakeupAtIndex:index];
+    [[FUTestRecorder shareRecorder] recordDuration:CFAbsoluteTimeGetCurrent() - startTime forStage:FUTestRecorderStageEffectSelect];
+    [[NSNotificationCenter defaultCenter] postNotificationName:FUDemoEffectDidChangeNotification object:self];
+    [self prefetchAroundIndex:index direction:0];
+}
+
+- (void)prefetchAroundIndex:(NSInteger)index direction:(NSInteger)direction {
+    [self.prefetcher prefetchAroundIndex:index inPaths:self.bundlePaths direction:direction];
+}
+
+- (NSString *)combinationMakeupNameAtIndex:(NSUInteger)index {
+    FUMakeupModel *model = self.combinationMakeups[index];
+    return FULocalizedString(model.name);
+}
+
+- (UIImage *)combinationMakeupIconAtIndex:(NSUInteger)index {
+    FUMakeupModel *model = self.combinationMakeups[index];
+    return [UIImage imageNamed:model.icon];
+}
+
+
+#pragma mark - Private methods
+
+- (void)applyCombinationMakeupAtIndex:(NSInteger)index {
     if (index == 0) {
-        // 卸妆
-        [FURenderKit shareRenderKit].makeup = nil;
+        // 卸妆只关闭美妆，不置空：置空会释放美妆及其绑定的组合妆道具，缓存中的道具句柄随之失效
+        [FURenderKit shareRenderKit].makeup.enable = NO;
         self.selectedIndex = 0;
         return;
     }
@@ -44,24 +87,27 @@
         makeup.makeupSegmentation = [FURenderKit devicePerformanceLevel] >= FUDevicePerformanceLevelHigh;
         [FURenderKit shareRenderKit].makeup = makeup;
     }
+    [FURenderKit shareRenderKit].makeup.enable = YES;
     FUMakeupModel *model = self.combinationMakeups[index];
     NSString *bundlePath = [[NSBundle mainBundle] pathForResource:model.bundleName ofType:@"bundle"];
-    FUItem *item = [[FUItem alloc] initWithPath:bundlePath name:model.bundleName];
-    [[FURenderKit shareRenderKit].makeup updateMakeupPackage:item needCleanSubItem:NO];
+    NSUInteger hitCount = self.itemCache.hitCount;
+    FUItem *item = [self.itemCache itemForPath:bundlePath cost:0 creator:^FUItem *(NSString *path) {
+        return [self createItemWithPath:path];
+    }];
+    [[FUTestRecorder shareRecorder] markEffectSelectionCached:self.itemCache.hitCount > hitCount];
+    if (item != self.currentItem) {
+        // needCleanSubItem 为 NO 时 SDK 不释放旧的组合妆道具，缓存中的道具切回时可直接复用
+        [[FURenderKit shareRenderKit].makeup updateMakeupPackage:item needCleanSubItem:NO];
+        self.currentItem = item;
+    }
     [FURenderKit shareRenderKit].makeup.intensity = model.value;
 }
 
-- (NSString *)combinationMakeupNameAtIndex:(NSUInteger)index {
-    FUMakeupModel *model = self.combinationMakeups[index];
-    return FULocalizedString(model.name);
-}
-
-- (UIImage *)combinationMakeupIconAtIndex:(NSUInteger)index {
-    FUMakeupModel *model = self.combinationMakeups[index];
-    return [UIImage imageNamed:model.icon];
+- (FUItem *)createItemWithPath:(NSString *)path {
+    // 道具名与道具包文件名一致
+    return [[FUItem alloc] initWithPath:path name:path.lastPathComponent.stringByDeletingPathExtension];
 }
 
-
 #pragma mark - Setters
 
 - (void)setSelectedMakeupValue:(double)selectedMakeupValue {
@@ -75,8 +121,51 @@
 
 #pragma mark - Getters
 
+- (FUItemPackageCache<FUItem *> *)itemCache {
+    if (!_itemCache) {
+        _itemCache = [[FUItemPackageCache alloc] initWithByteBudget:kMakeupItemCacheBudget];
+    }
+    return _itemCache;
+}
+
+- (FUItemPrefetcher<FUItem *> *)prefetcher {
+    if (!_prefetcher) {
+        __weak typeof(self) weakSelf = self;
+        _prefetcher = [[FUItemPrefetcher alloc] initWithCache:self.itemCache creator:^FUItem *(NSString *path) {
+            return [weakSelf createItemWithPath:path];
+        }];
+    }
+    return _prefetcher;
+}
+
+- (NSArray<NSString *> *)bundlePaths {
+    if (!_bundlePaths) {
+        NSMutableArray<NSString *> *paths = [NSMutableArray arrayWithCapacity:self.combinationMakeups.count];
+        for (FUMakeupModel *model in self.combinationMakeups) {
+            [paths addObject:[[NSBundle mainBundle] pathForResource:model.bundleName ofType:@"bundle"] ?: @""];
+        }
+        _bundlePaths = [paths copy];
+    }
+    return _bundlePaths;
+}
+
 - (NSArray<FUMakeupModel *> *)combinationMakeups {
     if (!_combinationMakeups) {
+        const FUEffectCatalogRecord *records = NULL;
+        uint32_t count = 0;
+        if ([FUEffectCatalogLoader getRecords:&records count:&count forTable:FUEffectCatalogTableCombinationMakeup]) {
+            NSMutableArray *makeups = [[NSMutableArray alloc] initWithCapacity:count];
+            for (uint32_t i = 0; i < count; i++) {
+                FUMakeupModel *model = [[FUMakeupModel alloc] init];
+                model.name = [FUEffectCatalogLoader stringAtOffset:records[i].name];
+                model.icon = [FUEffectCatalogLoader stringAtOffset:records[i].icon];
+                model.bundleName = [FUEffectCatalogLoader stringAtOffset:records[i].bundleName];
+                model.value = records[i].currentValue;
+                [makeups addObject:model];
+            }
+            _combinationMakeups = [makeups copy];
+            return _combinationMakeups;
+        }
         NSBundle *bundle = [NSBundle bundleForClass:[self class]];
         NSString *path = [bundle pathForResource:@"combination_makeups" ofType:@"json"];
         NSArray<NSDictionary *> *data = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:path] options:NSJSONReadingMutableContainers error:nil];
@@ -20,6 +20,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (UIImage *)stickerIconAtIndex:(NSUInteger)index;
 
+/// 预取相邻的贴纸道具
+/// @param index 选中或滑动停留的位置
+/// @param direction 滑动方向，1 向后、-1 向前、0 未知
+- (void)prefetchAroundIndex:(NSInteger)index direction:(NSInteger)direction;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -7,6 +7,11 @@
 
 #import "FUStickerViewModel.h"
 #import "FUStickerModel.h"
+#import "FUEffectCatalogLoader.h"
+#import "FUItemPackageCache.h"
+#import "FUItemPrefetcher.h"
+#import "FUTestRecorder.h"
+#import "FUDemoManager.h"
 #import <FURenderKit/FURenderKit.h>
 
 @interface FUStickerViewModel ()
@@ -14,15 +19,28 @@
 @property (nonatomic, copy) NSArray<FUStickerModel *> *stickers;
 /// 当前的贴纸
 @property (nonatomic, strong) FUSticker *currentSticker;
+/// 贴纸道具缓存，切回最近用过的贴纸时不再重新加载道具包
+@property (nonatomic, strong) FUItemPackageCache<FUSticker *> *stickerCache;
+/// 相邻贴纸预取
+@property (nonatomic, strong) FUItemPrefetcher<FUSticker *> *prefetcher;
+/// 各贴纸道具包路径，移除贴纸为空串
+@property (nonatomic, copy) NSArray<NSString *> *bundlePaths;
+/// 已加入贴纸容器的贴纸路径。切换贴纸只开关 enable，不经过 replaceSticker/removeAllSticks（会释放旧贴纸的道具句柄），
+/// 贴纸被缓存淘汰时才从容器移除
+@property (nonatomic, strong) NSMutableSet<NSString *> *loadedPaths;
 
 @end
 
+/// 贴纸道具缓存预算
+static const NSUInteger kStickerCacheBudget = 4 * 1024 * 1024;
+
 @implementation FUStickerViewModel
 
 - (instancetype)init {
     self = [super init];
     if (self) {
         _selectedIndex = 0;
+        _loadedPaths = [NSMutableSet set];
     }
     return self;
 }
@@ -33,25 +51,122 @@
 }
 
 - (void)setSelectedIndex:(NSInteger)selectedIndex {
+    [[FUTestRecorder shareRecorder] markEffectSelection];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [self applyStickerAtIndex:selectedIndex];
+    [[FUTestRecorder shareRecorder] recordDuration:CFAbsoluteTimeGetCurrent() - startTime forStage:FUTestRecorderStageEffectSelect];
+    [[NSNotificationCenter defaultCenter] postNotificationName:FUDemoEffectDidChangeNotification object:self];
+    [self prefetchAroundIndex:selectedIndex direction:0];
+}
+
+- (void)prefetchAroundIndex:(NSInteger)index direction:(NSInteger)direction {
+    [self.prefetcher prefetchAroundIndex:index inPaths:self.bundlePaths direction:direction];
+}
+
+#pragma mark - Private methods
+
+- (void)applyStickerAtIndex:(NSInteger)selectedIndex {
     if (selectedIndex == 0) {
-        [[FURenderKit shareRenderKit].stickerContainer removeAllSticks];
+        [self unloadSticker:self.currentSticker];
         _selectedIndex = 0;
+        self.currentSticker = nil;
         return;
     }
     FUStickerModel *model = self.stickers[selectedIndex];
     NSString *path = [[NSBundle mainBundle] pathForResource:model.bundleName ofType:@"bundle"];
-    FUSticker *sticker = [[FUSticker alloc] initWithPath:path name:@"sticker"];
-    if (self.currentSticker) {
-        [[FURenderKit shareRenderKit].stickerContainer replaceSticker:self.currentSticker withSticker:sticker completion:nil];
-    } else {
+    NSUInteger hitCount = self.stickerCache.hitCount;
+    FUSticker *sticker = [self.stickerCache itemForPath:path cost:0 creator:^FUSticker *(NSString *bundlePath) {
+        return [self createStickerWithPath:bundlePath];
+    }];
+    [[FUTestRecorder shareRecorder] markEffectSelectionCached:self.stickerCache.hitCount > hitCount];
+    if (sticker == self.currentSticker) {
+        _selectedIndex = selectedIndex;
+        return;
+    }
+    [self unloadSticker:self.currentSticker];
+    sticker.enable = YES;
+    if (![self.loadedPaths containsObject:sticker.path]) {
+        [self.loadedPaths addObject:sticker.path];
         [[FURenderKit shareRenderKit].stickerContainer addSticker:sticker completion:nil];
     }
     _selectedIndex = selectedIndex;
     self.currentSticker = sticker;
 }
 
+- (FUSticker *)createStickerWithPath:(NSString *)path {
+    return [[FUSticker alloc] initWithPath:path name:@"sticker"];
+}
+
+/// 卸下贴纸：缓存中的贴纸只关闭，留在容器中以便切回时复用；超出预算未缓存的贴纸直接移除
+- (void)unloadSticker:(FUSticker *)sticker {
+    if (!sticker) {
+        return;
+    }
+    sticker.enable = NO;
+    if (![self.stickerCache containsItemForPath:sticker.path]) {
+        [self removeLoadedSticker:sticker];
+    }
+}
+
+- (void)removeLoadedSticker:(FUSticker *)sticker {
+    if (sticker.path && [self.loadedPaths containsObject:sticker.path]) {
+        [self.loadedPaths removeObject:sticker.path];
+        [[FURenderKit shareRenderKit].stickerContainer removeSticker:sticker completion:nil];
+    }
+}
+
+#pragma mark - Getters
+
+- (FUItemPackageCache<FUSticker *> *)stickerCache {
+    if (!_stickerCache) {
+        _stickerCache = [[FUItemPackageCache alloc] initWithByteBudget:kStickerCacheBudget];
+        __weak typeof(self) weakSelf = self;
+        _stickerCache.evictionHandler = ^(FUSticker *sticker, NSString *path) {
+            // 淘汰的贴纸不会再复用，从容器移除以释放道具句柄；正在使用的贴纸由 currentSticker 持有，卸下时再移除
+            if (sticker != weakSelf.currentSticker) {
+                [weakSelf removeLoadedSticker:sticker];
+            }
+        };
+    }
+    return _stickerCache;
+}
+
+- (FUItemPrefetcher<FUSticker *> *)prefetcher {
+    if (!_prefetcher) {
+        __weak typeof(self) weakSelf = self;
+        _prefetcher = [[FUItemPrefetcher alloc] initWithCache:self.stickerCache creator:^FUSticker *(NSString *path) {
+            return [weakSelf createStickerWithPath:path];
+        }];
+    }
+    return _prefetcher;
+}
+
+- (NSArray<NSString *> *)bundlePaths {
+    if (!_bundlePaths) {
+        NSMutableArray<NSString *> *paths = [NSMutableArray arrayWithCapacity:self.stickers.count];
+        for (FUStickerModel *model in self.stickers) {
+            [paths addObject:[[NSBundle mainBundle] pathForResource:model.bundleName ofType:@"bundle"] ?: @""];
+        }
+        _bundlePaths = [paths copy];
+    }
+    return _bundlePaths;
+}
+
 - (NSArray<FUStickerModel *> *)stickers {
     if (!_stickers) {
+        const FUEffectCatalogRecord *records = NULL;
+        uint32_t count = 0;
+        if ([FUEffectCatalogLoader getRecords:&records count:&count forTable:FUEffectCatalogTableSticker]) {
+            NSMutableArray *stickers = [[NSMutableArray alloc] initWithCapacity:count];
+            for (uint32_t i = 0; i < count; i++) {
+                FUStickerModel *model = [[FUStickerModel alloc] init];
+                model.icon = [FUEffectCatalogLoader stringAtOffset:records[i].icon];
+                model.bundleName = [FUEffectCatalogLoader stringAtOffset:records[i].bundleName];
+                [stickers addObject:model];
+            }
+            _stickers = [stickers copy];
+            return _stickers;
+        }
         NSBundle *bundle = [NSBundle bundleForClass:[self class]];
         NSString *path = [bundle pathForResource:@"stickers" ofType:@"json"];
         NSArray<NSDictionary *> *data = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:path] options:NSJSONReadingMutableContainers error:nil];
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+#
+#  compile_effect_catalog.py
+#  FUDemo
+#
+#  把 Demo/Resource 下的效果配置 JSON 编译为二进制目录 effects.catalog，
+#  布局与 Demo/FUEffectCatalog.h 一致。修改任一 JSON 后需重新运行：
+#
+#      python3 FaceUnity/Tools/compile_effect_catalog.py
+#
+#  --check 只检查已有目录是否与 JSON 一致（不一致时返回 1），Xcode 的 Check Effect Catalog 构建阶段会调用。
+#  --dump <path> 另外把每条记录的字段按行写成文本，供 tests/FUEffectCatalogTests 与二进制目录逐字段对比。
+#
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+MAGIC = 0x43455546
+VERSION = 1
+
+HEADER = struct.Struct('<IHHIIIIQ')
+TABLE_ENTRY = struct.Struct('<II')
+RECORD = struct.Struct('<IIIiddiI')
+
+FLAG_DEFAULT_VALUE_IN_MIDDLE = 1 << 0
+FLAG_DIFFERENTIATE_DEVICE_PERFORMANCE = 1 << 1
+
+RESOURCE_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'Demo', 'Resource'))
+
+# 顺序与 FUEffectCatalogTable 一致
+SOURCES = [
+    '美颜/beauty_skin.json',
+    '美颜/beauty_shape.json',
+    '美颜/beauty_filter.json',
+    '美妆/combination_makeups.json',
+    '贴纸/stickers.json',
+    '美体/body.json',
+]
+
+
+def fnv1a64(data, seed=0):
+    value = seed or 0xcbf29ce484222325
+    for byte in data:
+        value ^= byte
+        value = (value * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return value
+
+
+class StringTable:
+    def __init__(self):
+        self.data = bytearray(b'\0')
+        self.offsets = {'': 0}
+
+    def add(self, text):
+        if text not in self.offsets:
+            self.offsets[text] = len(self.data)
+            self.data += text.encode('utf-8') + b'\0'
+        return self.offsets[text]
+
+
+def record_fields(entry):
+    """各表字段到定长记录的映射，见 FUEffectCatalogRecord 注释"""
+    name = entry.get('name', entry.get('filterName', ''))
+    value = entry.get('currentValue', entry.get('filterLevel', entry.get('value', 0.0)))
+    default = entry.get('defaultValue', entry.get('filterLevel', entry.get('value', 0.0)))
+    flags = 0
+    if entry.get('defaultValueInMiddle', False):
+        flags |= FLAG_DEFAULT_VALUE_IN_MIDDLE
+    if entry.get('differentiateDevicePerformance', False):
+        flags |= FLAG_DIFFERENTIATE_DEVICE_PERFORMANCE
+    return (name, entry.get('icon', ''), entry.get('bundleName', ''), int(entry.get('type', 0)), float(value),
+            float(default), int(entry.get('ratio', 0)), flags)
+
+
+def make_record(strings, fields):
+    name, icon, bundle_name, type_, value, default, ratio, flags = fields
+    return RECORD.pack(strings.add(name), strings.add(icon), strings.add(bundle_name), type_, value, default, ratio, flags)
+
+
+def align8(data):
+    data += b'\0' * (-len(data) % 8)
+
+
+def load_sources(resource_dir):
+    """返回 (源文件哈希, 每张表的记录字段列表)"""
+    source_hash = 0
+    tables = []
+    for source in SOURCES:
+        with open(os.path.join(resource_dir, source), 'rb') as f:
+            raw = f.read()
+        source_hash = fnv1a64(raw, source_hash)
+        tables.append([record_fields(entry) for entry in json.loads(raw)])
+    return source_hash, tables
+
+
+def compile_catalog(source_hash, field_tables):
+    strings = StringTable()
+    tables = [[make_record(strings, fields) for fields in table] for table in field_tables]
+
+    body = bytearray()
+    offset = HEADER.size + TABLE_ENTRY.size * len(tables)
+    offset += -offset % 8
+    directory = bytearray()
+    for records in tables:
+        directory += TABLE_ENTRY.pack(offset + len(body), len(records))
+        for record in records:
+            body += record
+        align8(body)
+    string_offset = offset + len(body)
+    header = HEADER.pack(MAGIC, VERSION, len(tables), RECORD.size, string_offset, len(strings.data), 0, source_hash)
+    data = bytearray(header + directory)
+    align8(data)
+    return bytes(data + body + strings.data)
+
+
+def write_dump(path, source_hash, field_tables):
+    """首行为源文件哈希（十六进制），之后每行：表序号 记录序号 name icon bundleName type currentValue defaultValue ratio flags，以制表符分隔"""
+    with open(path, 'w', encoding='utf-8') as f:
+        f.write('%016x\n' % source_hash)
+        for table_index, table in enumerate(field_tables):
+            for record_index, (name, icon, bundle_name, type_, value, default, ratio, flags) in enumerate(table):
+                f.write('\t'.join([str(table_index), str(record_index), name, icon, bundle_name, str(type_),
+                                   repr(value), repr(default), str(ratio), str(flags)]) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile effect JSON files into effects.catalog')
+    parser.add_argument('--resources', default=RESOURCE_DIR, help='Demo/Resource directory')
+    parser.add_argument('--output', help='output path, defaults to <resources>/effects.catalog')
+    parser.add_argument('--check', action='store_true', help='only check that the existing catalog is up to date')
+    parser.add_argument('--dump', help='also write the record fields as text, one record per line')
+    args = parser.parse_args()
+    output = args.output or os.path.join(args.resources, 'effects.catalog')
+    source_hash, field_tables = load_sources(args.resources)
+    data = compile_catalog(source_hash, field_tables)
+    if args.dump:
+        write_dump(args.dump, source_hash, field_tables)
+    if args.check:
+        try:
+            with open(output, 'rb') as f:
+                current = f.read()
+        except OSError:
+            current = None
+        if current != data:
+            print('error: %s is out of date, run %s' % (output, os.path.basename(__file__)), file=sys.stderr)
+            return 1
+        return 0
+    with open(output, 'wb') as f:
+        f.write(data)
+    print('wrote %s (%d bytes)' % (output, len(data)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,89 @@
+//
+//  FrameBudget.c
+//  quickstart
+//
+
+#include "FrameBudget.h"
+
+#include <string.h>
+
+FrameBudgetConfig FrameBudgetDefaultConfig(int frameRate) {
+    FrameBudgetConfig config = {
+        .budgetMs = 1000.0 / (frameRate > 0 ? frameRate : 1),
+        .smoothingFactor = 0.2,
+        .stepDownRatio = 0.9,
+        .stepUpRatio = 0.6,
+        .stepDownFrames = 15,
+        .stepUpFrames = 90,
+        .maxLevel = FrameBudgetLevelSparseTracking,
+    };
+    return config;
+}
+
+bool FrameBudgetInit(FrameBudget *budget, const FrameBudgetConfig *config) {
+    if (!budget || !config || config->budgetMs <= 0 || config->smoothingFactor <= 0 || config->smoothingFactor > 1 ||
+        config->stepUpRatio >= config->stepDownRatio || config->stepDownFrames == 0 || config->stepUpFrames == 0 ||
+        config->maxLevel < FrameBudgetLevelFull || config->maxLevel > FrameBudgetLevelSparseTracking) {
+        return false;
+    }
+    memset(budget, 0, sizeof(FrameBudget));
+    budget->config = *config;
+    budget->level = FrameBudgetLevelFull;
+    return true;
+}
+
+static bool FrameBudgetChangeLevel(FrameBudget *budget, FrameBudgetLevel level) {
+    // 切档后重新累计，新档位的耗时需要若干帧才能体现在平滑值中
+    budget->overBudgetFrames = 0;
+    budget->underBudgetFrames = 0;
+    if (budget->level == level) {
+        return false;
+    }
+    budget->level = level;
+    budget->levelChanges++;
+    return true;
+}
+
+bool FrameBudgetRecord(FrameBudget *budget, double costMs) {
+    const FrameBudgetConfig *config = &budget->config;
+    if (budget->smoothedCostMs <= 0) {
+        budget->smoothedCostMs = costMs;
+    } else {
+        budget->smoothedCostMs += config->smoothingFactor * (costMs - budget->smoothedCostMs);
+    }
+    budget->recordedFrames++;
+    budget->framesAtLevel[budget->level]++;
+
+    if (budget->smoothedCostMs > config->budgetMs * config->stepDownRatio) {
+        budget->overBudgetFrames++;
+        budget->underBudgetFrames = 0;
+    } else if (budget->smoothedCostMs < config->budgetMs * config->stepUpRatio) {
+        budget->underBudgetFrames++;
+        budget->overBudgetFrames = 0;
+    } else {
+        // 处于迟滞区间，保持当前档位
+        budget->overBudgetFrames = 0;
+        budget->underBudgetFrames = 0;
+    }
+
+    if (budget->overBudgetFrames >= config->stepDownFrames && budget->level < config->maxLevel) {
+        return FrameBudgetChangeLevel(budget, budget->level + 1);
+    }
+    if (budget->underBudgetFrames >= config->stepUpFrames && budget->level > FrameBudgetLevelFull) {
+        return FrameBudgetChangeLevel(budget, budget->level - 1);
+    }
+    return false;
+}
+
+bool FrameBudgetReset(FrameBudget *budget) {
+    budget->smoothedCostMs = 0;
+    return FrameBudgetChangeLevel(budget, FrameBudgetLevelFull);
+}
+
+int FrameBudgetDetectInterval(FrameBudgetLevel level, int baseInterval) {
+    return level == FrameBudgetLevelSparseTracking ? baseInterval * 2 : baseInterval;
+}
+
+bool FrameBudgetUsesAsyncTracking(FrameBudgetLevel level) {
+    return level == FrameBudgetLevelSparseTracking;
+}
@@ -0,0 +1,87 @@
+//
+//  FrameBudget.h
+//  quickstart
+//
+//  帧耗时预算控制逻辑：按平滑耗时与迟滞阈值逐档降级/恢复，不依赖任何 SDK，可离线回放耗时序列
+//
+
+#ifndef FrameBudget_h
+#define FrameBudget_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 降级档位，数值越大越省性能
+typedef enum {
+    FrameBudgetLevelFull = 0,               // 完整效果
+    FrameBudgetLevelReducedQuality,         // 降低美颜渲染质量
+    FrameBudgetLevelLowQuality,             // 进一步降低渲染质量，人脸点位使用低质量算法
+    FrameBudgetLevelSparseTracking,         // 在低质量基础上检测间隔加倍，并改为异步跟踪：渲染复用上一次完成的跟踪结果
+} FrameBudgetLevel;
+
+#define FRAME_BUDGET_LEVEL_COUNT 4
+
+/// 降级/恢复策略
+typedef struct {
+    /// 每帧预算（毫秒）
+    double budgetMs;
+    /// 平滑耗时的 EMA 系数 (0, 1]
+    double smoothingFactor;
+    /// 平滑耗时超过 预算 * stepDownRatio 时计为超预算
+    double stepDownRatio;
+    /// 平滑耗时低于 预算 * stepUpRatio 时计为有余量，两个阈值之间为迟滞区间
+    double stepUpRatio;
+    /// 连续超预算多少帧后降一档
+    uint32_t stepDownFrames;
+    /// 连续有余量多少帧后升一档，大于 stepDownFrames 形成时间上的迟滞
+    uint32_t stepUpFrames;
+    /// 最低可降到的档位
+    FrameBudgetLevel maxLevel;
+} FrameBudgetConfig;
+
+/// 默认策略：预算 1000 / frameRate，EMA 0.2，超 90% 连续 15 帧降档，低于 60% 连续 90 帧升档
+FrameBudgetConfig FrameBudgetDefaultConfig(int frameRate);
+
+/// 控制器状态，值类型，不申请内存；非线程安全，只在视频前处理线程中使用
+typedef struct {
+    FrameBudgetConfig config;
+    FrameBudgetLevel level;
+    double smoothedCostMs;
+    /// 连续超预算 / 有余量的帧数
+    uint32_t overBudgetFrames;
+    uint32_t underBudgetFrames;
+    /// 统计
+    uint64_t recordedFrames;
+    uint64_t levelChanges;
+    uint64_t framesAtLevel[FRAME_BUDGET_LEVEL_COUNT];
+} FrameBudget;
+
+/// 初始化为 FrameBudgetLevelFull
+/// @return 配置非法时返回 false
+bool FrameBudgetInit(FrameBudget *budget, const FrameBudgetConfig *config);
+
+/// 记录一帧耗时并更新档位
+/// @param costMs 本帧处理耗时（毫秒）
+/// @return 档位是否变化
+bool FrameBudgetRecord(FrameBudget *budget, double costMs);
+
+/// 回到 FrameBudgetLevelFull 并清空平滑耗时与计数（切换效果后调用，新效果的耗时与旧效果无关）
+/// @return 档位是否变化
+bool FrameBudgetReset(FrameBudget *budget);
+
+/// 档位对应的人脸检测间隔
+/// @param baseInterval 完整效果下的检测间隔（帧）
+int FrameBudgetDetectInterval(FrameBudgetLevel level, int baseInterval);
+
+/// 档位是否使用异步跟踪
+bool FrameBudgetUsesAsyncTracking(FrameBudgetLevel level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FrameBudget_h */
@@ -0,0 +1,72 @@
+//
+//  FrameBudgetGovernor.h
+//  quickstart
+//
+//  帧耗时预算控制
+//
+
+#import <Foundation/Foundation.h>
+#import "FrameBudget.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 降级/恢复策略
+@interface FrameBudgetPolicy : NSObject <NSCopying>
+
+/// 平滑耗时的 EMA 系数 (0, 1]，默认 0.2
+@property (nonatomic, assign) double smoothingFactor;
+/// 平滑耗时超过 预算 * stepDownRatio 时计为超预算，默认 0.9
+@property (nonatomic, assign) double stepDownRatio;
+/// 平滑耗时低于 预算 * stepUpRatio 时计为有余量，默认 0.6
+@property (nonatomic, assign) double stepUpRatio;
+/// 连续超预算多少帧后降一档，默认 15（约 0.5 秒）
+@property (nonatomic, assign) NSUInteger stepDownFrames;
+/// 连续有余量多少帧后升一档，默认 90（约 3 秒），大于 stepDownFrames 形成迟滞
+@property (nonatomic, assign) NSUInteger stepUpFrames;
+/// 最低可降到的档位，默认 FrameBudgetLevelSparseTracking
+@property (nonatomic, assign) FrameBudgetLevel maxLevel;
+
++ (instancetype)defaultPolicy;
+
+@end
+
+/// 根据每帧处理耗时与编码帧率对应的预算，逐档调整效果质量
+/// @note 控制逻辑在 FrameBudget（C）中，不直接调用 SDK，档位变化通过 levelChangedHandler 通知，
+///       可以在 Linux 上用录制的耗时序列回放验证策略（tests/FrameBudgetTests）。非线程安全，只在视频前处理线程中使用。
+@interface FrameBudgetGovernor : NSObject
+
+/// 每帧预算（毫秒）
+@property (nonatomic, assign, readonly) double budgetMs;
+
+@property (nonatomic, copy, readonly) FrameBudgetPolicy *policy;
+
+/// 当前档位
+@property (nonatomic, assign, readonly) FrameBudgetLevel level;
+
+/// 平滑后的每帧耗时（毫秒）
+@property (nonatomic, assign, readonly) double smoothedCostMs;
+
+/// 档位变化回调，在调用 recordFrameCost: 的线程执行
+@property (nonatomic, copy, nullable) void (^levelChangedHandler)(FrameBudgetLevel level);
+
+/// @param frameRate 编码帧率，预算为 1000 / frameRate 毫秒
+- (instancetype)initWithFrameRate:(NSInteger)frameRate policy:(FrameBudgetPolicy *)policy NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)initWithFrameRate:(NSInteger)frameRate;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 记录一帧耗时并更新档位
+/// @param costMs 本帧处理耗时（毫秒）
+/// @return 更新后的档位
+- (FrameBudgetLevel)recordFrameCost:(double)costMs;
+
+/// 回到 FrameBudgetLevelFull 并清空统计（切换效果后调用）
+- (void)reset;
+
+/// 当前累计统计
+- (FrameBudget)snapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,112 @@
+//
+//  FrameBudgetGovernor.m
+//  quickstart
+//
+
+#import "FrameBudgetGovernor.h"
+
+@implementation FrameBudgetPolicy
+
++ (instancetype)defaultPolicy {
+    return [[FrameBudgetPolicy alloc] init];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        FrameBudgetConfig config = FrameBudgetDefaultConfig(30);
+        _smoothingFactor = config.smoothingFactor;
+        _stepDownRatio = config.stepDownRatio;
+        _stepUpRatio = config.stepUpRatio;
+        _stepDownFrames = config.stepDownFrames;
+        _stepUpFrames = config.stepUpFrames;
+        _maxLevel = config.maxLevel;
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    FrameBudgetPolicy *policy = [[FrameBudgetPolicy allocWithZone:zone] init];
+    policy.smoothingFactor = self.smoothingFactor;
+    policy.stepDownRatio = self.stepDownRatio;
+    policy.stepUpRatio = self.stepUpRatio;
+    policy.stepDownFrames = self.stepDownFrames;
+    policy.stepUpFrames = self.stepUpFrames;
+    policy.maxLevel = self.maxLevel;
+    return policy;
+}
+
+@end
+
+@interface FrameBudgetGovernor () {
+    FrameBudget _budget;
+}
+
+@property (nonatomic, copy) FrameBudgetPolicy *policy;
+
+@end
+
+@implementation FrameBudgetGovernor
+
+- (instancetype)initWithFrameRate:(NSInteger)frameRate {
+    return [self initWithFrameRate:frameRate policy:[FrameBudgetPolicy defaultPolicy]];
+}
+
+- (instancetype)initWithFrameRate:(NSInteger)frameRate policy:(FrameBudgetPolicy *)policy {
+    self = [super init];
+    if (self) {
+        _policy = [policy copy];
+        FrameBudgetConfig config = FrameBudgetDefaultConfig((int)frameRate);
+        config.smoothingFactor = policy.smoothingFactor;
+        config.stepDownRatio = policy.stepDownRatio;
+        config.stepUpRatio = policy.stepUpRatio;
+        config.stepDownFrames = (uint32_t)policy.stepDownFrames;
+        config.stepUpFrames = (uint32_t)policy.stepUpFrames;
+        config.maxLevel = (FrameBudgetLevel)policy.maxLevel;
+        if (!FrameBudgetInit(&_budget, &config)) {
+            NSLog(@"FrameBudgetGovernor invalid policy, using default");
+            config = FrameBudgetDefaultConfig((int)frameRate);
+            FrameBudgetInit(&_budget, &config);
+        }
+    }
+    return self;
+}
+
+- (double)budgetMs {
+    return _budget.config.budgetMs;
+}
+
+- (FrameBudgetLevel)level {
+    return _budget.level;
+}
+
+- (double)smoothedCostMs {
+    return _budget.smoothedCostMs;
+}
+
+- (FrameBudgetLevel)recordFrameCost:(double)costMs {
+    if (FrameBudgetRecord(&_budget, costMs)) {
+        [self notifyLevelChanged];
+    }
+    return _budget.level;
+}
+
+- (void)reset {
+    if (FrameBudgetReset(&_budget)) {
+        [self notifyLevelChanged];
+    }
+}
+
+- (FrameBudget)snapshot {
+    return _budget;
+}
+
+#pragma mark - Private methods
+
+- (void)notifyLevelChanged {
+    if (self.levelChangedHandler) {
+        self.levelChangedHandler(_budget.level);
+    }
+}
+
+@end
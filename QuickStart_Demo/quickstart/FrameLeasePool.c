@@ -0,0 +1,227 @@
+//
+//  FrameLeasePool.c
+//  quickstart
+//
+
+#include "FrameLeasePool.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_LEASE_POOL_CACHE_LINE 64
+
+/// 记录出现过的 buffer 的上限，渲染器的 buffer 池远小于该值
+#define FRAME_LEASE_POOL_MAX_SEEN 64
+
+struct FrameLeasePool {
+    /// 处理线程写的字段
+    _Alignas(FRAME_LEASE_POOL_CACHE_LINE) _Atomic uint64_t leasedFrames;
+    _Atomic uint64_t exhaustedFrames;
+    _Atomic uint64_t reusedBuffers;
+    _Atomic uint64_t distinctBuffers;
+    _Atomic uint64_t probedFrames;
+    _Atomic uint32_t peakInFlight;
+
+    /// 归还线程写的字段，可能有多个归还线程
+    _Alignas(FRAME_LEASE_POOL_CACHE_LINE) _Atomic uint64_t returnedFrames;
+    /// 1（租借表本身）+ 租借中的帧数，归零时释放内存
+    _Atomic uint32_t references;
+
+    /// 租借位，NULL 表示空闲；处理线程只做 NULL -> buffer，归还线程只做 buffer -> NULL
+    _Alignas(FRAME_LEASE_POOL_CACHE_LINE) _Atomic(void *) slots[FRAME_LEASE_POOL_MAX_CAPACITY];
+
+    /// 以下只由处理线程访问
+    void *seen[FRAME_LEASE_POOL_MAX_SEEN];
+    uint32_t seenCount;
+    /// 校验渲染器时私下持有的输出 buffer
+    void *probed[FRAME_LEASE_POOL_MAX_CAPACITY];
+    uint32_t probedCount;
+    /// 渲染器在持有 capacity 块 buffer 时仍交出新 buffer，零拷贝可用
+    bool verified;
+    /// 渲染器复用了仍被引用的 buffer，零拷贝不可用
+    bool disabled;
+
+    /// 创建后只读
+    uint32_t capacity;
+    FrameLeasePoolDeleter deleter;
+    void *context;
+};
+
+FrameLeasePool *FrameLeasePoolCreate(uint32_t capacity, FrameLeasePoolDeleter deleter, void *context) {
+    if (capacity == 0 || capacity > FRAME_LEASE_POOL_MAX_CAPACITY || !deleter) {
+        return NULL;
+    }
+    void *memory = NULL;
+    if (posix_memalign(&memory, FRAME_LEASE_POOL_CACHE_LINE, sizeof(FrameLeasePool)) != 0) {
+        return NULL;
+    }
+    FrameLeasePool *pool = memory;
+    memset(pool, 0, sizeof(FrameLeasePool));
+    for (uint32_t i = 0; i < FRAME_LEASE_POOL_MAX_CAPACITY; i++) {
+        atomic_init(&pool->slots[i], NULL);
+    }
+    atomic_init(&pool->references, 1);
+    pool->capacity = capacity;
+    pool->deleter = deleter;
+    pool->context = context;
+    return pool;
+}
+
+static void FrameLeasePoolRelease(FrameLeasePool *pool) {
+    if (atomic_fetch_sub_explicit(&pool->references, 1, memory_order_acq_rel) == 1) {
+        free(pool);
+    }
+}
+
+/// 释放校验时持有的 buffer
+static void FrameLeasePoolReleaseProbed(FrameLeasePool *pool) {
+    for (uint32_t i = 0; i < pool->probedCount; i++) {
+        pool->deleter(pool->context, pool->probed[i]);
+    }
+    pool->probedCount = 0;
+}
+
+void FrameLeasePoolDestroy(FrameLeasePool *pool) {
+    if (!pool) {
+        return;
+    }
+    FrameLeasePoolReleaseProbed(pool);
+    FrameLeasePoolRelease(pool);
+}
+
+static inline void FrameLeasePoolCounterAdd(_Atomic uint64_t *counter) {
+    // 处理线程独占写的计数器，无需 RMW
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+bool FrameLeasePoolHasFreeLease(const FrameLeasePool *pool) {
+    for (uint32_t i = 0; i < pool->capacity; i++) {
+        if (!atomic_load_explicit(&pool->slots[i], memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+FrameLeaseTarget FrameLeasePoolBeginFrame(FrameLeasePool *pool) {
+    if (pool->disabled) {
+        return FrameLeaseTargetInPlace;
+    }
+    if (!pool->verified) {
+        return FrameLeaseTargetProbe;
+    }
+    if (!FrameLeasePoolHasFreeLease(pool)) {
+        FrameLeasePoolCounterAdd(&pool->exhaustedFrames);
+        return FrameLeaseTargetInPlace;
+    }
+    return FrameLeaseTargetLease;
+}
+
+void FrameLeasePoolProbe(FrameLeasePool *pool, void *buffer) {
+    FrameLeasePoolCounterAdd(&pool->probedFrames);
+    if (!buffer) {
+        return;
+    }
+    if (pool->verified || pool->disabled) {
+        pool->deleter(pool->context, buffer);
+        return;
+    }
+    bool reused = false;
+    for (uint32_t i = 0; i < pool->probedCount; i++) {
+        reused |= pool->probed[i] == buffer;
+    }
+    if (reused || pool->probedCount == pool->capacity) {
+        // 复用了仍被持有的 buffer：零拷贝会改写 SDK 正在读的画面；否则渲染器按引用轮换 buffer，校验通过
+        pool->disabled = reused;
+        pool->verified = !reused;
+        pool->deleter(pool->context, buffer);
+        FrameLeasePoolReleaseProbed(pool);
+        return;
+    }
+    pool->probed[pool->probedCount++] = buffer;
+}
+
+bool FrameLeasePoolZeroCopyAvailable(const FrameLeasePool *pool) {
+    return !pool->disabled;
+}
+
+/// 记录出现过的 buffer，新 buffer 计入 distinctBuffers
+static void FrameLeasePoolTrackDistinct(FrameLeasePool *pool, void *buffer) {
+    for (uint32_t i = 0; i < pool->seenCount; i++) {
+        if (pool->seen[i] == buffer) {
+            return;
+        }
+    }
+    if (pool->seenCount < FRAME_LEASE_POOL_MAX_SEEN) {
+        pool->seen[pool->seenCount++] = buffer;
+    }
+    FrameLeasePoolCounterAdd(&pool->distinctBuffers);
+}
+
+int32_t FrameLeasePoolLease(FrameLeasePool *pool, void *buffer) {
+    if (!buffer) {
+        return -1;
+    }
+    int32_t freeSlot = -1;
+    for (uint32_t i = 0; i < pool->capacity; i++) {
+        void *leased = atomic_load_explicit(&pool->slots[i], memory_order_acquire);
+        if (leased == buffer) {
+            // SDK 还在读这块 buffer，渲染器却已写入新一帧
+            FrameLeasePoolCounterAdd(&pool->reusedBuffers);
+            pool->disabled = true;
+            return -1;
+        }
+        if (!leased && freeSlot < 0) {
+            freeSlot = (int32_t)i;
+        }
+    }
+    if (freeSlot < 0) {
+        FrameLeasePoolCounterAdd(&pool->exhaustedFrames);
+        return -1;
+    }
+    FrameLeasePoolTrackDistinct(pool, buffer);
+    atomic_fetch_add_explicit(&pool->references, 1, memory_order_relaxed);
+    atomic_store_explicit(&pool->slots[freeSlot], buffer, memory_order_release);
+    FrameLeasePoolCounterAdd(&pool->leasedFrames);
+
+    uint64_t leased = atomic_load_explicit(&pool->leasedFrames, memory_order_relaxed);
+    uint64_t returned = atomic_load_explicit(&pool->returnedFrames, memory_order_relaxed);
+    uint32_t inFlight = (uint32_t)(leased - returned);
+    if (inFlight > atomic_load_explicit(&pool->peakInFlight, memory_order_relaxed)) {
+        atomic_store_explicit(&pool->peakInFlight, inFlight, memory_order_relaxed);
+    }
+    return freeSlot;
+}
+
+void FrameLeasePoolReturn(FrameLeasePool *pool, int32_t lease) {
+    if (!pool || lease < 0 || (uint32_t)lease >= pool->capacity) {
+        return;
+    }
+    void *buffer = atomic_exchange_explicit(&pool->slots[lease], NULL, memory_order_acq_rel);
+    if (!buffer) {
+        return;
+    }
+    // 先腾出租借位再释放引用：buffer 回到渲染器后可能立刻被复用，此时不应再被视为租借中
+    pool->deleter(pool->context, buffer);
+    atomic_fetch_add_explicit(&pool->returnedFrames, 1, memory_order_relaxed);
+    FrameLeasePoolRelease(pool);
+}
+
+void FrameLeasePoolResetDistinct(FrameLeasePool *pool) {
+    pool->seenCount = 0;
+    FrameLeasePoolReleaseProbed(pool);
+    pool->verified = false;
+    pool->disabled = false;
+}
+
+void FrameLeasePoolGetStats(const FrameLeasePool *pool, FrameLeasePoolStats *stats) {
+    stats->leasedFrames = atomic_load_explicit(&pool->leasedFrames, memory_order_relaxed);
+    stats->returnedFrames = atomic_load_explicit(&pool->returnedFrames, memory_order_relaxed);
+    stats->exhaustedFrames = atomic_load_explicit(&pool->exhaustedFrames, memory_order_relaxed);
+    stats->reusedBuffers = atomic_load_explicit(&pool->reusedBuffers, memory_order_relaxed);
+    stats->distinctBuffers = atomic_load_explicit(&pool->distinctBuffers, memory_order_relaxed);
+    stats->probedFrames = atomic_load_explicit(&pool->probedFrames, memory_order_relaxed);
+    stats->inFlight = stats->leasedFrames > stats->returnedFrames ? (uint32_t)(stats->leasedFrames - stats->returnedFrames) : 0;
+    stats->peakInFlight = atomic_load_explicit(&pool->peakInFlight, memory_order_relaxed);
+}
@@ -0,0 +1,90 @@
+//
+//  FrameLeasePool.h
+//  quickstart
+//
+//  零拷贝输出帧的 buffer 租借表：交给 SDK 的 buffer 在 SDK 释放帧之前一直持有引用
+//
+
+#ifndef FrameLeasePool_h
+#define FrameLeasePool_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 最多同时租借的帧数
+#define FRAME_LEASE_POOL_MAX_CAPACITY 16
+
+/// 归还时释放调用方对 buffer 的引用（对应 VideoFrameBuilder 的 memory_deleter），在归还线程执行
+typedef void (*FrameLeasePoolDeleter)(void *context, void *buffer);
+
+/// 计数器，可在任意线程读取
+typedef struct {
+    uint64_t leasedFrames;          // 租借成功的帧数
+    uint64_t returnedFrames;        // SDK 释放帧后归还的帧数
+    uint64_t exhaustedFrames;       // 租借数已达容量、调用方回退处理的帧数
+    uint64_t reusedBuffers;         // buffer 仍在租借中又被交来的次数（渲染器复用了 SDK 还持有的 buffer）
+    uint64_t distinctBuffers;       // 出现过的不同 buffer 数，即渲染器分配次数，稳定后不再增长
+    uint64_t probedFrames;          // 校验渲染器时原地渲染的帧数
+    uint32_t inFlight;              // 当前租借中的帧数
+    uint32_t peakInFlight;          // 租借中帧数的峰值
+} FrameLeasePoolStats;
+
+/// 渲染前决定的本帧输出方式
+typedef enum {
+    FrameLeaseTargetInPlace = 0,    // 在采集帧上原地渲染
+    FrameLeaseTargetProbe,          // 在采集帧上原地渲染，渲染器的输出 buffer 交给 FrameLeasePoolProbe 校验
+    FrameLeaseTargetLease,          // 零拷贝：渲染器的输出 buffer 交给 FrameLeasePoolLease，租借位已确认空闲
+} FrameLeaseTarget;
+
+typedef struct FrameLeasePool FrameLeasePool;
+
+/// 创建租借表，所有内存在此分配
+/// @param capacity 最多同时租借的帧数，1 ~ FRAME_LEASE_POOL_MAX_CAPACITY
+/// @param deleter 归还时调用，不能为 NULL
+/// @return 参数非法时返回 NULL
+FrameLeasePool *FrameLeasePoolCreate(uint32_t capacity, FrameLeasePoolDeleter deleter, void *context);
+
+/// 销毁租借表，只在处理线程调用
+/// @note 仍在租借中的 buffer 归还时照常调用 deleter，最后一次归还后才释放内存
+void FrameLeasePoolDestroy(FrameLeasePool *pool);
+
+/// 是否还有空闲的租借位，只在处理线程调用
+bool FrameLeasePoolHasFreeLease(const FrameLeasePool *pool);
+
+/// 渲染前决定本帧的输出方式，只在处理线程调用
+/// @note 零拷贝要求渲染器不复用仍被引用的 buffer。校验通过之前返回 FrameLeaseTargetProbe：输出不交给 SDK，
+///       由租借表私下持有渲染器的输出 buffer，持有 capacity 块时渲染器仍交出新的 buffer 才算通过；
+///       校验失败或租借时发现复用后只返回 FrameLeaseTargetInPlace，直到 FrameLeasePoolResetDistinct。
+///       租借位只有处理线程会占用，这里确认空闲后本帧租借不会因租借数已满而失败
+FrameLeaseTarget FrameLeasePoolBeginFrame(FrameLeasePool *pool);
+
+/// 校验帧渲染后交来渲染器的输出 buffer，调用方已为其增加一次引用，由租借表在校验结束时通过 deleter 释放
+/// @param buffer 渲染器的输出 buffer，没有输出时传 NULL（只计数）
+void FrameLeasePoolProbe(FrameLeasePool *pool, void *buffer);
+
+/// 零拷贝是否仍可能使用（校验中或已通过），只在处理线程调用
+bool FrameLeasePoolZeroCopyAvailable(const FrameLeasePool *pool);
+
+/// 租借 buffer，只在处理线程调用，无等待、无内存分配
+/// @return 租借编号；租借数已满或 buffer 仍在租借中时返回 -1，此时租借表不接管 buffer；
+///         buffer 仍在租借中说明渲染器复用了 SDK 持有的 buffer，之后不再零拷贝
+int32_t FrameLeasePoolLease(FrameLeasePool *pool, void *buffer);
+
+/// 归还租借并调用 deleter，可在任意线程调用（通常是 SDK 释放帧的线程），无等待
+void FrameLeasePoolReturn(FrameLeasePool *pool, int32_t lease);
+
+/// 清空出现过的 buffer 记录并重新校验渲染器（尺寸变化或切后台后 buffer 会重新分配），只在处理线程调用
+void FrameLeasePoolResetDistinct(FrameLeasePool *pool);
+
+/// 读取计数器，各项分别原子读取，彼此之间不保证是同一时刻的值
+void FrameLeasePoolGetStats(const FrameLeasePool *pool, FrameLeasePoolStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FrameLeasePool_h */
@@ -0,0 +1,359 @@
+//
+//  GridCompositor.c
+//  quickstart
+//
+
+#include "GridCompositor.h"
+#include "LumaDownscaler.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#include <arm_neon.h>
+#define GRID_COMPOSITOR_NEON 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define GRID_COMPOSITOR_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GRID_COMPOSITOR_SSE2 1
+#endif
+
+/// 行缓冲区尾部留出的余量，水平插值读取 x + 1 时不越界
+#define GRID_COMPOSITOR_ROW_PADDING 32
+
+struct GridCompositor {
+    int maxSourceWidth;
+    _Atomic bool scalarOnly;
+    /// 垂直插值后的一行源数据
+    uint8_t *row;
+};
+
+GridCompositor *GridCompositorCreate(int maxSourceWidth) {
+    if (maxSourceWidth < 2) {
+        return NULL;
+    }
+    GridCompositor *compositor = calloc(1, sizeof(GridCompositor));
+    if (!compositor) {
+        return NULL;
+    }
+    compositor->maxSourceWidth = maxSourceWidth;
+    atomic_init(&compositor->scalarOnly, false);
+    compositor->row = malloc((size_t)maxSourceWidth + GRID_COMPOSITOR_ROW_PADDING);
+    if (!compositor->row) {
+        GridCompositorDestroy(compositor);
+        return NULL;
+    }
+    return compositor;
+}
+
+void GridCompositorDestroy(GridCompositor *compositor) {
+    if (!compositor) {
+        return;
+    }
+    free(compositor->row);
+    free(compositor);
+}
+
+void GridCompositorSetScalarOnly(GridCompositor *compositor, bool scalarOnly) {
+    atomic_store_explicit(&compositor->scalarOnly, scalarOnly, memory_order_relaxed);
+}
+
+// 区域
+
+/// 取子区域，x、y、width、height 均为偶数
+static GridI420Image GridSubImage(const GridI420Image *image, int x, int y, int width, int height) {
+    GridI420Image sub = *image;
+    sub.y = image->y + (size_t)y * image->yStride + x;
+    sub.u = image->u + (size_t)(y / 2) * image->uStride + x / 2;
+    sub.v = image->v + (size_t)(y / 2) * image->vStride + x / 2;
+    sub.width = width;
+    sub.height = height;
+    return sub;
+}
+
+GridI420Image GridCompositorTile(const GridI420Image *canvas, int columns, int rows, int index) {
+    int column = index % columns;
+    int row = index / columns;
+    int x0 = (canvas->width * column / columns) & ~1;
+    int x1 = column + 1 == columns ? canvas->width : (canvas->width * (column + 1) / columns) & ~1;
+    int y0 = (canvas->height * row / rows) & ~1;
+    int y1 = row + 1 == rows ? canvas->height : (canvas->height * (row + 1) / rows) & ~1;
+    return GridSubImage(canvas, x0, y0, (x1 - x0) & ~1, (y1 - y0) & ~1);
+}
+
+static void GridFillPlane(uint8_t *plane, size_t stride, int width, int height, uint8_t value) {
+    for (int y = 0; y < height; y++) {
+        memset(plane + (size_t)y * stride, value, (size_t)width);
+    }
+}
+
+void GridCompositorFillBlack(const GridI420Image *region) {
+    if (region->width <= 0 || region->height <= 0) {
+        return;
+    }
+    GridFillPlane(region->y, region->yStride, region->width, region->height, 16);
+    GridFillPlane(region->u, region->uStride, region->width / 2, region->height / 2, 128);
+    GridFillPlane(region->v, region->vStride, region->width / 2, region->height / 2, 128);
+}
+
+// 垂直插值，dst = (row0 × (256 - fraction) + row1 × fraction + 128) >> 8
+
+static void GridInterpolateRow_C(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, int width, int fraction) {
+    int weight0 = 256 - fraction;
+    for (int i = 0; i < width; i++) {
+        dst[i] = (uint8_t)((row0[i] * weight0 + row1[i] * fraction + 128) >> 8);
+    }
+}
+
+/// fraction 为 1...255
+static void GridInterpolateRow(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, int width, int fraction) {
+    int i = 0;
+#if GRID_COMPOSITOR_NEON
+    uint8x8_t weight0 = vdup_n_u8((uint8_t)(256 - fraction));
+    uint8x8_t weight1 = vdup_n_u8((uint8_t)fraction);
+    for (; i + 16 <= width; i += 16) {
+        uint8x16_t a = vld1q_u8(row0 + i);
+        uint8x16_t b = vld1q_u8(row1 + i);
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), weight0), vget_low_u8(b), weight1);
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), weight0), vget_high_u8(b), weight1);
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+#elif GRID_COMPOSITOR_AVX2
+    __m256i zero = _mm256_setzero_si256();
+    __m256i weight0 = _mm256_set1_epi16((short)(256 - fraction));
+    __m256i weight1 = _mm256_set1_epi16((short)fraction);
+    __m256i round = _mm256_set1_epi16(128);
+    for (; i + 32 <= width; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(row0 + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(row1 + i));
+        // unpack 与 packus 都按 128 位通道处理，顺序保持不变
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), weight0),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), weight1));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), weight0),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), weight1));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 8);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+#elif GRID_COMPOSITOR_SSE2
+    __m128i zero = _mm_setzero_si128();
+    __m128i weight0 = _mm_set1_epi16((short)(256 - fraction));
+    __m128i weight1 = _mm_set1_epi16((short)fraction);
+    __m128i round = _mm_set1_epi16(128);
+    for (; i + 16 <= width; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(row0 + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(row1 + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), weight0),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), weight1));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), weight0),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), weight1));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    GridInterpolateRow_C(dst + i, row0 + i, row1 + i, width - i, fraction);
+}
+
+// 缩放
+
+/// 水平插值，x 为 16.16 定点坐标，最后一个源像素由行缓冲区尾部复制一份，x + 1 不越界
+static void GridScaleRow(uint8_t *dst, int dstWidth, const uint8_t *row, int64_t x, int64_t dx) {
+    for (int i = 0; i < dstWidth; i++, x += dx) {
+        int64_t clamped = x < 0 ? 0 : x;
+        int index = (int)(clamped >> 16);
+        int fraction = (int)((clamped >> 8) & 0xff);
+        dst[i] = (uint8_t)((row[index] * (256 - fraction) + row[index + 1] * fraction + 128) >> 8);
+    }
+}
+
+/// 中心对齐的起始坐标与步长（16.16 定点）
+static void GridScaleStep(int srcSize, int dstSize, int64_t *start, int64_t *step) {
+    *step = ((int64_t)srcSize << 16) / dstSize;
+    *start = *step / 2 - 32768;
+}
+
+/// 双线性缩放一个平面：先垂直插值出一行，再水平插值
+static void GridScalePlane(GridCompositor *compositor, const uint8_t *src, size_t srcStride, int srcWidth,
+                           int srcHeight, uint8_t *dst, size_t dstStride, int dstWidth, int dstHeight, bool simd) {
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        for (int y = 0; y < dstHeight; y++) {
+            memcpy(dst + (size_t)y * dstStride, src + (size_t)y * srcStride, (size_t)dstWidth);
+        }
+        return;
+    }
+    // 格子正好是源图一半时（如 720x1280 画布上显示 720x1280 的远端画面）走 2x2 box 降采样
+    if (srcWidth == dstWidth * 2 && srcHeight == dstHeight * 2) {
+        if (simd) {
+            LumaDownscaleHalf(src, srcStride, (size_t)srcWidth, (size_t)srcHeight, dst, dstStride);
+        } else {
+            LumaDownscaleHalf_C(src, srcStride, (size_t)srcWidth, (size_t)srcHeight, dst, dstStride);
+        }
+        return;
+    }
+    int64_t x0, dx, y, dy;
+    GridScaleStep(srcWidth, dstWidth, &x0, &dx);
+    GridScaleStep(srcHeight, dstHeight, &y, &dy);
+    int64_t maxY = (int64_t)(srcHeight - 1) << 16;
+    uint8_t *row = compositor->row;
+    for (int i = 0; i < dstHeight; i++, y += dy) {
+        int64_t clamped = y < 0 ? 0 : (y > maxY ? maxY : y);
+        int index = (int)(clamped >> 16);
+        int fraction = (int)((clamped >> 8) & 0xff);
+        const uint8_t *row0 = src + (size_t)index * srcStride;
+        if (fraction == 0) {
+            memcpy(row, row0, (size_t)srcWidth);
+        } else if (simd) {
+            GridInterpolateRow(row, row0, row0 + srcStride, srcWidth, fraction);
+        } else {
+            GridInterpolateRow_C(row, row0, row0 + srcStride, srcWidth, fraction);
+        }
+        row[srcWidth] = row[srcWidth - 1];
+        GridScaleRow(dst + (size_t)i * dstStride, dstWidth, row, x0, dx);
+    }
+}
+
+static void GridScaleImage(GridCompositor *compositor, const GridI420Image *src, const GridI420Image *dst, bool simd) {
+    GridScalePlane(compositor, src->y, src->yStride, src->width, src->height,
+                   dst->y, dst->yStride, dst->width, dst->height, simd);
+    GridScalePlane(compositor, src->u, src->uStride, src->width / 2, src->height / 2,
+                   dst->u, dst->uStride, dst->width / 2, dst->height / 2, simd);
+    GridScalePlane(compositor, src->v, src->vStride, src->width / 2, src->height / 2,
+                   dst->v, dst->vStride, dst->width / 2, dst->height / 2, simd);
+}
+
+bool GridCompositorDrawTile(GridCompositor *compositor, const GridI420Image *source, const GridI420Image *tile,
+                            GridScaleMode mode) {
+    int srcWidth = source->width & ~1;
+    int srcHeight = source->height & ~1;
+    if (srcWidth < 2 || srcHeight < 2 || srcWidth > compositor->maxSourceWidth || tile->width < 2 ||
+        tile->height < 2) {
+        return false;
+    }
+    bool simd = !atomic_load_explicit(&compositor->scalarOnly, memory_order_relaxed);
+    // 源图比格子更宽时以高度为准
+    bool sourceWider = (int64_t)srcWidth * tile->height > (int64_t)tile->width * srcHeight;
+    if (mode == GridScaleModeHidden) {
+        int cropWidth = srcWidth, cropHeight = srcHeight;
+        if (sourceWider) {
+            cropWidth = (int)((int64_t)srcHeight * tile->width / tile->height) & ~1;
+        } else {
+            cropHeight = (int)((int64_t)srcWidth * tile->height / tile->width) & ~1;
+        }
+        if (cropWidth < 2 || cropHeight < 2) {
+            return false;
+        }
+        GridI420Image crop = GridSubImage(source, ((srcWidth - cropWidth) / 2) & ~1,
+                                          ((srcHeight - cropHeight) / 2) & ~1, cropWidth, cropHeight);
+        GridScaleImage(compositor, &crop, tile, simd);
+        return true;
+    }
+
+    int innerWidth = tile->width, innerHeight = tile->height;
+    if (sourceWider) {
+        innerHeight = (int)((int64_t)tile->width * srcHeight / srcWidth) & ~1;
+    } else {
+        innerWidth = (int)((int64_t)tile->height * srcWidth / srcHeight) & ~1;
+    }
+    if (innerWidth < 2 || innerHeight < 2) {
+        return false;
+    }
+    int offsetX = ((tile->width - innerWidth) / 2) & ~1;
+    int offsetY = ((tile->height - innerHeight) / 2) & ~1;
+    // 只填黑边，不重复写画面区域
+    GridI420Image bars[2];
+    if (sourceWider) {
+        bars[0] = GridSubImage(tile, 0, 0, tile->width, offsetY);
+        bars[1] = GridSubImage(tile, 0, offsetY + innerHeight, tile->width, tile->height - offsetY - innerHeight);
+    } else {
+        bars[0] = GridSubImage(tile, 0, 0, offsetX, tile->height);
+        bars[1] = GridSubImage(tile, offsetX + innerWidth, 0, tile->width - offsetX - innerWidth, tile->height);
+    }
+    GridCompositorFillBlack(&bars[0]);
+    GridCompositorFillBlack(&bars[1]);
+    GridI420Image inner = GridSubImage(tile, offsetX, offsetY, innerWidth, innerHeight);
+    GridI420Image whole = GridSubImage(source, 0, 0, srcWidth, srcHeight);
+    GridScaleImage(compositor, &whole, &inner, simd);
+    return true;
+}
+
+int GridCompositorCompose(GridCompositor *compositor, const GridI420Image *const *sources, const GridI420Image *canvas,
+                          int columns, int rows, GridScaleMode mode) {
+    int drawn = 0;
+    for (int i = 0; i < columns * rows; i++) {
+        GridI420Image tile = GridCompositorTile(canvas, columns, rows, i);
+        if (sources[i] && GridCompositorDrawTile(compositor, sources[i], &tile, mode)) {
+            drawn++;
+        } else {
+            GridCompositorFillBlack(&tile);
+        }
+    }
+    return drawn;
+}
+
+// 基准测试
+
+static uint64_t GridCompositorNowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/// 在一块连续内存上布局 I420 图像
+static GridI420Image GridImageWithBuffer(uint8_t *buffer, int width, int height) {
+    size_t ySize = (size_t)width * height;
+    GridI420Image image = {
+        .y = buffer,
+        .u = buffer + ySize,
+        .v = buffer + ySize + ySize / 4,
+        .yStride = (size_t)width,
+        .uStride = (size_t)width / 2,
+        .vStride = (size_t)width / 2,
+        .width = width,
+        .height = height,
+    };
+    return image;
+}
+
+double GridCompositorBenchmark(GridCompositor *compositor, int outputWidth, int outputHeight, int sourceWidth,
+                               int sourceHeight, int activeTiles, size_t iterations) {
+    if (!compositor || iterations == 0) {
+        return 0;
+    }
+    outputWidth &= ~1;
+    outputHeight &= ~1;
+    sourceWidth &= ~1;
+    sourceHeight &= ~1;
+    uint8_t *canvasBuffer = malloc((size_t)outputWidth * outputHeight * 3 / 2);
+    uint8_t *sourceBuffer = malloc((size_t)sourceWidth * sourceHeight * 3 / 2);
+    if (!canvasBuffer || !sourceBuffer) {
+        free(canvasBuffer);
+        free(sourceBuffer);
+        return 0;
+    }
+    GridI420Image canvas = GridImageWithBuffer(canvasBuffer, outputWidth, outputHeight);
+    GridI420Image source = GridImageWithBuffer(sourceBuffer, sourceWidth, sourceHeight);
+    for (int y = 0; y < sourceHeight; y++) {
+        for (int x = 0; x < sourceWidth; x++) {
+            source.y[(size_t)y * source.yStride + x] = (uint8_t)(x + y);
+        }
+    }
+    memset(source.u, 96, (size_t)sourceWidth * sourceHeight / 2);
+    const GridI420Image *sources[4] = {NULL, NULL, NULL, NULL};
+    for (int i = 0; i < activeTiles && i < 4; i++) {
+        sources[i] = &source;
+    }
+    GridCompositorCompose(compositor, sources, &canvas, 2, 2, GridScaleModeHidden);
+    uint64_t start = GridCompositorNowNs();
+    for (size_t i = 0; i < iterations; i++) {
+        GridCompositorCompose(compositor, sources, &canvas, 2, 2, GridScaleModeHidden);
+    }
+    uint64_t elapsed = GridCompositorNowNs() - start;
+    free(canvasBuffer);
+    free(sourceBuffer);
+    return (double)elapsed / (double)iterations;
+}
@@ -0,0 +1,77 @@
+//
+//  GridCompositor.h
+//  quickstart
+//
+//  I420 多路画面网格合成（缩放 + 裁剪/留黑边）
+//
+
+#ifndef GridCompositor_h
+#define GridCompositor_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// I420 图像或其中一块区域，宽高为偶数
+typedef struct {
+    uint8_t *y;
+    uint8_t *u;
+    uint8_t *v;
+    size_t yStride;
+    size_t uStride;
+    size_t vStride;
+    int width;
+    int height;
+} GridI420Image;
+
+typedef enum {
+    /// 等比缩放铺满格子，居中裁掉多余部分（与 ByteRTCRenderModeHidden 一致）
+    GridScaleModeHidden = 0,
+    /// 等比缩放完整显示，空余部分填黑（与 ByteRTCRenderModeFit 一致）
+    GridScaleModeFit,
+} GridScaleMode;
+
+typedef struct GridCompositor GridCompositor;
+
+/// 所有内存在此分配，合成时不再分配内存
+/// @param maxSourceWidth 支持的最大源图宽度，更宽的源图不绘制
+GridCompositor *GridCompositorCreate(int maxSourceWidth);
+
+void GridCompositorDestroy(GridCompositor *compositor);
+
+/// 只使用标量实现，用于校验与对比 SIMD 实现，默认 false
+void GridCompositorSetScalarOnly(GridCompositor *compositor, bool scalarOnly);
+
+/// 画布按 columns × rows 均分后第 index 格（行优先）的区域，格子位置与宽高对齐到偶数
+GridI420Image GridCompositorTile(const GridI420Image *canvas, int columns, int rows, int index);
+
+/// 将区域填成黑色（Y = 16，U = V = 128）
+void GridCompositorFillBlack(const GridI420Image *region);
+
+/// 双线性缩放源图到目标区域
+/// @note 垂直插值根据编译目标选择 NEON / AVX2 / SSE2 实现，与标量实现逐字节一致
+/// @return 源图宽度超过 maxSourceWidth 或尺寸非法时返回 false，目标区域不变
+bool GridCompositorDrawTile(GridCompositor *compositor, const GridI420Image *source, const GridI420Image *tile,
+                            GridScaleMode mode);
+
+/// 合成整张网格：sources[i] 绘制到第 i 格，为 NULL 的格子填黑
+/// @note 耗时与有画面的格子数成正比
+/// @return 成功绘制的格子数
+int GridCompositorCompose(GridCompositor *compositor, const GridI420Image *const *sources, const GridI420Image *canvas,
+                          int columns, int rows, GridScaleMode mode);
+
+/// 用合成画面测量 2x2 网格中 activeTiles 格有画面时合成一帧的平均耗时
+/// @note 会改变内部状态，不要对正在使用的合成器调用
+/// @return 每帧纳秒数，内存不足时返回 0
+double GridCompositorBenchmark(GridCompositor *compositor, int outputWidth, int outputHeight, int sourceWidth,
+                               int sourceHeight, int activeTiles, size_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GridCompositor_h */
@@ -0,0 +1,408 @@
+//
+//  JpegEncoder.c
+//  quickstart
+//
+
+#include "JpegEncoder.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// 文件头（SOI、APP0、DQT、SOF0、DHT、SOS）与 EOI 的字节数上限
+#define JPEG_ENCODER_HEADER_BYTES 1024
+
+// Tables (ITU-T T.81 Annex K)
+
+/// 自然顺序下标对应的 zigzag 位置
+static const uint8_t JpegZigzag[64] = {
+    0,  1,  5,  6,  14, 15, 27, 28, 2,  4,  7,  13, 16, 26, 29, 42, 3,  8,  12, 17, 25, 30,
+    41, 43, 9,  11, 18, 24, 31, 40, 44, 53, 10, 19, 23, 32, 39, 45, 52, 54, 20, 22, 33, 38,
+    46, 51, 55, 60, 21, 34, 37, 47, 50, 56, 59, 61, 35, 36, 48, 49, 57, 58, 62, 63,
+};
+
+static const uint8_t JpegLumaQuant[64] = {
+    16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99,
+};
+
+static const uint8_t JpegChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99, 24, 26, 56, 99, 99, 99,
+    99, 99, 47, 66, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+static const uint8_t JpegDcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t JpegDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+static const uint8_t JpegDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+static const uint8_t JpegAcLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+static const uint8_t JpegAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71,
+    0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72,
+    0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83,
+    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3,
+    0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa,
+};
+
+static const uint8_t JpegAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+static const uint8_t JpegAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22,
+    0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0, 0x15, 0x62, 0x72, 0xd1,
+    0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36,
+    0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a,
+    0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a,
+    0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba,
+    0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa,
+};
+
+/// AAN 浮点 DCT 的行列缩放系数
+static const float JpegAanScale[8] = {
+    1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f,
+};
+
+typedef struct {
+    uint16_t code;
+    uint8_t length;
+} JpegHuffmanCode;
+
+/// 0 为亮度，1 为色度
+typedef struct {
+    uint8_t quant[64];                  // 自然顺序
+    float divisors[64];                 // 含 AAN 缩放的量化除数倒数，自然顺序
+    JpegHuffmanCode dc[12];
+    JpegHuffmanCode ac[256];
+} JpegComponentTables;
+
+struct JpegEncoder {
+    JpegComponentTables tables[2];
+    /// 像素值到减去 128 后的电平：[videoRange][亮度/色度][像素值]
+    float levels[2][2][256];
+};
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    uint32_t bits;
+    int bitCount;
+    bool overflow;
+} JpegWriter;
+
+// Setup
+
+static void JpegBuildHuffman(const uint8_t bits[16], const uint8_t *values, JpegHuffmanCode *codes) {
+    uint16_t code = 0;
+    size_t k = 0;
+    for (int length = 1; length <= 16; length++) {
+        for (int i = 0; i < bits[length - 1]; i++) {
+            codes[values[k]].code = code;
+            codes[values[k]].length = (uint8_t)length;
+            code++;
+            k++;
+        }
+        code <<= 1;
+    }
+}
+
+static void JpegBuildQuant(const uint8_t *base, int quality, JpegComponentTables *tables) {
+    int scale = quality < 50 ? 5000 / quality : 200 - 2 * quality;
+    for (int i = 0; i < 64; i++) {
+        int q = (base[i] * scale + 50) / 100;
+        tables->quant[i] = (uint8_t)(q < 1 ? 1 : q > 255 ? 255 : q);
+        tables->divisors[i] = 1.0f / ((float)tables->quant[i] * JpegAanScale[i / 8] * JpegAanScale[i % 8] * 8.0f);
+    }
+}
+
+JpegEncoder *JpegEncoderCreate(int quality) {
+    if (quality < 1 || quality > 100) {
+        return NULL;
+    }
+    JpegEncoder *encoder = calloc(1, sizeof(JpegEncoder));
+    if (!encoder) {
+        return NULL;
+    }
+    JpegBuildQuant(JpegLumaQuant, quality, &encoder->tables[0]);
+    JpegBuildQuant(JpegChromaQuant, quality, &encoder->tables[1]);
+    JpegBuildHuffman(JpegDcLumaBits, JpegDcValues, encoder->tables[0].dc);
+    JpegBuildHuffman(JpegDcChromaBits, JpegDcValues, encoder->tables[1].dc);
+    JpegBuildHuffman(JpegAcLumaBits, JpegAcLumaValues, encoder->tables[0].ac);
+    JpegBuildHuffman(JpegAcChromaBits, JpegAcChromaValues, encoder->tables[1].ac);
+    for (int value = 0; value < 256; value++) {
+        float luma = ((float)value - 16.0f) * 255.0f / 219.0f;
+        float chroma = ((float)value - 128.0f) * 255.0f / 224.0f;
+        encoder->levels[0][0][value] = (float)value - 128.0f;
+        encoder->levels[0][1][value] = (float)value - 128.0f;
+        encoder->levels[1][0][value] = fminf(fmaxf(luma, 0.0f), 255.0f) - 128.0f;
+        encoder->levels[1][1][value] = fminf(fmaxf(chroma, -128.0f), 127.0f);
+    }
+    return encoder;
+}
+
+void JpegEncoderDestroy(JpegEncoder *encoder) {
+    free(encoder);
+}
+
+size_t JpegEncoderSuggestedCapacity(size_t pixels) {
+    return pixels * 3 / 2 + JPEG_ENCODER_HEADER_BYTES;
+}
+
+// Writer
+
+static inline void JpegWriteByte(JpegWriter *writer, uint8_t byte) {
+    if (writer->size >= writer->capacity) {
+        writer->overflow = true;
+        return;
+    }
+    writer->data[writer->size++] = byte;
+}
+
+static void JpegWriteBytes(JpegWriter *writer, const uint8_t *bytes, size_t count) {
+    if (writer->capacity - writer->size < count) {
+        writer->overflow = true;
+        return;
+    }
+    memcpy(writer->data + writer->size, bytes, count);
+    writer->size += count;
+}
+
+static inline void JpegWriteU16(JpegWriter *writer, unsigned value) {
+    JpegWriteByte(writer, (uint8_t)(value >> 8));
+    JpegWriteByte(writer, (uint8_t)value);
+}
+
+/// 熵编码数据，0xFF 后补 0x00
+static inline void JpegWriteBits(JpegWriter *writer, uint32_t value, int count) {
+    writer->bits = (writer->bits << count) | (value & ((1u << count) - 1));
+    writer->bitCount += count;
+    while (writer->bitCount >= 8) {
+        writer->bitCount -= 8;
+        uint8_t byte = (uint8_t)(writer->bits >> writer->bitCount);
+        JpegWriteByte(writer, byte);
+        if (byte == 0xFF) {
+            JpegWriteByte(writer, 0);
+        }
+    }
+}
+
+/// 最后不足一字节的部分补 1
+static void JpegFlushBits(JpegWriter *writer) {
+    if (writer->bitCount > 0) {
+        JpegWriteBits(writer, 0x7F, 8 - writer->bitCount);
+    }
+    writer->bits = 0;
+}
+
+static void JpegWriteHeaders(JpegWriter *writer, const JpegEncoder *encoder, int width, int height) {
+    static const uint8_t app0[] = {
+        0xFF, 0xD8, 0xFF, 0xE0, 0, 16, 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0,
+    };
+    JpegWriteBytes(writer, app0, sizeof(app0));
+
+    JpegWriteU16(writer, 0xFFDB);
+    JpegWriteU16(writer, 2 + 2 * 65);
+    for (int table = 0; table < 2; table++) {
+        uint8_t zigzag[64];
+        for (int i = 0; i < 64; i++) {
+            zigzag[JpegZigzag[i]] = encoder->tables[table].quant[i];
+        }
+        JpegWriteByte(writer, (uint8_t)table);
+        JpegWriteBytes(writer, zigzag, 64);
+    }
+
+    // Y 2x2 采样，Cb/Cr 1x1
+    const uint8_t sof[] = {
+        0xFF, 0xC0, 0, 17, 8, (uint8_t)(height >> 8), (uint8_t)height, (uint8_t)(width >> 8), (uint8_t)width, 3,
+        1, 0x22, 0, 2, 0x11, 1, 3, 0x11, 1,
+    };
+    JpegWriteBytes(writer, sof, sizeof(sof));
+
+    const uint8_t *bits[4] = {JpegDcLumaBits, JpegAcLumaBits, JpegDcChromaBits, JpegAcChromaBits};
+    const uint8_t *values[4] = {JpegDcValues, JpegAcLumaValues, JpegDcValues, JpegAcChromaValues};
+    const uint8_t classes[4] = {0x00, 0x10, 0x01, 0x11};
+    size_t length = 2;
+    size_t counts[4];
+    for (int i = 0; i < 4; i++) {
+        counts[i] = 0;
+        for (int k = 0; k < 16; k++) {
+            counts[i] += bits[i][k];
+        }
+        length += 17 + counts[i];
+    }
+    JpegWriteU16(writer, 0xFFC4);
+    JpegWriteU16(writer, (unsigned)length);
+    for (int i = 0; i < 4; i++) {
+        JpegWriteByte(writer, classes[i]);
+        JpegWriteBytes(writer, bits[i], 16);
+        JpegWriteBytes(writer, values[i], counts[i]);
+    }
+
+    static const uint8_t sos[] = {0xFF, 0xDA, 0, 12, 3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+    JpegWriteBytes(writer, sos, sizeof(sos));
+}
+
+// Blocks
+
+/// AAN 浮点 DCT，结果需再乘以 divisors
+static void JpegForwardDct(float *block) {
+    for (int pass = 0; pass < 2; pass++) {
+        // 先行后列
+        int step = pass == 0 ? 1 : 8;
+        int next = pass == 0 ? 8 : 1;
+        for (int line = 0; line < 8; line++) {
+            float *d = block + line * next;
+            float tmp0 = d[0] + d[7 * step];
+            float tmp7 = d[0] - d[7 * step];
+            float tmp1 = d[step] + d[6 * step];
+            float tmp6 = d[step] - d[6 * step];
+            float tmp2 = d[2 * step] + d[5 * step];
+            float tmp5 = d[2 * step] - d[5 * step];
+            float tmp3 = d[3 * step] + d[4 * step];
+            float tmp4 = d[3 * step] - d[4 * step];
+
+            float tmp10 = tmp0 + tmp3;
+            float tmp13 = tmp0 - tmp3;
+            float tmp11 = tmp1 + tmp2;
+            float tmp12 = tmp1 - tmp2;
+            d[0] = tmp10 + tmp11;
+            d[4 * step] = tmp10 - tmp11;
+            float z1 = (tmp12 + tmp13) * 0.707106781f;
+            d[2 * step] = tmp13 + z1;
+            d[6 * step] = tmp13 - z1;
+
+            tmp10 = tmp4 + tmp5;
+            tmp11 = tmp5 + tmp6;
+            tmp12 = tmp6 + tmp7;
+            float z5 = (tmp10 - tmp12) * 0.382683433f;
+            float z2 = tmp10 * 0.541196100f + z5;
+            float z4 = tmp12 * 1.306562965f + z5;
+            float z3 = tmp11 * 0.707106781f;
+            float z11 = tmp7 + z3;
+            float z13 = tmp7 - z3;
+            d[5 * step] = z13 + z2;
+            d[3 * step] = z13 - z2;
+            d[step] = z11 + z4;
+            d[7 * step] = z11 - z4;
+        }
+    }
+}
+
+/// 取一个 8x8 块，超出图像的部分复制边缘像素
+static void JpegLoadBlock(const uint8_t *plane, size_t stride, int width, int height, int x, int y,
+                          const float *levels, float *block) {
+    for (int row = 0; row < 8; row++) {
+        int sy = y + row < height ? y + row : height - 1;
+        const uint8_t *line = plane + (size_t)sy * stride;
+        float *out = block + row * 8;
+        if (x + 8 <= width) {
+            for (int col = 0; col < 8; col++) {
+                out[col] = levels[line[x + col]];
+            }
+        } else {
+            for (int col = 0; col < 8; col++) {
+                out[col] = levels[line[x + col < width ? x + col : width - 1]];
+            }
+        }
+    }
+}
+
+/// 值的位数（JPEG 中的 category）
+static inline int JpegCategory(int value) {
+    unsigned magnitude = (unsigned)(value < 0 ? -value : value);
+    int category = 0;
+    while (magnitude) {
+        category++;
+        magnitude >>= 1;
+    }
+    return category;
+}
+
+static inline void JpegWriteValue(JpegWriter *writer, int value, int category) {
+    // 负数写 value - 1 的低 category 位
+    JpegWriteBits(writer, (uint32_t)(value < 0 ? value - 1 : value), category);
+}
+
+static void JpegEncodeBlock(JpegWriter *writer, const JpegComponentTables *tables, float *block, int *previousDc) {
+    JpegForwardDct(block);
+    int coefficients[64];
+    for (int i = 0; i < 64; i++) {
+        coefficients[JpegZigzag[i]] = (int)lrintf(block[i] * tables->divisors[i]);
+    }
+    // 基线 JPEG 的 AC 系数最多 10 位，质量接近 100 时可能超出
+    for (int i = 1; i < 64; i++) {
+        coefficients[i] = coefficients[i] > 1023 ? 1023 : coefficients[i] < -1023 ? -1023 : coefficients[i];
+    }
+
+    int diff = coefficients[0] - *previousDc;
+    *previousDc = coefficients[0];
+    int category = JpegCategory(diff);
+    JpegWriteBits(writer, tables->dc[category].code, tables->dc[category].length);
+    JpegWriteValue(writer, diff, category);
+
+    int last = 63;
+    while (last > 0 && coefficients[last] == 0) {
+        last--;
+    }
+    int run = 0;
+    for (int i = 1; i <= last; i++) {
+        if (coefficients[i] == 0) {
+            run++;
+            continue;
+        }
+        while (run >= 16) {
+            JpegWriteBits(writer, tables->ac[0xF0].code, tables->ac[0xF0].length);
+            run -= 16;
+        }
+        category = JpegCategory(coefficients[i]);
+        int symbol = (run << 4) | category;
+        JpegWriteBits(writer, tables->ac[symbol].code, tables->ac[symbol].length);
+        JpegWriteValue(writer, coefficients[i], category);
+        run = 0;
+    }
+    if (last < 63) {
+        JpegWriteBits(writer, tables->ac[0x00].code, tables->ac[0x00].length);
+    }
+}
+
+// Public
+
+size_t JpegEncoderEncodeI420(JpegEncoder *encoder, const GridI420Image *image, bool videoRange, uint8_t *out,
+                             size_t capacity) {
+    if (!encoder || !image || !out || image->width < 2 || image->height < 2 || image->width > 0xFFFF ||
+        image->height > 0xFFFF || (image->width & 1) || (image->height & 1)) {
+        return 0;
+    }
+    JpegWriter writer = {.data = out, .capacity = capacity};
+    JpegWriteHeaders(&writer, encoder, image->width, image->height);
+
+    const float *lumaLevels = encoder->levels[videoRange ? 1 : 0][0];
+    const float *chromaLevels = encoder->levels[videoRange ? 1 : 0][1];
+    int chromaWidth = image->width / 2;
+    int chromaHeight = image->height / 2;
+    int dc[3] = {0, 0, 0};
+    float block[64];
+    for (int my = 0; my < image->height && !writer.overflow; my += 16) {
+        for (int mx = 0; mx < image->width; mx += 16) {
+            for (int i = 0; i < 4; i++) {
+                JpegLoadBlock(image->y, image->yStride, image->width, image->height, mx + (i & 1) * 8,
+                              my + (i >> 1) * 8, lumaLevels, block);
+                JpegEncodeBlock(&writer, &encoder->tables[0], block, &dc[0]);
+            }
+            JpegLoadBlock(image->u, image->uStride, chromaWidth, chromaHeight, mx / 2, my / 2, chromaLevels, block);
+            JpegEncodeBlock(&writer, &encoder->tables[1], block, &dc[1]);
+            JpegLoadBlock(image->v, image->vStride, chromaWidth, chromaHeight, mx / 2, my / 2, chromaLevels, block);
+            JpegEncodeBlock(&writer, &encoder->tables[1], block, &dc[2]);
+        }
+    }
+    JpegFlushBits(&writer);
+    JpegWriteU16(&writer, 0xFFD9);
+    return writer.overflow ? 0 : writer.size;
+}
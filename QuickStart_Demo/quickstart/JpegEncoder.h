@@ -0,0 +1,43 @@
+//
+//  JpegEncoder.h
+//  quickstart
+//
+//  I420 基线 JPEG 编码（4:2:0，标准量化表与霍夫曼表），不依赖系统图像库
+//
+
+#ifndef JpegEncoder_h
+#define JpegEncoder_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "GridCompositor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct JpegEncoder JpegEncoder;
+
+/// 量化表与霍夫曼表在此生成，编码时不再分配内存
+/// @param quality 1～100，与 libjpeg 的质量系数一致
+JpegEncoder *JpegEncoderCreate(int quality);
+
+void JpegEncoderDestroy(JpegEncoder *encoder);
+
+/// 建议的输出缓冲字节数：I420 原始大小加文件头，质量 95 以下的自然图像不会超出
+size_t JpegEncoderSuggestedCapacity(size_t pixels);
+
+/// 编码一帧 I420，宽高为偶数
+/// @param videoRange 输入为 video range（Y 16～235，UV 16～240），编码时扩展到 JFIF 要求的 full range
+/// @param capacity out 的字节数
+/// @return JPEG 文件字节数，尺寸非法或空间不足时返回 0
+size_t JpegEncoderEncodeI420(JpegEncoder *encoder, const GridI420Image *image, bool videoRange, uint8_t *out,
+                             size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JpegEncoder_h */
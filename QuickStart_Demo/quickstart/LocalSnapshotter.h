@@ -0,0 +1,45 @@
+//
+//  LocalSnapshotter.h
+//  quickstart
+//
+//  本地处理后画面截图：不经过 SDK 的 takeLocalSnapshot，处理线程只拷贝，编码在后台完成
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "SnapshotPipeline.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 截图回调，在编码线程调用
+/// @note image.data 只在回调期间有效，需要保留时使用 jpegData
+typedef void (^LocalSnapshotHandler)(NSData *jpegData, SnapshotImage image);
+
+/// 由 CustomProcessor 在处理线程上逐帧调用 appendFrame:，有待截取的帧时把 I420 平面拷入预分配槽位（可同时降采样），
+/// 后台线程编码为 JPEG 后通过 snapshotHandler 交付。
+/// @note 没有请求时 appendFrame: 只读一个原子变量；有请求时不分配内存、不加锁，耗时计入 stats。
+@interface LocalSnapshotter : NSObject
+
+/// @param config 槽位数、最大像素数与 JPEG 质量，传 NULL 使用 SnapshotPipelineDefaultConfig()
+- (nullable instancetype)initWithConfig:(nullable const SnapshotPipelineConfig *)config NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (atomic, copy, nullable) LocalSnapshotHandler snapshotHandler;
+
+/// 截取接下来的 count 帧，可在任意线程调用；与未完成的请求累加
+- (void)captureNextFrames:(NSUInteger)count scale:(SnapshotScale)scale;
+
+/// 处理线程：追加一帧处理后的 I420 画面
+- (void)appendFrame:(ByteRTCVideoFrame *)frame;
+
+/// 同 appendFrame:，用于不经 CustomProcessor 的 I420 planar 画面（如 RemoteGridCompositor 的合成结果），同一时间只能有一个线程调用
+- (void)appendPixelBuffer:(CVPixelBufferRef)pixelBuffer rotation:(int)rotation time:(CMTime)time;
+
+/// 编码完已截取的帧并停止，可能等待编码，不要在处理线程调用
+- (void)stop;
+
+@property (nonatomic, assign, readonly) SnapshotPipelineStats stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,87 @@
+//
+//  LocalSnapshotter.m
+//  quickstart
+//
+
+#import "LocalSnapshotter.h"
+
+@interface LocalSnapshotter () {
+    SnapshotPipeline *_pipeline;
+}
+
+@end
+
+static void LocalSnapshotterDeliver(void *context, const SnapshotImage *image) {
+    LocalSnapshotter *snapshotter = (__bridge LocalSnapshotter *)context;
+    LocalSnapshotHandler handler = snapshotter.snapshotHandler;
+    if (!handler) {
+        return;
+    }
+    @autoreleasepool {
+        handler([NSData dataWithBytes:image->data length:image->size], *image);
+    }
+}
+
+@implementation LocalSnapshotter
+
+- (nullable instancetype)initWithConfig:(nullable const SnapshotPipelineConfig *)config {
+    self = [super init];
+    if (self) {
+        SnapshotPipelineConfig defaultConfig = SnapshotPipelineDefaultConfig();
+        _pipeline = SnapshotPipelineCreate(config ?: &defaultConfig, LocalSnapshotterDeliver, (__bridge void *)self);
+        if (!_pipeline) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    SnapshotPipelineDestroy(_pipeline);
+}
+
+- (void)captureNextFrames:(NSUInteger)count scale:(SnapshotScale)scale {
+    SnapshotPipelineRequest(_pipeline, (uint32_t)MIN(count, UINT32_MAX), scale);
+}
+
+- (void)appendFrame:(ByteRTCVideoFrame *)frame {
+    if (!SnapshotPipelineWantsFrame(_pipeline)) {
+        return;
+    }
+    [self appendPixelBuffer:frame.textureBuf rotation:(int)frame.rotation time:frame.time];
+}
+
+- (void)appendPixelBuffer:(CVPixelBufferRef)pixelBuffer rotation:(int)rotation time:(CMTime)time {
+    if (!SnapshotPipelineWantsFrame(_pipeline)) {
+        return;
+    }
+    if (!pixelBuffer || CVPixelBufferGetPlaneCount(pixelBuffer) != 3) {
+        return;
+    }
+    CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    GridI420Image image = {
+        .y = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0),
+        .u = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 1),
+        .v = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 2),
+        .yStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0),
+        .uStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 1),
+        .vStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 2),
+        .width = (int)CVPixelBufferGetWidth(pixelBuffer),
+        .height = (int)CVPixelBufferGetHeight(pixelBuffer),
+    };
+    int64_t timestampUs = CMTIME_IS_VALID(time) ? (int64_t)(CMTimeGetSeconds(time) * 1000000.0) : 0;
+    SnapshotPipelineCapture(_pipeline, &image, rotation, timestampUs);
+    CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+}
+
+- (void)stop {
+    SnapshotPipelineStop(_pipeline);
+}
+
+- (SnapshotPipelineStats)stats {
+    SnapshotPipelineStats stats;
+    SnapshotPipelineGetStats(_pipeline, &stats);
+    return stats;
+}
+
+@end
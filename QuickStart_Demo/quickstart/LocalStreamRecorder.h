@@ -0,0 +1,38 @@
+//
+//  LocalStreamRecorder.h
+//  quickstart
+//
+//  本地发布流录制：直接保存 SDK 编码后的视频帧，不重新编码
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "EncodedRecorder.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 通过 registerLocalEncodedVideoFrameObserver: 注册后，把主流的编码帧与采集音频交给 EncodedRecorder。
+/// @note 回调线程中只拷贝数据到预分配缓冲，不分配内存、不等待磁盘；缓冲满时丢帧并计数。
+///       采集音频来自 AudioPreprocessor 的 onProcessRecordAudioFrame:（SDK 不提供本地编码后的音频），
+///       MP4 中为 PCM 轨，Annex-B 格式另存为同名 WAV。
+@interface LocalStreamRecorder : NSObject <ByteRTCLocalEncodedVideoFrameObserver>
+
+/// 创建后即开始录制，第一个文件在收到第一帧关键帧时创建
+/// @param pathPrefix 输出路径前缀，如 Documents/Recordings/room_20240101_120000
+/// @param audioFormat 录制的采集音频格式，需与 enableAudioProcessor:audioFormat: 一致；nil 表示只录视频
+- (nullable instancetype)initWithPathPrefix:(NSString *)pathPrefix
+                                     format:(EncodedMuxerFormat)format
+                                audioFormat:(nullable ByteRTCAudioFormat *)audioFormat NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 采集音频线程：追加一帧前处理后的采集音频
+- (void)appendRecordAudioFrame:(ByteRTCAudioFrame *)audioFrame;
+
+/// 写完缓冲中剩余的帧并关闭文件，可能等待磁盘，不要在回调线程调用
+- (void)stop;
+
+@property (nonatomic, assign, readonly) EncodedRecorderStats stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
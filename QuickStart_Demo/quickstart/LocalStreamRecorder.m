@@ -0,0 +1,89 @@
+//
+//  LocalStreamRecorder.m
+//  quickstart
+//
+
+#import "LocalStreamRecorder.h"
+
+@interface LocalStreamRecorder () {
+    EncodedRecorder *_recorder;
+}
+
+@end
+
+@implementation LocalStreamRecorder
+
+- (nullable instancetype)initWithPathPrefix:(NSString *)pathPrefix
+                                     format:(EncodedMuxerFormat)format
+                                audioFormat:(nullable ByteRTCAudioFormat *)audioFormat {
+    self = [super init];
+    if (self) {
+        NSString *directory = pathPrefix.stringByDeletingLastPathComponent;
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+        EncodedRecorderConfig config = EncodedRecorderDefaultConfig(pathPrefix.fileSystemRepresentation);
+        config.format = format;
+        if (audioFormat && audioFormat.sampleRate > 0 && audioFormat.channel > 0) {
+            config.audioSampleRate = (uint32_t)audioFormat.sampleRate;
+            config.audioChannels = (uint32_t)audioFormat.channel;
+        }
+        _recorder = EncodedRecorderCreate(&config);
+        if (!_recorder) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    EncodedRecorderDestroy(_recorder);
+}
+
+- (void)stop {
+    EncodedRecorderStop(_recorder);
+}
+
+- (EncodedRecorderStats)stats {
+    EncodedRecorderStats stats;
+    EncodedRecorderGetStats(_recorder, &stats);
+    return stats;
+}
+
+#pragma mark - ByteRTCLocalEncodedVideoFrameObserver
+
+- (void)onLocalEncodedVideoFrame:(ByteRTCStreamIndex)streamIndex Frame:(ByteRTCEncodedVideoFrame *)frame {
+    if (streamIndex != ByteRTCStreamIndexMain || !frame || frame.data.length == 0 || frame.data.length > UINT32_MAX) {
+        return;
+    }
+    EncodedFrameHeader header = {
+        .ptsUs = frame.timestampUs,
+        .dtsUs = frame.timestampDtsUs,
+        .arrivalUs = EncodedRecorderNowUs(),
+        .size = (uint32_t)frame.data.length,
+        .flags = frame.pictureType == ByteRTCVideoPictureTypeI ? ENCODED_FRAME_FLAG_KEYFRAME : 0,
+        .width = (uint16_t)frame.width,
+        .height = (uint16_t)frame.height,
+        .rotation = (uint16_t)frame.rotation,
+        .codec = frame.codecType == ByteRTCVideoCodecTypeByteVC1 ? EncodedFrameCodecH265 : EncodedFrameCodecH264,
+    };
+    EncodedRecorderPushVideo(_recorder, &header, frame.data.bytes);
+}
+
+#pragma mark - Record audio
+
+- (void)appendRecordAudioFrame:(ByteRTCAudioFrame *)audioFrame {
+    int channels = audioFrame.channel == ByteRTCAudioChannelStereo ? 2 : 1;
+    size_t bytes = (size_t)audioFrame.samples * channels * sizeof(int16_t);
+    if (bytes == 0 || audioFrame.buffer.length < bytes || audioFrame.sampleRate <= 0) {
+        return;
+    }
+    EncodedFrameHeader header = {
+        .arrivalUs = EncodedRecorderNowUs(),
+        .size = (uint32_t)bytes,
+        .codec = EncodedFrameCodecPCM16,
+        .channels = (uint8_t)channels,
+        .sampleRate = (uint32_t)audioFrame.sampleRate,
+    };
+    EncodedRecorderPushAudio(_recorder, &header, audioFrame.buffer.bytes);
+}
+
+@end
@@ -0,0 +1,188 @@
+//
+//  LumaDownscaler.c
+//  quickstart
+//
+
+#include "LumaDownscaler.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LUMA_DOWNSCALER_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LUMA_DOWNSCALER_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+// AVX2 单独按函数开启，不要求整个工程以 -mavx2 编译，运行时按 CPU 选择
+#define LUMA_DOWNSCALER_AVX2 1
+#endif
+#endif
+
+static inline void LumaDownscaleHalfRow_C(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, size_t dstWidth) {
+    for (size_t x = 0; x < dstWidth; x++) {
+        unsigned sum = row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1];
+        dst[x] = (uint8_t)((sum + 2) >> 2);
+    }
+}
+
+void LumaDownscaleHalf_C(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                         uint8_t *dst, size_t dstStride) {
+    size_t dstWidth = srcWidth / 2;
+    size_t dstHeight = srcHeight / 2;
+    for (size_t y = 0; y < dstHeight; y++) {
+        const uint8_t *row0 = src + 2 * y * srcStride;
+        LumaDownscaleHalfRow_C(row0, row0 + srcStride, dst + y * dstStride, dstWidth);
+    }
+}
+
+#if LUMA_DOWNSCALER_NEON
+static void LumaDownscaleHalf_NEON(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                                   uint8_t *dst, size_t dstStride) {
+    size_t dstWidth = srcWidth / 2;
+    size_t dstHeight = srcHeight / 2;
+    for (size_t y = 0; y < dstHeight; y++) {
+        const uint8_t *row0 = src + 2 * y * srcStride;
+        const uint8_t *row1 = row0 + srcStride;
+        uint8_t *out = dst + y * dstStride;
+        size_t x = 0;
+        // 每次处理 32 个源像素，输出 16 个
+        for (; x + 16 <= dstWidth; x += 16) {
+            uint16x8_t lo = vpaddlq_u8(vld1q_u8(row0 + 2 * x));
+            uint16x8_t hi = vpaddlq_u8(vld1q_u8(row0 + 2 * x + 16));
+            lo = vpadalq_u8(lo, vld1q_u8(row1 + 2 * x));
+            hi = vpadalq_u8(hi, vld1q_u8(row1 + 2 * x + 16));
+            // vrshrn: (sum + 2) >> 2
+            vst1q_u8(out + x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+        }
+        LumaDownscaleHalfRow_C(row0 + 2 * x, row1 + 2 * x, out + x, dstWidth - x);
+    }
+}
+#endif
+
+#if LUMA_DOWNSCALER_SSE2
+static void LumaDownscaleHalf_SSE2(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                                   uint8_t *dst, size_t dstStride) {
+    size_t dstWidth = srcWidth / 2;
+    size_t dstHeight = srcHeight / 2;
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    const __m128i round = _mm_set1_epi16(2);
+    for (size_t y = 0; y < dstHeight; y++) {
+        const uint8_t *row0 = src + 2 * y * srcStride;
+        const uint8_t *row1 = row0 + srcStride;
+        uint8_t *out = dst + y * dstStride;
+        size_t x = 0;
+        for (; x + 16 <= dstWidth; x += 16) {
+            __m128i a0 = _mm_loadu_si128((const __m128i *)(row0 + 2 * x));
+            __m128i a1 = _mm_loadu_si128((const __m128i *)(row0 + 2 * x + 16));
+            __m128i b0 = _mm_loadu_si128((const __m128i *)(row1 + 2 * x));
+            __m128i b1 = _mm_loadu_si128((const __m128i *)(row1 + 2 * x + 16));
+            // 偶数列 + 奇数列，扩展到 16 位后相加
+            __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, mask), _mm_srli_epi16(a0, 8)),
+                                       _mm_add_epi16(_mm_and_si128(b0, mask), _mm_srli_epi16(b0, 8)));
+            __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a1, mask), _mm_srli_epi16(a1, 8)),
+                                       _mm_add_epi16(_mm_and_si128(b1, mask), _mm_srli_epi16(b1, 8)));
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 2);
+            _mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(lo, hi));
+        }
+        LumaDownscaleHalfRow_C(row0 + 2 * x, row1 + 2 * x, out + x, dstWidth - x);
+    }
+}
+#endif
+
+#if LUMA_DOWNSCALER_AVX2
+__attribute__((target("avx2")))
+static void LumaDownscaleHalf_AVX2(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                                   uint8_t *dst, size_t dstStride) {
+    size_t dstWidth = srcWidth / 2;
+    size_t dstHeight = srcHeight / 2;
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i round = _mm256_set1_epi16(2);
+    for (size_t y = 0; y < dstHeight; y++) {
+        const uint8_t *row0 = src + 2 * y * srcStride;
+        const uint8_t *row1 = row0 + srcStride;
+        uint8_t *out = dst + y * dstStride;
+        size_t x = 0;
+        // 每次处理 64 个源像素，输出 32 个
+        for (; x + 32 <= dstWidth; x += 32) {
+            // maddubs 与 1 相乘：相邻两字节求和到 16 位，最大 510 不会饱和
+            __m256i lo = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(row0 + 2 * x)), ones),
+                                          _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(row1 + 2 * x)), ones));
+            __m256i hi = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(row0 + 2 * x + 32)), ones),
+                                          _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(row1 + 2 * x + 32)), ones));
+            lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 2);
+            hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 2);
+            // packus 按 128 位分道交错，重新排列 64 位块恢复顺序
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+            _mm256_storeu_si256((__m256i *)(out + x), packed);
+        }
+        LumaDownscaleHalfRow_C(row0 + 2 * x, row1 + 2 * x, out + x, dstWidth - x);
+    }
+}
+
+static bool LumaDownscalerCPUSupportsAVX2(void) {
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+LumaDownscalerISA LumaDownscalerActiveISA(void) {
+#if LUMA_DOWNSCALER_NEON
+    return LumaDownscalerISANEON;
+#elif LUMA_DOWNSCALER_SSE2
+#if LUMA_DOWNSCALER_AVX2
+    if (LumaDownscalerCPUSupportsAVX2()) {
+        return LumaDownscalerISAAVX2;
+    }
+#endif
+    return LumaDownscalerISASSE2;
+#else
+    return LumaDownscalerISAScalar;
+#endif
+}
+
+bool LumaDownscaleHalfWithISA(LumaDownscalerISA isa, const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                              uint8_t *dst, size_t dstStride) {
+    switch (isa) {
+        case LumaDownscalerISAScalar:
+            LumaDownscaleHalf_C(src, srcStride, srcWidth, srcHeight, dst, dstStride);
+            return true;
+        case LumaDownscalerISANEON:
+#if LUMA_DOWNSCALER_NEON
+            LumaDownscaleHalf_NEON(src, srcStride, srcWidth, srcHeight, dst, dstStride);
+            return true;
+#else
+            return false;
+#endif
+        case LumaDownscalerISASSE2:
+#if LUMA_DOWNSCALER_SSE2
+            LumaDownscaleHalf_SSE2(src, srcStride, srcWidth, srcHeight, dst, dstStride);
+            return true;
+#else
+            return false;
+#endif
+        case LumaDownscalerISAAVX2:
+#if LUMA_DOWNSCALER_AVX2
+            if (!LumaDownscalerCPUSupportsAVX2()) {
+                return false;
+            }
+            LumaDownscaleHalf_AVX2(src, srcStride, srcWidth, srcHeight, dst, dstStride);
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+void LumaDownscaleHalf(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                       uint8_t *dst, size_t dstStride) {
+    LumaDownscaleHalfWithISA(LumaDownscalerActiveISA(), src, srcStride, srcWidth, srcHeight, dst, dstStride);
+}
+
+void LumaDownscaleQuarter(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                          uint8_t *dst, size_t dstStride, uint8_t *scratch) {
+    size_t halfWidth = srcWidth / 2;
+    size_t halfHeight = srcHeight / 2;
+    LumaDownscaleHalf(src, srcStride, srcWidth, srcHeight, scratch, halfWidth);
+    LumaDownscaleHalf(scratch, halfWidth, halfWidth, halfHeight, dst, dstStride);
+}
@@ -0,0 +1,59 @@
+//
+//  LumaDownscaler.h
+//  quickstart
+//
+//  亮度平面降采样（2x2 box），用于低分辨率人脸检测
+//
+
+#ifndef LumaDownscaler_h
+#define LumaDownscaler_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// SIMD 实现
+typedef enum {
+    LumaDownscalerISAScalar = 0,
+    LumaDownscalerISANEON,          // ARM 编译目标
+    LumaDownscalerISASSE2,          // x86 编译目标
+    LumaDownscalerISAAVX2,          // x86 运行时检测 CPU 支持后使用
+} LumaDownscalerISA;
+
+/// 当前 CPU 上 LumaDownscaleHalf 使用的实现
+LumaDownscalerISA LumaDownscalerActiveISA(void);
+
+/// 2x2 box 降采样到 1/2 分辨率，结果为 (a + b + c + d + 2) >> 2
+/// @note 使用 LumaDownscalerActiveISA 对应的实现，与 LumaDownscaleHalf_C 逐字节一致
+/// @param src 源亮度平面
+/// @param srcStride 源行字节数
+/// @param srcWidth 源宽度（奇数时忽略最后一列）
+/// @param srcHeight 源高度（奇数时忽略最后一行）
+/// @param dst 目标平面，大小至少为 dstStride * (srcHeight / 2)
+/// @param dstStride 目标行字节数，不小于 srcWidth / 2
+void LumaDownscaleHalf(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                       uint8_t *dst, size_t dstStride);
+
+/// 降采样到 1/4 分辨率（连续两次 LumaDownscaleHalf）
+/// @param scratch 中间结果缓冲区，大小至少为 (srcWidth / 2) * (srcHeight / 2)
+void LumaDownscaleQuarter(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                          uint8_t *dst, size_t dstStride, uint8_t *scratch);
+
+/// 标量参考实现，用于校验 SIMD 结果
+void LumaDownscaleHalf_C(const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                         uint8_t *dst, size_t dstStride);
+
+/// 用指定实现降采样，供测试与基准逐个对比各实现
+/// @return 编译目标或 CPU 不支持该实现时返回 false，不写 dst
+bool LumaDownscaleHalfWithISA(LumaDownscalerISA isa, const uint8_t *src, size_t srcStride, size_t srcWidth, size_t srcHeight,
+                              uint8_t *dst, size_t dstStride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LumaDownscaler_h */
@@ -0,0 +1,75 @@
+//
+//  RemoteGridCompositor.h
+//  quickstart
+//
+//  将房间画面按 2x2 网格合成为一路 I420 视频，用于录制/导出
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "GridCompositor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 合成结果回调，在合成线程调用
+/// @note pixelBuffer 为 I420 planar 格式，来自缓存池，需要在回调之后继续使用时 CVPixelBufferRetain
+typedef void (^RemoteGridFrameHandler)(CVPixelBufferRef pixelBuffer, CMTime time);
+
+/// 本地画面与每路远端流各绑定一个自定义渲染器，只保留最新一帧的引用（不拷贝），在合成线程上缩放拼接：
+/// 录制等连续输出用 start 按固定帧率合成，截图等偶尔取一帧时用 requestFrame 按需合成。
+/// 格子顺序与 RoomViewController 的四个视图一致：0 左上（本地）、1 右上、2 左下、3 右下。
+/// @note 绑定、解绑在主线程调用；渲染器回调线程只替换帧引用，不做缩放。
+@interface RemoteGridCompositor : NSObject
+
+/// @param width 输出宽度，向下取整到偶数
+/// @param height 输出高度，向下取整到偶数
+/// @param frameRate 合成帧率
+- (instancetype)initWithRTCVideo:(ByteRTCVideo *)rtcVideo
+                     outputWidth:(NSUInteger)width
+                          height:(NSUInteger)height
+                       frameRate:(NSUInteger)frameRate NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 格子数
+@property (nonatomic, assign, readonly) NSUInteger tileCount;
+
+/// 缩放模式，默认 GridScaleModeHidden，与视图的 ByteRTCRenderModeHidden 一致
+@property (atomic, assign) GridScaleMode scaleMode;
+
+@property (atomic, copy, nullable) RemoteGridFrameHandler frameHandler;
+
+/// 已输出的帧数
+@property (atomic, assign, readonly) NSUInteger composedFrameCount;
+/// 最近一次合成耗时（秒）
+@property (atomic, assign, readonly) NSTimeInterval lastComposeDuration;
+
+/// 为远端流绑定自定义渲染器，输出到第 tile 格；该格之前绑定的流会先解绑
+- (void)attachStreamKey:(ByteRTCRemoteStreamKey *)streamKey toTile:(NSUInteger)tile;
+
+/// 为本地前处理后的画面绑定自定义渲染器，输出到第 tile 格；该格之前绑定的流会先解绑
+/// @note 本地画面不经 SDK 转正，按帧的原始方向绘制
+- (void)attachLocalStream:(ByteRTCStreamIndex)streamIndex toTile:(NSUInteger)tile;
+
+/// 解绑第 tile 格的本地或远端流，并清空该格
+- (void)detachTile:(NSUInteger)tile;
+
+/// 解绑所有格子
+- (void)detachAllTiles;
+
+/// 替换第 tile 格的最新帧，pixelBuffer 需为 I420 planar 格式，传 NULL 清空该格
+/// @note 可在任意线程调用，用于接入本地画面等非远端流来源
+- (void)updateTile:(NSUInteger)tile withPixelBuffer:(nullable CVPixelBufferRef)pixelBuffer;
+
+/// 开始按帧率合成
+- (void)start;
+/// 停止合成，不解绑远端流；返回时已请求的合成都已结束
+- (void)stop;
+
+/// 在合成线程上用各格最新一帧合成一帧并回调 frameHandler，可在任意线程调用；不需要 start
+- (void)requestFrame;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,268 @@
+//
+//  RemoteGridCompositor.m
+//  quickstart
+//
+
+#import "RemoteGridCompositor.h"
+#import "VideoFramePool.h"
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+
+/// 2x2 网格
+static const int kRemoteGridColumns = 2;
+static const int kRemoteGridRows = 2;
+static const NSUInteger kRemoteGridTileCount = 4;
+/// 支持的最大源图宽度
+static const int kRemoteGridMaxSourceWidth = 4096;
+
+@class RemoteGridCompositor;
+
+/// 单路本地或远端流的渲染器，只把帧引用交给合成器
+@interface RemoteGridTileSink : NSObject <ByteRTCVideoSinkDelegate>
+@property (nonatomic, weak) RemoteGridCompositor *compositor;
+@property (nonatomic, assign) NSUInteger tile;
+@end
+
+@interface RemoteGridCompositor () {
+    GridCompositor *_compositor;
+    os_unfair_lock _frameLock;
+    /// 各格最新一帧，+1 引用，由 _frameLock 保护
+    CVPixelBufferRef _latestFrames[kRemoteGridTileCount];
+}
+
+@property (nonatomic, weak) ByteRTCVideo *rtcVideo;
+@property (nonatomic, assign) NSUInteger outputWidth;
+@property (nonatomic, assign) NSUInteger outputHeight;
+@property (nonatomic, assign) NSUInteger frameRate;
+
+/// 各格绑定的流与渲染器，只在主线程访问；远端流为 ByteRTCRemoteStreamKey，本地流为 ByteRTCStreamIndex 的 NSNumber
+@property (nonatomic, strong) NSMutableArray *streamKeys;
+@property (nonatomic, strong) NSMutableArray *sinks;
+
+/// 合成线程
+@property (nonatomic, strong) dispatch_queue_t composeQueue;
+@property (nonatomic, strong, nullable) dispatch_source_t composeTimer;
+/// 输出帧缓存池，只在 composeQueue 中使用
+@property (nonatomic, strong) VideoFramePool *outputPool;
+
+@property (atomic, assign) NSUInteger composedFrameCount;
+@property (atomic, assign) NSTimeInterval lastComposeDuration;
+
+@end
+
+@implementation RemoteGridCompositor
+
+- (instancetype)initWithRTCVideo:(ByteRTCVideo *)rtcVideo
+                     outputWidth:(NSUInteger)width
+                          height:(NSUInteger)height
+                       frameRate:(NSUInteger)frameRate {
+    self = [super init];
+    if (self) {
+        NSParameterAssert(width >= 4 && height >= 4 && frameRate > 0);
+        _rtcVideo = rtcVideo;
+        _outputWidth = width & ~(NSUInteger)1;
+        _outputHeight = height & ~(NSUInteger)1;
+        _frameRate = frameRate;
+        _tileCount = kRemoteGridTileCount;
+        _scaleMode = GridScaleModeHidden;
+        _compositor = GridCompositorCreate(kRemoteGridMaxSourceWidth);
+        _frameLock = OS_UNFAIR_LOCK_INIT;
+        _streamKeys = [NSMutableArray arrayWithCapacity:kRemoteGridTileCount];
+        _sinks = [NSMutableArray arrayWithCapacity:kRemoteGridTileCount];
+        for (NSUInteger i = 0; i < kRemoteGridTileCount; i++) {
+            [_streamKeys addObject:[NSNull null]];
+            RemoteGridTileSink *sink = [[RemoteGridTileSink alloc] init];
+            sink.compositor = self;
+            sink.tile = i;
+            [_sinks addObject:sink];
+        }
+        _outputPool = [[VideoFramePool alloc] initWithCapacity:3];
+
+        dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0);
+        _composeQueue = dispatch_queue_create("com.faceunity.grid-compositor", attr);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_composeTimer) {
+        dispatch_source_cancel(_composeTimer);
+    }
+    for (NSUInteger i = 0; i < kRemoteGridTileCount; i++) {
+        if (_latestFrames[i]) {
+            CVPixelBufferRelease(_latestFrames[i]);
+        }
+    }
+    GridCompositorDestroy(_compositor);
+}
+
+#pragma mark - Streams
+
+- (void)attachStreamKey:(ByteRTCRemoteStreamKey *)streamKey toTile:(NSUInteger)tile {
+    NSParameterAssert(tile < kRemoteGridTileCount);
+    [self detachTile:tile];
+    ByteRTCRemoteVideoSinkConfig *config = [[ByteRTCRemoteVideoSinkConfig alloc] init];
+    config.requiredPixelFormat = ByteRTCVideoSinkPixelFormatI420;
+    // 由 SDK 转正，合成时无需处理旋转
+    config.applyRotation = ByteRTCVideoApplyRotation0;
+    [self.rtcVideo setRemoteVideoRender:streamKey withSink:self.sinks[tile] withRemoteRenderConfig:config];
+    self.streamKeys[tile] = streamKey;
+}
+
+- (void)attachLocalStream:(ByteRTCStreamIndex)streamIndex toTile:(NSUInteger)tile {
+    NSParameterAssert(tile < kRemoteGridTileCount);
+    [self detachTile:tile];
+    ByteRTCLocalVideoSinkConfig *config = [[ByteRTCLocalVideoSinkConfig alloc] init];
+    config.position = ByteRTCLocalVideoRenderPositionAfterPreprocess;
+    config.requiredPixelFormat = ByteRTCVideoSinkPixelFormatI420;
+    [self.rtcVideo setLocalVideoRender:streamIndex withSink:self.sinks[tile] withLocalRenderConfig:config];
+    self.streamKeys[tile] = @(streamIndex);
+}
+
+- (void)detachTile:(NSUInteger)tile {
+    NSParameterAssert(tile < kRemoteGridTileCount);
+    id streamKey = self.streamKeys[tile];
+    if ([streamKey isKindOfClass:[ByteRTCRemoteStreamKey class]]) {
+        [self.rtcVideo setRemoteVideoRender:streamKey withSink:nil withRemoteRenderConfig:[[ByteRTCRemoteVideoSinkConfig alloc] init]];
+    } else if ([streamKey isKindOfClass:[NSNumber class]]) {
+        [self.rtcVideo setLocalVideoRender:[streamKey integerValue] withSink:nil withLocalRenderConfig:[[ByteRTCLocalVideoSinkConfig alloc] init]];
+    }
+    self.streamKeys[tile] = [NSNull null];
+    [self updateTile:tile withPixelBuffer:NULL];
+}
+
+- (void)detachAllTiles {
+    for (NSUInteger i = 0; i < kRemoteGridTileCount; i++) {
+        [self detachTile:i];
+    }
+}
+
+- (void)updateTile:(NSUInteger)tile withPixelBuffer:(CVPixelBufferRef)pixelBuffer {
+    if (tile >= kRemoteGridTileCount) {
+        return;
+    }
+    if (pixelBuffer) {
+        CVPixelBufferRetain(pixelBuffer);
+    }
+    os_unfair_lock_lock(&_frameLock);
+    CVPixelBufferRef previous = _latestFrames[tile];
+    _latestFrames[tile] = pixelBuffer;
+    os_unfair_lock_unlock(&_frameLock);
+    // 在锁外释放，避免 buffer 归还时的开销落在锁内
+    if (previous) {
+        CVPixelBufferRelease(previous);
+    }
+}
+
+#pragma mark - Compose
+
+- (void)start {
+    if (self.composeTimer) {
+        return;
+    }
+    uint64_t interval = NSEC_PER_SEC / self.frameRate;
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, DISPATCH_TIMER_STRICT, self.composeQueue);
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, 0);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(timer, ^{
+        [weakSelf composeFrame];
+    });
+    self.composeTimer = timer;
+    dispatch_resume(timer);
+}
+
+- (void)stop {
+    if (self.composeTimer) {
+        dispatch_source_cancel(self.composeTimer);
+        self.composeTimer = nil;
+    }
+    // 等待正在执行与已请求的合成结束，之后不再回调
+    dispatch_sync(self.composeQueue, ^{});
+    [self.outputPool flush];
+}
+
+- (void)requestFrame {
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.composeQueue, ^{
+        [weakSelf composeFrame];
+    });
+}
+
+/// 把 I420 planar buffer 的三个平面描述为 GridI420Image，调用前需锁定 base address
+static GridI420Image RemoteGridImageWithPixelBuffer(CVPixelBufferRef pixelBuffer) {
+    GridI420Image image = {
+        .y = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0),
+        .u = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 1),
+        .v = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 2),
+        .yStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0),
+        .uStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 1),
+        .vStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 2),
+        .width = (int)CVPixelBufferGetWidth(pixelBuffer),
+        .height = (int)CVPixelBufferGetHeight(pixelBuffer),
+    };
+    return image;
+}
+
+- (void)composeFrame {
+    RemoteGridFrameHandler frameHandler = self.frameHandler;
+    if (!frameHandler) {
+        return;
+    }
+    CFTimeInterval startTime = CACurrentMediaTime();
+    CVPixelBufferRef frames[kRemoteGridTileCount];
+    os_unfair_lock_lock(&_frameLock);
+    for (NSUInteger i = 0; i < kRemoteGridTileCount; i++) {
+        frames[i] = _latestFrames[i] ? CVPixelBufferRetain(_latestFrames[i]) : NULL;
+    }
+    os_unfair_lock_unlock(&_frameLock);
+
+    CVPixelBufferRef output = [self.outputPool dequeuePixelBufferWithWidth:self.outputWidth height:self.outputHeight];
+    if (output) {
+        GridI420Image images[kRemoteGridTileCount];
+        const GridI420Image *sources[kRemoteGridTileCount];
+        for (NSUInteger i = 0; i < kRemoteGridTileCount; i++) {
+            sources[i] = NULL;
+            if (frames[i]) {
+                CVPixelBufferLockBaseAddress(frames[i], kCVPixelBufferLock_ReadOnly);
+                images[i] = RemoteGridImageWithPixelBuffer(frames[i]);
+                sources[i] = &images[i];
+            }
+        }
+        CVPixelBufferLockBaseAddress(output, 0);
+        GridI420Image canvas = RemoteGridImageWithPixelBuffer(output);
+        GridCompositorCompose(_compositor, sources, &canvas, kRemoteGridColumns, kRemoteGridRows, self.scaleMode);
+        CVPixelBufferUnlockBaseAddress(output, 0);
+        for (NSUInteger i = 0; i < kRemoteGridTileCount; i++) {
+            if (frames[i]) {
+                CVPixelBufferUnlockBaseAddress(frames[i], kCVPixelBufferLock_ReadOnly);
+            }
+        }
+    }
+    for (NSUInteger i = 0; i < kRemoteGridTileCount; i++) {
+        if (frames[i]) {
+            CVPixelBufferRelease(frames[i]);
+        }
+    }
+    if (!output) {
+        // 下游仍持有所有输出 buffer，丢弃这一帧
+        return;
+    }
+    self.lastComposeDuration = CACurrentMediaTime() - startTime;
+    self.composedFrameCount++;
+    frameHandler(output, CMClockGetTime(CMClockGetHostTimeClock()));
+    CVPixelBufferRelease(output);
+}
+
+@end
+
+@implementation RemoteGridTileSink
+
+- (void)onFrame:(ByteRTCVideoFrame *)videoFrame {
+    CVPixelBufferRef pixelBuffer = videoFrame.textureBuf;
+    if (!pixelBuffer || CVPixelBufferGetPlaneCount(pixelBuffer) != 3) {
+        return;
+    }
+    [self.compositor updateTile:self.tile withPixelBuffer:pixelBuffer];
+}
+
+@end
@@ -0,0 +1,31 @@
+//
+//  RemoteStreamArchiver.h
+//  quickstart
+//
+//  远端流本地归档：保存订阅到的远端编码视频，不经过云端录制
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "StreamArchive.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 通过 registerRemoteEncodedVideoFrameObserver: 注册后，按 ByteRTCRemoteStreamKey 把每路远端流的编码帧交给 StreamArchive。
+/// @note 需同时用 setVideoDecoderConfig:withVideoDecoderConfig: 选择 ByteRTCVideoDecoderConfigBoth，否则 SDK 不再渲染远端画面。
+///       回调线程中只拷贝数据到预分配缓冲，不分配内存、不等待磁盘；缓冲满时丢帧并计数。
+@interface RemoteStreamArchiver : NSObject <ByteRTCRemoteEncodedVideoFrameObserver>
+
+/// 创建目录并开始归档，每路流的第一个文件在收到第一帧关键帧时创建
+/// @param directory 输出目录，如 Documents/Archive/room_20240101_120000
+- (nullable instancetype)initWithDirectory:(NSString *)directory NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 写完缓冲中剩余的帧并关闭所有文件，可能等待磁盘，不要在回调线程调用
+- (void)stop;
+
+@property (nonatomic, assign, readonly) StreamArchiveStats stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
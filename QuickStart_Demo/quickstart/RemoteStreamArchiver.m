@@ -0,0 +1,74 @@
+//
+//  RemoteStreamArchiver.m
+//  quickstart
+//
+
+#import "RemoteStreamArchiver.h"
+#import "EncodedRecorder.h"
+
+@interface RemoteStreamArchiver () {
+    StreamArchive *_archive;
+}
+
+@end
+
+@implementation RemoteStreamArchiver
+
+- (nullable instancetype)initWithDirectory:(NSString *)directory {
+    self = [super init];
+    if (self) {
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+        StreamArchiveConfig config = StreamArchiveDefaultConfig(directory.fileSystemRepresentation);
+        _archive = StreamArchiveCreate(&config);
+        if (!_archive) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    StreamArchiveDestroy(_archive);
+}
+
+- (void)stop {
+    StreamArchiveStop(_archive);
+}
+
+- (StreamArchiveStats)stats {
+    StreamArchiveStats stats;
+    StreamArchiveGetStats(_archive, &stats);
+    return stats;
+}
+
+#pragma mark - ByteRTCRemoteEncodedVideoFrameObserver
+
+- (void)onRemoteEncodedVideoFrame:(ByteRTCRemoteStreamKey *)streamKey withEncodedVideoFrame:(ByteRTCEncodedVideoFrame *)videoFrame {
+    if (videoFrame.data.length == 0 || videoFrame.data.length > UINT32_MAX) {
+        return;
+    }
+    // 栈上拼流名称，不创建 NSString
+    char roomId[STREAM_ARCHIVE_NAME_MAX];
+    char userId[STREAM_ARCHIVE_NAME_MAX];
+    if (!CFStringGetCString((__bridge CFStringRef)(streamKey.roomId ?: @""), roomId, sizeof(roomId), kCFStringEncodingUTF8) ||
+        !CFStringGetCString((__bridge CFStringRef)(streamKey.userId ?: @""), userId, sizeof(userId), kCFStringEncodingUTF8)) {
+        return;
+    }
+    char name[STREAM_ARCHIVE_NAME_MAX];
+    snprintf(name, sizeof(name), "%s_%s_%s", roomId, userId,
+             streamKey.streamIndex == ByteRTCStreamIndexScreen ? "screen" : "main");
+    EncodedFrameHeader header = {
+        .ptsUs = videoFrame.timestampUs,
+        .dtsUs = videoFrame.timestampDtsUs,
+        .arrivalUs = EncodedRecorderNowUs(),
+        .size = (uint32_t)videoFrame.data.length,
+        .flags = videoFrame.pictureType == ByteRTCVideoPictureTypeI ? ENCODED_FRAME_FLAG_KEYFRAME : 0,
+        .width = (uint16_t)videoFrame.width,
+        .height = (uint16_t)videoFrame.height,
+        .rotation = (uint16_t)videoFrame.rotation,
+        .codec = videoFrame.codecType == ByteRTCVideoCodecTypeByteVC1 ? EncodedFrameCodecH265 : EncodedFrameCodecH264,
+    };
+    StreamArchivePush(_archive, name, &header, videoFrame.data.bytes);
+}
+
+@end
@@ -0,0 +1,53 @@
+//
+//  RoomStatsCollector.h
+//  quickstart
+//
+//  房间统计采集：SDK 统计回调与处理耗时写入 StatsStore，按时间窗口聚合，结束时导出
+//
+
+#import <Foundation/Foundation.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import <VolcEngineRTC/objc/ByteRTCRoom.h>
+#import "StatsStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 各 record 方法可在 SDK 回调线程与处理线程直接调用：不加锁、不分配内存，时间取自同一个单调时钟。
+/// 远端用户按 uid 区分来源，本地为 STATS_SOURCE_LOCAL。聚合与导出在内部的串行队列上执行，可在任意线程调用。
+@interface RoomStatsCollector : NSObject
+
+/// @param config 每个指标保留的行数与远端来源数，传 NULL 使用 StatsStoreDefaultConfig()
+- (nullable instancetype)initWithConfig:(nullable const StatsStoreConfig *)config NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// onSysStats：CPU 占用与内存
+- (void)recordSysStats:(const ByteRTCSysStats *)stats;
+
+/// onLocalStreamStats：主流视频的码率、帧率、丢包与 RTT，屏幕流忽略
+- (void)recordLocalStreamStats:(ByteRTCLocalStreamStats *)stats;
+
+/// onRemoteStreamStats：远端主流视频的码率、帧率、丢包、卡顿与端到端延迟，屏幕流忽略
+- (void)recordRemoteStreamStats:(ByteRTCRemoteStreamStats *)stats;
+
+/// onNetworkQuality：本地与各远端用户的上下行质量、丢包率与 RTT
+- (void)recordNetworkQuality:(ByteRTCNetworkQualityStats *)localQuality
+             remoteQualities:(NSArray<ByteRTCNetworkQualityStats *> *)remoteQualities;
+
+/// 处理线程：一帧的总耗时、渲染与跟踪耗时（秒）
+- (void)recordProcessorTotal:(CFTimeInterval)total render:(CFTimeInterval)render tracking:(CFTimeInterval)tracking;
+
+/// 最近 seconds 秒内的聚合
+/// @param userId 远端用户，nil 表示全部来源
+/// @return 窗口内没有数据时 count 为 0
+- (StatsAggregate)aggregateMetric:(StatsMetric)metric userId:(nullable NSString *)userId lastSeconds:(NSTimeInterval)seconds;
+
+/// 把当前保留的所有行导出为二进制文件并转换为 CSV，在内部队列上执行
+/// @param csvPath 为 nil 时只导出二进制文件
+/// @param completion 在内部队列上调用
+- (void)exportToPath:(NSString *)path
+             csvPath:(nullable NSString *)csvPath
+          completion:(nullable void (^)(BOOL success))completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,136 @@
+//
+//  RoomStatsCollector.m
+//  quickstart
+//
+
+#import "RoomStatsCollector.h"
+
+@interface RoomStatsCollector () {
+    StatsStore *_store;
+}
+
+/// StatsStore 只允许一个读取线程，聚合与导出都在此队列上执行
+@property (nonatomic, strong) dispatch_queue_t readQueue;
+
+@end
+
+@implementation RoomStatsCollector
+
+- (nullable instancetype)initWithConfig:(nullable const StatsStoreConfig *)config {
+    self = [super init];
+    if (self) {
+        StatsStoreConfig defaultConfig = StatsStoreDefaultConfig();
+        _store = StatsStoreCreate(config ?: &defaultConfig);
+        if (!_store) {
+            return nil;
+        }
+        _readQueue = dispatch_queue_create("com.quickstart.roomstats", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    StatsStoreDestroy(_store);
+}
+
+#pragma mark - Record
+
+/// 远端用户的来源编号，uid 拷入栈上缓冲，不分配内存
+- (uint32_t)sourceForUserId:(NSString *)userId {
+    char name[STATS_SOURCE_NAME_MAX];
+    if (!userId || !CFStringGetCString((__bridge CFStringRef)userId, name, sizeof(name), kCFStringEncodingUTF8)) {
+        return STATS_SOURCE_OTHER;
+    }
+    return StatsStoreSourceForName(_store, name);
+}
+
+- (void)recordSysStats:(const ByteRTCSysStats *)stats {
+    int64_t now = StatsStoreNowUs();
+    StatsStoreRecord(_store, StatsMetricCpuApp, STATS_SOURCE_LOCAL, now, (float)stats.cpuAppUsage);
+    StatsStoreRecord(_store, StatsMetricCpuTotal, STATS_SOURCE_LOCAL, now, (float)stats.cpuTotalUsage);
+    StatsStoreRecord(_store, StatsMetricMemoryAppMB, STATS_SOURCE_LOCAL, now, (float)stats.memoryUsage);
+    StatsStoreRecord(_store, StatsMetricMemoryFreeMB, STATS_SOURCE_LOCAL, now, (float)stats.freeMemory);
+}
+
+- (void)recordLocalStreamStats:(ByteRTCLocalStreamStats *)stats {
+    if (stats.isScreen) {
+        return;
+    }
+    ByteRTCLocalVideoStats *video = stats.videoStats;
+    int64_t now = StatsStoreNowUs();
+    StatsStoreRecord(_store, StatsMetricLocalSentKbps, STATS_SOURCE_LOCAL, now, video.sentKBitrate);
+    StatsStoreRecord(_store, StatsMetricLocalInputFps, STATS_SOURCE_LOCAL, now, (float)video.inputFrameRate);
+    StatsStoreRecord(_store, StatsMetricLocalEncoderFps, STATS_SOURCE_LOCAL, now, (float)video.encoderOutputFrameRate);
+    StatsStoreRecord(_store, StatsMetricLocalSentFps, STATS_SOURCE_LOCAL, now, (float)video.sentFrameRate);
+    StatsStoreRecord(_store, StatsMetricLocalLossRate, STATS_SOURCE_LOCAL, now, video.videoLossRate);
+    StatsStoreRecord(_store, StatsMetricLocalRttMs, STATS_SOURCE_LOCAL, now, (float)video.rtt);
+}
+
+- (void)recordRemoteStreamStats:(ByteRTCRemoteStreamStats *)stats {
+    if (stats.isScreen) {
+        return;
+    }
+    ByteRTCRemoteVideoStats *video = stats.videoStats;
+    uint32_t source = [self sourceForUserId:stats.uid];
+    int64_t now = StatsStoreNowUs();
+    StatsStoreRecord(_store, StatsMetricRemoteReceivedKbps, source, now, video.receivedKBitrate);
+    StatsStoreRecord(_store, StatsMetricRemoteDecoderFps, source, now, (float)video.decoderOutputFrameRate);
+    StatsStoreRecord(_store, StatsMetricRemoteRenderFps, source, now, (float)video.renderOutputFrameRate);
+    StatsStoreRecord(_store, StatsMetricRemoteLossRate, source, now, video.videoLossRate);
+    StatsStoreRecord(_store, StatsMetricRemoteStallCount, source, now, (float)video.stallCount);
+    StatsStoreRecord(_store, StatsMetricRemoteE2eDelayMs, source, now, (float)video.e2eDelay);
+}
+
+- (void)recordNetworkQuality:(ByteRTCNetworkQualityStats *)localQuality
+             remoteQualities:(NSArray<ByteRTCNetworkQualityStats *> *)remoteQualities {
+    int64_t now = StatsStoreNowUs();
+    [self recordNetworkQuality:localQuality source:STATS_SOURCE_LOCAL timeUs:now];
+    for (ByteRTCNetworkQualityStats *quality in remoteQualities) {
+        [self recordNetworkQuality:quality source:[self sourceForUserId:quality.uid] timeUs:now];
+    }
+}
+
+- (void)recordNetworkQuality:(ByteRTCNetworkQualityStats *)quality source:(uint32_t)source timeUs:(int64_t)timeUs {
+    StatsStoreRecord(_store, StatsMetricNetTxQuality, source, timeUs, (float)quality.txQuality);
+    StatsStoreRecord(_store, StatsMetricNetRxQuality, source, timeUs, (float)quality.rxQuality);
+    StatsStoreRecord(_store, StatsMetricNetLossRatio, source, timeUs, (float)quality.lossRatio);
+    StatsStoreRecord(_store, StatsMetricNetRttMs, source, timeUs, (float)quality.rtt);
+}
+
+- (void)recordProcessorTotal:(CFTimeInterval)total render:(CFTimeInterval)render tracking:(CFTimeInterval)tracking {
+    int64_t now = StatsStoreNowUs();
+    StatsStoreRecord(_store, StatsMetricProcessTotalMs, STATS_SOURCE_LOCAL, now, (float)(total * 1000.0));
+    StatsStoreRecord(_store, StatsMetricProcessRenderMs, STATS_SOURCE_LOCAL, now, (float)(render * 1000.0));
+    StatsStoreRecord(_store, StatsMetricProcessTrackingMs, STATS_SOURCE_LOCAL, now, (float)(tracking * 1000.0));
+}
+
+#pragma mark - Read
+
+- (StatsAggregate)aggregateMetric:(StatsMetric)metric userId:(nullable NSString *)userId lastSeconds:(NSTimeInterval)seconds {
+    __block StatsAggregate aggregate = {0};
+    uint32_t source = userId ? [self sourceForUserId:userId] : STATS_SOURCE_ANY;
+    int64_t now = StatsStoreNowUs();
+    int64_t from = now - (int64_t)(seconds * 1000000.0);
+    dispatch_sync(self.readQueue, ^{
+        StatsStoreAggregate(self->_store, metric, source, from, now + 1, &aggregate);
+    });
+    return aggregate;
+}
+
+- (void)exportToPath:(NSString *)path
+             csvPath:(nullable NSString *)csvPath
+          completion:(nullable void (^)(BOOL success))completion {
+    dispatch_async(self.readQueue, ^{
+        [[NSFileManager defaultManager] createDirectoryAtPath:[path stringByDeletingLastPathComponent]
+                                  withIntermediateDirectories:YES attributes:nil error:nil];
+        BOOL success = StatsStoreExport(self->_store, path.fileSystemRepresentation);
+        if (success && csvPath) {
+            success = StatsStoreConvertToCsv(path.fileSystemRepresentation, csvPath.fileSystemRepresentation);
+        }
+        if (completion) {
+            completion(success);
+        }
+    });
+}
+
+@end
@@ -0,0 +1,71 @@
+//
+//  RoomUserRegistry.h
+//  quickstart
+//
+//  房间远端用户表：回调线程投递事件，主线程每帧批量处理并分配可见窗口
+//
+
+#import <Foundation/Foundation.h>
+#import "UserRegistry.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class RoomUserRegistry;
+
+@protocol RoomUserRegistryDelegate <NSObject>
+
+/// 主线程：槽位上显示的用户发生变化
+/// @param userId 新的用户 ID，空串表示槽位清空
+- (void)userRegistry:(RoomUserRegistry *)registry didAssignUserId:(NSString *)userId toSlot:(NSUInteger)slot;
+
+@end
+
+/// 用户 ID 驻留在 C 哈希表中，查找、进出房间都是 O(1)，不再遍历视图比较 uid。
+/// @note post 方法可在任意线程调用，无锁、不分配内存；其余方法只在主线程调用。
+///       start 之后每个屏幕刷新周期最多处理一次积压事件，槽位变化一次性回调给 delegate。
+@interface RoomUserRegistry : NSObject
+
+- (instancetype)initWithConfig:(UserRegistryConfig)config NS_DESIGNATED_INITIALIZER;
+
+/// 使用 UserRegistryDefaultConfig
+- (instancetype)init;
+
+@property (nonatomic, weak, nullable) id<RoomUserRegistryDelegate> delegate;
+
+/// 可见槽位数
+@property (nonatomic, assign, readonly) NSUInteger slotCount;
+
+/// 房间内的远端用户数
+@property (nonatomic, assign, readonly) NSUInteger userCount;
+
+/// 事件队列已满而丢弃的事件数
+@property (nonatomic, assign, readonly) uint64_t droppedEventCount;
+
+/// 任意线程：投递进房、离房、视频开始/停止、订阅状态等事件
+- (void)postEvent:(UserRegistryEventType)type userId:(NSString *)userId;
+
+/// 任意线程：投递最近一次远端流统计
+- (void)postStats:(UserRegistryStats)stats userId:(NSString *)userId;
+
+/// 开始按屏幕刷新周期处理事件
+- (void)start;
+- (void)stop;
+
+/// 立即处理积压事件
+- (void)applyPendingEvents;
+
+- (nullable NSString *)userIdInSlot:(NSUInteger)slot;
+
+/// 用户所在槽位，不可见或不在房间时返回 NSNotFound
+- (NSUInteger)slotOfUserId:(NSString *)userId;
+
+- (BOOL)userHasVideo:(NSString *)userId;
+
+- (BOOL)getState:(UserRegistryUserState *)state forUserId:(NSString *)userId;
+
+/// 把有视频的用户放到指定槽位，原来的用户回到等待队列队首，变化通过 delegate 回调
+- (void)moveUserId:(NSString *)userId toSlot:(NSUInteger)slot;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,155 @@
+//
+//  RoomUserRegistry.m
+//  quickstart
+//
+
+#import "RoomUserRegistry.h"
+#import <QuartzCore/QuartzCore.h>
+
+/// CADisplayLink 会强引用 target，通过弱引用转发避免循环引用
+@interface RoomUserRegistryDisplayLinkProxy : NSObject
+@property (nonatomic, weak) RoomUserRegistry *registry;
+@end
+
+@interface RoomUserRegistry () {
+    UserRegistry *_registry;
+    /// 槽位变化输出缓冲区，容量为槽位数
+    UserRegistrySlotChange *_changes;
+}
+
+@property (nonatomic, strong, nullable) CADisplayLink *displayLink;
+
+@end
+
+@implementation RoomUserRegistry
+
+- (instancetype)init {
+    return [self initWithConfig:UserRegistryDefaultConfig()];
+}
+
+- (instancetype)initWithConfig:(UserRegistryConfig)config {
+    self = [super init];
+    if (self) {
+        _registry = UserRegistryCreate(&config);
+        NSParameterAssert(_registry);
+        _slotCount = config.slotCount;
+        _changes = calloc(config.slotCount, sizeof(UserRegistrySlotChange));
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_displayLink invalidate];
+    UserRegistryDestroy(_registry);
+    free(_changes);
+}
+
+/// 转成栈上的 C 字符串，避免在回调线程分配内存
+static BOOL RoomUserRegistryCopyUserId(NSString *userId, char *buffer) {
+    return userId && CFStringGetCString((__bridge CFStringRef)userId, buffer, USER_REGISTRY_MAX_ID_LENGTH + 1, kCFStringEncodingUTF8);
+}
+
+#pragma mark - Any thread
+
+- (void)postEvent:(UserRegistryEventType)type userId:(NSString *)userId {
+    char buffer[USER_REGISTRY_MAX_ID_LENGTH + 1];
+    if (RoomUserRegistryCopyUserId(userId, buffer)) {
+        UserRegistryPost(_registry, type, buffer, NULL);
+    }
+}
+
+- (void)postStats:(UserRegistryStats)stats userId:(NSString *)userId {
+    char buffer[USER_REGISTRY_MAX_ID_LENGTH + 1];
+    if (RoomUserRegistryCopyUserId(userId, buffer)) {
+        UserRegistryPost(_registry, UserRegistryEventStats, buffer, &stats);
+    }
+}
+
+- (uint64_t)droppedEventCount {
+    return UserRegistryDroppedEvents(_registry);
+}
+
+#pragma mark - Main thread
+
+- (void)start {
+    if (self.displayLink) {
+        return;
+    }
+    RoomUserRegistryDisplayLinkProxy *proxy = [[RoomUserRegistryDisplayLinkProxy alloc] init];
+    proxy.registry = self;
+    self.displayLink = [CADisplayLink displayLinkWithTarget:proxy selector:@selector(displayLinkDidFire:)];
+    [self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+- (void)stop {
+    [self.displayLink invalidate];
+    self.displayLink = nil;
+}
+
+- (void)applyPendingEvents {
+    if (!UserRegistryHasPendingEvents(_registry)) {
+        return;
+    }
+    size_t count = UserRegistryApply(_registry, _changes);
+    [self notifyChanges:count];
+}
+
+- (void)notifyChanges:(size_t)count {
+    id<RoomUserRegistryDelegate> delegate = self.delegate;
+    for (size_t i = 0; i < count; i++) {
+        [delegate userRegistry:self didAssignUserId:@(_changes[i].userId) toSlot:(NSUInteger)_changes[i].slot];
+    }
+}
+
+- (NSUInteger)userCount {
+    return UserRegistryUserCount(_registry);
+}
+
+- (uint32_t)handleOfUserId:(NSString *)userId {
+    char buffer[USER_REGISTRY_MAX_ID_LENGTH + 1];
+    if (!RoomUserRegistryCopyUserId(userId, buffer)) {
+        return USER_REGISTRY_INVALID_HANDLE;
+    }
+    return UserRegistryFind(_registry, buffer);
+}
+
+- (NSString *)userIdInSlot:(NSUInteger)slot {
+    const char *userId = UserRegistryUserId(_registry, UserRegistrySlotUser(_registry, (int)slot));
+    return userId ? @(userId) : nil;
+}
+
+- (NSUInteger)slotOfUserId:(NSString *)userId {
+    UserRegistryUserState state;
+    if (![self getState:&state forUserId:userId] || state.slot == USER_REGISTRY_NO_SLOT) {
+        return NSNotFound;
+    }
+    return (NSUInteger)state.slot;
+}
+
+- (BOOL)userHasVideo:(NSString *)userId {
+    UserRegistryUserState state;
+    return [self getState:&state forUserId:userId] && state.hasVideo;
+}
+
+- (BOOL)getState:(UserRegistryUserState *)state forUserId:(NSString *)userId {
+    return UserRegistryGetState(_registry, [self handleOfUserId:userId], state);
+}
+
+- (void)moveUserId:(NSString *)userId toSlot:(NSUInteger)slot {
+    uint32_t handle = [self handleOfUserId:userId];
+    if (handle == USER_REGISTRY_INVALID_HANDLE) {
+        return;
+    }
+    size_t count = UserRegistryAssignSlot(_registry, (int)slot, handle, _changes);
+    [self notifyChanges:count];
+}
+
+@end
+
+@implementation RoomUserRegistryDisplayLinkProxy
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink {
+    [self.registry applyPendingEvents];
+}
+
+@end
@@ -49,8 +49,17 @@
 #import <VolcEngineRTC/objc/ByteRTCRoom.h>
 #import "FUDemoManager.h"
 #import "CustomProcessor.h"
-
-@interface RoomViewController ()<ByteRTCRoomDelegate, ByteRTCVideoDelegate>
+#import "AudioPreprocessor.h"
+#import "ActiveSpeakerMonitor.h"
+#import "RoomUserRegistry.h"
+#import "LocalStreamRecorder.h"
+#import "RemoteStreamArchiver.h"
+#import "FaceLandmarkReceiver.h"
+#import "RoomStatsCollector.h"
+#import "RemoteGridCompositor.h"
+#import "SpanTracer.h"
+
+@interface RoomViewController ()<ByteRTCRoomDelegate, ByteRTCVideoDelegate, RoomUserRegistryDelegate>
 @property (nonatomic, strong) UIView *headerView;
 @property (nonatomic, strong) UIButton *switchCameraBtn;
 @property (nonatomic, strong) UILabel *roomIdLabel;
@@ -68,6 +77,28 @@
 @property (nonatomic, strong) UserLiveView *thirdRemoteView;
 
 @property (nonatomic, strong) CustomProcessor *processor;
+@property (nonatomic, strong) AudioPreprocessor *audioPreprocessor;
+@property (nonatomic, strong) ActiveSpeakerMonitor *speakerMonitor;
+/// 远端用户与可见窗口，三个远端视图对应槽位 0~2
+@property (nonatomic, strong) RoomUserRegistry *userRegistry;
+/// 远端用户通过 SEI 发来的人脸点位
+@property (nonatomic, strong) FaceLandmarkReceiver *faceLandmarkReceiver;
+/// 启动参数 -RecordLocalStream YES 时录制本地发布流
+@property (nonatomic, strong, nullable) LocalStreamRecorder *localRecorder;
+/// 启动参数 -ArchiveRemoteStreams YES 时归档订阅到的远端流
+@property (nonatomic, strong, nullable) RemoteStreamArchiver *remoteArchiver;
+/// 启动参数 -LocalSnapshotInterval <秒> 时定时截取处理后的本地画面
+@property (nonatomic, strong, nullable) NSTimer *snapshotTimer;
+/// 四个视图按 2x2 合成的画面，启动参数 -RoomGridSnapshotInterval 大于 0 时创建
+@property (nonatomic, strong, nullable) RemoteGridCompositor *gridCompositor;
+@property (nonatomic, strong, nullable) LocalSnapshotter *gridSnapshotter;
+@property (nonatomic, strong, nullable) NSTimer *gridSnapshotTimer;
+/// 启动参数 -CollectRoomStats YES 时记录 SDK 统计与处理耗时，挂断时导出到 Documents/Stats
+@property (nonatomic, strong, nullable) RoomStatsCollector *statsCollector;
+/// 定时按音量调整远端窗口
+@property (nonatomic, strong, nullable) NSTimer *speakerTimer;
+/// 上次调整后用户表是否改动过远端窗口
+@property (nonatomic, assign) BOOL remoteSlotsChanged;
 
 
 // RTC SDK 引擎
@@ -86,6 +117,7 @@
 }
 
 - (void)viewDidLoad {
+    SPAN_TRACE_SCOPE("viewDidLoad");
     [super viewDidLoad];
     
     [self buildUI];
@@ -93,6 +125,7 @@
 }
 
 - (void)buildUI{
+    SPAN_TRACE_SCOPE("buildUI");
     self.view.backgroundColor = [UIColor whiteColor];
     
     UIEdgeInsets edgeInsets = UIEdgeInsetsZero;
@@ -191,8 +224,26 @@
 #pragma mark - RTC Method
 
 - (void)initEngineAndJoinRoom{
+    SPAN_TRACE_SCOPE("initEngineAndJoinRoom");
     /// 创建引擎
-    self.rtcVideo = [ByteRTCVideo createRTCVideo:APPID delegate:self parameters:@{}];
+    {
+        SPAN_TRACE_SCOPE("createRTCVideo");
+        self.rtcVideo = [ByteRTCVideo createRTCVideo:APPID delegate:self parameters:@{}];
+    }
+    /// 启动参数 -SendFaceLandmarks YES 时把本地人脸点位随视频帧发给其他用户
+    if ([[NSUserDefaults standardUserDefaults] boolForKey:@"SendFaceLandmarks"]) {
+        self.processor.landmarkSender = [[FaceLandmarkSender alloc] initWithRTCVideo:self.rtcVideo];
+    }
+    /// 在回调线程使用之前创建
+    self.faceLandmarkReceiver = [[FaceLandmarkReceiver alloc] init];
+    /// 启动参数 -AsyncTrackFace YES 时开启 FURenderKit 内部异步人脸跟踪，用于与串行模式对比帧耗时
+    if ([[NSUserDefaults standardUserDefaults] boolForKey:@"AsyncTrackFace"]) {
+        self.processor.pipelineMode = CustomProcessorPipelineModeAsyncTrack;
+    }
+    if ([[NSUserDefaults standardUserDefaults] boolForKey:@"CollectRoomStats"]) {
+        self.statsCollector = [[RoomStatsCollector alloc] initWithConfig:NULL];
+        self.processor.statsCollector = self.statsCollector;
+    }
     /// 设置视频发布参数
     ByteRTCVideoEncoderConfig *solution = [[ByteRTCVideoEncoderConfig alloc] init];
     solution.width = 360;
@@ -205,16 +256,54 @@
     ByteRTCVideoPreprocessorConfig *config = [[ByteRTCVideoPreprocessorConfig alloc] init];
     config.requiredPixelFormat = ByteRTCVideoPixelFormatI420;
     
+    // 处理耗时超出编码帧率对应的预算时自动降低效果质量
+    [self.processor enableFrameBudgetWithFrameRate:solution.frameRate];
     [self.rtcVideo registerLocalVideoProcessor: self.processor withConfig:config];
     
     
     [self setLocalRenderView];
     /// 开启本地视频采集
-    [self.rtcVideo startVideoCapture];
+    {
+        SPAN_TRACE_SCOPE("startVideoCapture");
+        [self.rtcVideo startVideoCapture];
+    }
+
+    /// 启动参数 -AudioPreprocess YES 时对采集音频做前处理：高通、增益、软限幅、去直流
+    BOOL preprocessAudio = [[NSUserDefaults standardUserDefaults] boolForKey:@"AudioPreprocess"];
+    BOOL recordLocalStream = [[NSUserDefaults standardUserDefaults] boolForKey:@"RecordLocalStream"];
+    self.audioPreprocessor.enabled = preprocessAudio;
+    [self.rtcVideo registerAudioProcessor:self.audioPreprocessor];
+    ByteRTCAudioFormat *audioFormat = [[ByteRTCAudioFormat alloc] init];
+    audioFormat.sampleRate = ByteRTCAudioSampleRate48000;
+    audioFormat.channel = ByteRTCAudioChannelMono;
+    if (preprocessAudio || recordLocalStream) {
+        // 本地录制同样从采集音频回调取音频
+        [self.rtcVideo enableAudioProcessor:ByteRTCAudioFrameProcessorRecord audioFormat:audioFormat];
+    }
+    /// 远端音频逐路统计音量，三个远端窗口优先显示说话最响的用户
+    self.audioPreprocessor.speakerMonitor = self.speakerMonitor;
+    [self.rtcVideo enableAudioProcessor:ByteRTCAudioFrameProcessorRemoteUser audioFormat:audioFormat];
+
+    if (recordLocalStream) {
+        [self startLocalRecordingWithAudioFormat:audioFormat];
+    }
 
     /// 开启本地音频采集
     [self.rtcVideo startAudioCapture];
     
+    if ([[NSUserDefaults standardUserDefaults] boolForKey:@"ArchiveRemoteStreams"]) {
+        [self startRemoteArchiving];
+    }
+
+    NSInteger snapshotInterval = [[NSUserDefaults standardUserDefaults] integerForKey:@"LocalSnapshotInterval"];
+    if (snapshotInterval > 0) {
+        [self startLocalSnapshotsWithInterval:snapshotInterval];
+    }
+    NSInteger gridSnapshotInterval = [[NSUserDefaults standardUserDefaults] integerForKey:@"RoomGridSnapshotInterval"];
+    if (gridSnapshotInterval > 0) {
+        [self startRoomGridSnapshotsWithInterval:gridSnapshotInterval];
+    }
+
     self.rtcRoom =[self.rtcVideo createRTCRoom:self.roomID];
     [self.rtcRoom setDelegate:self];
     ByteRTCUserInfo *userInfo = [[ByteRTCUserInfo alloc] init];
@@ -225,7 +314,170 @@
     roomConfig.isAutoSubscribeAudio = true;
     roomConfig.isAutoSubscribeVideo = true;
     
-    [self.rtcRoom joinRoom:TOKEN userInfo:userInfo roomConfig:roomConfig];
+    {
+        SPAN_TRACE_SCOPE("joinRoom");
+        [self.rtcRoom joinRoom:TOKEN userInfo:userInfo roomConfig:roomConfig];
+    }
+    [self.userRegistry start];
+
+    __weak typeof(self) weakSelf = self;
+    self.speakerTimer = [NSTimer scheduledTimerWithTimeInterval:0.2 repeats:YES block:^(NSTimer * _Nonnull timer) {
+        [weakSelf assignRemoteViewsToActiveSpeakers];
+    }];
+}
+
+/// 保存编码后的本地视频与前处理后的采集音频，不重新编码
+- (void)startLocalRecordingWithAudioFormat:(ByteRTCAudioFormat *)audioFormat{
+    NSString *pathPrefix = [self sessionPathInDocumentsFolder:@"Recordings"];
+    self.localRecorder = [[LocalStreamRecorder alloc] initWithPathPrefix:pathPrefix format:EncodedMuxerFormatFmp4 audioFormat:audioFormat];
+    if (!self.localRecorder) {
+        return;
+    }
+    [self.rtcVideo registerLocalEncodedVideoFrameObserver:self.localRecorder];
+    self.audioPreprocessor.recorder = self.localRecorder;
+}
+
+- (void)stopLocalRecording{
+    if (!self.localRecorder) {
+        return;
+    }
+    [self.rtcVideo registerLocalEncodedVideoFrameObserver:nil];
+    self.audioPreprocessor.recorder = nil;
+    [self.localRecorder stop];
+    self.localRecorder = nil;
+}
+
+/// 保存订阅到的远端编码视频，SDK 照常解码渲染
+- (void)startRemoteArchiving{
+    self.remoteArchiver = [[RemoteStreamArchiver alloc] initWithDirectory:[self sessionPathInDocumentsFolder:@"Archive"]];
+    if (!self.remoteArchiver) {
+        return;
+    }
+    [self.rtcVideo registerRemoteEncodedVideoFrameObserver:self.remoteArchiver];
+    /// 房间与用户为空时对所有远端流生效
+    for (NSNumber *streamIndex in @[@(ByteRTCStreamIndexMain), @(ByteRTCStreamIndexScreen)]) {
+        ByteRTCRemoteStreamKey *streamKey = [[ByteRTCRemoteStreamKey alloc] init];
+        streamKey.streamIndex = streamIndex.integerValue;
+        [self.rtcVideo setVideoDecoderConfig:streamKey withVideoDecoderConfig:ByteRTCVideoDecoderConfigBoth];
+    }
+}
+
+- (void)stopRemoteArchiving{
+    if (!self.remoteArchiver) {
+        return;
+    }
+    [self.rtcVideo registerRemoteEncodedVideoFrameObserver:nil];
+    [self.remoteArchiver stop];
+    self.remoteArchiver = nil;
+}
+
+/// 定时截取处理后的本地画面，半分辨率 JPEG 保存到 Documents/Snapshots
+- (void)startLocalSnapshotsWithInterval:(NSInteger)interval{
+    LocalSnapshotter *snapshotter = [[LocalSnapshotter alloc] initWithConfig:NULL];
+    if (!snapshotter) {
+        return;
+    }
+    NSString *directory = [self sessionPathInDocumentsFolder:@"Snapshots"];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    /// 在编码线程写文件，不占用处理线程
+    snapshotter.snapshotHandler = ^(NSData * _Nonnull jpegData, SnapshotImage image) {
+        NSString *name = [NSString stringWithFormat:@"%06llu.jpg", image.sequence];
+        [jpegData writeToFile:[directory stringByAppendingPathComponent:name] atomically:NO];
+    };
+    self.processor.snapshotter = snapshotter;
+    self.snapshotTimer = [NSTimer scheduledTimerWithTimeInterval:interval repeats:YES block:^(NSTimer * _Nonnull timer) {
+        [snapshotter captureNextFrames:1 scale:SnapshotScaleHalf];
+    }];
+}
+
+- (void)stopLocalSnapshots{
+    [self.snapshotTimer invalidate];
+    self.snapshotTimer = nil;
+    LocalSnapshotter *snapshotter = self.processor.snapshotter;
+    self.processor.snapshotter = nil;
+    [snapshotter stop];
+}
+
+/// 定时截取四个视图的 2x2 合成画面，JPEG 保存到 Documents/GridSnapshots
+/// 本地画面取前处理后的帧，远端画面经 setRemoteVideoRender 绑定的渲染器取后处理后的帧，与视图显示一致
+- (void)startRoomGridSnapshotsWithInterval:(NSInteger)interval{
+    LocalSnapshotter *snapshotter = [[LocalSnapshotter alloc] initWithConfig:NULL];
+    if (!snapshotter) {
+        return;
+    }
+    NSString *directory = [self sessionPathInDocumentsFolder:@"GridSnapshots"];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    snapshotter.snapshotHandler = ^(NSData * _Nonnull jpegData, SnapshotImage image) {
+        NSString *name = [NSString stringWithFormat:@"%06llu.jpg", image.sequence];
+        [jpegData writeToFile:[directory stringByAppendingPathComponent:name] atomically:NO];
+    };
+    /// 与编码分辨率一致的四格；每次截图只按需合成一帧，不持续合成
+    RemoteGridCompositor *compositor = [[RemoteGridCompositor alloc] initWithRTCVideo:self.rtcVideo outputWidth:720 height:1280 frameRate:15];
+    /// 合成线程是 appendPixelBuffer: 唯一的调用线程
+    compositor.frameHandler = ^(CVPixelBufferRef pixelBuffer, CMTime time) {
+        [snapshotter appendPixelBuffer:pixelBuffer rotation:0 time:time];
+    };
+    [compositor attachLocalStream:ByteRTCStreamIndexMain toTile:0];
+    self.gridCompositor = compositor;
+    self.gridSnapshotter = snapshotter;
+    self.gridSnapshotTimer = [NSTimer scheduledTimerWithTimeInterval:interval repeats:YES block:^(NSTimer * _Nonnull timer) {
+        [snapshotter captureNextFrames:1 scale:SnapshotScaleHalf];
+        [compositor requestFrame];
+    }];
+}
+
+- (void)stopRoomGridSnapshots{
+    [self.gridSnapshotTimer invalidate];
+    self.gridSnapshotTimer = nil;
+    /// 等待已请求的合成结束，之后不再有帧交给截图
+    [self.gridCompositor stop];
+    [self.gridCompositor detachAllTiles];
+    self.gridCompositor = nil;
+    [self.gridSnapshotter stop];
+    self.gridSnapshotter = nil;
+}
+
+/// 远端窗口对应网格的第 slot + 1 格，第 0 格为本地画面
+- (void)attachGridTileForSlot:(NSUInteger)slot roomId:(NSString *)roomId uid:(NSString *)uid{
+    if (!self.gridCompositor) {
+        return;
+    }
+    if (uid.length == 0) {
+        [self.gridCompositor detachTile:slot + 1];
+        return;
+    }
+    ByteRTCRemoteStreamKey *streamKey = [[ByteRTCRemoteStreamKey alloc] init];
+    streamKey.roomId = roomId;
+    streamKey.userId = uid;
+    streamKey.streamIndex = ByteRTCStreamIndexMain;
+    [self.gridCompositor attachStreamKey:streamKey toTile:slot + 1];
+}
+
+/// Documents/<folder>/<房间号>_<开始时间>
+/// 导出二进制统计与 CSV，并打印最近一分钟的处理耗时与远端帧率
+- (void)exportRoomStats{
+    RoomStatsCollector *collector = self.statsCollector;
+    if (!collector) {
+        return;
+    }
+    /// SDK 回调线程仍可能读取 statsCollector，只停止处理耗时的记录
+    self.processor.statsCollector = nil;
+    StatsAggregate total = [collector aggregateMetric:StatsMetricProcessTotalMs userId:nil lastSeconds:60];
+    StatsAggregate renderFps = [collector aggregateMetric:StatsMetricRemoteRenderFps userId:nil lastSeconds:60];
+    NSLog(@"process total ms: mean %.2f p95 %.2f p99 %.2f max %.2f (%u frames); remote render fps: mean %.1f min %.1f",
+          total.mean, total.p95, total.p99, total.max, total.count, renderFps.mean, renderFps.min);
+    NSString *path = [[self sessionPathInDocumentsFolder:@"Stats"] stringByAppendingPathExtension:@"stats"];
+    [collector exportToPath:path csvPath:[[path stringByDeletingPathExtension] stringByAppendingPathExtension:@"csv"] completion:^(BOOL success) {
+        NSLog(@"room stats export %@: %@", success ? @"done" : @"failed", path);
+    }];
+}
+
+- (NSString *)sessionPathInDocumentsFolder:(NSString *)folder{
+    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
+    formatter.dateFormat = @"yyyyMMdd_HHmmss";
+    NSString *documents = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *name = [NSString stringWithFormat:@"%@_%@", self.roomID, [formatter stringFromDate:[NSDate date]]];
+    return [[documents stringByAppendingPathComponent:folder] stringByAppendingPathComponent:name];
 }
 
 - (void)setLocalRenderView{
@@ -252,54 +504,138 @@
     [self.rtcVideo setRemoteVideoCanvas:streamKey withCanvas:canvas];
 }
 
+/// 解除远端用户与视图的绑定
+- (void)clearRemoteView:(UserLiveView *)userLiveView roomId:(NSString*)roomId{
+    ByteRTCRemoteStreamKey *streamKey = [[ByteRTCRemoteStreamKey alloc] init];
+    streamKey.roomId = roomId;
+    streamKey.userId = userLiveView.uid;
+    streamKey.streamIndex = ByteRTCStreamIndexMain;
+    [self.rtcVideo setRemoteVideoCanvas:streamKey withCanvas:nil];
+    userLiveView.uid = @"";
+}
+
+- (NSArray<UserLiveView *> *)remoteViews{
+    return @[self.firstRemoteView, self.secondRemoteView, self.thirdRemoteView];
+}
+
+/// 远端窗口优先显示最近说话最响的用户，空窗口由用户表按视频开始的顺序补齐
+/// 排序结果没有更新、槽位也没有变化时不重新分配
+- (void)assignRemoteViewsToActiveSpeakers{
+    ActiveSpeakerRanking ranking;
+    BOOL rankingUpdated = [self.speakerMonitor copyRanking:&ranking];
+    if (!rankingUpdated && !self.remoteSlotsChanged) {
+        return;
+    }
+    self.remoteSlotsChanged = NO;
+    NSUInteger slotCount = self.userRegistry.slotCount;
+    NSMutableArray<NSString *> *slotUserIds = [NSMutableArray arrayWithCapacity:slotCount];
+    for (NSUInteger slot = 0; slot < slotCount; slot++) {
+        [slotUserIds addObject:[self.userRegistry userIdInSlot:slot] ?: @""];
+    }
+    // 只有排序结果中的少数用户需要判断是否可显示
+    NSMutableSet<NSString *> *eligibleUserIds = [NSMutableSet setWithCapacity:ranking.count];
+    for (size_t i = 0; i < ranking.count; i++) {
+        NSString *uid = @(ranking.entries[i].userId);
+        if ([self.userRegistry userHasVideo:uid]) {
+            [eligibleUserIds addObject:uid];
+        }
+    }
+    NSArray<NSString *> *previousUserIds = [slotUserIds copy];
+    if (![self.speakerMonitor assignSlots:slotUserIds ranking:&ranking eligibleUserIds:eligibleUserIds]) {
+        return;
+    }
+    for (NSUInteger slot = 0; slot < slotCount; slot++) {
+        if (slotUserIds[slot].length > 0 && ![slotUserIds[slot] isEqualToString:previousUserIds[slot]]) {
+            [self.userRegistry moveUserId:slotUserIds[slot] toSlot:slot];
+        }
+    }
+}
+
+#pragma mark - RoomUserRegistryDelegate
+- (void)userRegistry:(RoomUserRegistry *)registry didAssignUserId:(NSString *)userId toSlot:(NSUInteger)slot{
+    self.remoteSlotsChanged = YES;
+    UserLiveView *liveView = self.remoteViews[slot];
+    if ([liveView.uid isEqualToString:userId]) {
+        // 窗口已在显示该用户，不重新设置画布
+        return;
+    }
+    if (liveView.uid.length > 0) {
+        [self clearRemoteView:liveView roomId:self.roomID];
+    }
+    if (userId.length > 0) {
+        [self setupRemoteView:liveView roomId:self.roomID uid:userId];
+    }
+    // 合成网格跟随窗口，attach 会先解绑该格之前的用户
+    [self attachGridTileForSlot:slot roomId:self.roomID uid:userId];
+}
+
 #pragma mark - RTC delegate
 - (void)rtcRoom:(ByteRTCRoom *)rtcRoom onRoomError:(ByteRTCErrorCode)errorCode {
     [self showAlert:[NSString stringWithFormat:@"error: %ld",(long)errorCode]];
 }
+- (void)rtcEngine:(ByteRTCVideo *)engine onFirstLocalVideoFrameCaptured:(ByteRTCStreamIndex)streamIndex withFrameInfo:(ByteRTCVideoFrameInfo *)frameInfo {
+    if (streamIndex == ByteRTCStreamIndexMain) {
+        // 启动追踪在第一帧处理完成后导出（见 processor 的 firstFrameHandler）
+        SPAN_TRACE_INSTANT("firstLocalVideoFrameCaptured");
+    }
+}
+
 - (void)rtcEngine:(ByteRTCVideo *)engine onFirstRemoteVideoFrameDecoded:(ByteRTCRemoteStreamKey *)streamKey withFrameInfo:(ByteRTCVideoFrameInfo *)frameInfo{
     NSLog(@"%@,%s",[NSThread currentThread],__func__);
-
-    dispatch_async(dispatch_get_main_queue(), ^{
-        if ([self.firstRemoteView.uid isEqualToString:streamKey.userId]) {
-            [self setupRemoteView:self.firstRemoteView roomId:streamKey.roomId uid:streamKey.userId];
-            return;
-        }else if ([self.secondRemoteView.uid isEqualToString:streamKey.userId]) {
-            [self setupRemoteView:self.secondRemoteView roomId:streamKey.roomId uid:streamKey.userId];
-            return;
-        }else if ([self.thirdRemoteView.uid isEqualToString: streamKey.userId]) {
-            [self setupRemoteView:self.thirdRemoteView roomId:streamKey.roomId uid:streamKey.userId];
-            return;
-        }else{
-            
-        }
-        
-        if (self.firstRemoteView.uid.length == 0) {
-            [self setupRemoteView:self.firstRemoteView roomId:streamKey.roomId uid:streamKey.userId];
-        }else if (self.secondRemoteView.uid.length == 0) {
-            [self setupRemoteView:self.secondRemoteView roomId:streamKey.roomId uid:streamKey.userId];
-        }else if (self.thirdRemoteView.uid.length == 0) {
-            [self setupRemoteView:self.thirdRemoteView roomId:streamKey.roomId uid:streamKey.userId];
-        }else{
-            
-        }
-    });
+    if (streamKey.streamIndex == ByteRTCStreamIndexMain) {
+        [self.userRegistry postEvent:UserRegistryEventVideoStarted userId:streamKey.userId];
+    }
 }
 
 - (void)rtcRoom:(ByteRTCRoom *)rtcRoom onUserJoined:(ByteRTCUserInfo *)userInfo elapsed:(NSInteger)elapsed {
     NSLog(@"%@,%s",[NSThread currentThread],__func__);
-
+    [self.userRegistry postEvent:UserRegistryEventJoined userId:userInfo.userId];
+    /// 新用户从关键帧开始解码人脸点位
+    [self.processor.landmarkSender requestKeyframe];
 }
 
 - (void)rtcRoom:(ByteRTCRoom *)rtcRoom onUserLeave:(NSString *)uid reason:(ByteRTCUserOfflineReason)reason{
     NSLog(@"%@,%s",[NSThread currentThread],__func__);
-    
-    dispatch_async(dispatch_get_main_queue(), ^{
-        for (UserLiveView *liveView in self.containerView.subviews) {
-            if ([uid isEqualToString:liveView.uid]) {
-                liveView.uid = @"";
-            }
-        }
-    });
+    [self.userRegistry postEvent:UserRegistryEventLeft userId:uid];
+    [self.faceLandmarkReceiver removeUserId:uid];
+}
+
+- (void)rtcRoom:(ByteRTCRoom *)rtcRoom onUserUnpublishStream:(NSString *)userId type:(ByteRTCMediaStreamType)type reason:(ByteRTCStreamRemoveReason)reason{
+    if (type & ByteRTCMediaStreamTypeVideo) {
+        [self.userRegistry postEvent:UserRegistryEventVideoStopped userId:userId];
+    }
+}
+
+- (void)rtcEngine:(ByteRTCVideo *)engine onSEIMessageReceived:(ByteRTCRemoteStreamKey *)remoteStreamKey andMessage:(NSData *)message{
+    [self.faceLandmarkReceiver receiveSEIMessage:message fromStream:remoteStreamKey];
+}
+
+- (void)rtcRoom:(ByteRTCRoom *)rtcRoom onRemoteStreamStats:(ByteRTCRemoteStreamStats *)stats{
+    if (stats.isScreen) {
+        return;
+    }
+    UserRegistryStats registryStats = {
+        .videoKbps = stats.videoStats.receivedKBitrate,
+        .audioKbps = stats.audioStats.receivedKBitrate,
+        .videoLossRate = stats.videoStats.videoLossRate,
+        .audioLossRate = stats.audioStats.audioLossRate,
+        .frameRate = (int)stats.videoStats.renderOutputFrameRate,
+        .e2eDelayMs = (int)stats.videoStats.e2eDelay,
+    };
+    [self.userRegistry postStats:registryStats userId:stats.uid];
+    [self.statsCollector recordRemoteStreamStats:stats];
+}
+
+- (void)rtcRoom:(ByteRTCRoom *)rtcRoom onLocalStreamStats:(ByteRTCLocalStreamStats *)stats{
+    [self.statsCollector recordLocalStreamStats:stats];
+}
+
+- (void)rtcRoom:(ByteRTCRoom *)rtcRoom onNetworkQuality:(ByteRTCNetworkQualityStats *)localQuality remoteQualities:(NSArray<ByteRTCNetworkQualityStats *> *)remoteQualities{
+    [self.statsCollector recordNetworkQuality:localQuality remoteQualities:remoteQualities];
+}
+
+- (void)rtcEngine:(ByteRTCVideo *)engine onSysStats:(const ByteRTCSysStats *)stats{
+    [self.statsCollector recordSysStats:stats];
 }
 
 - (void)rtcEngine:(ByteRTCVideo *)engine onWarning:(ByteRTCWarningCode)Code {
@@ -371,11 +707,34 @@
 }
 
 - (void)hangUp:(UIButton *)button{
+    [self.speakerTimer invalidate];
+    self.speakerTimer = nil;
+    [self.userRegistry stop];
+    [self stopLocalRecording];
+    [self stopRemoteArchiving];
+    [self stopLocalSnapshots];
+    [self stopRoomGridSnapshots];
+    [self exportRoomStats];
+    self.processor.landmarkSender = nil;
     /// 离开房间
     [self.rtcRoom leaveRoom];
     
     [self dismissViewControllerAnimated:YES completion:nil];
 }
+
+#if SPAN_TRACE_ENABLED
+/// 导出从 viewDidLoad 到第一帧处理完成的启动追踪，可用 chrome://tracing 或 Perfetto 打开
+/// @note 在后台队列调用
++ (void)exportStartupTrace {
+    NSString *path = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject stringByAppendingPathComponent:@"startup_trace.json"];
+    if (SpanTraceWriteChromeTrace(path.fileSystemRepresentation)) {
+        NSLog(@"startup trace: %@", path);
+    } else {
+        NSLog(@"startup trace export failed: %@", path);
+    }
+}
+#endif
+
 #pragma mark - Getter
 
 - (UIView *)headerView{
@@ -490,8 +849,42 @@
 - (CustomProcessor *)processor{
     if(!_processor){
         _processor = [[CustomProcessor alloc] init];
+        /// 启动参数 -FaceDetectionScale 2 或 4 时关闭效果也在 1/2 或 1/4 分辨率上检测人脸，保持人脸提示可用；默认不检测
+        NSInteger detectionScale = [[NSUserDefaults standardUserDefaults] integerForKey:@"FaceDetectionScale"];
+        if (detectionScale == FaceDetectionScaleHalf || detectionScale == FaceDetectionScaleQuarter) {
+            _processor.detectionScale = (FaceDetectionScale)detectionScale;
+        }
+#if SPAN_TRACE_ENABLED
+        _processor.firstFrameHandler = ^{
+            [RoomViewController exportStartupTrace];
+        };
+#endif
     }
     return _processor;
 }
 
+- (ActiveSpeakerMonitor *)speakerMonitor{
+    if(!_speakerMonitor){
+        _speakerMonitor = [[ActiveSpeakerMonitor alloc] init];
+    }
+    return _speakerMonitor;
+}
+
+- (RoomUserRegistry *)userRegistry{
+    if(!_userRegistry){
+        UserRegistryConfig config = UserRegistryDefaultConfig();
+        config.slotCount = 3;
+        _userRegistry = [[RoomUserRegistry alloc] initWithConfig:config];
+        _userRegistry.delegate = self;
+    }
+    return _userRegistry;
+}
+
+- (AudioPreprocessor *)audioPreprocessor{
+    if(!_audioPreprocessor){
+        _audioPreprocessor = [[AudioPreprocessor alloc] init];
+    }
+    return _audioPreprocessor;
+}
+
 @end
@@ -0,0 +1,355 @@
+//
+//  SnapshotPipeline.c
+//  quickstart
+//
+
+#include "SnapshotPipeline.h"
+#include "JpegEncoder.h"
+#include "LumaDownscaler.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// 截图的最大宽度，1/4 降采样按行进行，中间结果只需两行
+#define SNAPSHOT_PIPELINE_MAX_WIDTH 4096
+
+enum {
+    SnapshotSlotFree = 0,
+    /// 已由处理线程写入，归编码线程所有
+    SnapshotSlotReady,
+};
+
+typedef struct {
+    _Atomic uint32_t state;
+    uint8_t *pixels;
+    // 以下在 state 为 Ready 时有效
+    GridI420Image image;
+    int rotation;
+    int64_t timestampUs;
+    uint64_t sequence;
+} SnapshotSlot;
+
+struct SnapshotPipeline {
+    SnapshotPipelineConfig config;
+    SnapshotPipelineCallback callback;
+    void *context;
+    SnapshotSlot *slots;
+    pthread_t thread;
+    bool threadStarted;
+    _Atomic bool accepting;
+    _Atomic bool running;
+    _Atomic uint32_t pendingFrames;
+    _Atomic uint32_t scale;
+
+    // 以下只由处理线程访问
+    uint8_t *scratch;
+    uint32_t nextSlot;
+    uint64_t nextSequence;
+
+    // 以下只由编码线程访问
+    JpegEncoder *encoder;
+    uint8_t *output;
+    size_t outputCapacity;
+
+    // 处理线程写
+    _Atomic uint64_t capturedFrames;
+    _Atomic uint64_t busyFrames;
+    _Atomic uint64_t oversizedFrames;
+    _Atomic uint64_t captureNsTotal;
+    _Atomic uint64_t captureNsMax;
+    // 编码线程写
+    _Atomic uint64_t encodedFrames;
+    _Atomic uint64_t encodedBytes;
+    _Atomic uint64_t encodeErrors;
+    _Atomic uint64_t encodeNsTotal;
+    _Atomic uint64_t encodeNsMax;
+};
+
+SnapshotPipelineConfig SnapshotPipelineDefaultConfig(void) {
+    SnapshotPipelineConfig config = {
+        .maxPixels = 1280 * 720,
+        .slotCount = 3,
+        .quality = 80,
+        .videoRange = true,
+        .pollIntervalMs = 10,
+    };
+    return config;
+}
+
+static inline uint64_t SnapshotPipelineNowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static inline void SnapshotPipelineCounterAdd(_Atomic uint64_t *counter, uint64_t value) {
+    // 每个计数器只有一个线程写
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static inline void SnapshotPipelineCounterMax(_Atomic uint64_t *counter, uint64_t value) {
+    if (value > atomic_load_explicit(counter, memory_order_relaxed)) {
+        atomic_store_explicit(counter, value, memory_order_relaxed);
+    }
+}
+
+// Capture
+
+/// 拷贝或降采样一个平面，width、height 为输出尺寸
+static void SnapshotCopyPlane(const uint8_t *src, size_t srcStride, int width, int height, uint8_t *dst,
+                              size_t dstStride, SnapshotScale scale, uint8_t *scratch) {
+    switch (scale) {
+        case SnapshotScaleFull:
+            for (int y = 0; y < height; y++) {
+                memcpy(dst + (size_t)y * dstStride, src + (size_t)y * srcStride, (size_t)width);
+            }
+            break;
+        case SnapshotScaleHalf:
+            LumaDownscaleHalf(src, srcStride, (size_t)width * 2, (size_t)height * 2, dst, dstStride);
+            break;
+        case SnapshotScaleQuarter:
+            // 每 4 行源数据先降到 2 行，再降到 1 行；与 LumaDownscaleQuarter 逐字节一致
+            for (int y = 0; y < height; y++) {
+                LumaDownscaleHalf(src + (size_t)y * 4 * srcStride, srcStride, (size_t)width * 4, 4, scratch,
+                                  (size_t)width * 2);
+                LumaDownscaleHalf(scratch, (size_t)width * 2, (size_t)width * 2, 2, dst + (size_t)y * dstStride,
+                                  dstStride);
+            }
+            break;
+    }
+}
+
+/// 从 scale 开始加大降采样倍数，直到输出不超过 maxPixels
+/// @return 输出宽度，放不下时返回 0
+static int SnapshotFitScale(const SnapshotPipeline *pipeline, const GridI420Image *frame, SnapshotScale *scale,
+                            int *height) {
+    for (int shift = (int)*scale; shift <= SnapshotScaleQuarter; shift++) {
+        int outWidth = (frame->width >> shift) & ~1;
+        int outHeight = (frame->height >> shift) & ~1;
+        if (outWidth < 2 || outHeight < 2) {
+            return 0;
+        }
+        size_t pixels = (size_t)outWidth * (size_t)outHeight;
+        if (outWidth <= SNAPSHOT_PIPELINE_MAX_WIDTH && pixels <= pipeline->config.maxPixels) {
+            *scale = (SnapshotScale)shift;
+            *height = outHeight;
+            return outWidth;
+        }
+    }
+    return 0;
+}
+
+bool SnapshotPipelineWantsFrame(const SnapshotPipeline *pipeline) {
+    return atomic_load_explicit(&pipeline->pendingFrames, memory_order_relaxed) > 0;
+}
+
+bool SnapshotPipelineCapture(SnapshotPipeline *pipeline, const GridI420Image *frame, int rotation,
+                             int64_t timestampUs) {
+    if (!SnapshotPipelineWantsFrame(pipeline) || !atomic_load_explicit(&pipeline->accepting, memory_order_acquire)) {
+        return false;
+    }
+    uint64_t start = SnapshotPipelineNowNs();
+    SnapshotScale scale = (SnapshotScale)atomic_load_explicit(&pipeline->scale, memory_order_relaxed);
+    int height = 0;
+    int width = SnapshotFitScale(pipeline, frame, &scale, &height);
+    if (width == 0) {
+        // 同一尺寸的帧总是放不下，放弃这一次请求
+        atomic_fetch_sub_explicit(&pipeline->pendingFrames, 1, memory_order_relaxed);
+        SnapshotPipelineCounterAdd(&pipeline->oversizedFrames, 1);
+        return false;
+    }
+    SnapshotSlot *slot = NULL;
+    for (uint32_t i = 0; i < pipeline->config.slotCount; i++) {
+        SnapshotSlot *candidate = &pipeline->slots[(pipeline->nextSlot + i) % pipeline->config.slotCount];
+        if (atomic_load_explicit(&candidate->state, memory_order_acquire) == SnapshotSlotFree) {
+            slot = candidate;
+            pipeline->nextSlot = (pipeline->nextSlot + i + 1) % pipeline->config.slotCount;
+            break;
+        }
+    }
+    if (!slot) {
+        SnapshotPipelineCounterAdd(&pipeline->busyFrames, 1);
+        return false;
+    }
+
+    GridI420Image *image = &slot->image;
+    image->width = width;
+    image->height = height;
+    image->yStride = (size_t)width;
+    image->uStride = (size_t)width / 2;
+    image->vStride = (size_t)width / 2;
+    image->y = slot->pixels;
+    image->u = image->y + (size_t)width * height;
+    image->v = image->u + (size_t)(width / 2) * (height / 2);
+    SnapshotCopyPlane(frame->y, frame->yStride, width, height, image->y, image->yStride, scale, pipeline->scratch);
+    SnapshotCopyPlane(frame->u, frame->uStride, width / 2, height / 2, image->u, image->uStride, scale,
+                      pipeline->scratch);
+    SnapshotCopyPlane(frame->v, frame->vStride, width / 2, height / 2, image->v, image->vStride, scale,
+                      pipeline->scratch);
+    slot->rotation = rotation;
+    slot->timestampUs = timestampUs;
+    slot->sequence = pipeline->nextSequence++;
+    atomic_store_explicit(&slot->state, SnapshotSlotReady, memory_order_release);
+    atomic_fetch_sub_explicit(&pipeline->pendingFrames, 1, memory_order_relaxed);
+
+    uint64_t elapsed = SnapshotPipelineNowNs() - start;
+    SnapshotPipelineCounterAdd(&pipeline->capturedFrames, 1);
+    SnapshotPipelineCounterAdd(&pipeline->captureNsTotal, elapsed);
+    SnapshotPipelineCounterMax(&pipeline->captureNsMax, elapsed);
+    return true;
+}
+
+// Encoder thread
+
+/// 按截取顺序编码所有已写入的槽位
+static void SnapshotPipelineDrain(SnapshotPipeline *pipeline) {
+    for (;;) {
+        SnapshotSlot *slot = NULL;
+        for (uint32_t i = 0; i < pipeline->config.slotCount; i++) {
+            SnapshotSlot *candidate = &pipeline->slots[i];
+            if (atomic_load_explicit(&candidate->state, memory_order_acquire) == SnapshotSlotReady &&
+                (!slot || candidate->sequence < slot->sequence)) {
+                slot = candidate;
+            }
+        }
+        if (!slot) {
+            return;
+        }
+        uint64_t start = SnapshotPipelineNowNs();
+        size_t size = JpegEncoderEncodeI420(pipeline->encoder, &slot->image, pipeline->config.videoRange,
+                                            pipeline->output, pipeline->outputCapacity);
+        uint64_t elapsed = SnapshotPipelineNowNs() - start;
+        SnapshotPipelineCounterAdd(&pipeline->encodeNsTotal, elapsed);
+        SnapshotPipelineCounterMax(&pipeline->encodeNsMax, elapsed);
+        if (size == 0) {
+            SnapshotPipelineCounterAdd(&pipeline->encodeErrors, 1);
+        } else {
+            SnapshotImage result = {
+                .data = pipeline->output,
+                .size = size,
+                .width = slot->image.width,
+                .height = slot->image.height,
+                .rotation = slot->rotation,
+                .timestampUs = slot->timestampUs,
+                .sequence = slot->sequence,
+            };
+            SnapshotPipelineCounterAdd(&pipeline->encodedFrames, 1);
+            SnapshotPipelineCounterAdd(&pipeline->encodedBytes, size);
+            pipeline->callback(pipeline->context, &result);
+        }
+        atomic_store_explicit(&slot->state, SnapshotSlotFree, memory_order_release);
+    }
+}
+
+static void *SnapshotPipelineThread(void *context) {
+    SnapshotPipeline *pipeline = context;
+    struct timespec interval = {
+        .tv_sec = pipeline->config.pollIntervalMs / 1000,
+        .tv_nsec = (long)(pipeline->config.pollIntervalMs % 1000) * 1000000,
+    };
+    while (atomic_load_explicit(&pipeline->running, memory_order_acquire)) {
+        SnapshotPipelineDrain(pipeline);
+        nanosleep(&interval, NULL);
+    }
+    SnapshotPipelineDrain(pipeline);
+    return NULL;
+}
+
+// Public
+
+SnapshotPipeline *SnapshotPipelineCreate(const SnapshotPipelineConfig *config, SnapshotPipelineCallback callback,
+                                         void *context) {
+    if (!config || !callback || config->maxPixels < 4 || config->slotCount == 0 || config->pollIntervalMs == 0 ||
+        config->quality < 1 || config->quality > 100) {
+        return NULL;
+    }
+    SnapshotPipeline *pipeline = calloc(1, sizeof(SnapshotPipeline));
+    if (!pipeline) {
+        return NULL;
+    }
+    pipeline->config = *config;
+    pipeline->callback = callback;
+    pipeline->context = context;
+    pipeline->slots = calloc(config->slotCount, sizeof(SnapshotSlot));
+    pipeline->scratch = malloc(SNAPSHOT_PIPELINE_MAX_WIDTH * 4);
+    pipeline->encoder = JpegEncoderCreate(config->quality);
+    if (!pipeline->slots || !pipeline->scratch || !pipeline->encoder) {
+        SnapshotPipelineDestroy(pipeline);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < config->slotCount; i++) {
+        atomic_init(&pipeline->slots[i].state, SnapshotSlotFree);
+        pipeline->slots[i].pixels = malloc(config->maxPixels * 3 / 2);
+        if (!pipeline->slots[i].pixels) {
+            SnapshotPipelineDestroy(pipeline);
+            return NULL;
+        }
+        // 提前触发缺页，第一次截取的耗时与之后一致
+        memset(pipeline->slots[i].pixels, 0, config->maxPixels * 3 / 2);
+    }
+    pipeline->outputCapacity = JpegEncoderSuggestedCapacity(config->maxPixels);
+    pipeline->output = malloc(pipeline->outputCapacity);
+    if (!pipeline->output) {
+        SnapshotPipelineDestroy(pipeline);
+        return NULL;
+    }
+    atomic_init(&pipeline->pendingFrames, 0);
+    atomic_init(&pipeline->scale, SnapshotScaleFull);
+    atomic_init(&pipeline->accepting, true);
+    atomic_init(&pipeline->running, true);
+    if (pthread_create(&pipeline->thread, NULL, SnapshotPipelineThread, pipeline) != 0) {
+        SnapshotPipelineDestroy(pipeline);
+        return NULL;
+    }
+    pipeline->threadStarted = true;
+    return pipeline;
+}
+
+void SnapshotPipelineStop(SnapshotPipeline *pipeline) {
+    atomic_store_explicit(&pipeline->accepting, false, memory_order_release);
+    if (atomic_exchange_explicit(&pipeline->running, false, memory_order_acq_rel) && pipeline->threadStarted) {
+        pthread_join(pipeline->thread, NULL);
+    }
+}
+
+void SnapshotPipelineDestroy(SnapshotPipeline *pipeline) {
+    if (!pipeline) {
+        return;
+    }
+    SnapshotPipelineStop(pipeline);
+    if (pipeline->slots) {
+        for (uint32_t i = 0; i < pipeline->config.slotCount; i++) {
+            free(pipeline->slots[i].pixels);
+        }
+    }
+    free(pipeline->slots);
+    free(pipeline->scratch);
+    free(pipeline->output);
+    JpegEncoderDestroy(pipeline->encoder);
+    free(pipeline);
+}
+
+void SnapshotPipelineRequest(SnapshotPipeline *pipeline, uint32_t frameCount, SnapshotScale scale) {
+    if (frameCount == 0 || scale > SnapshotScaleQuarter) {
+        return;
+    }
+    atomic_store_explicit(&pipeline->scale, (uint32_t)scale, memory_order_relaxed);
+    atomic_fetch_add_explicit(&pipeline->pendingFrames, frameCount, memory_order_relaxed);
+}
+
+void SnapshotPipelineGetStats(const SnapshotPipeline *pipeline, SnapshotPipelineStats *stats) {
+    stats->capturedFrames = atomic_load_explicit(&pipeline->capturedFrames, memory_order_relaxed);
+    stats->busyFrames = atomic_load_explicit(&pipeline->busyFrames, memory_order_relaxed);
+    stats->oversizedFrames = atomic_load_explicit(&pipeline->oversizedFrames, memory_order_relaxed);
+    stats->encodedFrames = atomic_load_explicit(&pipeline->encodedFrames, memory_order_relaxed);
+    stats->encodedBytes = atomic_load_explicit(&pipeline->encodedBytes, memory_order_relaxed);
+    stats->encodeErrors = atomic_load_explicit(&pipeline->encodeErrors, memory_order_relaxed);
+    stats->captureNsTotal = atomic_load_explicit(&pipeline->captureNsTotal, memory_order_relaxed);
+    stats->captureNsMax = atomic_load_explicit(&pipeline->captureNsMax, memory_order_relaxed);
+    stats->encodeNsTotal = atomic_load_explicit(&pipeline->encodeNsTotal, memory_order_relaxed);
+    stats->encodeNsMax = atomic_load_explicit(&pipeline->encodeNsMax, memory_order_relaxed);
+    stats->pendingFrames = atomic_load_explicit(&pipeline->pendingFrames, memory_order_relaxed);
+}
@@ -0,0 +1,106 @@
+//
+//  SnapshotPipeline.h
+//  quickstart
+//
+//  本地画面截图：处理线程把接下来的若干帧拷入预分配槽位（可同时降采样），后台线程编码 JPEG 并回调
+//
+
+#ifndef SnapshotPipeline_h
+#define SnapshotPipeline_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "GridCompositor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SnapshotScaleFull = 0,
+    /// 2x2 box 降采样到 1/2
+    SnapshotScaleHalf,
+    /// 连续两次 2x2 box 降采样到 1/4
+    SnapshotScaleQuarter,
+} SnapshotScale;
+
+typedef struct {
+    /// 截图的最大像素数（降采样之后），槽位与编码缓冲按此预分配；超出时自动加大降采样倍数
+    size_t maxPixels;
+    /// 槽位数，编码跟不上时新帧顺延到之后的帧
+    uint32_t slotCount;
+    /// JPEG 质量 1～100
+    int quality;
+    /// 输入为 video range，RTC 采集帧通常如此
+    bool videoRange;
+    /// 编码线程检查槽位的间隔（毫秒）
+    uint32_t pollIntervalMs;
+} SnapshotPipelineConfig;
+
+/// 默认配置：最大 1280x720，3 个槽位，质量 80，video range，每 10ms 检查一次
+SnapshotPipelineConfig SnapshotPipelineDefaultConfig(void);
+
+typedef struct {
+    /// JPEG 文件数据，只在回调期间有效
+    const uint8_t *data;
+    size_t size;
+    int width;
+    int height;
+    /// 源帧的顺时针旋转角度，JPEG 中未旋转
+    int rotation;
+    int64_t timestampUs;
+    /// 截取顺序，从 0 开始
+    uint64_t sequence;
+} SnapshotImage;
+
+/// 在编码线程调用
+typedef void (*SnapshotPipelineCallback)(void *context, const SnapshotImage *image);
+
+/// 计数器，可在任意线程读取
+typedef struct {
+    uint64_t capturedFrames;
+    uint64_t busyFrames;            // 槽位全部占用、顺延到下一帧的次数
+    uint64_t oversizedFrames;       // 降采样到 1/4 仍超出 maxPixels 而放弃的帧数
+    uint64_t encodedFrames;
+    uint64_t encodedBytes;
+    uint64_t encodeErrors;
+    uint64_t captureNsTotal;        // 处理线程上拷贝与降采样的耗时
+    uint64_t captureNsMax;
+    uint64_t encodeNsTotal;
+    uint64_t encodeNsMax;
+    uint32_t pendingFrames;         // 已请求、尚未截取的帧数
+} SnapshotPipelineStats;
+
+typedef struct SnapshotPipeline SnapshotPipeline;
+
+/// 分配槽位与编码缓冲并启动编码线程
+SnapshotPipeline *SnapshotPipelineCreate(const SnapshotPipelineConfig *config, SnapshotPipelineCallback callback,
+                                         void *context);
+
+/// 停止并释放
+void SnapshotPipelineDestroy(SnapshotPipeline *pipeline);
+
+/// 请求截取接下来的 frameCount 帧，可在任意线程调用；与之前未完成的请求累加，降采样倍数以最后一次为准
+void SnapshotPipelineRequest(SnapshotPipeline *pipeline, uint32_t frameCount, SnapshotScale scale);
+
+/// 是否有待截取的帧，只读一个原子变量；为 false 时无需准备图像数据
+bool SnapshotPipelineWantsFrame(const SnapshotPipeline *pipeline);
+
+/// 处理线程：有待截取的帧时拷贝一帧，只在同一个线程调用
+/// @note 不分配内存、不加锁、不等待编码；拷贝量不超过 maxPixels * 3 / 2 字节，降采样时读取源图相应区域
+/// @return 截取了该帧时返回 true
+bool SnapshotPipelineCapture(SnapshotPipeline *pipeline, const GridI420Image *frame, int rotation,
+                             int64_t timestampUs);
+
+/// 编码完已截取的帧并结束编码线程，之后不再截取
+void SnapshotPipelineStop(SnapshotPipeline *pipeline);
+
+void SnapshotPipelineGetStats(const SnapshotPipeline *pipeline, SnapshotPipelineStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SnapshotPipeline_h */
@@ -0,0 +1,148 @@
+//
+//  SpanTracer.c
+//  quickstart
+//
+
+#include "SpanTracer.h"
+
+#if SPAN_TRACE_ENABLED
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    const char *name;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint64_t threadId;
+    char phase;
+    /// 事件写完后置位，导出时跳过未写完的事件
+    _Atomic bool committed;
+} SpanTraceEvent;
+
+static SpanTraceEvent events[SPAN_TRACE_MAX_EVENTS];
+static _Atomic size_t eventCount;
+
+static uint64_t SpanTraceNowNs(void) {
+#if defined(__APPLE__)
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static uint64_t SpanTraceThreadId(void) {
+#if defined(__APPLE__)
+    uint64_t threadId = 0;
+    pthread_threadid_np(NULL, &threadId);
+    return threadId;
+#else
+    return (uint64_t)syscall(SYS_gettid);
+#endif
+}
+
+static void SpanTraceRecord(const char *name, char phase, uint64_t startNs, uint64_t durationNs) {
+    size_t index = atomic_fetch_add_explicit(&eventCount, 1, memory_order_relaxed);
+    if (index >= SPAN_TRACE_MAX_EVENTS) {
+        return;
+    }
+    SpanTraceEvent *event = &events[index];
+    event->name = name;
+    event->startNs = startNs;
+    event->durationNs = durationNs;
+    event->threadId = SpanTraceThreadId();
+    event->phase = phase;
+    atomic_store_explicit(&event->committed, true, memory_order_release);
+}
+
+SpanTraceScope SpanTraceBegin(const char *name) {
+    SpanTraceScope scope = {name, SpanTraceNowNs()};
+    return scope;
+}
+
+void SpanTraceEnd(SpanTraceScope *scope) {
+    if (!scope->name) {
+        return;
+    }
+    uint64_t endNs = SpanTraceNowNs();
+    SpanTraceRecord(scope->name, 'X', scope->startNs, endNs - scope->startNs);
+    // 防止重复结束
+    scope->name = NULL;
+}
+
+void SpanTraceInstant(const char *name) {
+    SpanTraceRecord(name, 'i', SpanTraceNowNs(), 0);
+}
+
+size_t SpanTraceEventCount(void) {
+    size_t count = atomic_load_explicit(&eventCount, memory_order_relaxed);
+    return count < SPAN_TRACE_MAX_EVENTS ? count : SPAN_TRACE_MAX_EVENTS;
+}
+
+void SpanTraceReset(void) {
+    size_t count = SpanTraceEventCount();
+    for (size_t i = 0; i < count; i++) {
+        atomic_store_explicit(&events[i].committed, false, memory_order_relaxed);
+    }
+    atomic_store_explicit(&eventCount, 0, memory_order_release);
+}
+
+/// 写入 JSON 字符串，转义引号、反斜杠与控制字符
+static void SpanTraceWriteJSONString(FILE *file, const char *string) {
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *)string; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if (*c < 0x20) {
+            fprintf(file, "\\u%04x", *c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool SpanTraceWriteChromeTrace(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+    size_t count = SpanTraceEventCount();
+    bool first = true;
+    for (size_t i = 0; i < count; i++) {
+        const SpanTraceEvent *event = &events[i];
+        if (!atomic_load_explicit(&event->committed, memory_order_acquire)) {
+            continue;
+        }
+        fputs(first ? "\n" : ",\n", file);
+        first = false;
+        // Chrome trace 时间单位为微秒
+        fputs("{\"name\":", file);
+        SpanTraceWriteJSONString(file, event->name);
+        fprintf(file, ",\"cat\":\"startup\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%llu",
+                event->phase, event->startNs / 1000.0, (unsigned long long)event->threadId);
+        if (event->phase == 'X') {
+            fprintf(file, ",\"dur\":%.3f", event->durationNs / 1000.0);
+        } else {
+            fputs(",\"s\":\"t\"", file);
+        }
+        fputc('}', file);
+    }
+    fputs("\n]}\n", file);
+    bool success = ferror(file) == 0;
+    return fclose(file) == 0 && success;
+}
+
+#endif
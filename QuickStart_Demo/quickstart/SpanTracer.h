@@ -0,0 +1,78 @@
+//
+//  SpanTracer.h
+//  quickstart
+//
+//  启动关键路径耗时追踪
+//
+
+#ifndef SpanTracer_h
+#define SpanTracer_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// DEBUG 下默认开启；Release 下整体编译掉，需要时在编译参数中定义 SPAN_TRACE_ENABLED=1
+#ifndef SPAN_TRACE_ENABLED
+#  if defined(DEBUG) && DEBUG
+#    define SPAN_TRACE_ENABLED 1
+#  else
+#    define SPAN_TRACE_ENABLED 0
+#  endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 最多记录的事件数，超出后丢弃
+#define SPAN_TRACE_MAX_EVENTS 4096
+
+/// 进行中的区间
+typedef struct {
+    /// 名称必须是常量字符串，记录时不拷贝
+    const char *name;
+    uint64_t startNs;
+} SpanTraceScope;
+
+#if SPAN_TRACE_ENABLED
+
+/// 开始一个区间，使用单调时钟
+SpanTraceScope SpanTraceBegin(const char *name);
+
+/// 结束区间，记录为一个 Chrome trace 完整事件（ph = "X"），嵌套关系由时间包含体现
+void SpanTraceEnd(SpanTraceScope *scope);
+
+/// 记录瞬时事件（ph = "i"）
+void SpanTraceInstant(const char *name);
+
+/// 已记录的事件数
+size_t SpanTraceEventCount(void);
+
+/// 清空已记录的事件（不能与记录并发调用）
+void SpanTraceReset(void);
+
+/// 导出为 Chrome trace event JSON（chrome://tracing、Perfetto 可直接打开），可与记录并发调用
+/// @return 写入失败时返回 false
+bool SpanTraceWriteChromeTrace(const char *path);
+
+#define SPAN_TRACE_CONCAT_(a, b) a##b
+#define SPAN_TRACE_CONCAT(a, b) SPAN_TRACE_CONCAT_(a, b)
+
+/// 记录当前作用域，离开作用域时自动结束
+#define SPAN_TRACE_SCOPE(name) \
+    SpanTraceScope SPAN_TRACE_CONCAT(_spanTraceScope, __LINE__) __attribute__((cleanup(SpanTraceEnd), unused)) = SpanTraceBegin(name)
+#define SPAN_TRACE_INSTANT(name) SpanTraceInstant(name)
+
+#else
+
+#define SPAN_TRACE_SCOPE(name) do {} while (0)
+#define SPAN_TRACE_INSTANT(name) do {} while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SpanTracer_h */
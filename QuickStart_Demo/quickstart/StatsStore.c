@@ -0,0 +1,478 @@
+//
+//  StatsStore.c
+//  quickstart
+//
+
+#include "StatsStore.h"
+
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *const StatsMetricNames[StatsMetricCount] = {
+    "cpu_app",
+    "cpu_total",
+    "memory_app_mb",
+    "memory_free_mb",
+    "local_sent_kbps",
+    "local_input_fps",
+    "local_encoder_fps",
+    "local_sent_fps",
+    "local_loss_rate",
+    "local_rtt_ms",
+    "remote_received_kbps",
+    "remote_decoder_fps",
+    "remote_render_fps",
+    "remote_loss_rate",
+    "remote_stall_count",
+    "remote_e2e_delay_ms",
+    "net_tx_quality",
+    "net_rx_quality",
+    "net_loss_ratio",
+    "net_rtt_ms",
+    "process_total_ms",
+    "process_render_ms",
+    "process_tracking_ms",
+};
+
+enum {
+    StatsSourceFree = 0,
+    StatsSourceClaiming,
+    StatsSourceReady,
+};
+
+typedef struct {
+    _Atomic uint32_t state;
+    uint32_t hash;
+    char name[STATS_SOURCE_NAME_MAX];
+} StatsSource;
+
+/// 一个指标的列：行 i 的序号为 2 * i + 1 表示正在写，2 * i + 2 表示已写完
+typedef struct {
+    _Alignas(64) _Atomic uint64_t head;
+    _Atomic uint64_t *sequences;
+    _Atomic int64_t *times;
+    _Atomic float *values;
+    _Atomic uint32_t *sources;
+} StatsSeries;
+
+struct StatsStore {
+    StatsStoreConfig config;
+    uint64_t mask;
+    int64_t monotonicToUnixUs;
+    StatsSeries *series;
+    StatsSource *sourceTable;
+
+    // 以下只由读取线程访问
+    int64_t *readTimes;
+    float *readValues;
+    uint32_t *readSources;
+};
+
+const char *StatsMetricName(StatsMetric metric) {
+    return metric < StatsMetricCount ? StatsMetricNames[metric] : "unknown";
+}
+
+StatsStoreConfig StatsStoreDefaultConfig(void) {
+    StatsStoreConfig config = {
+        .rowsPerMetric = 4096,
+        .maxSources = 32,
+    };
+    return config;
+}
+
+int64_t StatsStoreNowUs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// Create
+
+StatsStore *StatsStoreCreate(const StatsStoreConfig *config) {
+    if (!config || config->rowsPerMetric == 0 || config->rowsPerMetric > (1u << 24) || config->maxSources == 0 ||
+        config->maxSources >= STATS_SOURCE_OTHER) {
+        return NULL;
+    }
+    StatsStore *store = calloc(1, sizeof(StatsStore));
+    if (!store) {
+        return NULL;
+    }
+    store->config = *config;
+    uint32_t rows = 1;
+    while (rows < config->rowsPerMetric) {
+        rows <<= 1;
+    }
+    store->config.rowsPerMetric = rows;
+    store->mask = rows - 1;
+
+    struct timespec unixNow;
+    clock_gettime(CLOCK_REALTIME, &unixNow);
+    store->monotonicToUnixUs = (int64_t)unixNow.tv_sec * 1000000 + unixNow.tv_nsec / 1000 - StatsStoreNowUs();
+
+    void *series = NULL;
+    if (posix_memalign(&series, 64, sizeof(StatsSeries) * StatsMetricCount) != 0) {
+        free(store);
+        return NULL;
+    }
+    memset(series, 0, sizeof(StatsSeries) * StatsMetricCount);
+    store->series = series;
+    for (int metric = 0; metric < StatsMetricCount; metric++) {
+        StatsSeries *s = &store->series[metric];
+        atomic_init(&s->head, 0);
+        s->sequences = calloc(rows, sizeof(*s->sequences));
+        s->times = calloc(rows, sizeof(*s->times));
+        s->values = calloc(rows, sizeof(*s->values));
+        s->sources = calloc(rows, sizeof(*s->sources));
+        if (!s->sequences || !s->times || !s->values || !s->sources) {
+            StatsStoreDestroy(store);
+            return NULL;
+        }
+    }
+    store->sourceTable = calloc(config->maxSources, sizeof(StatsSource));
+    store->readTimes = malloc(sizeof(int64_t) * rows);
+    store->readValues = malloc(sizeof(float) * rows);
+    store->readSources = malloc(sizeof(uint32_t) * rows);
+    if (!store->sourceTable || !store->readTimes || !store->readValues || !store->readSources) {
+        StatsStoreDestroy(store);
+        return NULL;
+    }
+    return store;
+}
+
+void StatsStoreDestroy(StatsStore *store) {
+    if (!store) {
+        return;
+    }
+    if (store->series) {
+        for (int metric = 0; metric < StatsMetricCount; metric++) {
+            StatsSeries *s = &store->series[metric];
+            free(s->sequences);
+            free(s->times);
+            free(s->values);
+            free(s->sources);
+        }
+    }
+    free(store->series);
+    free(store->sourceTable);
+    free(store->readTimes);
+    free(store->readValues);
+    free(store->readSources);
+    free(store);
+}
+
+// Sources
+
+static uint32_t StatsSourceHash(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t StatsStoreSourceForName(StatsStore *store, const char *name) {
+    char truncated[STATS_SOURCE_NAME_MAX];
+    snprintf(truncated, sizeof(truncated), "%s", name);
+    uint32_t hash = StatsSourceHash(truncated);
+    // 名称按出现顺序占用第一个空位，同时登记同一名称的线程在同一个空位上相遇，不会重复占用
+    for (uint32_t i = 0; i < store->config.maxSources; i++) {
+        StatsSource *entry = &store->sourceTable[i];
+        uint32_t state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        if (state == StatsSourceFree) {
+            uint32_t expected = StatsSourceFree;
+            if (atomic_compare_exchange_strong_explicit(&entry->state, &expected, StatsSourceClaiming,
+                                                        memory_order_acquire, memory_order_acquire)) {
+                entry->hash = hash;
+                memcpy(entry->name, truncated, sizeof(truncated));
+                atomic_store_explicit(&entry->state, StatsSourceReady, memory_order_release);
+                return i + 1;
+            }
+            state = expected;
+        }
+        while (state == StatsSourceClaiming) {
+            sched_yield();
+            state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        }
+        if (entry->hash == hash && strcmp(entry->name, truncated) == 0) {
+            return i + 1;
+        }
+    }
+    return STATS_SOURCE_OTHER;
+}
+
+// Write
+
+void StatsStoreRecord(StatsStore *store, StatsMetric metric, uint32_t source, int64_t timeUs, float value) {
+    if (metric >= StatsMetricCount) {
+        return;
+    }
+    StatsSeries *s = &store->series[metric];
+    uint64_t index = atomic_fetch_add_explicit(&s->head, 1, memory_order_relaxed);
+    uint64_t slot = index & store->mask;
+    atomic_store_explicit(&s->sequences[slot], 2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&s->times[slot], timeUs, memory_order_relaxed);
+    atomic_store_explicit(&s->values[slot], value, memory_order_relaxed);
+    atomic_store_explicit(&s->sources[slot], source, memory_order_relaxed);
+    atomic_store_explicit(&s->sequences[slot], 2 * index + 2, memory_order_release);
+}
+
+uint64_t StatsStoreRecordedRows(const StatsStore *store, StatsMetric metric) {
+    if (metric >= StatsMetricCount) {
+        return 0;
+    }
+    return atomic_load_explicit(&store->series[metric].head, memory_order_relaxed);
+}
+
+// Read
+
+/// 把仍保留、已写完且落在窗口内的行读到 read 缓冲，正在写或读取期间被覆盖的行跳过
+static size_t StatsStoreCollect(StatsStore *store, StatsMetric metric, uint32_t source, int64_t fromUs,
+                                int64_t toUs) {
+    StatsSeries *s = &store->series[metric];
+    uint64_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+    uint64_t rows = store->config.rowsPerMetric;
+    uint64_t start = head > rows ? head - rows : 0;
+    size_t count = 0;
+    for (uint64_t index = start; index < head; index++) {
+        uint64_t slot = index & store->mask;
+        uint64_t sequence = atomic_load_explicit(&s->sequences[slot], memory_order_acquire);
+        if (sequence != 2 * index + 2) {
+            continue;
+        }
+        int64_t timeUs = atomic_load_explicit(&s->times[slot], memory_order_relaxed);
+        float value = atomic_load_explicit(&s->values[slot], memory_order_relaxed);
+        uint32_t rowSource = atomic_load_explicit(&s->sources[slot], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s->sequences[slot], memory_order_relaxed) != sequence) {
+            continue;
+        }
+        if (timeUs < fromUs || timeUs >= toUs || (source != STATS_SOURCE_ANY && rowSource != source)) {
+            continue;
+        }
+        store->readTimes[count] = timeUs;
+        store->readValues[count] = value;
+        store->readSources[count] = rowSource;
+        count++;
+    }
+    return count;
+}
+
+static int StatsCompareFloat(const void *a, const void *b) {
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/// 最近秩分位数，values 已排序
+static inline float StatsPercentile(const float *values, size_t count, double percentile) {
+    size_t rank = (size_t)ceil(percentile / 100.0 * (double)count);
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+bool StatsStoreAggregate(StatsStore *store, StatsMetric metric, uint32_t source, int64_t fromUs, int64_t toUs,
+                         StatsAggregate *aggregate) {
+    memset(aggregate, 0, sizeof(*aggregate));
+    if (metric >= StatsMetricCount) {
+        return false;
+    }
+    size_t count = StatsStoreCollect(store, metric, source, fromUs, toUs);
+    if (count == 0) {
+        return false;
+    }
+    float *values = store->readValues;
+    double sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    qsort(values, count, sizeof(float), StatsCompareFloat);
+    aggregate->count = (uint32_t)count;
+    aggregate->mean = (float)(sum / (double)count);
+    aggregate->min = values[0];
+    aggregate->max = values[count - 1];
+    aggregate->p50 = StatsPercentile(values, count, 50);
+    aggregate->p95 = StatsPercentile(values, count, 95);
+    aggregate->p99 = StatsPercentile(values, count, 99);
+    return true;
+}
+
+// Export
+
+/// 按时间插入排序；多个线程写入时只有相邻几行可能乱序
+static void StatsSortRowsByTime(int64_t *times, float *values, uint32_t *sources, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        int64_t timeUs = times[i];
+        float value = values[i];
+        uint32_t source = sources[i];
+        size_t j = i;
+        while (j > 0 && times[j - 1] > timeUs) {
+            times[j] = times[j - 1];
+            values[j] = values[j - 1];
+            sources[j] = sources[j - 1];
+            j--;
+        }
+        times[j] = timeUs;
+        values[j] = value;
+        sources[j] = source;
+    }
+}
+
+bool StatsStoreExport(StatsStore *store, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    StatsStoreFileHeader header = {
+        .magic = STATS_STORE_FILE_MAGIC,
+        .version = STATS_STORE_FILE_VERSION,
+        .metricCount = StatsMetricCount,
+        .sourceCount = store->config.maxSources,
+        .monotonicToUnixUs = store->monotonicToUnixUs,
+    };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (uint32_t i = 0; ok && i < store->config.maxSources; i++) {
+        char name[STATS_SOURCE_NAME_MAX] = {0};
+        StatsSource *entry = &store->sourceTable[i];
+        if (atomic_load_explicit(&entry->state, memory_order_acquire) == StatsSourceReady) {
+            memcpy(name, entry->name, sizeof(name));
+        }
+        ok = fwrite(name, sizeof(name), 1, file) == 1;
+    }
+    for (int metric = 0; ok && metric < StatsMetricCount; metric++) {
+        size_t count = StatsStoreCollect(store, (StatsMetric)metric, STATS_SOURCE_ANY, INT64_MIN, INT64_MAX);
+        StatsSortRowsByTime(store->readTimes, store->readValues, store->readSources, count);
+        StatsStoreFileBlock block = {.metric = (uint32_t)metric, .rowCount = (uint32_t)count};
+        snprintf(block.name, sizeof(block.name), "%s", StatsMetricNames[metric]);
+        ok = fwrite(&block, sizeof(block), 1, file) == 1 &&
+             fwrite(store->readTimes, sizeof(int64_t), count, file) == count &&
+             fwrite(store->readValues, sizeof(float), count, file) == count &&
+             fwrite(store->readSources, sizeof(uint32_t), count, file) == count;
+    }
+    return fclose(file) == 0 && ok;
+}
+
+// CSV
+
+typedef struct {
+    StatsStoreFileBlock block;
+    int64_t *times;
+    float *values;
+    uint32_t *sources;
+    size_t cursor;
+} StatsCsvBlock;
+
+/// 读入导出文件的全部内容
+typedef struct {
+    StatsStoreFileHeader header;
+    char *names;
+    StatsCsvBlock *blocks;
+    uint32_t blockCount;
+} StatsCsvInput;
+
+static void StatsCsvInputFree(StatsCsvInput *input) {
+    for (uint32_t i = 0; i < input->blockCount; i++) {
+        free(input->blocks[i].times);
+        free(input->blocks[i].values);
+        free(input->blocks[i].sources);
+    }
+    free(input->blocks);
+    free(input->names);
+}
+
+static bool StatsCsvReadBlock(FILE *file, StatsCsvBlock *b) {
+    if (fread(&b->block, sizeof(b->block), 1, file) != 1 || b->block.rowCount > (1u << 24)) {
+        return false;
+    }
+    b->block.name[sizeof(b->block.name) - 1] = '\0';
+    size_t count = b->block.rowCount;
+    b->times = malloc(sizeof(int64_t) * (count ? count : 1));
+    b->values = malloc(sizeof(float) * (count ? count : 1));
+    b->sources = malloc(sizeof(uint32_t) * (count ? count : 1));
+    return b->times && b->values && b->sources && fread(b->times, sizeof(int64_t), count, file) == count &&
+           fread(b->values, sizeof(float), count, file) == count &&
+           fread(b->sources, sizeof(uint32_t), count, file) == count;
+}
+
+static bool StatsCsvRead(FILE *file, StatsCsvInput *input) {
+    StatsStoreFileHeader *header = &input->header;
+    if (fread(header, sizeof(*header), 1, file) != 1 || header->magic != STATS_STORE_FILE_MAGIC ||
+        header->version != STATS_STORE_FILE_VERSION || header->sourceCount >= STATS_SOURCE_OTHER) {
+        return false;
+    }
+    input->names = calloc(header->sourceCount ? header->sourceCount : 1, STATS_SOURCE_NAME_MAX);
+    input->blocks = calloc(header->metricCount ? header->metricCount : 1, sizeof(StatsCsvBlock));
+    if (!input->names || !input->blocks ||
+        fread(input->names, STATS_SOURCE_NAME_MAX, header->sourceCount, file) != header->sourceCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header->sourceCount; i++) {
+        input->names[(size_t)i * STATS_SOURCE_NAME_MAX + STATS_SOURCE_NAME_MAX - 1] = '\0';
+    }
+    while (input->blockCount < header->metricCount) {
+        // 先计数，读取失败时已分配的列也能释放
+        StatsCsvBlock *b = &input->blocks[input->blockCount++];
+        if (!StatsCsvReadBlock(file, b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const char *StatsCsvSourceName(const StatsCsvInput *input, uint32_t source) {
+    if (source == STATS_SOURCE_LOCAL) {
+        return "local";
+    }
+    if (source > input->header.sourceCount || input->names[(size_t)(source - 1) * STATS_SOURCE_NAME_MAX] == '\0') {
+        return "other";
+    }
+    return input->names + (size_t)(source - 1) * STATS_SOURCE_NAME_MAX;
+}
+
+static bool StatsCsvWrite(FILE *file, StatsCsvInput *input) {
+    if (fputs("time_ms,metric,source,value\n", file) < 0) {
+        return false;
+    }
+    // 各指标内已按时间排列，逐行取最早的一行合并
+    for (;;) {
+        StatsCsvBlock *next = NULL;
+        for (uint32_t i = 0; i < input->blockCount; i++) {
+            StatsCsvBlock *b = &input->blocks[i];
+            if (b->cursor < b->block.rowCount && (!next || b->times[b->cursor] < next->times[next->cursor])) {
+                next = b;
+            }
+        }
+        if (!next) {
+            return true;
+        }
+        size_t row = next->cursor++;
+        double timeMs = (double)(next->times[row] + input->header.monotonicToUnixUs) / 1000.0;
+        if (fprintf(file, "%.3f,%s,%s,%.6g\n", timeMs, next->block.name, StatsCsvSourceName(input, next->sources[row]),
+                    (double)next->values[row]) < 0) {
+            return false;
+        }
+    }
+}
+
+bool StatsStoreConvertToCsv(const char *binaryPath, const char *csvPath) {
+    FILE *binary = fopen(binaryPath, "rb");
+    if (!binary) {
+        return false;
+    }
+    StatsCsvInput input = {0};
+    bool ok = StatsCsvRead(binary, &input);
+    fclose(binary);
+    if (ok) {
+        FILE *csv = fopen(csvPath, "w");
+        ok = csv && StatsCsvWrite(csv, &input);
+        if (csv && fclose(csv) != 0) {
+            ok = false;
+        }
+    }
+    StatsCsvInputFree(&input);
+    return ok;
+}
@@ -0,0 +1,146 @@
+//
+//  StatsStore.h
+//  quickstart
+//
+//  统计时间序列：SDK 统计回调与本地处理耗时按同一时钟写入定长列式环形缓冲，支持窗口聚合与二进制导出
+//
+
+#ifndef StatsStore_h
+#define StatsStore_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    // onSysStats
+    StatsMetricCpuApp = 0,              // 应用 CPU 占用（0～1）
+    StatsMetricCpuTotal,                // 系统 CPU 占用（0～1）
+    StatsMetricMemoryAppMB,
+    StatsMetricMemoryFreeMB,
+    // onLocalStreamStats，主流
+    StatsMetricLocalSentKbps,
+    StatsMetricLocalInputFps,
+    StatsMetricLocalEncoderFps,
+    StatsMetricLocalSentFps,
+    StatsMetricLocalLossRate,
+    StatsMetricLocalRttMs,
+    // onRemoteStreamStats，按远端用户区分来源
+    StatsMetricRemoteReceivedKbps,
+    StatsMetricRemoteDecoderFps,
+    StatsMetricRemoteRenderFps,
+    StatsMetricRemoteLossRate,
+    StatsMetricRemoteStallCount,
+    StatsMetricRemoteE2eDelayMs,
+    // onNetworkQuality，来源 0 为本地
+    StatsMetricNetTxQuality,
+    StatsMetricNetRxQuality,
+    StatsMetricNetLossRatio,
+    StatsMetricNetRttMs,
+    // CustomProcessor
+    StatsMetricProcessTotalMs,
+    StatsMetricProcessRenderMs,
+    StatsMetricProcessTrackingMs,
+    StatsMetricCount
+} StatsMetric;
+
+/// 指标名称，用于导出，如 "local_encoder_fps"
+const char *StatsMetricName(StatsMetric metric);
+
+/// 来源：0 为本地，远端用户由 StatsStoreSourceForName 分配
+#define STATS_SOURCE_LOCAL 0u
+/// 来源表已满时的远端用户
+#define STATS_SOURCE_OTHER 0xFFFFFFFEu
+/// 聚合时不区分来源
+#define STATS_SOURCE_ANY 0xFFFFFFFFu
+/// 来源名称最大字节数（含结尾 0）
+#define STATS_SOURCE_NAME_MAX 64
+
+typedef struct {
+    /// 每个指标保留的最近行数，向上取整到 2 的幂；每 2 秒一次的 SDK 统计 4096 行约 2 小时，逐帧的处理耗时约 2 分钟
+    uint32_t rowsPerMetric;
+    /// 远端来源的最大数量
+    uint32_t maxSources;
+} StatsStoreConfig;
+
+/// 默认配置：每个指标 4096 行，32 个远端来源
+StatsStoreConfig StatsStoreDefaultConfig(void);
+
+typedef struct {
+    uint32_t count;
+    float mean;
+    float min;
+    float max;
+    float p50;
+    float p95;
+    float p99;
+} StatsAggregate;
+
+typedef struct StatsStore StatsStore;
+
+/// 分配所有行与读取用的临时缓冲
+StatsStore *StatsStoreCreate(const StatsStoreConfig *config);
+
+void StatsStoreDestroy(StatsStore *store);
+
+/// 统一时钟：单调时钟（微秒）
+int64_t StatsStoreNowUs(void);
+
+/// 远端来源编号，第一次出现的名称占用一个空位；可在任意线程调用，无锁
+/// @return 来源表已满时返回 STATS_SOURCE_OTHER
+uint32_t StatsStoreSourceForName(StatsStore *store, const char *name);
+
+/// 写入一行，可在任意线程并发调用：无锁、不分配内存；写满后覆盖该指标最旧的行
+/// @param timeUs StatsStoreNowUs() 的值
+void StatsStoreRecord(StatsStore *store, StatsMetric metric, uint32_t source, int64_t timeUs, float value);
+
+/// [fromUs, toUs) 内的均值、极值与分位数（最近秩）；只在同一个读取线程调用，与写入并发安全
+/// @param source 来源，STATS_SOURCE_ANY 表示全部
+/// @return 窗口内没有数据时返回 false
+bool StatsStoreAggregate(StatsStore *store, StatsMetric metric, uint32_t source, int64_t fromUs, int64_t toUs,
+                         StatsAggregate *aggregate);
+
+/// 已写入的行数（含已被覆盖的），可在任意线程调用
+uint64_t StatsStoreRecordedRows(const StatsStore *store, StatsMetric metric);
+
+// 导出文件：StatsStoreFileHeader、maxSources 个来源名称（每个 STATS_SOURCE_NAME_MAX 字节）、
+// 之后每个指标一个 StatsStoreFileBlock 后接 rowCount 个 int64 时间、float 值与 uint32 来源，均为小端序。
+// 同一指标内的行按时间排列。
+
+#define STATS_STORE_FILE_MAGIC 0x52535453u  // "STSR"
+#define STATS_STORE_FILE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t metricCount;
+    uint32_t sourceCount;
+    uint32_t reserved;
+    /// 单调时钟为 0 时对应的 Unix 时间（微秒）
+    int64_t monotonicToUnixUs;
+} StatsStoreFileHeader;
+
+typedef struct {
+    char name[32];
+    uint32_t metric;
+    uint32_t rowCount;
+} StatsStoreFileBlock;
+
+_Static_assert(sizeof(StatsStoreFileHeader) == 24, "stats file header layout");
+_Static_assert(sizeof(StatsStoreFileBlock) == 40, "stats file block layout");
+
+/// 导出当前保留的所有行；只在读取线程调用，与写入并发安全
+bool StatsStoreExport(StatsStore *store, const char *path);
+
+/// 把导出文件转换为 CSV：time_ms,metric,source,value，按时间排列，time_ms 为 Unix 时间（毫秒）
+bool StatsStoreConvertToCsv(const char *binaryPath, const char *csvPath);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* StatsStore_h */
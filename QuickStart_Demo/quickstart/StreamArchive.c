@@ -0,0 +1,544 @@
+//
+//  StreamArchive.c
+//  quickstart
+//
+
+#include "StreamArchive.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "EncodedMuxer.h"
+#include "EncodedRecorder.h"
+
+#define STREAM_ARCHIVE_CACHE_LINE 64
+/// 索引偏移为 32 位，文件大小上限留出一半余量给等待关键帧的帧
+#define STREAM_ARCHIVE_MAX_FILE_BYTES (2ULL << 30)
+
+typedef enum {
+    StreamArchiveSlotFree = 0,
+    /// 生产者正在写入名称
+    StreamArchiveSlotClaiming,
+    StreamArchiveSlotActive,
+    /// I/O 线程等待投递中的帧完成后回收
+    StreamArchiveSlotClosing,
+} StreamArchiveSlotState;
+
+typedef struct {
+    // 生产者与 I/O 线程共享，每路流独占缓存行
+    _Alignas(STREAM_ARCHIVE_CACHE_LINE) _Atomic int state;
+    _Atomic uint64_t nameHash;
+    /// 正在投递的线程数，为 0 时才能回收
+    _Atomic uint32_t writers;
+    /// Claiming 时写入，之后到回收前只读
+    char name[STREAM_ARCHIVE_NAME_MAX];
+    EncodedFrameSlab *slab;
+
+    // 以下只由 I/O 线程访问
+    EncodedMuxer *muxer;
+    int indexFd;
+    bool tracked;
+    int64_t lastActivityUs;
+    EncodedFrameCodec codec;
+    /// 当前文件已加入的字节数，即下一帧的偏移
+    uint64_t fileBytes;
+    int64_t fileStartArrivalUs;
+    /// 待写出的索引条目与视频字节数
+    StreamArchiveIndexEntry *index;
+    size_t indexCount;
+    size_t pendingBytes;
+    int64_t pendingSinceUs;
+    /// 已读出、尚未释放的最后一条记录
+    EncodedFrameRecord lastRecord;
+    bool hasLastRecord;
+} StreamArchiveSlot;
+
+struct StreamArchive {
+    StreamArchiveConfig config;
+    char directory[PATH_MAX];
+    StreamArchiveSlot *slots;
+    size_t indexCapacity;
+    pthread_t thread;
+    bool threadStarted;
+    _Atomic bool accepting;
+    _Atomic bool running;
+    /// 只由 I/O 线程访问，目录内所有流共用的文件序号
+    uint32_t fileIndex;
+
+    // 多个生产者写
+    _Atomic uint64_t rejectedFrames;
+    _Atomic uint32_t activeStreams;
+
+    // 只由 I/O 线程写
+    _Atomic uint64_t frames;
+    _Atomic uint64_t skippedFrames;
+    _Atomic uint64_t bytesWritten;
+    _Atomic uint32_t files;
+    _Atomic uint32_t writeErrors;
+};
+
+StreamArchiveConfig StreamArchiveDefaultConfig(const char *directory) {
+    StreamArchiveConfig config = {
+        .directory = directory,
+        .maxStreams = 8,
+        .streamSlabBytes = 2 << 20,
+        .maxFileBytes = 64 << 20,
+        .maxFileDurationMs = 5 * 60 * 1000,
+        .flushIntervalMs = 1000,
+        .idleTimeoutMs = 5000,
+        .pollIntervalMs = 20,
+    };
+    return config;
+}
+
+static inline void StreamArchiveCounterAdd(_Atomic uint64_t *counter, uint64_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static inline void StreamArchiveCounterAdd32(_Atomic uint32_t *counter) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+static uint64_t StreamArchiveHash(const char *name) {
+    // FNV-1a，只取会被保存的前 STREAM_ARCHIVE_NAME_MAX - 1 字节
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < STREAM_ARCHIVE_NAME_MAX - 1 && name[i]; i++) {
+        hash = (hash ^ (uint8_t)name[i]) * 1099511628211ULL;
+    }
+    // 0 表示空闲
+    return hash ? hash : 1;
+}
+
+// Index
+
+bool StreamArchiveIndexHeaderValid(const StreamArchiveIndexHeader *header) {
+    return header->magic == STREAM_ARCHIVE_INDEX_MAGIC && header->version == STREAM_ARCHIVE_INDEX_VERSION &&
+           header->headerSize >= sizeof(StreamArchiveIndexHeader) &&
+           header->entrySize >= sizeof(StreamArchiveIndexEntry);
+}
+
+size_t StreamArchiveIndexSeek(const StreamArchiveIndexEntry *entries, size_t count, int64_t ptsUs) {
+    // 第一个 ptsUs 大于目标的条目
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (entries[middle].ptsUs <= ptsUs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    while (low > 0) {
+        low--;
+        if (entries[low].flags & ENCODED_FRAME_FLAG_KEYFRAME) {
+            return low;
+        }
+    }
+    return count;
+}
+
+// I/O thread
+
+static bool StreamArchiveWriteAll(int fd, const void *bytes, size_t size) {
+    const uint8_t *cursor = bytes;
+    while (size > 0) {
+        ssize_t written = write(fd, cursor, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        cursor += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+static void StreamArchiveReleaseWritten(StreamArchiveSlot *slot) {
+    if (slot->hasLastRecord) {
+        EncodedFrameSlabRelease(slot->slab, &slot->lastRecord);
+        slot->hasLastRecord = false;
+    }
+}
+
+static void StreamArchiveCloseIndex(StreamArchiveSlot *slot) {
+    if (slot->indexFd >= 0) {
+        close(slot->indexFd);
+        slot->indexFd = -1;
+    }
+}
+
+/// 先写视频再写索引，索引中的条目总能找到对应数据
+static void StreamArchiveFlush(StreamArchive *archive, StreamArchiveSlot *slot) {
+    if (slot->indexCount > 0) {
+        size_t indexBytes = slot->indexCount * sizeof(StreamArchiveIndexEntry);
+        if (EncodedMuxerFlush(slot->muxer, INT64_MIN) && StreamArchiveWriteAll(slot->indexFd, slot->index, indexBytes)) {
+            StreamArchiveCounterAdd(&archive->frames, slot->indexCount);
+            StreamArchiveCounterAdd(&archive->bytesWritten, slot->pendingBytes + indexBytes);
+        } else {
+            // 写失败（如磁盘已满）后关闭文件，下一帧关键帧时重新尝试
+            StreamArchiveCounterAdd32(&archive->writeErrors);
+            EncodedMuxerClose(slot->muxer);
+            StreamArchiveCloseIndex(slot);
+        }
+    }
+    slot->indexCount = 0;
+    slot->pendingBytes = 0;
+    StreamArchiveReleaseWritten(slot);
+}
+
+static void StreamArchiveCloseFile(StreamArchive *archive, StreamArchiveSlot *slot) {
+    StreamArchiveFlush(archive, slot);
+    if (EncodedMuxerIsOpen(slot->muxer) && !EncodedMuxerClose(slot->muxer)) {
+        StreamArchiveCounterAdd32(&archive->writeErrors);
+    }
+    StreamArchiveCloseIndex(slot);
+}
+
+static int64_t StreamArchiveUnixNowUs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static bool StreamArchiveOpenFile(StreamArchive *archive, StreamArchiveSlot *slot, const EncodedFrameHeader *header) {
+    EncodedFrameCodec codec = header->codec == EncodedFrameCodecH265 ? EncodedFrameCodecH265 : EncodedFrameCodecH264;
+    // 流名称来自房间号与用户名，只保留文件名安全的字符
+    char fileName[STREAM_ARCHIVE_NAME_MAX];
+    size_t length = 0;
+    for (; slot->name[length]; length++) {
+        char c = slot->name[length];
+        bool safe = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' ||
+                    c == '_' || c == '.';
+        fileName[length] = safe ? c : '_';
+    }
+    fileName[length] = '\0';
+    char videoPath[PATH_MAX];
+    char indexPath[PATH_MAX];
+    int videoLength = snprintf(videoPath, sizeof(videoPath), "%s/%s_%04u.%s", archive->directory, fileName,
+                               archive->fileIndex, EncodedMuxerFileExtension(EncodedMuxerFormatAnnexB, codec));
+    int indexLength = snprintf(indexPath, sizeof(indexPath), "%s/%s_%04u.idx", archive->directory, fileName,
+                               archive->fileIndex);
+    archive->fileIndex++;
+    if (videoLength < 0 || (size_t)videoLength >= sizeof(videoPath) || indexLength < 0 ||
+        (size_t)indexLength >= sizeof(indexPath)) {
+        // 截断的路径可能指向其他流的文件，不打开
+        StreamArchiveCounterAdd32(&archive->writeErrors);
+        return false;
+    }
+
+    if (!EncodedMuxerOpen(slot->muxer, EncodedMuxerFormatAnnexB, codec, videoPath, NULL)) {
+        EncodedMuxerClose(slot->muxer);
+        StreamArchiveCounterAdd32(&archive->writeErrors);
+        return false;
+    }
+    slot->indexFd = open(indexPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    StreamArchiveIndexHeader indexHeader = {
+        .magic = STREAM_ARCHIVE_INDEX_MAGIC,
+        .version = STREAM_ARCHIVE_INDEX_VERSION,
+        .headerSize = sizeof(StreamArchiveIndexHeader),
+        .entrySize = sizeof(StreamArchiveIndexEntry),
+        .codec = (uint8_t)codec,
+        .startUnixUs = StreamArchiveUnixNowUs() - (EncodedRecorderNowUs() - header->arrivalUs),
+    };
+    memcpy(indexHeader.name, slot->name, length + 1);
+    if (slot->indexFd < 0 || !StreamArchiveWriteAll(slot->indexFd, &indexHeader, sizeof(indexHeader))) {
+        EncodedMuxerClose(slot->muxer);
+        StreamArchiveCloseIndex(slot);
+        StreamArchiveCounterAdd32(&archive->writeErrors);
+        return false;
+    }
+    slot->codec = codec;
+    slot->fileBytes = 0;
+    slot->fileStartArrivalUs = header->arrivalUs;
+    StreamArchiveCounterAdd(&archive->bytesWritten, sizeof(indexHeader));
+    StreamArchiveCounterAdd32(&archive->files);
+    return true;
+}
+
+static bool StreamArchiveShouldRotate(const StreamArchive *archive, const StreamArchiveSlot *slot,
+                                      const EncodedFrameHeader *header) {
+    EncodedFrameCodec codec = header->codec == EncodedFrameCodecH265 ? EncodedFrameCodecH265 : EncodedFrameCodecH264;
+    return codec != slot->codec || slot->fileBytes >= archive->config.maxFileBytes ||
+           header->arrivalUs - slot->fileStartArrivalUs >= (int64_t)archive->config.maxFileDurationMs * 1000;
+}
+
+static void StreamArchiveHandleFrame(StreamArchive *archive, StreamArchiveSlot *slot, const EncodedFrameRecord *record) {
+    const EncodedFrameHeader *header = &record->header;
+    bool keyframe = header->flags & ENCODED_FRAME_FLAG_KEYFRAME;
+    EncodedMuxer *muxer = slot->muxer;
+    // 在关键帧处换文件，每个文件都能单独解码
+    if (EncodedMuxerIsOpen(muxer) &&
+        ((keyframe && StreamArchiveShouldRotate(archive, slot, header)) ||
+         slot->fileBytes + header->size > UINT32_MAX)) {
+        StreamArchiveCloseFile(archive, slot);
+    }
+    if (!EncodedMuxerIsOpen(muxer) && (!keyframe || !StreamArchiveOpenFile(archive, slot, header))) {
+        StreamArchiveCounterAdd(&archive->skippedFrames, 1);
+        EncodedFrameSlabRelease(slot->slab, record);
+        return;
+    }
+    if (slot->indexCount == archive->indexCapacity || !EncodedMuxerAddVideo(muxer, header, record->data)) {
+        StreamArchiveFlush(archive, slot);
+        if (!EncodedMuxerIsOpen(muxer)) {
+            StreamArchiveCounterAdd(&archive->skippedFrames, 1);
+            EncodedFrameSlabRelease(slot->slab, record);
+            return;
+        }
+        EncodedMuxerAddVideo(muxer, header, record->data);
+    }
+    int64_t arrivalMs = (header->arrivalUs - slot->fileStartArrivalUs) / 1000;
+    slot->index[slot->indexCount++] = (StreamArchiveIndexEntry){
+        .ptsUs = header->ptsUs,
+        .offset = (uint32_t)slot->fileBytes,
+        .size = header->size,
+        .arrivalMs = arrivalMs < 0 ? 0 : (uint32_t)arrivalMs,
+        .flags = (uint16_t)header->flags,
+        .rotation = header->rotation,
+    };
+    if (slot->pendingBytes == 0) {
+        slot->pendingSinceUs = header->arrivalUs;
+    }
+    slot->fileBytes += header->size;
+    slot->pendingBytes += header->size;
+    slot->lastRecord = *record;
+    slot->hasLastRecord = true;
+}
+
+/// 写完缓冲中的帧、关闭文件，让出这路缓冲
+static void StreamArchiveRecycleSlot(StreamArchive *archive, StreamArchiveSlot *slot) {
+    EncodedFrameRecord record;
+    while (EncodedFrameSlabRead(slot->slab, &record)) {
+        StreamArchiveHandleFrame(archive, slot, &record);
+    }
+    StreamArchiveCloseFile(archive, slot);
+    slot->tracked = false;
+    atomic_store_explicit(&slot->nameHash, 0, memory_order_relaxed);
+    atomic_store_explicit(&slot->state, StreamArchiveSlotFree, memory_order_release);
+    atomic_fetch_sub_explicit(&archive->activeStreams, 1, memory_order_relaxed);
+}
+
+static void StreamArchiveServiceSlot(StreamArchive *archive, StreamArchiveSlot *slot, int64_t nowUs) {
+    int state = atomic_load_explicit(&slot->state, memory_order_seq_cst);
+    if (state == StreamArchiveSlotClosing) {
+        // 与 Push 中先加 writers 再检查 state 配对：看到 0 之后不会再有帧写入
+        if (atomic_load_explicit(&slot->writers, memory_order_seq_cst) == 0) {
+            StreamArchiveRecycleSlot(archive, slot);
+        }
+        return;
+    }
+    if (state != StreamArchiveSlotActive) {
+        return;
+    }
+    if (!slot->tracked) {
+        slot->tracked = true;
+        slot->lastActivityUs = nowUs;
+    }
+    EncodedFrameRecord record;
+    bool received = false;
+    while (EncodedFrameSlabRead(slot->slab, &record)) {
+        StreamArchiveHandleFrame(archive, slot, &record);
+        received = true;
+    }
+    if (received) {
+        slot->lastActivityUs = nowUs;
+    } else if (nowUs - slot->lastActivityUs >= (int64_t)archive->config.idleTimeoutMs * 1000) {
+        // 用户离开或取消发布：下次检查时回收
+        atomic_store_explicit(&slot->state, StreamArchiveSlotClosing, memory_order_seq_cst);
+        return;
+    }
+    // 攒够一段再写，减少系统调用；缓冲占用过半时提前写，保证回调线程总有空间
+    if (slot->pendingBytes > 0 &&
+        (nowUs - slot->pendingSinceUs >= (int64_t)archive->config.flushIntervalMs * 1000 ||
+         EncodedFrameSlabUsedBytes(slot->slab) > EncodedFrameSlabCapacity(slot->slab) / 2)) {
+        StreamArchiveFlush(archive, slot);
+    }
+}
+
+static void *StreamArchiveThread(void *context) {
+    StreamArchive *archive = context;
+    struct timespec interval = {
+        .tv_sec = archive->config.pollIntervalMs / 1000,
+        .tv_nsec = (long)(archive->config.pollIntervalMs % 1000) * 1000000,
+    };
+    while (atomic_load_explicit(&archive->running, memory_order_acquire)) {
+        int64_t nowUs = EncodedRecorderNowUs();
+        for (uint32_t i = 0; i < archive->config.maxStreams; i++) {
+            StreamArchiveServiceSlot(archive, &archive->slots[i], nowUs);
+        }
+        nanosleep(&interval, NULL);
+    }
+    // accepting 已关闭，等投递中的帧写完后收尾
+    struct timespec shortWait = {.tv_sec = 0, .tv_nsec = 1000000};
+    for (uint32_t i = 0; i < archive->config.maxStreams; i++) {
+        StreamArchiveSlot *slot = &archive->slots[i];
+        while (atomic_load_explicit(&slot->writers, memory_order_seq_cst) != 0) {
+            nanosleep(&shortWait, NULL);
+        }
+        int state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == StreamArchiveSlotActive || state == StreamArchiveSlotClosing) {
+            StreamArchiveRecycleSlot(archive, slot);
+        }
+    }
+    return NULL;
+}
+
+// Public
+
+StreamArchive *StreamArchiveCreate(const StreamArchiveConfig *config) {
+    if (!config || !config->directory || strlen(config->directory) + STREAM_ARCHIVE_NAME_MAX + 16 > PATH_MAX ||
+        config->maxStreams == 0 || config->maxFileBytes == 0 || config->maxFileDurationMs == 0 ||
+        config->flushIntervalMs == 0 || config->idleTimeoutMs == 0 || config->pollIntervalMs == 0) {
+        return NULL;
+    }
+    StreamArchive *archive = calloc(1, sizeof(StreamArchive));
+    if (!archive) {
+        return NULL;
+    }
+    archive->config = *config;
+    strcpy(archive->directory, config->directory);
+    archive->config.directory = archive->directory;
+    if (archive->config.maxFileBytes > STREAM_ARCHIVE_MAX_FILE_BYTES) {
+        archive->config.maxFileBytes = STREAM_ARCHIVE_MAX_FILE_BYTES;
+    }
+
+    EncodedMuxerConfig muxerConfig = EncodedMuxerDefaultConfig();
+    archive->indexCapacity = muxerConfig.maxFragmentVideoFrames;
+    void *memory = NULL;
+    if (posix_memalign(&memory, STREAM_ARCHIVE_CACHE_LINE, config->maxStreams * sizeof(StreamArchiveSlot)) != 0) {
+        free(archive);
+        return NULL;
+    }
+    memset(memory, 0, config->maxStreams * sizeof(StreamArchiveSlot));
+    archive->slots = memory;
+    bool allocated = true;
+    for (uint32_t i = 0; i < config->maxStreams; i++) {
+        StreamArchiveSlot *slot = &archive->slots[i];
+        atomic_init(&slot->state, StreamArchiveSlotFree);
+        atomic_init(&slot->nameHash, 0);
+        atomic_init(&slot->writers, 0);
+        slot->indexFd = -1;
+        slot->slab = EncodedFrameSlabCreate(config->streamSlabBytes);
+        slot->muxer = EncodedMuxerCreate(&muxerConfig);
+        slot->index = malloc(archive->indexCapacity * sizeof(StreamArchiveIndexEntry));
+        allocated = allocated && slot->slab && slot->muxer && slot->index;
+    }
+    if (!allocated) {
+        StreamArchiveDestroy(archive);
+        return NULL;
+    }
+    atomic_init(&archive->accepting, true);
+    atomic_init(&archive->running, true);
+    if (pthread_create(&archive->thread, NULL, StreamArchiveThread, archive) != 0) {
+        StreamArchiveDestroy(archive);
+        return NULL;
+    }
+    archive->threadStarted = true;
+    return archive;
+}
+
+void StreamArchiveStop(StreamArchive *archive) {
+    atomic_store_explicit(&archive->accepting, false, memory_order_seq_cst);
+    if (atomic_exchange_explicit(&archive->running, false, memory_order_acq_rel) && archive->threadStarted) {
+        pthread_join(archive->thread, NULL);
+    }
+}
+
+void StreamArchiveDestroy(StreamArchive *archive) {
+    if (!archive) {
+        return;
+    }
+    StreamArchiveStop(archive);
+    for (uint32_t i = 0; i < archive->config.maxStreams; i++) {
+        StreamArchiveSlot *slot = &archive->slots[i];
+        EncodedMuxerDestroy(slot->muxer);
+        EncodedFrameSlabDestroy(slot->slab);
+        free(slot->index);
+        StreamArchiveCloseIndex(slot);
+    }
+    free(archive->slots);
+    free(archive);
+}
+
+// Producer
+
+static StreamArchiveSlot *StreamArchiveFindSlot(StreamArchive *archive, uint64_t hash) {
+    for (uint32_t i = 0; i < archive->config.maxStreams; i++) {
+        StreamArchiveSlot *slot = &archive->slots[i];
+        if (atomic_load_explicit(&slot->nameHash, memory_order_relaxed) == hash &&
+            atomic_load_explicit(&slot->state, memory_order_acquire) == StreamArchiveSlotActive) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static StreamArchiveSlot *StreamArchiveClaimSlot(StreamArchive *archive, uint64_t hash, const char *name) {
+    for (uint32_t i = 0; i < archive->config.maxStreams; i++) {
+        StreamArchiveSlot *slot = &archive->slots[i];
+        int expected = StreamArchiveSlotFree;
+        if (atomic_compare_exchange_strong_explicit(&slot->state, &expected, StreamArchiveSlotClaiming,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            strncpy(slot->name, name, STREAM_ARCHIVE_NAME_MAX - 1);
+            slot->name[STREAM_ARCHIVE_NAME_MAX - 1] = '\0';
+            atomic_store_explicit(&slot->nameHash, hash, memory_order_relaxed);
+            atomic_store_explicit(&slot->state, StreamArchiveSlotActive, memory_order_release);
+            atomic_fetch_add_explicit(&archive->activeStreams, 1, memory_order_relaxed);
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+bool StreamArchivePush(StreamArchive *archive, const char *name, const EncodedFrameHeader *header, const void *data) {
+    if (!atomic_load_explicit(&archive->accepting, memory_order_acquire)) {
+        return false;
+    }
+    uint64_t hash = StreamArchiveHash(name);
+    // 找到的流可能恰好被回收，重试一次即占用新的缓冲
+    for (int attempt = 0; attempt < 2; attempt++) {
+        StreamArchiveSlot *slot = StreamArchiveFindSlot(archive, hash);
+        if (!slot) {
+            slot = StreamArchiveClaimSlot(archive, hash, name);
+        }
+        if (!slot) {
+            break;
+        }
+        atomic_fetch_add_explicit(&slot->writers, 1, memory_order_seq_cst);
+        if (atomic_load_explicit(&archive->accepting, memory_order_seq_cst) &&
+            atomic_load_explicit(&slot->state, memory_order_seq_cst) == StreamArchiveSlotActive &&
+            atomic_load_explicit(&slot->nameHash, memory_order_relaxed) == hash) {
+            bool written = strncmp(slot->name, name, STREAM_ARCHIVE_NAME_MAX - 1) == 0 &&
+                           EncodedFrameSlabWrite(slot->slab, header, data);
+            atomic_fetch_sub_explicit(&slot->writers, 1, memory_order_release);
+            return written;
+        }
+        atomic_fetch_sub_explicit(&slot->writers, 1, memory_order_release);
+    }
+    atomic_fetch_add_explicit(&archive->rejectedFrames, 1, memory_order_relaxed);
+    return false;
+}
+
+void StreamArchiveGetStats(const StreamArchive *archive, StreamArchiveStats *stats) {
+    stats->frames = atomic_load_explicit(&archive->frames, memory_order_relaxed);
+    stats->drops = 0;
+    for (uint32_t i = 0; i < archive->config.maxStreams; i++) {
+        stats->drops += EncodedFrameSlabDroppedFrames(archive->slots[i].slab);
+    }
+    stats->rejectedFrames = atomic_load_explicit(&archive->rejectedFrames, memory_order_relaxed);
+    stats->skippedFrames = atomic_load_explicit(&archive->skippedFrames, memory_order_relaxed);
+    stats->bytesWritten = atomic_load_explicit(&archive->bytesWritten, memory_order_relaxed);
+    stats->files = atomic_load_explicit(&archive->files, memory_order_relaxed);
+    stats->writeErrors = atomic_load_explicit(&archive->writeErrors, memory_order_relaxed);
+    stats->activeStreams = atomic_load_explicit(&archive->activeStreams, memory_order_relaxed);
+}
@@ -0,0 +1,126 @@
+//
+//  StreamArchive.h
+//  quickstart
+//
+//  远端编码流归档：每路流独立的有界缓冲，共用一个 I/O 线程写 Annex-B 文件与定位索引
+//
+
+#ifndef StreamArchive_h
+#define StreamArchive_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "EncodedFrameSlab.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 流名称最大字节数（含结尾 0）
+#define STREAM_ARCHIVE_NAME_MAX 104
+
+typedef struct {
+    /// 输出目录，需已存在；文件名为 <流名称>_<序号>.<h264|h265>，索引为同名 .idx
+    const char *directory;
+    /// 同时归档的最大流数，每路流预分配一个缓冲
+    uint32_t maxStreams;
+    /// 每路流的缓冲字节数，写盘慢于产生时新帧被丢弃
+    size_t streamSlabBytes;
+    /// 文件超过该大小或时长后，在下一帧关键帧处换新文件；大小不超过 2GB
+    uint64_t maxFileBytes;
+    uint32_t maxFileDurationMs;
+    /// 积压超过该时长写一次盘
+    uint32_t flushIntervalMs;
+    /// 超过该时长没有新帧的流关闭文件并让出缓冲
+    uint32_t idleTimeoutMs;
+    /// I/O 线程检查缓冲的间隔（毫秒）
+    uint32_t pollIntervalMs;
+} StreamArchiveConfig;
+
+/// 默认配置：8 路流，每路缓冲 2MB，文件 64MB 或 5 分钟，每秒写盘，空闲 5 秒关闭，每 20ms 检查一次
+StreamArchiveConfig StreamArchiveDefaultConfig(const char *directory);
+
+/// 计数器，可在任意线程读取
+typedef struct {
+    uint64_t frames;                // 写入文件的帧数
+    uint64_t drops;                 // 缓冲已满丢弃的帧数
+    uint64_t rejectedFrames;        // 流数已满丢弃的帧数
+    uint64_t skippedFrames;         // 等待关键帧而跳过的帧数
+    uint64_t bytesWritten;          // 写入的视频与索引字节数
+    uint32_t files;                 // 打开过的视频文件数
+    uint32_t writeErrors;
+    uint32_t activeStreams;
+} StreamArchiveStats;
+
+// 索引文件：一个 StreamArchiveIndexHeader 后接若干 StreamArchiveIndexEntry，小端序。
+// 条目按写入顺序排列，只在对应的视频数据写入文件之后追加，文件中断时不会指向不存在的数据。
+
+#define STREAM_ARCHIVE_INDEX_MAGIC 0x58495352u  // "RSIX"
+#define STREAM_ARCHIVE_INDEX_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    /// 头与每个条目的字节数，读取时按此跳过，以便以后扩展字段
+    uint16_t headerSize;
+    uint16_t entrySize;
+    /// EncodedFrameCodec
+    uint8_t codec;
+    uint8_t reserved[5];
+    /// 文件第一帧到达时的 Unix 时间（微秒），条目的 arrivalMs 相对于此
+    int64_t startUnixUs;
+    /// 流名称，以 0 结尾
+    char name[STREAM_ARCHIVE_NAME_MAX];
+} StreamArchiveIndexHeader;
+
+typedef struct {
+    /// 发送端的显示时间戳（微秒）
+    int64_t ptsUs;
+    /// 帧在视频文件中的偏移与字节数
+    uint32_t offset;
+    uint32_t size;
+    /// 到达时间，相对于 startUnixUs（毫秒）
+    uint32_t arrivalMs;
+    /// ENCODED_FRAME_FLAG_*
+    uint16_t flags;
+    /// 顺时针旋转角度
+    uint16_t rotation;
+} StreamArchiveIndexEntry;
+
+_Static_assert(sizeof(StreamArchiveIndexHeader) == 128, "index header layout");
+_Static_assert(sizeof(StreamArchiveIndexEntry) == 24, "index entry layout");
+
+/// 文件头是否可读：魔数、版本与大小
+bool StreamArchiveIndexHeaderValid(const StreamArchiveIndexHeader *header);
+
+/// 定位：ptsUs 处或之前最近的关键帧，从它开始解码即可显示 ptsUs 处的画面
+/// @param entries 按 ptsUs 非递减排列
+/// @return 条目下标，没有这样的关键帧时返回 count
+size_t StreamArchiveIndexSeek(const StreamArchiveIndexEntry *entries, size_t count, int64_t ptsUs);
+
+typedef struct StreamArchive StreamArchive;
+
+/// 分配所有缓冲并启动 I/O 线程
+StreamArchive *StreamArchiveCreate(const StreamArchiveConfig *config);
+
+/// 停止并释放
+void StreamArchiveDestroy(StreamArchive *archive);
+
+/// 投递一帧编码视频，可在多个回调线程调用，同一路流的帧需在同一时刻只有一个线程投递。
+/// 第一次出现的流名称占用一路空闲缓冲；只拷贝数据，不分配内存、不等待磁盘
+/// @param name 流名称，如 <房间>_<用户>_main，超出 STREAM_ARCHIVE_NAME_MAX 的部分被截断
+/// @return 缓冲已满、流数已满或已停止时丢弃该帧并返回 false
+bool StreamArchivePush(StreamArchive *archive, const char *name, const EncodedFrameHeader *header, const void *data);
+
+/// 写完缓冲中剩余的帧、关闭所有文件并结束 I/O 线程；之后投递的帧被丢弃
+void StreamArchiveStop(StreamArchive *archive);
+
+void StreamArchiveGetStats(const StreamArchive *archive, StreamArchiveStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* StreamArchive_h */
@@ -0,0 +1,519 @@
+//
+//  UserRegistry.c
+//  quickstart
+//
+
+#include "UserRegistry.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define USER_REGISTRY_CACHE_LINE 64
+
+typedef struct {
+    uint64_t hash;
+    /// 每次创建递增，句柄复用后也能区分不同用户
+    uint64_t serial;
+    bool used;
+    bool joined;
+    bool hasVideo;
+    bool subscribed;
+    int slot;
+    /// 等待队列（有视频但没有槽位的用户）的双向链表
+    bool waiting;
+    uint32_t prev;
+    uint32_t next;
+    /// 空闲链表
+    uint32_t nextFree;
+    UserRegistryStats stats;
+    char userId[USER_REGISTRY_MAX_ID_LENGTH + 1];
+} UserRecord;
+
+typedef struct {
+    UserRegistryEventType type;
+    UserRegistryStats stats;
+    char userId[USER_REGISTRY_MAX_ID_LENGTH + 1];
+} UserRegistryEvent;
+
+/// 有界 MPSC 队列单元，sequence 标记单元可写（== 位置）或可读（== 位置 + 1）
+typedef struct {
+    _Atomic size_t sequence;
+    UserRegistryEvent event;
+} UserRegistryEventCell;
+
+struct UserRegistry {
+    /// 生产者与消费者各自写的字段分开放在不同缓存行，避免伪共享
+    _Alignas(USER_REGISTRY_CACHE_LINE) _Atomic size_t enqueuePosition;
+    _Atomic uint64_t droppedEvents;
+
+    _Alignas(USER_REGISTRY_CACHE_LINE) _Atomic size_t dequeuePosition;
+
+    /// 以下只由 Apply 所在线程访问
+    _Alignas(USER_REGISTRY_CACHE_LINE) UserRegistryConfig config;
+    UserRegistryEventCell *cells;
+    size_t eventMask;
+
+    UserRecord *users;
+    uint32_t freeHead;
+    size_t userCount;
+    uint64_t nextSerial;
+    /// 开放寻址哈希表（线性探测），存用户句柄，负载不超过 1/2
+    uint32_t *table;
+    size_t tableMask;
+
+    uint32_t *slots;
+    /// 上次报告给调用方的各槽位用户
+    uint64_t *publishedSerials;
+    uint32_t waitingHead;
+    uint32_t waitingTail;
+};
+
+UserRegistryConfig UserRegistryDefaultConfig(void) {
+    UserRegistryConfig config = {
+        .capacity = 1024,
+        .eventCapacity = 4096,
+        .slotCount = 3,
+    };
+    return config;
+}
+
+static size_t UserRegistryRoundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+UserRegistry *UserRegistryCreate(const UserRegistryConfig *config) {
+    if (!config || config->capacity == 0 || config->capacity >= USER_REGISTRY_INVALID_HANDLE / 2 ||
+        config->eventCapacity < 2 || config->slotCount == 0) {
+        return NULL;
+    }
+    void *memory = NULL;
+    if (posix_memalign(&memory, USER_REGISTRY_CACHE_LINE, sizeof(UserRegistry)) != 0) {
+        return NULL;
+    }
+    UserRegistry *registry = memory;
+    memset(registry, 0, sizeof(UserRegistry));
+    registry->config = *config;
+    size_t eventCapacity = UserRegistryRoundUpPowerOfTwo(config->eventCapacity);
+    size_t tableSize = UserRegistryRoundUpPowerOfTwo(config->capacity * 2);
+    registry->eventMask = eventCapacity - 1;
+    registry->tableMask = tableSize - 1;
+    registry->cells = calloc(eventCapacity, sizeof(UserRegistryEventCell));
+    registry->users = calloc(config->capacity, sizeof(UserRecord));
+    registry->table = malloc(tableSize * sizeof(uint32_t));
+    registry->slots = malloc(config->slotCount * sizeof(uint32_t));
+    registry->publishedSerials = calloc(config->slotCount, sizeof(uint64_t));
+    if (!registry->cells || !registry->users || !registry->table || !registry->slots || !registry->publishedSerials) {
+        UserRegistryDestroy(registry);
+        return NULL;
+    }
+    for (size_t i = 0; i < eventCapacity; i++) {
+        atomic_init(&registry->cells[i].sequence, i);
+    }
+    atomic_init(&registry->enqueuePosition, 0);
+    atomic_init(&registry->dequeuePosition, 0);
+    atomic_init(&registry->droppedEvents, 0);
+    for (size_t i = 0; i < config->capacity; i++) {
+        registry->users[i].nextFree = i + 1 < config->capacity ? (uint32_t)(i + 1) : USER_REGISTRY_INVALID_HANDLE;
+    }
+    registry->freeHead = 0;
+    registry->nextSerial = 1;
+    for (size_t i = 0; i < tableSize; i++) {
+        registry->table[i] = USER_REGISTRY_INVALID_HANDLE;
+    }
+    for (size_t i = 0; i < config->slotCount; i++) {
+        registry->slots[i] = USER_REGISTRY_INVALID_HANDLE;
+    }
+    registry->waitingHead = USER_REGISTRY_INVALID_HANDLE;
+    registry->waitingTail = USER_REGISTRY_INVALID_HANDLE;
+    return registry;
+}
+
+void UserRegistryDestroy(UserRegistry *registry) {
+    if (!registry) {
+        return;
+    }
+    free(registry->cells);
+    free(registry->users);
+    free(registry->table);
+    free(registry->slots);
+    free(registry->publishedSerials);
+    free(registry);
+}
+
+size_t UserRegistrySlotCount(const UserRegistry *registry) {
+    return registry->config.slotCount;
+}
+
+// 事件队列
+
+bool UserRegistryPost(UserRegistry *registry, UserRegistryEventType type, const char *userId,
+                      const UserRegistryStats *stats) {
+    size_t length = userId ? strlen(userId) : 0;
+    if (length == 0 || length > USER_REGISTRY_MAX_ID_LENGTH) {
+        atomic_fetch_add_explicit(&registry->droppedEvents, 1, memory_order_relaxed);
+        return false;
+    }
+    UserRegistryEventCell *cell;
+    size_t position = atomic_load_explicit(&registry->enqueuePosition, memory_order_relaxed);
+    for (;;) {
+        cell = &registry->cells[position & registry->eventMask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&registry->enqueuePosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // 队列已满：消费者还没有处理这一圈之前的事件
+            atomic_fetch_add_explicit(&registry->droppedEvents, 1, memory_order_relaxed);
+            return false;
+        } else {
+            position = atomic_load_explicit(&registry->enqueuePosition, memory_order_relaxed);
+        }
+    }
+    cell->event.type = type;
+    if (stats) {
+        cell->event.stats = *stats;
+    }
+    memcpy(cell->event.userId, userId, length + 1);
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    return true;
+}
+
+uint64_t UserRegistryDroppedEvents(const UserRegistry *registry) {
+    return atomic_load_explicit(&((UserRegistry *)registry)->droppedEvents, memory_order_relaxed);
+}
+
+bool UserRegistryHasPendingEvents(const UserRegistry *registry) {
+    UserRegistry *mutableRegistry = (UserRegistry *)registry;
+    size_t dequeue = atomic_load_explicit(&mutableRegistry->dequeuePosition, memory_order_relaxed);
+    size_t enqueue = atomic_load_explicit(&mutableRegistry->enqueuePosition, memory_order_relaxed);
+    return enqueue != dequeue;
+}
+
+/// 取出队首事件；生产者已占位但尚未写完时视为队列为空，留到下一次 Apply
+static bool UserRegistryDequeue(UserRegistry *registry, UserRegistryEvent *event) {
+    size_t position = atomic_load_explicit(&registry->dequeuePosition, memory_order_relaxed);
+    UserRegistryEventCell *cell = &registry->cells[position & registry->eventMask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if (sequence != position + 1) {
+        return false;
+    }
+    *event = cell->event;
+    atomic_store_explicit(&cell->sequence, position + registry->eventMask + 1, memory_order_release);
+    atomic_store_explicit(&registry->dequeuePosition, position + 1, memory_order_relaxed);
+    return true;
+}
+
+// 哈希表
+
+static uint64_t UserRegistryHash(const char *userId) {
+    // FNV-1a
+    uint64_t hash = 1469598103934665603ULL;
+    for (const char *p = userId; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// 返回用户在哈希表中的位置，不存在时返回应插入的空位
+static size_t UserRegistryProbe(const UserRegistry *registry, const char *userId, uint64_t hash) {
+    size_t index = (size_t)hash & registry->tableMask;
+    for (;;) {
+        uint32_t handle = registry->table[index];
+        if (handle == USER_REGISTRY_INVALID_HANDLE) {
+            return index;
+        }
+        const UserRecord *user = &registry->users[handle];
+        if (user->hash == hash && strcmp(user->userId, userId) == 0) {
+            return index;
+        }
+        index = (index + 1) & registry->tableMask;
+    }
+}
+
+uint32_t UserRegistryFind(const UserRegistry *registry, const char *userId) {
+    if (!userId) {
+        return USER_REGISTRY_INVALID_HANDLE;
+    }
+    return registry->table[UserRegistryProbe(registry, userId, UserRegistryHash(userId))];
+}
+
+static uint32_t UserRegistryFindOrCreate(UserRegistry *registry, const char *userId) {
+    uint64_t hash = UserRegistryHash(userId);
+    size_t index = UserRegistryProbe(registry, userId, hash);
+    if (registry->table[index] != USER_REGISTRY_INVALID_HANDLE) {
+        return registry->table[index];
+    }
+    uint32_t handle = registry->freeHead;
+    if (handle == USER_REGISTRY_INVALID_HANDLE) {
+        return USER_REGISTRY_INVALID_HANDLE;
+    }
+    UserRecord *user = &registry->users[handle];
+    registry->freeHead = user->nextFree;
+    memset(user, 0, sizeof(UserRecord));
+    user->hash = hash;
+    user->serial = registry->nextSerial++;
+    user->used = true;
+    user->slot = USER_REGISTRY_NO_SLOT;
+    user->prev = USER_REGISTRY_INVALID_HANDLE;
+    user->next = USER_REGISTRY_INVALID_HANDLE;
+    strcpy(user->userId, userId);
+    registry->table[index] = handle;
+    registry->userCount++;
+    return handle;
+}
+
+/// 删除后把同一探测链上的后续元素前移，不使用墓碑，删除后探测长度不会变长
+static void UserRegistryRemove(UserRegistry *registry, uint32_t handle) {
+    UserRecord *user = &registry->users[handle];
+    size_t hole = UserRegistryProbe(registry, user->userId, user->hash);
+    registry->table[hole] = USER_REGISTRY_INVALID_HANDLE;
+    size_t index = hole;
+    for (;;) {
+        index = (index + 1) & registry->tableMask;
+        uint32_t moving = registry->table[index];
+        if (moving == USER_REGISTRY_INVALID_HANDLE) {
+            break;
+        }
+        size_t home = (size_t)registry->users[moving].hash & registry->tableMask;
+        // home 不在 (hole, index] 区间内时，该元素可以前移到 hole
+        bool reachable = hole <= index ? (home > hole && home <= index) : (home > hole || home <= index);
+        if (!reachable) {
+            registry->table[hole] = moving;
+            registry->table[index] = USER_REGISTRY_INVALID_HANDLE;
+            hole = index;
+        }
+    }
+    user->used = false;
+    user->nextFree = registry->freeHead;
+    registry->freeHead = handle;
+    registry->userCount--;
+}
+
+// 等待队列与槽位
+
+static void UserRegistryWaitingRemove(UserRegistry *registry, uint32_t handle) {
+    UserRecord *user = &registry->users[handle];
+    if (!user->waiting) {
+        return;
+    }
+    if (user->prev != USER_REGISTRY_INVALID_HANDLE) {
+        registry->users[user->prev].next = user->next;
+    } else {
+        registry->waitingHead = user->next;
+    }
+    if (user->next != USER_REGISTRY_INVALID_HANDLE) {
+        registry->users[user->next].prev = user->prev;
+    } else {
+        registry->waitingTail = user->prev;
+    }
+    user->prev = USER_REGISTRY_INVALID_HANDLE;
+    user->next = USER_REGISTRY_INVALID_HANDLE;
+    user->waiting = false;
+}
+
+static void UserRegistryWaitingPush(UserRegistry *registry, uint32_t handle, bool front) {
+    UserRecord *user = &registry->users[handle];
+    user->waiting = true;
+    if (front) {
+        user->prev = USER_REGISTRY_INVALID_HANDLE;
+        user->next = registry->waitingHead;
+        if (registry->waitingHead != USER_REGISTRY_INVALID_HANDLE) {
+            registry->users[registry->waitingHead].prev = handle;
+        } else {
+            registry->waitingTail = handle;
+        }
+        registry->waitingHead = handle;
+    } else {
+        user->next = USER_REGISTRY_INVALID_HANDLE;
+        user->prev = registry->waitingTail;
+        if (registry->waitingTail != USER_REGISTRY_INVALID_HANDLE) {
+            registry->users[registry->waitingTail].next = handle;
+        } else {
+            registry->waitingHead = handle;
+        }
+        registry->waitingTail = handle;
+    }
+}
+
+static void UserRegistryPlace(UserRegistry *registry, uint32_t handle, int slot) {
+    registry->slots[slot] = handle;
+    registry->users[handle].slot = slot;
+}
+
+/// 空槽由等待最久的用户补上
+static void UserRegistryRefill(UserRegistry *registry, int slot) {
+    uint32_t handle = registry->waitingHead;
+    if (handle == USER_REGISTRY_INVALID_HANDLE) {
+        return;
+    }
+    UserRegistryWaitingRemove(registry, handle);
+    UserRegistryPlace(registry, handle, slot);
+}
+
+static void UserRegistryVacate(UserRegistry *registry, uint32_t handle) {
+    int slot = registry->users[handle].slot;
+    if (slot == USER_REGISTRY_NO_SLOT) {
+        return;
+    }
+    registry->slots[slot] = USER_REGISTRY_INVALID_HANDLE;
+    registry->users[handle].slot = USER_REGISTRY_NO_SLOT;
+    UserRegistryRefill(registry, slot);
+}
+
+/// 有视频的用户进入第一个空槽，没有空槽时排到等待队列队尾
+static void UserRegistryEnqueueVisible(UserRegistry *registry, uint32_t handle) {
+    for (size_t i = 0; i < registry->config.slotCount; i++) {
+        if (registry->slots[i] == USER_REGISTRY_INVALID_HANDLE) {
+            UserRegistryPlace(registry, handle, (int)i);
+            return;
+        }
+    }
+    UserRegistryWaitingPush(registry, handle, false);
+}
+
+static size_t UserRegistryCollectChanges(UserRegistry *registry, UserRegistrySlotChange *changes) {
+    size_t count = 0;
+    for (size_t i = 0; i < registry->config.slotCount; i++) {
+        uint32_t handle = registry->slots[i];
+        uint64_t serial = handle == USER_REGISTRY_INVALID_HANDLE ? 0 : registry->users[handle].serial;
+        if (serial == registry->publishedSerials[i]) {
+            continue;
+        }
+        registry->publishedSerials[i] = serial;
+        changes[count].slot = (int)i;
+        if (handle == USER_REGISTRY_INVALID_HANDLE) {
+            changes[count].userId[0] = '\0';
+        } else {
+            strcpy(changes[count].userId, registry->users[handle].userId);
+        }
+        count++;
+    }
+    return count;
+}
+
+// 事件处理
+
+static void UserRegistryHandle(UserRegistry *registry, const UserRegistryEvent *event) {
+    uint32_t handle;
+    if (event->type == UserRegistryEventJoined || event->type == UserRegistryEventVideoStarted) {
+        handle = UserRegistryFindOrCreate(registry, event->userId);
+    } else {
+        handle = UserRegistryFind(registry, event->userId);
+    }
+    if (handle == USER_REGISTRY_INVALID_HANDLE) {
+        return;
+    }
+    UserRecord *user = &registry->users[handle];
+    switch (event->type) {
+        case UserRegistryEventJoined:
+            user->joined = true;
+            break;
+        case UserRegistryEventLeft:
+            UserRegistryWaitingRemove(registry, handle);
+            UserRegistryVacate(registry, handle);
+            UserRegistryRemove(registry, handle);
+            break;
+        case UserRegistryEventVideoStarted:
+            // 首帧回调可能早于进房回调到达
+            user->joined = true;
+            user->subscribed = true;
+            if (!user->hasVideo) {
+                user->hasVideo = true;
+                UserRegistryEnqueueVisible(registry, handle);
+            }
+            break;
+        case UserRegistryEventVideoStopped:
+            user->hasVideo = false;
+            UserRegistryWaitingRemove(registry, handle);
+            UserRegistryVacate(registry, handle);
+            break;
+        case UserRegistryEventSubscribed:
+            user->subscribed = true;
+            break;
+        case UserRegistryEventUnsubscribed:
+            user->subscribed = false;
+            break;
+        case UserRegistryEventStats:
+            user->stats = event->stats;
+            break;
+    }
+}
+
+size_t UserRegistryApply(UserRegistry *registry, UserRegistrySlotChange *changes) {
+    UserRegistryEvent event;
+    // 最多处理一圈，生产者持续投递时也不会一直占用主线程
+    for (size_t i = 0; i <= registry->eventMask; i++) {
+        if (!UserRegistryDequeue(registry, &event)) {
+            break;
+        }
+        UserRegistryHandle(registry, &event);
+    }
+    return UserRegistryCollectChanges(registry, changes);
+}
+
+// 查询
+
+const char *UserRegistryUserId(const UserRegistry *registry, uint32_t handle) {
+    if (handle >= registry->config.capacity || !registry->users[handle].used) {
+        return NULL;
+    }
+    return registry->users[handle].userId;
+}
+
+bool UserRegistryGetState(const UserRegistry *registry, uint32_t handle, UserRegistryUserState *state) {
+    if (handle >= registry->config.capacity || !registry->users[handle].used) {
+        return false;
+    }
+    const UserRecord *user = &registry->users[handle];
+    state->joined = user->joined;
+    state->hasVideo = user->hasVideo;
+    state->subscribed = user->subscribed;
+    state->slot = user->slot;
+    state->stats = user->stats;
+    return true;
+}
+
+uint32_t UserRegistrySlotUser(const UserRegistry *registry, int slot) {
+    if (slot < 0 || (size_t)slot >= registry->config.slotCount) {
+        return USER_REGISTRY_INVALID_HANDLE;
+    }
+    return registry->slots[slot];
+}
+
+size_t UserRegistryUserCount(const UserRegistry *registry) {
+    return registry->userCount;
+}
+
+size_t UserRegistryAssignSlot(UserRegistry *registry, int slot, uint32_t handle, UserRegistrySlotChange *changes) {
+    if (slot < 0 || (size_t)slot >= registry->config.slotCount || handle >= registry->config.capacity) {
+        return 0;
+    }
+    UserRecord *user = &registry->users[handle];
+    if (!user->used || !user->hasVideo || user->slot == slot) {
+        return 0;
+    }
+    int previousSlot = user->slot;
+    if (previousSlot != USER_REGISTRY_NO_SLOT) {
+        registry->slots[previousSlot] = USER_REGISTRY_INVALID_HANDLE;
+        user->slot = USER_REGISTRY_NO_SLOT;
+    }
+    UserRegistryWaitingRemove(registry, handle);
+    uint32_t displaced = registry->slots[slot];
+    if (displaced != USER_REGISTRY_INVALID_HANDLE) {
+        registry->users[displaced].slot = USER_REGISTRY_NO_SLOT;
+        UserRegistryWaitingPush(registry, displaced, true);
+    }
+    UserRegistryPlace(registry, handle, slot);
+    if (previousSlot != USER_REGISTRY_NO_SLOT) {
+        UserRegistryRefill(registry, previousSlot);
+    }
+    return UserRegistryCollectChanges(registry, changes);
+}
@@ -0,0 +1,127 @@
+//
+//  UserRegistry.h
+//  quickstart
+//
+//  大房间远端用户表：用户 ID 驻留、流状态与可见槽位分配
+//
+
+#ifndef UserRegistry_h
+#define UserRegistry_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 用户 ID 的最大长度（与 SDK 限制一致）
+#define USER_REGISTRY_MAX_ID_LENGTH 128
+/// 无效的用户句柄
+#define USER_REGISTRY_INVALID_HANDLE UINT32_MAX
+/// 用户不在任何槽位上
+#define USER_REGISTRY_NO_SLOT (-1)
+
+typedef enum {
+    UserRegistryEventJoined = 0,
+    UserRegistryEventLeft,
+    /// 远端视频首帧解码，可以显示
+    UserRegistryEventVideoStarted,
+    /// 远端取消发布视频
+    UserRegistryEventVideoStopped,
+    UserRegistryEventSubscribed,
+    UserRegistryEventUnsubscribed,
+    UserRegistryEventStats,
+} UserRegistryEventType;
+
+/// 最近一次远端流统计
+typedef struct {
+    float videoKbps;
+    float audioKbps;
+    float videoLossRate;
+    float audioLossRate;
+    int frameRate;
+    int e2eDelayMs;
+} UserRegistryStats;
+
+typedef struct {
+    bool joined;
+    bool hasVideo;
+    bool subscribed;
+    /// 所在槽位，USER_REGISTRY_NO_SLOT 表示不可见
+    int slot;
+    UserRegistryStats stats;
+} UserRegistryUserState;
+
+/// 一次 Apply / AssignSlot 之后槽位上显示的用户变化
+typedef struct {
+    int slot;
+    /// 新的用户 ID，空串表示槽位清空
+    char userId[USER_REGISTRY_MAX_ID_LENGTH + 1];
+} UserRegistrySlotChange;
+
+typedef struct {
+    /// 最多同时在房间内的远端用户数
+    size_t capacity;
+    /// 两次 Apply 之间最多积压的事件数，取整到 2 的幂
+    size_t eventCapacity;
+    /// 可见槽位数
+    size_t slotCount;
+} UserRegistryConfig;
+
+/// 默认配置：1024 个用户，4096 个事件，3 个槽位
+UserRegistryConfig UserRegistryDefaultConfig(void);
+
+typedef struct UserRegistry UserRegistry;
+
+/// 所有内存在此分配，之后投递事件与 Apply 都不再分配内存
+UserRegistry *UserRegistryCreate(const UserRegistryConfig *config);
+
+void UserRegistryDestroy(UserRegistry *registry);
+
+size_t UserRegistrySlotCount(const UserRegistry *registry);
+
+/// 投递一个事件，无锁，可在任意线程调用
+/// @param stats 仅 UserRegistryEventStats 使用，其余事件传 NULL
+/// @return 事件队列已满或 userId 过长时返回 false，事件被丢弃
+bool UserRegistryPost(UserRegistry *registry, UserRegistryEventType type, const char *userId,
+                      const UserRegistryStats *stats);
+
+/// 被丢弃的事件数
+uint64_t UserRegistryDroppedEvents(const UserRegistry *registry);
+
+/// 队列中是否有未处理的事件，可在任意线程调用
+bool UserRegistryHasPendingEvents(const UserRegistry *registry);
+
+/// 按投递顺序处理所有积压事件，并返回处理前后有变化的槽位
+/// @note 以下函数都只在同一个线程（主线程）调用
+/// @param changes 容量不小于槽位数
+/// @return 变化的槽位数
+size_t UserRegistryApply(UserRegistry *registry, UserRegistrySlotChange *changes);
+
+/// 查找用户，O(1)
+/// @return 句柄在用户离开前有效，离开后可能被新用户复用；不在房间时返回 USER_REGISTRY_INVALID_HANDLE
+uint32_t UserRegistryFind(const UserRegistry *registry, const char *userId);
+
+const char *UserRegistryUserId(const UserRegistry *registry, uint32_t handle);
+
+bool UserRegistryGetState(const UserRegistry *registry, uint32_t handle, UserRegistryUserState *state);
+
+/// 槽位上的用户，空槽返回 USER_REGISTRY_INVALID_HANDLE
+uint32_t UserRegistrySlotUser(const UserRegistry *registry, int slot);
+
+/// 房间内的用户数
+size_t UserRegistryUserCount(const UserRegistry *registry);
+
+/// 把有视频的用户放到指定槽位（如按音量切换说话人），原来的用户回到等待队列队首；
+/// 该用户原先所在的槽位由等待队列补上
+/// @param changes 容量不小于槽位数
+/// @return 变化的槽位数，用户不存在或没有视频时返回 0
+size_t UserRegistryAssignSlot(UserRegistry *registry, int slot, uint32_t handle, UserRegistrySlotChange *changes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UserRegistry_h */
@@ -0,0 +1,67 @@
+//
+//  VideoFramePool.h
+//  quickstart
+//
+//  前处理输出帧缓存池
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreVideo/CoreVideo.h>
+#import <VolcEngineRTC/objc/ByteRTCVideo.h>
+#import "FrameLeasePool.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// I420 buffer 缓存池与零拷贝输出帧
+/// @note 基于 CVPixelBufferPool，buffer 引用计数归零后自动回到池中复用，不会逐帧申请内存；
+///       零拷贝输出帧直接引用渲染器输出的 buffer，由 FrameLeasePool 持有引用直到 SDK 释放该帧。
+///       除 leaseStats 外非线程安全，只在视频前处理线程中使用。
+@interface VideoFramePool : NSObject
+
+/// 池中最多同时存在的 buffer 数量
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/// 池中已创建的 buffer 数量（稳定后不再增长）
+@property (nonatomic, assign, readonly) NSUInteger allocatedCount;
+
+/// 累计取出的 buffer 数量
+@property (nonatomic, assign, readonly) NSUInteger dequeuedCount;
+
+/// 渲染器输出的 buffer 是否可能零拷贝交给 SDK（校验中或校验通过）；渲染器复用仍被引用的 buffer 时为 NO，flush 后重新校验
+@property (nonatomic, assign, readonly) BOOL zeroCopySupported;
+
+/// 零拷贝输出帧的租借计数，可在任意线程读取
+@property (nonatomic, assign, readonly) FrameLeasePoolStats leaseStats;
+
+/// @param capacity 池容量，最小为 2
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init;
+
+/// 从池中取出指定大小的 I420 buffer，尺寸变化时会重建缓存池
+/// @return +1 引用的 buffer，调用方 CVPixelBufferRelease 后回到池中；池已用尽时返回 NULL
+- (nullable CVPixelBufferRef)dequeuePixelBufferWithWidth:(size_t)width height:(size_t)height CF_RETURNS_RETAINED;
+
+/// 渲染前决定下一帧的输出方式，每帧调用一次，调用方按结果只渲染一次：
+/// FrameLeaseTargetLease 时零拷贝渲染并调用 outputFrameWithPixelBuffer:；
+/// FrameLeaseTargetProbe 时在采集帧上原地渲染（回写）并把渲染器的输出 buffer 交给 probeRendererPixelBuffer:；
+/// FrameLeaseTargetInPlace 时只在采集帧上原地渲染
+- (FrameLeaseTarget)beginOutputFrame;
+
+/// 校验帧的渲染器输出 buffer，可为 NULL（渲染器没有单独的输出 buffer）
+- (void)probeRendererPixelBuffer:(nullable CVPixelBufferRef)pixelBuffer;
+
+/// 用渲染器输出的 buffer 生成携带源帧信息的输出帧，不拷贝像素，只在 beginOutputFrame 返回 FrameLeaseTargetLease 后调用
+/// @note 输出帧的 textureBuf 在此 retain，SDK 释放输出帧时通过 FrameLeasePool 归还，期间渲染器不会复用该 buffer。
+///       若渲染器仍复用了租借中的 buffer（校验后不应出现），本帧照常输出、不计租借，之后不再零拷贝
+/// @param pixelBuffer 渲染器输出的 buffer
+/// @param srcFrame 采集帧
+- (ByteRTCVideoFrame *)outputFrameWithPixelBuffer:(CVPixelBufferRef)pixelBuffer sourceFrame:(ByteRTCVideoFrame *)srcFrame;
+
+/// 释放池中所有 buffer 并重新检测零拷贝支持（切后台、关闭输出或离开房间后在处理线程调用）
+/// @note 已交给 SDK 的输出帧不受影响，SDK 释放时照常归还
+- (void)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
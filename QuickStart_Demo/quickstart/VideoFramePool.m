@@ -0,0 +1,218 @@
+//
+//  VideoFramePool.m
+//  quickstart
+//
+
+#import "VideoFramePool.h"
+#import <objc/runtime.h>
+
+/// 池容量上限
+static const NSUInteger kVideoFramePoolMaxCapacity = 8;
+
+/// 输出帧上关联租借对象的 key
+static char kVideoFrameLeaseKey;
+
+/// 归还时释放 outputFrameWithPixelBuffer: 中 retain 的 buffer
+static void VideoFramePoolReleasePixelBuffer(void *context, void *buffer) {
+    CVPixelBufferRelease((CVPixelBufferRef)buffer);
+}
+
+/// 关联在输出帧上，SDK 释放输出帧时归还租借；未能租借的 buffer 直接释放
+@interface VideoFrameLease : NSObject {
+    FrameLeasePool *_pool;
+    int32_t _lease;
+    CVPixelBufferRef _unleasedBuffer;
+}
+
+- (instancetype)initWithPool:(FrameLeasePool *)pool lease:(int32_t)lease;
+
+- (instancetype)initWithUnleasedBuffer:(CVPixelBufferRef)buffer;
+
+@end
+
+@implementation VideoFrameLease
+
+- (instancetype)initWithPool:(FrameLeasePool *)pool lease:(int32_t)lease {
+    self = [super init];
+    if (self) {
+        _pool = pool;
+        _lease = lease;
+    }
+    return self;
+}
+
+- (instancetype)initWithUnleasedBuffer:(CVPixelBufferRef)buffer {
+    self = [super init];
+    if (self) {
+        _lease = -1;
+        _unleasedBuffer = buffer;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_unleasedBuffer) {
+        CVPixelBufferRelease(_unleasedBuffer);
+        return;
+    }
+    FrameLeasePoolReturn(_pool, _lease);
+}
+
+@end
+
+@interface VideoFramePool () {
+    CVPixelBufferPoolRef _pool;
+    CFDictionaryRef _auxAttributes;
+    /// 已交给 SDK 的输出 buffer，租借表在所有租借归还后才释放
+    FrameLeasePool *_leasePool;
+    size_t _width;
+    size_t _height;
+}
+
+@property (nonatomic, assign) NSUInteger capacity;
+@property (nonatomic, assign) NSUInteger allocatedCount;
+@property (nonatomic, assign) NSUInteger dequeuedCount;
+@property (nonatomic, strong) NSHashTable *knownBuffers;
+
+@end
+
+@implementation VideoFramePool
+
+- (instancetype)init {
+    return [self initWithCapacity:4];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _capacity = MIN(MAX(capacity, 2), kVideoFramePoolMaxCapacity);
+        _knownBuffers = [NSHashTable hashTableWithOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality];
+        NSDictionary *aux = @{(id)kCVPixelBufferPoolAllocationThresholdKey : @(_capacity)};
+        _auxAttributes = CFBridgingRetain(aux);
+        _leasePool = FrameLeasePoolCreate((uint32_t)_capacity, VideoFramePoolReleasePixelBuffer, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self flush];
+    if (_auxAttributes) {
+        CFRelease(_auxAttributes);
+    }
+    FrameLeasePoolDestroy(_leasePool);
+}
+
+- (CVPixelBufferRef)dequeuePixelBufferWithWidth:(size_t)width height:(size_t)height {
+    if (width == 0 || height == 0) {
+        return NULL;
+    }
+    if (!_pool || width != _width || height != _height) {
+        [self flush];
+        if (![self createPoolWithWidth:width height:height]) {
+            return NULL;
+        }
+    }
+    CVPixelBufferRef pixelBuffer = NULL;
+    CVReturn result = CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(kCFAllocatorDefault, _pool, _auxAttributes, &pixelBuffer);
+    if (result != kCVReturnSuccess) {
+        // kCVReturnWouldExceedAllocationThreshold: 所有 buffer 都还在使用中
+        return NULL;
+    }
+    self.dequeuedCount++;
+    if (![self.knownBuffers containsObject:(__bridge id)pixelBuffer]) {
+        [self.knownBuffers addObject:(__bridge id)pixelBuffer];
+        self.allocatedCount++;
+    }
+    return pixelBuffer;
+}
+
+- (BOOL)zeroCopySupported {
+    return FrameLeasePoolZeroCopyAvailable(_leasePool);
+}
+
+- (FrameLeaseTarget)beginOutputFrame {
+    return FrameLeasePoolBeginFrame(_leasePool);
+}
+
+- (void)probeRendererPixelBuffer:(CVPixelBufferRef)pixelBuffer {
+    if (pixelBuffer) {
+        // 校验结束时由 VideoFramePoolReleasePixelBuffer 释放
+        CVPixelBufferRetain(pixelBuffer);
+    }
+    FrameLeasePoolProbe(_leasePool, pixelBuffer);
+    if (!FrameLeasePoolZeroCopyAvailable(_leasePool)) {
+        NSLog(@"VideoFramePool renderer reuses retained buffers, zero-copy output disabled");
+    }
+}
+
+- (ByteRTCVideoFrame *)outputFrameWithPixelBuffer:(CVPixelBufferRef)pixelBuffer sourceFrame:(ByteRTCVideoFrame *)srcFrame {
+    CVPixelBufferRetain(pixelBuffer);
+    int32_t lease = FrameLeasePoolLease(_leasePool, pixelBuffer);
+    VideoFrameLease *frameLease = nil;
+    if (lease < 0) {
+        // 租借位在渲染前已确认空闲，失败只可能是渲染器复用了 SDK 仍持有的 buffer；本帧已渲染，照常输出
+        NSLog(@"VideoFramePool renderer reused an in-flight buffer, zero-copy output disabled");
+        frameLease = [[VideoFrameLease alloc] initWithUnleasedBuffer:pixelBuffer];
+    } else {
+        frameLease = [[VideoFrameLease alloc] initWithPool:_leasePool lease:lease];
+    }
+
+    ByteRTCVideoFrame *dstFrame = [[ByteRTCVideoFrame alloc] init];
+    dstFrame.format = ByteRTCVideoPixelFormatCVPixelBuffer;
+    dstFrame.contentType = srcFrame.contentType;
+    dstFrame.time = srcFrame.time;
+    dstFrame.width = (int)CVPixelBufferGetWidth(pixelBuffer);
+    dstFrame.height = (int)CVPixelBufferGetHeight(pixelBuffer);
+    dstFrame.strideInPixels = (int)(CVPixelBufferIsPlanar(pixelBuffer) ? CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0) : CVPixelBufferGetBytesPerRow(pixelBuffer));
+    dstFrame.rotation = srcFrame.rotation;
+    dstFrame.flip = srcFrame.flip;
+    dstFrame.colorSpace = srcFrame.colorSpace;
+    dstFrame.cameraId = srcFrame.cameraId;
+    dstFrame.extendedData = srcFrame.extendedData;
+    dstFrame.supplementaryInfo = srcFrame.supplementaryInfo;
+    dstFrame.textureBuf = pixelBuffer;
+    // textureBuf 为 assign 属性，租借随输出帧一起释放
+    objc_setAssociatedObject(dstFrame, &kVideoFrameLeaseKey, frameLease, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    return dstFrame;
+}
+
+- (FrameLeasePoolStats)leaseStats {
+    FrameLeasePoolStats stats;
+    FrameLeasePoolGetStats(_leasePool, &stats);
+    return stats;
+}
+
+- (void)flush {
+    if (_pool) {
+        CVPixelBufferPoolFlush(_pool, kCVPixelBufferPoolFlushExcessBuffers);
+        CVPixelBufferPoolRelease(_pool);
+        _pool = NULL;
+    }
+    [self.knownBuffers removeAllObjects];
+    _width = 0;
+    _height = 0;
+    FrameLeasePoolResetDistinct(_leasePool);
+}
+
+#pragma mark - Private methods
+
+- (BOOL)createPoolWithWidth:(size_t)width height:(size_t)height {
+    NSDictionary *poolAttributes = @{(id)kCVPixelBufferPoolMinimumBufferCountKey : @(self.capacity)};
+    NSDictionary *pixelBufferAttributes = @{
+        (id)kCVPixelBufferPixelFormatTypeKey : @(kCVPixelFormatType_420YpCbCr8Planar),
+        (id)kCVPixelBufferWidthKey : @(width),
+        (id)kCVPixelBufferHeightKey : @(height),
+        (id)kCVPixelBufferIOSurfacePropertiesKey : @{}
+    };
+    CVReturn result = CVPixelBufferPoolCreate(kCFAllocatorDefault, (__bridge CFDictionaryRef)poolAttributes, (__bridge CFDictionaryRef)pixelBufferAttributes, &_pool);
+    if (result != kCVReturnSuccess) {
+        NSLog(@"VideoFramePool create failed: %d", result);
+        _pool = NULL;
+        return NO;
+    }
+    _width = width;
+    _height = height;
+    return YES;
+}
+
+@end
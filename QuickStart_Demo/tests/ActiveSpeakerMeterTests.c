@@ -0,0 +1,272 @@
+//
+//  ActiveSpeakerMeterTests.c
+//  tests
+//
+//  活跃说话人：SIMD 与标量电平一致、上升/下降时间常数、静音阈值、失效表项复用、
+//  只在结果变化时发布、槽位分配，以及更新不分配内存
+//
+
+#include "ActiveSpeakerMeter.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// 10ms @ 48kHz 单声道
+#define TEST_FRAME_SAMPLES 480
+#define TEST_FRAME_MS 10.0f
+
+/// 方波：每个样本的幅度都是 amplitude，RMS 与峰值都等于 amplitude / 32768
+static void TestFillSquare(int16_t *samples, size_t count, int16_t amplitude) {
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = (i & 1) ? (int16_t)-amplitude : amplitude;
+    }
+}
+
+static int16_t TestAmplitudeForDb(float db) {
+    return (int16_t)lrintf(32768.0f * powf(10.0f, db / 20.0f));
+}
+
+static bool TestFeed(ActiveSpeakerMeter *meter, const char *userId, int16_t amplitude, uint64_t nowMs) {
+    int16_t samples[TEST_FRAME_SAMPLES];
+    TestFillSquare(samples, TEST_FRAME_SAMPLES, amplitude);
+    return ActiveSpeakerMeterUpdate(meter, "room", userId, 0, samples, TEST_FRAME_SAMPLES, TEST_FRAME_MS, nowMs);
+}
+
+/// 读出某个用户当前的电平，不在排序结果中时返回电平下限
+static float TestLevelOf(ActiveSpeakerMeter *meter, const char *userId) {
+    ActiveSpeakerRanking ranking;
+    ActiveSpeakerMeterCopyRanking(meter, &ranking);
+    for (size_t i = 0; i < ranking.count; i++) {
+        if (strcmp(ranking.entries[i].userId, userId) == 0) {
+            return ranking.entries[i].levelDb;
+        }
+    }
+    return ACTIVE_SPEAKER_FLOOR_DB;
+}
+
+/// 每次更新都排序并发布，便于逐帧检查电平
+static ActiveSpeakerMeterConfig TestEveryFrameConfig(void) {
+    ActiveSpeakerMeterConfig config = ActiveSpeakerMeterDefaultConfig();
+    config.rankIntervalMs = 0;
+    config.publishDeltaDb = 0;
+    return config;
+}
+
+/// SIMD 实现与标量实现结果一致（含首尾不足一组的样本与满幅负值）
+static void TestMeasureMatchesScalar(void) {
+    int16_t samples[1024 + 7];
+    srand(42);
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        samples[i] = (int16_t)((rand() & 0xFFFF) - 32768);
+    }
+    samples[100] = -32768;
+    const size_t counts[] = {0, 1, 7, 8, 15, 16, 17, 480, 960, 1031};
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        for (size_t offset = 0; offset < 2; offset++) {
+            size_t count = counts[c] - (counts[c] > 0 && offset > 0 ? offset : 0);
+            float rms, peak, rmsC, peakC;
+            ActiveSpeakerMeasureS16(samples + offset, count, &rms, &peak);
+            ActiveSpeakerMeasureS16_C(samples + offset, count, &rmsC, &peakC);
+            TEST_CHECK(peak == peakC);
+            TEST_CHECK(fabsf(rms - rmsC) <= 1e-5f * fmaxf(rmsC, 1e-3f));
+        }
+    }
+    float rms, peak;
+    ActiveSpeakerMeasureS16(samples, 200, &rms, &peak);
+    TEST_CHECK(peak == 1.0f);
+    int16_t square[TEST_FRAME_SAMPLES];
+    TestFillSquare(square, TEST_FRAME_SAMPLES, 16384);
+    ActiveSpeakerMeasureS16(square, TEST_FRAME_SAMPLES, &rms, &peak);
+    TEST_CHECK(fabsf(rms - 0.5f) < 1e-6f && peak == 0.5f);
+}
+
+/// 上升按 attackMs、下降按 releaseMs 逼近：经过一个时间常数约走完 63%
+static void TestAttackRelease(void) {
+    ActiveSpeakerMeterConfig config = TestEveryFrameConfig();
+    ActiveSpeakerMeter *meter = ActiveSpeakerMeterCreate(&config);
+    int16_t quiet = TestAmplitudeForDb(-40.0f);
+    int16_t loud = TestAmplitudeForDb(-10.0f);
+    uint64_t nowMs = 1;
+    // 第一帧直接取当前电平
+    TestFeed(meter, "a", quiet, nowMs);
+    TEST_CHECK(fabsf(TestLevelOf(meter, "a") - -40.0f) < 0.1f);
+    float quietEnergy = powf(10.0f, -4.0f);
+    float loudEnergy = powf(10.0f, -1.0f);
+
+    // 上升：20ms（两帧）后能量约为 1 - e^-1
+    TestFeed(meter, "a", loud, nowMs += 10);
+    TestFeed(meter, "a", loud, nowMs += 10);
+    float expected = loudEnergy + (quietEnergy - loudEnergy) * expf(-1.0f);
+    float level = TestLevelOf(meter, "a");
+    TEST_CHECK(fabsf(level - 10.0f * log10f(expected)) < 0.1f);
+    for (int i = 0; i < 20; i++) {
+        TestFeed(meter, "a", loud, nowMs += 10);
+    }
+    TEST_CHECK(fabsf(TestLevelOf(meter, "a") - -10.0f) < 0.1f);
+
+    // 下降：20ms 后几乎不变，400ms 后约走完 63%
+    TestFeed(meter, "a", quiet, nowMs += 10);
+    TestFeed(meter, "a", quiet, nowMs += 10);
+    float afterShortGap = TestLevelOf(meter, "a");
+    TEST_CHECK(afterShortGap > -10.5f);
+    for (int i = 0; i < 38; i++) {
+        TestFeed(meter, "a", quiet, nowMs += 10);
+    }
+    expected = quietEnergy + (loudEnergy - quietEnergy) * expf(-1.0f);
+    level = TestLevelOf(meter, "a");
+    TEST_CHECK(fabsf(level - 10.0f * log10f(expected)) < 0.1f);
+    printf("  attack 20ms: %.1f dB, release 20ms: %.2f dB, release 400ms: %.2f dB\n",
+           10.0f * log10f(loudEnergy + (quietEnergy - loudEnergy) * expf(-1.0f)), afterShortGap, level);
+    ActiveSpeakerMeterDestroy(meter);
+}
+
+/// 低于阈值（含静音）的流不参与排序，其余按电平从大到小排列
+static void TestSilenceThreshold(void) {
+    ActiveSpeakerMeterConfig config = TestEveryFrameConfig();
+    ActiveSpeakerMeter *meter = ActiveSpeakerMeterCreate(&config);
+    uint64_t nowMs = 1;
+    TestFeed(meter, "silent", 0, nowMs);
+    TestFeed(meter, "below", TestAmplitudeForDb(-55.0f), nowMs);
+    TestFeed(meter, "above", TestAmplitudeForDb(-45.0f), nowMs);
+    TestFeed(meter, "loud", TestAmplitudeForDb(-20.0f), nowMs);
+    ActiveSpeakerRanking ranking;
+    TEST_CHECK(ActiveSpeakerMeterCopyRanking(meter, &ranking));
+    TEST_CHECK(ranking.count == 2);
+    TEST_CHECK(strcmp(ranking.entries[0].userId, "loud") == 0 && strcmp(ranking.entries[1].userId, "above") == 0);
+    TEST_CHECK(fabsf(ranking.entries[0].peakDb - -20.0f) < 0.1f);
+    TEST_CHECK(ActiveSpeakerMeterTrackedCount(meter) == 4);
+    ActiveSpeakerMeterDestroy(meter);
+}
+
+/// 表满时不能跟踪新的流；失效的表项被复用，复用后从当前帧的电平开始
+static void TestStaleSlotReuse(void) {
+    ActiveSpeakerMeterConfig config = TestEveryFrameConfig();
+    config.capacity = 4;
+    ActiveSpeakerMeter *meter = ActiveSpeakerMeterCreate(&config);
+    int16_t loud = TestAmplitudeForDb(-10.0f);
+    const char *users[] = {"a", "b", "c", "d"};
+    for (int i = 0; i < 4; i++) {
+        TEST_CHECK(TestFeed(meter, users[i], loud, 1));
+    }
+    TEST_CHECK(ActiveSpeakerMeterTrackedCount(meter) == 4);
+    TEST_CHECK(!TestFeed(meter, "e", loud, 500));
+    // a 持续更新，b/c/d 超过 staleMs 后失效
+    TEST_CHECK(TestFeed(meter, "a", loud, 1000));
+    TEST_CHECK(TestFeed(meter, "e", TestAmplitudeForDb(-30.0f), 1002));
+    TEST_CHECK(ActiveSpeakerMeterTrackedCount(meter) == 4);
+    ActiveSpeakerRanking ranking;
+    ActiveSpeakerMeterCopyRanking(meter, &ranking);
+    TEST_CHECK(ranking.count == 2);
+    TEST_CHECK(strcmp(ranking.entries[0].userId, "a") == 0 && strcmp(ranking.entries[1].userId, "e") == 0);
+    TEST_CHECK(fabsf(ranking.entries[1].levelDb - -30.0f) < 0.1f);
+    // 失效的流重新出现时同样复用表项
+    TEST_CHECK(TestFeed(meter, "b", loud, 1003) && TestFeed(meter, "c", loud, 1004));
+    TEST_CHECK(!TestFeed(meter, "f", loud, 1005));
+    ActiveSpeakerMeterDestroy(meter);
+}
+
+/// 电平稳定后不再发布，说话人变化时立即发布
+static void TestPublishOnlyOnChange(void) {
+    ActiveSpeakerMeterConfig config = ActiveSpeakerMeterDefaultConfig();
+    ActiveSpeakerMeter *meter = ActiveSpeakerMeterCreate(&config);
+    ActiveSpeakerRanking ranking;
+    int16_t loud = TestAmplitudeForDb(-20.0f);
+    uint64_t nowMs = 1;
+    for (int i = 0; i < 2; i++, nowMs += 10) {
+        TestFeed(meter, "a", loud, nowMs);
+        TestFeed(meter, "b", TestAmplitudeForDb(-30.0f), nowMs);
+    }
+    TEST_CHECK(ActiveSpeakerMeterCopyRanking(meter, &ranking) && ranking.count == 2);
+    int updates = 0;
+    for (int i = 0; i < 200; i++) {
+        nowMs += 10;
+        TestFeed(meter, "a", loud, nowMs);
+        TestFeed(meter, "b", TestAmplitudeForDb(-30.0f), nowMs);
+        updates += ActiveSpeakerMeterCopyRanking(meter, &ranking);
+    }
+    TEST_CHECK(updates == 0 && ranking.count == 2);
+    // b 变响，超过 a 后顺序变化
+    int changedAt = -1;
+    for (int i = 0; i < 20 && changedAt < 0; i++) {
+        nowMs += 10;
+        TestFeed(meter, "a", loud, nowMs);
+        TestFeed(meter, "b", TestAmplitudeForDb(-10.0f), nowMs);
+        if (ActiveSpeakerMeterCopyRanking(meter, &ranking) && strcmp(ranking.entries[0].userId, "b") == 0) {
+            changedAt = i;
+        }
+    }
+    TEST_CHECK(changedAt >= 0);
+    printf("  steady 2s: %d publishes, reorder published after %d frames\n", updates, changedAt + 1);
+    ActiveSpeakerMeterDestroy(meter);
+}
+
+static ActiveSpeakerEntry TestEntry(const char *userId, float levelDb) {
+    ActiveSpeakerEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    snprintf(entry.userId, sizeof(entry.userId), "%s", userId);
+    entry.levelDb = levelDb;
+    return entry;
+}
+
+/// 槽位分配：空槽按排名填充，已显示的用户保持原位，替换需要超出 switchMarginDb
+static void TestAssignSlots(void) {
+    ActiveSpeakerSlot slots[3];
+    memset(slots, 0, sizeof(slots));
+    ActiveSpeakerEntry ranked[4] = {TestEntry("a", -10), TestEntry("b", -20), TestEntry("c", -30),
+                                    TestEntry("d", -40)};
+    TEST_CHECK(ActiveSpeakerAssignSlots(ranked, 4, slots, 3, 6.0f) == 3);
+    TEST_CHECK(strcmp(slots[0].userId, "a") == 0 && strcmp(slots[1].userId, "b") == 0 &&
+               strcmp(slots[2].userId, "c") == 0);
+    // 排名变化但都已显示，位置不动
+    ActiveSpeakerEntry reordered[3] = {TestEntry("c", -5), TestEntry("a", -10), TestEntry("b", -20)};
+    TEST_CHECK(ActiveSpeakerAssignSlots(reordered, 3, slots, 3, 6.0f) == 0);
+    TEST_CHECK(strcmp(slots[0].userId, "a") == 0 && strcmp(slots[2].userId, "c") == 0);
+    // d 只比最安静的 b 高 4dB，不替换
+    ActiveSpeakerEntry close[4] = {TestEntry("a", -10), TestEntry("c", -12), TestEntry("d", -16),
+                                   TestEntry("b", -20)};
+    TEST_CHECK(ActiveSpeakerAssignSlots(close, 4, slots, 3, 6.0f) == 0);
+    // d 高出 8dB，替换 b 所在的槽位
+    ActiveSpeakerEntry louder[4] = {TestEntry("a", -10), TestEntry("d", -12), TestEntry("c", -15),
+                                    TestEntry("b", -20)};
+    TEST_CHECK(ActiveSpeakerAssignSlots(louder, 4, slots, 3, 6.0f) == 1);
+    TEST_CHECK(strcmp(slots[1].userId, "d") == 0);
+    // 不在排序结果中的已显示用户按电平下限计，最先被替换
+    ActiveSpeakerEntry gone[3] = {TestEntry("a", -10), TestEntry("d", -12), TestEntry("e", -40)};
+    TEST_CHECK(ActiveSpeakerAssignSlots(gone, 3, slots, 3, 6.0f) == 1);
+    TEST_CHECK(strcmp(slots[2].userId, "e") == 0);
+}
+
+/// 创建后更新与读取不分配内存
+static void TestNoAllocation(void) {
+    ActiveSpeakerMeterConfig config = ActiveSpeakerMeterDefaultConfig();
+    ActiveSpeakerMeter *meter = ActiveSpeakerMeterCreate(&config);
+    char userIds[32][8];
+    for (int u = 0; u < 32; u++) {
+        snprintf(userIds[u], sizeof(userIds[u]), "u%d", u);
+    }
+    ActiveSpeakerRanking ranking;
+    uint64_t allocations = TestAllocCount();
+    for (int frame = 0; frame < 500; frame++) {
+        for (int u = 0; u < 32; u++) {
+            TestFeed(meter, userIds[u], TestAmplitudeForDb(-60.0f + (float)((u * 7 + frame) % 50)), 1 + frame * 10);
+        }
+        ActiveSpeakerMeterCopyRanking(meter, &ranking);
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    TEST_CHECK(ActiveSpeakerMeterTrackedCount(meter) == 32);
+    ActiveSpeakerMeterDestroy(meter);
+}
+
+int main(void) {
+    TEST_RUN(TestMeasureMatchesScalar);
+    TEST_RUN(TestAttackRelease);
+    TEST_RUN(TestSilenceThreshold);
+    TEST_RUN(TestStaleSlotReuse);
+    TEST_RUN(TestPublishOnlyOnChange);
+    TEST_RUN(TestAssignSlots);
+    TEST_RUN(TestNoAllocation);
+    return TEST_RESULT();
+}
@@ -0,0 +1,342 @@
+//
+//  AudioFrameRingTests.c
+//  tests
+//
+//  音频帧环形缓冲：预缓冲、写满丢帧、读空隐藏与淡入、延迟丢帧、目标深度自适应，
+//  以及生产者、消费者线程随机停顿下的并发压力测试（顺序、数据完整与计数守恒）
+//
+
+#include "AudioFrameRing.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    Samples = 48,
+    Channels = 2,
+    FrameLength = Samples * Channels,
+};
+
+/// 第 sequence 帧的内容：前两个采样点存放序号，其余采样点由序号与位置决定，读出后可检查是否撕裂
+static void FillFrame(int16_t *frame, uint32_t sequence) {
+    frame[0] = (int16_t)(sequence & 0x7FFF);
+    frame[1] = (int16_t)((sequence >> 15) & 0x7FFF);
+    for (int i = 2; i < FrameLength; i++) {
+        frame[i] = (int16_t)((sequence * 31u + (uint32_t)i * 7u) & 0x3FFF);
+    }
+}
+
+/// 帧内容与 FillFrame 一致时返回帧序号，否则返回 -1
+static long FrameSequence(const int16_t *frame) {
+    uint32_t sequence = (uint32_t)frame[0] | ((uint32_t)frame[1] << 15);
+    for (int i = 2; i < FrameLength; i++) {
+        if (frame[i] != (int16_t)((sequence * 31u + (uint32_t)i * 7u) & 0x3FFF)) {
+            return -1;
+        }
+    }
+    return (long)sequence;
+}
+
+static AudioFrameRing *CreateRing(size_t capacity, size_t minTarget, size_t maxTarget, AudioFrameRingConcealment concealment) {
+    AudioFrameRingConfig config = AudioFrameRingDefaultConfig(Samples, Channels);
+    config.capacity = capacity;
+    config.minTargetDepth = minTarget;
+    config.maxTargetDepth = maxTarget;
+    config.concealment = concealment;
+    return AudioFrameRingCreate(&config);
+}
+
+static void TestRejectsInvalidConfig(void) {
+    TEST_CHECK(AudioFrameRingCreate(NULL) == NULL);
+    TEST_CHECK(CreateRing(1, 1, 1, AudioFrameRingConcealRepeat) == NULL);
+    TEST_CHECK(CreateRing(8, 0, 4, AudioFrameRingConcealRepeat) == NULL);
+    TEST_CHECK(CreateRing(8, 5, 4, AudioFrameRingConcealRepeat) == NULL);
+    // 目标深度上限必须小于容量
+    TEST_CHECK(CreateRing(8, 2, 8, AudioFrameRingConcealRepeat) == NULL);
+    AudioFrameRingConfig config = AudioFrameRingDefaultConfig(0, Channels);
+    TEST_CHECK(AudioFrameRingCreate(&config) == NULL);
+    config = AudioFrameRingDefaultConfig(Samples, 0);
+    TEST_CHECK(AudioFrameRingCreate(&config) == NULL);
+
+    AudioFrameRing *ring = CreateRing(8, 2, 7, AudioFrameRingConcealRepeat);
+    TEST_CHECK(ring != NULL);
+    TEST_CHECK(AudioFrameRingFrameLength(ring) == FrameLength);
+    AudioFrameRingDestroy(ring);
+    AudioFrameRingDestroy(NULL);
+}
+
+/// 深度达到目标前输出静音，之后按写入顺序输出
+static void TestPrebufferThenInOrder(void) {
+    AudioFrameRing *ring = CreateRing(8, 3, 6, AudioFrameRingConcealRepeat);
+    int16_t frame[FrameLength];
+    int16_t out[FrameLength];
+    for (uint32_t i = 0; i < 2; i++) {
+        FillFrame(frame, i);
+        TEST_CHECK(AudioFrameRingWrite(ring, frame));
+        memset(out, 0x55, sizeof(out));
+        TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadPrebuffering);
+        TEST_CHECK(out[0] == 0 && out[FrameLength - 1] == 0);
+    }
+    FillFrame(frame, 2);
+    AudioFrameRingWrite(ring, frame);
+    for (long i = 0; i < 3; i++) {
+        TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadData);
+        TEST_CHECK(FrameSequence(out) == i);
+    }
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(ring, &stats);
+    TEST_CHECK(stats.writtenFrames == 3 && stats.readFrames == 3 && stats.depth == 0);
+    TEST_CHECK(stats.underruns == 0 && stats.concealedFrames == 0);
+    AudioFrameRingDestroy(ring);
+}
+
+/// 写满后丢弃新帧，已缓存的帧不受影响
+static void TestOverrunDropsNewest(void) {
+    AudioFrameRing *ring = CreateRing(4, 1, 3, AudioFrameRingConcealRepeat);
+    int16_t frame[FrameLength];
+    for (uint32_t i = 0; i < 4; i++) {
+        FillFrame(frame, i);
+        TEST_CHECK(AudioFrameRingWrite(ring, frame));
+    }
+    FillFrame(frame, 99);
+    TEST_CHECK(!AudioFrameRingWrite(ring, frame));
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(ring, &stats);
+    TEST_CHECK(stats.writtenFrames == 4 && stats.overrunDrops == 1 && stats.depth == 4);
+    AudioFrameRingDestroy(ring);
+}
+
+/// 读空后重复上一帧并逐帧衰减 6dB，4 帧后静音；目标深度加一，恢复后第一帧淡入
+static void TestUnderrunRepeatConcealment(void) {
+    AudioFrameRing *ring = CreateRing(8, 1, 4, AudioFrameRingConcealRepeat);
+    int16_t frame[FrameLength];
+    int16_t last[FrameLength];
+    int16_t out[FrameLength];
+    FillFrame(last, 7);
+    AudioFrameRingWrite(ring, last);
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadData);
+
+    for (int run = 0; run < 6; run++) {
+        TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadConcealed);
+        for (int i = 0; i < FrameLength; i++) {
+            int16_t expected = run < 4 ? (int16_t)(last[i] >> (run + 1)) : 0;
+            if (out[i] != expected) {
+                TEST_CHECK(out[i] == expected);
+                break;
+            }
+        }
+    }
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(ring, &stats);
+    // 连续读空只计一次，目标深度只上调一次
+    TEST_CHECK(stats.underruns == 1 && stats.concealedFrames == 6 && stats.targetDepth == 2);
+
+    // 深度未回到新目标前继续隐藏
+    FillFrame(frame, 8);
+    AudioFrameRingWrite(ring, frame);
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadConcealed);
+    FillFrame(frame, 9);
+    AudioFrameRingWrite(ring, frame);
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadData);
+    // 淡入：开头接近静音，末尾接近原值
+    FillFrame(frame, 8);
+    TEST_CHECK(abs(out[0]) <= abs(frame[0]) / Samples + 1);
+    TEST_CHECK(abs(out[FrameLength - 1] - frame[FrameLength - 1]) <= abs(frame[FrameLength - 1]) / Samples + 1);
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadData);
+    TEST_CHECK(FrameSequence(out) == 9);
+    AudioFrameRingDestroy(ring);
+}
+
+/// 淡出隐藏：第一帧在帧内线性淡出，之后静音
+static void TestUnderrunFadeConcealment(void) {
+    AudioFrameRing *ring = CreateRing(8, 1, 4, AudioFrameRingConcealFade);
+    int16_t last[FrameLength];
+    int16_t out[FrameLength];
+    FillFrame(last, 3);
+    AudioFrameRingWrite(ring, last);
+    AudioFrameRingRead(ring, out);
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadConcealed);
+    TEST_CHECK(out[0] == last[0] && out[1] == last[1]);
+    TEST_CHECK(abs(out[FrameLength - 1]) <= abs(last[FrameLength - 1]) / Samples + 1);
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadConcealed);
+    int silent = 1;
+    for (int i = 0; i < FrameLength; i++) {
+        silent &= out[i] == 0;
+    }
+    TEST_CHECK(silent);
+    AudioFrameRingDestroy(ring);
+}
+
+/// 深度超出 目标 + 2 时每次读取多丢一帧
+static void TestLatencyDrop(void) {
+    AudioFrameRing *ring = CreateRing(16, 2, 8, AudioFrameRingConcealRepeat);
+    int16_t frame[FrameLength];
+    int16_t out[FrameLength];
+    for (uint32_t i = 0; i < 6; i++) {
+        FillFrame(frame, i);
+        AudioFrameRingWrite(ring, frame);
+    }
+    // 深度 6 > 2 + 2：丢第 0 帧，读出第 1 帧
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadData);
+    TEST_CHECK(FrameSequence(out) == 1);
+    // 深度 4 不再丢帧
+    TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadData);
+    TEST_CHECK(FrameSequence(out) == 2);
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(ring, &stats);
+    TEST_CHECK(stats.latencyDrops == 1 && stats.readFrames == 2 && stats.depth == 3);
+    AudioFrameRingDestroy(ring);
+}
+
+/// 目标深度在读空后上调，持续富余约 200 次读取后下调，不低于下限
+static void TestTargetDepthAdapts(void) {
+    AudioFrameRing *ring = CreateRing(16, 2, 8, AudioFrameRingConcealRepeat);
+    int16_t frame[FrameLength];
+    int16_t out[FrameLength];
+    uint32_t sequence = 0;
+    // 预缓冲后读空三次，目标深度 2 → 5
+    for (int underrun = 0; underrun < 3; underrun++) {
+        AudioFrameRingStats stats;
+        AudioFrameRingGetStats(ring, &stats);
+        while (stats.depth < stats.targetDepth) {
+            FillFrame(frame, sequence++);
+            AudioFrameRingWrite(ring, frame);
+            AudioFrameRingGetStats(ring, &stats);
+        }
+        while (AudioFrameRingRead(ring, out) == AudioFrameRingReadData) {
+        }
+    }
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(ring, &stats);
+    TEST_CHECK(stats.underruns == 3 && stats.targetDepth == 5);
+
+    // 每次读取前保持深度 = 目标 + 1，富余持续一个窗口后目标减一
+    for (int read = 0; read < 200 * 6; read++) {
+        AudioFrameRingGetStats(ring, &stats);
+        while (stats.depth < stats.targetDepth + 1) {
+            FillFrame(frame, sequence++);
+            AudioFrameRingWrite(ring, frame);
+            AudioFrameRingGetStats(ring, &stats);
+        }
+        TEST_CHECK(AudioFrameRingRead(ring, out) == AudioFrameRingReadData);
+    }
+    AudioFrameRingGetStats(ring, &stats);
+    TEST_CHECK(stats.targetDepth == 2);
+    TEST_CHECK(stats.latencyDrops == 0);
+    AudioFrameRingDestroy(ring);
+}
+
+// 并发压力
+
+enum {
+    StressFrames = 1000000,
+};
+
+static AudioFrameRing *stressRing;
+static _Atomic bool producerDone;
+
+static void RandomPause(unsigned *seed) {
+    // 约 1/64 的概率停顿，模拟线程调度与回调周期抖动
+    if (rand_r(seed) % 64 == 0) {
+        for (volatile int i = 0; i < (int)(rand_r(seed) % 4000); i++) {
+        }
+    }
+}
+
+static void *StressProducer(void *argument) {
+    int16_t frame[FrameLength];
+    unsigned seed = 1;
+    for (uint32_t sequence = 0; sequence < StressFrames; sequence++) {
+        FillFrame(frame, sequence);
+        if (!AudioFrameRingWrite(stressRing, frame)) {
+            // 写满时让出 CPU，近似真实采集的节奏，单核机器上消费者也能跟上
+            sched_yield();
+        }
+        RandomPause(&seed);
+    }
+    atomic_store(&producerDone, true);
+    return NULL;
+}
+
+/// 读出的帧序号严格递增（丢帧只会跳号）、内容完整；结束后各计数守恒；读写路径不分配内存
+static void TestConcurrentStress(void) {
+    AudioFrameRingConfig config = AudioFrameRingDefaultConfig(Samples, Channels);
+    config.capacity = 8;
+    config.maxTargetDepth = 6;
+    stressRing = AudioFrameRingCreate(&config);
+    atomic_store(&producerDone, false);
+    size_t allocsBefore = TestAllocCount();
+    pthread_t producer;
+    pthread_create(&producer, NULL, StressProducer, NULL);
+
+    int16_t out[FrameLength];
+    unsigned seed = 7;
+    long lastSequence = -1;
+    long torn = 0, outOfOrder = 0, dataFrames = 0, fadedFrames = 0;
+    bool concealedSinceData = false;
+    for (;;) {
+        bool done = atomic_load(&producerDone);
+        AudioFrameRingReadResult result = AudioFrameRingRead(stressRing, out);
+        if (result == AudioFrameRingReadData) {
+            dataFrames++;
+            if (concealedSinceData) {
+                // 恢复后第一帧经过淡入，内容无法校验
+                fadedFrames++;
+                concealedSinceData = false;
+            } else {
+                long sequence = FrameSequence(out);
+                if (sequence < 0) {
+                    torn++;
+                } else if (sequence <= lastSequence) {
+                    outOfOrder++;
+                }
+                lastSequence = sequence > lastSequence ? sequence : lastSequence;
+            }
+        } else if (result == AudioFrameRingReadConcealed) {
+            concealedSinceData = true;
+        }
+        if (done && result != AudioFrameRingReadData) {
+            // 生产者已结束：读空，或剩余深度不足目标停在预缓冲
+            break;
+        }
+        if (result != AudioFrameRingReadData) {
+            sched_yield();
+        }
+        RandomPause(&seed);
+    }
+    pthread_join(producer, NULL);
+    size_t allocs = TestAllocCount() - allocsBefore;
+
+    AudioFrameRingStats stats;
+    AudioFrameRingGetStats(stressRing, &stats);
+    TEST_CHECK(dataFrames > 0);
+    TEST_CHECK(torn == 0);
+    TEST_CHECK(outOfOrder == 0);
+    TEST_CHECK(stats.writtenFrames + stats.overrunDrops == StressFrames);
+    TEST_CHECK(stats.readFrames + stats.latencyDrops + stats.depth == stats.writtenFrames);
+    TEST_CHECK(stats.readFrames == (uint64_t)dataFrames);
+    TEST_CHECK(stats.targetDepth >= config.minTargetDepth && stats.targetDepth <= config.maxTargetDepth);
+    // pthread_create 本身会分配线程栈等，只允许少量分配
+    TEST_CHECK(allocs <= 4);
+    printf("  %ld data (%ld faded), overrun %llu, latency drops %llu, underruns %llu, concealed %llu, target %zu\n",
+           dataFrames, fadedFrames, (unsigned long long)stats.overrunDrops, (unsigned long long)stats.latencyDrops,
+           (unsigned long long)stats.underruns, (unsigned long long)stats.concealedFrames, stats.targetDepth);
+    AudioFrameRingDestroy(stressRing);
+}
+
+int main(void) {
+    TEST_RUN(TestRejectsInvalidConfig);
+    TEST_RUN(TestPrebufferThenInOrder);
+    TEST_RUN(TestOverrunDropsNewest);
+    TEST_RUN(TestUnderrunRepeatConcealment);
+    TEST_RUN(TestUnderrunFadeConcealment);
+    TEST_RUN(TestLatencyDrop);
+    TEST_RUN(TestTargetDepthAdapts);
+    TEST_RUN(TestConcurrentStress);
+    return TEST_RESULT();
+}
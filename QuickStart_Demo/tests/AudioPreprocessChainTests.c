@@ -0,0 +1,326 @@
+//
+//  AudioPreprocessChainTests.c
+//  tests
+//
+//  音频前处理链：参数检查、SIMD 与标量一致（逐点级 1 LSB 以内，IIR 级误差有界）、高通与去直流的频率响应、
+//  增益渐变、软限幅不削波、全部禁用时原样输出，以及处理与改参数时不分配内存
+//
+
+#include "AudioPreprocessChain.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    MaxFrames = 1200,
+};
+
+/// 语音通话常用的完整处理链
+static const AudioStageType fullChain[] = {
+    AudioStageDCRemoval,
+    AudioStageHighPass,
+    AudioStageGain,
+    AudioStageSoftLimiter,
+};
+enum {
+    FullChainCount = sizeof(fullChain) / sizeof(fullChain[0]),
+    GainStageIndex = 2,
+};
+
+static void FillSineS16(int16_t *samples, size_t frames, unsigned channels, double frequency, double sampleRate,
+                        double amplitude, size_t phase) {
+    for (size_t i = 0; i < frames; i++) {
+        double value = amplitude * sin(2 * M_PI * frequency * (double)(i + phase) / sampleRate);
+        for (unsigned c = 0; c < channels; c++) {
+            samples[i * channels + c] = (int16_t)lrint(value);
+        }
+    }
+}
+
+/// 单声道信号的均方根
+static double RmsS16(const int16_t *samples, size_t count) {
+    double sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += (double)samples[i] * samples[i];
+    }
+    return sqrt(sum / (double)count);
+}
+
+/// 单声道正弦流经处理链 seconds 秒后，最后 100ms 的均方根增益（dB）
+static double MeasureGainDb(AudioPreprocessChain *chain, double frequency, unsigned sampleRate, double seconds) {
+    size_t frames = sampleRate / 100;
+    int16_t block[MaxFrames];
+    size_t blocks = (size_t)(seconds * 100);
+    double inputRms = 0, outputRms = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        FillSineS16(block, frames, 1, frequency, sampleRate, 10000, b * frames);
+        double rms = RmsS16(block, frames);
+        AudioPreprocessChainProcessS16(chain, block, frames, 1, sampleRate);
+        if (b + 10 >= blocks) {
+            inputRms += rms;
+            outputRms += RmsS16(block, frames);
+        }
+    }
+    return 20 * log10(outputRms / inputRms);
+}
+
+/// 非法参数返回 NULL 或 false，合法链保留处理级顺序
+static void TestCreateValidation(void) {
+    AudioStageType invalid[] = {AudioStageGain, AudioStageTypeCount};
+    AudioStageType tooMany[AUDIO_PREPROCESS_MAX_STAGES + 1] = {0};
+    TEST_CHECK(AudioPreprocessChainCreate(NULL, 1) == NULL);
+    TEST_CHECK(AudioPreprocessChainCreate(fullChain, 0) == NULL);
+    TEST_CHECK(AudioPreprocessChainCreate(invalid, 2) == NULL);
+    TEST_CHECK(AudioPreprocessChainCreate(tooMany, AUDIO_PREPROCESS_MAX_STAGES + 1) == NULL);
+
+    AudioPreprocessChain *chain = AudioPreprocessChainCreate(fullChain, FullChainCount);
+    TEST_CHECK(chain != NULL);
+    TEST_CHECK(AudioPreprocessChainStageCount(chain) == FullChainCount);
+    for (size_t i = 0; i < FullChainCount; i++) {
+        TEST_CHECK(AudioPreprocessChainStageType(chain, i) == fullChain[i]);
+    }
+    TEST_CHECK(AudioPreprocessChainSetStageParam(chain, GainStageIndex, 6.0f));
+    TEST_CHECK(!AudioPreprocessChainSetStageParam(chain, FullChainCount, 6.0f));
+    TEST_CHECK(!AudioPreprocessChainSetStageParam(chain, GainStageIndex, NAN));
+    TEST_CHECK(!AudioPreprocessChainSetStageEnabled(chain, FullChainCount, false));
+    // 三声道不处理，数据原样保留
+    int16_t samples[3 * 8];
+    for (int i = 0; i < 3 * 8; i++) {
+        samples[i] = (int16_t)(i * 1000);
+    }
+    AudioPreprocessChainProcessS16(chain, samples, 8, 3, 48000);
+    TEST_CHECK(samples[5] == 5000 && samples[23] == 23000);
+    AudioPreprocessChainDestroy(chain);
+}
+
+/// 两条相同的链分别走 SIMD 与标量，在随机块长、改增益与切换采样率下比较输出，返回最大差值（LSB）
+/// 与差值相对信号的 SNR（dB）
+static int CompareSimdWithScalar(const AudioStageType *stages, size_t count, unsigned channels, int gainIndex,
+                                 double *snr) {
+    static const unsigned sampleRates[] = {16000, 48000};
+    AudioPreprocessChain *simd = AudioPreprocessChainCreate(stages, count);
+    AudioPreprocessChain *scalar = AudioPreprocessChainCreate(stages, count);
+    AudioPreprocessChainSetScalarOnly(scalar, true);
+    int16_t simdSamples[AUDIO_PREPROCESS_MAX_CHANNELS * MaxFrames];
+    int16_t scalarSamples[AUDIO_PREPROCESS_MAX_CHANNELS * MaxFrames];
+    int maxDiff = 0;
+    double signal = 0, error = 0;
+    size_t compared = 0;
+    srand(channels + 200 * (unsigned)count);
+    for (int round = 0; round < 2; round++) {
+        unsigned sampleRate = sampleRates[round];
+        for (int block = 0; block < 60; block++) {
+            // 块长覆盖不足一个向量、非整数倍与超过内部分块的情况
+            size_t frames = 1 + (size_t)rand() % MaxFrames;
+            // 随机噪声叠加直流与工频，接近满幅以触发限幅
+            for (size_t i = 0; i < frames; i++) {
+                double hum = 8000 * sin(2 * M_PI * 50 * (double)(compared + i) / sampleRate);
+                for (unsigned c = 0; c < channels; c++) {
+                    int value = rand() % 40000 - 20000 + (int)hum + 2000;
+                    simdSamples[i * channels + c] = (int16_t)(value > 32767 ? 32767 : value < -32768 ? -32768 : value);
+                }
+            }
+            memcpy(scalarSamples, simdSamples, frames * channels * sizeof(int16_t));
+            if (gainIndex >= 0 && block % 20 == 10) {
+                float gainDb = (float)(rand() % 25 - 12);
+                AudioPreprocessChainSetStageParam(simd, (size_t)gainIndex, gainDb);
+                AudioPreprocessChainSetStageParam(scalar, (size_t)gainIndex, gainDb);
+            }
+            AudioPreprocessChainProcessS16(simd, simdSamples, frames, channels, sampleRate);
+            AudioPreprocessChainProcessS16(scalar, scalarSamples, frames, channels, sampleRate);
+            for (size_t i = 0; i < frames * channels; i++) {
+                int diff = abs(simdSamples[i] - scalarSamples[i]);
+                maxDiff = diff > maxDiff ? diff : maxDiff;
+                error += (double)diff * diff;
+                signal += (double)scalarSamples[i] * scalarSamples[i];
+            }
+            compared += frames;
+        }
+    }
+    *snr = error > 0 ? 10 * log10(signal / error) : INFINITY;
+    AudioPreprocessChainDestroy(simd);
+    AudioPreprocessChainDestroy(scalar);
+    return maxDiff;
+}
+
+/// 增益与软限幅逐样本计算，SIMD 与标量相差不超过 1 LSB
+static void TestSimdMatchesScalarPointwise(void) {
+    AudioStageType stages[] = {AudioStageGain, AudioStageSoftLimiter};
+    for (unsigned channels = 1; channels <= AUDIO_PREPROCESS_MAX_CHANNELS; channels++) {
+        double snr = 0;
+        int maxDiff = CompareSimdWithScalar(stages, 2, channels, 0, &snr);
+        printf("  gain + limiter, %u channel(s): max diff %d LSB\n", channels, maxDiff);
+        TEST_CHECK(maxDiff <= 1);
+    }
+}
+
+/// 二阶 IIR 的 SIMD 分块形式与标量递推的舍入不同，极点接近 1 时反馈会放大 float 舍入误差；
+/// 完整处理链的差值限制在几十 LSB 以内且远低于信号
+static void TestSimdMatchesScalarRecursive(void) {
+    for (unsigned channels = 1; channels <= AUDIO_PREPROCESS_MAX_CHANNELS; channels++) {
+        double snr = 0;
+        int maxDiff = CompareSimdWithScalar(fullChain, FullChainCount, channels, GainStageIndex, &snr);
+        printf("  full chain, %u channel(s): max diff %d LSB, difference %.1f dB below signal\n", channels, maxDiff,
+               snr);
+        TEST_CHECK(maxDiff <= 64);
+        TEST_CHECK(snr > 65);
+    }
+}
+
+/// 高通在截止频率以下约 12 dB/倍频程衰减，通带不变；两种实现一致
+static void TestHighPassResponse(void) {
+    AudioStageType stages[] = {AudioStageHighPass};
+    for (int scalarOnly = 0; scalarOnly <= 1; scalarOnly++) {
+        AudioPreprocessChain *chain = AudioPreprocessChainCreate(stages, 1);
+        AudioPreprocessChainSetScalarOnly(chain, scalarOnly);
+        double stop = MeasureGainDb(chain, 20, 48000, 1.0);
+        double cutoff = MeasureGainDb(chain, 80, 48000, 1.0);
+        double pass = MeasureGainDb(chain, 1000, 48000, 1.0);
+        printf("  %s: 20 Hz %.1f dB, 80 Hz %.1f dB, 1 kHz %.2f dB\n", scalarOnly ? "scalar" : "simd", stop, cutoff,
+               pass);
+        TEST_CHECK(stop < -20);
+        TEST_CHECK(fabs(cutoff + 3) < 0.5);
+        TEST_CHECK(fabs(pass) < 0.1);
+        AudioPreprocessChainDestroy(chain);
+    }
+}
+
+/// 去直流在时间常数的数倍后把恒定偏移降到接近 0，语音频段不受影响
+static void TestDCRemoval(void) {
+    AudioStageType stages[] = {AudioStageDCRemoval};
+    AudioPreprocessChain *chain = AudioPreprocessChainCreate(stages, 1);
+    int16_t block[480];
+    for (int b = 0; b < 200; b++) {
+        for (int i = 0; i < 480; i++) {
+            block[i] = 8000;
+        }
+        AudioPreprocessChainProcessS16(chain, block, 480, 1, 48000);
+    }
+    // 2 秒为 10 个时间常数
+    TEST_CHECK(abs(block[0]) <= 2 && abs(block[479]) <= 2);
+    AudioPreprocessChainDestroy(chain);
+
+    chain = AudioPreprocessChainCreate(stages, 1);
+    TEST_CHECK(fabs(MeasureGainDb(chain, 300, 16000, 1.0)) < 0.1);
+    AudioPreprocessChainDestroy(chain);
+}
+
+/// 首块直接使用目标增益，之后改参数在一块内线性过渡，下一块起保持新增益
+static void TestGainRamp(void) {
+    AudioStageType stages[] = {AudioStageGain};
+    AudioPreprocessChain *chain = AudioPreprocessChainCreate(stages, 1);
+    AudioPreprocessChainSetStageParam(chain, 0, 20 * log10f(2.0f));
+    int16_t block[480];
+    for (int i = 0; i < 480; i++) {
+        block[i] = 1000;
+    }
+    AudioPreprocessChainProcessS16(chain, block, 480, 1, 48000);
+    TEST_CHECK(block[0] == 2000 && block[479] == 2000);
+
+    AudioPreprocessChainSetStageParam(chain, 0, 0.0f);
+    for (int i = 0; i < 480; i++) {
+        block[i] = 1000;
+    }
+    AudioPreprocessChainProcessS16(chain, block, 480, 1, 48000);
+    bool monotonic = true;
+    for (int i = 1; i < 480; i++) {
+        monotonic = monotonic && block[i] <= block[i - 1];
+    }
+    TEST_CHECK(monotonic);
+    TEST_CHECK(block[0] > 1990 && block[240] > 1400 && block[240] < 1600 && block[479] == 1000);
+
+    for (int i = 0; i < 480; i++) {
+        block[i] = 1000;
+    }
+    AudioPreprocessChainProcessS16(chain, block, 480, 1, 48000);
+    TEST_CHECK(block[0] == 1000 && block[479] == 1000);
+    AudioPreprocessChainDestroy(chain);
+}
+
+/// 软限幅：拐点以下原样输出，提升 12 dB 的满幅正弦也不削波
+static void TestSoftLimiter(void) {
+    AudioStageType stages[] = {AudioStageGain, AudioStageSoftLimiter};
+    for (int scalarOnly = 0; scalarOnly <= 1; scalarOnly++) {
+        AudioPreprocessChain *chain = AudioPreprocessChainCreate(stages, 2);
+        AudioPreprocessChainSetScalarOnly(chain, scalarOnly);
+        int16_t block[480];
+        int16_t input[480];
+        FillSineS16(input, 480, 1, 1000, 48000, 20000, 0);
+        memcpy(block, input, sizeof(block));
+        AudioPreprocessChainProcessS16(chain, block, 480, 1, 48000);
+        TEST_CHECK(memcmp(block, input, sizeof(block)) == 0);
+
+        AudioPreprocessChainSetStageParam(chain, 0, 12.0f);
+        int peak = 0;
+        for (int b = 0; b < 10; b++) {
+            FillSineS16(block, 480, 1, 1000, 48000, 32767, 0);
+            AudioPreprocessChainProcessS16(chain, block, 480, 1, 48000);
+            for (int i = 0; i < 480; i++) {
+                peak = abs(block[i]) > peak ? abs(block[i]) : peak;
+            }
+        }
+        printf("  %s: peak %d for +12 dB full-scale input\n", scalarOnly ? "scalar" : "simd", peak);
+        TEST_CHECK(peak > 32000 && peak < INT16_MAX);
+        AudioPreprocessChainDestroy(chain);
+    }
+}
+
+/// 全部禁用时数据原样输出，重新启用后恢复处理
+static void TestDisabledStagesPassThrough(void) {
+    AudioPreprocessChain *chain = AudioPreprocessChainCreate(fullChain, FullChainCount);
+    for (size_t i = 0; i < FullChainCount; i++) {
+        AudioPreprocessChainSetStageEnabled(chain, i, false);
+    }
+    int16_t block[2 * 480];
+    int16_t input[2 * 480];
+    for (int i = 0; i < 2 * 480; i++) {
+        input[i] = (int16_t)(i * 67 - 32000);
+    }
+    memcpy(block, input, sizeof(block));
+    AudioPreprocessChainProcessS16(chain, block, 480, 2, 48000);
+    TEST_CHECK(memcmp(block, input, sizeof(block)) == 0);
+
+    AudioPreprocessChainSetStageEnabled(chain, 0, true);
+    AudioPreprocessChainProcessS16(chain, block, 480, 2, 48000);
+    TEST_CHECK(memcmp(block, input, sizeof(block)) != 0);
+    AudioPreprocessChainDestroy(chain);
+}
+
+/// 处理、改参数、启停处理级与切换采样率声道数都不分配内存
+static void TestNoAllocationOnProcess(void) {
+    AudioPreprocessChain *chain = AudioPreprocessChainCreate(fullChain, FullChainCount);
+    int16_t block[2 * MaxFrames];
+    FillSineS16(block, MaxFrames, 2, 440, 48000, 12000, 0);
+    uint64_t allocations = TestAllocCount();
+    for (int i = 0; i < 500; i++) {
+        unsigned sampleRate = (i / 100) % 2 ? 16000 : 48000;
+        unsigned channels = (i / 50) % 2 ? 1 : 2;
+        size_t frames = i % 7 == 0 ? MaxFrames : sampleRate / 100;
+        if (i % 10 == 0) {
+            AudioPreprocessChainSetStageParam(chain, GainStageIndex, (float)(i % 13) - 6.0f);
+            AudioPreprocessChainSetStageParam(chain, 1, 60.0f + (float)(i % 40));
+            AudioPreprocessChainSetStageEnabled(chain, 0, i % 20 != 0);
+            AudioPreprocessChainSetScalarOnly(chain, i % 30 == 0);
+        }
+        AudioPreprocessChainProcessS16(chain, block, frames, channels, sampleRate);
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    printf("  allocations in 500 process calls: %llu\n", (unsigned long long)(TestAllocCount() - allocations));
+    AudioPreprocessChainDestroy(chain);
+}
+
+int main(void) {
+    TEST_RUN(TestCreateValidation);
+    TEST_RUN(TestSimdMatchesScalarPointwise);
+    TEST_RUN(TestSimdMatchesScalarRecursive);
+    TEST_RUN(TestHighPassResponse);
+    TEST_RUN(TestDCRemoval);
+    TEST_RUN(TestGainRamp);
+    TEST_RUN(TestSoftLimiter);
+    TEST_RUN(TestDisabledStagesPassThrough);
+    TEST_RUN(TestNoAllocationOnProcess);
+    return TEST_RESULT();
+}
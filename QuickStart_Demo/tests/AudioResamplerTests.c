@@ -0,0 +1,369 @@
+//
+//  AudioResamplerTests.c
+//  tests
+//
+//  采样率转换：输出帧数与比例、通带纹波与 SNR、降采样阻带衰减、分块无关性、SIMD 与标量一致、
+//  群延迟、reset 与容量检查，以及处理时不分配内存
+//
+
+#include "AudioResampler.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// 覆盖 AudioSampleRate 之间常见的升降采样
+static const unsigned ratePairs[][2] = {
+    {48000, 44100},
+    {44100, 48000},
+    {16000, 48000},
+    {48000, 16000},
+    {44100, 16000},
+    {8000, 32000},
+};
+enum {
+    RatePairCount = sizeof(ratePairs) / sizeof(ratePairs[0]),
+    MaxInputFrames = 480,
+};
+
+/// 按随机块长流式处理整段单声道 float 输入，返回输出帧数
+static size_t ProcessInChunks(AudioResampler *resampler, const float *input, size_t frames, float *output,
+                              unsigned seed) {
+    size_t produced = 0;
+    size_t offset = 0;
+    srand(seed);
+    while (offset < frames) {
+        size_t chunk = 1 + (size_t)rand() % 700;
+        if (offset + chunk > frames) {
+            chunk = frames - offset;
+        }
+        produced += AudioResamplerProcessFloat(resampler, input + offset, chunk, output + produced,
+                                               AudioResamplerMaxOutputFrames(resampler, chunk));
+        offset += chunk;
+    }
+    return produced;
+}
+
+/// 最小二乘拟合频率为 frequency 的正弦，返回幅度与残差 SNR（dB）
+static void FitSine(const float *samples, size_t count, double frequency, double sampleRate, double *amplitude,
+                    double *snr) {
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+    for (size_t i = 0; i < count; i++) {
+        double s = sin(2 * M_PI * frequency * i / sampleRate);
+        double c = cos(2 * M_PI * frequency * i / sampleRate);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += samples[i] * s;
+        yc += samples[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+    double error = 0, power = 0;
+    for (size_t i = 0; i < count; i++) {
+        double model = a * sin(2 * M_PI * frequency * i / sampleRate) + b * cos(2 * M_PI * frequency * i / sampleRate);
+        error += (samples[i] - model) * (samples[i] - model);
+        power += model * model;
+    }
+    *amplitude = sqrt(a * a + b * b);
+    *snr = 10 * log10(power / error);
+}
+
+static void FillSine(float *samples, size_t count, double frequency, double sampleRate, float amplitude) {
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = amplitude * (float)sin(2 * M_PI * frequency * i / sampleRate);
+    }
+}
+
+static void TestInvalidConfig(void) {
+    TEST_CHECK(AudioResamplerCreate(0, 48000, 1, MaxInputFrames, 0) == NULL);
+    TEST_CHECK(AudioResamplerCreate(48000, 0, 1, MaxInputFrames, 0) == NULL);
+    TEST_CHECK(AudioResamplerCreate(48000, 44100, 0, MaxInputFrames, 0) == NULL);
+    TEST_CHECK(AudioResamplerCreate(48000, 44100, AUDIO_RESAMPLER_MAX_CHANNELS + 1, MaxInputFrames, 0) == NULL);
+    TEST_CHECK(AudioResamplerCreate(48000, 44100, 1, 0, 0) == NULL);
+    // 互质的采样率使相数过大
+    TEST_CHECK(AudioResamplerCreate(48000, 47999, 1, MaxInputFrames, 0) == NULL);
+}
+
+/// 累计输出帧数跟随 outputRate / inputRate，误差不超过一帧
+static void TestOutputFrameCount(void) {
+    for (int k = 0; k < RatePairCount; k++) {
+        unsigned inputRate = ratePairs[k][0];
+        unsigned outputRate = ratePairs[k][1];
+        AudioResampler *resampler = AudioResamplerCreate(inputRate, outputRate, 1, MaxInputFrames, 0);
+        TEST_CHECK(resampler != NULL);
+        if (!resampler) {
+            continue;
+        }
+        size_t frames = inputRate;
+        float *input = calloc(frames, sizeof(float));
+        float *output = malloc(AudioResamplerMaxOutputFrames(resampler, frames) * sizeof(float));
+        size_t produced = ProcessInChunks(resampler, input, frames, output, k + 1);
+        double expected = (double)frames * outputRate / inputRate;
+        TEST_CHECK(fabs((double)produced - expected) <= 1.0);
+        free(input);
+        free(output);
+        AudioResamplerDestroy(resampler);
+    }
+
+    // 相同采样率直通
+    AudioResampler *bypass = AudioResamplerCreate(48000, 48000, 2, MaxInputFrames, 0);
+    int16_t input[2 * 100];
+    int16_t output[2 * 100];
+    for (int i = 0; i < 200; i++) {
+        input[i] = (int16_t)(i * 97 - 9000);
+    }
+    TEST_CHECK(AudioResamplerDelayInputFrames(bypass) == 0);
+    TEST_CHECK(AudioResamplerProcessS16(bypass, input, 100, output, 100) == 100);
+    TEST_CHECK(memcmp(input, output, sizeof(input)) == 0);
+    AudioResamplerDestroy(bypass);
+}
+
+/// 0.85 倍奈奎斯特频率以内的正弦：幅度纹波 < 0.01 dB，SNR > 70 dB
+static void TestPassband(void) {
+    for (int k = 0; k < RatePairCount; k++) {
+        unsigned inputRate = ratePairs[k][0];
+        unsigned outputRate = ratePairs[k][1];
+        size_t frames = inputRate / 2;
+        double nyquist = 0.5 * (inputRate < outputRate ? inputRate : outputRate);
+        float *input = malloc(frames * sizeof(float));
+        float *output = malloc((frames * outputRate / inputRate + 1024) * sizeof(float));
+        double minGain = 1e9, maxGain = 0, minSnr = 1e9;
+        for (int step = 0; step <= 8; step++) {
+            double frequency = 100 + (0.85 * nyquist - 100) * step / 8;
+            AudioResampler *resampler = AudioResamplerCreate(inputRate, outputRate, 1, MaxInputFrames, 0);
+            FillSine(input, frames, frequency, inputRate, 0.5f);
+            size_t produced = ProcessInChunks(resampler, input, frames, output, step + 1);
+            // 跳过开头的滤波器建立过程
+            size_t skip = 200;
+            double amplitude, snr;
+            FitSine(output + skip, produced - 2 * skip, frequency, outputRate, &amplitude, &snr);
+            double gain = amplitude / 0.5;
+            minGain = gain < minGain ? gain : minGain;
+            maxGain = gain > maxGain ? gain : maxGain;
+            minSnr = snr < minSnr ? snr : minSnr;
+            AudioResamplerDestroy(resampler);
+        }
+        double ripple = 20 * log10(maxGain / minGain);
+        TEST_CHECK(ripple < 0.01);
+        TEST_CHECK(minGain > 0.998 && maxGain < 1.002);
+        TEST_CHECK(minSnr > 70);
+        printf("  %5u -> %5u  ripple %.4f dB  SNR %.1f dB\n", inputRate, outputRate, ripple, minSnr);
+        free(input);
+        free(output);
+    }
+}
+
+/// 降采样时高于输出奈奎斯特频率的正弦被衰减 80 dB 以上，不会混叠进通带
+static void TestStopband(void) {
+    for (int k = 0; k < RatePairCount; k++) {
+        unsigned inputRate = ratePairs[k][0];
+        unsigned outputRate = ratePairs[k][1];
+        if (outputRate >= inputRate) {
+            continue;
+        }
+        size_t frames = inputRate / 2;
+        float *input = malloc(frames * sizeof(float));
+        float *output = malloc((frames * outputRate / inputRate + 1024) * sizeof(float));
+        double worst = -1000;
+        int tones = 0;
+        for (double ratio = 1.05; ratio < 1.9 && ratio * 0.5 * outputRate < 0.5 * inputRate; ratio += 0.2) {
+            AudioResampler *resampler = AudioResamplerCreate(inputRate, outputRate, 1, MaxInputFrames, 0);
+            FillSine(input, frames, ratio * 0.5 * outputRate, inputRate, 0.5f);
+            size_t produced = ProcessInChunks(resampler, input, frames, output, 7);
+            double energy = 0;
+            for (size_t i = 200; i < produced; i++) {
+                energy += (double)output[i] * output[i];
+            }
+            // 相对输入正弦功率 0.125
+            double level = 10 * log10(energy / (produced - 200) / 0.125);
+            worst = level > worst ? level : worst;
+            tones++;
+            AudioResamplerDestroy(resampler);
+        }
+        TEST_CHECK(tones > 0);
+        TEST_CHECK(worst < -80);
+        printf("  %5u -> %5u  stopband %.1f dB\n", inputRate, outputRate, worst);
+        free(input);
+        free(output);
+    }
+}
+
+/// 输出只取决于输入序列，与每次调用的块长（包括超过 maxInputFrames 的块）无关
+static void TestChunkingInvariance(void) {
+    AudioResampler *whole = AudioResamplerCreate(44100, 48000, 1, MaxInputFrames, 0);
+    AudioResampler *chunked = AudioResamplerCreate(44100, 48000, 1, MaxInputFrames, 0);
+    size_t frames = 44100 / 4;
+    float *input = malloc(frames * sizeof(float));
+    float *wholeOutput = malloc(AudioResamplerMaxOutputFrames(whole, frames) * sizeof(float));
+    float *chunkedOutput = malloc(AudioResamplerMaxOutputFrames(chunked, frames) * sizeof(float));
+    srand(11);
+    for (size_t i = 0; i < frames; i++) {
+        input[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+    size_t wholeFrames = AudioResamplerProcessFloat(whole, input, frames, wholeOutput,
+                                                    AudioResamplerMaxOutputFrames(whole, frames));
+    size_t chunkedFrames = ProcessInChunks(chunked, input, frames, chunkedOutput, 3);
+    TEST_CHECK(wholeFrames == chunkedFrames);
+    TEST_CHECK(memcmp(wholeOutput, chunkedOutput, wholeFrames * sizeof(float)) == 0);
+
+    // reset 后与新建的转换器输出一致
+    AudioResamplerReset(whole);
+    size_t resetFrames = AudioResamplerProcessFloat(whole, input, frames, chunkedOutput,
+                                                    AudioResamplerMaxOutputFrames(whole, frames));
+    TEST_CHECK(resetFrames == wholeFrames);
+    TEST_CHECK(memcmp(wholeOutput, chunkedOutput, wholeFrames * sizeof(float)) == 0);
+    free(input);
+    free(wholeOutput);
+    free(chunkedOutput);
+    AudioResamplerDestroy(whole);
+    AudioResamplerDestroy(chunked);
+}
+
+/// SIMD 与标量实现在 S16 立体声上相差不超过 1 LSB，两个声道互不串扰
+static void TestSimdMatchesScalar(void) {
+    for (int k = 0; k < RatePairCount; k++) {
+        unsigned inputRate = ratePairs[k][0];
+        unsigned outputRate = ratePairs[k][1];
+        AudioResampler *simd = AudioResamplerCreate(inputRate, outputRate, 2, MaxInputFrames, 0);
+        AudioResampler *scalar = AudioResamplerCreate(inputRate, outputRate, 2, MaxInputFrames, 0);
+        AudioResamplerSetScalarOnly(scalar, true);
+        size_t capacity = AudioResamplerMaxOutputFrames(simd, MaxInputFrames);
+        int16_t input[2 * MaxInputFrames];
+        int16_t *simdOutput = malloc(2 * capacity * sizeof(int16_t));
+        int16_t *scalarOutput = malloc(2 * capacity * sizeof(int16_t));
+        int maxDiff = 0;
+        bool rightSilent = true;
+        srand(k + 100);
+        for (int block = 0; block < 40; block++) {
+            // 左声道随机信号，右声道静音
+            for (int i = 0; i < MaxInputFrames; i++) {
+                input[2 * i] = (int16_t)(rand() % 40000 - 20000);
+                input[2 * i + 1] = 0;
+            }
+            size_t simdFrames = AudioResamplerProcessS16(simd, input, MaxInputFrames, simdOutput, capacity);
+            size_t scalarFrames = AudioResamplerProcessS16(scalar, input, MaxInputFrames, scalarOutput, capacity);
+            TEST_CHECK(simdFrames == scalarFrames);
+            for (size_t i = 0; i < 2 * simdFrames && simdFrames == scalarFrames; i++) {
+                int diff = abs(simdOutput[i] - scalarOutput[i]);
+                maxDiff = diff > maxDiff ? diff : maxDiff;
+            }
+            for (size_t i = 0; i < simdFrames; i++) {
+                rightSilent = rightSilent && simdOutput[2 * i + 1] == 0;
+            }
+        }
+        TEST_CHECK(maxDiff <= 1);
+        TEST_CHECK(rightSilent);
+        free(simdOutput);
+        free(scalarOutput);
+        AudioResamplerDestroy(simd);
+        AudioResamplerDestroy(scalar);
+    }
+}
+
+/// 满幅输入饱和到 int16 范围而不是回绕
+static void TestS16Saturation(void) {
+    AudioResampler *resampler = AudioResamplerCreate(16000, 48000, 1, MaxInputFrames, 0);
+    int16_t input[MaxInputFrames];
+    // 满幅方波在跳变处有吉布斯过冲
+    for (int i = 0; i < MaxInputFrames; i++) {
+        input[i] = (i / 20) % 2 ? INT16_MIN : INT16_MAX;
+    }
+    size_t capacity = AudioResamplerMaxOutputFrames(resampler, MaxInputFrames);
+    int16_t *output = malloc(capacity * sizeof(int16_t));
+    size_t produced = 0;
+    for (int block = 0; block < 4; block++) {
+        produced = AudioResamplerProcessS16(resampler, input, MaxInputFrames, output, capacity);
+    }
+    // 方波每半周期 60 个输出帧，同一半周期内的中段不会出现符号翻转
+    int wraps = 0;
+    for (size_t i = 1; i < produced; i++) {
+        wraps += abs(output[i] - output[i - 1]) > 30000;
+    }
+    TEST_CHECK(produced > 0);
+    TEST_CHECK(wraps == 0);
+    free(output);
+    AudioResamplerDestroy(resampler);
+}
+
+/// 脉冲响应的峰值位于 DelayInputFrames 换算到输出采样率的位置
+static void TestGroupDelay(void) {
+    for (int k = 0; k < RatePairCount; k++) {
+        unsigned inputRate = ratePairs[k][0];
+        unsigned outputRate = ratePairs[k][1];
+        AudioResampler *resampler = AudioResamplerCreate(inputRate, outputRate, 1, 4096, 0);
+        size_t frames = 4096;
+        size_t impulseAt = 1000;
+        float *input = calloc(frames, sizeof(float));
+        input[impulseAt] = 1.0f;
+        size_t capacity = AudioResamplerMaxOutputFrames(resampler, frames);
+        float *output = malloc(capacity * sizeof(float));
+        size_t produced = AudioResamplerProcessFloat(resampler, input, frames, output, capacity);
+        size_t peak = 0;
+        for (size_t i = 1; i < produced; i++) {
+            peak = fabsf(output[i]) > fabsf(output[peak]) ? i : peak;
+        }
+        double expected = (impulseAt + AudioResamplerDelayInputFrames(resampler)) * outputRate / inputRate;
+        TEST_CHECK(fabs((double)peak - expected) <= 1.0);
+        free(input);
+        free(output);
+        AudioResamplerDestroy(resampler);
+    }
+}
+
+/// 输出缓冲区小于 MaxOutputFrames 时不处理、不消费输入
+static void TestOutputCapacity(void) {
+    AudioResampler *resampler = AudioResamplerCreate(48000, 44100, 1, MaxInputFrames, 0);
+    AudioResampler *reference = AudioResamplerCreate(48000, 44100, 1, MaxInputFrames, 0);
+    float input[MaxInputFrames];
+    FillSine(input, MaxInputFrames, 1000, 48000, 0.5f);
+    size_t capacity = AudioResamplerMaxOutputFrames(resampler, MaxInputFrames);
+    float *output = malloc(capacity * sizeof(float));
+    float *referenceOutput = malloc(capacity * sizeof(float));
+    TEST_CHECK(AudioResamplerProcessFloat(resampler, input, MaxInputFrames, output, capacity - 1) == 0);
+    size_t produced = AudioResamplerProcessFloat(resampler, input, MaxInputFrames, output, capacity);
+    size_t referenceProduced = AudioResamplerProcessFloat(reference, input, MaxInputFrames, referenceOutput, capacity);
+    TEST_CHECK(produced > 0 && produced == referenceProduced);
+    TEST_CHECK(memcmp(output, referenceOutput, produced * sizeof(float)) == 0);
+    free(output);
+    free(referenceOutput);
+    AudioResamplerDestroy(resampler);
+    AudioResamplerDestroy(reference);
+}
+
+/// 创建后处理路径不再分配内存
+static void TestNoAllocationWhileProcessing(void) {
+    AudioResampler *resampler = AudioResamplerCreate(48000, 16000, 2, MaxInputFrames, 0);
+    int16_t input[2 * MaxInputFrames * 3];
+    for (int i = 0; i < 2 * MaxInputFrames * 3; i++) {
+        input[i] = (int16_t)(i * 31);
+    }
+    size_t capacity = AudioResamplerMaxOutputFrames(resampler, MaxInputFrames * 3);
+    int16_t *output = malloc(2 * capacity * sizeof(int16_t));
+    uint64_t allocations = TestAllocCount();
+    for (int block = 0; block < 100; block++) {
+        // 超过 maxInputFrames 的输入在内部分块
+        AudioResamplerProcessS16(resampler, input, MaxInputFrames * 3, output, capacity);
+        AudioResamplerReset(resampler);
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    free(output);
+    AudioResamplerDestroy(resampler);
+}
+
+int main(void) {
+    TEST_RUN(TestInvalidConfig);
+    TEST_RUN(TestOutputFrameCount);
+    TEST_RUN(TestPassband);
+    TEST_RUN(TestStopband);
+    TEST_RUN(TestChunkingInvariance);
+    TEST_RUN(TestSimdMatchesScalar);
+    TEST_RUN(TestS16Saturation);
+    TEST_RUN(TestGroupDelay);
+    TEST_RUN(TestOutputCapacity);
+    TEST_RUN(TestNoAllocationWhileProcessing);
+    return TEST_RESULT();
+}
@@ -0,0 +1,230 @@
+//
+//  EncodedFrameSlabTests.c
+//  tests
+//
+//  编码帧缓冲：容量取整、顺序与数据完整、回绕后数据连续、满时丢弃与释放、批量释放，
+//  以及单生产者单消费者压力测试与读写不分配内存
+//
+
+#include "EncodedFrameSlab.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+/// 由序号与位置确定的数据，读出时逐字节校验
+static void FillPayload(uint8_t *data, uint32_t size, uint32_t sequence) {
+    for (uint32_t i = 0; i < size; i++) {
+        data[i] = (uint8_t)(sequence * 31 + i);
+    }
+}
+
+static bool PayloadMatches(const uint8_t *data, uint32_t size, uint32_t sequence) {
+    for (uint32_t i = 0; i < size; i++) {
+        if (data[i] != (uint8_t)(sequence * 31 + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static EncodedFrameHeader HeaderForSequence(uint32_t sequence, uint32_t size) {
+    EncodedFrameHeader header = {
+        .ptsUs = (int64_t)sequence * 33333 + 1000,
+        .dtsUs = (int64_t)sequence * 33333,
+        .arrivalUs = (int64_t)sequence * 100,
+        .size = size,
+        .flags = sequence % 30 == 0 ? ENCODED_FRAME_FLAG_KEYFRAME : 0,
+        .width = 640,
+        .height = 360,
+        .rotation = 90,
+        .codec = EncodedFrameCodecH264,
+    };
+    return header;
+}
+
+static void TestCapacity(void) {
+    EncodedFrameSlab *slab = EncodedFrameSlabCreate(0);
+    TEST_CHECK(EncodedFrameSlabCapacity(slab) == 4096);
+    EncodedFrameSlabDestroy(slab);
+    slab = EncodedFrameSlabCreate(5000);
+    TEST_CHECK(EncodedFrameSlabCapacity(slab) == 8192);
+    TEST_CHECK(EncodedFrameSlabUsedBytes(slab) == 0);
+    EncodedFrameRecord record;
+    TEST_CHECK(!EncodedFrameSlabRead(slab, &record));
+    EncodedFrameSlabDestroy(slab);
+    EncodedFrameSlabDestroy(NULL);
+}
+
+/// 按写入顺序读出，记录头与数据不变，空数据的记录也保留
+static void TestOrderAndIntegrity(void) {
+    EncodedFrameSlab *slab = EncodedFrameSlabCreate(64 * 1024);
+    uint8_t data[1500];
+    uint32_t sizes[] = {1, 0, 7, 1500, 64, 333};
+    for (uint32_t i = 0; i < 6; i++) {
+        FillPayload(data, sizes[i], i);
+        EncodedFrameHeader header = HeaderForSequence(i, sizes[i]);
+        TEST_CHECK(EncodedFrameSlabWrite(slab, &header, data));
+    }
+    TEST_CHECK(EncodedFrameSlabWrittenFrames(slab) == 6);
+    for (uint32_t i = 0; i < 6; i++) {
+        EncodedFrameRecord record;
+        TEST_CHECK(EncodedFrameSlabRead(slab, &record));
+        EncodedFrameHeader expected = HeaderForSequence(i, sizes[i]);
+        TEST_CHECK(record.header.ptsUs == expected.ptsUs && record.header.dtsUs == expected.dtsUs &&
+                   record.header.arrivalUs == expected.arrivalUs && record.header.size == expected.size);
+        TEST_CHECK(record.header.flags == expected.flags && record.header.width == 640 &&
+                   record.header.height == 360 && record.header.rotation == 90 &&
+                   record.header.codec == EncodedFrameCodecH264);
+        TEST_CHECK(PayloadMatches(record.data, record.header.size, i));
+        // 记录按 8 字节对齐
+        TEST_CHECK(((uintptr_t)record.data & 7) == 0);
+        EncodedFrameSlabRelease(slab, &record);
+    }
+    EncodedFrameRecord record;
+    TEST_CHECK(!EncodedFrameSlabRead(slab, &record));
+    TEST_CHECK(EncodedFrameSlabUsedBytes(slab) == 0);
+    EncodedFrameSlabDestroy(slab);
+}
+
+/// 放不下、超过容量的帧被丢弃并计数；释放后空间可再用
+static void TestFullAndRelease(void) {
+    EncodedFrameSlab *slab = EncodedFrameSlabCreate(4096);
+    uint8_t data[8192];
+    FillPayload(data, sizeof(data), 0);
+    EncodedFrameHeader huge = HeaderForSequence(0, 8192);
+    TEST_CHECK(!EncodedFrameSlabWrite(slab, &huge, data));
+    TEST_CHECK(EncodedFrameSlabDroppedFrames(slab) == 1);
+
+    uint32_t written = 0;
+    for (;;) {
+        FillPayload(data, 900, written);
+        EncodedFrameHeader header = HeaderForSequence(written, 900);
+        if (!EncodedFrameSlabWrite(slab, &header, data)) {
+            break;
+        }
+        written++;
+    }
+    TEST_CHECK(written == 4);
+    TEST_CHECK(EncodedFrameSlabDroppedFrames(slab) == 2);
+    size_t usedWhenFull = EncodedFrameSlabUsedBytes(slab);
+    TEST_CHECK(usedWhenFull > 3600 && usedWhenFull <= 4096);
+
+    // 读出但未释放的记录仍占用空间
+    EncodedFrameRecord first, second;
+    TEST_CHECK(EncodedFrameSlabRead(slab, &first));
+    TEST_CHECK(EncodedFrameSlabRead(slab, &second));
+    EncodedFrameHeader next = HeaderForSequence(written, 900);
+    TEST_CHECK(!EncodedFrameSlabWrite(slab, &next, data));
+    TEST_CHECK(EncodedFrameSlabUsedBytes(slab) == usedWhenFull);
+
+    // 释放第二条同时释放第一条
+    EncodedFrameSlabRelease(slab, &second);
+    TEST_CHECK(EncodedFrameSlabUsedBytes(slab) < usedWhenFull / 2 + 64);
+    FillPayload(data, 900, written);
+    TEST_CHECK(EncodedFrameSlabWrite(slab, &next, data));
+    EncodedFrameSlabDestroy(slab);
+}
+
+/// 尾部放不下时整条记录从缓冲起点开始，读出的数据连续完整；
+/// 不超过半个缓冲的记录在缓冲为空时总能写入
+static void TestWrapAround(void) {
+    EncodedFrameSlab *slab = EncodedFrameSlabCreate(4096);
+    uint8_t data[2000];
+    uint32_t sequence = 0;
+    for (int round = 0; round < 200; round++) {
+        uint32_t size = 100 + (uint32_t)(round * 977) % 1900;
+        FillPayload(data, size, sequence);
+        EncodedFrameHeader header = HeaderForSequence(sequence, size);
+        TEST_CHECK(EncodedFrameSlabWrite(slab, &header, data));
+        EncodedFrameRecord record;
+        TEST_CHECK(EncodedFrameSlabRead(slab, &record));
+        TEST_CHECK(record.header.dtsUs == header.dtsUs && record.header.size == size);
+        TEST_CHECK(PayloadMatches(record.data, size, sequence));
+        EncodedFrameSlabRelease(slab, &record);
+        sequence++;
+    }
+    TEST_CHECK(EncodedFrameSlabDroppedFrames(slab) == 0);
+    TEST_CHECK(EncodedFrameSlabUsedBytes(slab) == 0);
+    EncodedFrameSlabDestroy(slab);
+}
+
+enum {
+    StressRecords = 200000,
+    StressMaxSize = 3000,
+};
+
+static EncodedFrameSlab *stressSlab;
+
+static uint32_t StressSize(uint32_t sequence) {
+    return (sequence * 2654435761u >> 8) % StressMaxSize;
+}
+
+static void *StressProducer(void *argument) {
+    static uint8_t data[StressMaxSize];
+    for (uint32_t sequence = 0; sequence < StressRecords;) {
+        uint32_t size = StressSize(sequence);
+        FillPayload(data, size, sequence);
+        EncodedFrameHeader header = HeaderForSequence(sequence, size);
+        if (EncodedFrameSlabWrite(stressSlab, &header, data)) {
+            sequence++;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/// 生产者写入随机长度的帧，消费者逐条校验，最多攒 3 条再一起释放
+static void TestProducerConsumerStress(void) {
+    stressSlab = EncodedFrameSlabCreate(16 * 1024);
+    pthread_t producer;
+    pthread_create(&producer, NULL, StressProducer, NULL);
+    uint32_t received = 0;
+    int held = 0;
+    bool intact = true;
+    EncodedFrameRecord record;
+    EncodedFrameRecord last;
+    uint64_t allocations = TestAllocCount();
+    while (received < StressRecords) {
+        if (!EncodedFrameSlabRead(stressSlab, &record)) {
+            if (held > 0) {
+                EncodedFrameSlabRelease(stressSlab, &last);
+                held = 0;
+            }
+            sched_yield();
+            continue;
+        }
+        uint32_t size = StressSize(received);
+        intact = intact && record.header.dtsUs == (int64_t)received * 33333 && record.header.size == size &&
+                 PayloadMatches(record.data, size, received);
+        received++;
+        last = record;
+        if (++held == 3) {
+            EncodedFrameSlabRelease(stressSlab, &last);
+            held = 0;
+        }
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    pthread_join(producer, NULL);
+    if (held > 0) {
+        EncodedFrameSlabRelease(stressSlab, &last);
+    }
+    TEST_CHECK(intact);
+    TEST_CHECK(EncodedFrameSlabWrittenFrames(stressSlab) == StressRecords);
+    TEST_CHECK(EncodedFrameSlabUsedBytes(stressSlab) == 0);
+    printf("  %u records, %llu full-buffer retries\n", received,
+           (unsigned long long)EncodedFrameSlabDroppedFrames(stressSlab));
+    EncodedFrameSlabDestroy(stressSlab);
+}
+
+int main(void) {
+    TEST_RUN(TestCapacity);
+    TEST_RUN(TestOrderAndIntegrity);
+    TEST_RUN(TestFullAndRelease);
+    TEST_RUN(TestWrapAround);
+    TEST_RUN(TestProducerConsumerStress);
+    return TEST_RESULT();
+}
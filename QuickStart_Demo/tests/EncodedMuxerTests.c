@@ -0,0 +1,776 @@
+//
+//  EncodedMuxerTests.c
+//  tests
+//
+//  编码帧封装：配置与打开校验、分片 MP4 逐个 box 解析回读（avcC、moof 序号、trun 时长与标志、长度前缀 NAL）、
+//  PCM 音轨对齐、Annex-B 与 WAV 旁路文件、写入失败、打开后不分配内存，以及录制器端到端换文件
+//
+
+#include "EncodedMuxer.h"
+#include "EncodedRecorder.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+enum {
+    TestMaxAccessUnit = 4096,
+    TestMaxSample = 4096,
+    TestFrameUs = 33333,
+};
+
+/// 一帧 Annex-B 数据与封装后应得到的长度前缀样本
+typedef struct {
+    uint8_t bytes[TestMaxAccessUnit];
+    size_t size;
+    uint8_t sample[TestMaxSample];
+    size_t sampleSize;
+    EncodedFrameHeader header;
+} TestAccessUnit;
+
+static char testDirectory[] = "/tmp/EncodedMuxerTestsXXXXXX";
+
+static void TestPath(char *path, size_t size, const char *name) {
+    snprintf(path, size, "%s/%s", testDirectory, name);
+}
+
+static uint32_t testRandomState = 12345;
+
+static uint32_t TestRandom(void) {
+    testRandomState = testRandomState * 1664525u + 1013904223u;
+    return testRandomState >> 8;
+}
+
+static void Append(TestAccessUnit *au, const void *bytes, size_t size) {
+    memcpy(au->bytes + au->size, bytes, size);
+    au->size += size;
+}
+
+/// 随机用 3 或 4 字节起始码，NAL 之后随机补 0，封装时应去掉
+static void AppendNal(TestAccessUnit *au, const uint8_t *nal, size_t size, bool expectInSample) {
+    static const uint8_t startCode[4] = {0, 0, 0, 1};
+    bool longCode = TestRandom() & 1;
+    Append(au, longCode ? startCode : startCode + 1, longCode ? 4 : 3);
+    Append(au, nal, size);
+    static const uint8_t zeros[2] = {0, 0};
+    Append(au, zeros, TestRandom() % 3);
+    if (expectInSample) {
+        uint8_t *prefix = au->sample + au->sampleSize;
+        prefix[0] = (uint8_t)(size >> 24);
+        prefix[1] = (uint8_t)(size >> 16);
+        prefix[2] = (uint8_t)(size >> 8);
+        prefix[3] = (uint8_t)size;
+        memcpy(prefix + 4, nal, size);
+        au->sampleSize += 4 + size;
+    }
+}
+
+static void TestSps(uint8_t variant, uint8_t sps[8]) {
+    const uint8_t bytes[8] = {0x67, 0x42, 0xC0, 0x1E, 0xDA, variant, 0x80, 0x44};
+    memcpy(sps, bytes, 8);
+}
+
+static const uint8_t testPps[4] = {0x68, 0xCE, 0x38, 0x80};
+
+/// AUD、关键帧的 SPS/PPS 与 1～3 个切片；切片内容不为 0，不会出现伪起始码
+static void MakeAccessUnit(TestAccessUnit *au, uint32_t index, bool keyframe, uint8_t spsVariant,
+                           int64_t baseUs) {
+    au->size = 0;
+    au->sampleSize = 0;
+    static const uint8_t aud[2] = {0x09, 0xF0};
+    AppendNal(au, aud, sizeof(aud), false);
+    if (keyframe) {
+        uint8_t sps[8];
+        TestSps(spsVariant, sps);
+        AppendNal(au, sps, sizeof(sps), false);
+        AppendNal(au, testPps, sizeof(testPps), false);
+    }
+    uint32_t slices = 1 + TestRandom() % 3;
+    for (uint32_t s = 0; s < slices; s++) {
+        uint8_t slice[600];
+        size_t size = 2 + TestRandom() % (sizeof(slice) - 2);
+        slice[0] = keyframe ? 0x65 : 0x41;
+        for (size_t i = 1; i < size; i++) {
+            slice[i] = (uint8_t)(1 + TestRandom() % 255);
+        }
+        AppendNal(au, slice, size, true);
+    }
+    int64_t dtsUs = baseUs + (int64_t)index * TestFrameUs;
+    EncodedFrameHeader header = {
+        .ptsUs = dtsUs + (int64_t)(index % 3) * TestFrameUs,
+        .dtsUs = dtsUs,
+        .arrivalUs = dtsUs,
+        .size = (uint32_t)au->size,
+        .flags = keyframe ? ENCODED_FRAME_FLAG_KEYFRAME : 0,
+        .width = 640,
+        .height = 360,
+        .rotation = 90,
+        .codec = EncodedFrameCodecH264,
+    };
+    au->header = header;
+}
+
+/// 与封装器相同的 90kHz 取整
+static uint64_t TestTicks(int64_t deltaUs) {
+    return deltaUs <= 0 ? 0 : (uint64_t)((deltaUs * 90 + 500) / 1000);
+}
+
+// Box parsing
+
+static uint32_t Be32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static uint64_t Be64(const uint8_t *bytes) {
+    return (uint64_t)Be32(bytes) << 32 | Be32(bytes + 4);
+}
+
+typedef struct {
+    const uint8_t *start;
+    const uint8_t *payload;
+    size_t size;
+    size_t payloadSize;
+} TestBox;
+
+/// 从 *offset 取出下一个 box，类型不符或越界时返回 false
+static bool NextBox(const uint8_t *data, size_t size, size_t *offset, const char *type, TestBox *box) {
+    if (*offset + 8 > size) {
+        return false;
+    }
+    uint32_t boxSize = Be32(data + *offset);
+    if (boxSize < 8 || *offset + boxSize > size || memcmp(data + *offset + 4, type, 4) != 0) {
+        return false;
+    }
+    box->start = data + *offset;
+    box->payload = box->start + 8;
+    box->size = boxSize;
+    box->payloadSize = boxSize - 8;
+    *offset += boxSize;
+    return true;
+}
+
+/// 在 parent 的子 box 中查找第 index 个 type
+static bool FindChild(const TestBox *parent, size_t skip, const char *type, size_t index, TestBox *box) {
+    size_t offset = skip;
+    while (offset + 8 <= parent->payloadSize) {
+        uint32_t boxSize = Be32(parent->payload + offset);
+        if (boxSize < 8 || offset + boxSize > parent->payloadSize) {
+            return false;
+        }
+        if (memcmp(parent->payload + offset + 4, type, 4) == 0 && index-- == 0) {
+            return NextBox(parent->payload, parent->payloadSize, &offset, type, box);
+        }
+        offset += boxSize;
+    }
+    return false;
+}
+
+static uint8_t *ReadWholeFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        *size = 0;
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = malloc(length > 0 ? (size_t)length : 1);
+    *size = fread(data, 1, (size_t)length, file);
+    fclose(file);
+    return data;
+}
+
+/// 期望的视频样本：帧号、时长与显示时间偏移
+typedef struct {
+    const TestAccessUnit *au;
+    uint32_t duration;
+    int32_t compositionOffset;
+} TestExpectedSample;
+
+/// 解析 moov 中视频轨的 avcC，与给定 SPS/PPS 比较
+static bool CheckVideoTrack(const TestBox *moov, uint8_t spsVariant, uint16_t width, uint16_t height) {
+    TestBox trak, tkhd, mdia, mdhd, minf, stbl, stsd, avc1, avcC;
+    if (!FindChild(moov, 0, "trak", 0, &trak) || !FindChild(&trak, 0, "tkhd", 0, &tkhd) ||
+        !FindChild(&trak, 0, "mdia", 0, &mdia) || !FindChild(&mdia, 0, "mdhd", 0, &mdhd) ||
+        !FindChild(&mdia, 0, "minf", 0, &minf) || !FindChild(&minf, 0, "stbl", 0, &stbl) ||
+        !FindChild(&stbl, 0, "stsd", 0, &stsd) || !FindChild(&stsd, 8, "avc1", 0, &avc1) ||
+        !FindChild(&avc1, 78, "avcC", 0, &avcC)) {
+        return false;
+    }
+    bool ok = true;
+    // tkhd：旋转 90 度的矩阵 {0, 1, -1, 0, height, 0}，之后是宽高
+    const uint8_t *matrix = tkhd.payload + 40;
+    ok = ok && Be32(matrix) == 0 && Be32(matrix + 4) == 0x10000 && Be32(matrix + 12) == 0xFFFF0000u &&
+         Be32(matrix + 16) == 0 && Be32(matrix + 24) == (uint32_t)height << 16;
+    ok = ok && Be32(tkhd.payload + 76) == (uint32_t)width << 16 && Be32(tkhd.payload + 80) == (uint32_t)height << 16;
+    ok = ok && Be32(mdhd.payload + 12) == 90000;
+    ok = ok && (avc1.payload[24] << 8 | avc1.payload[25]) == width && (avc1.payload[26] << 8 | avc1.payload[27]) == height;
+
+    uint8_t sps[8];
+    TestSps(spsVariant, sps);
+    const uint8_t *c = avcC.payload;
+    ok = ok && c[0] == 1 && c[1] == sps[1] && c[2] == sps[2] && c[3] == sps[3] && c[4] == 0xFF && c[5] == 0xE1;
+    ok = ok && (c[6] << 8 | c[7]) == sizeof(sps) && memcmp(c + 8, sps, sizeof(sps)) == 0;
+    c += 8 + sizeof(sps);
+    ok = ok && c[0] == 1 && (c[1] << 8 | c[2]) == sizeof(testPps) && memcmp(c + 3, testPps, sizeof(testPps)) == 0;
+    return ok;
+}
+
+/// 依次解析 moof + mdat，与期望的视频样本、音频数据比较；返回解析出的分片数
+static int CheckFragments(const uint8_t *data, size_t size, size_t offset, const TestExpectedSample *samples,
+                          size_t sampleCount, const int16_t *audio, size_t audioFrames, uint32_t audioChannels) {
+    size_t sampleIndex = 0;
+    size_t audioIndex = 0;
+    uint64_t videoTicks = 0;
+    int fragments = 0;
+    while (offset < size) {
+        TestBox moof, mdat, mfhd, traf;
+        if (!NextBox(data, size, &offset, "moof", &moof) || !NextBox(data, size, &offset, "mdat", &mdat) ||
+            !FindChild(&moof, 0, "mfhd", 0, &mfhd)) {
+            printf("  fragment %d: missing moof/mdat\n", fragments);
+            return -1;
+        }
+        fragments++;
+        TEST_CHECK(Be32(mfhd.payload + 4) == (uint32_t)fragments);
+        TEST_CHECK(mdat.start == moof.start + moof.size);
+        size_t mdatUsed = 0;
+        for (size_t t = 0; FindChild(&moof, 0, "traf", t, &traf); t++) {
+            TestBox tfhd, tfdt, trun;
+            TEST_CHECK(FindChild(&traf, 0, "tfhd", 0, &tfhd) && FindChild(&traf, 0, "tfdt", 0, &tfdt) &&
+                       FindChild(&traf, 0, "trun", 0, &trun));
+            TEST_CHECK(tfdt.payload[0] == 1);
+            uint32_t trackId = Be32(tfhd.payload + 4);
+            uint32_t count = Be32(trun.payload + 4);
+            uint32_t dataOffset = Be32(trun.payload + 8);
+            const uint8_t *media = moof.start + dataOffset;
+            TEST_CHECK(dataOffset == moof.size + 8 + mdatUsed);
+            if (trackId == 1) {
+                TEST_CHECK(Be32(tfhd.payload) == 0x020000);
+                TEST_CHECK(Be32(trun.payload) == 0x01000F01);
+                TEST_CHECK(Be64(tfdt.payload + 4) == videoTicks);
+                for (uint32_t i = 0; i < count; i++, sampleIndex++) {
+                    const uint8_t *entry = trun.payload + 12 + 16 * i;
+                    if (sampleIndex >= sampleCount) {
+                        TEST_CHECK(sampleIndex < sampleCount);
+                        return -1;
+                    }
+                    const TestExpectedSample *expected = &samples[sampleIndex];
+                    bool keyframe = expected->au->header.flags & ENCODED_FRAME_FLAG_KEYFRAME;
+                    uint32_t sampleSize = Be32(entry + 4);
+                    TEST_CHECK(Be32(entry) == expected->duration);
+                    TEST_CHECK(sampleSize == expected->au->sampleSize);
+                    TEST_CHECK(Be32(entry + 8) == (keyframe ? 0x02000000u : 0x01010000u));
+                    TEST_CHECK((int32_t)Be32(entry + 12) == expected->compositionOffset);
+                    TEST_CHECK(sampleSize == expected->au->sampleSize &&
+                               memcmp(media, expected->au->sample, sampleSize) == 0);
+                    media += sampleSize;
+                    mdatUsed += sampleSize;
+                    videoTicks += Be32(entry);
+                }
+            } else {
+                TEST_CHECK(trackId == 2);
+                TEST_CHECK(Be32(tfhd.payload) == 0x020038);
+                TEST_CHECK(Be32(tfhd.payload + 8) == 1 && Be32(tfhd.payload + 12) == audioChannels * 2);
+                TEST_CHECK(Be32(trun.payload) == 0x000001);
+                TEST_CHECK(Be64(tfdt.payload + 4) == audioIndex);
+                size_t bytes = (size_t)count * audioChannels * 2;
+                TEST_CHECK(audioIndex + count <= audioFrames &&
+                           memcmp(media, audio + audioIndex * audioChannels, bytes) == 0);
+                audioIndex += count;
+                mdatUsed += bytes;
+            }
+        }
+        TEST_CHECK(mdat.payloadSize == mdatUsed);
+    }
+    TEST_CHECK(sampleIndex == sampleCount);
+    TEST_CHECK(audioIndex == audioFrames);
+    return fragments;
+}
+
+// Tests
+
+static void TestConfigAndOpen(void) {
+    EncodedMuxerConfig config = EncodedMuxerDefaultConfig();
+    TEST_CHECK(config.audioSampleRate == 0 && config.maxFragmentVideoFrames == 256 &&
+               config.maxFragmentAudioFrames == 512);
+    TEST_CHECK(!EncodedMuxerCreate(NULL));
+    config.maxFragmentVideoFrames = 0;
+    TEST_CHECK(!EncodedMuxerCreate(&config));
+    config = EncodedMuxerDefaultConfig();
+    config.audioSampleRate = 48000;
+    TEST_CHECK(!EncodedMuxerCreate(&config));
+    config.audioChannels = 2;
+    config.audioSampleRate = 96000;
+    TEST_CHECK(!EncodedMuxerCreate(&config));
+
+    TEST_CHECK(strcmp(EncodedMuxerFileExtension(EncodedMuxerFormatFmp4, EncodedFrameCodecH264), "mp4") == 0);
+    TEST_CHECK(strcmp(EncodedMuxerFileExtension(EncodedMuxerFormatAnnexB, EncodedFrameCodecH264), "h264") == 0);
+    TEST_CHECK(strcmp(EncodedMuxerFileExtension(EncodedMuxerFormatAnnexB, EncodedFrameCodecH265), "h265") == 0);
+
+    config = EncodedMuxerDefaultConfig();
+    EncodedMuxer *muxer = EncodedMuxerCreate(&config);
+    char path[PATH_MAX];
+    TestPath(path, sizeof(path), "open.mp4");
+    TEST_CHECK(!EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecPCM16, path, NULL));
+    TEST_CHECK(!EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH265, path, NULL));
+    TEST_CHECK(!EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, "/nonexistent/x.mp4", NULL));
+    TEST_CHECK(!EncodedMuxerIsOpen(muxer));
+    TEST_CHECK(EncodedMuxerClose(muxer));
+    TEST_CHECK(EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, path, NULL));
+    TEST_CHECK(EncodedMuxerIsOpen(muxer));
+    TEST_CHECK(!EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, path, NULL));
+    // 没有任何帧时不写初始化段
+    TEST_CHECK(EncodedMuxerClose(muxer));
+    TEST_CHECK(EncodedMuxerBytesWritten(muxer) == 0);
+    TEST_CHECK(EncodedMuxerOpen(muxer, EncodedMuxerFormatAnnexB, EncodedFrameCodecH265, path, NULL));
+    TEST_CHECK(EncodedMuxerClose(muxer));
+    EncodedMuxerDestroy(muxer);
+    unlink(path);
+}
+
+/// 第一帧须为带参数集的关键帧；参数集变化检测；分片满时拒绝
+static void TestFrameRules(void) {
+    EncodedMuxerConfig config = EncodedMuxerDefaultConfig();
+    config.maxFragmentVideoFrames = 4;
+    EncodedMuxer *muxer = EncodedMuxerCreate(&config);
+    char path[PATH_MAX];
+    TestPath(path, sizeof(path), "rules.mp4");
+    TEST_CHECK(EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, path, NULL));
+
+    static TestAccessUnit units[8];
+    MakeAccessUnit(&units[0], 0, false, 1, 0);
+    TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[0].header, units[0].bytes));
+    TEST_CHECK(EncodedMuxerPendingVideoFrames(muxer) == 0);
+    // 关键帧但没有参数集
+    EncodedFrameHeader bare = units[0].header;
+    bare.flags = ENCODED_FRAME_FLAG_KEYFRAME;
+    TEST_CHECK(EncodedMuxerAddVideo(muxer, &bare, units[0].bytes));
+    TEST_CHECK(EncodedMuxerPendingVideoFrames(muxer) == 0);
+
+    for (uint32_t i = 1; i <= 5; i++) {
+        MakeAccessUnit(&units[i], i, i == 1, 1, 0);
+    }
+    for (uint32_t i = 1; i <= 4; i++) {
+        TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[i].header, units[i].bytes));
+    }
+    TEST_CHECK(EncodedMuxerPendingVideoFrames(muxer) == 4);
+    TEST_CHECK(!EncodedMuxerAddVideo(muxer, &units[5].header, units[5].bytes));
+    TEST_CHECK(EncodedMuxerPendingVideoFrames(muxer) == 4);
+    size_t expectedBytes = 0;
+    for (uint32_t i = 1; i <= 4; i++) {
+        expectedBytes += units[i].sampleSize;
+    }
+    TEST_CHECK(EncodedMuxerPendingBytes(muxer) == expectedBytes);
+    // 3 个间隔加上沿用的默认时长
+    TEST_CHECK(EncodedMuxerPendingVideoDurationUs(muxer) > 3 * TestFrameUs);
+
+    MakeAccessUnit(&units[6], 6, true, 1, 0);
+    TEST_CHECK(!EncodedMuxerParameterSetsChanged(muxer, &units[6].header, units[6].bytes));
+    MakeAccessUnit(&units[6], 6, true, 2, 0);
+    TEST_CHECK(EncodedMuxerParameterSetsChanged(muxer, &units[6].header, units[6].bytes));
+    TEST_CHECK(!EncodedMuxerParameterSetsChanged(muxer, &units[5].header, units[5].bytes));
+
+    TEST_CHECK(EncodedMuxerFlush(muxer, units[5].header.dtsUs));
+    TEST_CHECK(EncodedMuxerPendingVideoFrames(muxer) == 0 && EncodedMuxerPendingBytes(muxer) == 0);
+    TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[5].header, units[5].bytes));
+    TEST_CHECK(EncodedMuxerClose(muxer));
+    EncodedMuxerDestroy(muxer);
+    unlink(path);
+}
+
+/// 写出多个分片后逐个 box 解析回读：初始化段、分片序号、解码时间、时长、显示偏移、同步标志与样本数据
+static void TestFmp4RoundTrip(void) {
+    enum { Frames = 95, FlushEvery = 20 };
+    const int64_t baseUs = 5000000;
+    static TestAccessUnit units[Frames];
+    for (uint32_t i = 0; i < Frames; i++) {
+        // 第 0 帧不是关键帧，应被丢弃
+        MakeAccessUnit(&units[i], i, i % 30 == 1, 7, baseUs);
+    }
+    EncodedMuxerConfig config = EncodedMuxerDefaultConfig();
+    EncodedMuxer *muxer = EncodedMuxerCreate(&config);
+    char path[PATH_MAX];
+    TestPath(path, sizeof(path), "roundtrip.mp4");
+    TEST_CHECK(EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, path, NULL));
+    int expectedFragments = 0;
+    for (uint32_t i = 0; i < Frames; i++) {
+        TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[i].header, units[i].bytes));
+        if (EncodedMuxerPendingVideoFrames(muxer) == FlushEvery) {
+            TEST_CHECK(EncodedMuxerFlush(muxer, i + 1 < Frames ? units[i + 1].header.dtsUs : INT64_MIN));
+            expectedFragments++;
+        }
+    }
+    expectedFragments += EncodedMuxerPendingVideoFrames(muxer) > 0;
+    TEST_CHECK(EncodedMuxerClose(muxer));
+
+    static TestExpectedSample samples[Frames];
+    size_t sampleCount = Frames - 1;
+    int64_t firstDts = units[1].header.dtsUs;
+    for (size_t i = 0; i < sampleCount; i++) {
+        const TestAccessUnit *au = &units[i + 1];
+        uint64_t decode = TestTicks(au->header.dtsUs - firstDts);
+        uint64_t next = i + 1 < sampleCount ? TestTicks(units[i + 2].header.dtsUs - firstDts)
+                                            : decode + (decode - TestTicks(units[i].header.dtsUs - firstDts));
+        samples[i].au = au;
+        samples[i].duration = (uint32_t)(next - decode);
+        samples[i].compositionOffset = (int32_t)(TestTicks(au->header.ptsUs - firstDts) - decode);
+    }
+
+    size_t size;
+    uint8_t *data = ReadWholeFile(path, &size);
+    TEST_CHECK(data && size == EncodedMuxerBytesWritten(muxer));
+    size_t offset = 0;
+    TestBox ftyp, moov, mvex;
+    TEST_CHECK(NextBox(data, size, &offset, "ftyp", &ftyp) && memcmp(ftyp.payload, "isom", 4) == 0);
+    TEST_CHECK(NextBox(data, size, &offset, "moov", &moov));
+    TEST_CHECK(CheckVideoTrack(&moov, 7, 640, 360));
+    TestBox audioTrak;
+    TEST_CHECK(!FindChild(&moov, 0, "trak", 1, &audioTrak));
+    TEST_CHECK(FindChild(&moov, 0, "mvex", 0, &mvex));
+    int fragments = CheckFragments(data, size, offset, samples, sampleCount, NULL, 0, 0);
+    TEST_CHECK(fragments == expectedFragments);
+    printf("  %zu samples in %d fragments, %zu bytes\n", sampleCount, fragments, size);
+    free(data);
+    EncodedMuxerDestroy(muxer);
+    unlink(path);
+}
+
+/// 音频按到达时钟对齐到第一帧视频：之前的部分被裁掉，tfdt 连续，数据原样写入 mdat
+static void TestFmp4Audio(void) {
+    enum { Frames = 40, ChunkFrames = 480, Chunks = 150, Channels = 2 };
+    const int64_t baseUs = 1000000;
+    static TestAccessUnit units[Frames];
+    for (uint32_t i = 0; i < Frames; i++) {
+        MakeAccessUnit(&units[i], i, i % 20 == 0, 3, baseUs);
+    }
+    // 第 0、1 块完全早于视频，第 2 块的前 5ms（240 帧）早于视频
+    static int16_t audio[Chunks * ChunkFrames * Channels];
+    for (size_t i = 0; i < sizeof(audio) / sizeof(audio[0]); i++) {
+        audio[i] = (int16_t)(i * 7);
+    }
+    EncodedMuxerConfig config = EncodedMuxerDefaultConfig();
+    config.audioSampleRate = 48000;
+    config.audioChannels = Channels;
+    EncodedMuxer *muxer = EncodedMuxerCreate(&config);
+    char path[PATH_MAX];
+    TestPath(path, sizeof(path), "audio.mp4");
+    TEST_CHECK(EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, path, NULL));
+
+    EncodedFrameHeader audioHeader = {
+        .size = ChunkFrames * Channels * sizeof(int16_t),
+        .codec = EncodedFrameCodecPCM16,
+        .channels = Channels,
+        .sampleRate = 48000,
+    };
+    // 视频开始之前的音频不被接收
+    audioHeader.arrivalUs = baseUs;
+    TEST_CHECK(EncodedMuxerAddAudio(muxer, &audioHeader, (const uint8_t *)audio));
+    TEST_CHECK(EncodedMuxerPendingAudioFrames(muxer) == 0);
+
+    size_t chunk = 0;
+    for (uint32_t i = 0; i < Frames; i++) {
+        TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[i].header, units[i].bytes));
+        int64_t videoArrival = units[i].header.arrivalUs;
+        for (; chunk < Chunks && baseUs - 25000 + (int64_t)(chunk + 1) * 10000 <= videoArrival + TestFrameUs; chunk++) {
+            audioHeader.arrivalUs = baseUs - 25000 + (int64_t)(chunk + 1) * 10000;
+            TEST_CHECK(EncodedMuxerAddAudio(muxer, &audioHeader,
+                                            (const uint8_t *)(audio + chunk * ChunkFrames * Channels)));
+        }
+        if (i == 0) {
+            TEST_CHECK(EncodedMuxerPendingAudioFrames(muxer) > 0);
+            // 格式不符的音频被忽略
+            size_t before = EncodedMuxerPendingAudioFrames(muxer);
+            EncodedFrameHeader mismatched = audioHeader;
+            mismatched.sampleRate = 44100;
+            TEST_CHECK(EncodedMuxerAddAudio(muxer, &mismatched, (const uint8_t *)audio));
+            TEST_CHECK(EncodedMuxerPendingAudioFrames(muxer) == before);
+        }
+        if (i % 20 == 19) {
+            TEST_CHECK(EncodedMuxerPendingAudioDurationUs(muxer) > 0);
+            TEST_CHECK(EncodedMuxerFlush(muxer, i + 1 < Frames ? units[i + 1].header.dtsUs : INT64_MIN));
+        }
+    }
+    TEST_CHECK(EncodedMuxerClose(muxer));
+
+    static TestExpectedSample samples[Frames];
+    for (size_t i = 0; i < Frames; i++) {
+        uint64_t decode = TestTicks(units[i].header.dtsUs - baseUs);
+        uint64_t next = i + 1 < Frames ? TestTicks(units[i + 1].header.dtsUs - baseUs)
+                                       : decode + (decode - TestTicks(units[i - 1].header.dtsUs - baseUs));
+        samples[i].au = &units[i];
+        samples[i].duration = (uint32_t)(next - decode);
+        samples[i].compositionOffset = (int32_t)(TestTicks(units[i].header.ptsUs - baseUs) - decode);
+    }
+    size_t firstAudioFrame = 2 * ChunkFrames + 240;
+    size_t audioFrames = chunk * ChunkFrames - firstAudioFrame;
+
+    size_t size;
+    uint8_t *data = ReadWholeFile(path, &size);
+    size_t offset = 0;
+    TestBox ftyp, moov, audioTrak, mdia, mdhd, minf, stbl, stsd, sowt;
+    TEST_CHECK(NextBox(data, size, &offset, "ftyp", &ftyp) && NextBox(data, size, &offset, "moov", &moov));
+    TEST_CHECK(CheckVideoTrack(&moov, 3, 640, 360));
+    TEST_CHECK(FindChild(&moov, 0, "trak", 1, &audioTrak) && FindChild(&audioTrak, 0, "mdia", 0, &mdia) &&
+               FindChild(&mdia, 0, "mdhd", 0, &mdhd) && FindChild(&mdia, 0, "minf", 0, &minf) &&
+               FindChild(&minf, 0, "stbl", 0, &stbl) && FindChild(&stbl, 0, "stsd", 0, &stsd) &&
+               FindChild(&stsd, 8, "sowt", 0, &sowt));
+    TEST_CHECK(Be32(mdhd.payload + 12) == 48000);
+    TEST_CHECK((sowt.payload[16] << 8 | sowt.payload[17]) == Channels && Be32(sowt.payload + 24) == 48000u << 16);
+    int fragments = CheckFragments(data, size, offset, samples, Frames, audio + firstAudioFrame * Channels,
+                                   audioFrames, Channels);
+    TEST_CHECK(fragments == 2);
+    free(data);
+    EncodedMuxerDestroy(muxer);
+    unlink(path);
+}
+
+/// Annex-B 原样写出视频；WAV 开头补静音对齐第一帧视频，Close 时补全长度
+static void TestAnnexBWithWav(void) {
+    enum { Frames = 30, ChunkFrames = 160, Chunks = 50, Channels = 1 };
+    const int64_t baseUs = 2000000;
+    static TestAccessUnit units[Frames];
+    for (uint32_t i = 0; i < Frames; i++) {
+        MakeAccessUnit(&units[i], i, i % 10 == 2, 1, baseUs);
+        units[i].header.codec = EncodedFrameCodecH265;
+    }
+    static int16_t audio[Chunks * ChunkFrames * Channels];
+    for (size_t i = 0; i < sizeof(audio) / sizeof(audio[0]); i++) {
+        audio[i] = (int16_t)(1000 - i);
+    }
+    EncodedMuxerConfig config = EncodedMuxerDefaultConfig();
+    config.audioSampleRate = 16000;
+    config.audioChannels = Channels;
+    EncodedMuxer *muxer = EncodedMuxerCreate(&config);
+    char videoPath[PATH_MAX], audioPath[PATH_MAX];
+    TestPath(videoPath, sizeof(videoPath), "annexb.h265");
+    TestPath(audioPath, sizeof(audioPath), "annexb.wav");
+    TEST_CHECK(EncodedMuxerOpen(muxer, EncodedMuxerFormatAnnexB, EncodedFrameCodecH265, videoPath, audioPath));
+
+    // 第一块音频在第一帧关键帧（第 2 帧）之后 20ms 开始采集
+    int64_t videoStartUs = units[2].header.arrivalUs;
+    EncodedFrameHeader audioHeader = {
+        .size = ChunkFrames * Channels * sizeof(int16_t),
+        .codec = EncodedFrameCodecPCM16,
+        .channels = Channels,
+        .sampleRate = 16000,
+    };
+    for (uint32_t i = 0; i < Frames; i++) {
+        TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[i].header, units[i].bytes));
+        if (i == 2) {
+            for (size_t chunk = 0; chunk < Chunks; chunk++) {
+                audioHeader.arrivalUs = videoStartUs + 20000 + (int64_t)(chunk + 1) * 10000;
+                TEST_CHECK(EncodedMuxerAddAudio(muxer, &audioHeader,
+                                                (const uint8_t *)(audio + chunk * ChunkFrames * Channels)));
+            }
+        }
+        if (i == 15) {
+            TEST_CHECK(EncodedMuxerFlush(muxer, units[i + 1].header.dtsUs));
+        }
+    }
+    TEST_CHECK(EncodedMuxerClose(muxer));
+
+    size_t videoSize, audioSize;
+    uint8_t *video = ReadWholeFile(videoPath, &videoSize);
+    uint8_t *wav = ReadWholeFile(audioPath, &audioSize);
+    size_t expectedVideoSize = 0;
+    bool videoMatches = video != NULL;
+    for (uint32_t i = 2; i < Frames && videoMatches; i++) {
+        videoMatches = expectedVideoSize + units[i].size <= videoSize &&
+                       memcmp(video + expectedVideoSize, units[i].bytes, units[i].size) == 0;
+        expectedVideoSize += units[i].size;
+    }
+    TEST_CHECK(videoMatches && videoSize == expectedVideoSize);
+
+    size_t silenceFrames = 20000 * 16000 / 1000000;
+    size_t dataBytes = (silenceFrames + Chunks * ChunkFrames) * Channels * sizeof(int16_t);
+    TEST_CHECK(wav && audioSize == 44 + dataBytes);
+    if (wav && audioSize == 44 + dataBytes) {
+        uint32_t riffSize = wav[4] | wav[5] << 8 | wav[6] << 16 | (uint32_t)wav[7] << 24;
+        uint32_t dataSize = wav[40] | wav[41] << 8 | wav[42] << 16 | (uint32_t)wav[43] << 24;
+        uint32_t sampleRate = wav[24] | wav[25] << 8 | wav[26] << 16 | (uint32_t)wav[27] << 24;
+        TEST_CHECK(memcmp(wav, "RIFF", 4) == 0 && memcmp(wav + 8, "WAVE", 4) == 0 && memcmp(wav + 36, "data", 4) == 0);
+        TEST_CHECK(riffSize == 36 + dataBytes && dataSize == dataBytes && sampleRate == 16000 && wav[22] == Channels);
+        bool silent = true;
+        for (size_t i = 0; i < silenceFrames * Channels * sizeof(int16_t); i++) {
+            silent = silent && wav[44 + i] == 0;
+        }
+        TEST_CHECK(silent);
+        TEST_CHECK(memcmp(wav + 44 + silenceFrames * Channels * sizeof(int16_t), audio, sizeof(audio)) == 0);
+    }
+    free(video);
+    free(wav);
+    EncodedMuxerDestroy(muxer);
+    unlink(videoPath);
+    unlink(audioPath);
+}
+
+/// 写入失败后 Flush 与 Close 都返回 false，之后加入的帧被忽略
+static void TestWriteFailure(void) {
+    if (access("/dev/full", W_OK) != 0) {
+        printf("  /dev/full unavailable, skipped\n");
+        return;
+    }
+    EncodedMuxerConfig config = EncodedMuxerDefaultConfig();
+    EncodedMuxer *muxer = EncodedMuxerCreate(&config);
+    static TestAccessUnit units[3];
+    for (uint32_t i = 0; i < 3; i++) {
+        MakeAccessUnit(&units[i], i, i == 0, 1, 0);
+    }
+    TEST_CHECK(EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, "/dev/full", NULL));
+    TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[0].header, units[0].bytes));
+    TEST_CHECK(!EncodedMuxerFlush(muxer, units[1].header.dtsUs));
+    TEST_CHECK(EncodedMuxerAddVideo(muxer, &units[1].header, units[1].bytes));
+    TEST_CHECK(EncodedMuxerPendingVideoFrames(muxer) == 0);
+    TEST_CHECK(!EncodedMuxerFlush(muxer, INT64_MIN));
+    TEST_CHECK(!EncodedMuxerClose(muxer));
+    TEST_CHECK(!EncodedMuxerIsOpen(muxer));
+    EncodedMuxerDestroy(muxer);
+}
+
+/// 创建之后打开文件、加入帧、写分片、关闭都不分配内存
+static void TestNoAllocationAfterCreate(void) {
+    enum { Frames = 60 };
+    static TestAccessUnit units[Frames];
+    for (uint32_t i = 0; i < Frames; i++) {
+        MakeAccessUnit(&units[i], i, i % 30 == 0, 1, 0);
+    }
+    static int16_t audio[960];
+    EncodedFrameHeader audioHeader = {
+        .size = sizeof(audio),
+        .codec = EncodedFrameCodecPCM16,
+        .channels = 1,
+        .sampleRate = 48000,
+    };
+    EncodedMuxerConfig config = EncodedMuxerDefaultConfig();
+    config.audioSampleRate = 48000;
+    config.audioChannels = 1;
+    EncodedMuxer *muxer = EncodedMuxerCreate(&config);
+    char path[PATH_MAX];
+    TestPath(path, sizeof(path), "alloc.mp4");
+    uint64_t allocations = TestAllocCount();
+    for (int round = 0; round < 2; round++) {
+        EncodedMuxerOpen(muxer, EncodedMuxerFormatFmp4, EncodedFrameCodecH264, path, NULL);
+        for (uint32_t i = 0; i < Frames; i++) {
+            EncodedMuxerAddVideo(muxer, &units[i].header, units[i].bytes);
+            audioHeader.arrivalUs = units[i].header.arrivalUs + 20000;
+            EncodedMuxerAddAudio(muxer, &audioHeader, (const uint8_t *)audio);
+            if (i % 15 == 14) {
+                EncodedMuxerFlush(muxer, INT64_MIN);
+            }
+        }
+        EncodedMuxerClose(muxer);
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    EncodedMuxerDestroy(muxer);
+    unlink(path);
+}
+
+/// 前缀过长无法生成文件名时拒绝创建；目录不存在时记为写入错误
+static void TestRecorderPaths(void) {
+    static char longPrefix[PATH_MAX];
+    memset(longPrefix, 'a', sizeof(longPrefix) - 10);
+    longPrefix[sizeof(longPrefix) - 10] = '\0';
+    EncodedRecorderConfig config = EncodedRecorderDefaultConfig(longPrefix);
+    TEST_CHECK(!EncodedRecorderCreate(&config));
+
+    config = EncodedRecorderDefaultConfig("/nonexistent/recording");
+    EncodedRecorder *recorder = EncodedRecorderCreate(&config);
+    TEST_CHECK(recorder != NULL);
+    static TestAccessUnit au;
+    MakeAccessUnit(&au, 0, true, 1, 0);
+    TEST_CHECK(EncodedRecorderPushVideo(recorder, &au.header, au.bytes));
+    EncodedRecorderStop(recorder);
+    EncodedRecorderStats stats;
+    EncodedRecorderGetStats(recorder, &stats);
+    TEST_CHECK(stats.writeErrors >= 1 && stats.files == 0 && stats.videoFrames == 0);
+    EncodedRecorderDestroy(recorder);
+}
+
+/// 录制器端到端：参数集变化时换新文件，每个文件的帧数与 avcC 对应
+static void TestRecorderEndToEnd(void) {
+    enum { Frames = 120, SwitchAt = 60 };
+    static TestAccessUnit units[Frames];
+    const int64_t baseUs = EncodedRecorderNowUs();
+    for (uint32_t i = 0; i < Frames; i++) {
+        MakeAccessUnit(&units[i], i, i % 30 == 0, i < SwitchAt ? 4 : 5, baseUs);
+    }
+    char prefix[256];
+    TestPath(prefix, sizeof(prefix), "recording");
+    EncodedRecorderConfig config = EncodedRecorderDefaultConfig(prefix);
+    config.fragmentDurationMs = 300;
+    config.pollIntervalMs = 1;
+    EncodedRecorder *recorder = EncodedRecorderCreate(&config);
+    for (uint32_t i = 0; i < Frames; i++) {
+        TEST_CHECK(EncodedRecorderPushVideo(recorder, &units[i].header, units[i].bytes));
+        if (i % 10 == 9) {
+            usleep(1000);
+        }
+    }
+    EncodedRecorderStop(recorder);
+    EncodedRecorderStats stats;
+    EncodedRecorderGetStats(recorder, &stats);
+    TEST_CHECK(stats.files == 2 && stats.videoFrames == Frames && stats.videoDrops == 0 &&
+               stats.skippedFrames == 0 && stats.writeErrors == 0);
+
+    uint64_t totalBytes = 0;
+    for (int file = 0; file < 2; file++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s_%03d.mp4", prefix, file);
+        size_t size;
+        uint8_t *data = ReadWholeFile(path, &size);
+        TEST_CHECK(data != NULL);
+        if (!data) {
+            continue;
+        }
+        totalBytes += size;
+        size_t offset = 0;
+        TestBox ftyp, moov;
+        TEST_CHECK(NextBox(data, size, &offset, "ftyp", &ftyp) && NextBox(data, size, &offset, "moov", &moov));
+        TEST_CHECK(CheckVideoTrack(&moov, file == 0 ? 4 : 5, 640, 360));
+        // 样本数据按顺序与输入一致
+        size_t first = file == 0 ? 0 : SwitchAt;
+        size_t count = 0;
+        bool samplesMatch = true;
+        while (offset < size) {
+            TestBox moof, mdat, traf, trun;
+            if (!NextBox(data, size, &offset, "moof", &moof) || !NextBox(data, size, &offset, "mdat", &mdat) ||
+                !FindChild(&moof, 0, "traf", 0, &traf) || !FindChild(&traf, 0, "trun", 0, &trun)) {
+                samplesMatch = false;
+                break;
+            }
+            const uint8_t *media = moof.start + Be32(trun.payload + 8);
+            for (uint32_t i = 0; i < Be32(trun.payload + 4); i++, count++) {
+                const TestAccessUnit *au = &units[first + count];
+                samplesMatch = samplesMatch && first + count < Frames && Be32(trun.payload + 16 + 16 * i) == au->sampleSize &&
+                               memcmp(media, au->sample, au->sampleSize) == 0;
+                media += au->sampleSize;
+            }
+        }
+        TEST_CHECK(samplesMatch && count == SwitchAt);
+        free(data);
+        unlink(path);
+    }
+    TEST_CHECK(totalBytes == stats.bytesWritten);
+    EncodedRecorderDestroy(recorder);
+}
+
+int main(void) {
+    if (!mkdtemp(testDirectory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    TEST_RUN(TestConfigAndOpen);
+    TEST_RUN(TestFrameRules);
+    TEST_RUN(TestFmp4RoundTrip);
+    TEST_RUN(TestFmp4Audio);
+    TEST_RUN(TestAnnexBWithWav);
+    TEST_RUN(TestWriteFailure);
+    TEST_RUN(TestNoAllocationAfterCreate);
+    TEST_RUN(TestRecorderPaths);
+    TEST_RUN(TestRecorderEndToEnd);
+    rmdir(testDirectory);
+    return TEST_RESULT();
+}
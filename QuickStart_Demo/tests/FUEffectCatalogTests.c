@@ -0,0 +1,190 @@
+//
+//  FUEffectCatalogTests.c
+//  tests
+//
+//  效果目录往返测试：compile_effect_catalog.py 从 JSON 编译的目录经 C 读取后与脚本导出的字段逐一比对，
+//  源文件哈希与应用内校验算法一致，以及损坏的目录被拒绝
+//
+//  用法：FUEffectCatalogTests <effects.catalog> <dump.txt> <Demo/Resource 目录>
+//
+
+#include "FUEffectCatalog.h"
+#include "TestSupport.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// 与 FUEffectCatalogLoader、compile_effect_catalog.py 相同的源文件顺序
+static const char *const sourceFiles[FUEffectCatalogTableCount] = {
+    "美颜/beauty_skin.json",
+    "美颜/beauty_shape.json",
+    "美颜/beauty_filter.json",
+    "美妆/combination_makeups.json",
+    "贴纸/stickers.json",
+    "美体/body.json",
+};
+
+static uint8_t *ReadFile(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    // 目录要求 8 字节对齐，malloc 满足
+    uint8_t *data = size > 0 ? malloc((size_t)size) : NULL;
+    *length = data ? fread(data, 1, (size_t)size, file) : 0;
+    fclose(file);
+    return data;
+}
+
+static const char *catalogPath;
+static const char *dumpPath;
+static const char *resourceDir;
+
+/// 应用内 isCatalogUpToDate 的计算方式与脚本写入的哈希一致
+static void TestSourceHashMatchesLoader(void) {
+    FUEffectCatalog *catalog = FUEffectCatalogOpen(catalogPath);
+    TEST_CHECK(catalog != NULL);
+    if (!catalog) {
+        return;
+    }
+    uint64_t hash = 0;
+    for (int i = 0; i < FUEffectCatalogTableCount; i++) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", resourceDir, sourceFiles[i]);
+        size_t length = 0;
+        uint8_t *data = ReadFile(path, &length);
+        TEST_CHECK(data != NULL);
+        hash = FUEffectCatalogHashBytes(data, length, hash);
+        free(data);
+    }
+    TEST_CHECK(hash == FUEffectCatalogSourceHash(catalog));
+    // 任一 JSON 改动一个字节后哈希不同，应用会回退到解析 JSON
+    TEST_CHECK(FUEffectCatalogHashBytes(" ", 1, hash) != hash);
+    FUEffectCatalogClose(catalog);
+}
+
+/// 按制表符切分一行，空字段保留
+static int SplitFields(char *line, char **fields, int maxFields) {
+    int count = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    char *cursor = line;
+    while (cursor && count < maxFields) {
+        fields[count++] = strsep(&cursor, "\t");
+    }
+    return count;
+}
+
+static void TestRecordsRoundTrip(void) {
+    FUEffectCatalog *catalog = FUEffectCatalogOpen(catalogPath);
+    FILE *dump = fopen(dumpPath, "r");
+    TEST_CHECK(catalog != NULL && dump != NULL);
+    if (!catalog || !dump) {
+        FUEffectCatalogClose(catalog);
+        if (dump) {
+            fclose(dump);
+        }
+        return;
+    }
+    char line[4096];
+    TEST_CHECK(fgets(line, sizeof(line), dump) != NULL);
+    TEST_CHECK(strtoull(line, NULL, 16) == FUEffectCatalogSourceHash(catalog));
+
+    uint32_t seen[FUEffectCatalogTableCount] = {0};
+    int records = 0;
+    while (fgets(line, sizeof(line), dump)) {
+        char *fields[10];
+        if (SplitFields(line, fields, 10) != 10) {
+            TEST_CHECK(!"malformed dump line");
+            continue;
+        }
+        int table = atoi(fields[0]);
+        uint32_t index = (uint32_t)strtoul(fields[1], NULL, 10);
+        const FUEffectCatalogRecord *tableRecords = NULL;
+        uint32_t count = 0;
+        TEST_CHECK(table >= 0 && table < FUEffectCatalogTableCount);
+        TEST_CHECK(FUEffectCatalogGetTable(catalog, (FUEffectCatalogTable)table, &tableRecords, &count));
+        TEST_CHECK(index < count);
+        if (index >= count) {
+            continue;
+        }
+        const FUEffectCatalogRecord *record = &tableRecords[index];
+        TEST_CHECK(strcmp(FUEffectCatalogString(catalog, record->name), fields[2]) == 0);
+        TEST_CHECK(strcmp(FUEffectCatalogString(catalog, record->icon), fields[3]) == 0);
+        TEST_CHECK(strcmp(FUEffectCatalogString(catalog, record->bundleName), fields[4]) == 0);
+        TEST_CHECK(record->type == atoi(fields[5]));
+        // 脚本以 repr 输出，strtod 可精确还原
+        TEST_CHECK(record->currentValue == strtod(fields[6], NULL));
+        TEST_CHECK(record->defaultValue == strtod(fields[7], NULL));
+        TEST_CHECK(record->ratio == atoi(fields[8]));
+        TEST_CHECK(record->flags == (uint32_t)strtoul(fields[9], NULL, 10));
+        seen[table]++;
+        records++;
+    }
+    fclose(dump);
+    // 每张表的记录都出现在导出中，没有多余记录
+    for (int i = 0; i < FUEffectCatalogTableCount; i++) {
+        const FUEffectCatalogRecord *tableRecords = NULL;
+        uint32_t count = 0;
+        FUEffectCatalogGetTable(catalog, (FUEffectCatalogTable)i, &tableRecords, &count);
+        TEST_CHECK(count > 0);
+        TEST_CHECK(seen[i] == count);
+    }
+    printf("  %d records\n", records);
+    FUEffectCatalogClose(catalog);
+}
+
+/// 截断、魔数/版本错误、字符串偏移越界的目录都被拒绝
+static void TestRejectsCorruptCatalog(void) {
+    size_t length = 0;
+    uint8_t *original = ReadFile(catalogPath, &length);
+    TEST_CHECK(original != NULL && length > 64);
+    if (!original) {
+        return;
+    }
+    uint8_t *data = malloc(length);
+    memcpy(data, original, length);
+    FUEffectCatalog *catalog = FUEffectCatalogOpenWithBytes(data, length);
+    TEST_CHECK(catalog != NULL);
+    FUEffectCatalogClose(catalog);
+
+    for (size_t truncated = 0; truncated < length; truncated += 7) {
+        catalog = FUEffectCatalogOpenWithBytes(data, truncated);
+        TEST_CHECK(catalog == NULL);
+        FUEffectCatalogClose(catalog);
+    }
+
+    data[0] ^= 0xFF;
+    TEST_CHECK(FUEffectCatalogOpenWithBytes(data, length) == NULL);
+    memcpy(data, original, length);
+    data[4] += 1;   // version
+    TEST_CHECK(FUEffectCatalogOpenWithBytes(data, length) == NULL);
+    memcpy(data, original, length);
+
+    // 第一张表第一条记录的 name 偏移指到字符串表之外
+    uint32_t stringTableSize = 0;
+    uint32_t firstTableOffset = 0;
+    memcpy(&stringTableSize, data + 16, sizeof(uint32_t));
+    memcpy(&firstTableOffset, data + 32, sizeof(uint32_t));
+    memcpy(data + firstTableOffset, &stringTableSize, sizeof(uint32_t));
+    TEST_CHECK(FUEffectCatalogOpenWithBytes(data, length) == NULL);
+
+    free(data);
+    free(original);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s <effects.catalog> <dump.txt> <resource dir>\n", argv[0]);
+        return 2;
+    }
+    catalogPath = argv[1];
+    dumpPath = argv[2];
+    resourceDir = argv[3];
+    TEST_RUN(TestSourceHashMatchesLoader);
+    TEST_RUN(TestRecordsRoundTrip);
+    TEST_RUN(TestRejectsCorruptCatalog);
+    return TEST_RESULT();
+}
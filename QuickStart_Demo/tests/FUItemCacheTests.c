@@ -0,0 +1,190 @@
+//
+//  FUItemCacheTests.c
+//  tests
+//
+//  道具缓存策略：命中与未命中计数、LRU 淘汰顺序、字节计数、超出预算不缓存、
+//  预取只用剩余预算且最先淘汰、移除不回调、A→B→A 切换命中，以及命中不分配内存
+//
+
+#include "FUItemCache.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <string.h>
+
+/// 假道具后端：道具是带路径的计数对象，记录淘汰顺序
+typedef struct {
+    char path[32];
+    int evicted;
+} TestItem;
+
+typedef struct {
+    TestItem items[16];
+    uint32_t itemCount;
+    char evictedPaths[16][32];
+    uint32_t evictedCount;
+} TestBackend;
+
+static TestItem *TestCreateItem(TestBackend *backend, const char *path) {
+    TestItem *item = &backend->items[backend->itemCount++];
+    snprintf(item->path, sizeof(item->path), "%s", path);
+    item->evicted = 0;
+    return item;
+}
+
+static void TestEvict(void *context, void *item, const char *path) {
+    TestBackend *backend = context;
+    TestItem *testItem = item;
+    testItem->evicted++;
+    snprintf(backend->evictedPaths[backend->evictedCount++], 32, "%s", path);
+}
+
+static FUItemCache *TestCreateCache(TestBackend *backend, size_t byteBudget) {
+    memset(backend, 0, sizeof(*backend));
+    FUItemCacheBackend callbacks = {.evict = TestEvict, .context = backend};
+    return FUItemCacheCreate(byteBudget, &callbacks);
+}
+
+/// 按 itemForPath 的用法：查找，未命中时创建并放入
+static TestItem *TestGet(FUItemCache *cache, TestBackend *backend, const char *path, size_t cost) {
+    TestItem *item = FUItemCacheLookup(cache, path);
+    if (!item) {
+        item = TestCreateItem(backend, path);
+        FUItemCacheInsert(cache, path, item, cost);
+    }
+    return item;
+}
+
+/// 命中、未命中与字节计数
+static void TestHitsAndAccounting(void) {
+    TestBackend backend;
+    FUItemCache *cache = TestCreateCache(&backend, 1000);
+    TEST_CHECK(FUItemCacheLookup(cache, "a") == NULL);
+    TestItem *a = TestCreateItem(&backend, "a");
+    TEST_CHECK(FUItemCacheInsert(cache, "a", a, 300));
+    TEST_CHECK(!FUItemCacheInsert(cache, "a", a, 300));
+    TestItem *b = TestGet(cache, &backend, "b", 200);
+    TEST_CHECK(FUItemCacheLookup(cache, "a") == a);
+    TEST_CHECK(FUItemCacheLookup(cache, "b") == b);
+    TEST_CHECK(FUItemCacheContains(cache, "a") && !FUItemCacheContains(cache, "c"));
+    FUItemCacheStats stats = FUItemCacheGetStats(cache);
+    TEST_CHECK(stats.hits == 2 && stats.misses == 2 && stats.evictions == 0);
+    TEST_CHECK(stats.usedBytes == 500 && stats.count == 2);
+    TEST_CHECK(FUItemCacheHasRoom(cache, 500) && !FUItemCacheHasRoom(cache, 501));
+    // Contains 不影响计数
+    TEST_CHECK(FUItemCacheGetStats(cache).hits == 2);
+    FUItemCacheDestroy(cache);
+}
+
+/// A→B→A 切换时第二次选中 A 命中，不重新创建
+static void TestSwitchBack(void) {
+    TestBackend backend;
+    FUItemCache *cache = TestCreateCache(&backend, 1000);
+    TestItem *a = TestGet(cache, &backend, "a", 100);
+    TestGet(cache, &backend, "b", 100);
+    TEST_CHECK(TestGet(cache, &backend, "a", 100) == a);
+    TEST_CHECK(backend.itemCount == 2);
+    FUItemCacheStats stats = FUItemCacheGetStats(cache);
+    TEST_CHECK(stats.hits == 1 && stats.misses == 2);
+    FUItemCacheDestroy(cache);
+}
+
+/// 超出预算时按 LRU 淘汰，命中会刷新顺序
+static void TestLruEviction(void) {
+    TestBackend backend;
+    FUItemCache *cache = TestCreateCache(&backend, 300);
+    TestItem *a = TestGet(cache, &backend, "a", 100);
+    TestItem *b = TestGet(cache, &backend, "b", 100);
+    TestGet(cache, &backend, "c", 100);
+    // a 变为最新，b 最旧
+    TEST_CHECK(FUItemCacheLookup(cache, "a") == a);
+    TestGet(cache, &backend, "d", 100);
+    TEST_CHECK(backend.evictedCount == 1 && strcmp(backend.evictedPaths[0], "b") == 0 && b->evicted == 1);
+    TEST_CHECK(!FUItemCacheContains(cache, "b") && FUItemCacheContains(cache, "a"));
+    // 一次淘汰多个，直到放得下
+    TestGet(cache, &backend, "e", 250);
+    TEST_CHECK(backend.evictedCount == 4);
+    TEST_CHECK(strcmp(backend.evictedPaths[1], "c") == 0 && strcmp(backend.evictedPaths[2], "a") == 0 &&
+               strcmp(backend.evictedPaths[3], "d") == 0);
+    FUItemCacheStats stats = FUItemCacheGetStats(cache);
+    TEST_CHECK(stats.evictions == 4 && stats.usedBytes == 250 && stats.count == 1);
+    FUItemCacheDestroy(cache);
+}
+
+/// 单个超出预算的道具不缓存、不淘汰已有道具
+static void TestOversizedItem(void) {
+    TestBackend backend;
+    FUItemCache *cache = TestCreateCache(&backend, 300);
+    TestGet(cache, &backend, "a", 200);
+    TestItem *big = TestCreateItem(&backend, "big");
+    TEST_CHECK(!FUItemCacheInsert(cache, "big", big, 301));
+    TEST_CHECK(backend.evictedCount == 0 && FUItemCacheContains(cache, "a") && !FUItemCacheContains(cache, "big"));
+    TEST_CHECK(FUItemCacheGetStats(cache).usedBytes == 200);
+    FUItemCacheDestroy(cache);
+}
+
+/// 预取只用剩余预算，放在最旧的位置
+static void TestPrefetch(void) {
+    TestBackend backend;
+    FUItemCache *cache = TestCreateCache(&backend, 300);
+    TestGet(cache, &backend, "a", 100);
+    TestGet(cache, &backend, "b", 100);
+    TEST_CHECK(!FUItemCacheInsertPrefetched(cache, "p", TestCreateItem(&backend, "p"), 101));
+    TEST_CHECK(backend.evictedCount == 0 && FUItemCacheGetStats(cache).usedBytes == 200);
+    TEST_CHECK(FUItemCacheInsertPrefetched(cache, "q", TestCreateItem(&backend, "q"), 100));
+    TEST_CHECK(!FUItemCacheInsertPrefetched(cache, "q", TestCreateItem(&backend, "q"), 0));
+    FUItemCacheStats stats = FUItemCacheGetStats(cache);
+    TEST_CHECK(stats.hits == 0 && stats.misses == 2 && stats.usedBytes == 300 && stats.count == 3);
+    // 预取的 q 最先淘汰
+    TestGet(cache, &backend, "c", 100);
+    TEST_CHECK(backend.evictedCount == 1 && strcmp(backend.evictedPaths[0], "q") == 0);
+    FUItemCacheDestroy(cache);
+}
+
+/// 移除不回调，清空由旧到新回调
+static void TestRemove(void) {
+    TestBackend backend;
+    FUItemCache *cache = TestCreateCache(&backend, 1000);
+    TestItem *a = TestGet(cache, &backend, "a", 100);
+    TestGet(cache, &backend, "b", 200);
+    TestGet(cache, &backend, "c", 300);
+    TEST_CHECK(FUItemCacheRemove(cache, "a") == a && a->evicted == 0 && backend.evictedCount == 0);
+    TEST_CHECK(FUItemCacheRemove(cache, "a") == NULL);
+    TEST_CHECK(FUItemCacheGetStats(cache).usedBytes == 500);
+    FUItemCacheRemoveAll(cache);
+    TEST_CHECK(backend.evictedCount == 2 && strcmp(backend.evictedPaths[0], "b") == 0 && strcmp(backend.evictedPaths[1], "c") == 0);
+    FUItemCacheStats stats = FUItemCacheGetStats(cache);
+    TEST_CHECK(stats.usedBytes == 0 && stats.count == 0 && stats.evictions == 2);
+    // 清空后仍可使用
+    TestGet(cache, &backend, "a", 100);
+    TEST_CHECK(FUItemCacheContains(cache, "a"));
+    FUItemCacheDestroy(cache);
+}
+
+/// 命中与淘汰不分配内存，只有放入新道具时分配一次
+static void TestNoAllocationOnHit(void) {
+    TestBackend backend;
+    FUItemCache *cache = TestCreateCache(&backend, 300);
+    TestGet(cache, &backend, "a", 100);
+    TestGet(cache, &backend, "b", 100);
+    uint64_t allocations = TestAllocCount();
+    for (int i = 0; i < 1000; i++) {
+        FUItemCacheLookup(cache, (i & 1) ? "a" : "b");
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    TestGet(cache, &backend, "c", 200);
+    TEST_CHECK(TestAllocCount() == allocations + 1);
+    printf("  hits %llu, allocations on 1000 hits: 0\n", (unsigned long long)FUItemCacheGetStats(cache).hits);
+    FUItemCacheDestroy(cache);
+}
+
+int main(void) {
+    TEST_RUN(TestHitsAndAccounting);
+    TEST_RUN(TestSwitchBack);
+    TEST_RUN(TestLruEviction);
+    TEST_RUN(TestOversizedItem);
+    TEST_RUN(TestPrefetch);
+    TEST_RUN(TestRemove);
+    TEST_RUN(TestNoAllocationOnHit);
+    return TEST_RESULT();
+}
@@ -0,0 +1,239 @@
+//
+//  FULatencyHistogramTests.c
+//  tests
+//
+//  无锁耗时直方图：分桶精度、百分位、快照清零，以及多线程记录不丢计数、不分配内存
+//
+
+#include "FULatencyHistogram.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+static FULatencyHistogram *CreateHistogram(void) {
+    return calloc(1, sizeof(FULatencyHistogram));
+}
+
+/// 只记录一个值时，各百分位即为该值所在桶的上界（不超过最大值），相对误差在 1/16 以内
+static void TestSingleValueWithinRelativeError(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    FULatencyHistogramSnapshot snapshot;
+    for (uint64_t value = 1; value < (1ull << 26); value = value * 5 / 4 + 1) {
+        FULatencyHistogramRecord(histogram, value);
+        FULatencyHistogramRecord(histogram, value * 64);  // 抬高最大值，让百分位返回桶上界
+        FULatencyHistogramTakeSnapshot(histogram, &snapshot, true);
+        uint64_t p50 = FULatencyHistogramSnapshotPercentile(&snapshot, 50);
+        TEST_CHECK(p50 >= value);
+        TEST_CHECK(p50 - value <= value / FU_LATENCY_HISTOGRAM_SUB_BUCKETS);
+    }
+    free(histogram);
+}
+
+static void TestSmallValuesAreExact(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    FULatencyHistogramSnapshot snapshot;
+    for (uint64_t value = 0; value < 2 * FU_LATENCY_HISTOGRAM_SUB_BUCKETS; value++) {
+        FULatencyHistogramRecord(histogram, value);
+        FULatencyHistogramRecord(histogram, 1000);
+        FULatencyHistogramTakeSnapshot(histogram, &snapshot, true);
+        TEST_CHECK(FULatencyHistogramSnapshotPercentile(&snapshot, 50) == value);
+    }
+    free(histogram);
+}
+
+static void TestPercentilesOfUniformDistribution(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    for (uint64_t value = 1; value <= 10000; value++) {
+        FULatencyHistogramRecord(histogram, value);
+    }
+    FULatencyHistogramSnapshot snapshot;
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(snapshot.count == 10000);
+    TEST_CHECK(snapshot.maxValue == 10000);
+    TEST_CHECK(snapshot.totalValue == 10000ull * 10001 / 2);
+    TEST_CHECK(FULatencyHistogramSnapshotMean(&snapshot) == 5000.5);
+    const double percentiles[] = {50, 95, 99};
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+        uint64_t expected = (uint64_t)(percentiles[i] * 100);
+        uint64_t actual = FULatencyHistogramSnapshotPercentile(&snapshot, percentiles[i]);
+        TEST_CHECK(actual >= expected);
+        TEST_CHECK(actual - expected <= expected / FU_LATENCY_HISTOGRAM_SUB_BUCKETS);
+    }
+    TEST_CHECK(FULatencyHistogramSnapshotPercentile(&snapshot, 100) == 10000);
+    // 百分位随参数单调不减
+    uint64_t previous = 0;
+    for (double percentile = 0; percentile <= 100; percentile += 0.5) {
+        uint64_t value = FULatencyHistogramSnapshotPercentile(&snapshot, percentile);
+        TEST_CHECK(value >= previous);
+        previous = value;
+    }
+    free(histogram);
+}
+
+/// 均值掩盖的尾部尖峰要能从 p99 与最大值看出来
+static void TestTailSpikeVisible(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    for (int i = 0; i < 980; i++) {
+        FULatencyHistogramRecord(histogram, 8000);
+    }
+    for (int i = 0; i < 20; i++) {
+        FULatencyHistogramRecord(histogram, 60000);
+    }
+    FULatencyHistogramSnapshot snapshot;
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(FULatencyHistogramSnapshotMean(&snapshot) < 10000);
+    TEST_CHECK(FULatencyHistogramSnapshotPercentile(&snapshot, 50) < 8600);
+    TEST_CHECK(FULatencyHistogramSnapshotPercentile(&snapshot, 99) == 60000);
+    TEST_CHECK(snapshot.maxValue == 60000);
+    free(histogram);
+}
+
+static void TestOverflowGoesToLastBucket(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    FULatencyHistogramRecord(histogram, UINT64_MAX / 2);
+    FULatencyHistogramRecord(histogram, 1ull << 40);
+    FULatencyHistogramSnapshot snapshot;
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(snapshot.counts[FU_LATENCY_HISTOGRAM_BUCKETS - 1] == 2);
+    TEST_CHECK(snapshot.maxValue == UINT64_MAX / 2);
+    // 最后一个桶本身覆盖 [2^27 - 2^22, 2^27)，与头文件中的记录范围一致
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, true);
+    FULatencyHistogramRecord(histogram, (1ull << 27) - (1ull << 22) - 1);
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(snapshot.counts[FU_LATENCY_HISTOGRAM_BUCKETS - 2] == 1);
+    FULatencyHistogramRecord(histogram, (1ull << 27) - 1);
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(snapshot.counts[FU_LATENCY_HISTOGRAM_BUCKETS - 1] == 1);
+    TEST_CHECK(FULatencyHistogramSnapshotPercentile(&snapshot, 100) == (1ull << 27) - 1);
+    free(histogram);
+}
+
+static void TestSnapshotReset(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    FULatencyHistogramSnapshot snapshot;
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(snapshot.count == 0);
+    TEST_CHECK(FULatencyHistogramSnapshotPercentile(&snapshot, 99) == 0);
+    TEST_CHECK(FULatencyHistogramSnapshotMean(&snapshot) == 0);
+
+    FULatencyHistogramRecord(histogram, 500);
+    FULatencyHistogramRecord(histogram, 700);
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(snapshot.count == 2);
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, true);
+    TEST_CHECK(snapshot.count == 2 && snapshot.maxValue == 700 && snapshot.totalValue == 1200);
+    // 清零后开始新的统计窗口
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, false);
+    TEST_CHECK(snapshot.count == 0 && snapshot.maxValue == 0 && snapshot.totalValue == 0);
+    FULatencyHistogramRecord(histogram, 300);
+    FULatencyHistogramTakeSnapshot(histogram, &snapshot, true);
+    TEST_CHECK(snapshot.count == 1 && snapshot.maxValue == 300);
+    free(histogram);
+}
+
+// 并发
+
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_RECORDS 200000
+
+typedef struct {
+    FULatencyHistogram *histogram;
+    uint64_t seed;
+    uint64_t total;
+    uint64_t maxValue;
+} RecorderThread;
+
+static void *RecorderMain(void *argument) {
+    RecorderThread *thread = argument;
+    uint64_t seed = thread->seed;
+    for (int i = 0; i < CONCURRENT_RECORDS; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t value = (seed >> 33) % 100000;
+        FULatencyHistogramRecord(thread->histogram, value);
+        thread->total += value;
+        if (value > thread->maxValue) {
+            thread->maxValue = value;
+        }
+    }
+    return NULL;
+}
+
+/// 多个线程同时记录，另一线程按窗口取快照并清零，合计后不丢计数、不分配内存
+static void TestConcurrentRecordAndSnapshot(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    FULatencyHistogramSnapshot *snapshot = malloc(sizeof(FULatencyHistogramSnapshot));
+    RecorderThread threads[CONCURRENT_THREADS];
+    pthread_t handles[CONCURRENT_THREADS];
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        threads[i] = (RecorderThread){.histogram = histogram, .seed = (uint64_t)i + 1};
+        pthread_create(&handles[i], NULL, RecorderMain, &threads[i]);
+    }
+    uint64_t allocsAfterStart = TestAllocCount();
+
+    uint64_t windowCount = 0;
+    uint64_t windowTotal = 0;
+    uint64_t windowMax = 0;
+    for (int i = 0; i < 50; i++) {
+        FULatencyHistogramTakeSnapshot(histogram, snapshot, true);
+        windowCount += snapshot->count;
+        windowTotal += snapshot->totalValue;
+        if (snapshot->maxValue > windowMax) {
+            windowMax = snapshot->maxValue;
+        }
+        usleep(200);
+    }
+    uint64_t allocsDuringRecording = TestAllocCount() - allocsAfterStart;
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        pthread_join(handles[i], NULL);
+    }
+    FULatencyHistogramTakeSnapshot(histogram, snapshot, true);
+    windowCount += snapshot->count;
+    windowTotal += snapshot->totalValue;
+    if (snapshot->maxValue > windowMax) {
+        windowMax = snapshot->maxValue;
+    }
+
+    uint64_t expectedTotal = 0;
+    uint64_t expectedMax = 0;
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        expectedTotal += threads[i].total;
+        if (threads[i].maxValue > expectedMax) {
+            expectedMax = threads[i].maxValue;
+        }
+    }
+    TEST_CHECK(windowCount == (uint64_t)CONCURRENT_THREADS * CONCURRENT_RECORDS);
+    TEST_CHECK(windowTotal == expectedTotal);
+    TEST_CHECK(windowMax == expectedMax);
+    TEST_CHECK(allocsDuringRecording == 0);
+    printf("  %d threads x %d records, allocs while recording %llu\n",
+           CONCURRENT_THREADS, CONCURRENT_RECORDS, (unsigned long long)allocsDuringRecording);
+    free(snapshot);
+    free(histogram);
+}
+
+static void BenchmarkRecord(void) {
+    FULatencyHistogram *histogram = CreateHistogram();
+    const int iterations = 10000000;
+    uint64_t start = TestNowNs();
+    for (int i = 0; i < iterations; i++) {
+        FULatencyHistogramRecord(histogram, (uint64_t)(i & 0xFFFF) + 1000);
+    }
+    double nsPerRecord = (double)(TestNowNs() - start) / iterations;
+    printf("  record: %.1f ns\n", nsPerRecord);
+    free(histogram);
+}
+
+int main(void) {
+    TEST_RUN(TestSingleValueWithinRelativeError);
+    TEST_RUN(TestSmallValuesAreExact);
+    TEST_RUN(TestPercentilesOfUniformDistribution);
+    TEST_RUN(TestTailSpikeVisible);
+    TEST_RUN(TestOverflowGoesToLastBucket);
+    TEST_RUN(TestSnapshotReset);
+    TEST_RUN(TestConcurrentRecordAndSnapshot);
+    BenchmarkRecord();
+    return TEST_RESULT();
+}
@@ -0,0 +1,431 @@
+//
+//  FULogWriterTests.c
+//  tests
+//
+//  追加式日志：配置检查、行的顺序与换行、截断、队列满时丢弃、按大小轮转、时间格式、
+//  多线程追加不丢行且不分配内存，以及替换日志时等正在进行的追加结束后才释放
+//
+
+#include "FULogWriter.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static char testDirectory[64];
+
+static void TestSleepMs(long milliseconds) {
+    struct timespec interval = {.tv_sec = milliseconds / 1000, .tv_nsec = (milliseconds % 1000) * 1000000};
+    nanosleep(&interval, NULL);
+}
+
+static void TestPath(char *path, size_t size, const char *name) {
+    snprintf(path, size, "%s/%s", testDirectory, name);
+}
+
+/// 读入整个文件，返回长度，文件不存在时返回 -1
+static long TestReadFile(const char *path, char *out, size_t capacity) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    size_t length = fread(out, 1, capacity - 1, file);
+    out[length] = '\0';
+    fclose(file);
+    return (long)length;
+}
+
+static size_t TestCountLines(const char *text) {
+    size_t lines = 0;
+    for (const char *p = text; *p; p++) {
+        lines += *p == '\n';
+    }
+    return lines;
+}
+
+static void TestConfig(void) {
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    TEST_CHECK(config.queueLines == 1024 && config.flushBytes == 64 * 1024 && config.fsyncIntervalMs == 1000 &&
+               config.maxFileBytes == 8 * 1024 * 1024 && config.maxRotatedFiles == 3 && config.pollIntervalMs == 50);
+    char path[128];
+    TestPath(path, sizeof(path), "config.log");
+    TEST_CHECK(FULogWriterCreate(NULL, NULL, &config) == NULL);
+    TEST_CHECK(FULogWriterCreate(path, NULL, NULL) == NULL);
+    FULogWriterConfig invalid = config;
+    invalid.queueLines = 0;
+    TEST_CHECK(FULogWriterCreate(path, NULL, &invalid) == NULL);
+    invalid.queueLines = (1u << 20) + 1;
+    TEST_CHECK(FULogWriterCreate(path, NULL, &invalid) == NULL);
+    invalid = config;
+    invalid.flushBytes = FU_LOG_WRITER_LINE_MAX - 1;
+    TEST_CHECK(FULogWriterCreate(path, NULL, &invalid) == NULL);
+    invalid = config;
+    invalid.pollIntervalMs = 0;
+    TEST_CHECK(FULogWriterCreate(path, NULL, &invalid) == NULL);
+
+    static char longPath[PATH_MAX];
+    memset(longPath, 'a', sizeof(longPath) - 1);
+    longPath[0] = '/';
+    TEST_CHECK(FULogWriterCreate(longPath, NULL, &config) == NULL);
+    char missing[128];
+    TestPath(missing, sizeof(missing), "missing/config.log");
+    TEST_CHECK(FULogWriterCreate(missing, NULL, &config) == NULL);
+    FULogWriterDestroy(NULL);
+}
+
+/// 表头与各行按追加顺序写入，缺少的换行补上；停止后不再接受追加
+static void TestAppendAndStop(void) {
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    char path[128];
+    TestPath(path, sizeof(path), "append.log");
+    FULogWriter *writer = FULogWriterCreate(path, "time,fps\n", &config);
+    TEST_CHECK(writer != NULL);
+    TEST_CHECK(FULogWriterAppendf(writer, "%d,%s\n", 1, "a"));
+    TEST_CHECK(FULogWriterAppendf(writer, "%d,%s", 2, "b"));
+    TEST_CHECK(FULogWriterAppendf(writer, "%s", ""));
+    TEST_CHECK(FULogWriterAppendf(writer, "3,c\n"));
+    FULogWriterStop(writer);
+    TEST_CHECK(!FULogWriterAppendf(writer, "4,d\n"));
+    FULogWriterStop(writer);
+
+    char text[256];
+    TEST_CHECK(TestReadFile(path, text, sizeof(text)) > 0);
+    TEST_CHECK(strcmp(text, "time,fps\n1,a\n2,b\n\n3,c\n") == 0);
+    FULogWriterStats stats;
+    FULogWriterGetStats(writer, &stats);
+    TEST_CHECK(stats.appendedLines == 4 && stats.droppedLines == 0 && stats.truncatedLines == 0);
+    TEST_CHECK(stats.writtenBytes == strlen(text) && stats.writeErrors == 0 && stats.rotations == 0);
+    TEST_CHECK(stats.fsyncCalls >= 1);
+    FULogWriterDestroy(writer);
+
+    // 没有表头时文件只有追加的行；重新创建时覆盖旧文件
+    writer = FULogWriterCreate(path, NULL, &config);
+    TEST_CHECK(FULogWriterAppendf(writer, "only\n"));
+    FULogWriterDestroy(writer);
+    TEST_CHECK(TestReadFile(path, text, sizeof(text)) == 5 && strcmp(text, "only\n") == 0);
+    unlink(path);
+}
+
+/// 超出单行上限的部分截断，仍以换行结尾
+static void TestTruncation(void) {
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    char path[128];
+    TestPath(path, sizeof(path), "truncate.log");
+    FULogWriter *writer = FULogWriterCreate(path, NULL, &config);
+    char longLine[1000];
+    memset(longLine, 'z', sizeof(longLine) - 1);
+    longLine[sizeof(longLine) - 1] = '\0';
+    TEST_CHECK(FULogWriterAppendf(writer, "%s", longLine));
+    // 恰好 LINE_MAX - 1 个字符加换行时不截断
+    TEST_CHECK(FULogWriterAppendf(writer, "%.*s\n", FU_LOG_WRITER_LINE_MAX - 2, longLine));
+    FULogWriterDestroy(writer);
+
+    char text[2048];
+    TEST_CHECK(TestReadFile(path, text, sizeof(text)) == 2 * FU_LOG_WRITER_LINE_MAX - 1);
+    TEST_CHECK(text[FU_LOG_WRITER_LINE_MAX - 1] == '\n' && text[FU_LOG_WRITER_LINE_MAX - 2] == 'z');
+    TEST_CHECK(text[2 * FU_LOG_WRITER_LINE_MAX - 2] == '\n' && TestCountLines(text) == 2);
+    unlink(path);
+}
+
+/// 写入线程休眠时队列写满，多出的行丢弃并计数；停止时写完队列中的行
+static void TestQueueFull(void) {
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    config.queueLines = 3;
+    config.pollIntervalMs = 500;
+    char path[128];
+    TestPath(path, sizeof(path), "full.log");
+    FULogWriter *writer = FULogWriterCreate(path, NULL, &config);
+    // 等写入线程第一次检查完队列进入休眠
+    TestSleepMs(20);
+    int accepted = 0;
+    for (int i = 0; i < 10; i++) {
+        accepted += FULogWriterAppendf(writer, "%d\n", i) ? 1 : 0;
+    }
+    TEST_CHECK(accepted == 4);
+    FULogWriterStats stats;
+    FULogWriterGetStats(writer, &stats);
+    TEST_CHECK(stats.appendedLines == 4 && stats.droppedLines == 6);
+    FULogWriterDestroy(writer);
+    char text[256];
+    TEST_CHECK(TestReadFile(path, text, sizeof(text)) > 0 && strcmp(text, "0\n1\n2\n3\n") == 0);
+    unlink(path);
+}
+
+/// 超出 maxFileBytes 时轮转：每个文件以表头开头且不超过上限，只保留 maxRotatedFiles 个旧文件，行连续不缺
+static void TestRotation(void) {
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    config.maxFileBytes = 100;
+    config.maxRotatedFiles = 2;
+    config.flushBytes = FU_LOG_WRITER_LINE_MAX;
+    config.pollIntervalMs = 1;
+    char path[128];
+    TestPath(path, sizeof(path), "rotate.log");
+    FULogWriter *writer = FULogWriterCreate(path, "seq\n", &config);
+    for (int i = 0; i < 60; i++) {
+        while (!FULogWriterAppendf(writer, "line %04d\n", i)) {
+            TestSleepMs(1);
+        }
+    }
+    FULogWriterDestroy(writer);
+
+    // 从最旧的文件读起，行号应连续递增到 59
+    char names[3][160];
+    snprintf(names[0], sizeof(names[0]), "%s.2", path);
+    snprintf(names[1], sizeof(names[1]), "%s.1", path);
+    snprintf(names[2], sizeof(names[2]), "%s", path);
+    int expected = -1;
+    bool intact = true;
+    for (int f = 0; f < 3; f++) {
+        char text[512];
+        long length = TestReadFile(names[f], text, sizeof(text));
+        TEST_CHECK(length > 0 && length <= 100);
+        TEST_CHECK(strncmp(text, "seq\n", 4) == 0);
+        for (const char *line = text + 4; length > 0 && *line; line += 10) {
+            int number = atoi(line + 5);
+            intact = intact && strncmp(line, "line ", 5) == 0 && (expected < 0 || number == expected + 1);
+            expected = number;
+        }
+    }
+    TEST_CHECK(intact && expected == 59);
+    char extra[160];
+    snprintf(extra, sizeof(extra), "%s.3", path);
+    TEST_CHECK(access(extra, F_OK) != 0);
+    for (int f = 0; f < 3; f++) {
+        unlink(names[f]);
+    }
+}
+
+/// 时区偏移在创建时取得；毫秒为负时借位到上一秒
+static void TestTimestamp(void) {
+    setenv("TZ", "UTC", 1);
+    tzset();
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    char path[128];
+    TestPath(path, sizeof(path), "timestamp.log");
+    FULogWriter *writer = FULogWriterCreate(path, NULL, &config);
+    char out[FU_LOG_WRITER_TIMESTAMP_LENGTH];
+    FULogWriterFormatTimestamp(writer, 0.5, out);
+    TEST_CHECK(strcmp(out, "1970-01-01 00:00:00:500") == 0);
+    FULogWriterFormatTimestamp(writer, 1700000000.125, out);
+    TEST_CHECK(strcmp(out, "2023-11-14 22:13:20:125") == 0);
+    FULogWriterFormatTimestamp(writer, -0.25, out);
+    TEST_CHECK(strcmp(out, "1969-12-31 23:59:59:750") == 0);
+    FULogWriterDestroy(writer);
+
+    setenv("TZ", "CST-8", 1);
+    tzset();
+    writer = FULogWriterCreate(path, NULL, &config);
+    FULogWriterFormatTimestamp(writer, 1700000000.125, out);
+    TEST_CHECK(strcmp(out, "2023-11-15 06:13:20:125") == 0);
+    FULogWriterDestroy(writer);
+    unsetenv("TZ");
+    tzset();
+    unlink(path);
+}
+
+enum {
+    AppendThreads = 4,
+    AppendLines = 20000,
+};
+
+static FULogWriter *concurrentWriter;
+static _Atomic uint64_t appendAllocations;
+
+static void *ConcurrentAppender(void *argument) {
+    int thread = (int)(intptr_t)argument;
+    uint64_t allocations = TestAllocCount();
+    // 第一次使用线程局部缓冲之后的追加不分配内存
+    for (int i = 0; i < AppendLines; i++) {
+        while (!FULogWriterAppendf(concurrentWriter, "%d,%d,%s\n", thread, i, "payload")) {
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(&appendAllocations, TestAllocCount() - allocations);
+    return NULL;
+}
+
+/// 多个线程同时追加，队列满时重试：每行完整，各线程的行按追加顺序出现
+static void TestConcurrentAppend(void) {
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    config.queueLines = 256;
+    config.pollIntervalMs = 1;
+    char path[128];
+    TestPath(path, sizeof(path), "concurrent.log");
+    concurrentWriter = FULogWriterCreate(path, NULL, &config);
+    atomic_store(&appendAllocations, 0);
+    pthread_t threads[AppendThreads];
+    for (int t = 0; t < AppendThreads; t++) {
+        pthread_create(&threads[t], NULL, ConcurrentAppender, (void *)(intptr_t)t);
+    }
+    for (int t = 0; t < AppendThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    FULogWriterDestroy(concurrentWriter);
+
+    FILE *file = fopen(path, "r");
+    int next[AppendThreads] = {0};
+    bool intact = file != NULL;
+    char line[64];
+    size_t lines = 0;
+    while (file && fgets(line, sizeof(line), file)) {
+        int thread = -1;
+        int index = -1;
+        char payload[16] = {0};
+        intact = intact && sscanf(line, "%d,%d,%15[^\n]", &thread, &index, payload) == 3 && thread >= 0 &&
+                 thread < AppendThreads && index == next[thread] && strcmp(payload, "payload") == 0;
+        if (intact) {
+            next[thread]++;
+        }
+        lines++;
+    }
+    if (file) {
+        fclose(file);
+    }
+    TEST_CHECK(intact);
+    TEST_CHECK(lines == (size_t)AppendThreads * AppendLines);
+    TEST_CHECK(atomic_load(&appendAllocations) == 0);
+    unlink(path);
+}
+
+// Slot
+
+static FULogWriterSlot slot;
+static _Atomic bool slotHeld;
+static _Atomic bool slotReleased;
+
+static void *SlotHolder(void *argument) {
+    FULogWriter *writer = FULogWriterSlotAcquire(&slot);
+    atomic_store(&slotHeld, true);
+    TestSleepMs(50);
+    // 替换方等待期间日志仍可用
+    FULogWriterAppendf(writer, "held\n");
+    atomic_store(&slotReleased, true);
+    FULogWriterSlotRelease(&slot);
+    return argument;
+}
+
+/// 零初始化即可用；替换时等已取得日志的线程 Release 后才返回旧日志
+static void TestSlotWaitsForUsers(void) {
+    memset(&slot, 0, sizeof(slot));
+    TEST_CHECK(FULogWriterSlotAcquire(&slot) == NULL);
+    FULogWriterSlotRelease(&slot);
+    TEST_CHECK(FULogWriterSlotExchange(&slot, NULL) == NULL);
+
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    char path[128];
+    TestPath(path, sizeof(path), "slot.log");
+    FULogWriter *writer = FULogWriterCreate(path, NULL, &config);
+    TEST_CHECK(FULogWriterSlotExchange(&slot, writer) == NULL);
+
+    atomic_store(&slotHeld, false);
+    atomic_store(&slotReleased, false);
+    pthread_t holder;
+    pthread_create(&holder, NULL, SlotHolder, NULL);
+    while (!atomic_load(&slotHeld)) {
+        sched_yield();
+    }
+    FULogWriter *previous = FULogWriterSlotExchange(&slot, NULL);
+    TEST_CHECK(previous == writer);
+    TEST_CHECK(atomic_load(&slotReleased));
+    TEST_CHECK(FULogWriterSlotAcquire(&slot) == NULL);
+    FULogWriterSlotRelease(&slot);
+    FULogWriterDestroy(previous);
+    pthread_join(holder, NULL);
+
+    char text[64];
+    TEST_CHECK(TestReadFile(path, text, sizeof(text)) == 5 && strcmp(text, "held\n") == 0);
+    unlink(path);
+}
+
+enum {
+    SwapThreads = 3,
+    SwapGenerations = 40,
+};
+
+static _Atomic bool swapStop;
+static _Atomic uint64_t swapAccepted;
+
+static void *SwapAppender(void *argument) {
+    uint64_t accepted = 0;
+    int i = 0;
+    while (!atomic_load_explicit(&swapStop, memory_order_relaxed)) {
+        FULogWriter *writer = FULogWriterSlotAcquire(&slot);
+        if (writer) {
+            char timestamp[FU_LOG_WRITER_TIMESTAMP_LENGTH];
+            FULogWriterFormatTimestamp(writer, 1700000000.0 + i, timestamp);
+            accepted += FULogWriterAppendf(writer, "%s,%d\n", timestamp, i++) ? 1 : 0;
+        }
+        FULogWriterSlotRelease(&slot);
+        if (i % 16 == 0) {
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(&swapAccepted, accepted);
+    return argument;
+}
+
+/// 追加线程持续使用当前日志，另一线程反复换上新日志并立即释放旧的：
+/// 不访问已释放的日志（ASan 下检查），追加成功的行全部落盘
+static void TestSlotSwapStress(void) {
+    memset(&slot, 0, sizeof(slot));
+    atomic_store(&swapStop, false);
+    atomic_store(&swapAccepted, 0);
+    FULogWriterConfig config = FULogWriterDefaultConfig();
+    config.queueLines = 64;
+    config.pollIntervalMs = 1;
+    pthread_t threads[SwapThreads];
+    for (int t = 0; t < SwapThreads; t++) {
+        pthread_create(&threads[t], NULL, SwapAppender, NULL);
+    }
+    char path[128];
+    for (int generation = 0; generation < SwapGenerations; generation++) {
+        snprintf(path, sizeof(path), "%s/swap%02d.log", testDirectory, generation);
+        FULogWriter *writer = FULogWriterCreate(path, NULL, &config);
+        FULogWriterDestroy(FULogWriterSlotExchange(&slot, writer));
+        TestSleepMs(2);
+    }
+    FULogWriterDestroy(FULogWriterSlotExchange(&slot, NULL));
+    atomic_store(&swapStop, true);
+    for (int t = 0; t < SwapThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    size_t lines = 0;
+    static char text[1 << 20];
+    for (int generation = 0; generation < SwapGenerations; generation++) {
+        snprintf(path, sizeof(path), "%s/swap%02d.log", testDirectory, generation);
+        if (TestReadFile(path, text, sizeof(text)) >= 0) {
+            lines += TestCountLines(text);
+        }
+        unlink(path);
+    }
+    TEST_CHECK(lines == atomic_load(&swapAccepted));
+    TEST_CHECK(lines > 0);
+    printf("  %d swaps, %zu lines\n", SwapGenerations, lines);
+}
+
+int main(void) {
+    snprintf(testDirectory, sizeof(testDirectory), "/tmp/FULogWriterTestsXXXXXX");
+    if (!mkdtemp(testDirectory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    TEST_RUN(TestConfig);
+    TEST_RUN(TestAppendAndStop);
+    TEST_RUN(TestTruncation);
+    TEST_RUN(TestQueueFull);
+    TEST_RUN(TestRotation);
+    TEST_RUN(TestTimestamp);
+    TEST_RUN(TestConcurrentAppend);
+    TEST_RUN(TestSlotWaitsForUsers);
+    TEST_RUN(TestSlotSwapStress);
+    rmdir(testDirectory);
+    return TEST_RESULT();
+}
@@ -0,0 +1,134 @@
+//
+//  FUTrackStateTests.c
+//  tests
+//
+//  检测状态去抖：切换时机、reset 语义，以及处理线程更新时其他线程 reset / 读取状态
+//
+
+#include "FUTrackState.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+static void TestFirstUpdateAlwaysReports(void) {
+    FUTrackState state;
+    FUTrackStateInit(&state, 5);
+    TEST_CHECK(FUTrackStateUpdate(&state, 0));
+    TEST_CHECK(!FUTrackStateIsTracked(&state));
+    TEST_CHECK(!FUTrackStateUpdate(&state, 0));
+
+    FUTrackStateInit(&state, 5);
+    TEST_CHECK(FUTrackStateUpdate(&state, 2));
+    TEST_CHECK(FUTrackStateIsTracked(&state));
+}
+
+static void TestDebounce(void) {
+    FUTrackState state;
+    FUTrackStateInit(&state, 5);
+    FUTrackStateUpdate(&state, 0);
+    // 4 帧检测到后又丢失，不切换
+    for (int i = 0; i < 4; i++) {
+        TEST_CHECK(!FUTrackStateUpdate(&state, 1));
+    }
+    TEST_CHECK(!FUTrackStateUpdate(&state, 0));
+    TEST_CHECK(!FUTrackStateIsTracked(&state));
+    // 连续 5 帧检测到，第 5 帧切换
+    for (int i = 0; i < 4; i++) {
+        TEST_CHECK(!FUTrackStateUpdate(&state, 1));
+    }
+    TEST_CHECK(FUTrackStateUpdate(&state, 1));
+    TEST_CHECK(FUTrackStateIsTracked(&state));
+    // 保持状态不再报告
+    TEST_CHECK(!FUTrackStateUpdate(&state, 3));
+}
+
+static void TestZeroDebounceSwitchesImmediately(void) {
+    FUTrackState state;
+    FUTrackStateInit(&state, 0);
+    FUTrackStateUpdate(&state, 0);
+    TEST_CHECK(FUTrackStateUpdate(&state, 1));
+    TEST_CHECK(FUTrackStateUpdate(&state, 0));
+    FUTrackStateSetDebounceFrames(&state, 2);
+    TEST_CHECK(!FUTrackStateUpdate(&state, 1));
+    TEST_CHECK(FUTrackStateUpdate(&state, 1));
+}
+
+static void TestResetReportsNextFrame(void) {
+    FUTrackState state;
+    FUTrackStateInit(&state, 5);
+    FUTrackStateUpdate(&state, 1);
+    TEST_CHECK(!FUTrackStateUpdate(&state, 1));
+    // 切换检测目标后即使状态相同也报告一次，且不受去抖影响
+    FUTrackStateReset(&state);
+    TEST_CHECK(FUTrackStateUpdate(&state, 1));
+    FUTrackStateReset(&state);
+    TEST_CHECK(FUTrackStateUpdate(&state, 0));
+    TEST_CHECK(!FUTrackStateIsTracked(&state));
+    // reset 清掉了进行中的去抖计数
+    for (int i = 0; i < 3; i++) {
+        FUTrackStateUpdate(&state, 1);
+    }
+    FUTrackStateReset(&state);
+    FUTrackStateUpdate(&state, 0);
+    TEST_CHECK(!FUTrackStateUpdate(&state, 1));
+}
+
+// 并发：处理线程持续 update，主线程 reset 并读取状态
+
+#define CONCURRENT_FRAMES 2000000
+
+typedef struct {
+    FUTrackState *state;
+    _Atomic int resetsIssued;
+    _Atomic bool finished;
+    int reports;
+    int reportsAfterReset;
+} ConcurrentContext;
+
+static void *ProcessingThreadMain(void *argument) {
+    ConcurrentContext *context = argument;
+    for (int i = 0; i < CONCURRENT_FRAMES; i++) {
+        // 每 64 帧状态翻转一次
+        if (FUTrackStateUpdate(context->state, (i / 64) & 1)) {
+            context->reports++;
+        }
+    }
+    atomic_store(&context->finished, true);
+    return NULL;
+}
+
+static void TestConcurrentResetAndRead(void) {
+    FUTrackState state;
+    FUTrackStateInit(&state, 5);
+    ConcurrentContext context = {.state = &state};
+    pthread_t thread;
+    pthread_create(&thread, NULL, ProcessingThreadMain, &context);
+    int trackedReads = 0;
+    for (int i = 0; !atomic_load(&context.finished); i++) {
+        trackedReads += FUTrackStateIsTracked(&state);
+        if (i % 1000 == 0) {
+            FUTrackStateReset(&state);
+            atomic_fetch_add(&context.resetsIssued, 1);
+        }
+        FUTrackStateSetDebounceFrames(&state, (uint32_t)(4 + i % 3));
+    }
+    pthread_join(thread, NULL);
+    // 每次翻转最多报告一次，另外每次 reset 至多多报告一次
+    int flips = CONCURRENT_FRAMES / 64;
+    TEST_CHECK(context.reports >= flips - 1);
+    TEST_CHECK(context.reports <= flips + atomic_load(&context.resetsIssued) + 1);
+    // 最后一段为 (CONCURRENT_FRAMES - 1) / 64 的奇偶
+    TEST_CHECK(FUTrackStateIsTracked(&state) == (((CONCURRENT_FRAMES - 1) / 64) & 1));
+    printf("  reports %d, flips %d, resets %d, tracked reads %d\n", context.reports, flips,
+           atomic_load(&context.resetsIssued), trackedReads);
+}
+
+int main(void) {
+    TEST_RUN(TestFirstUpdateAlwaysReports);
+    TEST_RUN(TestDebounce);
+    TEST_RUN(TestZeroDebounceSwitchesImmediately);
+    TEST_RUN(TestResetReportsNextFrame);
+    TEST_RUN(TestConcurrentResetAndRead);
+    return TEST_RESULT();
+}
@@ -0,0 +1,391 @@
+//
+//  FaceLandmarkCodecTests.c
+//  tests
+//
+//  人脸点位编解码：各量化位数下的往返误差、关键帧间隔与布局变化、记录大小上限、
+//  丢包等待关键帧与重复记录、时间戳回退、插值与时间轴换算，以及截断与随机损坏的记录
+//
+
+#include "FaceLandmarkCodec.h"
+#include "TestSupport.h"
+
+#include <math.h>
+#include <string.h>
+
+static uint32_t testRandomState = 2024;
+
+static uint32_t TestRandom(void) {
+    testRandomState = testRandomState * 1664525u + 1013904223u;
+    return testRandomState >> 8;
+}
+
+static float TestUniform(float low, float high) {
+    return low + (high - low) * (float)(TestRandom() & 0xFFFF) / 65535.0f;
+}
+
+static void RandomFrame(FaceLandmarkFrame *frame, int64_t timestampUs, uint32_t faceCount, uint32_t pointCount) {
+    frame->timestampUs = timestampUs;
+    frame->width = 1280;
+    frame->height = 720;
+    frame->faceCount = faceCount;
+    for (uint32_t f = 0; f < faceCount; f++) {
+        FaceLandmarkFace *face = &frame->faces[f];
+        face->pointCount = pointCount;
+        for (int i = 0; i < 4; i++) {
+            face->rect[i] = TestUniform(0, i % 2 ? 720 : 1280);
+        }
+        for (uint32_t i = 0; i < 2 * pointCount; i++) {
+            face->points[i] = TestUniform(0, i % 2 ? 720 : 1280);
+        }
+    }
+}
+
+/// 每个坐标小幅移动，模拟相邻帧
+static void MoveFrame(FaceLandmarkFrame *frame, int64_t timestampUs, float step) {
+    frame->timestampUs = timestampUs;
+    for (uint32_t f = 0; f < frame->faceCount; f++) {
+        FaceLandmarkFace *face = &frame->faces[f];
+        for (int i = 0; i < 4; i++) {
+            float limit = i % 2 ? 720.0f : 1280.0f;
+            face->rect[i] = fminf(fmaxf(face->rect[i] + TestUniform(-step, step), 0), limit);
+        }
+        for (uint32_t i = 0; i < 2 * face->pointCount; i++) {
+            float limit = i % 2 ? 720.0f : 1280.0f;
+            face->points[i] = fminf(fmaxf(face->points[i] + TestUniform(-step, step), 0), limit);
+        }
+    }
+}
+
+/// 两帧的布局一致时返回最大坐标误差，否则返回无穷大
+static float MaxError(const FaceLandmarkFrame *a, const FaceLandmarkFrame *b) {
+    if (a->faceCount != b->faceCount || a->width != b->width || a->height != b->height ||
+        a->timestampUs != b->timestampUs) {
+        return INFINITY;
+    }
+    float error = 0;
+    for (uint32_t f = 0; f < a->faceCount; f++) {
+        if (a->faces[f].pointCount != b->faces[f].pointCount) {
+            return INFINITY;
+        }
+        for (int i = 0; i < 4; i++) {
+            error = fmaxf(error, fabsf(a->faces[f].rect[i] - b->faces[f].rect[i]));
+        }
+        for (uint32_t i = 0; i < 2 * a->faces[f].pointCount; i++) {
+            error = fmaxf(error, fabsf(a->faces[f].points[i] - b->faces[f].points[i]));
+        }
+    }
+    return error;
+}
+
+static bool IsKeyframeRecord(const uint8_t *record) {
+    return record[1] & 0x01;
+}
+
+static void TestConfig(void) {
+    FaceLandmarkEncoderConfig config = FaceLandmarkEncoderDefaultConfig();
+    TEST_CHECK(config.quantBits == 12 && config.keyframeInterval == 30);
+    TEST_CHECK(!FaceLandmarkEncoderCreate(NULL));
+    config.quantBits = 7;
+    TEST_CHECK(!FaceLandmarkEncoderCreate(&config));
+    config.quantBits = 17;
+    TEST_CHECK(!FaceLandmarkEncoderCreate(&config));
+    config = FaceLandmarkEncoderDefaultConfig();
+    config.keyframeInterval = 0;
+    TEST_CHECK(!FaceLandmarkEncoderCreate(&config));
+    TEST_CHECK(!FaceLandmarkDecoderCreate(1));
+    FaceLandmarkDecoderDestroy(NULL);
+
+    config = FaceLandmarkEncoderDefaultConfig();
+    FaceLandmarkEncoder *encoder = FaceLandmarkEncoderCreate(&config);
+    static FaceLandmarkFrame frame;
+    uint8_t record[FACE_LANDMARK_MAX_RECORD_BYTES];
+    RandomFrame(&frame, 0, 1, 75);
+    frame.width = 0;
+    TEST_CHECK(FaceLandmarkEncoderEncode(encoder, &frame, record, sizeof(record)) == 0);
+    frame.width = 70000;
+    TEST_CHECK(FaceLandmarkEncoderEncode(encoder, &frame, record, sizeof(record)) == 0);
+    frame.width = 1280;
+    frame.faceCount = FACE_LANDMARK_MAX_FACES + 1;
+    TEST_CHECK(FaceLandmarkEncoderEncode(encoder, &frame, record, sizeof(record)) == 0);
+    frame.faceCount = 1;
+    frame.faces[0].pointCount = FACE_LANDMARK_MAX_POINTS + 1;
+    TEST_CHECK(FaceLandmarkEncoderEncode(encoder, &frame, record, sizeof(record)) == 0);
+    TEST_CHECK(FaceLandmarkEncoderEncode(encoder, NULL, record, sizeof(record)) == 0);
+    FaceLandmarkEncoderDestroy(encoder);
+}
+
+/// 各量化位数下往返误差不超过半个量化步长；静止时差分记录只有几个字节；关键帧按间隔出现
+static void TestRoundTrip(void) {
+    static const uint32_t bits[] = {8, 12, 16};
+    for (size_t b = 0; b < sizeof(bits) / sizeof(bits[0]); b++) {
+        FaceLandmarkEncoderConfig config = {.quantBits = bits[b], .keyframeInterval = 10};
+        FaceLandmarkEncoder *encoder = FaceLandmarkEncoderCreate(&config);
+        FaceLandmarkDecoder *decoder = FaceLandmarkDecoderCreate(8);
+        static FaceLandmarkFrame input, output;
+        RandomFrame(&input, 1000000, 2, 75);
+        float step = 1280.0f / (float)((1u << bits[b]) - 1);
+        float worst = 0;
+        size_t keyframeBytes = 0, deltaBytes = 0, maxBytes = 0;
+        int keyframes = 0, mismatchedKeyframes = 0, results = 0;
+        for (int i = 0; i < 200; i++) {
+            if (i > 0) {
+                MoveFrame(&input, input.timestampUs + 33333, i % 50 < 5 ? 0.0f : 3.0f);
+            }
+            uint8_t record[FACE_LANDMARK_MAX_RECORD_BYTES];
+            size_t size = FaceLandmarkEncoderEncode(encoder, &input, record, sizeof(record));
+            maxBytes = size > maxBytes ? size : maxBytes;
+            bool keyframe = IsKeyframeRecord(record);
+            keyframes += keyframe;
+            mismatchedKeyframes += keyframe != (i % 10 == 0);
+            if (keyframe) {
+                keyframeBytes = size;
+            } else if (i % 50 > 0 && i % 50 < 5) {
+                deltaBytes = size;
+            }
+            results += FaceLandmarkDecoderDecode(decoder, record, size, input.timestampUs, &output) !=
+                       FaceLandmarkDecodeOk;
+            worst = fmaxf(worst, MaxError(&input, &output));
+        }
+        TEST_CHECK(results == 0);
+        TEST_CHECK(keyframes == 20 && mismatchedKeyframes == 0);
+        TEST_CHECK(worst <= step * 0.5f + 0.01f);
+        TEST_CHECK(maxBytes <= FACE_LANDMARK_MAX_RECORD_BYTES);
+        // 头 4 字节、时间戳差 3 字节、每张脸 1 字节位宽
+        TEST_CHECK(deltaBytes == 4 + 3 + 2);
+        printf("  %2u bits: max error %.3f px (step %.3f), keyframe %zu bytes, static delta %zu bytes\n", bits[b],
+               worst, step, keyframeBytes, deltaBytes);
+        FaceLandmarkEncoderDestroy(encoder);
+        FaceLandmarkDecoderDestroy(decoder);
+    }
+}
+
+/// 最坏情况（4 张脸、75 点、16 位，差分在 0 与最大值之间跳变）不超过记录上限；空间不足时不改变编码状态
+static void TestRecordLimits(void) {
+    FaceLandmarkEncoderConfig config = {.quantBits = 16, .keyframeInterval = 1000};
+    FaceLandmarkEncoder *encoder = FaceLandmarkEncoderCreate(&config);
+    FaceLandmarkDecoder *decoder = FaceLandmarkDecoderCreate(4);
+    static FaceLandmarkFrame input, output;
+    uint8_t record[FACE_LANDMARK_MAX_RECORD_BYTES];
+    size_t maxBytes = 0;
+    for (int i = 0; i < 6; i++) {
+        RandomFrame(&input, (int64_t)i * 1000000000, FACE_LANDMARK_MAX_FACES, FACE_LANDMARK_MAX_POINTS);
+        for (uint32_t f = 0; f < input.faceCount; f++) {
+            for (int v = 0; v < 4; v++) {
+                input.faces[f].rect[v] = (i + v) % 2 ? 1e9f : -1.0f;
+            }
+            for (uint32_t p = 0; p < 2 * FACE_LANDMARK_MAX_POINTS; p++) {
+                input.faces[f].points[p] = (i + p) % 2 ? 1e9f : -1.0f;
+            }
+        }
+        size_t size = FaceLandmarkEncoderEncode(encoder, &input, record, sizeof(record));
+        TEST_CHECK(size > 0);
+        maxBytes = size > maxBytes ? size : maxBytes;
+        TEST_CHECK(FaceLandmarkDecoderDecode(decoder, record, size, 0, &output) == FaceLandmarkDecodeOk);
+        // 超出范围的坐标被钳到图像边缘
+        TEST_CHECK(output.faces[3].points[(i + 1) % 2] == (((i + 1) % 2) ? 720.0f : 1280.0f) &&
+                   output.faces[3].points[i % 2] == 0.0f);
+    }
+    printf("  worst-case record %zu of %d bytes\n", maxBytes, FACE_LANDMARK_MAX_RECORD_BYTES);
+    TEST_CHECK(maxBytes <= FACE_LANDMARK_MAX_RECORD_BYTES);
+
+    // 空间不足时返回 0，下一条仍能接上之前的参考帧
+    MoveFrame(&input, input.timestampUs + 33333, 0.0f);
+    TEST_CHECK(FaceLandmarkEncoderEncode(encoder, &input, record, 8) == 0);
+    size_t size = FaceLandmarkEncoderEncode(encoder, &input, record, sizeof(record));
+    TEST_CHECK(size > 0 && !IsKeyframeRecord(record));
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, record, size, 0, &output) == FaceLandmarkDecodeOk);
+    FaceLandmarkEncoderDestroy(encoder);
+    FaceLandmarkDecoderDestroy(decoder);
+}
+
+/// 人脸数、点数、尺寸变化与强制关键帧都发关键帧；0 张脸也能往返
+static void TestLayoutChanges(void) {
+    FaceLandmarkEncoderConfig config = FaceLandmarkEncoderDefaultConfig();
+    FaceLandmarkEncoder *encoder = FaceLandmarkEncoderCreate(&config);
+    FaceLandmarkDecoder *decoder = FaceLandmarkDecoderCreate(4);
+    static FaceLandmarkFrame input, output;
+    uint8_t record[FACE_LANDMARK_MAX_RECORD_BYTES];
+    int64_t timestampUs = 0;
+
+    struct {
+        uint32_t faces;
+        uint32_t points;
+        uint32_t width;
+        bool force;
+        bool keyframe;
+    } steps[] = {
+        {1, 75, 1280, false, true},
+        {1, 75, 1280, false, false},
+        {2, 75, 1280, false, true},
+        {2, 0, 1280, false, true},
+        {2, 0, 1280, false, false},
+        {2, 0, 960, false, true},
+        {2, 0, 960, true, true},
+        {0, 0, 960, false, true},
+        {0, 0, 960, false, false},
+        {1, 5, 960, false, true},
+    };
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        RandomFrame(&input, timestampUs += 33333, steps[i].faces, steps[i].points);
+        input.width = steps[i].width;
+        // x 坐标缩放到新的宽度内
+        for (uint32_t f = 0; f < input.faceCount; f++) {
+            input.faces[f].rect[0] *= (float)input.width / 1280.0f;
+            input.faces[f].rect[2] *= (float)input.width / 1280.0f;
+            for (uint32_t p = 0; p < input.faces[f].pointCount; p++) {
+                input.faces[f].points[2 * p] *= (float)input.width / 1280.0f;
+            }
+        }
+        if (steps[i].force) {
+            FaceLandmarkEncoderForceKeyframe(encoder);
+        }
+        size_t size = FaceLandmarkEncoderEncode(encoder, &input, record, sizeof(record));
+        TEST_CHECK(size > 0 && IsKeyframeRecord(record) == steps[i].keyframe);
+        TEST_CHECK(FaceLandmarkDecoderDecode(decoder, record, size, 0, &output) == FaceLandmarkDecodeOk);
+        TEST_CHECK(MaxError(&input, &output) < 1.0f);
+    }
+    FaceLandmarkEncoderDestroy(encoder);
+    FaceLandmarkDecoderDestroy(decoder);
+}
+
+/// 丢失差分记录后等待关键帧；重发的记录被识别为重复；时间戳回退时发关键帧并清空历史
+static void TestLossAndDuplicates(void) {
+    FaceLandmarkEncoderConfig config = {.quantBits = 12, .keyframeInterval = 5};
+    FaceLandmarkEncoder *encoder = FaceLandmarkEncoderCreate(&config);
+    FaceLandmarkDecoder *decoder = FaceLandmarkDecoderCreate(16);
+    static FaceLandmarkFrame input, output;
+    static uint8_t records[12][FACE_LANDMARK_MAX_RECORD_BYTES];
+    size_t sizes[12];
+    RandomFrame(&input, 0, 1, 75);
+    for (int i = 0; i < 12; i++) {
+        if (i > 0) {
+            MoveFrame(&input, input.timestampUs + 33333, 2.0f);
+        }
+        sizes[i] = FaceLandmarkEncoderEncode(encoder, &input, records[i], sizeof(records[i]));
+    }
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[1], sizes[1], 0, NULL) == FaceLandmarkDecodeWaitingKeyframe);
+    TEST_CHECK(!FaceLandmarkDecoderSample(decoder, 0, &output));
+    TEST_CHECK(FaceLandmarkDecoderSenderTimeUs(decoder, 0) == INT64_MIN);
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[0], sizes[0], 0, NULL) == FaceLandmarkDecodeOk);
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[0], sizes[0], 0, NULL) == FaceLandmarkDecodeDuplicate);
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[1], sizes[1], 0, NULL) == FaceLandmarkDecodeOk);
+    // 丢失第 2 条
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[3], sizes[3], 0, NULL) == FaceLandmarkDecodeWaitingKeyframe);
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[4], sizes[4], 0, NULL) == FaceLandmarkDecodeWaitingKeyframe);
+    TEST_CHECK(IsKeyframeRecord(records[5]));
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[5], sizes[5], 0, &output) == FaceLandmarkDecodeOk);
+    TEST_CHECK(output.timestampUs == 5 * 33333);
+    for (int i = 6; i < 12; i++) {
+        TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[i], sizes[i], 0, &output) == FaceLandmarkDecodeOk);
+    }
+    TEST_CHECK(MaxError(&input, &output) < 0.5f);
+
+    // 发送端重新开始：时间戳回退，自动发关键帧，接收端历史只剩新记录
+    RandomFrame(&input, 100, 1, 75);
+    uint8_t record[FACE_LANDMARK_MAX_RECORD_BYTES];
+    size_t size = FaceLandmarkEncoderEncode(encoder, &input, record, sizeof(record));
+    TEST_CHECK(IsKeyframeRecord(record));
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, record, size, 0, &output) == FaceLandmarkDecodeOk);
+    TEST_CHECK(FaceLandmarkDecoderSample(decoder, 1000000, &output) && output.timestampUs == 100);
+
+    FaceLandmarkDecoderReset(decoder);
+    TEST_CHECK(!FaceLandmarkDecoderSample(decoder, 0, &output));
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, records[6], sizes[6], 0, NULL) == FaceLandmarkDecodeWaitingKeyframe);
+    FaceLandmarkEncoderDestroy(encoder);
+    FaceLandmarkDecoderDestroy(decoder);
+}
+
+/// 两条记录之间线性插值，范围外取最近一条；布局不同时不插值；时间轴取传输最快的一条
+static void TestSampleAndClock(void) {
+    FaceLandmarkEncoderConfig config = FaceLandmarkEncoderDefaultConfig();
+    FaceLandmarkEncoder *encoder = FaceLandmarkEncoderCreate(&config);
+    FaceLandmarkDecoder *decoder = FaceLandmarkDecoderCreate(3);
+    static FaceLandmarkFrame frames[4], output;
+    uint8_t record[FACE_LANDMARK_MAX_RECORD_BYTES];
+    int64_t arrivals[4] = {5000, 45000, 70000, 150000};
+    for (int i = 0; i < 4; i++) {
+        RandomFrame(&frames[i], 1000000 + i * 40000, 1, i < 3 ? 75 : 10);
+        size_t size = FaceLandmarkEncoderEncode(encoder, &frames[i], record, sizeof(record));
+        TEST_CHECK(FaceLandmarkDecoderDecode(decoder, record, size, arrivals[i], &frames[i]) == FaceLandmarkDecodeOk);
+    }
+    // 历史只保留最近 3 条：第 1、2、3 条
+    TEST_CHECK(FaceLandmarkDecoderSample(decoder, 0, &output) && output.timestampUs == frames[1].timestampUs);
+    TEST_CHECK(FaceLandmarkDecoderSample(decoder, 1060000, &output));
+    float expected = (frames[1].faces[0].points[10] + frames[2].faces[0].points[10]) * 0.5f;
+    TEST_CHECK(output.timestampUs == 1060000 && fabsf(output.faces[0].points[10] - expected) < 1e-3f);
+    expected = frames[1].faces[0].rect[2] + (frames[2].faces[0].rect[2] - frames[1].faces[0].rect[2]) * 0.25f;
+    TEST_CHECK(FaceLandmarkDecoderSample(decoder, 1050000, &output) && fabsf(output.faces[0].rect[2] - expected) < 1e-3f);
+    // 第 2、3 条点数不同，取之前的一条
+    TEST_CHECK(FaceLandmarkDecoderSample(decoder, 1100000, &output) && output.timestampUs == frames[2].timestampUs &&
+               output.faces[0].pointCount == 75);
+    TEST_CHECK(FaceLandmarkDecoderSample(decoder, 9000000, &output) && output.timestampUs == frames[3].timestampUs);
+
+    // 到达与时间戳之差：45000-1040000、70000-1080000、150000-1120000，最小的是第 2 条
+    TEST_CHECK(FaceLandmarkDecoderSenderTimeUs(decoder, 0) == 1010000);
+    FaceLandmarkEncoderDestroy(encoder);
+    FaceLandmarkDecoderDestroy(decoder);
+}
+
+/// 截断与随机改写的记录只会被拒绝或解出范围内的坐标，不会越界读写
+static void TestCorruptRecords(void) {
+    FaceLandmarkEncoderConfig config = {.quantBits = 10, .keyframeInterval = 4};
+    FaceLandmarkEncoder *encoder = FaceLandmarkEncoderCreate(&config);
+    FaceLandmarkDecoder *decoder = FaceLandmarkDecoderCreate(4);
+    static FaceLandmarkFrame input, output;
+    static uint8_t records[8][FACE_LANDMARK_MAX_RECORD_BYTES];
+    size_t sizes[8];
+    RandomFrame(&input, 0, 3, 40);
+    for (int i = 0; i < 8; i++) {
+        MoveFrame(&input, input.timestampUs + 33333, 20.0f);
+        sizes[i] = FaceLandmarkEncoderEncode(encoder, &input, records[i], sizeof(records[i]));
+    }
+    TEST_CHECK(FaceLandmarkDecoderDecode(decoder, NULL, 0, 0, NULL) == FaceLandmarkDecodeInvalid);
+    int truncatedAccepted = 0;
+    for (size_t cut = 0; cut < sizes[0]; cut++) {
+        FaceLandmarkDecoderReset(decoder);
+        truncatedAccepted += FaceLandmarkDecoderDecode(decoder, records[0], cut, 0, NULL) == FaceLandmarkDecodeOk;
+    }
+    TEST_CHECK(truncatedAccepted == 0);
+
+    int outOfRange = 0;
+    int accepted = 0;
+    uint8_t mutated[FACE_LANDMARK_MAX_RECORD_BYTES];
+    for (int round = 0; round < 20000; round++) {
+        int index = round % 8;
+        memcpy(mutated, records[index], sizes[index]);
+        int flips = 1 + TestRandom() % 4;
+        for (int i = 0; i < flips; i++) {
+            mutated[TestRandom() % sizes[index]] ^= (uint8_t)(1 + TestRandom() % 255);
+        }
+        size_t size = sizes[index] - (TestRandom() % 4 == 0 ? TestRandom() % sizes[index] : 0);
+        if (index == 0) {
+            FaceLandmarkDecoderReset(decoder);
+            FaceLandmarkDecoderDecode(decoder, records[0], sizes[0], 0, NULL);
+        }
+        if (FaceLandmarkDecoderDecode(decoder, mutated, size, 0, &output) != FaceLandmarkDecodeOk) {
+            continue;
+        }
+        accepted++;
+        for (uint32_t f = 0; f < output.faceCount; f++) {
+            for (uint32_t i = 0; i < 2 * output.faces[f].pointCount; i++) {
+                float limit = (float)(i % 2 ? output.height : output.width);
+                outOfRange += !(output.faces[f].points[i] >= 0 && output.faces[f].points[i] <= limit);
+            }
+        }
+    }
+    TEST_CHECK(outOfRange == 0);
+    printf("  %d of 20000 corrupted records decoded\n", accepted);
+    FaceLandmarkEncoderDestroy(encoder);
+    FaceLandmarkDecoderDestroy(decoder);
+}
+
+int main(void) {
+    TEST_RUN(TestConfig);
+    TEST_RUN(TestRoundTrip);
+    TEST_RUN(TestRecordLimits);
+    TEST_RUN(TestLayoutChanges);
+    TEST_RUN(TestLossAndDuplicates);
+    TEST_RUN(TestSampleAndClock);
+    TEST_RUN(TestCorruptRecords);
+    return TEST_RESULT();
+}
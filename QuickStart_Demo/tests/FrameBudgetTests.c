@@ -0,0 +1,304 @@
+//
+//  FrameBudgetTests.c
+//  tests
+//
+//  帧耗时预算控制：策略单元测试，以及耗时序列回放仿真
+//
+//  用法：FrameBudgetTests                 运行单元测试与内置场景
+//        FrameBudgetTests <trace>...      回放录制的耗时序列（每行一个完整效果下的每帧耗时，毫秒；# 开头为注释）
+//
+
+#include "FrameBudget.h"
+#include "TestSupport.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 策略
+
+static void TestInitRejectsInvalidConfig(void) {
+    FrameBudget budget;
+    FrameBudgetConfig config = FrameBudgetDefaultConfig(30);
+    TEST_CHECK(FrameBudgetInit(&budget, &config));
+    TEST_CHECK(fabs(budget.config.budgetMs - 1000.0 / 30) < 1e-9);
+    FrameBudgetConfig invalid = config;
+    invalid.stepUpRatio = invalid.stepDownRatio;
+    TEST_CHECK(!FrameBudgetInit(&budget, &invalid));
+    invalid = config;
+    invalid.smoothingFactor = 0;
+    TEST_CHECK(!FrameBudgetInit(&budget, &invalid));
+    invalid = config;
+    invalid.stepDownFrames = 0;
+    TEST_CHECK(!FrameBudgetInit(&budget, &invalid));
+}
+
+static void TestStepsDownAfterConsecutiveOverBudgetFrames(void) {
+    FrameBudget budget;
+    FrameBudgetConfig config = FrameBudgetDefaultConfig(30);
+    FrameBudgetInit(&budget, &config);
+    for (uint32_t i = 1; i < config.stepDownFrames; i++) {
+        TEST_CHECK(!FrameBudgetRecord(&budget, 50));
+    }
+    TEST_CHECK(FrameBudgetRecord(&budget, 50));
+    TEST_CHECK(budget.level == FrameBudgetLevelReducedQuality);
+    // 切档后重新累计
+    for (uint32_t i = 1; i < config.stepDownFrames; i++) {
+        FrameBudgetRecord(&budget, 50);
+    }
+    TEST_CHECK(budget.level == FrameBudgetLevelReducedQuality);
+    FrameBudgetRecord(&budget, 50);
+    TEST_CHECK(budget.level == FrameBudgetLevelLowQuality);
+    // 不超过 maxLevel
+    for (int i = 0; i < 200; i++) {
+        FrameBudgetRecord(&budget, 50);
+    }
+    TEST_CHECK(budget.level == FrameBudgetLevelSparseTracking);
+    TEST_CHECK(budget.levelChanges == 3);
+}
+
+static void TestHysteresisBandHoldsLevel(void) {
+    FrameBudget budget;
+    FrameBudgetConfig config = FrameBudgetDefaultConfig(30);
+    FrameBudgetInit(&budget, &config);
+    for (int i = 0; i < 15; i++) {
+        FrameBudgetRecord(&budget, 50);
+    }
+    TEST_CHECK(budget.level == FrameBudgetLevelReducedQuality);
+    // 预算的 60% ~ 90% 之间既不降档也不升档
+    for (int i = 0; i < 2000; i++) {
+        FrameBudgetRecord(&budget, config.budgetMs * 0.75);
+    }
+    TEST_CHECK(budget.level == FrameBudgetLevelReducedQuality);
+}
+
+static void TestStepsUpSlowerThanDown(void) {
+    FrameBudget budget;
+    FrameBudgetConfig config = FrameBudgetDefaultConfig(30);
+    FrameBudgetInit(&budget, &config);
+    for (int i = 0; i < 15; i++) {
+        FrameBudgetRecord(&budget, 50);
+    }
+    TEST_CHECK(budget.level == FrameBudgetLevelReducedQuality);
+    // 平滑值先要降到阈值以下，之后还需连续 stepUpFrames 帧
+    int frames = 0;
+    while (budget.level != FrameBudgetLevelFull && frames < 1000) {
+        FrameBudgetRecord(&budget, 5);
+        frames++;
+    }
+    TEST_CHECK(budget.level == FrameBudgetLevelFull);
+    TEST_CHECK(frames >= (int)config.stepUpFrames);
+    TEST_CHECK(frames < (int)config.stepUpFrames + 30);
+}
+
+static void TestResetReturnsToFull(void) {
+    FrameBudget budget;
+    FrameBudgetConfig config = FrameBudgetDefaultConfig(30);
+    config.maxLevel = FrameBudgetLevelLowQuality;
+    FrameBudgetInit(&budget, &config);
+    for (int i = 0; i < 200; i++) {
+        FrameBudgetRecord(&budget, 50);
+    }
+    TEST_CHECK(budget.level == FrameBudgetLevelLowQuality);
+    TEST_CHECK(FrameBudgetReset(&budget));
+    TEST_CHECK(budget.level == FrameBudgetLevelFull);
+    TEST_CHECK(budget.smoothedCostMs == 0);
+    TEST_CHECK(!FrameBudgetReset(&budget));
+    // 重置后第一帧直接作为平滑值，不受旧效果耗时影响
+    FrameBudgetRecord(&budget, 10);
+    TEST_CHECK(budget.smoothedCostMs == 10);
+}
+
+static void TestLevelActions(void) {
+    TEST_CHECK(FrameBudgetDetectInterval(FrameBudgetLevelFull, 7) == 7);
+    TEST_CHECK(FrameBudgetDetectInterval(FrameBudgetLevelLowQuality, 7) == 7);
+    TEST_CHECK(FrameBudgetDetectInterval(FrameBudgetLevelSparseTracking, 7) == 14);
+    TEST_CHECK(!FrameBudgetUsesAsyncTracking(FrameBudgetLevelLowQuality));
+    TEST_CHECK(FrameBudgetUsesAsyncTracking(FrameBudgetLevelSparseTracking));
+}
+
+// 耗时序列回放
+
+/// 各档位相对完整效果的耗时比例（仿真模型：动态质量 1.0/0.6/0.3 与异步跟踪的大致收益）
+static const double levelCostScale[FRAME_BUDGET_LEVEL_COUNT] = {1.0, 0.8, 0.65, 0.5};
+
+typedef struct {
+    uint64_t frames;
+    uint64_t overBudgetUngoverned;
+    uint64_t overBudgetGoverned;
+    uint64_t levelChanges;
+    FrameBudgetLevel finalLevel;
+    FrameBudgetLevel peakLevel;
+    uint64_t framesAtLevel[FRAME_BUDGET_LEVEL_COUNT];
+} SimulationResult;
+
+/// 按当前档位缩放完整效果下的耗时后交给控制器，统计超出预算（会导致编码丢帧）的帧数
+static SimulationResult Simulate(const double *fullCosts, size_t count, int frameRate) {
+    SimulationResult result = {0};
+    FrameBudget budget;
+    FrameBudgetConfig config = FrameBudgetDefaultConfig(frameRate);
+    FrameBudgetInit(&budget, &config);
+    for (size_t i = 0; i < count; i++) {
+        double cost = fullCosts[i] * levelCostScale[budget.level];
+        result.overBudgetUngoverned += fullCosts[i] > config.budgetMs;
+        result.overBudgetGoverned += cost > config.budgetMs;
+        FrameBudgetRecord(&budget, cost);
+        if (budget.level > result.peakLevel) {
+            result.peakLevel = budget.level;
+        }
+    }
+    result.frames = count;
+    result.levelChanges = budget.levelChanges;
+    result.finalLevel = budget.level;
+    memcpy(result.framesAtLevel, budget.framesAtLevel, sizeof(result.framesAtLevel));
+    return result;
+}
+
+static void PrintSimulation(const char *name, const SimulationResult *result) {
+    printf("  %-18s frames %5llu  over budget %5.1f%% -> %5.1f%%  level changes %llu  peak %d  final %d  at level [%llu %llu %llu %llu]\n",
+           name, (unsigned long long)result->frames,
+           100.0 * (double)result->overBudgetUngoverned / (double)result->frames,
+           100.0 * (double)result->overBudgetGoverned / (double)result->frames,
+           (unsigned long long)result->levelChanges, result->peakLevel, result->finalLevel,
+           (unsigned long long)result->framesAtLevel[0], (unsigned long long)result->framesAtLevel[1],
+           (unsigned long long)result->framesAtLevel[2], (unsigned long long)result->framesAtLevel[3]);
+}
+
+/// 确定性噪声，[-1, 1)
+static double Noise(unsigned *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (double)((*seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+}
+
+/// 分段生成耗时序列：每段 frames 帧，均值 meanMs，噪声幅度 jitterMs，偶发 spikeMs 尖峰
+typedef struct {
+    size_t frames;
+    double meanMs;
+    double jitterMs;
+    double spikeMs;
+} TraceSegment;
+
+static double *BuildTrace(const TraceSegment *segments, size_t segmentCount, size_t *count) {
+    size_t total = 0;
+    for (size_t i = 0; i < segmentCount; i++) {
+        total += segments[i].frames;
+    }
+    double *costs = malloc(total * sizeof(double));
+    unsigned seed = 2024;
+    size_t index = 0;
+    for (size_t i = 0; i < segmentCount; i++) {
+        for (size_t f = 0; f < segments[i].frames; f++) {
+            double cost = segments[i].meanMs + segments[i].jitterMs * Noise(&seed);
+            if (segments[i].spikeMs > 0 && f % 97 == 0) {
+                cost += segments[i].spikeMs;
+            }
+            costs[index++] = cost > 0 ? cost : 0.1;
+        }
+    }
+    *count = total;
+    return costs;
+}
+
+static void TestLightEffectStaysFull(void) {
+    TraceSegment segments[] = {{3000, 18, 3, 12}};
+    size_t count = 0;
+    double *costs = BuildTrace(segments, 1, &count);
+    SimulationResult result = Simulate(costs, count, 30);
+    PrintSimulation("light beauty", &result);
+    // 偶发尖峰不应触发降档
+    TEST_CHECK(result.levelChanges == 0);
+    free(costs);
+}
+
+static void TestHeavyMakeupBurstStepsDownAndRecovers(void) {
+    // 20ms 美颜 -> 切到重妆 40ms -> 切回
+    TraceSegment segments[] = {{300, 20, 3, 0}, {900, 40, 5, 15}, {900, 20, 3, 0}};
+    size_t count = 0;
+    double *costs = BuildTrace(segments, 3, &count);
+    SimulationResult result = Simulate(costs, count, 30);
+    PrintSimulation("heavy makeup burst", &result);
+    TEST_CHECK(result.peakLevel >= FrameBudgetLevelLowQuality);
+    TEST_CHECK(result.overBudgetGoverned * 4 < result.overBudgetUngoverned);
+    TEST_CHECK(result.finalLevel == FrameBudgetLevelFull);
+    free(costs);
+}
+
+static void TestSustainedBodySlimDoesNotOscillate(void) {
+    TraceSegment segments[] = {{3000, 38, 8, 20}};
+    size_t count = 0;
+    double *costs = BuildTrace(segments, 1, &count);
+    SimulationResult result = Simulate(costs, count, 30);
+    PrintSimulation("sustained body-slim", &result);
+    TEST_CHECK(result.peakLevel >= FrameBudgetLevelLowQuality);
+    TEST_CHECK(result.overBudgetGoverned * 4 < result.overBudgetUngoverned);
+    // 稳定负载下升档后又降档的来回切换不超过几次
+    TEST_CHECK(result.levelChanges <= 6);
+    free(costs);
+}
+
+static void TestNearThresholdNoiseHolds(void) {
+    TraceSegment segments[] = {{3000, 25, 6, 0}};
+    size_t count = 0;
+    double *costs = BuildTrace(segments, 1, &count);
+    SimulationResult result = Simulate(costs, count, 30);
+    PrintSimulation("near threshold", &result);
+    TEST_CHECK(result.levelChanges <= 2);
+    free(costs);
+}
+
+static double *ReadTrace(const char *path, size_t *count) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return NULL;
+    }
+    size_t capacity = 1024;
+    double *costs = malloc(capacity * sizeof(double));
+    char line[128];
+    *count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') {
+            continue;
+        }
+        char *end = NULL;
+        double cost = strtod(line, &end);
+        if (end == line) {
+            continue;
+        }
+        if (*count == capacity) {
+            capacity *= 2;
+            costs = realloc(costs, capacity * sizeof(double));
+        }
+        costs[(*count)++] = cost;
+    }
+    fclose(file);
+    return costs;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            size_t count = 0;
+            double *costs = ReadTrace(argv[i], &count);
+            if (!costs || count == 0) {
+                fprintf(stderr, "cannot read trace %s\n", argv[i]);
+                free(costs);
+                return 1;
+            }
+            SimulationResult result = Simulate(costs, count, 30);
+            PrintSimulation(argv[i], &result);
+            free(costs);
+        }
+        return 0;
+    }
+    TEST_RUN(TestInitRejectsInvalidConfig);
+    TEST_RUN(TestStepsDownAfterConsecutiveOverBudgetFrames);
+    TEST_RUN(TestHysteresisBandHoldsLevel);
+    TEST_RUN(TestStepsUpSlowerThanDown);
+    TEST_RUN(TestResetReturnsToFull);
+    TEST_RUN(TestLevelActions);
+    TEST_RUN(TestLightEffectStaysFull);
+    TEST_RUN(TestHeavyMakeupBurstStepsDownAndRecovers);
+    TEST_RUN(TestSustainedBodySlimDoesNotOscillate);
+    TEST_RUN(TestNearThresholdNoiseHolds);
+    return TEST_RESULT();
+}
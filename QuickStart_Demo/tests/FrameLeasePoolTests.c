@@ -0,0 +1,413 @@
+//
+//  FrameLeasePoolTests.c
+//  tests
+//
+//  零拷贝输出帧租借表：基本语义、渲染前的渲染器校验，以及桩 IVideoFrame 流水线下的每帧分配次数与常驻内存
+//
+
+#include "FrameLeasePool.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 基本语义
+
+typedef struct {
+    int deleted;
+    void *lastBuffer;
+} DeleterRecord;
+
+static void RecordDeleter(void *context, void *buffer) {
+    DeleterRecord *record = context;
+    record->deleted++;
+    record->lastBuffer = buffer;
+}
+
+static void TestCreateRejectsInvalidArguments(void) {
+    DeleterRecord record = {0};
+    TEST_CHECK(FrameLeasePoolCreate(0, RecordDeleter, &record) == NULL);
+    TEST_CHECK(FrameLeasePoolCreate(FRAME_LEASE_POOL_MAX_CAPACITY + 1, RecordDeleter, &record) == NULL);
+    TEST_CHECK(FrameLeasePoolCreate(4, NULL, &record) == NULL);
+}
+
+static void TestLeaseAndReturn(void) {
+    DeleterRecord record = {0};
+    FrameLeasePool *pool = FrameLeasePoolCreate(2, RecordDeleter, &record);
+    int a = 0;
+    int b = 0;
+    int32_t leaseA = FrameLeasePoolLease(pool, &a);
+    int32_t leaseB = FrameLeasePoolLease(pool, &b);
+    TEST_CHECK(leaseA >= 0 && leaseB >= 0 && leaseA != leaseB);
+    TEST_CHECK(!FrameLeasePoolHasFreeLease(pool));
+    TEST_CHECK(FrameLeasePoolLease(pool, NULL) == -1);
+
+    FrameLeasePoolReturn(pool, leaseA);
+    TEST_CHECK(record.deleted == 1 && record.lastBuffer == &a);
+    TEST_CHECK(FrameLeasePoolHasFreeLease(pool));
+    // 重复归还与越界编号被忽略
+    FrameLeasePoolReturn(pool, leaseA);
+    FrameLeasePoolReturn(pool, 7);
+    FrameLeasePoolReturn(pool, -1);
+    TEST_CHECK(record.deleted == 1);
+
+    FrameLeasePoolStats stats;
+    FrameLeasePoolGetStats(pool, &stats);
+    TEST_CHECK(stats.leasedFrames == 2);
+    TEST_CHECK(stats.returnedFrames == 1);
+    TEST_CHECK(stats.inFlight == 1);
+    TEST_CHECK(stats.peakInFlight == 2);
+    TEST_CHECK(stats.distinctBuffers == 2);
+    FrameLeasePoolReturn(pool, leaseB);
+    FrameLeasePoolDestroy(pool);
+}
+
+static void TestExhaustedAndReused(void) {
+    DeleterRecord record = {0};
+    FrameLeasePool *pool = FrameLeasePoolCreate(2, RecordDeleter, &record);
+    int buffers[3];
+    int32_t lease0 = FrameLeasePoolLease(pool, &buffers[0]);
+    TEST_CHECK(lease0 >= 0);
+    // SDK 仍持有 buffers[0]，渲染器再次交回同一块 buffer
+    TEST_CHECK(FrameLeasePoolLease(pool, &buffers[0]) == -1);
+    int32_t lease1 = FrameLeasePoolLease(pool, &buffers[1]);
+    TEST_CHECK(lease1 >= 0);
+    TEST_CHECK(FrameLeasePoolLease(pool, &buffers[2]) == -1);
+
+    FrameLeasePoolStats stats;
+    FrameLeasePoolGetStats(pool, &stats);
+    TEST_CHECK(stats.reusedBuffers == 1);
+    TEST_CHECK(stats.exhaustedFrames == 1);
+    TEST_CHECK(stats.leasedFrames == 2);
+    TEST_CHECK(record.deleted == 0);
+
+    // 归还后同一块 buffer 可以再次租借，不计入新 buffer
+    FrameLeasePoolReturn(pool, lease0);
+    TEST_CHECK(FrameLeasePoolLease(pool, &buffers[0]) >= 0);
+    FrameLeasePoolGetStats(pool, &stats);
+    TEST_CHECK(stats.distinctBuffers == 2);
+
+    FrameLeasePoolResetDistinct(pool);
+    FrameLeasePoolReturn(pool, lease1);
+    lease1 = FrameLeasePoolLease(pool, &buffers[1]);
+    TEST_CHECK(lease1 >= 0);
+    FrameLeasePoolGetStats(pool, &stats);
+    TEST_CHECK(stats.distinctBuffers == 3);
+    FrameLeasePoolReturn(pool, 0);
+    FrameLeasePoolReturn(pool, 1);
+    TEST_CHECK(record.deleted == 4);
+    FrameLeasePoolDestroy(pool);
+}
+
+static void TestDestroyWhileLeased(void) {
+    DeleterRecord record = {0};
+    FrameLeasePool *pool = FrameLeasePoolCreate(4, RecordDeleter, &record);
+    int a = 0;
+    int b = 0;
+    int32_t leaseA = FrameLeasePoolLease(pool, &a);
+    int32_t leaseB = FrameLeasePoolLease(pool, &b);
+    // 离开房间时 SDK 可能还持有输出帧，销毁后归还仍需释放 buffer
+    FrameLeasePoolDestroy(pool);
+    FrameLeasePoolReturn(pool, leaseB);
+    TEST_CHECK(record.deleted == 1 && record.lastBuffer == &b);
+    FrameLeasePoolReturn(pool, leaseA);
+    TEST_CHECK(record.deleted == 2 && record.lastBuffer == &a);
+}
+
+/// 校验渲染器：持有 capacity 块时仍交出新 buffer 才零拷贝，复用持有中的 buffer 则只原地渲染
+static void TestProbeRenderer(void) {
+    DeleterRecord record = {0};
+    FrameLeasePool *pool = FrameLeasePoolCreate(2, RecordDeleter, &record);
+    int buffers[3];
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetProbe);
+    FrameLeasePoolProbe(pool, NULL);
+    FrameLeasePoolProbe(pool, &buffers[0]);
+    FrameLeasePoolProbe(pool, &buffers[1]);
+    TEST_CHECK(record.deleted == 0);
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetProbe);
+    FrameLeasePoolProbe(pool, &buffers[2]);
+    // 校验通过，持有的 buffer 全部释放
+    TEST_CHECK(record.deleted == 3);
+    TEST_CHECK(FrameLeasePoolZeroCopyAvailable(pool));
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetLease);
+    int32_t lease0 = FrameLeasePoolLease(pool, &buffers[0]);
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetLease);
+    int32_t lease1 = FrameLeasePoolLease(pool, &buffers[1]);
+    // 租借已满，渲染前就决定原地渲染
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetInPlace);
+    FrameLeasePoolReturn(pool, lease0);
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetLease);
+    FrameLeasePoolStats stats;
+    FrameLeasePoolGetStats(pool, &stats);
+    TEST_CHECK(stats.probedFrames == 4 && stats.exhaustedFrames == 1);
+    // 校验通过后仍发现复用：不再零拷贝
+    TEST_CHECK(FrameLeasePoolLease(pool, &buffers[1]) == -1);
+    TEST_CHECK(!FrameLeasePoolZeroCopyAvailable(pool));
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetInPlace);
+    FrameLeasePoolReturn(pool, lease1);
+    // 重置后重新校验
+    FrameLeasePoolResetDistinct(pool);
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetProbe);
+    FrameLeasePoolDestroy(pool);
+
+    // 渲染器复用持有中的 buffer
+    record = (DeleterRecord){0};
+    pool = FrameLeasePoolCreate(2, RecordDeleter, &record);
+    FrameLeasePoolProbe(pool, &buffers[0]);
+    FrameLeasePoolProbe(pool, &buffers[0]);
+    TEST_CHECK(record.deleted == 2);
+    TEST_CHECK(!FrameLeasePoolZeroCopyAvailable(pool));
+    TEST_CHECK(FrameLeasePoolBeginFrame(pool) == FrameLeaseTargetInPlace);
+    FrameLeasePoolResetDistinct(pool);
+    TEST_CHECK(FrameLeasePoolZeroCopyAvailable(pool));
+    // 校验中销毁，持有的 buffer 随之释放
+    FrameLeasePoolProbe(pool, &buffers[1]);
+    FrameLeasePoolDestroy(pool);
+    TEST_CHECK(record.deleted == 3 && record.lastBuffer == &buffers[1]);
+}
+
+// 桩 IVideoFrame 流水线
+
+#define STUB_WIDTH 640
+#define STUB_HEIGHT 360
+#define STUB_FRAME_BYTES (STUB_WIDTH * STUB_HEIGHT * 3 / 2)
+#define STUB_LEASE_CAPACITY 4
+#define STUB_SDK_MAX_HELD 3
+#define STUB_FRAMES 20000
+#define STUB_WARMUP_FRAMES 2000
+
+/// 渲染器输出 buffer，模拟 CVPixelBuffer：引用计数归零后回到渲染器的池中
+typedef struct StubBuffer {
+    _Atomic int references;
+    struct StubBuffer *nextFree;
+    uint8_t *planes;
+} StubBuffer;
+
+/// 模拟 FURenderKit 的输出 buffer 池，空时分配新 buffer
+typedef struct {
+    pthread_mutex_t lock;
+    StubBuffer *freeList;
+    _Atomic int allocatedBuffers;
+} StubRenderer;
+
+/// 模拟 VideoFrameBuilder 构造的 IVideoFrame：SDK 释放帧时调用 memory_deleter
+typedef struct {
+    const uint8_t *planes[3];
+    int strides[3];
+    int width;
+    int height;
+    int64_t timestampUs;
+    void (*memoryDeleter)(void *userOpaque);
+    void *userOpaque;
+} StubVideoFrame;
+
+/// 模拟 SDK：编码线程乱序释放所持有的帧
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    StubVideoFrame *queue[STUB_LEASE_CAPACITY];
+    int queued;
+    bool finished;
+} StubSDK;
+
+typedef struct {
+    FrameLeasePool *pool;
+    int32_t lease;
+} StubLeaseRef;
+
+static StubRenderer stubRenderer;
+static StubSDK stubSDK;
+static StubVideoFrame stubFrames[STUB_LEASE_CAPACITY];
+static StubLeaseRef stubLeaseRefs[STUB_LEASE_CAPACITY];
+
+static void StubBufferRelease(StubBuffer *buffer) {
+    if (atomic_fetch_sub(&buffer->references, 1) != 1) {
+        return;
+    }
+    pthread_mutex_lock(&stubRenderer.lock);
+    buffer->nextFree = stubRenderer.freeList;
+    stubRenderer.freeList = buffer;
+    pthread_mutex_unlock(&stubRenderer.lock);
+}
+
+/// 取出一块输出 buffer 并写入渲染结果，返回时渲染器持有一个引用
+static StubBuffer *StubRendererRender(uint8_t value) {
+    pthread_mutex_lock(&stubRenderer.lock);
+    StubBuffer *buffer = stubRenderer.freeList;
+    if (buffer) {
+        stubRenderer.freeList = buffer->nextFree;
+    }
+    pthread_mutex_unlock(&stubRenderer.lock);
+    if (!buffer) {
+        buffer = calloc(1, sizeof(StubBuffer));
+        buffer->planes = malloc(STUB_FRAME_BYTES);
+        atomic_fetch_add(&stubRenderer.allocatedBuffers, 1);
+    }
+    atomic_store(&buffer->references, 1);
+    memset(buffer->planes, value, STUB_FRAME_BYTES);
+    return buffer;
+}
+
+static void StubLeaseDeleter(void *context, void *buffer) {
+    StubBufferRelease(buffer);
+}
+
+static void StubFrameMemoryDeleter(void *userOpaque) {
+    StubLeaseRef *ref = userOpaque;
+    FrameLeasePoolReturn(ref->pool, ref->lease);
+}
+
+static void *StubSDKThread(void *argument) {
+    unsigned seed = 12345;
+    pthread_mutex_lock(&stubSDK.lock);
+    while (!stubSDK.finished || stubSDK.queued > 0) {
+        // 持有 1 ~ STUB_SDK_MAX_HELD 帧后再释放，模拟编码与发送的排队
+        int hold = 1 + (int)(rand_r(&seed) % STUB_SDK_MAX_HELD);
+        if (stubSDK.queued < hold && !stubSDK.finished) {
+            pthread_cond_wait(&stubSDK.changed, &stubSDK.lock);
+            continue;
+        }
+        int index = (int)(rand_r(&seed) % (unsigned)stubSDK.queued);
+        StubVideoFrame *frame = stubSDK.queue[index];
+        stubSDK.queue[index] = stubSDK.queue[--stubSDK.queued];
+        pthread_mutex_unlock(&stubSDK.lock);
+        // 读一下像素，确认 SDK 持有期间 buffer 未被改写
+        uint8_t expected = (uint8_t)(frame->timestampUs & 0xff);
+        if (frame->planes[0][0] != expected || frame->planes[2][STUB_WIDTH * STUB_HEIGHT / 4 - 1] != expected) {
+            fprintf(stderr, "frame %lld overwritten while held by SDK\n", (long long)frame->timestampUs);
+            abort();
+        }
+        frame->memoryDeleter(frame->userOpaque);
+        pthread_mutex_lock(&stubSDK.lock);
+        pthread_cond_broadcast(&stubSDK.changed);
+    }
+    pthread_mutex_unlock(&stubSDK.lock);
+    return NULL;
+}
+
+/// 把输出帧交给 SDK，队列长度不会超过租借容量
+static void StubSDKPush(StubVideoFrame *frame) {
+    pthread_mutex_lock(&stubSDK.lock);
+    stubSDK.queue[stubSDK.queued++] = frame;
+    pthread_cond_broadcast(&stubSDK.changed);
+    pthread_mutex_unlock(&stubSDK.lock);
+}
+
+static void TestStubPipelineAllocations(void) {
+    memset(&stubSDK, 0, sizeof(stubSDK));
+    memset(&stubRenderer, 0, sizeof(stubRenderer));
+    pthread_mutex_init(&stubRenderer.lock, NULL);
+    pthread_mutex_init(&stubSDK.lock, NULL);
+    pthread_cond_init(&stubSDK.changed, NULL);
+    FrameLeasePool *pool = FrameLeasePoolCreate(STUB_LEASE_CAPACITY, StubLeaseDeleter, NULL);
+    pthread_t sdkThread;
+    pthread_create(&sdkThread, NULL, StubSDKThread, NULL);
+
+    uint64_t warmAllocs = 0;
+    long warmResidentKB = 0;
+    uint64_t fallbackFrames = 0;
+    uint64_t renders = 0;
+    uint64_t leaseNs = 0;
+    for (int64_t frameIndex = 0; frameIndex < STUB_FRAMES; frameIndex++) {
+        if (frameIndex == STUB_WARMUP_FRAMES) {
+            warmAllocs = TestAllocCount();
+            warmResidentKB = TestResidentKB();
+        }
+        FrameLeaseTarget target = FrameLeasePoolBeginFrame(pool);
+        if (target == FrameLeaseTargetInPlace) {
+            // SDK 持有的输出帧已满，真实流程在渲染前就决定在采集帧上原地渲染
+            fallbackFrames++;
+            sched_yield();
+            continue;
+        }
+        StubBuffer *buffer = StubRendererRender((uint8_t)(frameIndex & 0xff));
+        renders++;
+        atomic_fetch_add(&buffer->references, 1);
+        if (target == FrameLeaseTargetProbe) {
+            // 校验期间真实流程把渲染结果回写采集帧，输出 buffer 只交给租借表持有
+            FrameLeasePoolProbe(pool, buffer);
+            StubBufferRelease(buffer);
+            continue;
+        }
+        uint64_t leaseStart = TestNowNs();
+        int32_t lease = FrameLeasePoolLease(pool, buffer);
+        leaseNs += TestNowNs() - leaseStart;
+        // 渲染器交出 buffer 后释放自己的引用，只剩租借表持有
+        StubBufferRelease(buffer);
+        if (lease < 0) {
+            StubBufferRelease(buffer);
+            fallbackFrames++;
+            continue;
+        }
+        // 租借编号在租借期间唯一，帧对象按编号复用，不逐帧分配
+        StubVideoFrame *frame = &stubFrames[lease];
+        stubLeaseRefs[lease] = (StubLeaseRef){.pool = pool, .lease = lease};
+        frame->planes[0] = buffer->planes;
+        frame->planes[1] = buffer->planes + STUB_WIDTH * STUB_HEIGHT;
+        frame->planes[2] = buffer->planes + STUB_WIDTH * STUB_HEIGHT * 5 / 4;
+        frame->strides[0] = STUB_WIDTH;
+        frame->strides[1] = STUB_WIDTH / 2;
+        frame->strides[2] = STUB_WIDTH / 2;
+        frame->width = STUB_WIDTH;
+        frame->height = STUB_HEIGHT;
+        frame->timestampUs = frameIndex;
+        frame->memoryDeleter = StubFrameMemoryDeleter;
+        frame->userOpaque = &stubLeaseRefs[lease];
+        StubSDKPush(frame);
+    }
+    uint64_t steadyAllocs = TestAllocCount() - warmAllocs;
+    long endResidentKB = TestResidentKB();
+
+    pthread_mutex_lock(&stubSDK.lock);
+    stubSDK.finished = true;
+    pthread_cond_broadcast(&stubSDK.changed);
+    pthread_mutex_unlock(&stubSDK.lock);
+    pthread_join(sdkThread, NULL);
+
+    FrameLeasePoolStats stats;
+    FrameLeasePoolGetStats(pool, &stats);
+    uint64_t frames = STUB_FRAMES - STUB_WARMUP_FRAMES;
+    printf("  frames %d  leased %llu  probed %llu  fallback %llu  peakInFlight %u  renderer buffers %d\n",
+           STUB_FRAMES, (unsigned long long)stats.leasedFrames, (unsigned long long)stats.probedFrames,
+           (unsigned long long)fallbackFrames, stats.peakInFlight, atomic_load(&stubRenderer.allocatedBuffers));
+    printf("  steady-state allocs/frame %.4f  RSS %ld KB -> %ld KB  lease %.0f ns/frame\n",
+           (double)steadyAllocs / (double)frames, warmResidentKB, endResidentKB,
+           stats.leasedFrames ? (double)leaseNs / (double)stats.leasedFrames : 0.0);
+
+    // 每帧只渲染一次：要么渲染器渲染（校验或零拷贝），要么原地渲染
+    TEST_CHECK(renders + fallbackFrames == STUB_FRAMES);
+    TEST_CHECK(stats.probedFrames == STUB_LEASE_CAPACITY + 1);
+    TEST_CHECK(stats.returnedFrames == stats.leasedFrames);
+    TEST_CHECK(stats.inFlight == 0);
+    TEST_CHECK(stats.reusedBuffers == 0);
+    TEST_CHECK(stats.peakInFlight <= STUB_LEASE_CAPACITY);
+    // 稳定后既不分配帧对象也不分配 buffer
+    TEST_CHECK(steadyAllocs == 0);
+    // 渲染器最多 capacity 块在 SDK 手中，再加一块正在渲染
+    TEST_CHECK(atomic_load(&stubRenderer.allocatedBuffers) <= STUB_LEASE_CAPACITY + 1);
+    // 校验时分配的 buffer 之后不一定都会被租借
+    TEST_CHECK(stats.distinctBuffers <= (uint64_t)atomic_load(&stubRenderer.allocatedBuffers));
+    // 常驻内存不随帧数增长（留 256KB 余量给线程栈与页缓存抖动）
+    TEST_CHECK(warmResidentKB > 0 && endResidentKB - warmResidentKB < 256);
+
+    FrameLeasePoolDestroy(pool);
+    while (stubRenderer.freeList) {
+        StubBuffer *buffer = stubRenderer.freeList;
+        stubRenderer.freeList = buffer->nextFree;
+        free(buffer->planes);
+        free(buffer);
+    }
+}
+
+int main(void) {
+    TEST_RUN(TestCreateRejectsInvalidArguments);
+    TEST_RUN(TestLeaseAndReturn);
+    TEST_RUN(TestExhaustedAndReused);
+    TEST_RUN(TestDestroyWhileLeased);
+    TEST_RUN(TestProbeRenderer);
+    TEST_RUN(TestStubPipelineAllocations);
+    return TEST_RESULT();
+}
@@ -0,0 +1,281 @@
+//
+//  GridCompositorTests.c
+//  tests
+//
+//  网格合成：格子划分、Hidden 模式居中裁剪、Fit 模式黑边位置、空格子填黑、
+//  SIMD 与标量逐字节一致，以及合成不分配内存
+//
+
+#include "GridCompositor.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t *buffer;
+    GridI420Image image;
+} TestImage;
+
+/// 三个平面连续存放的 I420 图像，stride 比宽度多 16 字节，检查不依赖 stride == width
+static TestImage TestImageCreate(int width, int height) {
+    TestImage test;
+    size_t yStride = (size_t)width + 16;
+    size_t uvStride = (size_t)width / 2 + 16;
+    size_t ySize = yStride * (size_t)height;
+    size_t uvSize = uvStride * (size_t)(height / 2);
+    test.buffer = malloc(ySize + 2 * uvSize);
+    memset(test.buffer, 7, ySize + 2 * uvSize);
+    test.image = (GridI420Image){
+        .y = test.buffer,
+        .u = test.buffer + ySize,
+        .v = test.buffer + ySize + uvSize,
+        .yStride = yStride,
+        .uStride = uvStride,
+        .vStride = uvStride,
+        .width = width,
+        .height = height,
+    };
+    return test;
+}
+
+static void TestImageDestroy(TestImage *test) {
+    free(test->buffer);
+}
+
+static void TestFillRandom(const GridI420Image *image, unsigned seed) {
+    srand(seed);
+    for (int y = 0; y < image->height; y++) {
+        for (int x = 0; x < image->width; x++) {
+            image->y[(size_t)y * image->yStride + x] = (uint8_t)rand();
+        }
+    }
+    for (int y = 0; y < image->height / 2; y++) {
+        for (int x = 0; x < image->width / 2; x++) {
+            image->u[(size_t)y * image->uStride + x] = (uint8_t)rand();
+            image->v[(size_t)y * image->vStride + x] = (uint8_t)rand();
+        }
+    }
+}
+
+/// 按亮度坐标 [inside0, inside1) 内外填不同的值；horizontal 为 true 时按列，否则按行
+static void TestFillBands(const GridI420Image *image, bool horizontal, int inside0, int inside1) {
+    for (int y = 0; y < image->height; y++) {
+        for (int x = 0; x < image->width; x++) {
+            int position = horizontal ? x : y;
+            image->y[(size_t)y * image->yStride + x] = position < inside0 ? 50 : (position < inside1 ? 200 : 250);
+        }
+    }
+    for (int y = 0; y < image->height / 2; y++) {
+        for (int x = 0; x < image->width / 2; x++) {
+            int position = (horizontal ? x : y) * 2;
+            uint8_t value = position < inside0 ? 60 : (position < inside1 ? 120 : 180);
+            image->u[(size_t)y * image->uStride + x] = value;
+            image->v[(size_t)y * image->vStride + x] = value;
+        }
+    }
+}
+
+/// 区域 [y0, y1) 行内的三个平面是否都等于给定值
+static bool TestRowsEqual(const GridI420Image *image, int y0, int y1, uint8_t luma, uint8_t chroma) {
+    for (int y = y0; y < y1; y++) {
+        for (int x = 0; x < image->width; x++) {
+            if (image->y[(size_t)y * image->yStride + x] != luma) {
+                return false;
+            }
+        }
+    }
+    for (int y = y0 / 2; y < y1 / 2; y++) {
+        for (int x = 0; x < image->width / 2; x++) {
+            if (image->u[(size_t)y * image->uStride + x] != chroma || image->v[(size_t)y * image->vStride + x] != chroma) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool TestImagesEqual(const GridI420Image *a, const GridI420Image *b) {
+    for (int y = 0; y < a->height; y++) {
+        if (memcmp(a->y + (size_t)y * a->yStride, b->y + (size_t)y * b->yStride, (size_t)a->width) != 0) {
+            return false;
+        }
+    }
+    for (int y = 0; y < a->height / 2; y++) {
+        if (memcmp(a->u + (size_t)y * a->uStride, b->u + (size_t)y * b->uStride, (size_t)a->width / 2) != 0 ||
+            memcmp(a->v + (size_t)y * a->vStride, b->v + (size_t)y * b->vStride, (size_t)a->width / 2) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// 2x2 均分，最后一行/列吸收余数，位置与宽高都是偶数
+static void TestTileGeometry(void) {
+    TestImage canvas = TestImageCreate(720, 1280);
+    GridI420Image tile = GridCompositorTile(&canvas.image, 2, 2, 3);
+    TEST_CHECK(tile.width == 360 && tile.height == 640);
+    TEST_CHECK(tile.y == canvas.image.y + 640 * canvas.image.yStride + 360);
+    TEST_CHECK(tile.u == canvas.image.u + 320 * canvas.image.uStride + 180);
+    TestImageDestroy(&canvas);
+
+    TestImage odd = TestImageCreate(722, 482);
+    for (int i = 0; i < 9; i++) {
+        GridI420Image third = GridCompositorTile(&odd.image, 3, 3, i);
+        size_t offset = (size_t)(third.y - odd.image.y);
+        TEST_CHECK(third.width % 2 == 0 && third.height % 2 == 0);
+        TEST_CHECK((offset % odd.image.yStride) % 2 == 0 && (offset / odd.image.yStride) % 2 == 0);
+    }
+    GridI420Image last = GridCompositorTile(&odd.image, 3, 3, 8);
+    TEST_CHECK((size_t)(last.y - odd.image.y) % odd.image.yStride + (size_t)last.width == 722);
+    TestImageDestroy(&odd);
+}
+
+/// Hidden：横屏源图放进竖屏格子时只取中间一段，竖屏源图放进较扁的格子时只取中间几行
+static void TestHiddenCrop(void) {
+    GridCompositor *compositor = GridCompositorCreate(4096);
+    TestImage tile = TestImageCreate(360, 640);
+    // 1280x720 → 360x640：裁剪宽度 720 × 360 / 640 = 405 → 404，起点 (1280 - 404) / 2 = 438
+    TestImage landscape = TestImageCreate(1280, 720);
+    TestFillBands(&landscape.image, true, 438, 438 + 404);
+    for (int simd = 0; simd < 2; simd++) {
+        GridCompositorSetScalarOnly(compositor, !simd);
+        TEST_CHECK(GridCompositorDrawTile(compositor, &landscape.image, &tile.image, GridScaleModeHidden));
+        TEST_CHECK(TestRowsEqual(&tile.image, 0, 640, 200, 120));
+    }
+    // 偏移一个像素就会混入两侧的值
+    TestFillBands(&landscape.image, true, 440, 440 + 404);
+    TEST_CHECK(GridCompositorDrawTile(compositor, &landscape.image, &tile.image, GridScaleModeHidden));
+    TEST_CHECK(!TestRowsEqual(&tile.image, 0, 640, 200, 120));
+    // 360x1280 → 360x640：裁剪高度 640，起点 320，中间按 1:1 拷贝
+    TestImage portrait = TestImageCreate(360, 1280);
+    TestFillBands(&portrait.image, false, 320, 960);
+    TEST_CHECK(GridCompositorDrawTile(compositor, &portrait.image, &tile.image, GridScaleModeHidden));
+    TEST_CHECK(TestRowsEqual(&tile.image, 0, 640, 200, 120));
+    TestImageDestroy(&portrait);
+    TestImageDestroy(&landscape);
+    TestImageDestroy(&tile);
+    GridCompositorDestroy(compositor);
+}
+
+/// Fit：完整显示源图，上下（或左右）黑边位置对齐到偶数，格子的每个像素都被写到
+static void TestFitLetterbox(void) {
+    GridCompositor *compositor = GridCompositorCreate(4096);
+    // 1280x720 → 360x640：画面高 360 × 720 / 1280 = 202.5 → 202，上边 (640 - 202) / 2 = 219 → 218
+    TestImage landscape = TestImageCreate(1280, 720);
+    TestFillBands(&landscape.image, true, 0, 1280);
+    TestImage tile = TestImageCreate(360, 640);
+    TEST_CHECK(GridCompositorDrawTile(compositor, &landscape.image, &tile.image, GridScaleModeFit));
+    TEST_CHECK(TestRowsEqual(&tile.image, 0, 218, 16, 128));
+    TEST_CHECK(TestRowsEqual(&tile.image, 218, 420, 200, 120));
+    TEST_CHECK(TestRowsEqual(&tile.image, 420, 640, 16, 128));
+
+    // 720x1280 → 640x360：画面宽 360 × 720 / 1280 = 202.5 → 202，左边 219 → 218
+    TestImage portrait = TestImageCreate(720, 1280);
+    TestFillBands(&portrait.image, true, 0, 720);
+    TestImage wide = TestImageCreate(640, 360);
+    TEST_CHECK(GridCompositorDrawTile(compositor, &portrait.image, &wide.image, GridScaleModeFit));
+    bool bars = true;
+    for (int y = 0; y < 360; y++) {
+        for (int x = 0; x < 640; x++) {
+            uint8_t expected = (x < 218 || x >= 420) ? 16 : 200;
+            bars = bars && wide.image.y[(size_t)y * wide.image.yStride + x] == expected;
+        }
+    }
+    for (int y = 0; y < 180; y++) {
+        for (int x = 0; x < 320; x++) {
+            uint8_t expected = (x < 109 || x >= 210) ? 128 : 120;
+            bars = bars && wide.image.u[(size_t)y * wide.image.uStride + x] == expected &&
+                   wide.image.v[(size_t)y * wide.image.vStride + x] == expected;
+        }
+    }
+    TEST_CHECK(bars);
+    TestImageDestroy(&wide);
+    TestImageDestroy(&portrait);
+    TestImageDestroy(&tile);
+    TestImageDestroy(&landscape);
+    GridCompositorDestroy(compositor);
+}
+
+/// 没有画面或源图过宽的格子填黑，返回实际绘制的格子数
+static void TestComposeEmptyTiles(void) {
+    GridCompositor *compositor = GridCompositorCreate(1280);
+    TestImage canvas = TestImageCreate(720, 1280);
+    TestImage source = TestImageCreate(640, 360);
+    TestFillBands(&source.image, true, 0, 640);
+    TestImage tooWide = TestImageCreate(1920, 1080);
+    const GridI420Image *sources[4] = {&source.image, NULL, &tooWide.image, &source.image};
+    TEST_CHECK(GridCompositorCompose(compositor, sources, &canvas.image, 2, 2, GridScaleModeHidden) == 2);
+    GridI420Image tiles[4];
+    for (int i = 0; i < 4; i++) {
+        tiles[i] = GridCompositorTile(&canvas.image, 2, 2, i);
+    }
+    TEST_CHECK(TestRowsEqual(&tiles[0], 0, 640, 200, 120));
+    TEST_CHECK(TestRowsEqual(&tiles[1], 0, 640, 16, 128));
+    TEST_CHECK(TestRowsEqual(&tiles[2], 0, 640, 16, 128));
+    TEST_CHECK(TestRowsEqual(&tiles[3], 0, 640, 200, 120));
+    TestImageDestroy(&tooWide);
+    TestImageDestroy(&source);
+    TestImageDestroy(&canvas);
+    GridCompositorDestroy(compositor);
+}
+
+/// SIMD 与标量实现对各种缩放比例（含 2x 降采样与 1:1 拷贝）逐字节一致
+static void TestSimdMatchesScalar(void) {
+    GridCompositor *compositor = GridCompositorCreate(4096);
+    const int sizes[][2] = {{1280, 720}, {720, 1280}, {720, 1280 * 2}, {1920, 1080}, {640, 480}, {350, 198},
+                            {362, 642}, {2, 2}};
+    TestImage simdCanvas = TestImageCreate(720, 1280);
+    TestImage scalarCanvas = TestImageCreate(720, 1280);
+    int compared = 0;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        TestImage source = TestImageCreate(sizes[s][0], sizes[s][1]);
+        TestFillRandom(&source.image, (unsigned)s + 1);
+        const GridI420Image *sources[4] = {&source.image, &source.image, NULL, &source.image};
+        for (int mode = GridScaleModeHidden; mode <= GridScaleModeFit; mode++) {
+            GridCompositorSetScalarOnly(compositor, false);
+            GridCompositorCompose(compositor, sources, &simdCanvas.image, 2, 2, (GridScaleMode)mode);
+            GridCompositorSetScalarOnly(compositor, true);
+            GridCompositorCompose(compositor, sources, &scalarCanvas.image, 2, 2, (GridScaleMode)mode);
+            bool equal = TestImagesEqual(&simdCanvas.image, &scalarCanvas.image);
+            TEST_CHECK(equal);
+            if (!equal) {
+                fprintf(stderr, "  %dx%d mode %d differs\n", sizes[s][0], sizes[s][1], mode);
+            }
+            compared++;
+        }
+        TestImageDestroy(&source);
+    }
+    printf("  %d size/mode combinations byte-identical\n", compared);
+    TestImageDestroy(&scalarCanvas);
+    TestImageDestroy(&simdCanvas);
+    GridCompositorDestroy(compositor);
+}
+
+/// 合成时不分配内存
+static void TestNoAllocation(void) {
+    GridCompositor *compositor = GridCompositorCreate(4096);
+    TestImage canvas = TestImageCreate(720, 1280);
+    TestImage source = TestImageCreate(1280, 720);
+    TestFillRandom(&source.image, 3);
+    const GridI420Image *sources[4] = {&source.image, &source.image, &source.image, NULL};
+    uint64_t allocations = TestAllocCount();
+    for (int i = 0; i < 10; i++) {
+        GridCompositorCompose(compositor, sources, &canvas.image, 2, 2, i & 1 ? GridScaleModeFit : GridScaleModeHidden);
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    TestImageDestroy(&source);
+    TestImageDestroy(&canvas);
+    GridCompositorDestroy(compositor);
+}
+
+int main(void) {
+    TEST_RUN(TestTileGeometry);
+    TEST_RUN(TestHiddenCrop);
+    TEST_RUN(TestFitLetterbox);
+    TEST_RUN(TestComposeEmptyTiles);
+    TEST_RUN(TestSimdMatchesScalar);
+    TEST_RUN(TestNoAllocation);
+    return TEST_RESULT();
+}
@@ -0,0 +1,686 @@
+//
+//  JpegEncoderTests.c
+//  tests
+//
+//  JPEG 编码：用测试内的基线解码器按文件中的表解码后与原图比较，检查文件结构、质量系数、
+//  video range 扩展、行字节数与边缘补齐、0xFF 填充、非法参数与缓冲不足，以及编码不分配内存
+//
+
+#include "JpegEncoder.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint8_t TestZigzag[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,  12, 19, 26, 33, 40, 48,
+    41, 34, 27, 20, 13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23,
+    30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// Decoder
+
+typedef struct {
+    bool present;
+    uint8_t values[256];
+    int32_t minCode[17];
+    int32_t maxCode[17];
+    int valueIndex[17];
+} TestHuffman;
+
+/// 只支持本编码器输出的基线 JPEG：3 个分量、无重启标记
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t position;
+    uint32_t bits;
+    int bitCount;
+    bool error;
+    size_t stuffedBytes;
+
+    int width;
+    int height;
+    uint8_t quant[4][64];               // 自然顺序
+    bool quantPresent[4];
+    TestHuffman dc[4];
+    TestHuffman ac[4];
+    uint8_t sampling[3];
+    uint8_t quantIndex[3];
+    uint8_t dcIndex[3];
+    uint8_t acIndex[3];
+    bool sawJfif;
+
+    // 按 MCU 补齐后的平面
+    int paddedWidth;
+    int paddedHeight;
+    uint8_t *planes[3];
+} TestJpeg;
+
+static uint16_t TestReadU16(const uint8_t *data) {
+    return (uint16_t)(data[0] << 8 | data[1]);
+}
+
+static bool TestParseHuffman(TestJpeg *jpeg, const uint8_t *segment, size_t length) {
+    size_t offset = 0;
+    while (offset < length) {
+        if (length - offset < 17) {
+            return false;
+        }
+        uint8_t tableClass = segment[offset] >> 4;
+        uint8_t index = segment[offset] & 15;
+        if (tableClass > 1 || index > 3) {
+            return false;
+        }
+        TestHuffman *table = tableClass == 0 ? &jpeg->dc[index] : &jpeg->ac[index];
+        const uint8_t *counts = segment + offset + 1;
+        int total = 0;
+        for (int i = 0; i < 16; i++) {
+            total += counts[i];
+        }
+        if (total > 256 || length - offset < 17 + (size_t)total) {
+            return false;
+        }
+        memcpy(table->values, segment + offset + 17, (size_t)total);
+        int32_t code = 0;
+        int k = 0;
+        for (int bitLength = 1; bitLength <= 16; bitLength++) {
+            table->valueIndex[bitLength] = k;
+            table->minCode[bitLength] = code;
+            code += counts[bitLength - 1];
+            k += counts[bitLength - 1];
+            table->maxCode[bitLength] = counts[bitLength - 1] ? code - 1 : -1;
+            code <<= 1;
+        }
+        table->present = true;
+        offset += 17 + (size_t)total;
+    }
+    return true;
+}
+
+static bool TestParseHeaders(TestJpeg *jpeg) {
+    if (jpeg->size < 4 || TestReadU16(jpeg->data) != 0xFFD8) {
+        return false;
+    }
+    size_t position = 2;
+    bool sawFrame = false;
+    for (;;) {
+        if (jpeg->size - position < 4 || jpeg->data[position] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = jpeg->data[position + 1];
+        size_t length = TestReadU16(jpeg->data + position + 2);
+        if (length < 2 || jpeg->size - position - 2 < length) {
+            return false;
+        }
+        const uint8_t *segment = jpeg->data + position + 4;
+        length -= 2;
+        position += 4 + length;
+        switch (marker) {
+            case 0xE0:
+                jpeg->sawJfif = length >= 5 && memcmp(segment, "JFIF", 5) == 0;
+                break;
+            case 0xDB:
+                for (size_t offset = 0; offset < length; offset += 65) {
+                    // 只支持 8 位精度的量化表
+                    if (length - offset < 65 || (segment[offset] >> 4) != 0 || (segment[offset] & 15) > 3) {
+                        return false;
+                    }
+                    uint8_t index = segment[offset] & 15;
+                    for (int i = 0; i < 64; i++) {
+                        jpeg->quant[index][TestZigzag[i]] = segment[offset + 1 + i];
+                    }
+                    jpeg->quantPresent[index] = true;
+                }
+                break;
+            case 0xC0:
+                if (length != 15 || segment[0] != 8 || segment[5] != 3) {
+                    return false;
+                }
+                jpeg->height = TestReadU16(segment + 1);
+                jpeg->width = TestReadU16(segment + 3);
+                for (int c = 0; c < 3; c++) {
+                    if (segment[6 + c * 3] != c + 1) {
+                        return false;
+                    }
+                    jpeg->sampling[c] = segment[7 + c * 3];
+                    jpeg->quantIndex[c] = segment[8 + c * 3] & 3;
+                }
+                sawFrame = true;
+                break;
+            case 0xC4:
+                if (!TestParseHuffman(jpeg, segment, length)) {
+                    return false;
+                }
+                break;
+            case 0xDA:
+                if (!sawFrame || length != 10 || segment[0] != 3 || segment[7] != 0 || segment[8] != 63 ||
+                    segment[9] != 0) {
+                    return false;
+                }
+                for (int c = 0; c < 3; c++) {
+                    if (segment[1 + c * 2] != c + 1) {
+                        return false;
+                    }
+                    jpeg->dcIndex[c] = segment[2 + c * 2] >> 4;
+                    jpeg->acIndex[c] = segment[2 + c * 2] & 3;
+                }
+                jpeg->position = position;
+                return true;
+            default:
+                // 本编码器不输出其他段
+                return false;
+        }
+    }
+}
+
+static int TestReadBit(TestJpeg *jpeg) {
+    if (jpeg->bitCount == 0) {
+        if (jpeg->position >= jpeg->size) {
+            jpeg->error = true;
+            return 0;
+        }
+        uint8_t byte = jpeg->data[jpeg->position++];
+        if (byte == 0xFF) {
+            // 熵编码数据中的 0xFF 之后必须是填充的 0x00
+            if (jpeg->position >= jpeg->size || jpeg->data[jpeg->position] != 0x00) {
+                jpeg->error = true;
+                return 0;
+            }
+            jpeg->position++;
+            jpeg->stuffedBytes++;
+        }
+        jpeg->bits = byte;
+        jpeg->bitCount = 8;
+    }
+    jpeg->bitCount--;
+    return (int)(jpeg->bits >> jpeg->bitCount) & 1;
+}
+
+static int TestReadValue(TestJpeg *jpeg, int category) {
+    int value = 0;
+    for (int i = 0; i < category; i++) {
+        value = value << 1 | TestReadBit(jpeg);
+    }
+    // 最高位为 0 时是负数
+    if (category > 0 && value < (1 << (category - 1))) {
+        value -= (1 << category) - 1;
+    }
+    return value;
+}
+
+static int TestDecodeSymbol(TestJpeg *jpeg, const TestHuffman *table) {
+    int32_t code = 0;
+    for (int bitLength = 1; bitLength <= 16; bitLength++) {
+        code = code << 1 | TestReadBit(jpeg);
+        if (code <= table->maxCode[bitLength]) {
+            return table->values[table->valueIndex[bitLength] + code - table->minCode[bitLength]];
+        }
+    }
+    jpeg->error = true;
+    return 0;
+}
+
+/// 浮点 IDCT 参考实现，逐项按定义计算
+static void TestInverseDct(const int *coefficients, const uint8_t *quant, uint8_t *out, size_t stride) {
+    static double cosines[8][8];
+    static bool ready;
+    if (!ready) {
+        for (int x = 0; x < 8; x++) {
+            for (int u = 0; u < 8; u++) {
+                cosines[x][u] = (u == 0 ? sqrt(0.5) : 1.0) * cos((2 * x + 1) * u * M_PI / 16);
+            }
+        }
+        ready = true;
+    }
+    double rows[8][8];
+    for (int v = 0; v < 8; v++) {
+        for (int x = 0; x < 8; x++) {
+            double sum = 0;
+            for (int u = 0; u < 8; u++) {
+                sum += cosines[x][u] * coefficients[v * 8 + u] * quant[v * 8 + u];
+            }
+            rows[v][x] = sum / 2;
+        }
+    }
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            double sum = 0;
+            for (int v = 0; v < 8; v++) {
+                sum += cosines[y][v] * rows[v][x];
+            }
+            long value = lround(sum / 2 + 128);
+            out[(size_t)y * stride + (size_t)x] = (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+        }
+    }
+}
+
+static void TestDecodeBlock(TestJpeg *jpeg, int component, int *previousDc, uint8_t *out, size_t stride) {
+    int coefficients[64] = {0};
+    int category = TestDecodeSymbol(jpeg, &jpeg->dc[jpeg->dcIndex[component]]);
+    if (category > 11) {
+        jpeg->error = true;
+        return;
+    }
+    *previousDc += TestReadValue(jpeg, category);
+    coefficients[0] = *previousDc;
+    for (int k = 1; k < 64;) {
+        int symbol = TestDecodeSymbol(jpeg, &jpeg->ac[jpeg->acIndex[component]]);
+        int run = symbol >> 4;
+        int size = symbol & 15;
+        if (size == 0) {
+            if (run == 15) {
+                k += 16;
+                continue;
+            }
+            break;
+        }
+        k += run;
+        if (k > 63) {
+            jpeg->error = true;
+            return;
+        }
+        coefficients[TestZigzag[k++]] = TestReadValue(jpeg, size);
+    }
+    TestInverseDct(coefficients, jpeg->quant[jpeg->quantIndex[component]], out, stride);
+}
+
+static void TestJpegFree(TestJpeg *jpeg) {
+    for (int c = 0; c < 3; c++) {
+        free(jpeg->planes[c]);
+    }
+}
+
+/// 解码 4:2:0 基线 JPEG，结束后检查补齐位全为 1、之后紧跟 EOI
+static bool TestJpegDecode(const uint8_t *data, size_t size, TestJpeg *jpeg) {
+    memset(jpeg, 0, sizeof(*jpeg));
+    jpeg->data = data;
+    jpeg->size = size;
+    if (!TestParseHeaders(jpeg) || jpeg->sampling[0] != 0x22 || jpeg->sampling[1] != 0x11 ||
+        jpeg->sampling[2] != 0x11) {
+        return false;
+    }
+    for (int c = 0; c < 3; c++) {
+        if (!jpeg->quantPresent[jpeg->quantIndex[c]] || !jpeg->dc[jpeg->dcIndex[c]].present ||
+            !jpeg->ac[jpeg->acIndex[c]].present) {
+            return false;
+        }
+    }
+    int mcuColumns = (jpeg->width + 15) / 16;
+    int mcuRows = (jpeg->height + 15) / 16;
+    jpeg->paddedWidth = mcuColumns * 16;
+    jpeg->paddedHeight = mcuRows * 16;
+    size_t lumaStride = (size_t)jpeg->paddedWidth;
+    size_t chromaStride = lumaStride / 2;
+    jpeg->planes[0] = malloc(lumaStride * (size_t)jpeg->paddedHeight);
+    jpeg->planes[1] = malloc(chromaStride * (size_t)jpeg->paddedHeight / 2);
+    jpeg->planes[2] = malloc(chromaStride * (size_t)jpeg->paddedHeight / 2);
+    int dc[3] = {0, 0, 0};
+    for (int my = 0; my < mcuRows && !jpeg->error; my++) {
+        for (int mx = 0; mx < mcuColumns && !jpeg->error; mx++) {
+            for (int i = 0; i < 4; i++) {
+                size_t x = (size_t)mx * 16 + (size_t)(i & 1) * 8;
+                size_t y = (size_t)my * 16 + (size_t)(i >> 1) * 8;
+                TestDecodeBlock(jpeg, 0, &dc[0], jpeg->planes[0] + y * lumaStride + x, lumaStride);
+            }
+            for (int c = 1; c < 3; c++) {
+                TestDecodeBlock(jpeg, c, &dc[c], jpeg->planes[c] + (size_t)my * 8 * chromaStride + (size_t)mx * 8,
+                                chromaStride);
+            }
+        }
+    }
+    bool paddedWithOnes = jpeg->bitCount == 0 || (jpeg->bits & ((1u << jpeg->bitCount) - 1)) ==
+                                                     (1u << jpeg->bitCount) - 1;
+    bool endsWithEoi = jpeg->position + 2 == jpeg->size && TestReadU16(jpeg->data + jpeg->position) == 0xFFD9;
+    if (jpeg->error || !paddedWithOnes || !endsWithEoi) {
+        TestJpegFree(jpeg);
+        return false;
+    }
+    return true;
+}
+
+// Images
+
+typedef struct {
+    uint8_t *pixels;
+    GridI420Image image;
+} TestImage;
+
+/// 行字节数可大于宽度，多出的部分填 fill，编码器不应读到
+static TestImage TestImageCreate(int width, int height, size_t padding, uint8_t fill) {
+    TestImage result;
+    size_t yStride = (size_t)width + padding;
+    size_t cStride = (size_t)width / 2 + padding;
+    size_t ySize = yStride * (size_t)height;
+    size_t cSize = cStride * (size_t)height / 2;
+    result.pixels = malloc(ySize + cSize * 2);
+    memset(result.pixels, fill, ySize + cSize * 2);
+    result.image = (GridI420Image){
+        .y = result.pixels,
+        .u = result.pixels + ySize,
+        .v = result.pixels + ySize + cSize,
+        .yStride = yStride,
+        .uStride = cStride,
+        .vStride = cStride,
+        .width = width,
+        .height = height,
+    };
+    return result;
+}
+
+/// 平滑渐变叠加低频纹理，接近相机画面
+static void TestImageFillNatural(TestImage *image) {
+    GridI420Image *i = &image->image;
+    for (int y = 0; y < i->height; y++) {
+        for (int x = 0; x < i->width; x++) {
+            double value = 40 + 150.0 * x / i->width + 30 * sin(x * 0.15) * cos(y * 0.11) + 20.0 * y / i->height;
+            i->y[(size_t)y * i->yStride + (size_t)x] = (uint8_t)lround(value);
+        }
+    }
+    for (int y = 0; y < i->height / 2; y++) {
+        for (int x = 0; x < i->width / 2; x++) {
+            i->u[(size_t)y * i->uStride + (size_t)x] = (uint8_t)(100 + x * 50 / (i->width / 2));
+            i->v[(size_t)y * i->vStride + (size_t)x] = (uint8_t)(160 - y * 40 / (i->height / 2));
+        }
+    }
+}
+
+static void TestImageFillNoise(TestImage *image, uint32_t seed) {
+    GridI420Image *i = &image->image;
+    uint8_t *planes[3] = {i->y, i->u, i->v};
+    size_t strides[3] = {i->yStride, i->uStride, i->vStride};
+    for (int c = 0; c < 3; c++) {
+        int width = c == 0 ? i->width : i->width / 2;
+        int height = c == 0 ? i->height : i->height / 2;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                planes[c][(size_t)y * strides[c] + (size_t)x] = (uint8_t)(seed >> 24);
+            }
+        }
+    }
+}
+
+static void TestImageFill(TestImage *image, uint8_t y, uint8_t u, uint8_t v) {
+    GridI420Image *i = &image->image;
+    for (int row = 0; row < i->height; row++) {
+        memset(i->y + (size_t)row * i->yStride, y, (size_t)i->width);
+    }
+    for (int row = 0; row < i->height / 2; row++) {
+        memset(i->u + (size_t)row * i->uStride, u, (size_t)i->width / 2);
+        memset(i->v + (size_t)row * i->vStride, v, (size_t)i->width / 2);
+    }
+}
+
+/// 解码结果与原图一个分量的 PSNR
+static double TestPlanePsnr(const TestJpeg *jpeg, const GridI420Image *image, int component) {
+    if (!jpeg->planes[component]) {
+        return 0;
+    }
+    const uint8_t *source = component == 0 ? image->y : component == 1 ? image->u : image->v;
+    size_t sourceStride = component == 0 ? image->yStride : component == 1 ? image->uStride : image->vStride;
+    int width = component == 0 ? image->width : image->width / 2;
+    int height = component == 0 ? image->height : image->height / 2;
+    size_t decodedStride = (size_t)(component == 0 ? jpeg->paddedWidth : jpeg->paddedWidth / 2);
+    double squared = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            double diff = (double)source[(size_t)y * sourceStride + (size_t)x] -
+                          (double)jpeg->planes[component][(size_t)y * decodedStride + (size_t)x];
+            squared += diff * diff;
+        }
+    }
+    double mse = squared / ((double)width * height);
+    return mse == 0 ? 99.0 : 10 * log10(255.0 * 255.0 / mse);
+}
+
+/// 编码并解码，失败时返回 0
+static size_t TestEncodeDecode(int quality, const GridI420Image *image, bool videoRange, TestJpeg *jpeg) {
+    JpegEncoder *encoder = JpegEncoderCreate(quality);
+    // 噪声图在高质量下会超出建议容量
+    size_t capacity = (size_t)image->width * (size_t)image->height * 4 + 1024;
+    uint8_t *out = malloc(capacity);
+    size_t size = JpegEncoderEncodeI420(encoder, image, videoRange, out, capacity);
+    bool decoded = size > 0 && TestJpegDecode(out, size, jpeg);
+    if (!decoded) {
+        memset(jpeg, 0, sizeof(*jpeg));
+    }
+    free(out);
+    JpegEncoderDestroy(encoder);
+    return decoded ? size : 0;
+}
+
+// Tests
+
+static void TestCreate(void) {
+    TEST_CHECK(JpegEncoderCreate(0) == NULL);
+    TEST_CHECK(JpegEncoderCreate(101) == NULL);
+    JpegEncoder *encoder = JpegEncoderCreate(1);
+    TEST_CHECK(encoder != NULL);
+    JpegEncoderDestroy(encoder);
+    encoder = JpegEncoderCreate(100);
+    TEST_CHECK(encoder != NULL);
+    JpegEncoderDestroy(encoder);
+    JpegEncoderDestroy(NULL);
+    TEST_CHECK(JpegEncoderSuggestedCapacity(1280 * 720) > 1280 * 720 * 3 / 2);
+}
+
+/// 文件结构：JFIF、两张量化表、Y 2x2 采样用表 0，Cb/Cr 1x1 用表 1，四张标准霍夫曼表
+static void TestStructure(void) {
+    TestImage image = TestImageCreate(64, 48, 0, 0);
+    TestImageFillNatural(&image);
+    TestJpeg jpeg;
+    TEST_CHECK(TestEncodeDecode(75, &image.image, false, &jpeg) > 0);
+    TEST_CHECK(jpeg.sawJfif);
+    TEST_CHECK(jpeg.width == 64 && jpeg.height == 48);
+    TEST_CHECK(jpeg.quantIndex[0] == 0 && jpeg.quantIndex[1] == 1 && jpeg.quantIndex[2] == 1);
+    TEST_CHECK(jpeg.dcIndex[0] == 0 && jpeg.acIndex[0] == 0);
+    TEST_CHECK(jpeg.dcIndex[1] == 1 && jpeg.acIndex[1] == 1 && jpeg.dcIndex[2] == 1 && jpeg.acIndex[2] == 1);
+    // Annex K 亮度 AC 表：2 个 2 位码 0x01、0x02
+    TEST_CHECK(jpeg.ac[0].maxCode[1] == -1 && jpeg.ac[0].values[0] == 0x01 && jpeg.ac[0].values[1] == 0x02);
+    TEST_CHECK(jpeg.ac[1].values[0] == 0x00 && jpeg.dc[0].values[11] == 11 && jpeg.dc[1].values[11] == 11);
+    TestJpegFree(&jpeg);
+    free(image.pixels);
+}
+
+/// 与 libjpeg 相同的质量缩放：50 为 Annex K 原表，100 全为 1，越低文件越小
+static void TestQuality(void) {
+    TestImage image = TestImageCreate(96, 64, 0, 0);
+    TestImageFillNatural(&image);
+    TestJpeg jpeg;
+    TEST_CHECK(TestEncodeDecode(50, &image.image, false, &jpeg) > 0);
+    TEST_CHECK(jpeg.quant[0][0] == 16 && jpeg.quant[0][1] == 11 && jpeg.quant[0][63] == 99);
+    TEST_CHECK(jpeg.quant[1][0] == 17 && jpeg.quant[1][63] == 99);
+    TestJpegFree(&jpeg);
+
+    TEST_CHECK(TestEncodeDecode(100, &image.image, false, &jpeg) > 0);
+    bool allOnes = true;
+    for (int i = 0; i < 64; i++) {
+        allOnes = allOnes && jpeg.quant[0][i] == 1 && jpeg.quant[1][i] == 1;
+    }
+    TEST_CHECK(allOnes);
+    TestJpegFree(&jpeg);
+
+    TEST_CHECK(TestEncodeDecode(1, &image.image, false, &jpeg) > 0);
+    TEST_CHECK(jpeg.quant[0][0] == 255);
+    TestJpegFree(&jpeg);
+
+    size_t previous = 0;
+    double previousPsnr = 0;
+    int qualities[] = {20, 50, 80, 95};
+    for (int i = 0; i < 4; i++) {
+        size_t size = TestEncodeDecode(qualities[i], &image.image, false, &jpeg);
+        double psnr = TestPlanePsnr(&jpeg, &image.image, 0);
+        TEST_CHECK(size > previous);
+        TEST_CHECK(psnr > previousPsnr);
+        printf("  q%d: %zu bytes, Y %.1f dB\n", qualities[i], size, psnr);
+        previous = size;
+        previousPsnr = psnr;
+        TestJpegFree(&jpeg);
+    }
+    free(image.pixels);
+}
+
+/// 解码结果接近原图
+static void TestRoundTrip(void) {
+    TestImage image = TestImageCreate(160, 96, 0, 0);
+    TestImageFillNatural(&image);
+    TestJpeg jpeg;
+    TEST_CHECK(TestEncodeDecode(90, &image.image, false, &jpeg) > 0);
+    double psnr[3];
+    for (int c = 0; c < 3; c++) {
+        psnr[c] = TestPlanePsnr(&jpeg, &image.image, c);
+    }
+    TEST_CHECK(psnr[0] > 38 && psnr[1] > 38 && psnr[2] > 38);
+    printf("  q90: Y %.1f dB, U %.1f dB, V %.1f dB\n", psnr[0], psnr[1], psnr[2]);
+    TestJpegFree(&jpeg);
+
+    TEST_CHECK(TestEncodeDecode(100, &image.image, false, &jpeg) > 0);
+    TEST_CHECK(TestPlanePsnr(&jpeg, &image.image, 0) > 45);
+    TestJpegFree(&jpeg);
+    free(image.pixels);
+}
+
+/// video range 输入扩展到 full range：Y 16/235 → 0/255，UV 16/240 → 0/255，128 不变
+static void TestVideoRange(void) {
+    struct {
+        uint8_t input;
+        uint8_t chroma;
+        int expectedLuma;
+        int expectedChroma;
+    } cases[] = {
+        {16, 16, 0, 0},
+        {235, 240, 255, 255},
+        {126, 128, 128, 128},
+        {0, 0, 0, 0},
+        {255, 255, 255, 255},
+    };
+    TestImage image = TestImageCreate(32, 32, 0, 0);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        TestImageFill(&image, cases[i].input, cases[i].chroma, cases[i].chroma);
+        TestJpeg jpeg;
+        TEST_CHECK(TestEncodeDecode(95, &image.image, true, &jpeg) > 0);
+        TEST_CHECK(abs(jpeg.planes[0][17 * jpeg.paddedWidth + 9] - cases[i].expectedLuma) <= 1);
+        TEST_CHECK(abs(jpeg.planes[1][5 * jpeg.paddedWidth / 2 + 3] - cases[i].expectedChroma) <= 1);
+        TEST_CHECK(abs(jpeg.planes[2][5 * jpeg.paddedWidth / 2 + 3] - cases[i].expectedChroma) <= 1);
+        TestJpegFree(&jpeg);
+
+        // full range 输入原样编码
+        TEST_CHECK(TestEncodeDecode(95, &image.image, false, &jpeg) > 0);
+        TEST_CHECK(abs(jpeg.planes[0][17 * jpeg.paddedWidth + 9] - cases[i].input) <= 1);
+        TestJpegFree(&jpeg);
+    }
+    free(image.pixels);
+}
+
+/// 行字节数大于宽度时只读有效区域；宽高不是 16 的倍数时补齐部分复制边缘像素
+static void TestStrideAndEdges(void) {
+    TestImage tight = TestImageCreate(38, 22, 0, 0);
+    TestImage padded = TestImageCreate(38, 22, 29, 0xFF);
+    TestImageFillNatural(&tight);
+    TestImageFillNatural(&padded);
+    JpegEncoder *encoder = JpegEncoderCreate(85);
+    uint8_t first[8192];
+    uint8_t second[8192];
+    size_t firstSize = JpegEncoderEncodeI420(encoder, &tight.image, false, first, sizeof(first));
+    size_t secondSize = JpegEncoderEncodeI420(encoder, &padded.image, false, second, sizeof(second));
+    TEST_CHECK(firstSize > 0 && firstSize == secondSize && memcmp(first, second, firstSize) == 0);
+
+    TestJpeg jpeg;
+    TEST_CHECK(TestJpegDecode(first, firstSize, &jpeg));
+    TEST_CHECK(jpeg.width == 38 && jpeg.height == 22 && jpeg.paddedWidth == 48 && jpeg.paddedHeight == 32);
+    TEST_CHECK(TestPlanePsnr(&jpeg, &tight.image, 0) > 35);
+    // 右侧与下方补齐的像素接近最后一列、最后一行
+    int rightEdge = tight.image.y[10 * tight.image.yStride + 37];
+    int bottomEdge = tight.image.y[21 * tight.image.yStride + 20];
+    TEST_CHECK(abs(jpeg.planes[0][10 * 48 + 46] - rightEdge) <= 12);
+    TEST_CHECK(abs(jpeg.planes[0][30 * 48 + 20] - bottomEdge) <= 12);
+    TestJpegFree(&jpeg);
+    JpegEncoderDestroy(encoder);
+    free(tight.pixels);
+    free(padded.pixels);
+}
+
+/// 噪声图的熵编码数据中出现 0xFF，全部补 0x00；质量 100 时接近无损
+static void TestByteStuffing(void) {
+    TestImage image = TestImageCreate(64, 64, 0, 0);
+    TestImageFillNoise(&image, 7);
+    TestJpeg jpeg;
+    size_t size = TestEncodeDecode(100, &image.image, false, &jpeg);
+    TEST_CHECK(size > 0);
+    TEST_CHECK(jpeg.stuffedBytes > 0);
+    TEST_CHECK(TestPlanePsnr(&jpeg, &image.image, 0) > 40);
+    printf("  noise q100: %zu bytes, %zu stuffed\n", size, jpeg.stuffedBytes);
+    TestJpegFree(&jpeg);
+    free(image.pixels);
+}
+
+/// 宽高为奇数、小于 2 或超过 65535 时拒绝；缓冲不足时返回 0 且不越界
+static void TestInvalidInput(void) {
+    JpegEncoder *encoder = JpegEncoderCreate(80);
+    TestImage image = TestImageCreate(64, 64, 0, 0);
+    TestImageFillNatural(&image);
+    static uint8_t out[16384];
+    GridI420Image invalid = image.image;
+    int sizes[][2] = {{63, 64}, {64, 63}, {0, 64}, {64, 0}, {1, 2}, {-2, 2}, {65536, 2}, {2, 65536}};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        invalid.width = sizes[i][0];
+        invalid.height = sizes[i][1];
+        TEST_CHECK(JpegEncoderEncodeI420(encoder, &invalid, false, out, sizeof(out)) == 0);
+    }
+    invalid.width = 2;
+    invalid.height = 2;
+    TEST_CHECK(JpegEncoderEncodeI420(encoder, &invalid, false, out, sizeof(out)) > 0);
+    TEST_CHECK(JpegEncoderEncodeI420(NULL, &image.image, false, out, sizeof(out)) == 0);
+    TEST_CHECK(JpegEncoderEncodeI420(encoder, NULL, false, out, sizeof(out)) == 0);
+    TEST_CHECK(JpegEncoderEncodeI420(encoder, &image.image, false, NULL, sizeof(out)) == 0);
+
+    size_t size = JpegEncoderEncodeI420(encoder, &image.image, false, out, sizeof(out));
+    TEST_CHECK(size > 0 && size < sizeof(out) - 64);
+    size_t capacities[] = {0, 1, 100, size / 2, size - 1};
+    for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++) {
+        memset(out, 0xA5, sizeof(out));
+        TEST_CHECK(JpegEncoderEncodeI420(encoder, &image.image, false, out, capacities[i]) == 0);
+        bool untouched = true;
+        for (size_t k = capacities[i]; k < sizeof(out); k++) {
+            untouched = untouched && out[k] == 0xA5;
+        }
+        TEST_CHECK(untouched);
+    }
+    TEST_CHECK(JpegEncoderEncodeI420(encoder, &image.image, false, out, size) == size);
+    JpegEncoderDestroy(encoder);
+    free(image.pixels);
+}
+
+/// 建议容量足够质量 95 的 720p 自然图像；编码过程不分配内存
+static void TestCapacityAndAllocation(void) {
+    TestImage image = TestImageCreate(1280, 720, 0, 0);
+    TestImageFillNatural(&image);
+    JpegEncoder *encoder = JpegEncoderCreate(95);
+    size_t capacity = JpegEncoderSuggestedCapacity(1280 * 720);
+    uint8_t *out = malloc(capacity);
+    uint64_t allocations = TestAllocCount();
+    uint64_t start = TestNowNs();
+    size_t size = JpegEncoderEncodeI420(encoder, &image.image, true, out, capacity);
+    uint64_t elapsed = TestNowNs() - start;
+    TEST_CHECK(TestAllocCount() == allocations);
+    TEST_CHECK(size > 0 && size < capacity);
+    printf("  720p q95: %zu bytes of %zu, %.1f ms\n", size, capacity, (double)elapsed / 1e6);
+    free(out);
+    JpegEncoderDestroy(encoder);
+    free(image.pixels);
+}
+
+int main(void) {
+    TEST_RUN(TestCreate);
+    TEST_RUN(TestStructure);
+    TEST_RUN(TestQuality);
+    TEST_RUN(TestRoundTrip);
+    TEST_RUN(TestVideoRange);
+    TEST_RUN(TestStrideAndEdges);
+    TEST_RUN(TestByteStuffing);
+    TEST_RUN(TestInvalidInput);
+    TEST_RUN(TestCapacityAndAllocation);
+    return TEST_RESULT();
+}
@@ -0,0 +1,182 @@
+//
+//  KernelBenchmark.c
+//  tests
+//
+//  音频前处理链、重采样与网格合成的单帧耗时（SIMD 与标量对比），以及编码流归档的写盘吞吐
+//
+//  用法：KernelBenchmark [audio | resampler | grid | archive]，不带参数时全部运行
+//
+
+#include "AudioPreprocessChain.h"
+#include "AudioResampler.h"
+#include "GridCompositor.h"
+#include "StreamArchive.h"
+
+#include <dirent.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// 默认处理链每 10ms 音频帧的耗时
+static void BenchmarkAudioPreprocess(void) {
+    const AudioStageType stages[] = {AudioStageHighPass, AudioStageGain, AudioStageSoftLimiter, AudioStageDCRemoval};
+    const unsigned sampleRates[] = {16000, 48000};
+    for (size_t r = 0; r < sizeof(sampleRates) / sizeof(sampleRates[0]); r++) {
+        for (unsigned channels = 1; channels <= 2; channels++) {
+            AudioPreprocessChain *chain = AudioPreprocessChainCreate(stages, sizeof(stages) / sizeof(stages[0]));
+            double simdNs = AudioPreprocessChainBenchmark(chain, sampleRates[r], channels, 10000);
+            AudioPreprocessChainSetScalarOnly(chain, true);
+            double scalarNs = AudioPreprocessChainBenchmark(chain, sampleRates[r], channels, 10000);
+            AudioPreprocessChainDestroy(chain);
+            printf("audio preprocess: %uHz %uch %.0f ns/frame (scalar %.0f ns/frame)\n",
+                   sampleRates[r], channels, simdNs, scalarNs);
+        }
+    }
+}
+
+/// 常用采样率之间转换每 10ms 输入帧的耗时
+static void BenchmarkAudioResampler(void) {
+    const unsigned ratePairs[][2] = {{48000, 44100}, {44100, 48000}, {48000, 16000}, {16000, 48000}, {44100, 16000}};
+    for (size_t r = 0; r < sizeof(ratePairs) / sizeof(ratePairs[0]); r++) {
+        for (unsigned channels = 1; channels <= 2; channels++) {
+            unsigned inputRate = ratePairs[r][0], outputRate = ratePairs[r][1];
+            AudioResampler *resampler = AudioResamplerCreate(inputRate, outputRate, channels, inputRate / 100, 0);
+            double simdNs = AudioResamplerBenchmark(resampler, 10000);
+            AudioResamplerSetScalarOnly(resampler, true);
+            double scalarNs = AudioResamplerBenchmark(resampler, 10000);
+            AudioResamplerDestroy(resampler);
+            printf("audio resampler: %u -> %uHz %uch %.0f ns/frame (scalar %.0f ns/frame)\n",
+                   inputRate, outputRate, channels, simdNs, scalarNs);
+        }
+    }
+}
+
+/// 720x1280 画布上 0~4 格有画面时合成一帧的耗时
+static void BenchmarkGridCompositor(void) {
+    const int sourceSizes[][2] = {{640, 360}, {1280, 720}, {720, 1280}};
+    GridCompositor *compositor = GridCompositorCreate(4096);
+    for (size_t s = 0; s < sizeof(sourceSizes) / sizeof(sourceSizes[0]); s++) {
+        for (int activeTiles = 0; activeTiles <= 4; activeTiles++) {
+            int sourceWidth = sourceSizes[s][0], sourceHeight = sourceSizes[s][1];
+            GridCompositorSetScalarOnly(compositor, false);
+            double simdNs = GridCompositorBenchmark(compositor, 720, 1280, sourceWidth, sourceHeight, activeTiles, 300);
+            GridCompositorSetScalarOnly(compositor, true);
+            double scalarNs = GridCompositorBenchmark(compositor, 720, 1280, sourceWidth, sourceHeight, activeTiles, 300);
+            printf("grid compositor: source %dx%d %d tiles %.0f us/frame (scalar %.0f us/frame)\n",
+                   sourceWidth, sourceHeight, activeTiles, simdNs / 1000, scalarNs / 1000);
+        }
+    }
+    GridCompositorDestroy(compositor);
+}
+
+static uint64_t BenchmarkClockNs(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void BenchmarkRemoveDirectory(const char *directory) {
+    DIR *dir = opendir(directory);
+    if (dir) {
+        struct dirent *entry;
+        char path[PATH_MAX];
+        while ((entry = readdir(dir))) {
+            if (entry->d_name[0] != '.') {
+                snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+                unlink(path);
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(directory);
+}
+
+/// 默认配置下 1/4/8 路流以最快速度投递 64MB（16KB 帧，每 30 帧一个关键帧）：
+/// 投递线程每帧耗时、从开始投递到 StreamArchiveStop 返回的写盘吞吐，以及 I/O 线程每 MB 的 CPU 时间
+static void BenchmarkStreamArchive(void) {
+    enum { FrameBytes = 16 * 1024, TotalBytes = 64 << 20, KeyframeInterval = 30 };
+    static uint8_t data[FrameBytes];
+    for (size_t i = 0; i < FrameBytes; i++) {
+        data[i] = (uint8_t)(i * 131);
+    }
+    const uint32_t streamCounts[] = {1, 4, 8};
+    for (size_t c = 0; c < sizeof(streamCounts) / sizeof(streamCounts[0]); c++) {
+        char directory[] = "/tmp/KernelBenchmarkArchiveXXXXXX";
+        if (!mkdtemp(directory)) {
+            printf("stream archive: cannot create %s\n", directory);
+            return;
+        }
+        uint32_t streams = streamCounts[c];
+        StreamArchiveConfig config = StreamArchiveDefaultConfig(directory);
+        StreamArchive *archive = StreamArchiveCreate(&config);
+        char names[8][32];
+        for (uint32_t s = 0; s < streams; s++) {
+            snprintf(names[s], sizeof(names[s]), "bench_user%u_main", s);
+        }
+        uint64_t frames = TotalBytes / FrameBytes;
+        uint64_t pushNs = 0, retries = 0;
+        uint64_t startNs = BenchmarkClockNs(CLOCK_MONOTONIC);
+        uint64_t startCpuNs = BenchmarkClockNs(CLOCK_PROCESS_CPUTIME_ID);
+        uint64_t startThreadNs = BenchmarkClockNs(CLOCK_THREAD_CPUTIME_ID);
+        for (uint64_t i = 0; i < frames; i++) {
+            uint32_t stream = (uint32_t)(i % streams);
+            uint64_t sequence = i / streams;
+            EncodedFrameHeader header = {
+                .ptsUs = (int64_t)sequence * 33333,
+                .dtsUs = (int64_t)sequence * 33333,
+                .arrivalUs = (int64_t)(BenchmarkClockNs(CLOCK_MONOTONIC) / 1000),
+                .size = FrameBytes,
+                .flags = sequence % KeyframeInterval == 0 ? ENCODED_FRAME_FLAG_KEYFRAME : 0,
+                .width = 1280,
+                .height = 720,
+                .codec = EncodedFrameCodecH264,
+            };
+            for (;;) {
+                uint64_t pushStartNs = BenchmarkClockNs(CLOCK_MONOTONIC);
+                bool pushed = StreamArchivePush(archive, names[stream], &header, data);
+                if (pushed) {
+                    pushNs += BenchmarkClockNs(CLOCK_MONOTONIC) - pushStartNs;
+                    break;
+                }
+                // 缓冲已满，等 I/O 线程写盘，测的是写盘吞吐而不是丢帧
+                retries++;
+                sched_yield();
+            }
+        }
+        uint64_t producerCpuNs = BenchmarkClockNs(CLOCK_THREAD_CPUTIME_ID) - startThreadNs;
+        StreamArchiveStop(archive);
+        uint64_t elapsedNs = BenchmarkClockNs(CLOCK_MONOTONIC) - startNs;
+        uint64_t writerCpuNs = BenchmarkClockNs(CLOCK_PROCESS_CPUTIME_ID) - startCpuNs - producerCpuNs;
+        StreamArchiveStats stats;
+        StreamArchiveGetStats(archive, &stats);
+        StreamArchiveDestroy(archive);
+        BenchmarkRemoveDirectory(directory);
+        double megabytes = (double)stats.bytesWritten / (1 << 20);
+        printf("stream archive: %u streams %.0f MB/s, push %.0f ns/frame, writer cpu %.2f ms/MB, "
+               "%llu frames %u files, %llu full-buffer retries\n",
+               streams, megabytes / ((double)elapsedNs / 1e9), (double)pushNs / (double)frames,
+               (double)writerCpuNs / 1e6 / megabytes, (unsigned long long)stats.frames, stats.files,
+               (unsigned long long)retries);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *only = argc > 1 ? argv[1] : NULL;
+    if (!only || strcmp(only, "audio") == 0) {
+        BenchmarkAudioPreprocess();
+    }
+    if (!only || strcmp(only, "resampler") == 0) {
+        BenchmarkAudioResampler();
+    }
+    if (!only || strcmp(only, "grid") == 0) {
+        BenchmarkGridCompositor();
+    }
+    if (!only || strcmp(only, "archive") == 0) {
+        BenchmarkStreamArchive();
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+//
+//  LumaDownscalerBenchmark.c
+//  tests
+//
+//  亮度降采样基准：各实现在常见采集分辨率下的每帧耗时
+//
+//  用法：LumaDownscalerBenchmark [迭代次数]
+//
+
+#include "LumaDownscaler.h"
+#include "TestSupport.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    LumaDownscalerISA isa;
+} BenchmarkISA;
+
+static const BenchmarkISA benchmarkISAs[] = {
+    {"scalar", LumaDownscalerISAScalar},
+    {"NEON", LumaDownscalerISANEON},
+    {"SSE2", LumaDownscalerISASSE2},
+    {"AVX2", LumaDownscalerISAAVX2},
+};
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 500;
+    static const size_t sizes[][2] = {{640, 360}, {1280, 720}, {1920, 1080}};
+    unsigned seed = 3;
+    printf("%-10s %-7s %10s %10s %8s\n", "size", "ISA", "ns/frame", "MPix/s", "speedup");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t width = sizes[s][0];
+        size_t height = sizes[s][1];
+        uint8_t *src = malloc(width * height);
+        uint8_t *dst = malloc((width / 2) * (height / 2));
+        for (size_t i = 0; i < width * height; i++) {
+            src[i] = (uint8_t)rand_r(&seed);
+        }
+        double scalarNs = 0;
+        for (size_t i = 0; i < sizeof(benchmarkISAs) / sizeof(benchmarkISAs[0]); i++) {
+            const BenchmarkISA *isa = &benchmarkISAs[i];
+            if (!LumaDownscaleHalfWithISA(isa->isa, src, width, width, height, dst, width / 2)) {
+                continue;
+            }
+            uint64_t best = UINT64_MAX;
+            for (int n = 0; n < iterations; n++) {
+                uint64_t start = TestNowNs();
+                LumaDownscaleHalfWithISA(isa->isa, src, width, width, height, dst, width / 2);
+                uint64_t elapsed = TestNowNs() - start;
+                if (elapsed < best) {
+                    best = elapsed;
+                }
+            }
+            if (isa->isa == LumaDownscalerISAScalar) {
+                scalarNs = (double)best;
+            }
+            char label[16];
+            snprintf(label, sizeof(label), "%zux%zu", width, height);
+            printf("%-10s %-7s %10llu %10.0f %7.1fx\n", label, isa->name, (unsigned long long)best,
+                   (double)(width * height) / (double)best * 1000.0, scalarNs / (double)best);
+        }
+        free(src);
+        free(dst);
+    }
+    return 0;
+}
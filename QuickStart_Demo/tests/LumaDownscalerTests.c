@@ -0,0 +1,132 @@
+//
+//  LumaDownscalerTests.c
+//  tests
+//
+//  亮度降采样：各 SIMD 实现与标量参考逐字节一致
+//
+
+#include "LumaDownscaler.h"
+#include "TestSupport.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const LumaDownscalerISA allISAs[] = {
+    LumaDownscalerISANEON,
+    LumaDownscalerISASSE2,
+    LumaDownscalerISAAVX2,
+};
+
+static const char *ISAName(LumaDownscalerISA isa) {
+    switch (isa) {
+        case LumaDownscalerISAScalar: return "scalar";
+        case LumaDownscalerISANEON: return "NEON";
+        case LumaDownscalerISASSE2: return "SSE2";
+        case LumaDownscalerISAAVX2: return "AVX2";
+    }
+    return "?";
+}
+
+static void FillRandom(uint8_t *buffer, size_t length, unsigned *seed) {
+    for (size_t i = 0; i < length; i++) {
+        buffer[i] = (uint8_t)rand_r(seed);
+    }
+}
+
+/// 对比一种尺寸下所有可用实现，dst 行尾留出哨兵字节检查越界写
+static void CheckSize(size_t width, size_t height, size_t srcPadding, unsigned *seed) {
+    size_t srcStride = width + srcPadding;
+    size_t dstWidth = width / 2;
+    size_t dstHeight = height / 2;
+    size_t dstStride = dstWidth + 7;
+    uint8_t *src = malloc(srcStride * height + 1);
+    uint8_t *expected = malloc(dstStride * dstHeight + 1);
+    uint8_t *actual = malloc(dstStride * dstHeight + 1);
+    FillRandom(src, srcStride * height, seed);
+    memset(expected, 0xA5, dstStride * dstHeight + 1);
+    LumaDownscaleHalf_C(src, srcStride, width, height, expected, dstStride);
+    for (size_t i = 0; i < sizeof(allISAs) / sizeof(allISAs[0]); i++) {
+        memset(actual, 0xA5, dstStride * dstHeight + 1);
+        if (!LumaDownscaleHalfWithISA(allISAs[i], src, srcStride, width, height, actual, dstStride)) {
+            continue;
+        }
+        if (memcmp(expected, actual, dstStride * dstHeight + 1) != 0) {
+            fprintf(stderr, "%s mismatch at %zux%zu stride %zu\n", ISAName(allISAs[i]), width, height, srcStride);
+            TEST_CHECK(false);
+        }
+    }
+    free(src);
+    free(expected);
+    free(actual);
+}
+
+static void TestExtremeValues(void) {
+    // 全 255 时 16 位累加与打包不能饱和出错；0/255 交错检查舍入
+    size_t width = 256;
+    size_t height = 4;
+    uint8_t src[256 * 4];
+    uint8_t expected[128 * 2];
+    uint8_t actual[128 * 2];
+    for (int pattern = 0; pattern < 3; pattern++) {
+        for (size_t i = 0; i < sizeof(src); i++) {
+            src[i] = pattern == 0 ? 255 : pattern == 1 ? 0 : (uint8_t)((i & 1) ? 255 : (i % 3 ? 1 : 0));
+        }
+        LumaDownscaleHalf_C(src, width, width, height, expected, width / 2);
+        for (size_t i = 0; i < sizeof(allISAs) / sizeof(allISAs[0]); i++) {
+            if (LumaDownscaleHalfWithISA(allISAs[i], src, width, width, height, actual, width / 2)) {
+                TEST_CHECK(memcmp(expected, actual, sizeof(expected)) == 0);
+            }
+        }
+    }
+    TEST_CHECK(expected[0] == 64 || expected[0] == 128);
+}
+
+static void TestRandomSizes(void) {
+    unsigned seed = 7;
+    // 覆盖各 SIMD 宽度的整块、尾部与奇数宽高
+    static const size_t widths[] = {2, 3, 30, 31, 32, 33, 63, 64, 65, 127, 130, 360, 641, 1280};
+    static const size_t heights[] = {2, 3, 5, 16, 17, 72};
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        for (size_t h = 0; h < sizeof(heights) / sizeof(heights[0]); h++) {
+            CheckSize(widths[w], heights[h], 0, &seed);
+            CheckSize(widths[w], heights[h], 13, &seed);
+        }
+    }
+}
+
+static void TestQuarterMatchesTwoScalarPasses(void) {
+    unsigned seed = 11;
+    size_t width = 1280;
+    size_t height = 720;
+    uint8_t *src = malloc(width * height);
+    uint8_t *half = malloc((width / 2) * (height / 2));
+    uint8_t *expected = malloc((width / 4) * (height / 4));
+    uint8_t *actual = malloc((width / 4) * (height / 4));
+    uint8_t *scratch = malloc((width / 2) * (height / 2));
+    FillRandom(src, width * height, &seed);
+    LumaDownscaleHalf_C(src, width, width, height, half, width / 2);
+    LumaDownscaleHalf_C(half, width / 2, width / 2, height / 2, expected, width / 4);
+    LumaDownscaleQuarter(src, width, width, height, actual, width / 4, scratch);
+    TEST_CHECK(memcmp(expected, actual, (width / 4) * (height / 4)) == 0);
+    free(src);
+    free(half);
+    free(expected);
+    free(actual);
+    free(scratch);
+}
+
+static void TestActiveISAIsAvailable(void) {
+    uint8_t src[64] = {0};
+    uint8_t dst[16];
+    LumaDownscalerISA isa = LumaDownscalerActiveISA();
+    printf("  active ISA: %s\n", ISAName(isa));
+    TEST_CHECK(LumaDownscaleHalfWithISA(isa, src, 16, 16, 4, dst, 8));
+}
+
+int main(void) {
+    TEST_RUN(TestActiveISAIsAvailable);
+    TEST_RUN(TestExtremeValues);
+    TEST_RUN(TestRandomSizes);
+    TEST_RUN(TestQuarterMatchesTwoScalarPasses);
+    return TEST_RESULT();
+}
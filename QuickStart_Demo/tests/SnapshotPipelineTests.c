@@ -0,0 +1,421 @@
+//
+//  SnapshotPipelineTests.c
+//  tests
+//
+//  截图流水线：配置检查、请求计数、各降采样倍数与直接编码逐字节一致、超出 maxPixels 时自动降采样或放弃、
+//  槽位占满时顺延、停止时编码完已截取的帧，以及截取不分配内存
+//
+
+#include "JpegEncoder.h"
+#include "LumaDownscaler.h"
+#include "SnapshotPipeline.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+    CollectorMaxImages = 16,
+    CollectorMaxBytes = 256 * 1024,
+};
+
+/// 在编码线程收集回调结果；数据只在回调期间有效，拷贝到预分配的缓冲
+typedef struct {
+    pthread_mutex_t mutex;
+    SnapshotImage images[CollectorMaxImages];
+    uint8_t *data[CollectorMaxImages];
+    int count;
+    /// 为 true 时回调等待放行，模拟编码线程跟不上
+    _Atomic bool gate;
+    _Atomic int entered;
+} Collector;
+
+static void CollectorInit(Collector *collector) {
+    memset(collector, 0, sizeof(*collector));
+    pthread_mutex_init(&collector->mutex, NULL);
+    for (int i = 0; i < CollectorMaxImages; i++) {
+        collector->data[i] = malloc(CollectorMaxBytes);
+    }
+}
+
+static void CollectorDestroy(Collector *collector) {
+    for (int i = 0; i < CollectorMaxImages; i++) {
+        free(collector->data[i]);
+    }
+    pthread_mutex_destroy(&collector->mutex);
+}
+
+static void TestSleepMs(long milliseconds) {
+    struct timespec interval = {.tv_sec = milliseconds / 1000, .tv_nsec = (milliseconds % 1000) * 1000000};
+    nanosleep(&interval, NULL);
+}
+
+static void CollectorCallback(void *context, const SnapshotImage *image) {
+    Collector *collector = context;
+    atomic_fetch_add(&collector->entered, 1);
+    while (atomic_load(&collector->gate)) {
+        TestSleepMs(1);
+    }
+    pthread_mutex_lock(&collector->mutex);
+    if (collector->count < CollectorMaxImages && image->size <= CollectorMaxBytes) {
+        memcpy(collector->data[collector->count], image->data, image->size);
+        collector->images[collector->count] = *image;
+        collector->images[collector->count].data = collector->data[collector->count];
+        collector->count++;
+    }
+    pthread_mutex_unlock(&collector->mutex);
+}
+
+static int CollectorCount(Collector *collector) {
+    pthread_mutex_lock(&collector->mutex);
+    int count = collector->count;
+    pthread_mutex_unlock(&collector->mutex);
+    return count;
+}
+
+/// 等待编码线程输出 count 张，最多 5 秒
+static bool CollectorWait(Collector *collector, int count) {
+    for (int i = 0; i < 5000; i++) {
+        if (CollectorCount(collector) >= count) {
+            return true;
+        }
+        TestSleepMs(1);
+    }
+    return false;
+}
+
+typedef struct {
+    uint8_t *pixels;
+    GridI420Image image;
+} TestFrame;
+
+/// 行字节数大于宽度的 I420 帧，内容随位置与 seed 变化
+static TestFrame TestFrameCreate(int width, int height, uint32_t seed) {
+    TestFrame frame;
+    size_t yStride = (size_t)width + 24;
+    size_t cStride = (size_t)width / 2 + 40;
+    size_t ySize = yStride * (size_t)height;
+    size_t cSize = cStride * (size_t)height / 2;
+    frame.pixels = malloc(ySize + cSize * 2);
+    memset(frame.pixels, 0xEE, ySize + cSize * 2);
+    frame.image = (GridI420Image){
+        .y = frame.pixels,
+        .u = frame.pixels + ySize,
+        .v = frame.pixels + ySize + cSize,
+        .yStride = yStride,
+        .uStride = cStride,
+        .vStride = cStride,
+        .width = width,
+        .height = height,
+    };
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            frame.image.y[(size_t)y * yStride + (size_t)x] = (uint8_t)(16 + (x * 3 + y * 2 + seed * 17) % 220);
+        }
+    }
+    for (int y = 0; y < height / 2; y++) {
+        for (int x = 0; x < width / 2; x++) {
+            frame.image.u[(size_t)y * cStride + (size_t)x] = (uint8_t)(64 + (x + seed * 5) % 128);
+            frame.image.v[(size_t)y * cStride + (size_t)x] = (uint8_t)(64 + (y * 2 + seed * 7) % 128);
+        }
+    }
+    return frame;
+}
+
+/// 参考结果：先按倍数降采样到紧凑的 I420，再直接编码
+static size_t TestReferenceJpeg(const GridI420Image *frame, SnapshotScale scale, const SnapshotPipelineConfig *config,
+                                uint8_t *out, size_t capacity) {
+    int width = (frame->width >> scale) & ~1;
+    int height = (frame->height >> scale) & ~1;
+    size_t lumaSize = (size_t)width * (size_t)height;
+    uint8_t *pixels = malloc(lumaSize * 3 / 2);
+    uint8_t *scratch = malloc((size_t)frame->width * (size_t)frame->height);
+    GridI420Image image = {
+        .y = pixels,
+        .u = pixels + lumaSize,
+        .v = pixels + lumaSize + lumaSize / 4,
+        .yStride = (size_t)width,
+        .uStride = (size_t)width / 2,
+        .vStride = (size_t)width / 2,
+        .width = width,
+        .height = height,
+    };
+    const uint8_t *sources[3] = {frame->y, frame->u, frame->v};
+    size_t sourceStrides[3] = {frame->yStride, frame->uStride, frame->vStride};
+    uint8_t *targets[3] = {image.y, image.u, image.v};
+    for (int c = 0; c < 3; c++) {
+        size_t targetWidth = c == 0 ? (size_t)width : (size_t)width / 2;
+        size_t targetHeight = c == 0 ? (size_t)height : (size_t)height / 2;
+        size_t sourceWidth = targetWidth << scale;
+        size_t sourceHeight = targetHeight << scale;
+        switch (scale) {
+            case SnapshotScaleFull:
+                for (size_t y = 0; y < targetHeight; y++) {
+                    memcpy(targets[c] + y * targetWidth, sources[c] + y * sourceStrides[c], targetWidth);
+                }
+                break;
+            case SnapshotScaleHalf:
+                LumaDownscaleHalf(sources[c], sourceStrides[c], sourceWidth, sourceHeight, targets[c], targetWidth);
+                break;
+            case SnapshotScaleQuarter:
+                LumaDownscaleQuarter(sources[c], sourceStrides[c], sourceWidth, sourceHeight, targets[c], targetWidth,
+                                     scratch);
+                break;
+        }
+    }
+    JpegEncoder *encoder = JpegEncoderCreate(config->quality);
+    size_t size = JpegEncoderEncodeI420(encoder, &image, config->videoRange, out, capacity);
+    JpegEncoderDestroy(encoder);
+    free(scratch);
+    free(pixels);
+    return size;
+}
+
+static void TestConfig(void) {
+    SnapshotPipelineConfig config = SnapshotPipelineDefaultConfig();
+    TEST_CHECK(config.maxPixels == 1280 * 720 && config.slotCount == 3 && config.quality == 80 &&
+               config.videoRange && config.pollIntervalMs == 10);
+    Collector collector;
+    CollectorInit(&collector);
+    TEST_CHECK(SnapshotPipelineCreate(NULL, CollectorCallback, &collector) == NULL);
+    TEST_CHECK(SnapshotPipelineCreate(&config, NULL, &collector) == NULL);
+    SnapshotPipelineConfig invalid = config;
+    invalid.slotCount = 0;
+    TEST_CHECK(SnapshotPipelineCreate(&invalid, CollectorCallback, &collector) == NULL);
+    invalid = config;
+    invalid.quality = 0;
+    TEST_CHECK(SnapshotPipelineCreate(&invalid, CollectorCallback, &collector) == NULL);
+    invalid.quality = 101;
+    TEST_CHECK(SnapshotPipelineCreate(&invalid, CollectorCallback, &collector) == NULL);
+    invalid = config;
+    invalid.maxPixels = 3;
+    TEST_CHECK(SnapshotPipelineCreate(&invalid, CollectorCallback, &collector) == NULL);
+    invalid = config;
+    invalid.pollIntervalMs = 0;
+    TEST_CHECK(SnapshotPipelineCreate(&invalid, CollectorCallback, &collector) == NULL);
+
+    SnapshotPipeline *pipeline = SnapshotPipelineCreate(&config, CollectorCallback, &collector);
+    TEST_CHECK(pipeline != NULL);
+    SnapshotPipelineDestroy(pipeline);
+    SnapshotPipelineDestroy(NULL);
+    TEST_CHECK(CollectorCount(&collector) == 0);
+    CollectorDestroy(&collector);
+}
+
+/// 只截取请求的帧数；请求累加，非法请求忽略
+static void TestRequestCounting(void) {
+    SnapshotPipelineConfig config = SnapshotPipelineDefaultConfig();
+    config.slotCount = 4;
+    Collector collector;
+    CollectorInit(&collector);
+    SnapshotPipeline *pipeline = SnapshotPipelineCreate(&config, CollectorCallback, &collector);
+    TestFrame frame = TestFrameCreate(64, 48, 1);
+
+    TEST_CHECK(!SnapshotPipelineWantsFrame(pipeline));
+    TEST_CHECK(!SnapshotPipelineCapture(pipeline, &frame.image, 0, 0));
+    SnapshotPipelineRequest(pipeline, 0, SnapshotScaleFull);
+    SnapshotPipelineRequest(pipeline, 5, (SnapshotScale)3);
+    TEST_CHECK(!SnapshotPipelineWantsFrame(pipeline));
+
+    SnapshotPipelineRequest(pipeline, 1, SnapshotScaleFull);
+    SnapshotPipelineRequest(pipeline, 2, SnapshotScaleFull);
+    SnapshotPipelineStats stats;
+    SnapshotPipelineGetStats(pipeline, &stats);
+    TEST_CHECK(stats.pendingFrames == 3);
+    int captured = 0;
+    for (int i = 0; i < 6; i++) {
+        captured += SnapshotPipelineCapture(pipeline, &frame.image, 0, i) ? 1 : 0;
+    }
+    TEST_CHECK(captured == 3);
+    TEST_CHECK(!SnapshotPipelineWantsFrame(pipeline));
+    TEST_CHECK(CollectorWait(&collector, 3));
+    SnapshotPipelineGetStats(pipeline, &stats);
+    TEST_CHECK(stats.capturedFrames == 3 && stats.pendingFrames == 0 && stats.busyFrames == 0);
+    TEST_CHECK(stats.encodedFrames == 3 && stats.encodeErrors == 0 && stats.encodedBytes > 0);
+    TEST_CHECK(stats.captureNsMax > 0 && stats.captureNsTotal >= stats.captureNsMax);
+    TEST_CHECK(stats.encodeNsMax > 0 && stats.encodeNsTotal >= stats.encodeNsMax);
+    SnapshotPipelineDestroy(pipeline);
+    free(frame.pixels);
+    CollectorDestroy(&collector);
+}
+
+/// 各降采样倍数的输出与先降采样再直接编码逐字节一致；旋转与时间戳原样传出，按截取顺序回调
+static void TestScalesMatchReference(void) {
+    SnapshotPipelineConfig config = SnapshotPipelineDefaultConfig();
+    config.quality = 90;
+    Collector collector;
+    CollectorInit(&collector);
+    SnapshotPipeline *pipeline = SnapshotPipelineCreate(&config, CollectorCallback, &collector);
+    TestFrame frame = TestFrameCreate(328, 248, 2);
+    SnapshotScale scales[] = {SnapshotScaleFull, SnapshotScaleHalf, SnapshotScaleQuarter};
+    int rotations[] = {0, 90, 270};
+    for (int i = 0; i < 3; i++) {
+        SnapshotPipelineRequest(pipeline, 1, scales[i]);
+        TEST_CHECK(SnapshotPipelineCapture(pipeline, &frame.image, rotations[i], 1000000 + i * 33333));
+    }
+    SnapshotPipelineStop(pipeline);
+    TEST_CHECK(CollectorCount(&collector) == 3);
+
+    // 停止后不再截取
+    SnapshotPipelineRequest(pipeline, 1, SnapshotScaleFull);
+    TEST_CHECK(!SnapshotPipelineCapture(pipeline, &frame.image, 0, 0));
+
+    static uint8_t reference[CollectorMaxBytes];
+    int widths[] = {328, 164, 82};
+    int heights[] = {248, 124, 62};
+    for (int i = 0; i < 3 && i < collector.count; i++) {
+        const SnapshotImage *image = &collector.images[i];
+        TEST_CHECK(image->sequence == (uint64_t)i);
+        TEST_CHECK(image->width == widths[i] && image->height == heights[i]);
+        TEST_CHECK(image->rotation == rotations[i] && image->timestampUs == 1000000 + i * 33333);
+        size_t size = TestReferenceJpeg(&frame.image, scales[i], &config, reference, sizeof(reference));
+        TEST_CHECK(size > 0 && image->size == size && memcmp(image->data, reference, size) == 0);
+    }
+    SnapshotPipelineDestroy(pipeline);
+    free(frame.pixels);
+    CollectorDestroy(&collector);
+}
+
+/// 超出 maxPixels 时加大降采样倍数；1/4 仍超出时放弃该次请求并计数
+static void TestOversized(void) {
+    SnapshotPipelineConfig config = SnapshotPipelineDefaultConfig();
+    config.maxPixels = 64 * 64;
+    Collector collector;
+    CollectorInit(&collector);
+    SnapshotPipeline *pipeline = SnapshotPipelineCreate(&config, CollectorCallback, &collector);
+
+    TestFrame large = TestFrameCreate(320, 240, 3);
+    SnapshotPipelineRequest(pipeline, 1, SnapshotScaleFull);
+    TEST_CHECK(!SnapshotPipelineCapture(pipeline, &large.image, 0, 0));
+    SnapshotPipelineStats stats;
+    SnapshotPipelineGetStats(pipeline, &stats);
+    TEST_CHECK(stats.oversizedFrames == 1 && stats.pendingFrames == 0 && stats.capturedFrames == 0);
+
+    TestFrame medium = TestFrameCreate(160, 120, 4);
+    SnapshotPipelineRequest(pipeline, 1, SnapshotScaleFull);
+    TEST_CHECK(SnapshotPipelineCapture(pipeline, &medium.image, 0, 0));
+    // 源图太小，降采样后不足 2x2
+    TestFrame tiny = TestFrameCreate(2, 2, 5);
+    SnapshotPipelineRequest(pipeline, 1, SnapshotScaleHalf);
+    TEST_CHECK(!SnapshotPipelineCapture(pipeline, &tiny.image, 0, 0));
+    SnapshotPipelineStop(pipeline);
+    TEST_CHECK(CollectorCount(&collector) == 1);
+    TEST_CHECK(collector.images[0].width == 40 && collector.images[0].height == 30);
+    static uint8_t reference[CollectorMaxBytes];
+    size_t size = TestReferenceJpeg(&medium.image, SnapshotScaleQuarter, &config, reference, sizeof(reference));
+    TEST_CHECK(collector.images[0].size == size && memcmp(collector.images[0].data, reference, size) == 0);
+    SnapshotPipelineGetStats(pipeline, &stats);
+    TEST_CHECK(stats.oversizedFrames == 2 && stats.pendingFrames == 0);
+
+    SnapshotPipelineDestroy(pipeline);
+    free(large.pixels);
+    free(medium.pixels);
+    free(tiny.pixels);
+    CollectorDestroy(&collector);
+}
+
+/// 唯一的槽位在编码时，新帧顺延且请求保留，槽位释放后截取下一帧
+static void TestBusySlots(void) {
+    SnapshotPipelineConfig config = SnapshotPipelineDefaultConfig();
+    config.slotCount = 1;
+    config.pollIntervalMs = 1;
+    Collector collector;
+    CollectorInit(&collector);
+    atomic_store(&collector.gate, true);
+    SnapshotPipeline *pipeline = SnapshotPipelineCreate(&config, CollectorCallback, &collector);
+    TestFrame frame = TestFrameCreate(96, 64, 6);
+
+    SnapshotPipelineRequest(pipeline, 2, SnapshotScaleFull);
+    TEST_CHECK(SnapshotPipelineCapture(pipeline, &frame.image, 0, 1));
+    TEST_CHECK(!SnapshotPipelineCapture(pipeline, &frame.image, 0, 2));
+    TEST_CHECK(!SnapshotPipelineCapture(pipeline, &frame.image, 0, 3));
+    SnapshotPipelineStats stats;
+    SnapshotPipelineGetStats(pipeline, &stats);
+    TEST_CHECK(stats.busyFrames == 2 && stats.capturedFrames == 1 && stats.pendingFrames == 1);
+
+    atomic_store(&collector.gate, false);
+    int64_t timestamp = 4;
+    for (int i = 0; i < 5000 && !SnapshotPipelineCapture(pipeline, &frame.image, 0, timestamp); i++) {
+        TestSleepMs(1);
+        timestamp++;
+    }
+    TEST_CHECK(CollectorWait(&collector, 2));
+    TEST_CHECK(collector.images[0].timestampUs == 1 && collector.images[1].timestampUs == timestamp);
+    TEST_CHECK(collector.images[1].sequence == 1);
+    SnapshotPipelineGetStats(pipeline, &stats);
+    TEST_CHECK(stats.capturedFrames == 2 && stats.pendingFrames == 0 && stats.busyFrames >= 2);
+    printf("  %llu busy frames\n", (unsigned long long)stats.busyFrames);
+    SnapshotPipelineDestroy(pipeline);
+    free(frame.pixels);
+    CollectorDestroy(&collector);
+}
+
+/// 编码线程休眠期间停止，已截取的帧仍全部编码
+static void TestStopDrains(void) {
+    SnapshotPipelineConfig config = SnapshotPipelineDefaultConfig();
+    config.pollIntervalMs = 200;
+    Collector collector;
+    CollectorInit(&collector);
+    SnapshotPipeline *pipeline = SnapshotPipelineCreate(&config, CollectorCallback, &collector);
+    TestFrame frame = TestFrameCreate(128, 96, 7);
+    // 等编码线程第一次检查完槽位进入休眠
+    TestSleepMs(20);
+    SnapshotPipelineRequest(pipeline, 3, SnapshotScaleHalf);
+    for (int i = 0; i < 3; i++) {
+        TEST_CHECK(SnapshotPipelineCapture(pipeline, &frame.image, 0, i));
+    }
+    SnapshotPipelineStop(pipeline);
+    TEST_CHECK(CollectorCount(&collector) == 3);
+    for (int i = 0; i < 3 && i < collector.count; i++) {
+        TEST_CHECK(collector.images[i].sequence == (uint64_t)i && collector.images[i].timestampUs == i);
+    }
+    SnapshotPipelineStop(pipeline);
+    SnapshotPipelineDestroy(pipeline);
+    free(frame.pixels);
+    CollectorDestroy(&collector);
+}
+
+/// 处理线程上的截取不分配内存，720p 源图的耗时
+static void TestCaptureNoAllocation(void) {
+    SnapshotPipelineConfig config = SnapshotPipelineDefaultConfig();
+    config.pollIntervalMs = 1;
+    Collector collector;
+    CollectorInit(&collector);
+    SnapshotPipeline *pipeline = SnapshotPipelineCreate(&config, CollectorCallback, &collector);
+    TestFrame frame = TestFrameCreate(1280, 720, 8);
+    SnapshotScale scales[] = {SnapshotScaleFull, SnapshotScaleHalf, SnapshotScaleQuarter};
+    int captured = 0;
+    uint64_t allocations = TestAllocCount();
+    for (int i = 0; i < 3; i++) {
+        SnapshotPipelineRequest(pipeline, 1, scales[i]);
+        for (int attempt = 0; attempt < 5000 && !SnapshotPipelineCapture(pipeline, &frame.image, 0, i); attempt++) {
+            TestSleepMs(1);
+        }
+        captured++;
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    TEST_CHECK(CollectorWait(&collector, captured));
+    SnapshotPipelineStats stats;
+    SnapshotPipelineGetStats(pipeline, &stats);
+    TEST_CHECK(stats.capturedFrames == 3);
+    printf("  capture max %.2f ms, encode max %.2f ms, %llu bytes\n", (double)stats.captureNsMax / 1e6,
+           (double)stats.encodeNsMax / 1e6, (unsigned long long)stats.encodedBytes);
+    SnapshotPipelineDestroy(pipeline);
+    free(frame.pixels);
+    CollectorDestroy(&collector);
+}
+
+int main(void) {
+    TEST_RUN(TestConfig);
+    TEST_RUN(TestRequestCounting);
+    TEST_RUN(TestScalesMatchReference);
+    TEST_RUN(TestOversized);
+    TEST_RUN(TestBusySlots);
+    TEST_RUN(TestStopDrains);
+    TEST_RUN(TestCaptureNoAllocation);
+    return TEST_RESULT();
+}
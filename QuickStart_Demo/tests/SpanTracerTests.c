@@ -0,0 +1,253 @@
+//
+//  SpanTracerTests.c
+//  tests
+//
+//  启动追踪：区间嵌套与导出格式、名称转义、事件上限、reset，以及多线程记录时并发导出
+//
+
+#include "SpanTracer.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// 导出的一个事件
+typedef struct {
+    char name[64];
+    char phase;
+    double ts;
+    double dur;
+    unsigned long long tid;
+} TraceEvent;
+
+static char tracePath[] = "/tmp/SpanTracerTestsXXXXXX";
+
+static char *ReadTrace(void) {
+    FILE *file = fopen(tracePath, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc((size_t)size + 1);
+    size_t length = fread(text, 1, (size_t)size, file);
+    text[length] = '\0';
+    fclose(file);
+    return text;
+}
+
+/// 导出后逐行解析事件（导出每行一个事件），返回事件数，格式不符时返回 -1
+static int ExportAndParse(TraceEvent *events, int maxEvents) {
+    if (!SpanTraceWriteChromeTrace(tracePath)) {
+        return -1;
+    }
+    char *text = ReadTrace();
+    if (!text || strncmp(text, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39) != 0 || !strstr(text, "\n]}\n")) {
+        free(text);
+        return -1;
+    }
+    int count = 0;
+    for (char *line = strstr(text, "\n{\"name\":"); line; line = strstr(line + 1, "\n{\"name\":")) {
+        if (count >= maxEvents) {
+            count++;
+            continue;
+        }
+        TraceEvent *event = &events[count++];
+        memset(event, 0, sizeof(*event));
+        // 名称可能含转义，测试只比较转义后的原文
+        const char *nameStart = line + strlen("\n{\"name\":\"");
+        const char *nameEnd = strstr(nameStart, "\",\"cat\":\"startup\"");
+        if (!nameEnd || nameEnd - nameStart >= (long)sizeof(event->name)) {
+            free(text);
+            return -1;
+        }
+        memcpy(event->name, nameStart, (size_t)(nameEnd - nameStart));
+        if (sscanf(nameEnd, "\",\"cat\":\"startup\",\"ph\":\"%c\",\"ts\":%lf,\"pid\":1,\"tid\":%llu",
+                   &event->phase, &event->ts, &event->tid) != 3) {
+            free(text);
+            return -1;
+        }
+        const char *dur = strstr(nameEnd, ",\"dur\":");
+        const char *lineEnd = strchr(nameEnd, '\n');
+        if (event->phase == 'X' && dur && (!lineEnd || dur < lineEnd)) {
+            event->dur = strtod(dur + strlen(",\"dur\":"), NULL);
+        }
+    }
+    free(text);
+    return count;
+}
+
+static const TraceEvent *FindEvent(const TraceEvent *events, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(events[i].name, name) == 0) {
+            return &events[i];
+        }
+    }
+    return NULL;
+}
+
+static void SpinNs(uint64_t ns) {
+    uint64_t start = TestNowNs();
+    while (TestNowNs() - start < ns) {
+    }
+}
+
+/// 内层区间先结束先记录，时间上包含在外层区间内
+static void TestNestedScopes(void) {
+    SpanTraceReset();
+    {
+        SPAN_TRACE_SCOPE("outer");
+        SpinNs(200000);
+        {
+            SPAN_TRACE_SCOPE("inner");
+            SpinNs(500000);
+        }
+        SPAN_TRACE_INSTANT("marker");
+        SpinNs(200000);
+    }
+    TEST_CHECK(SpanTraceEventCount() == 3);
+
+    TraceEvent events[8];
+    int count = ExportAndParse(events, 8);
+    TEST_CHECK(count == 3);
+    if (count != 3) {
+        return;
+    }
+    TEST_CHECK(strcmp(events[0].name, "inner") == 0);
+    const TraceEvent *outer = FindEvent(events, count, "outer");
+    const TraceEvent *inner = FindEvent(events, count, "inner");
+    const TraceEvent *marker = FindEvent(events, count, "marker");
+    TEST_CHECK(outer && inner && marker);
+    if (!outer || !inner || !marker) {
+        return;
+    }
+    TEST_CHECK(outer->phase == 'X' && inner->phase == 'X' && marker->phase == 'i');
+    // 时间单位为微秒
+    TEST_CHECK(inner->dur >= 500.0);
+    TEST_CHECK(outer->dur >= inner->dur + 400.0);
+    TEST_CHECK(inner->ts >= outer->ts);
+    TEST_CHECK(inner->ts + inner->dur <= outer->ts + outer->dur);
+    TEST_CHECK(marker->ts >= inner->ts + inner->dur && marker->ts <= outer->ts + outer->dur);
+    TEST_CHECK(outer->tid == inner->tid && inner->tid == marker->tid);
+}
+
+/// 同一区间结束两次只记录一次
+static void TestEndTwice(void) {
+    SpanTraceReset();
+    SpanTraceScope scope = SpanTraceBegin("once");
+    SpanTraceEnd(&scope);
+    SpanTraceEnd(&scope);
+    TEST_CHECK(SpanTraceEventCount() == 1);
+}
+
+/// 引号、反斜杠与控制字符按 JSON 转义
+static void TestNameEscaping(void) {
+    SpanTraceReset();
+    SPAN_TRACE_INSTANT("say \"hi\"\\\n");
+    TraceEvent events[2];
+    int count = ExportAndParse(events, 2);
+    TEST_CHECK(count == 1);
+    if (count == 1) {
+        TEST_CHECK(strcmp(events[0].name, "say \\\"hi\\\"\\\\\\u000a") == 0);
+    }
+}
+
+/// 超出上限的事件被丢弃，计数停在上限
+static void TestEventLimit(void) {
+    SpanTraceReset();
+    for (int i = 0; i < SPAN_TRACE_MAX_EVENTS + 100; i++) {
+        SPAN_TRACE_INSTANT("tick");
+    }
+    TEST_CHECK(SpanTraceEventCount() == SPAN_TRACE_MAX_EVENTS);
+    TEST_CHECK(ExportAndParse(NULL, 0) == SPAN_TRACE_MAX_EVENTS);
+
+    SpanTraceReset();
+    TEST_CHECK(SpanTraceEventCount() == 0);
+    TEST_CHECK(ExportAndParse(NULL, 0) == 0);
+}
+
+static void TestWriteFailure(void) {
+    TEST_CHECK(!SpanTraceWriteChromeTrace("/nonexistent-directory/trace.json"));
+}
+
+enum {
+    WriterThreads = 4,
+    EventsPerThread = 800,
+};
+
+static _Atomic int writersDone;
+static _Atomic int exportsDone;
+
+static void *WriterThread(void *argument) {
+    for (int i = 0; i < EventsPerThread; i++) {
+        SPAN_TRACE_SCOPE("worker");
+        if (i == EventsPerThread / 2) {
+            // 记录到一半时等主线程导出几次，保证导出与记录重叠
+            while (atomic_load(&exportsDone) < 3) {
+            }
+        }
+    }
+    atomic_fetch_add(&writersDone, 1);
+    return NULL;
+}
+
+/// 多线程记录时并发导出：导出的总是格式完整、已写完的事件
+static void TestConcurrentRecordAndExport(void) {
+    SpanTraceReset();
+    atomic_store(&writersDone, 0);
+    atomic_store(&exportsDone, 0);
+    pthread_t threads[WriterThreads];
+    for (int i = 0; i < WriterThreads; i++) {
+        pthread_create(&threads[i], NULL, WriterThread, NULL);
+    }
+    TraceEvent *events = malloc(sizeof(TraceEvent) * SPAN_TRACE_MAX_EVENTS);
+    while (atomic_load(&writersDone) < WriterThreads) {
+        int count = ExportAndParse(events, SPAN_TRACE_MAX_EVENTS);
+        TEST_CHECK(count >= 0 && count <= WriterThreads * EventsPerThread);
+        for (int i = 0; i < count; i++) {
+            TEST_CHECK(strcmp(events[i].name, "worker") == 0 && events[i].phase == 'X');
+        }
+        atomic_fetch_add(&exportsDone, 1);
+    }
+    for (int i = 0; i < WriterThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    TEST_CHECK(SpanTraceEventCount() == WriterThreads * EventsPerThread);
+    int count = ExportAndParse(events, SPAN_TRACE_MAX_EVENTS);
+    TEST_CHECK(count == WriterThreads * EventsPerThread);
+    // 每个线程的事件带各自的线程号
+    unsigned long long tids[WriterThreads] = {0};
+    int distinct = 0;
+    for (int i = 0; i < count; i++) {
+        int known = 0;
+        for (int t = 0; t < distinct; t++) {
+            known |= tids[t] == events[i].tid;
+        }
+        if (!known && distinct < WriterThreads) {
+            tids[distinct++] = events[i].tid;
+        }
+    }
+    TEST_CHECK(distinct == WriterThreads);
+    free(events);
+    printf("  %d exports while recording\n", atomic_load(&exportsDone));
+}
+
+int main(void) {
+    int fd = mkstemp(tracePath);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+    TEST_RUN(TestNestedScopes);
+    TEST_RUN(TestEndTwice);
+    TEST_RUN(TestNameEscaping);
+    TEST_RUN(TestEventLimit);
+    TEST_RUN(TestWriteFailure);
+    TEST_RUN(TestConcurrentRecordAndExport);
+    unlink(tracePath);
+    return TEST_RESULT();
+}
@@ -0,0 +1,488 @@
+//
+//  StatsStoreTests.c
+//  tests
+//
+//  统计时间序列：配置与行数取整、来源登记、窗口聚合与分位数、覆盖最旧的行、
+//  并发写入时读取与导出不出现撕裂的行、写入不分配内存，以及导出文件与 CSV 转换
+//
+
+#include "StatsStore.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char testDirectory[64];
+
+static void TestConfig(void) {
+    StatsStoreConfig config = StatsStoreDefaultConfig();
+    TEST_CHECK(config.rowsPerMetric == 4096 && config.maxSources == 32);
+    StatsStoreConfig invalid = config;
+    invalid.rowsPerMetric = 0;
+    TEST_CHECK(StatsStoreCreate(&invalid) == NULL);
+    invalid.rowsPerMetric = (1u << 24) + 1;
+    TEST_CHECK(StatsStoreCreate(&invalid) == NULL);
+    invalid = config;
+    invalid.maxSources = 0;
+    TEST_CHECK(StatsStoreCreate(&invalid) == NULL);
+    invalid.maxSources = STATS_SOURCE_OTHER;
+    TEST_CHECK(StatsStoreCreate(&invalid) == NULL);
+    TEST_CHECK(StatsStoreCreate(NULL) == NULL);
+    StatsStoreDestroy(NULL);
+
+    TEST_CHECK(strcmp(StatsMetricName(StatsMetricCpuApp), "cpu_app") == 0);
+    TEST_CHECK(strcmp(StatsMetricName(StatsMetricLocalEncoderFps), "local_encoder_fps") == 0);
+    TEST_CHECK(strcmp(StatsMetricName(StatsMetricProcessTrackingMs), "process_tracking_ms") == 0);
+    TEST_CHECK(strcmp(StatsMetricName(StatsMetricCount), "unknown") == 0);
+
+    // 行数向上取整到 2 的幂
+    config.rowsPerMetric = 3000;
+    StatsStore *store = StatsStoreCreate(&config);
+    for (int i = 0; i < 5000; i++) {
+        StatsStoreRecord(store, StatsMetricCpuApp, STATS_SOURCE_LOCAL, i, (float)i);
+    }
+    StatsAggregate aggregate;
+    TEST_CHECK(StatsStoreAggregate(store, StatsMetricCpuApp, STATS_SOURCE_ANY, INT64_MIN, INT64_MAX, &aggregate));
+    TEST_CHECK(aggregate.count == 4096 && aggregate.min == 5000 - 4096 && aggregate.max == 4999);
+    TEST_CHECK(StatsStoreRecordedRows(store, StatsMetricCpuApp) == 5000);
+    TEST_CHECK(StatsStoreRecordedRows(store, StatsMetricCpuTotal) == 0);
+    TEST_CHECK(StatsStoreRecordedRows(store, StatsMetricCount) == 0);
+    // 非法指标的写入忽略
+    StatsStoreRecord(store, StatsMetricCount, STATS_SOURCE_LOCAL, 0, 1);
+    StatsStoreDestroy(store);
+
+    int64_t first = StatsStoreNowUs();
+    usleep(2000);
+    TEST_CHECK(StatsStoreNowUs() - first >= 2000);
+}
+
+/// 名称按出现顺序编号，截断到 63 字节后比较；来源表满后返回 STATS_SOURCE_OTHER
+static void TestSources(void) {
+    StatsStoreConfig config = StatsStoreDefaultConfig();
+    config.maxSources = 3;
+    StatsStore *store = StatsStoreCreate(&config);
+    TEST_CHECK(StatsStoreSourceForName(store, "alice") == 1);
+    TEST_CHECK(StatsStoreSourceForName(store, "bob") == 2);
+    TEST_CHECK(StatsStoreSourceForName(store, "alice") == 1);
+
+    char longName[100];
+    memset(longName, 'x', sizeof(longName) - 1);
+    longName[sizeof(longName) - 1] = '\0';
+    TEST_CHECK(StatsStoreSourceForName(store, longName) == 3);
+    longName[80] = 'y';
+    TEST_CHECK(StatsStoreSourceForName(store, longName) == 3);
+    longName[10] = 'y';
+    TEST_CHECK(StatsStoreSourceForName(store, longName) == STATS_SOURCE_OTHER);
+    TEST_CHECK(StatsStoreSourceForName(store, "carol") == STATS_SOURCE_OTHER);
+    TEST_CHECK(StatsStoreSourceForName(store, "bob") == 2);
+    StatsStoreDestroy(store);
+}
+
+enum {
+    SourceThreads = 4,
+    SourceNames = 24,
+};
+
+static StatsStore *sourceStore;
+static uint32_t sourceIds[SourceThreads][SourceNames];
+
+static void *SourceWorker(void *argument) {
+    int thread = (int)(intptr_t)argument;
+    // 各线程以不同顺序登记同一组名称，步长与名称数互质
+    static const int steps[SourceThreads] = {1, 5, 7, 11};
+    char name[16];
+    for (int round = 0; round < SourceNames; round++) {
+        int n = (round * steps[thread] + thread) % SourceNames;
+        snprintf(name, sizeof(name), "user%d", n);
+        sourceIds[thread][n] = StatsStoreSourceForName(sourceStore, name);
+        sched_yield();
+    }
+    return NULL;
+}
+
+/// 多个线程同时登记同一组名称，同一名称得到同一编号，不同名称不共用编号
+static void TestConcurrentSources(void) {
+    StatsStoreConfig config = StatsStoreDefaultConfig();
+    config.maxSources = SourceNames;
+    sourceStore = StatsStoreCreate(&config);
+    pthread_t threads[SourceThreads];
+    for (int t = 0; t < SourceThreads; t++) {
+        pthread_create(&threads[t], NULL, SourceWorker, (void *)(intptr_t)t);
+    }
+    for (int t = 0; t < SourceThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    bool consistent = true;
+    bool used[SourceNames + 1] = {false};
+    for (int n = 0; n < SourceNames; n++) {
+        uint32_t id = sourceIds[0][n];
+        for (int t = 1; t < SourceThreads; t++) {
+            consistent = consistent && sourceIds[t][n] == id;
+        }
+        consistent = consistent && id >= 1 && id <= SourceNames && !used[id];
+        if (id >= 1 && id <= SourceNames) {
+            used[id] = true;
+        }
+    }
+    TEST_CHECK(consistent);
+    TEST_CHECK(StatsStoreSourceForName(sourceStore, "late") == STATS_SOURCE_OTHER);
+    StatsStoreDestroy(sourceStore);
+}
+
+/// 均值、极值与最近秩分位数；窗口左闭右开，按来源过滤
+static void TestAggregate(void) {
+    StatsStoreConfig config = StatsStoreDefaultConfig();
+    StatsStore *store = StatsStoreCreate(&config);
+    StatsAggregate aggregate;
+    TEST_CHECK(!StatsStoreAggregate(store, StatsMetricLocalRttMs, STATS_SOURCE_ANY, INT64_MIN, INT64_MAX, &aggregate));
+    TEST_CHECK(aggregate.count == 0 && aggregate.max == 0);
+
+    // 乱序写入 1～100，时间为 1000 + 值
+    for (int i = 0; i < 100; i++) {
+        int value = (i * 37) % 100 + 1;
+        uint32_t source = value % 2 == 0 ? 1 : 2;
+        StatsStoreRecord(store, StatsMetricRemoteE2eDelayMs, source, 1000 + value, (float)value);
+    }
+    TEST_CHECK(StatsStoreAggregate(store, StatsMetricRemoteE2eDelayMs, STATS_SOURCE_ANY, INT64_MIN, INT64_MAX,
+                                   &aggregate));
+    TEST_CHECK(aggregate.count == 100 && aggregate.mean == 50.5f && aggregate.min == 1 && aggregate.max == 100);
+    TEST_CHECK(aggregate.p50 == 50 && aggregate.p95 == 95 && aggregate.p99 == 99);
+
+    TEST_CHECK(StatsStoreAggregate(store, StatsMetricRemoteE2eDelayMs, STATS_SOURCE_ANY, 1011, 1021, &aggregate));
+    TEST_CHECK(aggregate.count == 10 && aggregate.min == 11 && aggregate.max == 20);
+    TEST_CHECK(aggregate.p50 == 15 && aggregate.p99 == 20);
+    TEST_CHECK(!StatsStoreAggregate(store, StatsMetricRemoteE2eDelayMs, STATS_SOURCE_ANY, 1101, 2000, &aggregate));
+    TEST_CHECK(!StatsStoreAggregate(store, StatsMetricRemoteE2eDelayMs, STATS_SOURCE_ANY, 1050, 1050, &aggregate));
+
+    TEST_CHECK(StatsStoreAggregate(store, StatsMetricRemoteE2eDelayMs, 1, INT64_MIN, INT64_MAX, &aggregate));
+    TEST_CHECK(aggregate.count == 50 && aggregate.min == 2 && aggregate.max == 100 && aggregate.mean == 51);
+    TEST_CHECK(!StatsStoreAggregate(store, StatsMetricRemoteE2eDelayMs, 3, INT64_MIN, INT64_MAX, &aggregate));
+
+    // 单行时所有分位数都是该值
+    StatsStoreRecord(store, StatsMetricCpuTotal, STATS_SOURCE_LOCAL, 5, 0.25f);
+    TEST_CHECK(StatsStoreAggregate(store, StatsMetricCpuTotal, STATS_SOURCE_LOCAL, 0, 10, &aggregate));
+    TEST_CHECK(aggregate.count == 1 && aggregate.p50 == 0.25f && aggregate.p99 == 0.25f && aggregate.mean == 0.25f);
+    TEST_CHECK(!StatsStoreAggregate(store, StatsMetricCount, STATS_SOURCE_ANY, INT64_MIN, INT64_MAX, &aggregate));
+    StatsStoreDestroy(store);
+}
+
+/// 写满后只保留最近 rowsPerMetric 行，各指标互不影响；写入不分配内存
+static void TestOverwrite(void) {
+    StatsStoreConfig config = {.rowsPerMetric = 64, .maxSources = 4};
+    StatsStore *store = StatsStoreCreate(&config);
+    uint64_t allocations = TestAllocCount();
+    for (int i = 0; i < 1000; i++) {
+        StatsStoreRecord(store, StatsMetricProcessTotalMs, STATS_SOURCE_LOCAL, i, (float)i);
+        if (i % 10 == 0) {
+            StatsStoreRecord(store, StatsMetricProcessRenderMs, STATS_SOURCE_LOCAL, i, (float)i);
+        }
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    StatsAggregate aggregate;
+    TEST_CHECK(StatsStoreAggregate(store, StatsMetricProcessTotalMs, STATS_SOURCE_ANY, INT64_MIN, INT64_MAX,
+                                   &aggregate));
+    TEST_CHECK(aggregate.count == 64 && aggregate.min == 936 && aggregate.max == 999);
+    TEST_CHECK(StatsStoreAggregate(store, StatsMetricProcessRenderMs, STATS_SOURCE_ANY, INT64_MIN, INT64_MAX,
+                                   &aggregate));
+    TEST_CHECK(aggregate.count == 64 && aggregate.min == 360 && aggregate.max == 990);
+    TEST_CHECK(StatsStoreRecordedRows(store, StatsMetricProcessTotalMs) == 1000);
+    TEST_CHECK(StatsStoreRecordedRows(store, StatsMetricProcessRenderMs) == 100);
+    StatsStoreDestroy(store);
+}
+
+// Export
+
+typedef struct {
+    StatsStoreFileHeader header;
+    char names[8][STATS_SOURCE_NAME_MAX];
+    StatsStoreFileBlock blocks[StatsMetricCount];
+    int64_t *times[StatsMetricCount];
+    float *values[StatsMetricCount];
+    uint32_t *sources[StatsMetricCount];
+} TestExport;
+
+static void TestExportFree(TestExport *file) {
+    for (int m = 0; m < StatsMetricCount; m++) {
+        free(file->times[m]);
+        free(file->values[m]);
+        free(file->sources[m]);
+    }
+}
+
+/// 读回导出文件，来源数不超过 8
+static bool TestExportRead(const char *path, TestExport *file) {
+    memset(file, 0, sizeof(*file));
+    FILE *input = fopen(path, "rb");
+    if (!input) {
+        return false;
+    }
+    bool ok = fread(&file->header, sizeof(file->header), 1, input) == 1 && file->header.sourceCount <= 8 &&
+              file->header.metricCount == StatsMetricCount &&
+              fread(file->names, STATS_SOURCE_NAME_MAX, file->header.sourceCount, input) ==
+                  file->header.sourceCount;
+    for (int m = 0; ok && m < StatsMetricCount; m++) {
+        ok = fread(&file->blocks[m], sizeof(file->blocks[m]), 1, input) == 1;
+        size_t count = ok ? file->blocks[m].rowCount : 0;
+        file->times[m] = malloc(sizeof(int64_t) * (count + 1));
+        file->values[m] = malloc(sizeof(float) * (count + 1));
+        file->sources[m] = malloc(sizeof(uint32_t) * (count + 1));
+        ok = ok && fread(file->times[m], sizeof(int64_t), count, input) == count &&
+             fread(file->values[m], sizeof(float), count, input) == count &&
+             fread(file->sources[m], sizeof(uint32_t), count, input) == count;
+    }
+    ok = ok && fgetc(input) == EOF;
+    fclose(input);
+    return ok;
+}
+
+/// 导出文件的结构、各指标内按时间排列，以及转换出的 CSV
+static void TestExportAndCsv(void) {
+    StatsStoreConfig config = {.rowsPerMetric = 16, .maxSources = 2};
+    StatsStore *store = StatsStoreCreate(&config);
+    uint32_t alice = StatsStoreSourceForName(store, "alice");
+    // 时间乱序写入，导出时排序
+    int64_t times[] = {300, 100, 200, 500, 400};
+    for (int i = 0; i < 5; i++) {
+        StatsStoreRecord(store, StatsMetricRemoteRenderFps, i % 2 ? alice : STATS_SOURCE_OTHER, times[i],
+                         (float)times[i] / 10);
+    }
+    StatsStoreRecord(store, StatsMetricCpuApp, STATS_SOURCE_LOCAL, 250, 0.5f);
+
+    char binaryPath[128];
+    char csvPath[128];
+    snprintf(binaryPath, sizeof(binaryPath), "%s/stats.bin", testDirectory);
+    snprintf(csvPath, sizeof(csvPath), "%s/stats.csv", testDirectory);
+    TEST_CHECK(StatsStoreExport(store, binaryPath));
+    TestExport file;
+    TEST_CHECK(TestExportRead(binaryPath, &file));
+    TEST_CHECK(file.header.magic == STATS_STORE_FILE_MAGIC && file.header.version == STATS_STORE_FILE_VERSION);
+    TEST_CHECK(file.header.sourceCount == 2 && strcmp(file.names[0], "alice") == 0 && file.names[1][0] == '\0');
+    TEST_CHECK(file.header.monotonicToUnixUs > 1600000000ll * 1000000);
+    TEST_CHECK(file.blocks[StatsMetricRemoteRenderFps].rowCount == 5 &&
+               strcmp(file.blocks[StatsMetricRemoteRenderFps].name, "remote_render_fps") == 0);
+    bool sorted = true;
+    for (int i = 0; i < 5; i++) {
+        int64_t expected = 100 * (i + 1);
+        sorted = sorted && file.times[StatsMetricRemoteRenderFps][i] == expected &&
+                 file.values[StatsMetricRemoteRenderFps][i] == (float)expected / 10;
+    }
+    TEST_CHECK(sorted);
+    TEST_CHECK(file.blocks[StatsMetricCpuApp].rowCount == 1 && file.blocks[StatsMetricCpuTotal].rowCount == 0);
+    TestExportFree(&file);
+
+    TEST_CHECK(StatsStoreConvertToCsv(binaryPath, csvPath));
+    FILE *csv = fopen(csvPath, "r");
+    char line[256];
+    char lines[8][256];
+    int lineCount = 0;
+    while (csv && lineCount < 8 && fgets(line, sizeof(line), csv)) {
+        memcpy(lines[lineCount++], line, sizeof(line));
+    }
+    if (csv) {
+        fclose(csv);
+    }
+    TEST_CHECK(lineCount == 7);
+    TEST_CHECK(strcmp(lines[0], "time_ms,metric,source,value\n") == 0);
+    // 各指标合并后按时间排列，来源名称：0 为 local，未登记的为 other
+    TEST_CHECK(strstr(lines[1], ",remote_render_fps,alice,10\n") != NULL);
+    TEST_CHECK(strstr(lines[2], ",remote_render_fps,other,20\n") != NULL);
+    TEST_CHECK(strstr(lines[3], ",cpu_app,local,0.5\n") != NULL);
+    TEST_CHECK(strstr(lines[6], ",remote_render_fps,alice,50\n") != NULL);
+    double firstMs = atof(lines[1]);
+    double lastMs = atof(lines[6]);
+    TEST_CHECK(lastMs - firstMs > 0.399 && lastMs - firstMs < 0.401);
+
+    char missingPath[128];
+    snprintf(missingPath, sizeof(missingPath), "%s/missing/stats.bin", testDirectory);
+    TEST_CHECK(!StatsStoreExport(store, missingPath));
+    TEST_CHECK(!StatsStoreConvertToCsv(missingPath, csvPath));
+    // 魔数不对的文件拒绝转换
+    FILE *garbage = fopen(binaryPath, "r+b");
+    fputc('X', garbage);
+    fclose(garbage);
+    TEST_CHECK(!StatsStoreConvertToCsv(binaryPath, csvPath));
+    unlink(binaryPath);
+    unlink(csvPath);
+    StatsStoreDestroy(store);
+}
+
+// Concurrency
+
+enum {
+    WriterThreads = 4,
+    WriterRows = 200000,
+};
+
+static StatsStore *concurrentStore;
+static _Atomic int writersDone;
+
+/// 行的三列由线程号与序号共同决定：时间段、来源与值段都属于同一个线程，任意两次写入拼出的行可被识别
+static int64_t WriterTime(uint32_t thread, uint32_t i) {
+    return (int64_t)thread * 1000000000 + i;
+}
+
+static float WriterValue(uint32_t thread, uint32_t i) {
+    return (float)(thread * 1000000 + i % 1000000);
+}
+
+static bool RowConsistent(int64_t timeUs, float value, uint32_t source) {
+    if (source < 1 || source > WriterThreads) {
+        return false;
+    }
+    uint32_t thread = source - 1;
+    int64_t i = timeUs - (int64_t)thread * 1000000000;
+    return i >= 0 && i < WriterRows && value == WriterValue(thread, (uint32_t)i);
+}
+
+static void *ConcurrentWriter(void *argument) {
+    uint32_t thread = (uint32_t)(intptr_t)argument;
+    for (uint32_t i = 0; i < WriterRows; i++) {
+        StatsStoreRecord(concurrentStore, StatsMetricProcessTotalMs, thread + 1, WriterTime(thread, i),
+                         WriterValue(thread, i));
+        if (i % 64 == 0) {
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(&writersDone, 1);
+    return NULL;
+}
+
+/// 多个线程写入同一指标、缓冲不断被覆盖时，聚合与导出读到的每一行三列都来自同一次写入
+static void TestConcurrentReadWrite(void) {
+    StatsStoreConfig config = {.rowsPerMetric = 256, .maxSources = 4};
+    concurrentStore = StatsStoreCreate(&config);
+    atomic_store(&writersDone, 0);
+    pthread_t threads[WriterThreads];
+    for (int t = 0; t < WriterThreads; t++) {
+        pthread_create(&threads[t], NULL, ConcurrentWriter, (void *)(intptr_t)t);
+    }
+    char path[128];
+    snprintf(path, sizeof(path), "%s/concurrent.bin", testDirectory);
+    uint64_t aggregates = 0;
+    uint64_t exportedRows = 0;
+    bool intact = true;
+    while (atomic_load(&writersDone) < WriterThreads) {
+        for (uint32_t t = 0; t < WriterThreads; t++) {
+            StatsAggregate aggregate;
+            // 按来源过滤：值必须落在该线程的值段
+            if (StatsStoreAggregate(concurrentStore, StatsMetricProcessTotalMs, t + 1, INT64_MIN, INT64_MAX,
+                                    &aggregate)) {
+                intact = intact && aggregate.count <= 256 && aggregate.min >= WriterValue(t, 0) &&
+                         aggregate.max <= WriterValue(t, WriterRows - 1);
+                aggregates++;
+            }
+            // 按时间过滤：同样只能是该线程的值
+            if (StatsStoreAggregate(concurrentStore, StatsMetricProcessTotalMs, STATS_SOURCE_ANY, WriterTime(t, 0),
+                                    WriterTime(t, WriterRows), &aggregate)) {
+                intact = intact && aggregate.min >= WriterValue(t, 0) &&
+                         aggregate.max <= WriterValue(t, WriterRows - 1);
+                aggregates++;
+            }
+        }
+        if (aggregates % 64 < 8 && StatsStoreExport(concurrentStore, path)) {
+            TestExport file;
+            if (TestExportRead(path, &file)) {
+                uint32_t count = file.blocks[StatsMetricProcessTotalMs].rowCount;
+                for (uint32_t i = 0; i < count; i++) {
+                    intact = intact && RowConsistent(file.times[StatsMetricProcessTotalMs][i],
+                                                     file.values[StatsMetricProcessTotalMs][i],
+                                                     file.sources[StatsMetricProcessTotalMs][i]);
+                    intact = intact && (i == 0 || file.times[StatsMetricProcessTotalMs][i - 1] <=
+                                                      file.times[StatsMetricProcessTotalMs][i]);
+                }
+                exportedRows += count;
+            } else {
+                intact = false;
+            }
+            TestExportFree(&file);
+        }
+        sched_yield();
+    }
+    for (int t = 0; t < WriterThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    TEST_CHECK(intact);
+    TEST_CHECK(StatsStoreRecordedRows(concurrentStore, StatsMetricProcessTotalMs) ==
+               (uint64_t)WriterThreads * WriterRows);
+    // 写完之后保留的行全部可读
+    StatsAggregate aggregate;
+    TEST_CHECK(StatsStoreAggregate(concurrentStore, StatsMetricProcessTotalMs, STATS_SOURCE_ANY, INT64_MIN,
+                                   INT64_MAX, &aggregate));
+    TEST_CHECK(aggregate.count == 256);
+    printf("  %llu aggregates, %llu exported rows during writes\n", (unsigned long long)aggregates,
+           (unsigned long long)exportedRows);
+    unlink(path);
+    StatsStoreDestroy(concurrentStore);
+}
+
+static _Atomic bool singleRowStop;
+
+static void *SingleRowWriter(void *argument) {
+    uint32_t thread = (uint32_t)(intptr_t)argument;
+    for (uint32_t i = 0; !atomic_load_explicit(&singleRowStop, memory_order_relaxed); i = (i + 1) % WriterRows) {
+        StatsStoreRecord(concurrentStore, StatsMetricNetRttMs, thread + 1, WriterTime(thread, i),
+                         WriterValue(thread, i));
+    }
+    return NULL;
+}
+
+/// 只有一行时每次写入都覆盖同一行，写入线程在写到一半时被抢占的机会最多；读到的行不能拼接两次写入
+static void TestSingleRowTearing(void) {
+    StatsStoreConfig config = {.rowsPerMetric = 1, .maxSources = 4};
+    concurrentStore = StatsStoreCreate(&config);
+    atomic_store(&singleRowStop, false);
+    pthread_t threads[WriterThreads];
+    for (int t = 0; t < WriterThreads; t++) {
+        pthread_create(&threads[t], NULL, SingleRowWriter, (void *)(intptr_t)t);
+    }
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    uint64_t start = TestNowNs();
+    while (TestNowNs() - start < 300000000ull) {
+        for (uint32_t t = 0; t < WriterThreads; t++) {
+            StatsAggregate aggregate;
+            if (StatsStoreAggregate(concurrentStore, StatsMetricNetRttMs, t + 1, INT64_MIN, INT64_MAX, &aggregate)) {
+                torn += aggregate.count != 1 || aggregate.min < WriterValue(t, 0) ||
+                        aggregate.min > WriterValue(t, WriterRows - 1);
+                reads++;
+            }
+            if (StatsStoreAggregate(concurrentStore, StatsMetricNetRttMs, STATS_SOURCE_ANY, WriterTime(t, 0),
+                                    WriterTime(t, WriterRows), &aggregate)) {
+                torn += aggregate.min < WriterValue(t, 0) || aggregate.min > WriterValue(t, WriterRows - 1);
+                reads++;
+            }
+        }
+    }
+    atomic_store(&singleRowStop, true);
+    for (int t = 0; t < WriterThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    TEST_CHECK(torn == 0);
+    TEST_CHECK(reads > 0);
+    printf("  %llu reads of %llu rows\n", (unsigned long long)reads,
+           (unsigned long long)StatsStoreRecordedRows(concurrentStore, StatsMetricNetRttMs));
+    StatsStoreDestroy(concurrentStore);
+}
+
+int main(void) {
+    snprintf(testDirectory, sizeof(testDirectory), "/tmp/StatsStoreTestsXXXXXX");
+    if (!mkdtemp(testDirectory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    TEST_RUN(TestConfig);
+    TEST_RUN(TestSources);
+    TEST_RUN(TestConcurrentSources);
+    TEST_RUN(TestAggregate);
+    TEST_RUN(TestOverwrite);
+    TEST_RUN(TestExportAndCsv);
+    TEST_RUN(TestConcurrentReadWrite);
+    TEST_RUN(TestSingleRowTearing);
+    rmdir(testDirectory);
+    return TEST_RESULT();
+}
@@ -0,0 +1,461 @@
+//
+//  StreamArchiveTests.c
+//  tests
+//
+//  远端编码流归档：索引头校验与关键帧定位（与逐个查找比较），配置校验，
+//  多路流写出后按索引回读视频文件、按大小换文件、流数已满与空闲回收、并发投递，以及投递不分配内存
+//
+
+#include "StreamArchive.h"
+#include "EncodedRecorder.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    TestMaxFrame = 2048,
+    TestFrameUs = 33333,
+    TestMaxFramesPerStream = 2000,
+};
+
+static char testDirectory[] = "/tmp/StreamArchiveTestsXXXXXX";
+
+static uint32_t TestFrameSize(uint32_t stream, uint32_t sequence) {
+    return 16 + (sequence * 2654435761u + stream * 40503u) % (TestMaxFrame - 16);
+}
+
+static uint8_t TestFrameByte(uint32_t stream, uint32_t sequence, uint32_t i) {
+    return (uint8_t)(stream * 61 + sequence * 7 + i);
+}
+
+static void TestFrameData(uint8_t *data, uint32_t stream, uint32_t sequence) {
+    uint32_t size = TestFrameSize(stream, sequence);
+    for (uint32_t i = 0; i < size; i++) {
+        data[i] = TestFrameByte(stream, sequence, i);
+    }
+}
+
+/// 每 keyframeInterval 帧一个关键帧，第一帧不是关键帧
+static EncodedFrameHeader TestFrameHeader(uint32_t stream, uint32_t sequence, uint32_t keyframeInterval,
+                                          EncodedFrameCodec codec) {
+    EncodedFrameHeader header = {
+        .ptsUs = (int64_t)sequence * TestFrameUs,
+        .dtsUs = (int64_t)sequence * TestFrameUs,
+        .arrivalUs = EncodedRecorderNowUs(),
+        .size = TestFrameSize(stream, sequence),
+        .flags = sequence % keyframeInterval == 1 ? ENCODED_FRAME_FLAG_KEYFRAME : 0,
+        .width = 320,
+        .height = 240,
+        .rotation = 270,
+        .codec = codec,
+    };
+    return header;
+}
+
+static uint8_t *ReadWholeFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        *size = 0;
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = malloc(length > 0 ? (size_t)length : 1);
+    *size = fread(data, 1, (size_t)length, file);
+    fclose(file);
+    return data;
+}
+
+/// 回读结果：每路流按出现顺序记下的帧序号
+typedef struct {
+    const char *name;
+    uint32_t stream;
+    EncodedFrameCodec codec;
+    uint32_t sequences[TestMaxFramesPerStream];
+    size_t count;
+    uint32_t files;
+    bool intact;
+} TestArchivedStream;
+
+/// 读出目录下所有索引：校验头、条目偏移连续、数据与投递的帧一致、每个文件从关键帧开始；返回文件数
+static int ReadArchive(TestArchivedStream *streams, size_t streamCount) {
+    for (size_t s = 0; s < streamCount; s++) {
+        streams[s].count = 0;
+        streams[s].files = 0;
+        streams[s].intact = true;
+    }
+    DIR *directory = opendir(testDirectory);
+    if (!directory) {
+        return -1;
+    }
+    // 文件序号在目录内递增，按序号读保证同一路流的文件按时间排列
+    char names[256][NAME_MAX + 1];
+    int fileCount = 0;
+    struct dirent *entry;
+    while ((entry = readdir(directory)) && fileCount < 256) {
+        size_t length = strlen(entry->d_name);
+        if (length > 4 && strcmp(entry->d_name + length - 4, ".idx") == 0) {
+            strcpy(names[fileCount++], entry->d_name);
+        }
+    }
+    closedir(directory);
+    for (int f = 1; f < fileCount; f++) {
+        char moving[NAME_MAX + 1];
+        strcpy(moving, names[f]);
+        int g = f;
+        // 文件名以 _NNNN.idx 结尾，按末尾 8 个字符比较
+        for (; g > 0 && strcmp(names[g - 1] + strlen(names[g - 1]) - 8, moving + strlen(moving) - 8) > 0; g--) {
+            strcpy(names[g], names[g - 1]);
+        }
+        strcpy(names[g], moving);
+    }
+    for (int f = 0; f < fileCount; f++) {
+        char indexPath[PATH_MAX];
+        snprintf(indexPath, sizeof(indexPath), "%s/%.*s", testDirectory, NAME_MAX, names[f]);
+        size_t indexSize;
+        uint8_t *index = ReadWholeFile(indexPath, &indexSize);
+        const StreamArchiveIndexHeader *header = (const StreamArchiveIndexHeader *)index;
+        if (!index || indexSize < sizeof(*header) || !StreamArchiveIndexHeaderValid(header)) {
+            TEST_CHECK(!"index header");
+            free(index);
+            continue;
+        }
+        TestArchivedStream *stream = NULL;
+        for (size_t s = 0; s < streamCount; s++) {
+            if (strcmp(header->name, streams[s].name) == 0) {
+                stream = &streams[s];
+            }
+        }
+        TEST_CHECK(stream != NULL);
+        if (!stream) {
+            free(index);
+            continue;
+        }
+        stream->files++;
+        TEST_CHECK(header->codec == stream->codec);
+        TEST_CHECK((indexSize - header->headerSize) % header->entrySize == 0);
+        size_t entryCount = (indexSize - header->headerSize) / header->entrySize;
+
+        char videoPath[PATH_MAX];
+        snprintf(videoPath, sizeof(videoPath), "%s/%.*s.%s", testDirectory, (int)(strlen(names[f]) - 4), names[f],
+                 stream->codec == EncodedFrameCodecH265 ? "h265" : "h264");
+        size_t videoSize;
+        uint8_t *video = ReadWholeFile(videoPath, &videoSize);
+        TEST_CHECK(video != NULL);
+        uint64_t offset = 0;
+        for (size_t i = 0; i < entryCount && video; i++) {
+            StreamArchiveIndexEntry item;
+            memcpy(&item, index + header->headerSize + i * header->entrySize, sizeof(item));
+            uint32_t sequence = (uint32_t)(item.ptsUs / TestFrameUs);
+            bool ok = item.offset == offset && item.size == TestFrameSize(stream->stream, sequence) &&
+                      (uint64_t)item.offset + item.size <= videoSize && item.rotation == 270 &&
+                      (i > 0 || (item.flags & ENCODED_FRAME_FLAG_KEYFRAME));
+            for (uint32_t b = 0; ok && b < item.size; b++) {
+                ok = video[item.offset + b] == TestFrameByte(stream->stream, sequence, b);
+            }
+            stream->intact = stream->intact && ok;
+            if (stream->count < TestMaxFramesPerStream) {
+                stream->sequences[stream->count++] = sequence;
+            }
+            offset += item.size;
+        }
+        TEST_CHECK(offset == videoSize);
+        free(video);
+        free(index);
+    }
+    return fileCount;
+}
+
+static void RemoveArchive(void) {
+    DIR *directory = opendir(testDirectory);
+    struct dirent *entry;
+    while (directory && (entry = readdir(directory))) {
+        if (entry->d_name[0] != '.') {
+            char path[PATH_MAX];
+            snprintf(path, sizeof(path), "%s/%s", testDirectory, entry->d_name);
+            unlink(path);
+        }
+    }
+    if (directory) {
+        closedir(directory);
+    }
+}
+
+// Tests
+
+static void TestIndexHeader(void) {
+    StreamArchiveIndexHeader header = {
+        .magic = STREAM_ARCHIVE_INDEX_MAGIC,
+        .version = STREAM_ARCHIVE_INDEX_VERSION,
+        .headerSize = sizeof(StreamArchiveIndexHeader),
+        .entrySize = sizeof(StreamArchiveIndexEntry),
+    };
+    TEST_CHECK(StreamArchiveIndexHeaderValid(&header));
+    // 以后扩展的更大的头与条目仍可读
+    header.headerSize = 256;
+    header.entrySize = 32;
+    TEST_CHECK(StreamArchiveIndexHeaderValid(&header));
+    StreamArchiveIndexHeader bad = header;
+    bad.magic ^= 1;
+    TEST_CHECK(!StreamArchiveIndexHeaderValid(&bad));
+    bad = header;
+    bad.version = STREAM_ARCHIVE_INDEX_VERSION + 1;
+    TEST_CHECK(!StreamArchiveIndexHeaderValid(&bad));
+    bad = header;
+    bad.headerSize = sizeof(StreamArchiveIndexHeader) - 8;
+    TEST_CHECK(!StreamArchiveIndexHeaderValid(&bad));
+    bad = header;
+    bad.entrySize = sizeof(StreamArchiveIndexEntry) - 4;
+    TEST_CHECK(!StreamArchiveIndexHeaderValid(&bad));
+}
+
+/// 逐个查找：ptsUs 不大于目标的最后一个关键帧
+static size_t ReferenceSeek(const StreamArchiveIndexEntry *entries, size_t count, int64_t ptsUs) {
+    size_t found = count;
+    for (size_t i = 0; i < count && entries[i].ptsUs <= ptsUs; i++) {
+        if (entries[i].flags & ENCODED_FRAME_FLAG_KEYFRAME) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+static void TestIndexSeek(void) {
+    TEST_CHECK(StreamArchiveIndexSeek(NULL, 0, 0) == 0);
+    StreamArchiveIndexEntry fixed[6] = {
+        {.ptsUs = 100, .flags = 0},
+        {.ptsUs = 200, .flags = ENCODED_FRAME_FLAG_KEYFRAME},
+        {.ptsUs = 300, .flags = 0},
+        {.ptsUs = 300, .flags = ENCODED_FRAME_FLAG_KEYFRAME},
+        {.ptsUs = 400, .flags = 0},
+        {.ptsUs = 500, .flags = 0},
+    };
+    TEST_CHECK(StreamArchiveIndexSeek(fixed, 6, 50) == 6);
+    TEST_CHECK(StreamArchiveIndexSeek(fixed, 6, 150) == 6);
+    TEST_CHECK(StreamArchiveIndexSeek(fixed, 6, 200) == 1);
+    TEST_CHECK(StreamArchiveIndexSeek(fixed, 6, 299) == 1);
+    // 相同 ptsUs 的关键帧取后一个
+    TEST_CHECK(StreamArchiveIndexSeek(fixed, 6, 300) == 3);
+    TEST_CHECK(StreamArchiveIndexSeek(fixed, 6, 1000) == 3);
+
+    static StreamArchiveIndexEntry entries[512];
+    uint32_t state = 7;
+    int mismatches = 0;
+    for (int round = 0; round < 200; round++) {
+        size_t count = (size_t)round % 512 + 1;
+        int64_t pts = 0;
+        for (size_t i = 0; i < count; i++) {
+            state = state * 1664525u + 1013904223u;
+            pts += (state >> 8) % 3 * 1000;
+            entries[i].ptsUs = pts;
+            entries[i].flags = (state >> 20) % 9 == 0 ? ENCODED_FRAME_FLAG_KEYFRAME : 0;
+        }
+        for (int64_t target = -1000; target <= pts + 1000; target += 500) {
+            mismatches += StreamArchiveIndexSeek(entries, count, target) != ReferenceSeek(entries, count, target);
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+}
+
+static void TestConfig(void) {
+    TEST_CHECK(!StreamArchiveCreate(NULL));
+    StreamArchiveConfig config = StreamArchiveDefaultConfig(NULL);
+    TEST_CHECK(!StreamArchiveCreate(&config));
+    config = StreamArchiveDefaultConfig(testDirectory);
+    config.maxStreams = 0;
+    TEST_CHECK(!StreamArchiveCreate(&config));
+    config = StreamArchiveDefaultConfig(testDirectory);
+    config.idleTimeoutMs = 0;
+    TEST_CHECK(!StreamArchiveCreate(&config));
+    // 目录长到放不下文件名时拒绝创建
+    static char longDirectory[PATH_MAX];
+    memset(longDirectory, 'd', PATH_MAX - STREAM_ARCHIVE_NAME_MAX);
+    longDirectory[PATH_MAX - STREAM_ARCHIVE_NAME_MAX] = '\0';
+    config = StreamArchiveDefaultConfig(longDirectory);
+    TEST_CHECK(!StreamArchiveCreate(&config));
+}
+
+/// 两路流（其中一路为 H.265、名称含不安全字符）写出后按索引回读；小文件上限时在关键帧处换文件
+static void TestArchiveRoundTrip(void) {
+    enum { Frames = 300 };
+    StreamArchiveConfig config = StreamArchiveDefaultConfig(testDirectory);
+    config.maxFileBytes = 64 * 1024;
+    config.flushIntervalMs = 20;
+    config.pollIntervalMs = 2;
+    StreamArchive *archive = StreamArchiveCreate(&config);
+    static TestArchivedStream streams[2] = {
+        {.name = "room 1/user:a_main", .stream = 0, .codec = EncodedFrameCodecH264},
+        {.name = "room1_userB_screen", .stream = 1, .codec = EncodedFrameCodecH265},
+    };
+    static uint8_t data[TestMaxFrame];
+    uint64_t pushed = 0;
+    for (uint32_t sequence = 0; sequence < Frames; sequence++) {
+        for (uint32_t s = 0; s < 2; s++) {
+            EncodedFrameHeader header = TestFrameHeader(s, sequence, 25, streams[s].codec);
+            TestFrameData(data, s, sequence);
+            pushed += StreamArchivePush(archive, streams[s].name, &header, data);
+        }
+        if (sequence % 10 == 0) {
+            usleep(2000);
+        }
+    }
+    StreamArchiveStop(archive);
+    TEST_CHECK(!StreamArchivePush(archive, streams[0].name, &(EncodedFrameHeader){.size = 0}, data));
+    StreamArchiveStats stats;
+    StreamArchiveGetStats(archive, &stats);
+    TEST_CHECK(pushed == 2 * Frames && stats.drops == 0 && stats.rejectedFrames == 0);
+    // 每路流第一帧不是关键帧
+    TEST_CHECK(stats.skippedFrames == 2 && stats.frames == 2 * Frames - 2);
+    TEST_CHECK(stats.writeErrors == 0 && stats.activeStreams == 0);
+
+    int files = ReadArchive(streams, 2);
+    TEST_CHECK(files >= 0 && (uint32_t)files == stats.files);
+    for (uint32_t s = 0; s < 2; s++) {
+        bool ordered = streams[s].count == Frames - 1;
+        for (size_t i = 0; ordered && i < streams[s].count; i++) {
+            ordered = streams[s].sequences[i] == i + 1;
+        }
+        TEST_CHECK(ordered && streams[s].intact);
+        // 每个文件约 64KB，平均帧 1KB，关键帧间隔 25
+        TEST_CHECK(streams[s].files >= 3);
+        printf("  stream %u: %zu frames in %u files\n", s, streams[s].count, streams[s].files);
+    }
+
+    // 文件名只保留安全字符
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/room_1_user_a_main_0000.h264", testDirectory);
+    TEST_CHECK(access(path, R_OK) == 0);
+    StreamArchiveDestroy(archive);
+    RemoveArchive();
+}
+
+/// 流数已满时拒绝新流；空闲超时后回收，新流可以占用
+static void TestCapacityAndIdle(void) {
+    StreamArchiveConfig config = StreamArchiveDefaultConfig(testDirectory);
+    config.maxStreams = 2;
+    config.idleTimeoutMs = 40;
+    config.pollIntervalMs = 2;
+    StreamArchive *archive = StreamArchiveCreate(&config);
+    static uint8_t data[TestMaxFrame];
+    const char *names[3] = {"a", "b", "c"};
+    for (uint32_t s = 0; s < 3; s++) {
+        EncodedFrameHeader header = TestFrameHeader(s, 1, 25, EncodedFrameCodecH264);
+        TestFrameData(data, s, 1);
+        TEST_CHECK(StreamArchivePush(archive, names[s], &header, data) == (s < 2));
+    }
+    StreamArchiveStats stats;
+    StreamArchiveGetStats(archive, &stats);
+    TEST_CHECK(stats.rejectedFrames == 1 && stats.activeStreams == 2);
+
+    // 两路流空闲后都被回收
+    for (int wait = 0; wait < 500 && stats.activeStreams > 0; wait++) {
+        usleep(2000);
+        StreamArchiveGetStats(archive, &stats);
+    }
+    TEST_CHECK(stats.activeStreams == 0 && stats.files == 2 && stats.frames == 2);
+    EncodedFrameHeader header = TestFrameHeader(2, 1, 25, EncodedFrameCodecH264);
+    TestFrameData(data, 2, 1);
+    TEST_CHECK(StreamArchivePush(archive, names[2], &header, data));
+    StreamArchiveStop(archive);
+    StreamArchiveGetStats(archive, &stats);
+    TEST_CHECK(stats.files == 3 && stats.frames == 3 && stats.writeErrors == 0);
+    StreamArchiveDestroy(archive);
+    RemoveArchive();
+}
+
+enum {
+    ConcurrentStreams = 4,
+    ConcurrentFrames = 1500,
+};
+
+typedef struct {
+    StreamArchive *archive;
+    uint32_t stream;
+    const char *name;
+    uint64_t accepted;
+    uint64_t allocations;
+} TestProducer;
+
+/// 每个线程投递自己的一路流，缓冲满时让出 CPU 重试
+static void *ProducerThread(void *argument) {
+    TestProducer *producer = argument;
+    static _Thread_local uint8_t data[TestMaxFrame];
+    uint64_t allocationsBefore = TestAllocCount();
+    for (uint32_t sequence = 0; sequence < ConcurrentFrames; sequence++) {
+        EncodedFrameHeader header = TestFrameHeader(producer->stream, sequence, 30, EncodedFrameCodecH264);
+        TestFrameData(data, producer->stream, sequence);
+        while (!StreamArchivePush(producer->archive, producer->name, &header, data)) {
+            sched_yield();
+        }
+        producer->accepted++;
+        sched_yield();
+    }
+    producer->allocations = TestAllocCount() - allocationsBefore;
+    return NULL;
+}
+
+/// 多个线程同时投递，每路流的帧完整且按顺序写出；投递不分配内存
+static void TestConcurrentProducers(void) {
+    StreamArchiveConfig config = StreamArchiveDefaultConfig(testDirectory);
+    config.streamSlabBytes = 64 * 1024;
+    config.flushIntervalMs = 10;
+    config.pollIntervalMs = 1;
+    StreamArchive *archive = StreamArchiveCreate(&config);
+    static const char *names[ConcurrentStreams] = {"p0", "p1", "p2", "p3"};
+    static TestProducer producers[ConcurrentStreams];
+    pthread_t threads[ConcurrentStreams];
+    for (uint32_t s = 0; s < ConcurrentStreams; s++) {
+        producers[s] = (TestProducer){.archive = archive, .stream = s, .name = names[s]};
+        pthread_create(&threads[s], NULL, ProducerThread, &producers[s]);
+    }
+    for (uint32_t s = 0; s < ConcurrentStreams; s++) {
+        pthread_join(threads[s], NULL);
+        TEST_CHECK(producers[s].accepted == ConcurrentFrames);
+    }
+    StreamArchiveStop(archive);
+    StreamArchiveStats stats;
+    StreamArchiveGetStats(archive, &stats);
+    TEST_CHECK(stats.frames == ConcurrentStreams * (ConcurrentFrames - 1) && stats.writeErrors == 0);
+    printf("  %llu frames, %llu full-buffer retries\n", (unsigned long long)stats.frames,
+           (unsigned long long)stats.drops);
+
+    static TestArchivedStream streams[ConcurrentStreams];
+    for (uint32_t s = 0; s < ConcurrentStreams; s++) {
+        streams[s].name = names[s];
+        streams[s].stream = s;
+        streams[s].codec = EncodedFrameCodecH264;
+    }
+    ReadArchive(streams, ConcurrentStreams);
+    for (uint32_t s = 0; s < ConcurrentStreams; s++) {
+        bool ordered = streams[s].count == ConcurrentFrames - 1;
+        for (size_t i = 0; ordered && i < streams[s].count; i++) {
+            ordered = streams[s].sequences[i] == i + 1;
+        }
+        TEST_CHECK(ordered && streams[s].intact);
+        TEST_CHECK(producers[s].allocations == 0);
+    }
+    StreamArchiveDestroy(archive);
+    RemoveArchive();
+}
+
+int main(void) {
+    if (!mkdtemp(testDirectory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    TEST_RUN(TestIndexHeader);
+    TEST_RUN(TestIndexSeek);
+    TEST_RUN(TestConfig);
+    TEST_RUN(TestArchiveRoundTrip);
+    TEST_RUN(TestCapacityAndIdle);
+    TEST_RUN(TestConcurrentProducers);
+    rmdir(testDirectory);
+    return TEST_RESULT();
+}
@@ -0,0 +1,40 @@
+//
+//  TestAllocCounter.c
+//  tests
+//
+
+#include "TestAllocCounter.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+static _Atomic uint64_t testAllocCount;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+int __real_posix_memalign(void **memory, size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    atomic_fetch_add_explicit(&testAllocCount, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&testAllocCount, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    atomic_fetch_add_explicit(&testAllocCount, 1, memory_order_relaxed);
+    return __real_realloc(pointer, size);
+}
+
+int __wrap_posix_memalign(void **memory, size_t alignment, size_t size) {
+    atomic_fetch_add_explicit(&testAllocCount, 1, memory_order_relaxed);
+    return __real_posix_memalign(memory, alignment, size);
+}
+
+uint64_t TestAllocCount(void) {
+    return atomic_load_explicit(&testAllocCount, memory_order_relaxed);
+}
@@ -0,0 +1,16 @@
+//
+//  TestAllocCounter.h
+//  tests
+//
+//  统计进程内 malloc/calloc/realloc/posix_memalign 调用次数，链接时需 --wrap 对应符号
+//
+
+#ifndef TestAllocCounter_h
+#define TestAllocCounter_h
+
+#include <stdint.h>
+
+/// 累计分配次数，可在任意线程读取
+uint64_t TestAllocCount(void);
+
+#endif /* TestAllocCounter_h */
@@ -0,0 +1,57 @@
+//
+//  TestSupport.h
+//  tests
+//
+//  Linux 单元测试与基准共用的断言、计时与内存统计
+//
+
+#ifndef TestSupport_h
+#define TestSupport_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+static int testFailures __attribute__((unused));
+
+/// 条件不成立时输出位置并记为失败，继续执行
+#define TEST_CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        testFailures++; \
+    } \
+} while (0)
+
+/// 运行一个测试函数并输出结果
+#define TEST_RUN(test) do { \
+    int failuresBefore = testFailures; \
+    test(); \
+    printf("%s %s\n", failuresBefore == testFailures ? "ok  " : "FAIL", #test); \
+} while (0)
+
+/// main 的返回值
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
+
+static inline uint64_t TestNowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/// 当前常驻内存（KB），读取失败返回 -1
+static inline long TestResidentKB(void) {
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file) {
+        return -1;
+    }
+    long size = 0;
+    long resident = -1;
+    if (fscanf(file, "%ld %ld", &size, &resident) != 2) {
+        resident = -1;
+    }
+    fclose(file);
+    return resident < 0 ? -1 : resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+#endif /* TestSupport_h */
@@ -0,0 +1,465 @@
+//
+//  UserRegistryTests.c
+//  tests
+//
+//  远端用户表：槽位分配与补位、说话人换位、句柄复用、事件校验与丢弃、容量上限、
+//  哈希表删除后查找，以及多线程投递时与参考模型一致、处理时不分配内存
+//
+
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+#include "UserRegistry.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+static UserRegistry *CreateRegistry(size_t capacity, size_t eventCapacity, size_t slotCount) {
+    UserRegistryConfig config = {
+        .capacity = capacity,
+        .eventCapacity = eventCapacity,
+        .slotCount = slotCount,
+    };
+    return UserRegistryCreate(&config);
+}
+
+static uint32_t Find(const UserRegistry *registry, const char *userId) {
+    return UserRegistryFind(registry, userId);
+}
+
+/// 槽位上的用户 ID，空槽返回空串
+static const char *SlotUserId(const UserRegistry *registry, int slot) {
+    uint32_t handle = UserRegistrySlotUser(registry, slot);
+    return handle == USER_REGISTRY_INVALID_HANDLE ? "" : UserRegistryUserId(registry, handle);
+}
+
+static void TestConfig(void) {
+    UserRegistryConfig config = UserRegistryDefaultConfig();
+    TEST_CHECK(config.capacity == 1024 && config.eventCapacity == 4096 && config.slotCount == 3);
+    TEST_CHECK(UserRegistryCreate(NULL) == NULL);
+    TEST_CHECK(CreateRegistry(0, 16, 3) == NULL);
+    TEST_CHECK(CreateRegistry(16, 1, 3) == NULL);
+    TEST_CHECK(CreateRegistry(16, 16, 0) == NULL);
+    UserRegistry *registry = UserRegistryCreate(&config);
+    TEST_CHECK(registry != NULL);
+    TEST_CHECK(UserRegistrySlotCount(registry) == 3);
+    TEST_CHECK(UserRegistryUserCount(registry) == 0);
+    TEST_CHECK(UserRegistrySlotUser(registry, -1) == USER_REGISTRY_INVALID_HANDLE);
+    TEST_CHECK(UserRegistrySlotUser(registry, 3) == USER_REGISTRY_INVALID_HANDLE);
+    TEST_CHECK(UserRegistryFind(registry, NULL) == USER_REGISTRY_INVALID_HANDLE);
+    TEST_CHECK(UserRegistryUserId(registry, 0) == NULL);
+    UserRegistryDestroy(registry);
+    UserRegistryDestroy(NULL);
+}
+
+/// 有视频的用户依次进入空槽，多出的用户排队；离开或停止视频时由等待最久的用户补位
+static void TestSlotsFillAndRefill(void) {
+    UserRegistry *registry = CreateRegistry(16, 16, 2);
+    UserRegistrySlotChange changes[2];
+    UserRegistryPost(registry, UserRegistryEventJoined, "a", NULL);
+    UserRegistryPost(registry, UserRegistryEventJoined, "b", NULL);
+    TEST_CHECK(UserRegistryHasPendingEvents(registry));
+    // 只进房没有视频时不占槽位
+    TEST_CHECK(UserRegistryApply(registry, changes) == 0);
+    TEST_CHECK(!UserRegistryHasPendingEvents(registry));
+    TEST_CHECK(UserRegistryUserCount(registry) == 2);
+
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "b", NULL);
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "a", NULL);
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "c", NULL);
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "d", NULL);
+    size_t count = UserRegistryApply(registry, changes);
+    TEST_CHECK(count == 2);
+    TEST_CHECK(changes[0].slot == 0 && strcmp(changes[0].userId, "b") == 0);
+    TEST_CHECK(changes[1].slot == 1 && strcmp(changes[1].userId, "a") == 0);
+    UserRegistryUserState state;
+    TEST_CHECK(UserRegistryGetState(registry, Find(registry, "c"), &state));
+    TEST_CHECK(state.joined && state.hasVideo && state.subscribed && state.slot == USER_REGISTRY_NO_SLOT);
+    // 没有新事件时不重复报告
+    TEST_CHECK(UserRegistryApply(registry, changes) == 0);
+
+    UserRegistryPost(registry, UserRegistryEventLeft, "b", NULL);
+    count = UserRegistryApply(registry, changes);
+    TEST_CHECK(count == 1 && changes[0].slot == 0 && strcmp(changes[0].userId, "c") == 0);
+    TEST_CHECK(Find(registry, "b") == USER_REGISTRY_INVALID_HANDLE);
+    TEST_CHECK(UserRegistryUserCount(registry) == 3);
+
+    UserRegistryPost(registry, UserRegistryEventVideoStopped, "a", NULL);
+    count = UserRegistryApply(registry, changes);
+    TEST_CHECK(count == 1 && changes[0].slot == 1 && strcmp(changes[0].userId, "d") == 0);
+    TEST_CHECK(UserRegistryGetState(registry, Find(registry, "a"), &state));
+    TEST_CHECK(state.joined && !state.hasVideo && state.slot == USER_REGISTRY_NO_SLOT);
+
+    // 没有等待的用户时槽位清空
+    UserRegistryPost(registry, UserRegistryEventVideoStopped, "d", NULL);
+    count = UserRegistryApply(registry, changes);
+    TEST_CHECK(count == 1 && changes[0].slot == 1 && changes[0].userId[0] == '\0');
+    TEST_CHECK(UserRegistrySlotUser(registry, 1) == USER_REGISTRY_INVALID_HANDLE);
+
+    // 重新开始视频的用户排在已等待的用户之后
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "a", NULL);
+    count = UserRegistryApply(registry, changes);
+    TEST_CHECK(count == 1 && changes[0].slot == 1 && strcmp(changes[0].userId, "a") == 0);
+    UserRegistryDestroy(registry);
+}
+
+/// 统计、订阅状态按用户保存；不在房间的用户的离开、统计事件被忽略
+static void TestStateEvents(void) {
+    UserRegistry *registry = CreateRegistry(16, 16, 3);
+    UserRegistrySlotChange changes[3];
+    UserRegistryStats stats = {
+        .videoKbps = 800,
+        .audioKbps = 32,
+        .videoLossRate = 0.01f,
+        .frameRate = 24,
+        .e2eDelayMs = 180,
+    };
+    UserRegistryPost(registry, UserRegistryEventStats, "ghost", &stats);
+    UserRegistryPost(registry, UserRegistryEventLeft, "ghost", NULL);
+    UserRegistryPost(registry, UserRegistryEventVideoStopped, "ghost", NULL);
+    UserRegistryPost(registry, UserRegistryEventSubscribed, "ghost", NULL);
+    TEST_CHECK(UserRegistryApply(registry, changes) == 0);
+    TEST_CHECK(UserRegistryUserCount(registry) == 0);
+
+    UserRegistryPost(registry, UserRegistryEventJoined, "u", NULL);
+    UserRegistryPost(registry, UserRegistryEventSubscribed, "u", NULL);
+    UserRegistryPost(registry, UserRegistryEventStats, "u", &stats);
+    UserRegistryApply(registry, changes);
+    UserRegistryUserState state;
+    TEST_CHECK(UserRegistryGetState(registry, Find(registry, "u"), &state));
+    TEST_CHECK(state.joined && state.subscribed && !state.hasVideo);
+    TEST_CHECK(state.stats.videoKbps == 800 && state.stats.frameRate == 24 && state.stats.e2eDelayMs == 180);
+
+    UserRegistryPost(registry, UserRegistryEventUnsubscribed, "u", NULL);
+    UserRegistryApply(registry, changes);
+    TEST_CHECK(UserRegistryGetState(registry, Find(registry, "u"), &state));
+    TEST_CHECK(!state.subscribed);
+
+    // 首帧回调早于进房回调
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "early", NULL);
+    TEST_CHECK(UserRegistryApply(registry, changes) == 1);
+    TEST_CHECK(UserRegistryGetState(registry, Find(registry, "early"), &state));
+    TEST_CHECK(state.joined && state.hasVideo && state.slot == 0);
+    // 重复的首帧事件不会再次排队
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "early", NULL);
+    TEST_CHECK(UserRegistryApply(registry, changes) == 0);
+    TEST_CHECK(UserRegistrySlotUser(registry, 1) == USER_REGISTRY_INVALID_HANDLE);
+    UserRegistryDestroy(registry);
+}
+
+/// 离开后句柄被新用户复用：同一槽位、同一句柄也报告为变化
+static void TestHandleReuse(void) {
+    UserRegistry *registry = CreateRegistry(4, 16, 1);
+    UserRegistrySlotChange changes[1];
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "old", NULL);
+    UserRegistryApply(registry, changes);
+    uint32_t oldHandle = Find(registry, "old");
+
+    UserRegistryPost(registry, UserRegistryEventLeft, "old", NULL);
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "new", NULL);
+    size_t count = UserRegistryApply(registry, changes);
+    TEST_CHECK(Find(registry, "new") == oldHandle);
+    TEST_CHECK(count == 1 && changes[0].slot == 0 && strcmp(changes[0].userId, "new") == 0);
+
+    // 同一用户在一次 Apply 之间离开又回来，也是新的一次显示
+    UserRegistryPost(registry, UserRegistryEventLeft, "new", NULL);
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "new", NULL);
+    count = UserRegistryApply(registry, changes);
+    TEST_CHECK(count == 1 && strcmp(changes[0].userId, "new") == 0);
+    UserRegistryDestroy(registry);
+}
+
+/// 说话人换位：目标槽位的用户换到该用户原来的槽位；从等待队列选中时被换下的用户排到队首
+static void TestAssignSlot(void) {
+    UserRegistry *registry = CreateRegistry(16, 16, 3);
+    UserRegistrySlotChange changes[3];
+    const char *users[] = {"a", "b", "c", "d", "e"};
+    for (int i = 0; i < 5; i++) {
+        UserRegistryPost(registry, UserRegistryEventVideoStarted, users[i], NULL);
+    }
+    UserRegistryPost(registry, UserRegistryEventJoined, "silent", NULL);
+    UserRegistryApply(registry, changes);
+
+    size_t count = UserRegistryAssignSlot(registry, 0, Find(registry, "c"), changes);
+    TEST_CHECK(count == 2);
+    TEST_CHECK(strcmp(SlotUserId(registry, 0), "c") == 0);
+    TEST_CHECK(strcmp(SlotUserId(registry, 1), "b") == 0);
+    TEST_CHECK(strcmp(SlotUserId(registry, 2), "a") == 0);
+
+    // 等待中的 e 换到槽位 1，b 排到队首，先于 d 补位
+    count = UserRegistryAssignSlot(registry, 1, Find(registry, "e"), changes);
+    TEST_CHECK(count == 1 && changes[0].slot == 1 && strcmp(changes[0].userId, "e") == 0);
+    UserRegistryPost(registry, UserRegistryEventLeft, "a", NULL);
+    count = UserRegistryApply(registry, changes);
+    TEST_CHECK(count == 1 && changes[0].slot == 2 && strcmp(changes[0].userId, "b") == 0);
+
+    // 已在目标槽位、没有视频、槽位或句柄越界时不变
+    TEST_CHECK(UserRegistryAssignSlot(registry, 0, Find(registry, "c"), changes) == 0);
+    TEST_CHECK(UserRegistryAssignSlot(registry, 0, Find(registry, "silent"), changes) == 0);
+    TEST_CHECK(UserRegistryAssignSlot(registry, 3, Find(registry, "d"), changes) == 0);
+    TEST_CHECK(UserRegistryAssignSlot(registry, -1, Find(registry, "d"), changes) == 0);
+    TEST_CHECK(UserRegistryAssignSlot(registry, 0, USER_REGISTRY_INVALID_HANDLE, changes) == 0);
+    TEST_CHECK(strcmp(SlotUserId(registry, 0), "c") == 0);
+    UserRegistryDestroy(registry);
+}
+
+/// 空 ID、超长 ID 与队列满时的事件被丢弃并计数，处理后可继续投递
+static void TestPostRejectsAndDrops(void) {
+    UserRegistry *registry = CreateRegistry(16, 3, 1);
+    UserRegistrySlotChange changes[1];
+    char longId[USER_REGISTRY_MAX_ID_LENGTH + 2];
+    memset(longId, 'x', sizeof(longId) - 1);
+    longId[sizeof(longId) - 1] = '\0';
+    TEST_CHECK(!UserRegistryPost(registry, UserRegistryEventJoined, "", NULL));
+    TEST_CHECK(!UserRegistryPost(registry, UserRegistryEventJoined, NULL, NULL));
+    TEST_CHECK(!UserRegistryPost(registry, UserRegistryEventJoined, longId, NULL));
+    TEST_CHECK(UserRegistryDroppedEvents(registry) == 3);
+    TEST_CHECK(!UserRegistryHasPendingEvents(registry));
+    // 最长的 ID 可以投递
+    longId[USER_REGISTRY_MAX_ID_LENGTH] = '\0';
+    TEST_CHECK(UserRegistryPost(registry, UserRegistryEventVideoStarted, longId, NULL));
+
+    // eventCapacity 取整到 4
+    for (int i = 0; i < 3; i++) {
+        TEST_CHECK(UserRegistryPost(registry, UserRegistryEventJoined, "fill", NULL));
+    }
+    TEST_CHECK(!UserRegistryPost(registry, UserRegistryEventJoined, "overflow", NULL));
+    TEST_CHECK(UserRegistryDroppedEvents(registry) == 4);
+    TEST_CHECK(UserRegistryApply(registry, changes) == 1);
+    TEST_CHECK(strcmp(changes[0].userId, longId) == 0);
+    TEST_CHECK(Find(registry, "overflow") == USER_REGISTRY_INVALID_HANDLE);
+    TEST_CHECK(UserRegistryPost(registry, UserRegistryEventJoined, "overflow", NULL));
+    UserRegistryApply(registry, changes);
+    TEST_CHECK(Find(registry, "overflow") != USER_REGISTRY_INVALID_HANDLE);
+    UserRegistryDestroy(registry);
+}
+
+/// 用户数达到上限后新用户被忽略，有人离开后可以再进入
+static void TestCapacity(void) {
+    UserRegistry *registry = CreateRegistry(3, 16, 1);
+    UserRegistrySlotChange changes[1];
+    const char *users[] = {"a", "b", "c", "d"};
+    for (int i = 0; i < 4; i++) {
+        UserRegistryPost(registry, UserRegistryEventJoined, users[i], NULL);
+    }
+    UserRegistryApply(registry, changes);
+    TEST_CHECK(UserRegistryUserCount(registry) == 3);
+    TEST_CHECK(Find(registry, "d") == USER_REGISTRY_INVALID_HANDLE);
+    UserRegistryPost(registry, UserRegistryEventLeft, "b", NULL);
+    UserRegistryPost(registry, UserRegistryEventVideoStarted, "d", NULL);
+    TEST_CHECK(UserRegistryApply(registry, changes) == 1);
+    TEST_CHECK(UserRegistryUserCount(registry) == 3);
+    TEST_CHECK(strcmp(SlotUserId(registry, 0), "d") == 0);
+    UserRegistryDestroy(registry);
+}
+
+enum {
+    ModelUsers = 2000,
+    ModelSlots = 5,
+};
+
+/// 参考模型：每个用户是否在房间、是否有视频
+typedef struct {
+    bool present[ModelUsers];
+    bool video[ModelUsers];
+} RegistryModel;
+
+static void UserIdForIndex(int index, char *userId) {
+    snprintf(userId, 32, "user-%d", index);
+}
+
+/// 随机投递一个事件并更新模型，队列满时让出 CPU 后重试
+static void PostRandomEvent(UserRegistry *registry, RegistryModel *model, int index, unsigned *seed) {
+    char userId[32];
+    UserIdForIndex(index, userId);
+    UserRegistryEventType type;
+    UserRegistryStats stats = {.frameRate = index};
+    switch (rand_r(seed) % 6) {
+        case 0:
+            type = UserRegistryEventJoined;
+            model->present[index] = true;
+            break;
+        case 1:
+            type = UserRegistryEventLeft;
+            model->present[index] = false;
+            model->video[index] = false;
+            break;
+        case 2:
+        case 3:
+            type = UserRegistryEventVideoStarted;
+            model->present[index] = true;
+            model->video[index] = true;
+            break;
+        case 4:
+            type = UserRegistryEventVideoStopped;
+            model->video[index] = false;
+            break;
+        default:
+            type = UserRegistryEventStats;
+            break;
+    }
+    while (!UserRegistryPost(registry, type, userId, type == UserRegistryEventStats ? &stats : NULL)) {
+        sched_yield();
+    }
+}
+
+/// 表内状态与模型一致：查找、视频状态、槽位与等待队列的不变式
+static void CheckAgainstModel(const UserRegistry *registry, const RegistryModel *model) {
+    size_t present = 0;
+    size_t withVideo = 0;
+    for (int i = 0; i < ModelUsers; i++) {
+        char userId[32];
+        UserIdForIndex(i, userId);
+        uint32_t handle = UserRegistryFind(registry, userId);
+        if (!model->present[i]) {
+            TEST_CHECK(handle == USER_REGISTRY_INVALID_HANDLE);
+            continue;
+        }
+        present++;
+        withVideo += model->video[i];
+        UserRegistryUserState state;
+        TEST_CHECK(UserRegistryGetState(registry, handle, &state));
+        TEST_CHECK(strcmp(UserRegistryUserId(registry, handle), userId) == 0);
+        TEST_CHECK(state.hasVideo == model->video[i]);
+        if (state.slot != USER_REGISTRY_NO_SLOT) {
+            TEST_CHECK(state.hasVideo && UserRegistrySlotUser(registry, state.slot) == handle);
+        }
+    }
+    TEST_CHECK(UserRegistryUserCount(registry) == present);
+    // 有视频的用户数不少于槽位数时槽位全满
+    size_t occupied = 0;
+    for (int slot = 0; slot < ModelSlots; slot++) {
+        occupied += UserRegistrySlotUser(registry, slot) != USER_REGISTRY_INVALID_HANDLE;
+    }
+    TEST_CHECK(occupied == (withVideo < ModelSlots ? withVideo : ModelSlots));
+}
+
+/// 单线程随机进出房间与换位，每批处理后与模型比对；大量删除后哈希表查找仍正确
+static void TestRandomChurnMatchesModel(void) {
+    UserRegistry *registry = CreateRegistry(ModelUsers, 256, ModelSlots);
+    RegistryModel *model = calloc(1, sizeof(RegistryModel));
+    UserRegistrySlotChange changes[ModelSlots];
+    unsigned seed = 7;
+    for (int batch = 0; batch < 400; batch++) {
+        int events = rand_r(&seed) % 200;
+        for (int i = 0; i < events; i++) {
+            PostRandomEvent(registry, model, rand_r(&seed) % ModelUsers, &seed);
+        }
+        UserRegistryApply(registry, changes);
+        for (int i = 0; i < 3; i++) {
+            char userId[32];
+            int index = rand_r(&seed) % ModelUsers;
+            UserIdForIndex(index, userId);
+            uint32_t handle = UserRegistryFind(registry, userId);
+            if (handle != USER_REGISTRY_INVALID_HANDLE && model->video[index]) {
+                int slot = rand_r(&seed) % ModelSlots;
+                UserRegistryAssignSlot(registry, slot, handle, changes);
+                TEST_CHECK(UserRegistrySlotUser(registry, slot) == handle);
+            }
+        }
+        CheckAgainstModel(registry, model);
+    }
+    TEST_CHECK(UserRegistryDroppedEvents(registry) == 0);
+    printf("  %zu users after churn\n", UserRegistryUserCount(registry));
+    free(model);
+    UserRegistryDestroy(registry);
+}
+
+enum {
+    ProducerThreads = 4,
+    EventsPerProducer = 50000,
+};
+
+typedef struct {
+    UserRegistry *registry;
+    RegistryModel *model;
+    int firstUser;
+    unsigned seed;
+} Producer;
+
+static _Atomic int producersDone;
+
+/// 每个线程只投递自己范围内的用户，同一用户的事件顺序与投递顺序一致
+static void *ProducerThread(void *argument) {
+    Producer *producer = argument;
+    int users = ModelUsers / ProducerThreads;
+    for (int i = 0; i < EventsPerProducer; i++) {
+        int index = producer->firstUser + rand_r(&producer->seed) % users;
+        PostRandomEvent(producer->registry, producer->model, index, &producer->seed);
+    }
+    atomic_fetch_add(&producersDone, 1);
+    return NULL;
+}
+
+/// 多个线程同时投递、主线程同时处理，最终状态与各线程的模型一致
+static void TestConcurrentPostersMatchModel(void) {
+    UserRegistry *registry = CreateRegistry(ModelUsers, 512, ModelSlots);
+    RegistryModel *model = calloc(1, sizeof(RegistryModel));
+    UserRegistrySlotChange changes[ModelSlots];
+    Producer producers[ProducerThreads];
+    pthread_t threads[ProducerThreads];
+    atomic_store(&producersDone, 0);
+    for (int i = 0; i < ProducerThreads; i++) {
+        producers[i] = (Producer){
+            .registry = registry,
+            .model = model,
+            .firstUser = i * (ModelUsers / ProducerThreads),
+            .seed = 100u + i,
+        };
+        pthread_create(&threads[i], NULL, ProducerThread, &producers[i]);
+    }
+    size_t applies = 0;
+    while (atomic_load(&producersDone) < ProducerThreads) {
+        UserRegistryApply(registry, changes);
+        applies++;
+        sched_yield();
+    }
+    for (int i = 0; i < ProducerThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    while (UserRegistryHasPendingEvents(registry)) {
+        UserRegistryApply(registry, changes);
+    }
+    // 队列满时被拒绝的投递已重试，不影响最终状态
+    CheckAgainstModel(registry, model);
+    printf("  %zu applies while posting, %llu full-queue retries, %zu users\n", applies,
+           (unsigned long long)UserRegistryDroppedEvents(registry), UserRegistryUserCount(registry));
+    free(model);
+    UserRegistryDestroy(registry);
+}
+
+/// 创建后投递、处理与换位都不分配内存
+static void TestNoAllocationAfterCreate(void) {
+    UserRegistry *registry = CreateRegistry(ModelUsers, 256, ModelSlots);
+    RegistryModel *model = calloc(1, sizeof(RegistryModel));
+    UserRegistrySlotChange changes[ModelSlots];
+    unsigned seed = 3;
+    uint64_t allocations = TestAllocCount();
+    for (int batch = 0; batch < 100; batch++) {
+        for (int i = 0; i < 100; i++) {
+            PostRandomEvent(registry, model, rand_r(&seed) % ModelUsers, &seed);
+        }
+        UserRegistryApply(registry, changes);
+        uint32_t handle = UserRegistrySlotUser(registry, ModelSlots - 1);
+        UserRegistryAssignSlot(registry, 0, handle, changes);
+    }
+    TEST_CHECK(TestAllocCount() == allocations);
+    free(model);
+    UserRegistryDestroy(registry);
+}
+
+int main(void) {
+    TEST_RUN(TestConfig);
+    TEST_RUN(TestSlotsFillAndRefill);
+    TEST_RUN(TestStateEvents);
+    TEST_RUN(TestHandleReuse);
+    TEST_RUN(TestAssignSlot);
+    TEST_RUN(TestPostRejectsAndDrops);
+    TEST_RUN(TestCapacity);
+    TEST_RUN(TestRandomChurnMatchesModel);
+    TEST_RUN(TestConcurrentPostersMatchModel);
+    TEST_RUN(TestNoAllocationAfterCreate);
+    return TEST_RESULT();
+}
@@ -0,0 +1,466 @@
+//
+//  VideoReplayBenchmark.c
+//  tests
+//
+//  离线 YUV 回放性能测试：读取录制的 I420 / NV12 / Y4M 文件，逐帧包装为桩视频帧，
+//  驱动 quickstart 中可移植的 C 前处理阶段，无需真机与房间即可对比吞吐、耗时分布、分配次数与内存
+//
+//  用法：VideoReplayBenchmark [选项] <clip.y4m | clip.i420 | clip.nv12>
+//        VideoReplayBenchmark [选项] --synthetic 640x360:90
+//
+//    --size WxH            裸 I420 / NV12 文件的宽高（Y4M 从文件头读取）
+//    --stages a,b,...      依次执行的阶段，默认 downscale,budget；可选 downscale、quarter、grid、jpeg、budget
+//    --fps N               按 N fps 定时送帧，默认不限速
+//    --loops N             回放次数，默认 1
+//    --rotation 0|90|180|270
+//    --warmup N            不计入统计的预热帧数，默认 10
+//    --check-allocs        预热后仍有内存分配时返回失败（用于 ctest）
+//
+
+#include "FrameBudget.h"
+#include "FULatencyHistogram.h"
+#include "GridCompositor.h"
+#include "JpegEncoder.h"
+#include "LumaDownscaler.h"
+#include "TestAllocCounter.h"
+#include "TestSupport.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/resource.h>
+
+// 桩视频帧
+
+/// 对应 bytertc::IVideoFrame 中前处理用到的部分：I420 平面、旋转角度与时间戳
+typedef struct {
+    GridI420Image image;
+    int rotation;
+    int64_t timestampUs;
+} ReplayFrame;
+
+// 回放文件
+
+typedef enum {
+    ReplayFileFormatI420 = 0,
+    ReplayFileFormatNV12,
+    ReplayFileFormatY4M,
+} ReplayFileFormat;
+
+/// 全部帧转换为 I420 后读入内存，回放时不再有文件读写
+typedef struct {
+    int width;
+    int height;
+    size_t frameCount;
+    size_t frameSize;
+    uint8_t *frames;
+} ReplayClip;
+
+static bool HasSuffix(const char *string, const char *suffix) {
+    size_t length = strlen(string);
+    size_t suffixLength = strlen(suffix);
+    return length >= suffixLength && strcasecmp(string + length - suffixLength, suffix) == 0;
+}
+
+/// 解析 "YUV4MPEG2 W640 H360 F30:1 Ip A1:1 C420jpeg\n"，返回第一帧 FRAME 头的偏移
+static size_t ParseY4MHeader(const uint8_t *data, size_t length, int *width, int *height) {
+    const uint8_t *end = memchr(data, '\n', length < 256 ? length : 256);
+    if (!end || length < 10 || memcmp(data, "YUV4MPEG2 ", 10) != 0) {
+        return 0;
+    }
+    char header[256];
+    size_t headerLength = (size_t)(end - data);
+    memcpy(header, data, headerLength);
+    header[headerLength] = '\0';
+    for (char *token = strtok(header + 10, " "); token; token = strtok(NULL, " ")) {
+        if (token[0] == 'W') {
+            *width = atoi(token + 1);
+        } else if (token[0] == 'H') {
+            *height = atoi(token + 1);
+        } else if (token[0] == 'C' && strncmp(token + 1, "420", 3) != 0) {
+            return 0;
+        }
+    }
+    return headerLength + 1;
+}
+
+static bool LoadClip(ReplayClip *clip, const char *path, int width, int height) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long fileLength = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = fileLength > 0 ? malloc((size_t)fileLength) : NULL;
+    size_t length = data ? fread(data, 1, (size_t)fileLength, file) : 0;
+    fclose(file);
+    if (length == 0) {
+        free(data);
+        return false;
+    }
+
+    ReplayFileFormat format = HasSuffix(path, ".y4m") ? ReplayFileFormatY4M
+                            : HasSuffix(path, ".nv12") ? ReplayFileFormatNV12 : ReplayFileFormatI420;
+    size_t offset = 0;
+    if (format == ReplayFileFormatY4M) {
+        offset = ParseY4MHeader(data, length, &width, &height);
+        if (offset == 0) {
+            free(data);
+            return false;
+        }
+    }
+    if (width <= 0 || height <= 0 || (width & 1) || (height & 1)) {
+        free(data);
+        return false;
+    }
+    size_t frameSize = (size_t)width * height * 3 / 2;
+    // Y4M 每帧前有 "FRAME\n" 头（只支持不带参数的帧头）
+    size_t frameStride = format == ReplayFileFormatY4M ? frameSize + 6 : frameSize;
+    size_t frameCount = (length - offset) / frameStride;
+    if (frameCount == 0) {
+        free(data);
+        return false;
+    }
+
+    clip->width = width;
+    clip->height = height;
+    clip->frameCount = frameCount;
+    clip->frameSize = frameSize;
+    clip->frames = malloc(frameCount * frameSize);
+    size_t lumaSize = (size_t)width * height;
+    size_t chromaSize = lumaSize / 4;
+    for (size_t i = 0; i < frameCount; i++) {
+        const uint8_t *src = data + offset + i * frameStride + (format == ReplayFileFormatY4M ? 6 : 0);
+        uint8_t *dst = clip->frames + i * frameSize;
+        if (format == ReplayFileFormatNV12) {
+            memcpy(dst, src, lumaSize);
+            const uint8_t *uv = src + lumaSize;
+            for (size_t x = 0; x < chromaSize; x++) {
+                dst[lumaSize + x] = uv[2 * x];
+                dst[lumaSize + chromaSize + x] = uv[2 * x + 1];
+            }
+        } else {
+            memcpy(dst, src, frameSize);
+        }
+    }
+    free(data);
+    return true;
+}
+
+/// 生成运动的渐变画面，用于没有录制文件时的冒烟测试
+static void SynthesizeClip(ReplayClip *clip, int width, int height, size_t frameCount) {
+    clip->width = width;
+    clip->height = height;
+    clip->frameCount = frameCount;
+    clip->frameSize = (size_t)width * height * 3 / 2;
+    clip->frames = malloc(frameCount * clip->frameSize);
+    for (size_t i = 0; i < frameCount; i++) {
+        uint8_t *y = clip->frames + i * clip->frameSize;
+        uint8_t *u = y + (size_t)width * height;
+        uint8_t *v = u + (size_t)width * height / 4;
+        for (int row = 0; row < height; row++) {
+            for (int x = 0; x < width; x++) {
+                y[row * width + x] = (uint8_t)(16 + (x + row + (int)i * 4) % 220);
+            }
+        }
+        for (int row = 0; row < height / 2; row++) {
+            for (int x = 0; x < width / 2; x++) {
+                u[row * (width / 2) + x] = (uint8_t)(128 + (x - (int)i) % 32);
+                v[row * (width / 2) + x] = (uint8_t)(128 + (row + (int)i) % 32);
+            }
+        }
+    }
+}
+
+// 前处理阶段
+
+/// 所有阶段共用的状态，内存在 StagesCreate 中一次分配
+typedef struct {
+    int width;
+    int height;
+    /// 检测输入：1/2、1/4 亮度
+    uint8_t *halfLuma;
+    uint8_t *quarterLuma;
+    uint8_t *quarterScratch;
+    /// 远端网格：720x1280 画布，2x2，四格都是当前帧
+    GridCompositor *compositor;
+    GridI420Image canvas;
+    uint8_t *canvasData;
+    /// 截图编码
+    JpegEncoder *encoder;
+    uint8_t *jpeg;
+    size_t jpegCapacity;
+    size_t jpegBytes;
+    /// 帧耗时预算，记录上一帧整条链路的耗时
+    FrameBudget budget;
+    double lastFrameCostMs;
+} Stages;
+
+typedef void (*StageFunction)(Stages *stages, const ReplayFrame *frame);
+
+static void StageDownscale(Stages *stages, const ReplayFrame *frame) {
+    LumaDownscaleHalf(frame->image.y, frame->image.yStride, (size_t)frame->image.width, (size_t)frame->image.height,
+                      stages->halfLuma, (size_t)frame->image.width / 2);
+}
+
+static void StageQuarter(Stages *stages, const ReplayFrame *frame) {
+    LumaDownscaleQuarter(frame->image.y, frame->image.yStride, (size_t)frame->image.width, (size_t)frame->image.height,
+                         stages->quarterLuma, (size_t)frame->image.width / 4, stages->quarterScratch);
+}
+
+static void StageGrid(Stages *stages, const ReplayFrame *frame) {
+    const GridI420Image *sources[4] = {&frame->image, &frame->image, &frame->image, &frame->image};
+    GridCompositorCompose(stages->compositor, sources, &stages->canvas, 2, 2, GridScaleModeHidden);
+}
+
+static void StageJpeg(Stages *stages, const ReplayFrame *frame) {
+    stages->jpegBytes = JpegEncoderEncodeI420(stages->encoder, &frame->image, true, stages->jpeg, stages->jpegCapacity);
+}
+
+static void StageBudget(Stages *stages, const ReplayFrame *frame) {
+    FrameBudgetRecord(&stages->budget, stages->lastFrameCostMs);
+}
+
+typedef struct {
+    const char *name;
+    StageFunction function;
+} StageEntry;
+
+static const StageEntry stageEntries[] = {
+    {"downscale", StageDownscale},
+    {"quarter", StageQuarter},
+    {"grid", StageGrid},
+    {"jpeg", StageJpeg},
+    {"budget", StageBudget},
+};
+
+#define STAGE_ENTRY_COUNT (sizeof(stageEntries) / sizeof(stageEntries[0]))
+#define MAX_STAGES 8
+
+static StageFunction FindStage(const char *name) {
+    for (size_t i = 0; i < STAGE_ENTRY_COUNT; i++) {
+        if (strcmp(stageEntries[i].name, name) == 0) {
+            return stageEntries[i].function;
+        }
+    }
+    return NULL;
+}
+
+static bool StagesCreate(Stages *stages, int width, int height, double frameRate) {
+    memset(stages, 0, sizeof(Stages));
+    stages->width = width;
+    stages->height = height;
+    size_t pixels = (size_t)width * height;
+    stages->halfLuma = malloc(pixels / 4);
+    stages->quarterLuma = malloc(pixels / 16 + 1);
+    stages->quarterScratch = malloc(pixels / 4);
+    stages->compositor = GridCompositorCreate(width);
+    stages->canvas = (GridI420Image){.width = 720, .height = 1280, .yStride = 720, .uStride = 360, .vStride = 360};
+    stages->canvasData = malloc(720 * 1280 * 3 / 2);
+    stages->encoder = JpegEncoderCreate(85);
+    stages->jpegCapacity = JpegEncoderSuggestedCapacity(pixels);
+    stages->jpeg = malloc(stages->jpegCapacity);
+    FrameBudgetConfig config = FrameBudgetDefaultConfig(frameRate > 0 ? (int)frameRate : 30);
+    if (!stages->halfLuma || !stages->quarterLuma || !stages->quarterScratch || !stages->compositor ||
+        !stages->canvasData || !stages->encoder || !stages->jpeg || !FrameBudgetInit(&stages->budget, &config)) {
+        return false;
+    }
+    stages->canvas.y = stages->canvasData;
+    stages->canvas.u = stages->canvasData + 720 * 1280;
+    stages->canvas.v = stages->canvas.u + 360 * 640;
+    return true;
+}
+
+static void StagesDestroy(Stages *stages) {
+    free(stages->halfLuma);
+    free(stages->quarterLuma);
+    free(stages->quarterScratch);
+    GridCompositorDestroy(stages->compositor);
+    free(stages->canvasData);
+    JpegEncoderDestroy(stages->encoder);
+    free(stages->jpeg);
+}
+
+// 回放
+
+typedef struct {
+    const char *clipPath;
+    int width;
+    int height;
+    size_t syntheticFrames;
+    StageFunction stages[MAX_STAGES];
+    size_t stageCount;
+    double frameRate;
+    int loops;
+    int rotation;
+    int warmupFrames;
+    bool checkAllocations;
+} ReplayOptions;
+
+static bool ParseStages(ReplayOptions *options, char *list) {
+    options->stageCount = 0;
+    for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+        StageFunction stage = FindStage(name);
+        if (!stage || options->stageCount == MAX_STAGES) {
+            fprintf(stderr, "unknown stage %s\n", name);
+            return false;
+        }
+        options->stages[options->stageCount++] = stage;
+    }
+    return options->stageCount > 0;
+}
+
+static bool ParseOptions(ReplayOptions *options, int argc, char **argv) {
+    char defaultStages[] = "downscale,budget";
+    *options = (ReplayOptions){.loops = 1, .warmupFrames = 10};
+    ParseStages(options, defaultStages);
+    for (int i = 1; i < argc; i++) {
+        const char *argument = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argument, "--check-allocs") == 0) {
+            options->checkAllocations = true;
+            continue;
+        }
+        if (argument[0] != '-') {
+            options->clipPath = argument;
+            continue;
+        }
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argument);
+            return false;
+        }
+        i++;
+        if (strcmp(argument, "--size") == 0) {
+            if (sscanf(value, "%dx%d", &options->width, &options->height) != 2) {
+                return false;
+            }
+        } else if (strcmp(argument, "--synthetic") == 0) {
+            if (sscanf(value, "%dx%d:%zu", &options->width, &options->height, &options->syntheticFrames) != 3) {
+                return false;
+            }
+        } else if (strcmp(argument, "--stages") == 0) {
+            char list[256];
+            snprintf(list, sizeof(list), "%s", value);
+            if (!ParseStages(options, list)) {
+                return false;
+            }
+        } else if (strcmp(argument, "--fps") == 0) {
+            options->frameRate = atof(value);
+        } else if (strcmp(argument, "--loops") == 0) {
+            options->loops = atoi(value);
+        } else if (strcmp(argument, "--rotation") == 0) {
+            options->rotation = atoi(value);
+        } else if (strcmp(argument, "--warmup") == 0) {
+            options->warmupFrames = atoi(value);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argument);
+            return false;
+        }
+    }
+    return (options->clipPath || options->syntheticFrames > 0) && options->loops > 0;
+}
+
+static void SleepUntil(uint64_t deadlineNs) {
+    struct timespec deadline = {.tv_sec = (time_t)(deadlineNs / 1000000000ull), .tv_nsec = (long)(deadlineNs % 1000000000ull)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) != 0) {
+    }
+}
+
+int main(int argc, char **argv) {
+    ReplayOptions options;
+    if (!ParseOptions(&options, argc, argv)) {
+        fprintf(stderr, "usage: %s [--size WxH] [--stages a,b] [--fps N] [--loops N] [--rotation R] [--warmup N] "
+                        "[--check-allocs] <clip> | --synthetic WxH:frames\n", argv[0]);
+        return 2;
+    }
+    ReplayClip clip = {0};
+    if (options.syntheticFrames > 0) {
+        SynthesizeClip(&clip, options.width, options.height, options.syntheticFrames);
+    } else if (!LoadClip(&clip, options.clipPath, options.width, options.height)) {
+        fprintf(stderr, "cannot open clip %s\n", options.clipPath);
+        return 1;
+    }
+    Stages stages;
+    if (!StagesCreate(&stages, clip.width, clip.height, options.frameRate)) {
+        fprintf(stderr, "cannot create stages\n");
+        StagesDestroy(&stages);
+        free(clip.frames);
+        return 1;
+    }
+    // 采集 buffer：每帧从回放数据拷入，模拟采集回调交来的新帧
+    uint8_t *capture = malloc(clip.frameSize);
+    FULatencyHistogram *histogram = calloc(1, sizeof(FULatencyHistogram));
+    FULatencyHistogramSnapshot *snapshot = malloc(sizeof(FULatencyHistogramSnapshot));
+    ReplayFrame frame = {
+        .image = {
+            .y = capture,
+            .u = capture + (size_t)clip.width * clip.height,
+            .v = capture + (size_t)clip.width * clip.height * 5 / 4,
+            .yStride = (size_t)clip.width,
+            .uStride = (size_t)clip.width / 2,
+            .vStride = (size_t)clip.width / 2,
+            .width = clip.width,
+            .height = clip.height,
+        },
+        .rotation = options.rotation,
+    };
+    // 不限速时时间戳按 30fps 递增
+    int64_t timestampStepUs = (int64_t)(1000000.0 / (options.frameRate > 0 ? options.frameRate : 30));
+    uint64_t intervalNs = options.frameRate > 0 ? (uint64_t)(1e9 / options.frameRate) : 0;
+    size_t totalFrames = clip.frameCount * (size_t)options.loops;
+    size_t warmupFrames = (size_t)options.warmupFrames < totalFrames ? (size_t)options.warmupFrames : 0;
+
+    long residentBeforeKB = TestResidentKB();
+    uint64_t allocationsBefore = 0;
+    uint64_t replayStartNs = TestNowNs();
+    uint64_t measureStartNs = replayStartNs;
+    for (size_t i = 0; i < totalFrames; i++) {
+        if (i == warmupFrames) {
+            allocationsBefore = TestAllocCount();
+            measureStartNs = TestNowNs();
+        }
+        if (intervalNs > 0) {
+            SleepUntil(replayStartNs + i * intervalNs);
+        }
+        memcpy(capture, clip.frames + (i % clip.frameCount) * clip.frameSize, clip.frameSize);
+        frame.timestampUs = (int64_t)i * timestampStepUs;
+
+        uint64_t frameStartNs = TestNowNs();
+        for (size_t s = 0; s < options.stageCount; s++) {
+            options.stages[s](&stages, &frame);
+        }
+        uint64_t frameCostNs = TestNowNs() - frameStartNs;
+        stages.lastFrameCostMs = (double)frameCostNs / 1e6;
+        if (i >= warmupFrames) {
+            FULatencyHistogramRecord(histogram, frameCostNs / 1000);
+        }
+    }
+    uint64_t durationNs = TestNowNs() - measureStartNs;
+    uint64_t allocations = TestAllocCount() - allocationsBefore;
+    long residentAfterKB = TestResidentKB();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    FULatencyHistogramTakeSnapshot(histogram, snapshot, false);
+    double fps = durationNs > 0 ? (double)snapshot->count * 1e9 / (double)durationNs : 0;
+    printf("clip %dx%d, %zu frames x %d loops, rotation %d, %s\n", clip.width, clip.height, clip.frameCount,
+           options.loops, options.rotation, options.frameRate > 0 ? "paced" : "max speed");
+    printf("frames %llu  fps %.1f  p50 %.3fms  p95 %.3fms  p99 %.3fms  max %.3fms\n",
+           (unsigned long long)snapshot->count, fps,
+           FULatencyHistogramSnapshotPercentile(snapshot, 50) / 1000.0,
+           FULatencyHistogramSnapshotPercentile(snapshot, 95) / 1000.0,
+           FULatencyHistogramSnapshotPercentile(snapshot, 99) / 1000.0,
+           snapshot->maxValue / 1000.0);
+    printf("allocations %llu (%.2f/frame)  resident %+ld KB  peak RSS %ld KB  budget level %d\n",
+           (unsigned long long)allocations, snapshot->count > 0 ? (double)allocations / (double)snapshot->count : 0,
+           residentAfterKB - residentBeforeKB, usage.ru_maxrss, stages.budget.level);
+
+    int result = options.checkAllocations && allocations > 0 ? 1 : 0;
+    free(snapshot);
+    free(histogram);
+    free(capture);
+    StagesDestroy(&stages);
+    free(clip.frames);
+    return result;
+}